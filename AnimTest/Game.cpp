@@ -11,6 +11,7 @@
 
 #include "pch.h"
 #include "Game.h"
+#include "Profiler.h"
 
 #pragma warning(disable : 4238)
 
@@ -21,6 +22,9 @@
 //#define LH_COORDS
 
 extern void ExitGame() noexcept;
+#ifdef PC
+extern void ExitGame(int exitCode) noexcept;
+#endif
 
 using namespace DirectX;
 using namespace DirectX::SimpleMath;
@@ -40,6 +44,13 @@ namespace
     constexpr float row1 = 0.f;
     constexpr float row2 = -2.f;
 
+#ifdef PC
+    // Reference images are captured at a fixed frame, with the animations advanced by a
+    // fixed step rather than the clock.
+    constexpr uint32_t c_referenceFrame = 30;
+    constexpr float c_referenceStep = 1.f / 30.f;
+#endif
+
     void DumpBones(const ModelBone::Collection& bones, _In_z_ const char* name)
     {
         char buff[128] = {};
@@ -67,6 +78,9 @@ namespace
 }
 
 Game::Game() noexcept(false)
+#ifdef PC
+    : m_reference(L"AnimTest")
+#endif
 {
 #ifdef GAMMA_CORRECT_RENDERING
     constexpr DXGI_FORMAT c_RenderFormat = DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
@@ -105,6 +119,8 @@ void Game::Initialize(
 #endif
     int width, int height, DXGI_MODE_ROTATION rotation)
 {
+    DX_PROFILE_SCOPE("Initialize");
+
     m_gamePad = std::make_unique<GamePad>();
     m_keyboard = std::make_unique<Keyboard>();
 
@@ -142,6 +158,8 @@ void Game::Initialize(
 // Executes the basic game loop.
 void Game::Tick()
 {
+    DX_PROFILE_SCOPE("Tick");
+
     m_timer.Tick([&]()
     {
         Update(m_timer);
@@ -153,7 +171,13 @@ void Game::Tick()
 // Updates the world.
 void Game::Update(DX::StepTimer const& timer)
 {
+    DX_PROFILE_SCOPE("Update");
+
+#ifdef PC
+    float elapsedTime = m_reference.IsEnabled() ? c_referenceStep : float(timer.GetElapsedSeconds());
+#else
     float elapsedTime = float(timer.GetElapsedSeconds());
+#endif
 
     auto pad = m_gamePad->GetState(0);
     auto kb = m_keyboard->GetState();
@@ -171,6 +195,8 @@ void Game::Update(DX::StepTimer const& timer)
 // Draws the scene.
 void Game::Render()
 {
+    DX_PROFILE_SCOPE("Render");
+
     // Don't try to render anything before the first Update.
     if (m_timer.GetFrameCount() == 0)
     {
@@ -181,7 +207,11 @@ void Game::Render()
     m_deviceResources->Prepare();
 #endif
 
+#ifdef PC
+    auto time = m_reference.IsEnabled() ? float(m_timer.GetFrameCount()) * c_referenceStep : static_cast<float>(m_timer.GetTotalSeconds());
+#else
     auto time = static_cast<float>(m_timer.GetTotalSeconds());
+#endif
 
     XMMATRIX world = XMMatrixRotationY(XM_PI);
 
@@ -296,6 +326,15 @@ void Game::Render()
         nbones, bones.get(),
         local, m_view, m_projection);
 
+#ifdef PC
+    if (m_reference.IsEnabled() && m_timer.GetFrameCount() == c_referenceFrame)
+    {
+        m_reference.Check(context, m_deviceResources->GetRenderTarget(), L"frame");
+
+        ExitGame(m_reference.Summarize());
+    }
+#endif
+
     // Show the new frame.
     m_deviceResources->Present();
 
@@ -386,6 +425,8 @@ void Game::GetDefaultSize(int& width, int& height) const
 // These are the resources that depend on the device.
 void Game::CreateDeviceDependentResources()
 {
+    DX_PROFILE_SCOPE("CreateDeviceDependentResources");
+
     auto device = m_deviceResources->GetD3DDevice();
 
 #ifdef XBOX
@@ -453,6 +494,8 @@ void Game::CreateDeviceDependentResources()
 // Allocate all memory resources that change on a window SizeChanged event.
 void Game::CreateWindowSizeDependentResources()
 {
+    DX_PROFILE_SCOPE("CreateWindowSizeDependentResources");
+
     static const XMVECTORF32 cameraPosition = { { { 0.f, 0.f, 6.f, 0.f } } };
 
     const auto size = m_deviceResources->GetOutputSize();
@@ -14,6 +14,10 @@
 #include "DirectXTKTest.h"
 #include "StepTimer.h"
 
+#ifdef PC
+#include "ReferenceCapture.h"
+#endif
+
 constexpr uint32_t c_testTimeout = 10000;
 
 // A basic game implementation that creates a D3D11 device and
@@ -118,4 +122,9 @@ private:
 
     DX::AnimationSDKMESH                    m_soldierAnim;
     DX::AnimationCMO                        m_teapotAnim;
+
+#ifdef PC
+    // Golden image checks enabled by DIRECTXTK_REFERENCE_PATH
+    DX::ReferenceCapture                    m_reference;
+#endif
 };
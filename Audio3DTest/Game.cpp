@@ -11,6 +11,7 @@
 
 #include "pch.h"
 #include "Game.h"
+#include "Profiler.h"
 
 #define GAMMA_CORRECT_RENDERING
 #define USE_FAST_SEMANTICS
@@ -171,6 +172,8 @@ void Game::Initialize(
 #endif
     int width, int height, DXGI_MODE_ROTATION rotation)
 {
+    DX_PROFILE_SCOPE("Initialize");
+
     m_gamePad = std::make_unique<GamePad>();
     m_keyboard = std::make_unique<Keyboard>();
 
@@ -251,6 +254,8 @@ void Game::Initialize(
 // Executes the basic game loop.
 void Game::Tick()
 {
+    DX_PROFILE_SCOPE("Tick");
+
     m_timer.Tick([&]()
     {
         Update(m_timer);
@@ -264,6 +269,8 @@ void Game::Tick()
 // Updates the world.
 void Game::Update(DX::StepTimer const& timer)
 {
+    DX_PROFILE_SCOPE("Update");
+
     auto pad = m_gamePad->GetState(0);
     auto kb = m_keyboard->GetState();
     if (kb.Escape || (pad.IsConnected() && pad.IsViewPressed()))
@@ -318,6 +325,8 @@ void Game::Update(DX::StepTimer const& timer)
 // Draws the scene.
 void Game::Render()
 {
+    DX_PROFILE_SCOPE("Render");
+
     // Don't try to render anything before the first Update.
     if (m_timer.GetFrameCount() == 0)
     {
@@ -514,6 +523,8 @@ void Game::GetDefaultSize(int& width, int& height) const
 // These are the resources that depend on the device.
 void Game::CreateDeviceDependentResources()
 {
+    DX_PROFILE_SCOPE("CreateDeviceDependentResources");
+
     auto device = m_deviceResources->GetD3DDevice();
 
 #ifdef XBOX
@@ -536,6 +547,8 @@ void Game::CreateDeviceDependentResources()
 // Allocate all memory resources that change on a window SizeChanged event.
 void Game::CreateWindowSizeDependentResources()
 {
+    DX_PROFILE_SCOPE("CreateWindowSizeDependentResources");
+
     static const XMVECTORF32 cameraPosition = { { { 0.f, 14.f, 0.f, 0.f } } };
 
     const auto size = m_deviceResources->GetOutputSize();
@@ -11,8 +11,10 @@
 #include "Animation.h"
 
 #include <cassert>
+#include <cstring>
 #include <fstream>
 #include <stdexcept>
+#include <string>
 
 using namespace DX;
 using namespace DirectX;
@@ -106,7 +108,51 @@ HRESULT AnimationSDKMESH::Load(_In_z_ const wchar_t* fileName)
 
     inFile.close();
 
-    auto header = reinterpret_cast<const SDKANIMATION_FILE_HEADER*>(blob.get());
+    HRESULT hr = Validate(blob.get(), static_cast<size_t>(len));
+    if (FAILED(hr))
+        return hr;
+
+    m_animData.swap(blob);
+    m_animSize = static_cast<size_t>(len);
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT AnimationSDKMESH::Load(const uint8_t* animData, size_t dataSize)
+{
+    Release();
+
+    if (!animData)
+        return E_INVALIDARG;
+
+    if (dataSize > UINT32_MAX)
+        return HRESULT_FROM_WIN32(ERROR_FILE_TOO_LARGE);
+
+    if (dataSize < sizeof(SDKANIMATION_FILE_HEADER))
+        return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+    HRESULT hr = Validate(animData, dataSize);
+    if (FAILED(hr))
+        return hr;
+
+    // Bind patches the frame data in place, so this needs its own copy
+    std::unique_ptr<uint8_t[]> blob(new (std::nothrow) uint8_t[dataSize]);
+    if (!blob)
+        return E_OUTOFMEMORY;
+
+    memcpy(blob.get(), animData, dataSize);
+
+    m_animData.swap(blob);
+    m_animSize = dataSize;
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT AnimationSDKMESH::Validate(const uint8_t* animData, size_t dataSize) noexcept
+{
+    auto header = reinterpret_cast<const SDKANIMATION_FILE_HEADER*>(animData);
 
     if (header->Version != SDKMESH_FILE_VERSION
         || header->IsBigEndian != 0
@@ -116,12 +162,16 @@ HRESULT AnimationSDKMESH::Load(_In_z_ const wchar_t* fileName)
         || header->AnimationFPS == 0)
         return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
 
-    uint64_t dataSize = header->AnimationDataOffset + header->AnimationDataSize;
-    if (dataSize > uint64_t(len))
+    uint64_t dataEnd = header->AnimationDataOffset + header->AnimationDataSize;
+    if (dataEnd < header->AnimationDataOffset
+        || dataEnd > uint64_t(dataSize))
         return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
 
-    m_animData.swap(blob);
-    m_animSize = static_cast<size_t>(len);
+    // Bind walks the frame table, so it must fit in the file
+    uint64_t framesEnd = header->AnimationDataOffset + uint64_t(header->NumFrames) * sizeof(SDKANIMATION_FRAME_DATA);
+    if (framesEnd < header->AnimationDataOffset
+        || framesEnd > uint64_t(dataSize))
+        return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
 
     return S_OK;
 }
@@ -155,8 +205,11 @@ bool AnimationSDKMESH::Bind(const Model& model)
 
         frameData[j].pAnimationData = reinterpret_cast<SDKANIMATION_DATA*>(m_animData.get() + offset);
 
-        wchar_t frameName[MAX_FRAME_NAME] = {};
-        MultiByteToWideChar(CP_UTF8, 0, frameData[j].FrameName, -1, frameName, MAX_FRAME_NAME);
+        // Frame names are not guaranteed to be null-terminated
+        wchar_t frameName[MAX_FRAME_NAME + 1] = {};
+        MultiByteToWideChar(CP_UTF8, 0, frameData[j].FrameName,
+            static_cast<int>(strnlen(frameData[j].FrameName, MAX_FRAME_NAME)),
+            frameName, MAX_FRAME_NAME);
 
         size_t count = 0;
         for (const auto& it : model.bones)
@@ -323,29 +376,48 @@ HRESULT AnimationCMO::Load(const wchar_t* fileName, size_t offset, const wchar_t
 
     inFile.close();
 
-    auto nClips = reinterpret_cast<const uint32_t*>(blob.get());
+    return Load(blob.get(), dataSize, 0, clipName);
+}
+
+_Use_decl_annotations_
+HRESULT AnimationCMO::Load(const uint8_t* meshData, size_t dataSize, size_t offset, const wchar_t* clipName)
+{
+    Release();
+
+    if (!meshData)
+        return E_INVALIDARG;
+
+    if (dataSize > UINT32_MAX)
+        return HRESULT_FROM_WIN32(ERROR_FILE_TOO_LARGE);
+
+    if (offset > dataSize)
+        return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+    const uint8_t* animData = meshData + offset;
+    dataSize -= offset;
+
     size_t usedSize = sizeof(uint32_t);
     if (dataSize < usedSize)
         return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
 
-    if (!nClips)
-        return E_FAIL;
+    auto nClips = reinterpret_cast<const uint32_t*>(animData);
 
     for (size_t j = 0; j < *nClips; ++j)
     {
         // Clip name
-        auto nName = reinterpret_cast<const uint32_t*>(blob.get() + usedSize);
+        auto nName = reinterpret_cast<const uint32_t*>(animData + usedSize);
         usedSize += sizeof(uint32_t);
         if (dataSize < usedSize)
             return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
 
-        auto name = reinterpret_cast<const wchar_t*>(blob.get() + usedSize); // [CodeQL.SM02986]: The cast here is intentional.
+        auto name = reinterpret_cast<const wchar_t*>(animData + usedSize); // [CodeQL.SM02986]: The cast here is intentional.
 
-        usedSize += sizeof(wchar_t) * (*nName);
-        if (dataSize < usedSize)
+        if (uint64_t(*nName) * sizeof(wchar_t) > uint64_t(dataSize - usedSize))
             return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
 
-        auto clip = reinterpret_cast<const Clip*>(blob.get() + usedSize);
+        usedSize += sizeof(wchar_t) * (*nName);
+
+        auto clip = reinterpret_cast<const Clip*>(animData + usedSize);
         usedSize += sizeof(Clip);
         if (dataSize < usedSize)
             return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
@@ -353,12 +425,14 @@ HRESULT AnimationCMO::Load(const wchar_t* fileName, size_t offset, const wchar_t
         if (!clip->keys)
             return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
 
-        auto keys = reinterpret_cast<const Keyframe*>(blob.get() + usedSize);
-        usedSize += sizeof(Keyframe) * clip->keys;
-        if (dataSize < usedSize)
+        auto keys = reinterpret_cast<const Keyframe*>(animData + usedSize);
+        if (uint64_t(clip->keys) * sizeof(Keyframe) > uint64_t(dataSize - usedSize))
             return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
 
-        if (!clipName || _wcsicmp(clipName, name) == 0)
+        usedSize += sizeof(Keyframe) * clip->keys;
+
+        // The stored name is not guaranteed to be null-terminated
+        if (!clipName || _wcsicmp(clipName, std::wstring(name, *nName).c_str()) == 0)
         {
             m_startTime = clip->StartTime;
             m_endTime = clip->EndTime;
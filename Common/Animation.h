@@ -31,6 +31,7 @@ namespace DX
         AnimationSDKMESH& operator= (AnimationSDKMESH const&) = delete;
 
         HRESULT Load(_In_z_ const wchar_t* fileName);
+        HRESULT Load(_In_reads_bytes_(dataSize) const uint8_t* animData, size_t dataSize);
 
         void Release()
         {
@@ -51,6 +52,8 @@ namespace DX
             _Out_writes_(nbones) DirectX::XMMATRIX* boneTransforms) const;
 
     private:
+        static HRESULT Validate(_In_reads_bytes_(dataSize) const uint8_t* animData, size_t dataSize) noexcept;
+
         double                              m_animTime;
         std::unique_ptr<uint8_t[]>          m_animData;
         size_t                              m_animSize;
@@ -72,6 +75,9 @@ namespace DX
 
         HRESULT Load(_In_z_ const wchar_t* fileName, size_t offset, _In_opt_z_ const wchar_t* clipName = nullptr);
 
+        // 'offset' is the location of the animation clips within the CMO data.
+        HRESULT Load(_In_reads_bytes_(dataSize) const uint8_t* meshData, size_t dataSize, size_t offset, _In_opt_z_ const wchar_t* clipName = nullptr);
+
         void Release()
         {
             m_animTime = m_startTime = m_endTime = 0.f;
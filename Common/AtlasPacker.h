@@ -0,0 +1,616 @@
+//--------------------------------------------------------------------------------------
+// File: AtlasPacker.h
+//
+// Rectangle bin packing for texture atlases, on SimpleMath::Rectangle
+//
+// AtlasPacker places sprite-sized rectangles into a fixed-size atlas so that many small
+// textures can be drawn from one, batching thousands of sprites into a few draws.
+// Two methods are provided:
+//
+//  MaxRects    keeps every maximal free rectangle and places by best short side fit;
+//              the tightest packing, and removed space is reused immediately
+//  Skyline     keeps the top edge of the packed area and places bottom-left; faster,
+//              but space freed by Remove() is only reclaimed by Defragment()
+//
+// Insert() returns an id for each rectangle placed; ids stay valid until removed, and
+// are reused after that. Inserting a whole set at once sorts it largest first, which
+// packs noticeably better than arbitrary order. Defragment() repacks everything still
+// live and reports which rectangles moved so their texels can be copied.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SimpleMath.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+namespace DX
+{
+    class AtlasPacker
+    {
+    public:
+        enum class Method
+        {
+            MaxRects,
+            Skyline,
+        };
+
+        struct Move
+        {
+            uint32_t                        id;
+            DirectX::SimpleMath::Rectangle  from;
+            DirectX::SimpleMath::Rectangle  to;
+        };
+
+        static constexpr uint32_t c_Invalid = UINT32_MAX;
+
+        AtlasPacker() noexcept :
+            m_width(0),
+            m_height(0),
+            m_padding(0),
+            m_method(Method::MaxRects),
+            m_usedArea(0),
+            m_count(0)
+        {
+        }
+
+        // 'padding' texels are kept free to the right of and below every rectangle
+        AtlasPacker(long width, long height, Method method = Method::MaxRects, long padding = 0);
+
+        AtlasPacker(AtlasPacker&&) = default;
+        AtlasPacker& operator= (AtlasPacker&&) = default;
+
+        AtlasPacker(AtlasPacker const&) = default;
+        AtlasPacker& operator= (AtlasPacker const&) = default;
+
+        // Returns false (leaving the atlas unchanged) if there is no room
+        bool Insert(long width, long height, uint32_t& id, DirectX::SimpleMath::Rectangle& placed);
+
+        // Places rectangles of the given sizes (x and y are ignored), largest first. Entries
+        // that do not fit get c_Invalid; the return value is the number placed.
+        size_t Insert(
+            _In_reads_(count) const DirectX::SimpleMath::Rectangle* sizes,
+            size_t count,
+            _Out_writes_(count) uint32_t* ids,
+            _Out_writes_opt_(count) DirectX::SimpleMath::Rectangle* placed = nullptr);
+
+        bool Remove(uint32_t id);
+
+        // Repacks every live rectangle, keeping their ids; on failure the atlas is unchanged.
+        // Moves can overlap each other, so copy texels from a snapshot of the old atlas.
+        bool Defragment(_Out_opt_ std::vector<Move>* moves = nullptr);
+
+        void Clear();
+
+        bool IsValid(uint32_t id) const noexcept { return id < m_entries.size() && m_entries[id].width > 0; }
+
+        DirectX::SimpleMath::Rectangle Get(uint32_t id) const
+        {
+            if (!IsValid(id))
+                throw std::out_of_range("Invalid atlas id");
+
+            return m_entries[id];
+        }
+
+        long Width() const noexcept { return m_width; }
+        long Height() const noexcept { return m_height; }
+        Method GetMethod() const noexcept { return m_method; }
+        size_t Count() const noexcept { return m_count; }
+
+        // Texels covered by live rectangles (without padding), and as a fraction of the atlas
+        uint64_t UsedArea() const noexcept { return m_usedArea; }
+        float Occupancy() const noexcept
+        {
+            const uint64_t area = uint64_t(m_width) * uint64_t(m_height);
+            return (area > 0) ? float(double(m_usedArea) / double(area)) : 0.f;
+        }
+
+        // Smallest rectangle at the origin holding every live rectangle, for trimming the atlas
+        DirectX::SimpleMath::Rectangle UsedBounds() const noexcept;
+
+    private:
+        struct Segment
+        {
+            long x;
+            long y;
+            long width;
+        };
+
+        long                                        m_width;
+        long                                        m_height;
+        long                                        m_padding;
+        Method                                      m_method;
+        uint64_t                                    m_usedArea;
+        size_t                                      m_count;
+        std::vector<DirectX::SimpleMath::Rectangle> m_entries;  // By id; width 0 when free
+        std::vector<uint32_t>                       m_freeIds;
+        std::vector<DirectX::SimpleMath::Rectangle> m_free;     // MaxRects free rectangles
+        std::vector<Segment>                        m_skyline;  // Skyline segments, by x
+        std::vector<DirectX::SimpleMath::Rectangle> m_split;
+
+        void Reset();
+
+        bool Place(long width, long height, DirectX::SimpleMath::Rectangle& reserved);
+
+        bool FindMaxRects(long width, long height, DirectX::SimpleMath::Rectangle& node) const noexcept;
+        void SplitFree(const DirectX::SimpleMath::Rectangle& used);
+        void AddFree(DirectX::SimpleMath::Rectangle rect);
+
+        bool FitSkyline(size_t index, long width, long height, long& y) const noexcept;
+        bool FindSkyline(long width, long height, size_t& index, DirectX::SimpleMath::Rectangle& node) const noexcept;
+        void AddSkyline(size_t index, const DirectX::SimpleMath::Rectangle& node);
+
+        uint32_t AllocateId();
+
+        // Larger rectangles first: by height, then width, for both methods
+        static bool Larger(const DirectX::SimpleMath::Rectangle& a, const DirectX::SimpleMath::Rectangle& b) noexcept
+        {
+            if (a.height != b.height)
+                return a.height > b.height;
+            return a.width > b.width;
+        }
+    };
+
+
+    //==================================================================================
+    // Implementation
+    //==================================================================================
+
+    inline AtlasPacker::AtlasPacker(long width, long height, Method method, long padding) :
+        m_width(width),
+        m_height(height),
+        m_padding(padding),
+        m_method(method),
+        m_usedArea(0),
+        m_count(0)
+    {
+        if (width <= 0 || height <= 0)
+            throw std::invalid_argument("Atlas size must be positive");
+
+        if (padding < 0)
+            throw std::invalid_argument("Padding must not be negative");
+
+        if (method != Method::MaxRects && method != Method::Skyline)
+            throw std::invalid_argument("Unknown packing method");
+
+        Reset();
+    }
+
+    inline void AtlasPacker::Reset()
+    {
+        m_free.clear();
+        m_skyline.clear();
+        if (m_width > 0 && m_height > 0)
+        {
+            if (m_method == Method::MaxRects)
+            {
+                m_free.emplace_back(0, 0, m_width, m_height);
+            }
+            else
+            {
+                m_skyline.push_back(Segment{ 0, 0, m_width });
+            }
+        }
+    }
+
+    inline void AtlasPacker::Clear()
+    {
+        m_entries.clear();
+        m_freeIds.clear();
+        m_usedArea = 0;
+        m_count = 0;
+        Reset();
+    }
+
+    inline DirectX::SimpleMath::Rectangle AtlasPacker::UsedBounds() const noexcept
+    {
+        long right = 0;
+        long bottom = 0;
+        for (const auto& rect : m_entries)
+        {
+            if (rect.width > 0)
+            {
+                right = std::max(right, rect.x + rect.width);
+                bottom = std::max(bottom, rect.y + rect.height);
+            }
+        }
+        return DirectX::SimpleMath::Rectangle(0, 0, right, bottom);
+    }
+
+    //----------------------------------------------------------------------------------
+    // MaxRects: best short side fit, ties to the top-left
+    inline bool AtlasPacker::FindMaxRects(long width, long height, DirectX::SimpleMath::Rectangle& node) const noexcept
+    {
+        bool found = false;
+        long bestShort = LONG_MAX;
+        long bestLong = LONG_MAX;
+        for (const auto& free : m_free)
+        {
+            if (width > free.width || height > free.height)
+                continue;
+
+            const long leftoverX = free.width - width;
+            const long leftoverY = free.height - height;
+            const long shortSide = std::min(leftoverX, leftoverY);
+            const long longSide = std::max(leftoverX, leftoverY);
+
+            if (!found
+                || shortSide < bestShort
+                || (shortSide == bestShort && (longSide < bestLong
+                    || (longSide == bestLong && (free.y < node.y || (free.y == node.y && free.x < node.x))))))
+            {
+                node = DirectX::SimpleMath::Rectangle(free.x, free.y, width, height);
+                bestShort = shortSide;
+                bestLong = longSide;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    // Replaces every free rectangle overlapping 'used' with the (up to four) maximal pieces
+    // left around it, dropping pieces that lie inside another free rectangle
+    inline void AtlasPacker::SplitFree(const DirectX::SimpleMath::Rectangle& used)
+    {
+        m_split.clear();
+
+        const long usedRight = used.x + used.width;
+        const long usedBottom = used.y + used.height;
+        for (size_t j = 0; j < m_free.size();)
+        {
+            const DirectX::SimpleMath::Rectangle free = m_free[j];
+            if (!free.Intersects(used))
+            {
+                ++j;
+                continue;
+            }
+
+            const long freeRight = free.x + free.width;
+            const long freeBottom = free.y + free.height;
+            if (used.x > free.x)
+                m_split.emplace_back(free.x, free.y, used.x - free.x, free.height);
+            if (usedRight < freeRight)
+                m_split.emplace_back(usedRight, free.y, freeRight - usedRight, free.height);
+            if (used.y > free.y)
+                m_split.emplace_back(free.x, free.y, free.width, used.y - free.y);
+            if (usedBottom < freeBottom)
+                m_split.emplace_back(free.x, usedBottom, free.width, freeBottom - usedBottom);
+
+            m_free[j] = m_free.back();
+            m_free.pop_back();
+        }
+
+        // The untouched free rectangles never contain each other, and none of them can lie
+        // inside a new piece (which would put it inside the rectangle it was split from), so
+        // only the new pieces need checking
+        for (size_t j = 0; j < m_split.size(); ++j)
+        {
+            const auto& piece = m_split[j];
+            bool contained = false;
+            for (const auto& free : m_free)
+            {
+                if (free.Contains(piece))
+                {
+                    contained = true;
+                    break;
+                }
+            }
+
+            for (size_t k = 0; k < m_split.size() && !contained; ++k)
+            {
+                // Of two identical pieces, keep the first
+                if (k != j && m_split[k].Contains(piece) && (k < j || !piece.Contains(m_split[k])))
+                {
+                    contained = true;
+                }
+            }
+
+            if (!contained)
+            {
+                m_free.push_back(piece);
+            }
+        }
+    }
+
+    // Returns a removed rectangle to the free list, merged with free neighbors sharing a full edge
+    inline void AtlasPacker::AddFree(DirectX::SimpleMath::Rectangle rect)
+    {
+        for (bool merged = true; merged;)
+        {
+            merged = false;
+            for (size_t j = 0; j < m_free.size(); ++j)
+            {
+                const auto& free = m_free[j];
+                const bool column = (free.x == rect.x && free.width == rect.width)
+                    && (free.y + free.height == rect.y || rect.y + rect.height == free.y);
+                const bool row = (free.y == rect.y && free.height == rect.height)
+                    && (free.x + free.width == rect.x || rect.x + rect.width == free.x);
+                if (column || row)
+                {
+                    const long x = std::min(free.x, rect.x);
+                    const long y = std::min(free.y, rect.y);
+                    rect = DirectX::SimpleMath::Rectangle(x, y,
+                        std::max(free.x + free.width, rect.x + rect.width) - x,
+                        std::max(free.y + free.height, rect.y + rect.height) - y);
+
+                    m_free[j] = m_free.back();
+                    m_free.pop_back();
+                    merged = true;
+                    break;
+                }
+            }
+        }
+
+        for (size_t j = 0; j < m_free.size();)
+        {
+            if (m_free[j].Contains(rect))
+                return;
+
+            if (rect.Contains(m_free[j]))
+            {
+                m_free[j] = m_free.back();
+                m_free.pop_back();
+                continue;
+            }
+            ++j;
+        }
+        m_free.push_back(rect);
+    }
+
+    //----------------------------------------------------------------------------------
+    // Skyline: lowest top edge, ties to the left
+    inline bool AtlasPacker::FitSkyline(size_t index, long width, long height, long& y) const noexcept
+    {
+        if (m_skyline[index].x + width > m_width)
+            return false;
+
+        y = 0;
+        for (long remaining = width; remaining > 0; ++index)
+        {
+            const Segment& segment = m_skyline[index];
+            y = std::max(y, segment.y);
+            if (y + height > m_height)
+                return false;
+            remaining -= segment.width;
+        }
+        return true;
+    }
+
+    inline bool AtlasPacker::FindSkyline(long width, long height, size_t& index, DirectX::SimpleMath::Rectangle& node) const noexcept
+    {
+        bool found = false;
+        long bestTop = LONG_MAX;
+        for (size_t j = 0; j < m_skyline.size(); ++j)
+        {
+            // Nothing starting on a segment this high can beat the best so far
+            if (m_skyline[j].y + height >= bestTop)
+                continue;
+
+            long y;
+            if (FitSkyline(j, width, height, y) && y + height < bestTop)
+            {
+                node = DirectX::SimpleMath::Rectangle(m_skyline[j].x, y, width, height);
+                bestTop = y + height;
+                index = j;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    inline void AtlasPacker::AddSkyline(size_t index, const DirectX::SimpleMath::Rectangle& node)
+    {
+        m_skyline.insert(m_skyline.begin() + ptrdiff_t(index), Segment{ node.x, node.y + node.height, node.width });
+
+        // Trim the segments now underneath the new one
+        const long right = node.x + node.width;
+        for (size_t j = index + 1; j < m_skyline.size();)
+        {
+            Segment& segment = m_skyline[j];
+            if (segment.x >= right)
+                break;
+
+            const long shrink = right - segment.x;
+            if (segment.width <= shrink)
+            {
+                m_skyline.erase(m_skyline.begin() + ptrdiff_t(j));
+                continue;
+            }
+
+            segment.x += shrink;
+            segment.width -= shrink;
+            break;
+        }
+
+        // Merge neighbors at the same height
+        for (size_t j = 0; j + 1 < m_skyline.size();)
+        {
+            if (m_skyline[j].y == m_skyline[j + 1].y)
+            {
+                m_skyline[j].width += m_skyline[j + 1].width;
+                m_skyline.erase(m_skyline.begin() + ptrdiff_t(j + 1));
+                continue;
+            }
+            ++j;
+        }
+    }
+
+    //----------------------------------------------------------------------------------
+    inline bool AtlasPacker::Place(long width, long height, DirectX::SimpleMath::Rectangle& reserved)
+    {
+        if (width > m_width - m_padding || height > m_height - m_padding)
+            return false;
+
+        const long paddedWidth = width + m_padding;
+        const long paddedHeight = height + m_padding;
+
+        if (m_method == Method::MaxRects)
+        {
+            if (!FindMaxRects(paddedWidth, paddedHeight, reserved))
+                return false;
+
+            SplitFree(reserved);
+        }
+        else
+        {
+            size_t index = 0;
+            if (!FindSkyline(paddedWidth, paddedHeight, index, reserved))
+                return false;
+
+            AddSkyline(index, reserved);
+        }
+        return true;
+    }
+
+    inline uint32_t AtlasPacker::AllocateId()
+    {
+        if (!m_freeIds.empty())
+        {
+            const uint32_t id = m_freeIds.back();
+            m_freeIds.pop_back();
+            return id;
+        }
+
+        if (m_entries.size() >= c_Invalid)
+            throw std::out_of_range("Too many atlas entries");
+
+        m_entries.emplace_back(0, 0, 0, 0);
+        return static_cast<uint32_t>(m_entries.size() - 1);
+    }
+
+    inline bool AtlasPacker::Insert(long width, long height, uint32_t& id, DirectX::SimpleMath::Rectangle& placed)
+    {
+        if (width <= 0 || height <= 0)
+            throw std::invalid_argument("Rectangle size must be positive");
+
+        id = c_Invalid;
+
+        DirectX::SimpleMath::Rectangle reserved;
+        if (!Place(width, height, reserved))
+            return false;
+
+        id = AllocateId();
+        placed = DirectX::SimpleMath::Rectangle(reserved.x, reserved.y, width, height);
+        m_entries[id] = placed;
+        m_usedArea += uint64_t(width) * uint64_t(height);
+        ++m_count;
+        return true;
+    }
+
+    inline size_t AtlasPacker::Insert(
+        const DirectX::SimpleMath::Rectangle* sizes,
+        size_t count,
+        uint32_t* ids,
+        DirectX::SimpleMath::Rectangle* placed)
+    {
+        if (count > 0 && (!sizes || !ids))
+            throw std::invalid_argument("Invalid arguments");
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            if (sizes[j].width <= 0 || sizes[j].height <= 0)
+                throw std::invalid_argument("Rectangle size must be positive");
+        }
+
+        std::vector<uint32_t> order(count);
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [sizes](uint32_t a, uint32_t b) { return Larger(sizes[a], sizes[b]); });
+
+        size_t result = 0;
+        for (const uint32_t j : order)
+        {
+            DirectX::SimpleMath::Rectangle rect;
+            if (Insert(sizes[j].width, sizes[j].height, ids[j], rect))
+            {
+                ++result;
+            }
+
+            if (placed)
+            {
+                placed[j] = rect;
+            }
+        }
+        return result;
+    }
+
+    inline bool AtlasPacker::Remove(uint32_t id)
+    {
+        if (!IsValid(id))
+            return false;
+
+        m_freeIds.push_back(id);
+
+        DirectX::SimpleMath::Rectangle& rect = m_entries[id];
+        if (m_method == Method::MaxRects)
+        {
+            AddFree(DirectX::SimpleMath::Rectangle(rect.x, rect.y, rect.width + m_padding, rect.height + m_padding));
+        }
+
+        m_usedArea -= uint64_t(rect.width) * uint64_t(rect.height);
+        --m_count;
+        rect = DirectX::SimpleMath::Rectangle(0, 0, 0, 0);
+        return true;
+    }
+
+    inline bool AtlasPacker::Defragment(std::vector<Move>* moves)
+    {
+        std::vector<uint32_t> live;
+        live.reserve(m_count);
+        for (size_t j = 0; j < m_entries.size(); ++j)
+        {
+            if (m_entries[j].width > 0)
+            {
+                live.push_back(static_cast<uint32_t>(j));
+            }
+        }
+
+        std::stable_sort(live.begin(), live.end(), [this](uint32_t a, uint32_t b) { return Larger(m_entries[a], m_entries[b]); });
+
+        // Pack into a fresh copy so that a failed repack leaves this one untouched
+        AtlasPacker packed(*this);
+        packed.Reset();
+
+        std::vector<DirectX::SimpleMath::Rectangle> placed(live.size());
+        for (size_t j = 0; j < live.size(); ++j)
+        {
+            const auto& rect = m_entries[live[j]];
+            DirectX::SimpleMath::Rectangle reserved;
+            if (!packed.Place(rect.width, rect.height, reserved))
+                return false;
+
+            placed[j] = DirectX::SimpleMath::Rectangle(reserved.x, reserved.y, rect.width, rect.height);
+        }
+
+        if (moves)
+        {
+            moves->clear();
+            for (size_t j = 0; j < live.size(); ++j)
+            {
+                const auto& from = m_entries[live[j]];
+                if (from.x != placed[j].x || from.y != placed[j].y)
+                {
+                    moves->push_back(Move{ live[j], from, placed[j] });
+                }
+            }
+        }
+
+        for (size_t j = 0; j < live.size(); ++j)
+        {
+            packed.m_entries[live[j]] = placed[j];
+        }
+
+        *this = std::move(packed);
+        return true;
+    }
+}
@@ -0,0 +1,531 @@
+//--------------------------------------------------------------------------------------
+// File: AudioSpatializer.h
+//
+// Portable CPU reference for 3D positional audio
+//
+// Computes the per-emitter output channel matrix, Doppler factor, LPF coefficient, and
+// reverb send level for a batch of emitters against a single listener. Emitters are
+// passed in structure-of-arrays layout and evaluated four at a time using DirectXMath,
+// so it has no dependency on X3DAudio and builds anywhere DirectXMath does.
+//
+// This is a reference model of the behavior exercised through AudioEmitter/AudioListener,
+// not a bit-exact reimplementation of X3DAudioCalculate:
+//  - Panning is pairwise constant-power between adjacent speakers sorted by azimuth
+//  - Within an emitter's inner radius the signal blends toward all speakers equally
+//  - Volume, LFE, LPF, and reverb distance curves use the distance divided by the
+//    batch's CurveDistanceScaler
+//  - Cone volume and reverb values scale the result; cone LPF values are added
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+
+namespace DX
+{
+    // Speaker positions use the same bits as WAVEFORMATEXTENSIBLE::dwChannelMask
+    enum SPATIAL_SPEAKER : uint32_t
+    {
+        SpatialSpeaker_FrontLeft = 0x1,
+        SpatialSpeaker_FrontRight = 0x2,
+        SpatialSpeaker_FrontCenter = 0x4,
+        SpatialSpeaker_LowFrequency = 0x8,
+        SpatialSpeaker_BackLeft = 0x10,
+        SpatialSpeaker_BackRight = 0x20,
+        SpatialSpeaker_FrontLeftOfCenter = 0x40,
+        SpatialSpeaker_FrontRightOfCenter = 0x80,
+        SpatialSpeaker_BackCenter = 0x100,
+        SpatialSpeaker_SideLeft = 0x200,
+        SpatialSpeaker_SideRight = 0x400,
+
+        SpatialSpeaker_Mono = SpatialSpeaker_FrontCenter,
+        SpatialSpeaker_Stereo = SpatialSpeaker_FrontLeft | SpatialSpeaker_FrontRight,
+        SpatialSpeaker_Quad = SpatialSpeaker_Stereo | SpatialSpeaker_BackLeft | SpatialSpeaker_BackRight,
+        SpatialSpeaker_5Point1 = SpatialSpeaker_Quad | SpatialSpeaker_FrontCenter | SpatialSpeaker_LowFrequency,
+        SpatialSpeaker_7Point1Surround = SpatialSpeaker_5Point1 | SpatialSpeaker_SideLeft | SpatialSpeaker_SideRight,
+    };
+
+    // Same layout as X3DAUDIO_CONE. Angles are the full cone angle in radians.
+    struct SpatialCone
+    {
+        float innerAngle;
+        float outerAngle;
+        float innerVolume;
+        float outerVolume;
+        float innerLPF;
+        float outerLPF;
+        float innerReverb;
+        float outerReverb;
+    };
+
+    // Same layout as X3DAUDIO_DISTANCE_CURVE_POINT / X3DAUDIO_DISTANCE_CURVE
+    struct SpatialCurvePoint
+    {
+        float distance;
+        float dspSetting;
+    };
+
+    struct SpatialCurve
+    {
+        const SpatialCurvePoint*    points;
+        uint32_t                    pointCount;
+    };
+
+    struct SpatialListener
+    {
+        DirectX::XMFLOAT3   position;
+        DirectX::XMFLOAT3   orientFront;
+        DirectX::XMFLOAT3   orientTop;
+        DirectX::XMFLOAT3   velocity;
+        const SpatialCone*  pCone;
+    };
+
+    // Per-emitter values are arrays of 'count' floats. Optional arrays may be null.
+    struct SpatialEmitters
+    {
+        size_t              count;
+
+        const float*        positionX;
+        const float*        positionY;
+        const float*        positionZ;
+
+        const float*        velocityX;              // Optional, defaults to zero
+        const float*        velocityY;
+        const float*        velocityZ;
+
+        const float*        orientFrontX;           // Required if pCone is set
+        const float*        orientFrontY;
+        const float*        orientFrontZ;
+
+        const float*        innerRadius;            // Optional, defaults to zero
+
+        // Shared by all emitters in the batch
+        float               curveDistanceScaler;
+        float               dopplerScaler;
+        const SpatialCone*  pCone;
+        const SpatialCurve* pVolumeCurve;           // Inverse distance if null
+        const SpatialCurve* pLFECurve;              // Inverse distance if null
+        const SpatialCurve* pLPFDirectCurve;        // No filtering if null
+        const SpatialCurve* pReverbCurve;           // Full send if null
+    };
+
+    // 'matrix' holds one row of 'stride' floats per output channel, so matrix[c * stride + i]
+    // is the level of emitter i in channel c. All other outputs are optional.
+    struct SpatialResults
+    {
+        float*  matrix;
+        size_t  stride;
+        float*  doppler;
+        float*  lpfDirect;                          // 0 is unfiltered, 1 is fully filtered
+        float*  reverbLevel;
+        float*  distance;
+    };
+
+    class AudioSpatializer
+    {
+    public:
+        static constexpr float c_DefaultSpeedOfSound = 343.5f;
+
+        explicit AudioSpatializer(uint32_t channelMask, float speedOfSound = c_DefaultSpeedOfSound) noexcept(false) :
+            m_channelMask(channelMask),
+            m_channelCount(0),
+            m_speakerCount(0),
+            m_lfeChannel(-1),
+            m_speedOfSound(speedOfSound),
+            m_speakers{}
+        {
+            if (!channelMask || (channelMask & ~0x7FFu) != 0)
+                throw std::invalid_argument("Unsupported channel mask");
+
+            if (!(speedOfSound > 0.f))
+                throw std::invalid_argument("Speed of sound must be positive");
+
+            using namespace DirectX;
+
+            // Azimuths are clockwise from the front
+            static const float s_azimuths[11] =
+            {
+                -XM_PIDIV4,             // FrontLeft
+                XM_PIDIV4,              // FrontRight
+                0.f,                    // FrontCenter
+                0.f,                    // LowFrequency
+                -3.f * XM_PIDIV4,       // BackLeft
+                3.f * XM_PIDIV4,        // BackRight
+                -XM_PI / 8.f,           // FrontLeftOfCenter
+                XM_PI / 8.f,            // FrontRightOfCenter
+                XM_PI,                  // BackCenter
+                -XM_PIDIV2,             // SideLeft
+                XM_PIDIV2,              // SideRight
+            };
+
+            for (uint32_t bit = 0; bit < 11; ++bit)
+            {
+                if (!(channelMask & (1u << bit)))
+                    continue;
+
+                if ((1u << bit) == SpatialSpeaker_LowFrequency)
+                {
+                    m_lfeChannel = int(m_channelCount);
+                }
+                else
+                {
+                    Speaker& spk = m_speakers[m_speakerCount++];
+                    spk.channel = m_channelCount;
+                    spk.azimuth = s_azimuths[bit];
+                }
+
+                ++m_channelCount;
+            }
+
+            if (!m_speakerCount)
+                throw std::invalid_argument("Channel mask has no positional speakers");
+
+            std::sort(m_speakers, m_speakers + m_speakerCount,
+                [](const Speaker& a, const Speaker& b) noexcept { return a.azimuth < b.azimuth; });
+
+            // Arc to the neighboring speaker in each direction, wrapping around behind the listener
+            for (uint32_t j = 0; j < m_speakerCount; ++j)
+            {
+                const Speaker& next = m_speakers[(j + 1) % m_speakerCount];
+                float arc = next.azimuth - m_speakers[j].azimuth;
+                if (arc <= 0.f)
+                    arc += XM_2PI;
+
+                m_speakers[j].arcNext = arc;
+                m_speakers[(j + 1) % m_speakerCount].arcPrev = arc;
+            }
+        }
+
+        AudioSpatializer(AudioSpatializer&&) = default;
+        AudioSpatializer& operator= (AudioSpatializer&&) = default;
+
+        AudioSpatializer(AudioSpatializer const&) = default;
+        AudioSpatializer& operator= (AudioSpatializer const&) = default;
+
+        uint32_t GetChannelMask() const noexcept { return m_channelMask; }
+        uint32_t GetChannelCount() const noexcept { return m_channelCount; }
+
+        // Returns the output channel index of the LFE speaker, or -1 if there is none.
+        int GetLFEChannel() const noexcept { return m_lfeChannel; }
+
+        void Calculate(
+            const SpatialListener& listener,
+            const SpatialEmitters& emitters,
+            const SpatialResults& results,
+            bool rhcoords = true) const
+        {
+            using namespace DirectX;
+
+            if (!emitters.count)
+                return;
+
+            if (!emitters.positionX || !emitters.positionY || !emitters.positionZ)
+                throw std::invalid_argument("Emitter positions are required");
+
+            if (emitters.pCone && (!emitters.orientFrontX || !emitters.orientFrontY || !emitters.orientFrontZ))
+                throw std::invalid_argument("Emitter cones require orientations");
+
+            if (!results.matrix || results.stride < emitters.count)
+                throw std::invalid_argument("Invalid channel matrix");
+
+            ValidateCurve(emitters.pVolumeCurve);
+            ValidateCurve(emitters.pLFECurve);
+            ValidateCurve(emitters.pLPFDirectCurve);
+            ValidateCurve(emitters.pReverbCurve);
+
+            // Listener basis
+            const XMVECTOR front = XMVector3Normalize(XMLoadFloat3(&listener.orientFront));
+            const XMVECTOR top = XMLoadFloat3(&listener.orientTop);
+            const XMVECTOR right = XMVector3Normalize(rhcoords ? XMVector3Cross(front, top) : XMVector3Cross(top, front));
+
+            const XMVECTOR lposX = XMVectorReplicate(listener.position.x);
+            const XMVECTOR lposY = XMVectorReplicate(listener.position.y);
+            const XMVECTOR lposZ = XMVectorReplicate(listener.position.z);
+
+            const XMVECTOR frontX = XMVectorSplatX(front);
+            const XMVECTOR frontY = XMVectorSplatY(front);
+            const XMVECTOR frontZ = XMVectorSplatZ(front);
+
+            const XMVECTOR rightX = XMVectorSplatX(right);
+            const XMVECTOR rightY = XMVectorSplatY(right);
+            const XMVECTOR rightZ = XMVectorSplatZ(right);
+
+            const XMVECTOR lvelX = XMVectorReplicate(listener.velocity.x);
+            const XMVECTOR lvelY = XMVectorReplicate(listener.velocity.y);
+            const XMVECTOR lvelZ = XMVectorReplicate(listener.velocity.z);
+
+            const float curveScale = (emitters.curveDistanceScaler > 0.f) ? 1.f / emitters.curveDistanceScaler : 1.f;
+
+            // Scaled velocities are limited to half the speed of sound so the factor stays in [1/3, 3]
+            const XMVECTOR speedOfSound = XMVectorReplicate(m_speedOfSound);
+            const XMVECTOR maxVelocity = XMVectorReplicate(m_speedOfSound * 0.5f);
+            const XMVECTOR minVelocity = XMVectorNegate(maxVelocity);
+
+            const XMVECTOR omniGain = XMVectorReplicate(1.f / std::sqrt(float(m_speakerCount)));
+
+            static const XMVECTORF32 s_epsilon = { { { 1e-6f, 1e-6f, 1e-6f, 1e-6f } } };
+            static const XMVECTORF32 s_halfPi = { { { XM_PIDIV2, XM_PIDIV2, XM_PIDIV2, XM_PIDIV2 } } };
+
+            for (size_t i = 0; i < emitters.count; i += 4)
+            {
+                const size_t n = std::min<size_t>(4, emitters.count - i);
+
+                // Emitter to listener
+                XMVECTOR dx = XMVectorSubtract(Load(emitters.positionX, i, n, 0.f), lposX);
+                XMVECTOR dy = XMVectorSubtract(Load(emitters.positionY, i, n, 0.f), lposY);
+                XMVECTOR dz = XMVectorSubtract(Load(emitters.positionZ, i, n, 0.f), lposZ);
+
+                const XMVECTOR dist = XMVectorSqrt(XMVectorMultiplyAdd(dx, dx, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dz, dz))));
+                const XMVECTOR coincident = XMVectorLess(dist, s_epsilon);
+
+                // Unit direction from the listener to the emitter (zero when coincident)
+                const XMVECTOR invDist = XMVectorSelect(XMVectorReciprocal(dist), g_XMZero, coincident);
+                dx = XMVectorMultiply(dx, invDist);
+                dy = XMVectorMultiply(dy, invDist);
+                dz = XMVectorMultiply(dz, invDist);
+
+                // Azimuth in listener space, clockwise from the front
+                const XMVECTOR localX = Dot(dx, dy, dz, rightX, rightY, rightZ);
+                const XMVECTOR localZ = Dot(dx, dy, dz, frontX, frontY, frontZ);
+                const XMVECTOR azimuth = XMVectorSelect(XMVectorATan2(localX, localZ), g_XMZero, coincident);
+
+                const XMVECTOR curveDist = XMVectorScale(dist, curveScale);
+
+                XMVECTOR volume = Attenuation(emitters.pVolumeCurve, curveDist);
+                XMVECTOR lfe = Attenuation(emitters.pLFECurve, curveDist);
+                XMVECTOR lpf = emitters.pLPFDirectCurve ? EvaluateCurve(*emitters.pLPFDirectCurve, curveDist) : g_XMZero;
+                XMVECTOR reverb = emitters.pReverbCurve ? EvaluateCurve(*emitters.pReverbCurve, curveDist) : g_XMOne;
+
+                if (listener.pCone)
+                {
+                    // A coincident emitter is treated as directly in front
+                    const XMVECTOR cosAngle = XMVectorSelect(localZ, g_XMOne, coincident);
+                    EvaluateCone(*listener.pCone, cosAngle, volume, lpf, reverb);
+                }
+
+                if (emitters.pCone)
+                {
+                    const XMVECTOR ex = Load(emitters.orientFrontX, i, n, 0.f);
+                    const XMVECTOR ey = Load(emitters.orientFrontY, i, n, 0.f);
+                    const XMVECTOR ez = Load(emitters.orientFrontZ, i, n, -1.f);
+                    const XMVECTOR elen = XMVectorSqrt(Dot(ex, ey, ez, ex, ey, ez));
+                    const XMVECTOR einv = XMVectorSelect(XMVectorReciprocal(elen), g_XMZero, XMVectorLess(elen, s_epsilon));
+
+                    // Direction from the emitter back to the listener is the negated direction
+                    XMVECTOR cosAngle = XMVectorNegate(XMVectorMultiply(Dot(dx, dy, dz, ex, ey, ez), einv));
+                    cosAngle = XMVectorSelect(cosAngle, g_XMOne, coincident);
+                    EvaluateCone(*emitters.pCone, cosAngle, volume, lpf, reverb);
+                }
+
+                // Blend toward an omnidirectional spread inside the inner radius
+                XMVECTOR panWeight = g_XMOne;
+                if (emitters.innerRadius)
+                {
+                    const XMVECTOR radius = Load(emitters.innerRadius, i, n, 0.f);
+                    panWeight = XMVectorSelect(
+                        XMVectorSaturate(XMVectorDivide(dist, XMVectorMax(radius, s_epsilon))),
+                        g_XMOne,
+                        XMVectorLess(radius, s_epsilon));
+                }
+                panWeight = XMVectorSelect(panWeight, g_XMZero, coincident);
+
+                for (uint32_t j = 0; j < m_speakerCount; ++j)
+                {
+                    const Speaker& spk = m_speakers[j];
+                    const XMVECTOR spkAzimuth = XMVectorReplicate(spk.azimuth);
+
+                    // Arc from this speaker clockwise to the emitter, and counter-clockwise
+                    const XMVECTOR cw = WrapTwoPi(XMVectorSubtract(azimuth, spkAzimuth));
+                    const XMVECTOR ccw = WrapTwoPi(XMVectorSubtract(spkAzimuth, azimuth));
+
+                    const XMVECTOR arcNext = XMVectorReplicate(spk.arcNext);
+                    const XMVECTOR arcPrev = XMVectorReplicate(spk.arcPrev);
+
+                    const XMVECTOR gainNext = XMVectorCos(XMVectorMultiply(XMVectorDivide(cw, arcNext), s_halfPi));
+                    const XMVECTOR gainPrev = XMVectorCos(XMVectorMultiply(XMVectorDivide(ccw, arcPrev), s_halfPi));
+
+                    XMVECTOR gain = (m_speakerCount > 1)
+                        ? XMVectorSelect(
+                            XMVectorSelect(g_XMZero, gainPrev, XMVectorLess(ccw, arcPrev)),
+                            gainNext,
+                            XMVectorLess(cw, arcNext))
+                        : g_XMOne;
+
+                    gain = XMVectorLerpV(omniGain, gain, panWeight);
+                    gain = XMVectorMax(gain, g_XMZero);
+
+                    Store(results.matrix + size_t(spk.channel) * results.stride, i, n, XMVectorMultiply(gain, volume));
+                }
+
+                if (m_lfeChannel >= 0)
+                {
+                    Store(results.matrix + size_t(m_lfeChannel) * results.stride, i, n, lfe);
+                }
+
+                if (results.doppler)
+                {
+                    // Velocity components along the listener-to-emitter axis
+                    const XMVECTOR lvel = Dot(dx, dy, dz, lvelX, lvelY, lvelZ);
+                    const XMVECTOR evel = Dot(dx, dy, dz,
+                        Load(emitters.velocityX, i, n, 0.f),
+                        Load(emitters.velocityY, i, n, 0.f),
+                        Load(emitters.velocityZ, i, n, 0.f));
+
+                    const XMVECTOR scaler = XMVectorReplicate(emitters.dopplerScaler);
+                    const XMVECTOR vl = XMVectorClamp(XMVectorMultiply(lvel, scaler), minVelocity, maxVelocity);
+                    const XMVECTOR ve = XMVectorClamp(XMVectorMultiply(evel, scaler), minVelocity, maxVelocity);
+
+                    // Positive components move the listener toward the emitter, and the emitter away from the listener
+                    XMVECTOR doppler = XMVectorDivide(XMVectorAdd(speedOfSound, vl), XMVectorAdd(speedOfSound, ve));
+                    doppler = XMVectorSelect(doppler, g_XMOne, coincident);
+                    Store(results.doppler, i, n, doppler);
+                }
+
+                Store(results.lpfDirect, i, n, XMVectorSaturate(lpf));
+                Store(results.reverbLevel, i, n, reverb);
+                Store(results.distance, i, n, dist);
+            }
+        }
+
+    private:
+        struct Speaker
+        {
+            uint32_t    channel;
+            float       azimuth;
+            float       arcNext;
+            float       arcPrev;
+        };
+
+        static void ValidateCurve(const SpatialCurve* curve)
+        {
+            if (curve && (!curve->points || !curve->pointCount))
+                throw std::invalid_argument("Invalid distance curve");
+        }
+
+        static DirectX::XMVECTOR XM_CALLCONV Load(_In_opt_ const float* ptr, size_t index, size_t count, float defaultValue) noexcept
+        {
+            using namespace DirectX;
+
+            if (!ptr)
+                return XMVectorReplicate(defaultValue);
+
+            if (count == 4)
+                return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(ptr + index));
+
+            XMFLOAT4A tail(defaultValue, defaultValue, defaultValue, defaultValue);
+            memcpy(&tail, ptr + index, count * sizeof(float));
+            return XMLoadFloat4A(&tail);
+        }
+
+        static void XM_CALLCONV Store(_In_opt_ float* ptr, size_t index, size_t count, DirectX::FXMVECTOR value) noexcept
+        {
+            using namespace DirectX;
+
+            if (!ptr)
+                return;
+
+            if (count == 4)
+            {
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(ptr + index), value);
+                return;
+            }
+
+            XMFLOAT4A tail;
+            XMStoreFloat4A(&tail, value);
+            memcpy(ptr + index, &tail, count * sizeof(float));
+        }
+
+        static DirectX::XMVECTOR XM_CALLCONV Dot(
+            DirectX::FXMVECTOR ax, DirectX::FXMVECTOR ay, DirectX::FXMVECTOR az,
+            DirectX::GXMVECTOR bx, DirectX::HXMVECTOR by, DirectX::HXMVECTOR bz) noexcept
+        {
+            using namespace DirectX;
+            return XMVectorMultiplyAdd(ax, bx, XMVectorMultiplyAdd(ay, by, XMVectorMultiply(az, bz)));
+        }
+
+        // Wraps to [0, 2pi)
+        static DirectX::XMVECTOR XM_CALLCONV WrapTwoPi(DirectX::FXMVECTOR angle) noexcept
+        {
+            using namespace DirectX;
+            const XMVECTOR turns = XMVectorFloor(XMVectorMultiply(angle, g_XMReciprocalTwoPi));
+            return XMVectorNegativeMultiplySubtract(turns, g_XMTwoPi, angle);
+        }
+
+        // Inverse distance, 1 / max(d, 1), when no curve is provided: no attenuation inside the curve distance scaler
+        static DirectX::XMVECTOR XM_CALLCONV Attenuation(_In_opt_ const SpatialCurve* curve, DirectX::FXMVECTOR distance) noexcept
+        {
+            using namespace DirectX;
+
+            if (curve)
+                return EvaluateCurve(*curve, distance);
+
+            return XMVectorReciprocal(XMVectorMax(distance, g_XMOne));
+        }
+
+        // Piecewise linear; clamps to the first and last points
+        static DirectX::XMVECTOR XM_CALLCONV EvaluateCurve(const SpatialCurve& curve, DirectX::FXMVECTOR distance) noexcept
+        {
+            using namespace DirectX;
+
+            XMVECTOR result = XMVectorReplicate(curve.points[0].dspSetting);
+            for (uint32_t j = 1; j < curve.pointCount; ++j)
+            {
+                const SpatialCurvePoint& p0 = curve.points[j - 1];
+                const SpatialCurvePoint& p1 = curve.points[j];
+
+                const XMVECTOR start = XMVectorReplicate(p0.distance);
+                const float span = p1.distance - p0.distance;
+
+                const XMVECTOR t = (span > 0.f)
+                    ? XMVectorSaturate(XMVectorScale(XMVectorSubtract(distance, start), 1.f / span))
+                    : g_XMOne;
+
+                const XMVECTOR value = XMVectorLerpV(XMVectorReplicate(p0.dspSetting), XMVectorReplicate(p1.dspSetting), t);
+                result = XMVectorSelect(result, value, XMVectorGreaterOrEqual(distance, start));
+            }
+
+            return result;
+        }
+
+        static void XM_CALLCONV EvaluateCone(
+            const SpatialCone& cone,
+            DirectX::FXMVECTOR cosAngle,
+            DirectX::XMVECTOR& volume,
+            DirectX::XMVECTOR& lpf,
+            DirectX::XMVECTOR& reverb) noexcept
+        {
+            using namespace DirectX;
+
+            // Cone angles are full angles, so compare against twice the off-axis angle
+            const XMVECTOR angle = XMVectorScale(XMVectorACos(XMVectorClamp(cosAngle, g_XMNegativeOne, g_XMOne)), 2.f);
+            const XMVECTOR inner = XMVectorReplicate(cone.innerAngle);
+            const float span = cone.outerAngle - cone.innerAngle;
+
+            const XMVECTOR t = (span > 0.f)
+                ? XMVectorSaturate(XMVectorScale(XMVectorSubtract(angle, inner), 1.f / span))
+                : XMVectorSelect(g_XMZero, g_XMOne, XMVectorGreater(angle, inner));
+
+            volume = XMVectorMultiply(volume, XMVectorLerpV(XMVectorReplicate(cone.innerVolume), XMVectorReplicate(cone.outerVolume), t));
+            lpf = XMVectorAdd(lpf, XMVectorLerpV(XMVectorReplicate(cone.innerLPF), XMVectorReplicate(cone.outerLPF), t));
+            reverb = XMVectorMultiply(reverb, XMVectorLerpV(XMVectorReplicate(cone.innerReverb), XMVectorReplicate(cone.outerReverb), t));
+        }
+
+        uint32_t    m_channelMask;
+        uint32_t    m_channelCount;
+        uint32_t    m_speakerCount;
+        int         m_lfeChannel;
+        float       m_speedOfSound;
+        Speaker     m_speakers[11];
+    };
+}
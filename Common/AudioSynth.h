@@ -0,0 +1,391 @@
+//--------------------------------------------------------------------------------------
+// File: AudioSynth.h
+//
+// Simple procedural tone generator for use with DynamicSoundEffectInstance
+//
+// Generates mono sine, square, sawtooth, and noise waveforms with an optional ADSR
+// envelope directly into caller-provided float or 16-bit PCM buffers. The oscillators
+// are evaluated four samples at a time using DirectXMath.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+
+namespace DX
+{
+    enum class Waveform : uint32_t
+    {
+        Sine = 0,
+        Square,
+        Sawtooth,
+        Noise,
+    };
+
+    // Times are in seconds, sustain is a level in the range 0 to 1.
+    struct ADSREnvelope
+    {
+        float attack;
+        float decay;
+        float sustain;
+        float release;
+    };
+
+    class ToneGenerator
+    {
+    public:
+        ToneGenerator(uint32_t sampleRate, Waveform waveform, float frequency, float amplitude = 1.f) noexcept(false) :
+            m_sampleRate(sampleRate),
+            m_waveform(waveform),
+            m_amplitude(amplitude),
+            m_phase(0.f),
+            m_phaseStep(0.f),
+            m_envelope{},
+            m_useEnvelope(false),
+            m_stage(Stage::Off),
+            m_level(1.f),
+            m_releaseStep(0.f),
+            m_noiseState{ 0x9E3779B9u, 0x7F4A7C15u, 0x6A09E667u, 0xBB67AE85u },
+            m_pending{},
+            m_pendingOffset(4)
+        {
+            if (!sampleRate)
+                throw std::invalid_argument("ToneGenerator");
+
+            SetFrequency(frequency);
+        }
+
+        ToneGenerator(ToneGenerator&&) = default;
+        ToneGenerator& operator= (ToneGenerator&&) = default;
+
+        ToneGenerator(ToneGenerator const&) = default;
+        ToneGenerator& operator= (ToneGenerator const&) = default;
+
+        void SetFrequency(float frequency) noexcept
+        {
+            m_phaseStep = std::max(0.f, frequency) / float(m_sampleRate);
+        }
+
+        void SetAmplitude(float amplitude) noexcept { m_amplitude = amplitude; }
+
+        // Enables the envelope and restarts it at the attack stage.
+        void SetEnvelope(const ADSREnvelope& envelope) noexcept
+        {
+            m_envelope = envelope;
+            m_useEnvelope = true;
+            NoteOn();
+        }
+
+        void NoteOn() noexcept
+        {
+            if (!m_useEnvelope)
+                return;
+
+            m_level = 0.f;
+            m_stage = Stage::Attack;
+        }
+
+        void NoteOff() noexcept
+        {
+            if (!m_useEnvelope || m_stage == Stage::Off)
+                return;
+
+            const float samples = m_envelope.release * float(m_sampleRate);
+            m_releaseStep = (samples > 0.f) ? -m_level / samples : -m_level;
+            m_stage = Stage::Release;
+        }
+
+        // Returns true once the envelope has finished its release stage.
+        bool IsFinished() const noexcept { return m_useEnvelope && m_stage == Stage::Off; }
+
+        void Reset() noexcept
+        {
+            m_phase = 0.f;
+            m_pendingOffset = 4;
+            if (m_useEnvelope)
+            {
+                NoteOn();
+            }
+        }
+
+        // Generates 'count' mono samples in the range [-amplitude, amplitude].
+        //
+        // Samples are computed in blocks of 4. When 'count' ends partway through a block, the
+        // rest of that block is returned first by the next call, so the output is continuous
+        // across any buffer sizes. Changes to frequency, amplitude, or note state take effect
+        // after those (at most 3) leftover samples.
+        void Generate(_Out_writes_(count) float* output, size_t count) noexcept
+        {
+            using namespace DirectX;
+
+            const float* pending = &m_pending.x;
+            size_t j = 0;
+            for (; j < count && m_pendingOffset < 4; ++j)
+            {
+                output[j] = pending[m_pendingOffset++];
+            }
+
+            for (; j + 4 <= count; j += 4)
+            {
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(output + j), NextBlock());
+            }
+
+            if (j < count)
+            {
+                XMStoreFloat4A(&m_pending, NextBlock());
+                for (m_pendingOffset = 0; j < count; ++j)
+                {
+                    output[j] = pending[m_pendingOffset++];
+                }
+            }
+        }
+
+        // Generates 'count' mono 16-bit signed PCM samples.
+        void Generate(_Out_writes_(count) int16_t* output, size_t count) noexcept
+        {
+            using namespace DirectX;
+            using namespace DirectX::PackedVector;
+
+            // Leftover samples are kept as float and converted the same way as a full block
+            XMSHORTN4 tail;
+            const int16_t* src = &tail.x;
+
+            size_t j = 0;
+            if (m_pendingOffset < 4)
+            {
+                XMStoreShortN4(&tail, XMLoadFloat4A(&m_pending));
+                for (; j < count && m_pendingOffset < 4; ++j)
+                {
+                    output[j] = src[m_pendingOffset++];
+                }
+            }
+
+            for (; j + 4 <= count; j += 4)
+            {
+                XMStoreShortN4(reinterpret_cast<XMSHORTN4*>(output + j), NextBlock());
+            }
+
+            if (j < count)
+            {
+                XMStoreFloat4A(&m_pending, NextBlock());
+                XMStoreShortN4(&tail, XMLoadFloat4A(&m_pending));
+                for (m_pendingOffset = 0; j < count; ++j)
+                {
+                    output[j] = src[m_pendingOffset++];
+                }
+            }
+        }
+
+        // Fills a 16-bit mono submit buffer, returning the number of bytes written.
+        size_t GenerateBuffer(_Out_writes_bytes_(bufferSize) uint8_t* buffer, size_t bufferSize) noexcept
+        {
+            const size_t count = bufferSize / sizeof(int16_t);
+            Generate(reinterpret_cast<int16_t*>(buffer), count);
+            return count * sizeof(int16_t);
+        }
+
+    private:
+        enum class Stage : uint32_t
+        {
+            Off = 0,
+            Attack,
+            Decay,
+            Sustain,
+            Release,
+        };
+
+        DirectX::XMVECTOR XM_CALLCONV NextBlock() noexcept
+        {
+            using namespace DirectX;
+
+            static const XMVECTORF32 s_lane = { { { 0.f, 1.f, 2.f, 3.f } } };
+
+            // Phase for each lane in [0,1)
+            XMVECTOR phase = XMVectorMultiplyAdd(s_lane, XMVectorReplicate(m_phaseStep), XMVectorReplicate(m_phase));
+            phase = XMVectorSubtract(phase, XMVectorFloor(phase));
+
+            m_phase += m_phaseStep * 4.f;
+            m_phase -= std::floor(m_phase);
+
+            XMVECTOR value;
+            switch (m_waveform)
+            {
+            case Waveform::Square:
+                value = XMVectorSelect(g_XMNegativeOne, g_XMOne, XMVectorLess(phase, g_XMOneHalf));
+                break;
+
+            case Waveform::Sawtooth:
+                value = XMVectorSubtract(XMVectorAdd(phase, phase), g_XMOne);
+                break;
+
+            case Waveform::Noise:
+                value = NextNoise();
+                break;
+
+            case Waveform::Sine:
+            default:
+                value = XMVectorSin(XMVectorMultiply(phase, g_XMTwoPi));
+                break;
+            }
+
+            value = XMVectorScale(value, m_amplitude);
+
+            if (m_useEnvelope)
+            {
+                value = XMVectorMultiply(value, NextEnvelope());
+            }
+
+            return XMVectorClamp(value, g_XMNegativeOne, g_XMOne);
+        }
+
+        DirectX::XMVECTOR XM_CALLCONV NextNoise() noexcept
+        {
+            using namespace DirectX;
+
+            // xorshift32 per lane
+            XMVECTORU32 bits;
+            for (size_t k = 0; k < 4; ++k)
+            {
+                uint32_t x = m_noiseState[k];
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                m_noiseState[k] = x;
+
+                // Map to [1,2) using the mantissa bits
+                bits.u[k] = 0x3F800000u | (x >> 9);
+            }
+
+            // [1,2) -> [-1,1)
+            static const XMVECTORF32 s_three = { { { 3.f, 3.f, 3.f, 3.f } } };
+            return XMVectorSubtract(XMVectorAdd(bits.v, bits.v), s_three);
+        }
+
+        DirectX::XMVECTOR XM_CALLCONV NextEnvelope() noexcept
+        {
+            using namespace DirectX;
+
+            static const XMVECTORF32 s_ramp = { { { 1.f, 2.f, 3.f, 4.f } } };
+
+            // Fast path: the whole block is in a stage with a constant slope
+            float step = 0.f;
+            float limit = 0.f;
+            switch (m_stage)
+            {
+            case Stage::Off:
+                return g_XMZero;
+
+            case Stage::Sustain:
+                return XMVectorReplicate(m_level);
+
+            case Stage::Attack:
+                step = StageStep(m_envelope.attack, 1.f);
+                limit = 1.f;
+                break;
+
+            case Stage::Decay:
+                step = -StageStep(m_envelope.decay, 1.f - m_envelope.sustain);
+                limit = m_envelope.sustain;
+                break;
+
+            case Stage::Release:
+                step = m_releaseStep;
+                limit = 0.f;
+                break;
+            }
+
+            const float end = m_level + step * 4.f;
+            if ((step > 0.f && end < limit) || (step < 0.f && end > limit))
+            {
+                XMVECTOR result = XMVectorMultiplyAdd(s_ramp, XMVectorReplicate(step), XMVectorReplicate(m_level));
+                m_level = end;
+                return result;
+            }
+
+            // Slow path: a stage transition happens inside this block
+            XMFLOAT4A result;
+            float* dest = &result.x;
+            for (size_t k = 0; k < 4; ++k)
+            {
+                dest[k] = NextEnvelopeSample();
+            }
+
+            return XMLoadFloat4A(&result);
+        }
+
+        float NextEnvelopeSample() noexcept
+        {
+            switch (m_stage)
+            {
+            case Stage::Attack:
+                m_level += StageStep(m_envelope.attack, 1.f);
+                if (m_level >= 1.f)
+                {
+                    m_level = 1.f;
+                    m_stage = Stage::Decay;
+                }
+                break;
+
+            case Stage::Decay:
+                m_level -= StageStep(m_envelope.decay, 1.f - m_envelope.sustain);
+                if (m_level <= m_envelope.sustain)
+                {
+                    m_level = m_envelope.sustain;
+                    m_stage = Stage::Sustain;
+                }
+                break;
+
+            case Stage::Release:
+                m_level += m_releaseStep;
+                if (m_level <= 0.f)
+                {
+                    m_level = 0.f;
+                    m_stage = Stage::Off;
+                }
+                break;
+
+            case Stage::Sustain:
+            case Stage::Off:
+            default:
+                break;
+            }
+
+            return m_level;
+        }
+
+        float StageStep(float seconds, float range) const noexcept
+        {
+            const float samples = seconds * float(m_sampleRate);
+            return (samples > 1.f) ? range / samples : range;
+        }
+
+        uint32_t        m_sampleRate;
+        Waveform        m_waveform;
+        float           m_amplitude;
+        float           m_phase;
+        float           m_phaseStep;
+
+        ADSREnvelope    m_envelope;
+        bool            m_useEnvelope;
+        Stage           m_stage;
+        float           m_level;
+        float           m_releaseStep;
+
+        uint32_t        m_noiseState[4];
+
+        // Rest of the last partial block, returned by the next Generate call
+        DirectX::XMFLOAT4A  m_pending;
+        size_t              m_pendingOffset;
+    };
+}
@@ -0,0 +1,1140 @@
+//--------------------------------------------------------------------------------------
+// File: BCDecode.h
+//
+// CPU decompression of BC1 through BC7 block-compressed textures to RGBA8 or float
+// RGBA, without any Direct3D device, so decoded pixels can be compared headlessly.
+//
+// Each 4x4 block is decoded by building its small palette once and then expanding the
+// indices with table lookups. Whole DDS files are decoded by splitting every mip level
+// and slice into rows of blocks that are spread across a pool of threads.
+//
+// sRGB formats are returned as stored (no conversion to linear). SNORM formats decoded
+// to RGBA8 are biased so -1..1 maps to 0..255.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "DDSMetadata.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace DX
+{
+    constexpr size_t BC_BLOCK_PIXELS = 16;
+
+    // Location of one decoded sub-resource in the output pixel array. Rows are tightly packed
+    // RGBA, so pixel (x,y,z) starts at element 4 * (offset + (z * height + y) * width + x).
+    struct BCImage
+    {
+        uint32_t    width;
+        uint32_t    height;
+        uint32_t    depth;
+        size_t      offset;
+    };
+
+    inline bool IsBCFormat(DXGI_FORMAT format) noexcept
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_TYPELESS:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+        case DXGI_FORMAT_BC6H_TYPELESS:
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_TYPELESS:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    inline size_t BCBlockSize(DXGI_FORMAT format) noexcept
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+            return 8;
+
+        default:
+            return IsBCFormat(format) ? 16 : 0;
+        }
+    }
+
+    namespace Internal
+    {
+        //----------------------------------------------------------------------------------
+        // Shared tables (BC6H uses the first 32 two-subset partitions)
+
+        // Bit i set means pixel i is in subset 1
+        constexpr uint16_t g_BCPartition2[64] =
+        {
+            0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+            0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+            0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+            0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+            0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+            0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+            0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+            0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+        };
+
+        // Two bits per pixel, pixel i in bits 2i+1:2i
+        constexpr uint32_t g_BCPartition3[64] =
+        {
+            0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+            0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+            0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+            0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+            0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+            0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+            0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+            0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254,
+        };
+
+        constexpr uint8_t g_BCAnchor2[64] =
+        {
+            15, 15, 15, 15, 15, 15, 15, 15,
+            15, 15, 15, 15, 15, 15, 15, 15,
+            15,  2,  8,  2,  2,  8,  8, 15,
+             2,  8,  2,  2,  8,  8,  2,  2,
+            15, 15,  6,  8,  2,  8, 15, 15,
+             2,  8,  2,  2,  2, 15, 15,  6,
+             6,  2,  6,  8, 15, 15,  2,  2,
+            15, 15, 15, 15, 15,  2,  2, 15,
+        };
+
+        constexpr uint8_t g_BCAnchor3a[64] =
+        {
+             3,  3, 15, 15,  8,  3, 15, 15,
+             8,  8,  6,  6,  6,  5,  3,  3,
+             3,  3,  8, 15,  3,  3,  6, 10,
+             5,  8,  8,  6,  8,  5, 15, 15,
+             8, 15,  3,  5,  6, 10,  8, 15,
+            15,  3, 15,  5, 15, 15, 15, 15,
+             3, 15,  5,  5,  5,  8,  5, 10,
+             5, 10,  8, 13, 15, 12,  3,  3,
+        };
+
+        constexpr uint8_t g_BCAnchor3b[64] =
+        {
+            15,  8,  8,  3, 15, 15,  3,  8,
+            15, 15, 15, 15, 15, 15, 15,  8,
+            15,  8, 15,  3, 15,  8, 15,  8,
+             3, 15,  6, 10, 15, 15, 10,  8,
+            15,  3, 15, 10, 10,  8,  9, 10,
+             6, 15,  8, 15,  3,  6,  6,  8,
+            15,  3, 15, 15, 15, 15, 15, 15,
+            15, 15, 15, 15,  3, 15, 15,  8,
+        };
+
+        constexpr uint8_t g_BCWeights2[4] = { 0, 21, 43, 64 };
+        constexpr uint8_t g_BCWeights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+        constexpr uint8_t g_BCWeights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        inline const uint8_t* BCWeights(unsigned bits) noexcept
+        {
+            return (bits == 2) ? g_BCWeights2 : ((bits == 3) ? g_BCWeights3 : g_BCWeights4);
+        }
+
+        inline unsigned BCSubset(unsigned subsets, unsigned partition, unsigned pixel) noexcept
+        {
+            switch (subsets)
+            {
+            case 2: return (g_BCPartition2[partition] >> pixel) & 1u;
+            case 3: return (g_BCPartition3[partition] >> (pixel * 2)) & 3u;
+            default: return 0;
+            }
+        }
+
+        inline bool BCIsAnchor(unsigned subsets, unsigned partition, unsigned pixel) noexcept
+        {
+            if (!pixel)
+                return true;
+
+            switch (subsets)
+            {
+            case 2: return pixel == g_BCAnchor2[partition];
+            case 3: return pixel == g_BCAnchor3a[partition] || pixel == g_BCAnchor3b[partition];
+            default: return false;
+            }
+        }
+
+        class BCBitReader
+        {
+        public:
+            explicit BCBitReader(_In_reads_bytes_(16) const uint8_t* block) noexcept : m_pos(0)
+            {
+                memcpy(&m_lo, block, sizeof(uint64_t));
+                memcpy(&m_hi, block + 8, sizeof(uint64_t));
+            }
+
+            uint32_t Read(unsigned count) noexcept
+            {
+                if (!count)
+                    return 0;
+
+                uint64_t value;
+                if (m_pos >= 64)
+                {
+                    value = m_hi >> (m_pos - 64);
+                }
+                else if (m_pos + count <= 64)
+                {
+                    value = m_lo >> m_pos;
+                }
+                else
+                {
+                    value = (m_lo >> m_pos) | (m_hi << (64 - m_pos));
+                }
+
+                m_pos += count;
+                return static_cast<uint32_t>(value & ((uint64_t(1) << count) - 1));
+            }
+
+            unsigned Position() const noexcept { return m_pos; }
+
+        private:
+            uint64_t    m_lo;
+            uint64_t    m_hi;
+            unsigned    m_pos;
+        };
+
+        inline uint8_t BCExpand(uint32_t value, unsigned bits) noexcept
+        {
+            value <<= (8 - bits);
+            return static_cast<uint8_t>(value | (value >> bits));
+        }
+
+        inline void BCStore(uint8_t* out, uint32_t r, uint32_t g, uint32_t b, uint32_t a) noexcept
+        {
+            out[0] = static_cast<uint8_t>(r);
+            out[1] = static_cast<uint8_t>(g);
+            out[2] = static_cast<uint8_t>(b);
+            out[3] = static_cast<uint8_t>(a);
+        }
+
+        //----------------------------------------------------------------------------------
+        // BC1 color block (also the color half of BC2 and BC3, which never use 3-color mode)
+        inline void DecodeBC1Color(_In_reads_bytes_(8) const uint8_t* block, _Out_writes_(64) uint8_t* rgba, bool allowPunchThrough) noexcept
+        {
+            const uint32_t c0 = uint32_t(block[0]) | (uint32_t(block[1]) << 8);
+            const uint32_t c1 = uint32_t(block[2]) | (uint32_t(block[3]) << 8);
+
+            uint8_t palette[4][4];
+            const uint32_t r0 = BCExpand(c0 >> 11, 5), g0 = BCExpand((c0 >> 5) & 0x3F, 6), b0 = BCExpand(c0 & 0x1F, 5);
+            const uint32_t r1 = BCExpand(c1 >> 11, 5), g1 = BCExpand((c1 >> 5) & 0x3F, 6), b1 = BCExpand(c1 & 0x1F, 5);
+
+            BCStore(palette[0], r0, g0, b0, 255);
+            BCStore(palette[1], r1, g1, b1, 255);
+
+            if (c0 > c1 || !allowPunchThrough)
+            {
+                BCStore(palette[2], (2 * r0 + r1 + 1) / 3, (2 * g0 + g1 + 1) / 3, (2 * b0 + b1 + 1) / 3, 255);
+                BCStore(palette[3], (r0 + 2 * r1 + 1) / 3, (g0 + 2 * g1 + 1) / 3, (b0 + 2 * b1 + 1) / 3, 255);
+            }
+            else
+            {
+                BCStore(palette[2], (r0 + r1 + 1) / 2, (g0 + g1 + 1) / 2, (b0 + b1 + 1) / 2, 255);
+                BCStore(palette[3], 0, 0, 0, 0);
+            }
+
+            uint32_t indices = uint32_t(block[4]) | (uint32_t(block[5]) << 8) | (uint32_t(block[6]) << 16) | (uint32_t(block[7]) << 24);
+            for (size_t i = 0; i < BC_BLOCK_PIXELS; ++i, indices >>= 2)
+            {
+                memcpy(rgba + i * 4, palette[indices & 3], 4);
+            }
+        }
+
+        // BC3 alpha and BC4/BC5 channels use the same block with unsigned or signed endpoints
+        inline void DecodeBC4Channel(_In_reads_bytes_(8) const uint8_t* block, _Out_writes_(16) float* values, bool isSigned) noexcept
+        {
+            float palette[8];
+            if (isSigned)
+            {
+                const int e0 = std::max<int>(static_cast<int8_t>(block[0]), -127);
+                const int e1 = std::max<int>(static_cast<int8_t>(block[1]), -127);
+                palette[0] = float(e0) / 127.f;
+                palette[1] = float(e1) / 127.f;
+                if (e0 > e1)
+                {
+                    for (int i = 1; i < 7; ++i)
+                        palette[i + 1] = float((7 - i) * e0 + i * e1) / (7.f * 127.f);
+                }
+                else
+                {
+                    for (int i = 1; i < 5; ++i)
+                        palette[i + 1] = float((5 - i) * e0 + i * e1) / (5.f * 127.f);
+                    palette[6] = -1.f;
+                    palette[7] = 1.f;
+                }
+            }
+            else
+            {
+                const int e0 = block[0];
+                const int e1 = block[1];
+                palette[0] = float(e0) / 255.f;
+                palette[1] = float(e1) / 255.f;
+                if (e0 > e1)
+                {
+                    for (int i = 1; i < 7; ++i)
+                        palette[i + 1] = float((7 - i) * e0 + i * e1) / (7.f * 255.f);
+                }
+                else
+                {
+                    for (int i = 1; i < 5; ++i)
+                        palette[i + 1] = float((5 - i) * e0 + i * e1) / (5.f * 255.f);
+                    palette[6] = 0.f;
+                    palette[7] = 1.f;
+                }
+            }
+
+            uint64_t indices = 0;
+            for (size_t i = 0; i < 6; ++i)
+            {
+                indices |= uint64_t(block[2 + i]) << (8 * i);
+            }
+
+            for (size_t i = 0; i < BC_BLOCK_PIXELS; ++i, indices >>= 3)
+            {
+                values[i] = palette[indices & 7];
+            }
+        }
+
+        inline uint8_t BCToUNorm8(float value) noexcept
+        {
+            value = std::min(std::max(value, 0.f), 1.f);
+            return static_cast<uint8_t>(value * 255.f + 0.5f);
+        }
+
+        inline void DecodeBC2Alpha(_In_reads_bytes_(8) const uint8_t* block, _Inout_updates_(64) uint8_t* rgba) noexcept
+        {
+            for (size_t i = 0; i < BC_BLOCK_PIXELS; ++i)
+            {
+                const uint32_t a = (block[i >> 1] >> ((i & 1) * 4)) & 0xF;
+                rgba[i * 4 + 3] = static_cast<uint8_t>(a * 17);
+            }
+        }
+
+        inline void DecodeBC3Alpha(_In_reads_bytes_(8) const uint8_t* block, _Inout_updates_(64) uint8_t* rgba) noexcept
+        {
+            const uint32_t a0 = block[0];
+            const uint32_t a1 = block[1];
+
+            uint8_t palette[8];
+            palette[0] = static_cast<uint8_t>(a0);
+            palette[1] = static_cast<uint8_t>(a1);
+            if (a0 > a1)
+            {
+                for (uint32_t i = 1; i < 7; ++i)
+                    palette[i + 1] = static_cast<uint8_t>(((7 - i) * a0 + i * a1 + 3) / 7);
+            }
+            else
+            {
+                for (uint32_t i = 1; i < 5; ++i)
+                    palette[i + 1] = static_cast<uint8_t>(((5 - i) * a0 + i * a1 + 2) / 5);
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+
+            uint64_t indices = 0;
+            for (size_t i = 0; i < 6; ++i)
+            {
+                indices |= uint64_t(block[2 + i]) << (8 * i);
+            }
+
+            for (size_t i = 0; i < BC_BLOCK_PIXELS; ++i, indices >>= 3)
+            {
+                rgba[i * 4 + 3] = palette[indices & 7];
+            }
+        }
+
+        //----------------------------------------------------------------------------------
+        // BC7
+        struct BC7ModeInfo
+        {
+            uint8_t subsets;
+            uint8_t partitionBits;
+            uint8_t rotationBits;
+            uint8_t indexSelectionBits;
+            uint8_t colorBits;
+            uint8_t alphaBits;
+            uint8_t endpointPBits;
+            uint8_t sharedPBits;
+            uint8_t indexBits;
+            uint8_t indexBits2;
+        };
+
+        constexpr BC7ModeInfo g_BC7Modes[8] =
+        {
+            { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+            { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+            { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+            { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+            { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+            { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+            { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+            { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+        };
+
+        inline void DecodeBC7(_In_reads_bytes_(16) const uint8_t* block, _Out_writes_(64) uint8_t* rgba) noexcept
+        {
+            unsigned mode = 0;
+            while (mode < 8 && !(block[0] & (1u << mode)))
+                ++mode;
+
+            if (mode >= 8)
+            {
+                // Reserved mode decodes as transparent black
+                memset(rgba, 0, BC_BLOCK_PIXELS * 4);
+                return;
+            }
+
+            const BC7ModeInfo& info = g_BC7Modes[mode];
+
+            BCBitReader bits(block);
+            bits.Read(mode + 1);
+
+            const unsigned partition = bits.Read(info.partitionBits);
+            const unsigned rotation = bits.Read(info.rotationBits);
+            const unsigned indexSelection = bits.Read(info.indexSelectionBits);
+
+            const unsigned numEndpoints = info.subsets * 2u;
+
+            uint32_t endpoints[6][4] = {};
+            for (unsigned c = 0; c < 3; ++c)
+            {
+                for (unsigned e = 0; e < numEndpoints; ++e)
+                    endpoints[e][c] = bits.Read(info.colorBits);
+            }
+            for (unsigned e = 0; e < numEndpoints; ++e)
+                endpoints[e][3] = info.alphaBits ? bits.Read(info.alphaBits) : 255u;
+
+            unsigned colorBits = info.colorBits;
+            unsigned alphaBits = info.alphaBits;
+
+            if (info.endpointPBits)
+            {
+                for (unsigned e = 0; e < numEndpoints; ++e)
+                {
+                    const uint32_t p = bits.Read(1);
+                    for (unsigned c = 0; c < 4; ++c)
+                    {
+                        if (c < 3 || alphaBits)
+                            endpoints[e][c] = (endpoints[e][c] << 1) | p;
+                    }
+                }
+            }
+            else if (info.sharedPBits)
+            {
+                for (unsigned s = 0; s < info.subsets; ++s)
+                {
+                    const uint32_t p = bits.Read(1);
+                    for (unsigned e = s * 2; e < s * 2 + 2; ++e)
+                    {
+                        for (unsigned c = 0; c < 3; ++c)
+                            endpoints[e][c] = (endpoints[e][c] << 1) | p;
+                    }
+                }
+            }
+
+            if (info.endpointPBits || info.sharedPBits)
+            {
+                ++colorBits;
+                if (alphaBits)
+                    ++alphaBits;
+            }
+
+            for (unsigned e = 0; e < numEndpoints; ++e)
+            {
+                for (unsigned c = 0; c < 3; ++c)
+                    endpoints[e][c] = BCExpand(endpoints[e][c], colorBits);
+                if (alphaBits)
+                    endpoints[e][3] = BCExpand(endpoints[e][3], alphaBits);
+            }
+
+            uint8_t indices[BC_BLOCK_PIXELS];
+            uint8_t indices2[BC_BLOCK_PIXELS] = {};
+
+            for (unsigned i = 0; i < BC_BLOCK_PIXELS; ++i)
+            {
+                const unsigned count = info.indexBits - (BCIsAnchor(info.subsets, partition, i) ? 1u : 0u);
+                indices[i] = static_cast<uint8_t>(bits.Read(count));
+            }
+
+            if (info.indexBits2)
+            {
+                for (unsigned i = 0; i < BC_BLOCK_PIXELS; ++i)
+                {
+                    const unsigned count = info.indexBits2 - (i ? 0u : 1u);
+                    indices2[i] = static_cast<uint8_t>(bits.Read(count));
+                }
+            }
+
+            // Mode 4 can swap which index set drives color and which drives alpha
+            unsigned colorIndexBits = info.indexBits;
+            unsigned alphaIndexBits = info.indexBits2 ? info.indexBits2 : info.indexBits;
+            const uint8_t* colorIndices = indices;
+            const uint8_t* alphaIndices = info.indexBits2 ? indices2 : indices;
+            if (indexSelection)
+            {
+                std::swap(colorIndexBits, alphaIndexBits);
+                std::swap(colorIndices, alphaIndices);
+            }
+
+            const uint8_t* colorWeights = BCWeights(colorIndexBits);
+            const uint8_t* alphaWeights = BCWeights(alphaIndexBits);
+
+            for (unsigned i = 0; i < BC_BLOCK_PIXELS; ++i)
+            {
+                const unsigned subset = BCSubset(info.subsets, partition, i);
+                const uint32_t* e0 = endpoints[subset * 2];
+                const uint32_t* e1 = endpoints[subset * 2 + 1];
+
+                const uint32_t wc = colorWeights[colorIndices[i]];
+                const uint32_t wa = alphaWeights[alphaIndices[i]];
+
+                uint8_t* out = rgba + i * 4;
+                for (unsigned c = 0; c < 3; ++c)
+                    out[c] = static_cast<uint8_t>(((64 - wc) * e0[c] + wc * e1[c] + 32) >> 6);
+                out[3] = static_cast<uint8_t>(((64 - wa) * e0[3] + wa * e1[3] + 32) >> 6);
+
+                if (rotation)
+                    std::swap(out[3], out[rotation - 1]);
+            }
+        }
+
+        //----------------------------------------------------------------------------------
+        // BC6H
+        enum BC6HField : uint8_t { BC6H_RW, BC6H_RX, BC6H_RY, BC6H_RZ, BC6H_GW, BC6H_GX, BC6H_GY, BC6H_GZ, BC6H_BW, BC6H_BX, BC6H_BY, BC6H_BZ, BC6H_D };
+
+        // Run of bits for one field, read from bit 'first' towards bit 'last' (some runs are stored reversed)
+        struct BC6HRun
+        {
+            uint8_t field;
+            uint8_t first;
+            uint8_t last;
+        };
+
+        struct BC6HModeInfo
+        {
+            uint8_t     mode;
+            uint8_t     modeBits;
+            uint8_t     transformed;
+            uint8_t     endpointBits;
+            uint8_t     deltaBits[3];
+            uint8_t     numRuns;
+            BC6HRun     runs[24];
+        };
+
+        constexpr BC6HModeInfo g_BC6HModes[14] =
+        {
+            { 0x00, 2, 1, 10, { 5, 5, 5 }, 20, {
+                { BC6H_GY,4,4 }, { BC6H_BY,4,4 }, { BC6H_BZ,4,4 }, { BC6H_RW,0,9 }, { BC6H_GW,0,9 }, { BC6H_BW,0,9 },
+                { BC6H_RX,0,4 }, { BC6H_GZ,4,4 }, { BC6H_GY,0,3 }, { BC6H_GX,0,4 }, { BC6H_BZ,0,0 }, { BC6H_GZ,0,3 },
+                { BC6H_BX,0,4 }, { BC6H_BZ,1,1 }, { BC6H_BY,0,3 }, { BC6H_RY,0,4 }, { BC6H_BZ,2,2 }, { BC6H_RZ,0,4 },
+                { BC6H_BZ,3,3 }, { BC6H_D,0,4 } } },
+            { 0x01, 2, 1, 7, { 6, 6, 6 }, 22, {
+                { BC6H_GY,5,5 }, { BC6H_GZ,4,5 }, { BC6H_RW,0,6 }, { BC6H_BZ,0,1 }, { BC6H_BY,4,4 }, { BC6H_GW,0,6 },
+                { BC6H_BY,5,5 }, { BC6H_BZ,2,2 }, { BC6H_GY,4,4 }, { BC6H_BW,0,6 }, { BC6H_BZ,3,3 }, { BC6H_BZ,5,5 },
+                { BC6H_BZ,4,4 }, { BC6H_RX,0,5 }, { BC6H_GY,0,3 }, { BC6H_GX,0,5 }, { BC6H_GZ,0,3 }, { BC6H_BX,0,5 },
+                { BC6H_BY,0,3 }, { BC6H_RY,0,5 }, { BC6H_RZ,0,5 }, { BC6H_D,0,4 } } },
+            { 0x02, 5, 1, 11, { 5, 4, 4 }, 19, {
+                { BC6H_RW,0,9 }, { BC6H_GW,0,9 }, { BC6H_BW,0,9 }, { BC6H_RX,0,4 }, { BC6H_RW,10,10 }, { BC6H_GY,0,3 },
+                { BC6H_GX,0,3 }, { BC6H_GW,10,10 }, { BC6H_BZ,0,0 }, { BC6H_GZ,0,3 }, { BC6H_BX,0,3 }, { BC6H_BW,10,10 },
+                { BC6H_BZ,1,1 }, { BC6H_BY,0,3 }, { BC6H_RY,0,4 }, { BC6H_BZ,2,2 }, { BC6H_RZ,0,4 }, { BC6H_BZ,3,3 },
+                { BC6H_D,0,4 } } },
+            { 0x06, 5, 1, 11, { 4, 5, 4 }, 21, {
+                { BC6H_RW,0,9 }, { BC6H_GW,0,9 }, { BC6H_BW,0,9 }, { BC6H_RX,0,3 }, { BC6H_RW,10,10 }, { BC6H_GZ,4,4 },
+                { BC6H_GY,0,3 }, { BC6H_GX,0,4 }, { BC6H_GW,10,10 }, { BC6H_GZ,0,3 }, { BC6H_BX,0,3 }, { BC6H_BW,10,10 },
+                { BC6H_BZ,1,1 }, { BC6H_BY,0,3 }, { BC6H_RY,0,3 }, { BC6H_BZ,0,0 }, { BC6H_BZ,2,2 }, { BC6H_RZ,0,3 },
+                { BC6H_GY,4,4 }, { BC6H_BZ,3,3 }, { BC6H_D,0,4 } } },
+            { 0x0A, 5, 1, 11, { 4, 4, 5 }, 20, {
+                { BC6H_RW,0,9 }, { BC6H_GW,0,9 }, { BC6H_BW,0,9 }, { BC6H_RX,0,3 }, { BC6H_RW,10,10 }, { BC6H_BY,4,4 },
+                { BC6H_GY,0,3 }, { BC6H_GX,0,3 }, { BC6H_GW,10,10 }, { BC6H_BZ,0,0 }, { BC6H_GZ,0,3 }, { BC6H_BX,0,4 },
+                { BC6H_BW,10,10 }, { BC6H_BY,0,3 }, { BC6H_RY,0,3 }, { BC6H_BZ,1,2 }, { BC6H_RZ,0,3 }, { BC6H_BZ,4,4 },
+                { BC6H_BZ,3,3 }, { BC6H_D,0,4 } } },
+            { 0x0E, 5, 1, 9, { 5, 5, 5 }, 20, {
+                { BC6H_RW,0,8 }, { BC6H_BY,4,4 }, { BC6H_GW,0,8 }, { BC6H_GY,4,4 }, { BC6H_BW,0,8 }, { BC6H_BZ,4,4 },
+                { BC6H_RX,0,4 }, { BC6H_GZ,4,4 }, { BC6H_GY,0,3 }, { BC6H_GX,0,4 }, { BC6H_BZ,0,0 }, { BC6H_GZ,0,3 },
+                { BC6H_BX,0,4 }, { BC6H_BZ,1,1 }, { BC6H_BY,0,3 }, { BC6H_RY,0,4 }, { BC6H_BZ,2,2 }, { BC6H_RZ,0,4 },
+                { BC6H_BZ,3,3 }, { BC6H_D,0,4 } } },
+            { 0x12, 5, 1, 8, { 6, 5, 5 }, 19, {
+                { BC6H_RW,0,7 }, { BC6H_GZ,4,4 }, { BC6H_BY,4,4 }, { BC6H_GW,0,7 }, { BC6H_BZ,2,2 }, { BC6H_GY,4,4 },
+                { BC6H_BW,0,7 }, { BC6H_BZ,3,4 }, { BC6H_RX,0,5 }, { BC6H_GY,0,3 }, { BC6H_GX,0,4 }, { BC6H_BZ,0,0 },
+                { BC6H_GZ,0,3 }, { BC6H_BX,0,4 }, { BC6H_BZ,1,1 }, { BC6H_BY,0,3 }, { BC6H_RY,0,5 }, { BC6H_RZ,0,5 },
+                { BC6H_D,0,4 } } },
+            { 0x16, 5, 1, 8, { 5, 6, 5 }, 22, {
+                { BC6H_RW,0,7 }, { BC6H_BZ,0,0 }, { BC6H_BY,4,4 }, { BC6H_GW,0,7 }, { BC6H_GY,5,5 }, { BC6H_GY,4,4 },
+                { BC6H_BW,0,7 }, { BC6H_GZ,5,5 }, { BC6H_BZ,4,4 }, { BC6H_RX,0,4 }, { BC6H_GZ,4,4 }, { BC6H_GY,0,3 },
+                { BC6H_GX,0,5 }, { BC6H_GZ,0,3 }, { BC6H_BX,0,4 }, { BC6H_BZ,1,1 }, { BC6H_BY,0,3 }, { BC6H_RY,0,4 },
+                { BC6H_BZ,2,2 }, { BC6H_RZ,0,4 }, { BC6H_BZ,3,3 }, { BC6H_D,0,4 } } },
+            { 0x1A, 5, 1, 8, { 5, 5, 6 }, 22, {
+                { BC6H_RW,0,7 }, { BC6H_BZ,1,1 }, { BC6H_BY,4,4 }, { BC6H_GW,0,7 }, { BC6H_BY,5,5 }, { BC6H_GY,4,4 },
+                { BC6H_BW,0,7 }, { BC6H_BZ,5,5 }, { BC6H_BZ,4,4 }, { BC6H_RX,0,4 }, { BC6H_GZ,4,4 }, { BC6H_GY,0,3 },
+                { BC6H_GX,0,4 }, { BC6H_BZ,0,0 }, { BC6H_GZ,0,3 }, { BC6H_BX,0,5 }, { BC6H_BY,0,3 }, { BC6H_RY,0,4 },
+                { BC6H_BZ,2,2 }, { BC6H_RZ,0,4 }, { BC6H_BZ,3,3 }, { BC6H_D,0,4 } } },
+            { 0x1E, 5, 0, 6, { 6, 6, 6 }, 23, {
+                { BC6H_RW,0,5 }, { BC6H_GZ,4,4 }, { BC6H_BZ,0,1 }, { BC6H_BY,4,4 }, { BC6H_GW,0,5 }, { BC6H_GY,5,5 },
+                { BC6H_BY,5,5 }, { BC6H_BZ,2,2 }, { BC6H_GY,4,4 }, { BC6H_BW,0,5 }, { BC6H_GZ,5,5 }, { BC6H_BZ,3,3 },
+                { BC6H_BZ,5,5 }, { BC6H_BZ,4,4 }, { BC6H_RX,0,5 }, { BC6H_GY,0,3 }, { BC6H_GX,0,5 }, { BC6H_GZ,0,3 },
+                { BC6H_BX,0,5 }, { BC6H_BY,0,3 }, { BC6H_RY,0,5 }, { BC6H_RZ,0,5 }, { BC6H_D,0,4 } } },
+            { 0x03, 5, 0, 10, { 10, 10, 10 }, 6, {
+                { BC6H_RW,0,9 }, { BC6H_GW,0,9 }, { BC6H_BW,0,9 }, { BC6H_RX,0,9 }, { BC6H_GX,0,9 }, { BC6H_BX,0,9 } } },
+            { 0x07, 5, 1, 11, { 9, 9, 9 }, 9, {
+                { BC6H_RW,0,9 }, { BC6H_GW,0,9 }, { BC6H_BW,0,9 }, { BC6H_RX,0,8 }, { BC6H_RW,10,10 }, { BC6H_GX,0,8 },
+                { BC6H_GW,10,10 }, { BC6H_BX,0,8 }, { BC6H_BW,10,10 } } },
+            { 0x0B, 5, 1, 12, { 8, 8, 8 }, 9, {
+                { BC6H_RW,0,9 }, { BC6H_GW,0,9 }, { BC6H_BW,0,9 }, { BC6H_RX,0,7 }, { BC6H_RW,11,10 }, { BC6H_GX,0,7 },
+                { BC6H_GW,11,10 }, { BC6H_BX,0,7 }, { BC6H_BW,11,10 } } },
+            { 0x0F, 5, 1, 16, { 4, 4, 4 }, 9, {
+                { BC6H_RW,0,9 }, { BC6H_GW,0,9 }, { BC6H_BW,0,9 }, { BC6H_RX,0,3 }, { BC6H_RW,15,10 }, { BC6H_GX,0,3 },
+                { BC6H_GW,15,10 }, { BC6H_BX,0,3 }, { BC6H_BW,15,10 } } },
+        };
+
+        inline int BC6HSignExtend(int value, unsigned bits) noexcept
+        {
+            const int sign = 1 << (bits - 1);
+            value &= (1 << bits) - 1;
+            return (value ^ sign) - sign;
+        }
+
+        inline int BC6HUnquantize(int value, unsigned bits, bool isSigned) noexcept
+        {
+            if (!isSigned)
+            {
+                if (bits >= 15 || value == 0)
+                    return value;
+                if (value == (1 << bits) - 1)
+                    return 0xFFFF;
+                return ((value << 16) + 0x8000) >> bits;
+            }
+
+            if (bits >= 16)
+                return std::max(value, -0x7FFF);
+
+            const bool negative = value < 0;
+            if (negative)
+                value = -value;
+
+            int result;
+            if (value == 0)
+                result = 0;
+            else if (value >= (1 << (bits - 1)) - 1)
+                result = 0x7FFF;
+            else
+                result = ((value << 15) + 0x4000) >> (bits - 1);
+
+            return negative ? -result : result;
+        }
+
+        inline float BCHalfToFloat(uint16_t half) noexcept
+        {
+            const uint32_t sign = uint32_t(half & 0x8000) << 16;
+            uint32_t exponent = (half >> 10) & 0x1F;
+            uint32_t mantissa = half & 0x3FF;
+
+            uint32_t bits;
+            if (exponent == 0x1F)
+            {
+                bits = sign | 0x7F800000 | (mantissa << 13);
+            }
+            else if (exponent)
+            {
+                bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+            }
+            else if (mantissa)
+            {
+                // Denormal
+                exponent = 113;
+                while (!(mantissa & 0x400))
+                {
+                    mantissa <<= 1;
+                    --exponent;
+                }
+                bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+            }
+            else
+            {
+                bits = sign;
+            }
+
+            float result;
+            memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+
+        inline void DecodeBC6H(_In_reads_bytes_(16) const uint8_t* block, _Out_writes_(64) float* rgba, bool isSigned) noexcept
+        {
+            unsigned mode = block[0] & 0x3;
+            if (mode > 1)
+                mode = block[0] & 0x1F;
+
+            const BC6HModeInfo* info = nullptr;
+            for (const auto& it : g_BC6HModes)
+            {
+                if (it.mode == mode)
+                {
+                    info = &it;
+                    break;
+                }
+            }
+
+            if (!info)
+            {
+                // Reserved modes decode as opaque black
+                for (size_t i = 0; i < BC_BLOCK_PIXELS; ++i)
+                {
+                    rgba[i * 4] = rgba[i * 4 + 1] = rgba[i * 4 + 2] = 0.f;
+                    rgba[i * 4 + 3] = 1.f;
+                }
+                return;
+            }
+
+            BCBitReader bits(block);
+            bits.Read(info->modeBits);
+
+            int fields[BC6H_D + 1] = {};
+            for (unsigned r = 0; r < info->numRuns; ++r)
+            {
+                const BC6HRun& run = info->runs[r];
+                const int step = (run.last >= run.first) ? 1 : -1;
+                for (int b = run.first; ; b += step)
+                {
+                    fields[run.field] |= static_cast<int>(bits.Read(1)) << b;
+                    if (b == run.last)
+                        break;
+                }
+            }
+
+            const bool twoSubsets = (info->modeBits == 2) || (mode & 0x3) == 2;
+            const unsigned numEndpoints = twoSubsets ? 4u : 2u;
+            const unsigned partition = twoSubsets ? static_cast<unsigned>(fields[BC6H_D]) : 0u;
+
+            // Endpoints in order w, x, y, z per channel
+            int endpoints[4][3];
+            for (unsigned c = 0; c < 3; ++c)
+            {
+                for (unsigned e = 0; e < numEndpoints; ++e)
+                    endpoints[e][c] = fields[c * 4 + e];
+            }
+
+            const unsigned epBits = info->endpointBits;
+            for (unsigned c = 0; c < 3; ++c)
+            {
+                if (isSigned)
+                    endpoints[0][c] = BC6HSignExtend(endpoints[0][c], epBits);
+
+                for (unsigned e = 1; e < numEndpoints; ++e)
+                {
+                    if (info->transformed)
+                    {
+                        int value = endpoints[0][c] + BC6HSignExtend(endpoints[e][c], info->deltaBits[c]);
+                        value &= (1 << epBits) - 1;
+                        endpoints[e][c] = isSigned ? BC6HSignExtend(value, epBits) : value;
+                    }
+                    else if (isSigned)
+                    {
+                        endpoints[e][c] = BC6HSignExtend(endpoints[e][c], epBits);
+                    }
+                }
+            }
+
+            for (unsigned e = 0; e < numEndpoints; ++e)
+            {
+                for (unsigned c = 0; c < 3; ++c)
+                    endpoints[e][c] = BC6HUnquantize(endpoints[e][c], epBits, isSigned);
+            }
+
+            const unsigned indexBits = twoSubsets ? 3u : 4u;
+            const unsigned subsets = twoSubsets ? 2u : 1u;
+            const uint8_t* weights = BCWeights(indexBits);
+
+            for (unsigned i = 0; i < BC_BLOCK_PIXELS; ++i)
+            {
+                const unsigned count = indexBits - (BCIsAnchor(subsets, partition, i) ? 1u : 0u);
+                const int w = weights[bits.Read(count)];
+                const unsigned subset = BCSubset(subsets, partition, i);
+                const int* e0 = endpoints[subset * 2];
+                const int* e1 = endpoints[subset * 2 + 1];
+
+                for (unsigned c = 0; c < 3; ++c)
+                {
+                    const int value = ((64 - w) * e0[c] + w * e1[c] + 32) >> 6;
+
+                    uint16_t half;
+                    if (isSigned)
+                    {
+                        const int scaled = (value < 0) ? -(((-value) * 31) >> 5) : (value * 31) >> 5;
+                        half = (scaled < 0) ? static_cast<uint16_t>(0x8000 | (-scaled)) : static_cast<uint16_t>(scaled);
+                    }
+                    else
+                    {
+                        half = static_cast<uint16_t>((value * 31) >> 6);
+                    }
+
+                    rgba[i * 4 + c] = BCHalfToFloat(half);
+                }
+                rgba[i * 4 + 3] = 1.f;
+            }
+        }
+
+        //----------------------------------------------------------------------------------
+        // Formats that decode exactly to 8 bits per channel
+        inline bool IsBCUNorm8(DXGI_FORMAT format) noexcept
+        {
+            switch (format)
+            {
+            case DXGI_FORMAT_BC1_TYPELESS:
+            case DXGI_FORMAT_BC1_UNORM:
+            case DXGI_FORMAT_BC1_UNORM_SRGB:
+            case DXGI_FORMAT_BC2_TYPELESS:
+            case DXGI_FORMAT_BC2_UNORM:
+            case DXGI_FORMAT_BC2_UNORM_SRGB:
+            case DXGI_FORMAT_BC3_TYPELESS:
+            case DXGI_FORMAT_BC3_UNORM:
+            case DXGI_FORMAT_BC3_UNORM_SRGB:
+            case DXGI_FORMAT_BC7_TYPELESS:
+            case DXGI_FORMAT_BC7_UNORM:
+            case DXGI_FORMAT_BC7_UNORM_SRGB:
+                return true;
+
+            default:
+                return false;
+            }
+        }
+
+        inline void DecodeBlockUNorm8(DXGI_FORMAT format, _In_reads_bytes_(16) const uint8_t* block, _Out_writes_(64) uint8_t* rgba) noexcept
+        {
+            switch (format)
+            {
+            case DXGI_FORMAT_BC1_TYPELESS:
+            case DXGI_FORMAT_BC1_UNORM:
+            case DXGI_FORMAT_BC1_UNORM_SRGB:
+                DecodeBC1Color(block, rgba, true);
+                break;
+
+            case DXGI_FORMAT_BC2_TYPELESS:
+            case DXGI_FORMAT_BC2_UNORM:
+            case DXGI_FORMAT_BC2_UNORM_SRGB:
+                DecodeBC1Color(block + 8, rgba, false);
+                DecodeBC2Alpha(block, rgba);
+                break;
+
+            case DXGI_FORMAT_BC3_TYPELESS:
+            case DXGI_FORMAT_BC3_UNORM:
+            case DXGI_FORMAT_BC3_UNORM_SRGB:
+                DecodeBC1Color(block + 8, rgba, false);
+                DecodeBC3Alpha(block, rgba);
+                break;
+
+            default:
+                DecodeBC7(block, rgba);
+                break;
+            }
+        }
+
+        // BC4, BC5, and BC6H
+        inline void DecodeBlockFloat(DXGI_FORMAT format, _In_reads_bytes_(16) const uint8_t* block, _Out_writes_(64) float* rgba) noexcept
+        {
+            float r[BC_BLOCK_PIXELS];
+            float g[BC_BLOCK_PIXELS];
+
+            switch (format)
+            {
+            case DXGI_FORMAT_BC4_TYPELESS:
+            case DXGI_FORMAT_BC4_UNORM:
+            case DXGI_FORMAT_BC4_SNORM:
+                DecodeBC4Channel(block, r, format == DXGI_FORMAT_BC4_SNORM);
+                for (size_t i = 0; i < BC_BLOCK_PIXELS; ++i)
+                {
+                    rgba[i * 4] = r[i];
+                    rgba[i * 4 + 1] = rgba[i * 4 + 2] = 0.f;
+                    rgba[i * 4 + 3] = 1.f;
+                }
+                break;
+
+            case DXGI_FORMAT_BC5_TYPELESS:
+            case DXGI_FORMAT_BC5_UNORM:
+            case DXGI_FORMAT_BC5_SNORM:
+                DecodeBC4Channel(block, r, format == DXGI_FORMAT_BC5_SNORM);
+                DecodeBC4Channel(block + 8, g, format == DXGI_FORMAT_BC5_SNORM);
+                for (size_t i = 0; i < BC_BLOCK_PIXELS; ++i)
+                {
+                    rgba[i * 4] = r[i];
+                    rgba[i * 4 + 1] = g[i];
+                    rgba[i * 4 + 2] = 0.f;
+                    rgba[i * 4 + 3] = 1.f;
+                }
+                break;
+
+            default:
+                DecodeBC6H(block, rgba, format == DXGI_FORMAT_BC6H_SF16);
+                break;
+            }
+        }
+
+        inline bool IsBCSNorm(DXGI_FORMAT format) noexcept
+        {
+            return format == DXGI_FORMAT_BC4_SNORM || format == DXGI_FORMAT_BC5_SNORM;
+        }
+
+        template<typename T>
+        void DecodeBlock(DXGI_FORMAT format, _In_reads_bytes_(16) const uint8_t* block, _Out_writes_(64) T* rgba) noexcept
+        {
+            static_assert(std::is_same<T, uint8_t>::value || std::is_same<T, float>::value, "RGBA8 or float only");
+
+            if (IsBCUNorm8(format))
+            {
+                if constexpr (std::is_same<T, uint8_t>::value)
+                {
+                    DecodeBlockUNorm8(format, block, rgba);
+                }
+                else
+                {
+                    uint8_t temp[BC_BLOCK_PIXELS * 4];
+                    DecodeBlockUNorm8(format, block, temp);
+                    for (size_t i = 0; i < BC_BLOCK_PIXELS * 4; ++i)
+                        rgba[i] = float(temp[i]) / 255.f;
+                }
+            }
+            else
+            {
+                if constexpr (std::is_same<T, float>::value)
+                {
+                    DecodeBlockFloat(format, block, rgba);
+                }
+                else
+                {
+                    float temp[BC_BLOCK_PIXELS * 4];
+                    DecodeBlockFloat(format, block, temp);
+                    if (IsBCSNorm(format))
+                    {
+                        for (size_t i = 0; i < BC_BLOCK_PIXELS * 4; ++i)
+                            rgba[i] = BCToUNorm8(temp[i] * 0.5f + 0.5f);
+                    }
+                    else
+                    {
+                        for (size_t i = 0; i < BC_BLOCK_PIXELS * 4; ++i)
+                            rgba[i] = BCToUNorm8(temp[i]);
+                    }
+                }
+            }
+        }
+
+        // Decodes block rows [firstRow, lastRow) of one 2D slice
+        template<typename T>
+        void DecodeBlockRows(DXGI_FORMAT format, const uint8_t* src, size_t srcRowPitch,
+            uint32_t width, uint32_t height, size_t firstRow, size_t lastRow, T* dst, size_t dstRowPitch) noexcept
+        {
+            const size_t blockSize = BCBlockSize(format);
+            const size_t blocksWide = std::max<size_t>(1u, (size_t(width) + 3u) / 4u);
+
+            T pixels[BC_BLOCK_PIXELS * 4];
+            for (size_t by = firstRow; by < lastRow; ++by)
+            {
+                const uint8_t* block = src + by * srcRowPitch;
+                const size_t rows = std::min<size_t>(4u, height - by * 4);
+
+                for (size_t bx = 0; bx < blocksWide; ++bx, block += blockSize)
+                {
+                    DecodeBlock(format, block, pixels);
+
+                    const size_t cols = std::min<size_t>(4u, width - bx * 4);
+                    for (size_t y = 0; y < rows; ++y)
+                    {
+                        memcpy(dst + (by * 4 + y) * dstRowPitch + bx * 16, pixels + y * 16, cols * 4 * sizeof(T));
+                    }
+                }
+            }
+        }
+
+        template<typename T>
+        HRESULT DecodeDDS(_In_reads_bytes_(size) const uint8_t* data, size_t size,
+            DDSMetadata& metadata, std::vector<BCImage>& images, std::vector<T>& pixels, size_t threads)
+        {
+            images.clear();
+            pixels.clear();
+
+            std::vector<DDSSubresource> subresources;
+            HRESULT hr = GetDDSMetadata(data, size, metadata, &subresources);
+            if (FAILED(hr))
+                return hr;
+
+            if (!IsBCFormat(metadata.format))
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+            // One job per row of blocks in every slice of every sub-resource
+            struct Job
+            {
+                const uint8_t*  src;
+                size_t          srcRowPitch;
+                uint32_t        width;
+                uint32_t        height;
+                size_t          row;
+                size_t          dstOffset;
+            };
+
+            std::vector<Job> jobs;
+            images.reserve(subresources.size());
+
+            size_t totalPixels = 0;
+            for (const auto& sub : subresources)
+            {
+                const BCImage image = { sub.width, sub.height, sub.depth, totalPixels };
+                images.push_back(image);
+
+                for (uint32_t z = 0; z < sub.depth; ++z)
+                {
+                    const uint8_t* slice = data + sub.offset + uint64_t(z) * sub.slicePitch;
+                    const size_t sliceOffset = totalPixels + size_t(z) * sub.width * sub.height;
+                    for (size_t row = 0; row < sub.numRows; ++row)
+                    {
+                        jobs.push_back({ slice, sub.rowPitch, sub.width, sub.height, row, sliceOffset });
+                    }
+                }
+
+                totalPixels += size_t(sub.width) * sub.height * sub.depth;
+            }
+
+            pixels.resize(totalPixels * 4);
+
+            if (!threads)
+            {
+                threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+            }
+
+            // Small jobs are batched so thread hand-off doesn't dominate tiny mips
+            constexpr size_t c_RowsPerBatch = 4;
+            const size_t batches = (jobs.size() + c_RowsPerBatch - 1) / c_RowsPerBatch;
+            threads = std::min(threads, batches);
+
+            std::atomic<size_t> next(0);
+            T* output = pixels.data();
+            auto worker = [&]()
+            {
+                for (;;)
+                {
+                    const size_t batch = next++;
+                    if (batch >= batches)
+                        break;
+
+                    const size_t last = std::min(jobs.size(), (batch + 1) * c_RowsPerBatch);
+                    for (size_t j = batch * c_RowsPerBatch; j < last; ++j)
+                    {
+                        const Job& job = jobs[j];
+                        DecodeBlockRows(metadata.format, job.src, job.srcRowPitch, job.width, job.height,
+                            job.row, job.row + 1, output + job.dstOffset * 4, size_t(job.width) * 4);
+                    }
+                }
+            };
+
+            if (threads <= 1)
+            {
+                worker();
+            }
+            else
+            {
+                std::vector<std::thread> pool;
+                pool.reserve(threads - 1);
+                for (size_t j = 1; j < threads; ++j)
+                {
+                    pool.emplace_back(worker);
+                }
+                worker();
+                for (auto& t : pool)
+                {
+                    t.join();
+                }
+            }
+
+            return S_OK;
+        }
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Decodes one block to 16 RGBA pixels in row-major order
+    inline HRESULT DecodeBCBlock(DXGI_FORMAT format, _In_reads_bytes_(16) const uint8_t* block, _Out_writes_(64) uint8_t* rgba) noexcept
+    {
+        if (!block || !rgba)
+            return E_INVALIDARG;
+
+        if (!IsBCFormat(format))
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+        Internal::DecodeBlock(format, block, rgba);
+        return S_OK;
+    }
+
+    inline HRESULT DecodeBCBlock(DXGI_FORMAT format, _In_reads_bytes_(16) const uint8_t* block, _Out_writes_(64) float* rgba) noexcept
+    {
+        if (!block || !rgba)
+            return E_INVALIDARG;
+
+        if (!IsBCFormat(format))
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+        Internal::DecodeBlock(format, block, rgba);
+        return S_OK;
+    }
+
+    // Decodes one 2D surface; 'dstRowPitch' is in elements (at least 4 * width)
+    template<typename T>
+    HRESULT DecodeBCImage(DXGI_FORMAT format, _In_ const uint8_t* src, size_t srcRowPitch,
+        uint32_t width, uint32_t height, _Out_ T* dst, size_t dstRowPitch) noexcept
+    {
+        if (!src || !dst || !width || !height || dstRowPitch < size_t(width) * 4)
+            return E_INVALIDARG;
+
+        if (!IsBCFormat(format))
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+        Internal::DecodeBlockRows(format, src, srcRowPitch, width, height, 0, (size_t(height) + 3u) / 4u, dst, dstRowPitch);
+        return S_OK;
+    }
+
+    // Decodes every sub-resource of a BC-compressed DDS file in memory using up to 'threads'
+    // threads (0 for the number of cores).
+    inline HRESULT DecodeBCDDS(_In_reads_bytes_(size) const uint8_t* data, size_t size,
+        DDSMetadata& metadata, std::vector<BCImage>& images, std::vector<uint8_t>& pixels, size_t threads = 0)
+    {
+        return Internal::DecodeDDS(data, size, metadata, images, pixels, threads);
+    }
+
+    inline HRESULT DecodeBCDDS(_In_reads_bytes_(size) const uint8_t* data, size_t size,
+        DDSMetadata& metadata, std::vector<BCImage>& images, std::vector<float>& pixels, size_t threads = 0)
+    {
+        return Internal::DecodeDDS(data, size, metadata, images, pixels, threads);
+    }
+}
@@ -0,0 +1,758 @@
+//--------------------------------------------------------------------------------------
+// File: BoundingVolumeHierarchy.h
+//
+// Bounding volume hierarchy over DirectXCollision boxes for picking and culling queries
+//
+// Build() takes one BoundingBox per object and produces a binary tree of axis-aligned
+// nodes, flattened into a single array of 32-byte nodes with children stored as adjacent
+// pairs. Splits are chosen with a binned surface area heuristic (SAH); large builds are
+// split across threads once the top of the tree is in place.
+//
+// Queries return object indices (positions in the array passed to Build) with the same
+// results as testing every box directly:
+//
+//  Query(ray, callback(index, dist))       every box hit, as Ray::Intersects(BoundingBox)
+//  Nearest(ray, index, dist)               the closest box hit
+//  Nearest(ray, test, index, dist)         closest hit of a caller test (e.g. triangles)
+//  Query(volume, callback(index))          every box intersecting a BoundingFrustum,
+//                                          BoundingSphere, BoundingBox or BoundingOrientedBox
+//
+// For moving objects, Refit() updates the bounds in place without changing the tree;
+// rebuild when objects have moved far enough that queries slow down.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SimpleMath.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace DX
+{
+    class BoundingVolumeHierarchy
+    {
+    public:
+        struct Node
+        {
+            DirectX::XMFLOAT3   min;
+            uint32_t            leftFirst;  // First child (interior) or first object slot (leaf)
+            DirectX::XMFLOAT3   max;
+            uint32_t            count;      // Objects in a leaf; 0 for interior nodes
+        };
+
+        static_assert(sizeof(Node) == 32, "Node should be 32 bytes");
+
+        static constexpr uint32_t c_MaxLeafSize = 4;
+        static constexpr uint32_t c_Bins = 16;
+        static constexpr uint32_t c_MaxDepth = 64;
+
+        // Subtrees smaller than this are not worth a thread of their own
+        static constexpr uint32_t c_ParallelThreshold = 4096;
+
+        BoundingVolumeHierarchy() = default;
+
+        BoundingVolumeHierarchy(BoundingVolumeHierarchy&&) = default;
+        BoundingVolumeHierarchy& operator= (BoundingVolumeHierarchy&&) = default;
+
+        BoundingVolumeHierarchy(BoundingVolumeHierarchy const&) = default;
+        BoundingVolumeHierarchy& operator= (BoundingVolumeHierarchy const&) = default;
+
+        // 'threads' of 0 uses every hardware thread; 1 builds on the calling thread
+        void Build(_In_reads_(count) const DirectX::BoundingBox* boxes, size_t count, size_t threads = 0);
+
+        // Same objects (count and order) as the last Build, at new positions
+        void Refit(_In_reads_(count) const DirectX::BoundingBox* boxes, size_t count);
+
+        size_t Size() const noexcept { return m_indices.size(); }
+        size_t NodeCount() const noexcept { return m_nodes.size(); }
+        const Node* GetNodes() const noexcept { return m_nodes.data(); }
+        uint32_t Depth() const noexcept { return m_depth; }
+
+        DirectX::BoundingBox GetBounds() const noexcept
+        {
+            DirectX::BoundingBox box(DirectX::XMFLOAT3(0.f, 0.f, 0.f), DirectX::XMFLOAT3(0.f, 0.f, 0.f));
+            if (!m_nodes.empty())
+            {
+                box = NodeBox(m_nodes[0]);
+            }
+            return box;
+        }
+
+        // Estimated traversal cost relative to a single box test, for deciding when to rebuild
+        float Cost() const noexcept;
+
+        template<typename TCallback>
+        void Query(const DirectX::SimpleMath::Ray& ray, TCallback&& callback) const;
+
+        bool Nearest(const DirectX::SimpleMath::Ray& ray, uint32_t& index, float& dist) const
+        {
+            return Nearest(ray,
+                [this, &ray](uint32_t slot, float& d) { return ray.Intersects(m_boxes[slot], d); },
+                index, dist, true);
+        }
+
+        // 'test(index, dist)' returns true on a hit, which must lie inside the object's box
+        template<typename TTest>
+        bool Nearest(const DirectX::SimpleMath::Ray& ray, TTest&& test, uint32_t& index, float& dist) const
+        {
+            return Nearest(ray,
+                [this, &test](uint32_t slot, float& d) { return test(m_indices[slot], d); },
+                index, dist, true);
+        }
+
+        template<typename TVolume, typename TCallback>
+        void Query(const TVolume& volume, TCallback&& callback) const;
+
+    private:
+        struct RayInfo
+        {
+            float       origin[3];
+            float       inverse[3];
+            bool        parallel[3];
+
+            explicit RayInfo(const DirectX::SimpleMath::Ray& ray) noexcept;
+        };
+
+        struct Range
+        {
+            uint32_t    node;
+            uint32_t    first;
+            uint32_t    count;
+            uint32_t    depth;
+        };
+
+        struct BuildContext
+        {
+            const DirectX::BoundingBox* boxes;
+            std::vector<DirectX::XMFLOAT3> centroids;
+            std::atomic<uint32_t>       nextNode;
+            std::atomic<uint32_t>       depth;
+        };
+
+        std::vector<Node>                   m_nodes;
+        std::vector<uint32_t>               m_indices;  // Object index for each slot
+        std::vector<DirectX::BoundingBox>   m_boxes;    // Object boxes in slot order
+        uint32_t                            m_depth = 0;
+
+        static DirectX::BoundingBox NodeBox(const Node& node) noexcept
+        {
+            DirectX::BoundingBox box;
+            DirectX::BoundingBox::CreateFromPoints(box, DirectX::XMLoadFloat3(&node.min), DirectX::XMLoadFloat3(&node.max));
+            return box;
+        }
+
+        static float HalfArea(const DirectX::XMFLOAT3& min, const DirectX::XMFLOAT3& max) noexcept
+        {
+            const float dx = max.x - min.x;
+            const float dy = max.y - min.y;
+            const float dz = max.z - min.z;
+            return dx * dy + dy * dz + dz * dx;
+        }
+
+        static void SetBounds(Node& node, const DirectX::BoundingBox& box) noexcept
+        {
+            node.min = DirectX::XMFLOAT3(box.Center.x - box.Extents.x, box.Center.y - box.Extents.y, box.Center.z - box.Extents.z);
+            node.max = DirectX::XMFLOAT3(box.Center.x + box.Extents.x, box.Center.y + box.Extents.y, box.Center.z + box.Extents.z);
+        }
+
+        static void Grow(Node& node, const DirectX::XMFLOAT3& min, const DirectX::XMFLOAT3& max) noexcept
+        {
+            node.min = DirectX::XMFLOAT3(std::min(node.min.x, min.x), std::min(node.min.y, min.y), std::min(node.min.z, min.z));
+            node.max = DirectX::XMFLOAT3(std::max(node.max.x, max.x), std::max(node.max.y, max.y), std::max(node.max.z, max.z));
+        }
+
+        static bool Intersects(const Node& node, const RayInfo& ray, float& tnear) noexcept;
+
+        bool Subdivide(BuildContext& context, const Range& range, Range& left, Range& right);
+        void BuildSubtree(BuildContext& context, const Range& range);
+
+        template<typename TTest>
+        bool Nearest(const DirectX::SimpleMath::Ray& ray, TTest&& test, uint32_t& index, float& dist, bool) const;
+
+        template<typename TCallback>
+        void EmitSubtree(uint32_t node, TCallback& callback) const;
+    };
+
+
+    //==================================================================================
+    // Implementation
+    //==================================================================================
+
+    inline BoundingVolumeHierarchy::RayInfo::RayInfo(const DirectX::SimpleMath::Ray& ray) noexcept
+    {
+        const float* position = &ray.position.x;
+        const float* direction = &ray.direction.x;
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            origin[axis] = position[axis];
+            inverse[axis] = 1.f / direction[axis];
+
+            // Same threshold as BoundingBox::Intersects
+            parallel[axis] = std::fabs(direction[axis]) <= 1e-20f;
+        }
+    }
+
+    // Conservative slab test; 'tnear' is the entry distance (negative if the origin is inside)
+    inline bool BoundingVolumeHierarchy::Intersects(const Node& node, const RayInfo& ray, float& tnear) noexcept
+    {
+        const float* nmin = &node.min.x;
+        const float* nmax = &node.max.x;
+
+        float t0 = -FLT_MAX;
+        float t1 = FLT_MAX;
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            if (ray.parallel[axis])
+            {
+                if (ray.origin[axis] < nmin[axis] || ray.origin[axis] > nmax[axis])
+                    return false;
+                continue;
+            }
+
+            const float a = (nmin[axis] - ray.origin[axis]) * ray.inverse[axis];
+            const float b = (nmax[axis] - ray.origin[axis]) * ray.inverse[axis];
+            t0 = std::max(t0, std::min(a, b));
+            t1 = std::min(t1, std::max(a, b));
+        }
+
+        tnear = t0;
+        return (t0 <= t1) && (t1 >= 0.f);
+    }
+
+    //----------------------------------------------------------------------------------
+    // Computes the bounds of 'range' and either makes it a leaf (returns false) or splits
+    // it, allocating the two children.
+    inline bool BoundingVolumeHierarchy::Subdivide(BuildContext& context, const Range& range, Range& left, Range& right)
+    {
+        Node& node = m_nodes[range.node];
+
+        uint32_t* indices = m_indices.data() + range.first;
+        const auto& centroids = context.centroids;
+
+        SetBounds(node, context.boxes[indices[0]]);
+        DirectX::XMFLOAT3 cmin = centroids[indices[0]];
+        DirectX::XMFLOAT3 cmax = cmin;
+        for (uint32_t j = 1; j < range.count; ++j)
+        {
+            const auto& box = context.boxes[indices[j]];
+            Grow(node,
+                DirectX::XMFLOAT3(box.Center.x - box.Extents.x, box.Center.y - box.Extents.y, box.Center.z - box.Extents.z),
+                DirectX::XMFLOAT3(box.Center.x + box.Extents.x, box.Center.y + box.Extents.y, box.Center.z + box.Extents.z));
+
+            const auto& c = centroids[indices[j]];
+            cmin = DirectX::XMFLOAT3(std::min(cmin.x, c.x), std::min(cmin.y, c.y), std::min(cmin.z, c.z));
+            cmax = DirectX::XMFLOAT3(std::max(cmax.x, c.x), std::max(cmax.y, c.y), std::max(cmax.z, c.z));
+        }
+
+        uint32_t depth = context.depth.load(std::memory_order_relaxed);
+        while (range.depth > depth && !context.depth.compare_exchange_weak(depth, range.depth, std::memory_order_relaxed)) {}
+
+        node.leftFirst = range.first;
+        node.count = range.count;
+        if (range.count <= c_MaxLeafSize)
+            return false;
+
+        // Binned SAH over the longest centroid axis that has any spread
+        const float* lo = &cmin.x;
+        const float* hi = &cmax.x;
+
+        uint32_t bestAxis = 3;
+        uint32_t bestBin = 0;
+        float bestCost = FLT_MAX;
+
+        if (range.depth < c_MaxDepth - 32)
+        {
+            for (uint32_t axis = 0; axis < 3; ++axis)
+            {
+                const float extent = hi[axis] - lo[axis];
+                if (!(extent > 0.f))
+                    continue;
+
+                struct Bin
+                {
+                    Node        bounds;
+                    uint32_t    count;
+                };
+
+                Bin bins[c_Bins] = {};
+                const float scale = float(c_Bins) / extent;
+                for (uint32_t j = 0; j < range.count; ++j)
+                {
+                    const uint32_t b = std::min(c_Bins - 1, uint32_t(((&centroids[indices[j]].x)[axis] - lo[axis]) * scale));
+                    const auto& box = context.boxes[indices[j]];
+                    if (!bins[b].count)
+                    {
+                        SetBounds(bins[b].bounds, box);
+                    }
+                    else
+                    {
+                        Node other;
+                        SetBounds(other, box);
+                        Grow(bins[b].bounds, other.min, other.max);
+                    }
+                    ++bins[b].count;
+                }
+
+                // Sweep from the right to get the cost of every split plane
+                float rightArea[c_Bins] = {};
+                uint32_t rightCount[c_Bins] = {};
+                Node accum = {};
+                uint32_t total = 0;
+                for (uint32_t b = c_Bins - 1; b > 0; --b)
+                {
+                    if (bins[b].count)
+                    {
+                        if (!total)
+                            accum = bins[b].bounds;
+                        else
+                            Grow(accum, bins[b].bounds.min, bins[b].bounds.max);
+                        total += bins[b].count;
+                    }
+                    rightArea[b] = total ? HalfArea(accum.min, accum.max) : 0.f;
+                    rightCount[b] = total;
+                }
+
+                total = 0;
+                for (uint32_t b = 0; b < c_Bins - 1; ++b)
+                {
+                    if (bins[b].count)
+                    {
+                        if (!total)
+                            accum = bins[b].bounds;
+                        else
+                            Grow(accum, bins[b].bounds.min, bins[b].bounds.max);
+                        total += bins[b].count;
+                    }
+
+                    if (!total || !rightCount[b + 1])
+                        continue;
+
+                    const float cost = float(total) * HalfArea(accum.min, accum.max) + float(rightCount[b + 1]) * rightArea[b + 1];
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestBin = b;
+                    }
+                }
+            }
+        }
+
+        uint32_t leftCount = 0;
+        if (bestAxis < 3)
+        {
+            // A leaf is cheaper than any split: one test per object
+            const float leafCost = float(range.count) * HalfArea(node.min, node.max);
+            if (bestCost >= leafCost && range.count <= c_MaxLeafSize * 4)
+                return false;
+
+            const float base = lo[bestAxis];
+            const float scale = float(c_Bins) / (hi[bestAxis] - base);
+            uint32_t* mid = std::partition(indices, indices + range.count, [&](uint32_t index)
+                {
+                    const uint32_t b = std::min(c_Bins - 1, uint32_t(((&centroids[index].x)[bestAxis] - base) * scale));
+                    return b <= bestBin;
+                });
+            leftCount = uint32_t(mid - indices);
+        }
+
+        if (leftCount == 0 || leftCount == range.count)
+        {
+            // Coincident centroids or too deep for SAH: split evenly along the widest axis
+            uint32_t axis = 0;
+            for (uint32_t a = 1; a < 3; ++a)
+            {
+                if (hi[a] - lo[a] > hi[axis] - lo[axis])
+                    axis = a;
+            }
+
+            leftCount = range.count / 2;
+            std::nth_element(indices, indices + leftCount, indices + range.count, [&](uint32_t a, uint32_t b)
+                {
+                    return (&centroids[a].x)[axis] < (&centroids[b].x)[axis];
+                });
+        }
+
+        const uint32_t child = context.nextNode.fetch_add(2, std::memory_order_relaxed);
+        node.leftFirst = child;
+        node.count = 0;
+
+        left = Range{ child, range.first, leftCount, range.depth + 1 };
+        right = Range{ child + 1, range.first + leftCount, range.count - leftCount, range.depth + 1 };
+        return true;
+    }
+
+    inline void BoundingVolumeHierarchy::BuildSubtree(BuildContext& context, const Range& range)
+    {
+        std::vector<Range> stack;
+        stack.push_back(range);
+        while (!stack.empty())
+        {
+            const Range current = stack.back();
+            stack.pop_back();
+
+            Range left, right;
+            if (Subdivide(context, current, left, right))
+            {
+                stack.push_back(right);
+                stack.push_back(left);
+            }
+        }
+    }
+
+    inline void BoundingVolumeHierarchy::Build(const DirectX::BoundingBox* boxes, size_t count, size_t threads)
+    {
+        if ((!boxes && count > 0) || count > (UINT32_MAX / 2))
+            throw std::invalid_argument("BoundingVolumeHierarchy::Build");
+
+        m_nodes.clear();
+        m_indices.clear();
+        m_boxes.clear();
+        m_depth = 0;
+
+        if (!count)
+            return;
+
+        BuildContext context;
+        context.boxes = boxes;
+        context.centroids.resize(count);
+        context.nextNode = 1;
+        context.depth = 0;
+
+        m_indices.resize(count);
+        for (size_t j = 0; j < count; ++j)
+        {
+            m_indices[j] = uint32_t(j);
+            context.centroids[j] = boxes[j].Center;
+        }
+
+        // A binary tree with at least one object per leaf has at most 2n - 1 nodes
+        m_nodes.resize(count * 2 - 1);
+
+        if (!threads)
+        {
+            threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+
+        const Range root = { 0, 0, uint32_t(count), 0 };
+        if (threads <= 1 || count < c_ParallelThreshold)
+        {
+            BuildSubtree(context, root);
+        }
+        else
+        {
+            // Split the top of the tree here until there is enough independent work to share out;
+            // each subtree owns a disjoint range of slots, and nodes come from the atomic counter.
+            std::vector<Range> work;
+            std::vector<Range> pending = { root };
+            for (size_t j = 0; j < pending.size(); ++j)
+            {
+                const Range current = pending[j];
+                if (current.count < c_ParallelThreshold || (work.size() + pending.size() - j) >= threads * 4)
+                {
+                    work.push_back(current);
+                    continue;
+                }
+
+                Range left, right;
+                if (Subdivide(context, current, left, right))
+                {
+                    pending.push_back(left);
+                    pending.push_back(right);
+                }
+            }
+
+            // Largest first for better balance across threads
+            std::sort(work.begin(), work.end(), [](const Range& a, const Range& b) { return a.count > b.count; });
+
+            threads = std::min(threads, work.size());
+            std::atomic<size_t> next(0);
+
+            auto worker = [&]()
+            {
+                for (;;)
+                {
+                    const size_t item = next.fetch_add(1);
+                    if (item >= work.size())
+                        break;
+
+                    BuildSubtree(context, work[item]);
+                }
+            };
+
+            std::vector<std::thread> pool;
+            pool.reserve(threads - 1);
+            for (size_t j = 1; j < threads; ++j)
+            {
+                pool.emplace_back(worker);
+            }
+            worker();
+            for (auto& t : pool)
+            {
+                t.join();
+            }
+        }
+
+        m_nodes.resize(context.nextNode.load());
+        m_nodes.shrink_to_fit();
+        m_depth = context.depth.load();
+
+        m_boxes.resize(count);
+        for (size_t j = 0; j < count; ++j)
+        {
+            m_boxes[j] = boxes[m_indices[j]];
+        }
+    }
+
+    inline void BoundingVolumeHierarchy::Refit(const DirectX::BoundingBox* boxes, size_t count)
+    {
+        if (count != m_indices.size() || (!boxes && count > 0))
+            throw std::invalid_argument("BoundingVolumeHierarchy::Refit");
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            m_boxes[j] = boxes[m_indices[j]];
+        }
+
+        // Children are always allocated after their parent, so a reverse sweep is bottom-up
+        for (size_t j = m_nodes.size(); j-- > 0; )
+        {
+            Node& node = m_nodes[j];
+            if (node.count)
+            {
+                SetBounds(node, m_boxes[node.leftFirst]);
+                for (uint32_t k = 1; k < node.count; ++k)
+                {
+                    Node other;
+                    SetBounds(other, m_boxes[node.leftFirst + k]);
+                    Grow(node, other.min, other.max);
+                }
+            }
+            else
+            {
+                const Node& left = m_nodes[node.leftFirst];
+                const Node& right = m_nodes[node.leftFirst + 1];
+                node.min = left.min;
+                node.max = left.max;
+                Grow(node, right.min, right.max);
+            }
+        }
+    }
+
+    inline float BoundingVolumeHierarchy::Cost() const noexcept
+    {
+        if (m_nodes.empty())
+            return 0.f;
+
+        const float rootArea = HalfArea(m_nodes[0].min, m_nodes[0].max);
+        if (!(rootArea > 0.f))
+            return float(m_nodes.size());
+
+        // Each node is visited with probability proportional to its surface area
+        float cost = 0.f;
+        for (const auto& node : m_nodes)
+        {
+            const float p = HalfArea(node.min, node.max) / rootArea;
+            cost += p * (node.count ? float(node.count) : 1.f);
+        }
+        return cost;
+    }
+
+    //----------------------------------------------------------------------------------
+    template<typename TCallback>
+    void BoundingVolumeHierarchy::Query(const DirectX::SimpleMath::Ray& ray, TCallback&& callback) const
+    {
+        if (m_nodes.empty())
+            return;
+
+        const RayInfo r(ray);
+
+        uint32_t stack[c_MaxDepth + 1];
+        uint32_t top = 0;
+        stack[top++] = 0;
+        while (top)
+        {
+            const Node& node = m_nodes[stack[--top]];
+
+            float tnear;
+            if (!Intersects(node, r, tnear))
+                continue;
+
+            if (node.count)
+            {
+                for (uint32_t slot = node.leftFirst; slot < node.leftFirst + node.count; ++slot)
+                {
+                    float dist = 0.f;
+                    if (ray.Intersects(m_boxes[slot], dist))
+                    {
+                        callback(m_indices[slot], dist);
+                    }
+                }
+            }
+            else
+            {
+                stack[top++] = node.leftFirst + 1;
+                stack[top++] = node.leftFirst;
+            }
+        }
+    }
+
+    template<typename TTest>
+    bool BoundingVolumeHierarchy::Nearest(const DirectX::SimpleMath::Ray& ray, TTest&& test, uint32_t& index, float& dist, bool) const
+    {
+        if (m_nodes.empty())
+            return false;
+
+        const RayInfo r(ray);
+
+        float best = FLT_MAX;
+        uint32_t bestSlot = UINT32_MAX;
+
+        struct Entry
+        {
+            uint32_t    node;
+            float       tnear;
+        };
+
+        Entry stack[c_MaxDepth + 1];
+        uint32_t top = 0;
+
+        float tnear;
+        if (!Intersects(m_nodes[0], r, tnear))
+            return false;
+        stack[top++] = Entry{ 0, tnear };
+
+        while (top)
+        {
+            const Entry entry = stack[--top];
+            if (entry.tnear > best)
+                continue;
+
+            const Node& node = m_nodes[entry.node];
+            if (node.count)
+            {
+                for (uint32_t slot = node.leftFirst; slot < node.leftFirst + node.count; ++slot)
+                {
+                    float d = 0.f;
+                    if (test(slot, d) && d < best)
+                    {
+                        best = d;
+                        bestSlot = slot;
+                    }
+                }
+                continue;
+            }
+
+            // Visit the nearer child first so the farther one is more likely to be pruned
+            float t0, t1;
+            const bool hit0 = Intersects(m_nodes[node.leftFirst], r, t0);
+            const bool hit1 = Intersects(m_nodes[node.leftFirst + 1], r, t1);
+            if (hit0 && hit1)
+            {
+                if (t0 <= t1)
+                {
+                    stack[top++] = Entry{ node.leftFirst + 1, t1 };
+                    stack[top++] = Entry{ node.leftFirst, t0 };
+                }
+                else
+                {
+                    stack[top++] = Entry{ node.leftFirst, t0 };
+                    stack[top++] = Entry{ node.leftFirst + 1, t1 };
+                }
+            }
+            else if (hit0)
+            {
+                stack[top++] = Entry{ node.leftFirst, t0 };
+            }
+            else if (hit1)
+            {
+                stack[top++] = Entry{ node.leftFirst + 1, t1 };
+            }
+        }
+
+        if (bestSlot == UINT32_MAX)
+            return false;
+
+        index = m_indices[bestSlot];
+        dist = best;
+        return true;
+    }
+
+    template<typename TCallback>
+    void BoundingVolumeHierarchy::EmitSubtree(uint32_t root, TCallback& callback) const
+    {
+        uint32_t stack[c_MaxDepth + 1];
+        uint32_t top = 0;
+        stack[top++] = root;
+        while (top)
+        {
+            const Node& node = m_nodes[stack[--top]];
+            if (node.count)
+            {
+                for (uint32_t slot = node.leftFirst; slot < node.leftFirst + node.count; ++slot)
+                {
+                    callback(m_indices[slot]);
+                }
+            }
+            else
+            {
+                stack[top++] = node.leftFirst + 1;
+                stack[top++] = node.leftFirst;
+            }
+        }
+    }
+
+    template<typename TVolume, typename TCallback>
+    void BoundingVolumeHierarchy::Query(const TVolume& volume, TCallback&& callback) const
+    {
+        if (m_nodes.empty())
+            return;
+
+        uint32_t stack[c_MaxDepth + 1];
+        uint32_t top = 0;
+        stack[top++] = 0;
+        while (top)
+        {
+            const uint32_t current = stack[--top];
+            const Node& node = m_nodes[current];
+
+            const DirectX::ContainmentType containment = volume.Contains(NodeBox(node));
+            if (containment == DirectX::DISJOINT)
+                continue;
+
+            if (containment == DirectX::CONTAINS)
+            {
+                // Everything below is inside the volume; no further tests needed
+                EmitSubtree(current, callback);
+            }
+            else if (node.count)
+            {
+                for (uint32_t slot = node.leftFirst; slot < node.leftFirst + node.count; ++slot)
+                {
+                    if (volume.Intersects(m_boxes[slot]))
+                    {
+                        callback(m_indices[slot]);
+                    }
+                }
+            }
+            else
+            {
+                stack[top++] = node.leftFirst + 1;
+                stack[top++] = node.leftFirst;
+            }
+        }
+    }
+}
@@ -0,0 +1,620 @@
+//--------------------------------------------------------------------------------------
+// File: ColorConversion.h
+//
+// Batch color-space conversions over SimpleMath::Color arrays
+//
+// XMColorSRGBToRGB and friends convert one color per call, and XMVectorPow is evaluated
+// one lane at a time, so converting a texture or a tonemap preview pixel by pixel is slow.
+// These kernels stream through Color arrays instead: each block of 4 (or 8 with AVX)
+// colors is transposed into r, g, b and a registers, converted with the SoAMath lane
+// operations, and transposed back. Powers are computed as Exp2(y * Log2(x)) across the
+// whole block.
+//
+// - SRGBToLinear / LinearToSRGB match XMColorSRGBToRGB / XMColorRGBToSRGB, including
+//   clamping the input to [0,1]
+// - ConvertColorPrimaries rotates linear colors between Rec.709 (HDTV), Rec.2020 (UHDTV)
+//   and DCI-P3 with a D65 white point, as ToneMapPostProcess does on the GPU
+// - LinearToST2084 / ST2084ToLinear are the SMPTE ST.2084 (PQ) curve; 'whiteNits' is the
+//   luminance of a linear value of 1, and the default maps 1 to the 10,000 nit peak
+// - LinearToHDR10 / HDR10ToLinear combine the Rec.709 to Rec.2020 rotation, paper white
+//   scaling and PQ curve in one pass, the same steps as ToneMapPostProcess::ST2084
+// - PremultiplyAlpha / UnpremultiplyAlpha scale rgb by alpha; zero alpha unpremultiplies
+//   to black
+//
+// Alpha passes through unchanged except where noted. 'result' may be the same array as
+// 'colors'.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SoAMath.h"
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(_XM_ARM_NEON_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+#include <arm_neon.h>
+#endif
+
+
+namespace DX
+{
+    enum class ColorPrimaries
+    {
+        HDTV,           // Rec.709 / sRGB
+        UHDTV,          // Rec.2020
+        DCI_P3_D65,     // Display P3
+    };
+
+    // Luminance of a PQ code value of 1
+    constexpr float c_ST2084MaxNits = 10000.f;
+
+    // Reference white for HDR10 output, matching the ToneMapPostProcess default
+    constexpr float c_HDR10PaperWhiteNits = 200.f;
+
+    void SRGBToLinear(
+        _In_reads_(count) const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        _Out_writes_(count) DirectX::SimpleMath::Color* result);
+
+    void LinearToSRGB(
+        _In_reads_(count) const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        _Out_writes_(count) DirectX::SimpleMath::Color* result);
+
+    void ConvertColorPrimaries(
+        _In_reads_(count) const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        _Out_writes_(count) DirectX::SimpleMath::Color* result,
+        ColorPrimaries from,
+        ColorPrimaries to);
+
+    // Negative values encode as 0; values brighter than the peak are not clamped
+    void LinearToST2084(
+        _In_reads_(count) const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        _Out_writes_(count) DirectX::SimpleMath::Color* result,
+        float whiteNits = c_ST2084MaxNits);
+
+    // Code values are clamped to [0,1]
+    void ST2084ToLinear(
+        _In_reads_(count) const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        _Out_writes_(count) DirectX::SimpleMath::Color* result,
+        float whiteNits = c_ST2084MaxNits);
+
+    void LinearToHDR10(
+        _In_reads_(count) const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        _Out_writes_(count) DirectX::SimpleMath::Color* result,
+        float paperWhiteNits = c_HDR10PaperWhiteNits);
+
+    void HDR10ToLinear(
+        _In_reads_(count) const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        _Out_writes_(count) DirectX::SimpleMath::Color* result,
+        float paperWhiteNits = c_HDR10PaperWhiteNits);
+
+    void PremultiplyAlpha(
+        _In_reads_(count) const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        _Out_writes_(count) DirectX::SimpleMath::Color* result);
+
+    void UnpremultiplyAlpha(
+        _In_reads_(count) const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        _Out_writes_(count) DirectX::SimpleMath::Color* result);
+
+
+    //==================================================================================
+    // Implementation
+    //==================================================================================
+
+    namespace SoADetail
+    {
+        // Transposes four packed XMFLOAT4s into r, g, b and a registers and back
+        inline void XM_CALLCONV LoadColors(
+            _In_reads_(4) const DirectX::XMFLOAT4* p,
+            DirectX::XMVECTOR& r, DirectX::XMVECTOR& g, DirectX::XMVECTOR& b, DirectX::XMVECTOR& a) noexcept
+        {
+        #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            __m128 c0 = _mm_loadu_ps(&p[0].x);
+            __m128 c1 = _mm_loadu_ps(&p[1].x);
+            __m128 c2 = _mm_loadu_ps(&p[2].x);
+            __m128 c3 = _mm_loadu_ps(&p[3].x);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            r = c0;
+            g = c1;
+            b = c2;
+            a = c3;
+        #elif defined(_XM_ARM_NEON_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            const float32x4x4_t v = vld4q_f32(&p->x);
+            r = v.val[0];
+            g = v.val[1];
+            b = v.val[2];
+            a = v.val[3];
+        #else
+            r = DirectX::XMVectorSet(p[0].x, p[1].x, p[2].x, p[3].x);
+            g = DirectX::XMVectorSet(p[0].y, p[1].y, p[2].y, p[3].y);
+            b = DirectX::XMVectorSet(p[0].z, p[1].z, p[2].z, p[3].z);
+            a = DirectX::XMVectorSet(p[0].w, p[1].w, p[2].w, p[3].w);
+        #endif
+        }
+
+        inline void XM_CALLCONV StoreColors(
+            _Out_writes_(4) DirectX::XMFLOAT4* p,
+            DirectX::FXMVECTOR r, DirectX::FXMVECTOR g, DirectX::FXMVECTOR b, DirectX::GXMVECTOR a) noexcept
+        {
+        #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            __m128 c0 = r;
+            __m128 c1 = g;
+            __m128 c2 = b;
+            __m128 c3 = a;
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            _mm_storeu_ps(&p[0].x, c0);
+            _mm_storeu_ps(&p[1].x, c1);
+            _mm_storeu_ps(&p[2].x, c2);
+            _mm_storeu_ps(&p[3].x, c3);
+        #elif defined(_XM_ARM_NEON_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            float32x4x4_t v;
+            v.val[0] = r;
+            v.val[1] = g;
+            v.val[2] = b;
+            v.val[3] = a;
+            vst4q_f32(&p->x, v);
+        #else
+            DirectX::XMFLOAT4 fr, fg, fb, fa;
+            DirectX::XMStoreFloat4(&fr, r);
+            DirectX::XMStoreFloat4(&fg, g);
+            DirectX::XMStoreFloat4(&fb, b);
+            DirectX::XMStoreFloat4(&fa, a);
+            p[0] = DirectX::XMFLOAT4(fr.x, fg.x, fb.x, fa.x);
+            p[1] = DirectX::XMFLOAT4(fr.y, fg.y, fb.y, fa.y);
+            p[2] = DirectX::XMFLOAT4(fr.z, fg.z, fb.z, fa.z);
+            p[3] = DirectX::XMFLOAT4(fr.w, fg.w, fb.w, fa.w);
+        #endif
+        }
+
+    #ifdef DX_SOA_AVX
+        inline void XM_CALLCONV LoadColors(_In_reads_(8) const DirectX::XMFLOAT4* p, __m256& r, __m256& g, __m256& b, __m256& a) noexcept
+        {
+            __m128 r0, g0, b0, a0, r1, g1, b1, a1;
+            LoadColors(p, r0, g0, b0, a0);
+            LoadColors(p + 4, r1, g1, b1, a1);
+            r = _mm256_insertf128_ps(_mm256_castps128_ps256(r0), r1, 1);
+            g = _mm256_insertf128_ps(_mm256_castps128_ps256(g0), g1, 1);
+            b = _mm256_insertf128_ps(_mm256_castps128_ps256(b0), b1, 1);
+            a = _mm256_insertf128_ps(_mm256_castps128_ps256(a0), a1, 1);
+        }
+
+        inline void XM_CALLCONV StoreColors(_Out_writes_(8) DirectX::XMFLOAT4* p, __m256 r, __m256 g, __m256 b, __m256 a) noexcept
+        {
+            StoreColors(p, _mm256_castps256_ps128(r), _mm256_castps256_ps128(g), _mm256_castps256_ps128(b), _mm256_castps256_ps128(a));
+            StoreColors(p + 4, _mm256_extractf128_ps(r, 1), _mm256_extractf128_ps(g, 1), _mm256_extractf128_ps(b, 1), _mm256_extractf128_ps(a, 1));
+        }
+    #endif
+
+        // Applies op(r, g, b, a) to every color, a block at a time
+        template<typename L, typename Op>
+        void TransformColors(
+            _In_reads_(count) const DirectX::XMFLOAT4* colors,
+            size_t count,
+            _Out_writes_(count) DirectX::XMFLOAT4* result,
+            const Op& op)
+        {
+            using V = typename L::V;
+
+            for (size_t j = 0; j < count; j += L::Width)
+            {
+                const size_t remaining = count - j;
+
+                // The last partial block goes through a local copy
+                DirectX::XMFLOAT4 tail[L::Width] = {};
+                const bool partial = remaining < L::Width;
+                if (partial)
+                {
+                    memcpy(tail, colors + j, remaining * sizeof(DirectX::XMFLOAT4));
+                }
+
+                V r, g, b, a;
+                LoadColors(partial ? tail : colors + j, r, g, b, a);
+
+                op(r, g, b, a);
+
+                if (partial)
+                {
+                    StoreColors(tail, r, g, b, a);
+                    memcpy(result + j, tail, remaining * sizeof(DirectX::XMFLOAT4));
+                }
+                else
+                {
+                    StoreColors(result + j, r, g, b, a);
+                }
+            }
+        }
+
+        template<typename L>
+        typename L::V XM_CALLCONV Saturate(typename L::V x) noexcept
+        {
+            return L::Max(L::Min(x, L::Splat(1.f)), L::Zero());
+        }
+
+        // x^y for a positive exponent; x <= 0 gives 0
+        template<typename L>
+        typename L::V XM_CALLCONV Pow(typename L::V x, typename L::V y) noexcept
+        {
+            const typename L::V p = L::Exp2(L::Multiply(y, L::Log2(x)));
+            return L::And(p, L::Greater(x, L::Zero()));
+        }
+
+        // Piecewise sRGB curve, with the constants XMColorSRGBToRGB and XMColorRGBToSRGB use
+        template<typename L>
+        struct SRGBCurve
+        {
+            using V = typename L::V;
+
+            V decodeCutoff = L::Splat(0.04045f);
+            V encodeCutoff = L::Splat(0.0031308f);
+            V linear = L::Splat(12.92f);
+            V invLinear = L::Splat(1.f / 12.92f);
+            V scale = L::Splat(1.055f);
+            V invScale = L::Splat(1.f / 1.055f);
+            V bias = L::Splat(0.055f);
+            V gamma = L::Splat(2.4f);
+            V invGamma = L::Splat(1.f / 2.4f);
+
+            V XM_CALLCONV Decode(V x) const noexcept
+            {
+                const V v = Saturate<L>(x);
+                const V curve = Pow<L>(L::Multiply(L::Add(v, bias), invScale), gamma);
+                return L::Select(L::Multiply(v, invLinear), curve, L::Greater(v, decodeCutoff));
+            }
+
+            V XM_CALLCONV Encode(V x) const noexcept
+            {
+                const V v = Saturate<L>(x);
+                const V curve = L::Subtract(L::Multiply(scale, Pow<L>(v, invGamma)), bias);
+                return L::Select(curve, L::Multiply(v, linear), L::Less(v, encodeCutoff));
+            }
+        };
+
+        // SMPTE ST.2084 on luminance normalized to the 10,000 nit peak
+        template<typename L>
+        struct ST2084Curve
+        {
+            using V = typename L::V;
+
+            V m1 = L::Splat(2610.f / 16384.f);
+            V m2 = L::Splat(2523.f / 4096.f * 128.f);
+            V invM1 = L::Splat(16384.f / 2610.f);
+            V invM2 = L::Splat(4096.f / (2523.f * 128.f));
+            V c1 = L::Splat(3424.f / 4096.f);
+            V c2 = L::Splat(2413.f / 4096.f * 32.f);
+            V c3 = L::Splat(2392.f / 4096.f * 32.f);
+            V one = L::Splat(1.f);
+
+            V XM_CALLCONV Encode(V y) const noexcept
+            {
+                const V p = Pow<L>(L::Max(y, L::Zero()), m1);
+                return Pow<L>(L::Divide(L::MultiplyAdd(c2, p, c1), L::MultiplyAdd(c3, p, one)), m2);
+            }
+
+            V XM_CALLCONV Decode(V e) const noexcept
+            {
+                const V p = Pow<L>(Saturate<L>(e), invM2);
+                const V n = L::Max(L::Subtract(p, c1), L::Zero());
+                return Pow<L>(L::Divide(n, L::Subtract(c2, L::Multiply(c3, p))), invM1);
+            }
+        };
+
+        // 3x3 matrices in double, applied as result = m * rgb
+        struct ColorMatrix
+        {
+            double m[3][3];
+
+            ColorMatrix operator* (const ColorMatrix& other) const noexcept
+            {
+                ColorMatrix result = {};
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    for (size_t j = 0; j < 3; ++j)
+                    {
+                        result.m[i][j] = m[i][0] * other.m[0][j] + m[i][1] * other.m[1][j] + m[i][2] * other.m[2][j];
+                    }
+                }
+                return result;
+            }
+
+            ColorMatrix Invert() const noexcept
+            {
+                const double c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+                const double c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+                const double c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+                const double invDet = 1.0 / (m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02);
+
+                ColorMatrix result;
+                result.m[0][0] = c00 * invDet;
+                result.m[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * invDet;
+                result.m[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * invDet;
+                result.m[1][0] = c01 * invDet;
+                result.m[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * invDet;
+                result.m[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * invDet;
+                result.m[2][0] = c02 * invDet;
+                result.m[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * invDet;
+                result.m[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * invDet;
+                return result;
+            }
+        };
+
+        // Linear RGB to CIE XYZ, derived from the xy chromaticities of each primary and D65
+        inline ColorMatrix RGBToXYZ(ColorPrimaries primaries)
+        {
+            static const double s_chromaticities[][6] =
+            {
+                { 0.640, 0.330, 0.300, 0.600, 0.150, 0.060 },   // HDTV
+                { 0.708, 0.292, 0.170, 0.797, 0.131, 0.046 },   // UHDTV
+                { 0.680, 0.320, 0.265, 0.690, 0.150, 0.060 },   // DCI_P3_D65
+            };
+            constexpr double c_WhiteX = 0.3127;
+            constexpr double c_WhiteY = 0.3290;
+
+            const auto index = static_cast<size_t>(primaries);
+            if (index >= std::size(s_chromaticities))
+                throw std::invalid_argument("ColorPrimaries");
+
+            const double* xy = s_chromaticities[index];
+
+            ColorMatrix p;
+            for (size_t j = 0; j < 3; ++j)
+            {
+                const double x = xy[j * 2];
+                const double y = xy[j * 2 + 1];
+                p.m[0][j] = x / y;
+                p.m[1][j] = 1.0;
+                p.m[2][j] = (1.0 - x - y) / y;
+            }
+
+            // Scale each primary so that rgb (1,1,1) is the white point
+            const ColorMatrix inv = p.Invert();
+            const double white[3] = { c_WhiteX / c_WhiteY, 1.0, (1.0 - c_WhiteX - c_WhiteY) / c_WhiteY };
+            for (size_t j = 0; j < 3; ++j)
+            {
+                const double s = inv.m[j][0] * white[0] + inv.m[j][1] * white[1] + inv.m[j][2] * white[2];
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    p.m[i][j] *= s;
+                }
+            }
+
+            return p;
+        }
+
+        inline ColorMatrix PrimariesMatrix(ColorPrimaries from, ColorPrimaries to)
+        {
+            return RGBToXYZ(to).Invert() * RGBToXYZ(from);
+        }
+
+        template<typename L>
+        struct ColorRotation
+        {
+            using V = typename L::V;
+
+            V m[3][3];
+
+            explicit ColorRotation(const ColorMatrix& matrix, double scale = 1.0) noexcept
+            {
+                for (size_t i = 0; i < 3; ++i)
+                {
+                    for (size_t j = 0; j < 3; ++j)
+                    {
+                        m[i][j] = L::Splat(static_cast<float>(matrix.m[i][j] * scale));
+                    }
+                }
+            }
+
+            void XM_CALLCONV Apply(V& r, V& g, V& b) const noexcept
+            {
+                const V x = L::MultiplyAdd(r, m[0][0], L::MultiplyAdd(g, m[0][1], L::Multiply(b, m[0][2])));
+                const V y = L::MultiplyAdd(r, m[1][0], L::MultiplyAdd(g, m[1][1], L::Multiply(b, m[1][2])));
+                const V z = L::MultiplyAdd(r, m[2][0], L::MultiplyAdd(g, m[2][1], L::Multiply(b, m[2][2])));
+                r = x;
+                g = y;
+                b = z;
+            }
+        };
+
+        inline void ValidateColors(const void* colors, size_t count, const void* result, const char* name)
+        {
+            if (count > 0 && (!colors || !result))
+                throw std::invalid_argument(name);
+        }
+
+        inline float NitsScale(float whiteNits, const char* name)
+        {
+            if (!(whiteNits > 0.f))
+                throw std::invalid_argument(name);
+
+            return whiteNits / c_ST2084MaxNits;
+        }
+    }
+
+    inline void SRGBToLinear(
+        const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        DirectX::SimpleMath::Color* result)
+    {
+        using L = SoADetail::Lanes;
+        SoADetail::ValidateColors(colors, count, result, "SRGBToLinear");
+
+        const SoADetail::SRGBCurve<L> curve;
+        SoADetail::TransformColors<L>(colors, count, result, [&](L::V& r, L::V& g, L::V& b, L::V&)
+        {
+            r = curve.Decode(r);
+            g = curve.Decode(g);
+            b = curve.Decode(b);
+        });
+    }
+
+    inline void LinearToSRGB(
+        const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        DirectX::SimpleMath::Color* result)
+    {
+        using L = SoADetail::Lanes;
+        SoADetail::ValidateColors(colors, count, result, "LinearToSRGB");
+
+        const SoADetail::SRGBCurve<L> curve;
+        SoADetail::TransformColors<L>(colors, count, result, [&](L::V& r, L::V& g, L::V& b, L::V&)
+        {
+            r = curve.Encode(r);
+            g = curve.Encode(g);
+            b = curve.Encode(b);
+        });
+    }
+
+    inline void ConvertColorPrimaries(
+        const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        DirectX::SimpleMath::Color* result,
+        ColorPrimaries from,
+        ColorPrimaries to)
+    {
+        using L = SoADetail::Lanes;
+        SoADetail::ValidateColors(colors, count, result, "ConvertColorPrimaries");
+
+        if (from == to)
+        {
+            if (count > 0 && colors != result)
+            {
+                memmove(result, colors, count * sizeof(DirectX::SimpleMath::Color));
+            }
+            return;
+        }
+
+        const SoADetail::ColorRotation<L> rotation(SoADetail::PrimariesMatrix(from, to));
+        SoADetail::TransformColors<L>(colors, count, result, [&](L::V& r, L::V& g, L::V& b, L::V&)
+        {
+            rotation.Apply(r, g, b);
+        });
+    }
+
+    inline void LinearToST2084(
+        const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        DirectX::SimpleMath::Color* result,
+        float whiteNits)
+    {
+        using L = SoADetail::Lanes;
+        SoADetail::ValidateColors(colors, count, result, "LinearToST2084");
+
+        const L::V scale = L::Splat(SoADetail::NitsScale(whiteNits, "LinearToST2084"));
+        const SoADetail::ST2084Curve<L> curve;
+        SoADetail::TransformColors<L>(colors, count, result, [&](L::V& r, L::V& g, L::V& b, L::V&)
+        {
+            r = curve.Encode(L::Multiply(r, scale));
+            g = curve.Encode(L::Multiply(g, scale));
+            b = curve.Encode(L::Multiply(b, scale));
+        });
+    }
+
+    inline void ST2084ToLinear(
+        const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        DirectX::SimpleMath::Color* result,
+        float whiteNits)
+    {
+        using L = SoADetail::Lanes;
+        SoADetail::ValidateColors(colors, count, result, "ST2084ToLinear");
+
+        const L::V scale = L::Splat(1.f / SoADetail::NitsScale(whiteNits, "ST2084ToLinear"));
+        const SoADetail::ST2084Curve<L> curve;
+        SoADetail::TransformColors<L>(colors, count, result, [&](L::V& r, L::V& g, L::V& b, L::V&)
+        {
+            r = L::Multiply(curve.Decode(r), scale);
+            g = L::Multiply(curve.Decode(g), scale);
+            b = L::Multiply(curve.Decode(b), scale);
+        });
+    }
+
+    inline void LinearToHDR10(
+        const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        DirectX::SimpleMath::Color* result,
+        float paperWhiteNits)
+    {
+        using L = SoADetail::Lanes;
+        SoADetail::ValidateColors(colors, count, result, "LinearToHDR10");
+
+        // The paper white scale is folded into the rotation
+        const double scale = SoADetail::NitsScale(paperWhiteNits, "LinearToHDR10");
+        const SoADetail::ColorRotation<L> rotation(SoADetail::PrimariesMatrix(ColorPrimaries::HDTV, ColorPrimaries::UHDTV), scale);
+        const SoADetail::ST2084Curve<L> curve;
+        SoADetail::TransformColors<L>(colors, count, result, [&](L::V& r, L::V& g, L::V& b, L::V&)
+        {
+            rotation.Apply(r, g, b);
+            r = curve.Encode(r);
+            g = curve.Encode(g);
+            b = curve.Encode(b);
+        });
+    }
+
+    inline void HDR10ToLinear(
+        const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        DirectX::SimpleMath::Color* result,
+        float paperWhiteNits)
+    {
+        using L = SoADetail::Lanes;
+        SoADetail::ValidateColors(colors, count, result, "HDR10ToLinear");
+
+        const double scale = 1.0 / SoADetail::NitsScale(paperWhiteNits, "HDR10ToLinear");
+        const SoADetail::ColorRotation<L> rotation(SoADetail::PrimariesMatrix(ColorPrimaries::UHDTV, ColorPrimaries::HDTV), scale);
+        const SoADetail::ST2084Curve<L> curve;
+        SoADetail::TransformColors<L>(colors, count, result, [&](L::V& r, L::V& g, L::V& b, L::V&)
+        {
+            r = curve.Decode(r);
+            g = curve.Decode(g);
+            b = curve.Decode(b);
+            rotation.Apply(r, g, b);
+        });
+    }
+
+    inline void PremultiplyAlpha(
+        const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        DirectX::SimpleMath::Color* result)
+    {
+        using L = SoADetail::Lanes;
+        SoADetail::ValidateColors(colors, count, result, "PremultiplyAlpha");
+
+        SoADetail::TransformColors<L>(colors, count, result, [](L::V& r, L::V& g, L::V& b, L::V& a)
+        {
+            r = L::Multiply(r, a);
+            g = L::Multiply(g, a);
+            b = L::Multiply(b, a);
+        });
+    }
+
+    inline void UnpremultiplyAlpha(
+        const DirectX::SimpleMath::Color* colors,
+        size_t count,
+        DirectX::SimpleMath::Color* result)
+    {
+        using L = SoADetail::Lanes;
+        SoADetail::ValidateColors(colors, count, result, "UnpremultiplyAlpha");
+
+        SoADetail::TransformColors<L>(colors, count, result, [](L::V& r, L::V& g, L::V& b, L::V& a)
+        {
+            const L::V valid = L::Greater(a, L::Zero());
+            const L::V invAlpha = L::Divide(L::Splat(1.f), L::Select(L::Splat(1.f), a, valid));
+            r = L::And(L::Multiply(r, invAlpha), valid);
+            g = L::And(L::Multiply(g, invAlpha), valid);
+            b = L::And(L::Multiply(b, invAlpha), valid);
+        });
+    }
+}
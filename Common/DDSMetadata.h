@@ -0,0 +1,935 @@
+//--------------------------------------------------------------------------------------
+// File: DDSMetadata.h
+//
+// Device-independent DDS header, metadata, and sub-resource layout parser
+//
+// Applies the same header validation, legacy pixel format mapping, and Direct3D 11
+// hardware limits as DDSTextureLoader, but without creating any resources. The layout
+// can be computed from just the first DDS_MAX_HEADER_SIZE bytes of a file plus the
+// file's total size, so large collections can be indexed without reading pixel data.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#ifdef _WIN32
+#include <dxgiformat.h>
+#else
+#include <sal.h>
+#include <wsl/winadapter.h>
+#include <dxgiformat.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifndef ERROR_NOT_SUPPORTED
+#define ERROR_NOT_SUPPORTED 50L
+#endif
+
+#ifndef ERROR_HANDLE_EOF
+#define ERROR_HANDLE_EOF 38L
+#endif
+
+#ifndef ERROR_INVALID_DATA
+#define ERROR_INVALID_DATA 13L
+#endif
+
+#ifndef ERROR_ARITHMETIC_OVERFLOW
+#define ERROR_ARITHMETIC_OVERFLOW 534L
+#endif
+
+
+namespace DX
+{
+    // Same values as D3D11_RESOURCE_DIMENSION
+    enum DDS_DIMENSION : uint32_t
+    {
+        DDS_DIMENSION_UNKNOWN = 0,
+        DDS_DIMENSION_TEXTURE1D = 2,
+        DDS_DIMENSION_TEXTURE2D = 3,
+        DDS_DIMENSION_TEXTURE3D = 4,
+    };
+
+    // Same value as D3D11_RESOURCE_MISC_TEXTURECUBE
+    constexpr uint32_t DDS_MISC_TEXTURECUBE = 0x4;
+
+    // 'DDS ' + DDS_HEADER + DDS_HEADER_DXT10
+    constexpr size_t DDS_MAX_HEADER_SIZE = 148;
+
+    // Matches the fields of the DdsWicTest TestMedia tables
+    struct DDSMetadata
+    {
+        uint32_t        width;
+        uint32_t        height;
+        uint32_t        depthOrArraySize;   // Depth for 3D textures, array size (x6 for cubemaps) otherwise
+        uint32_t        mipLevels;
+        DXGI_FORMAT     format;
+        DDS_DIMENSION   dimension;
+        uint32_t        miscFlags;          // DDS_MISC_TEXTURECUBE
+        uint32_t        alphaMode;          // Same values as DirectX::DDS_ALPHA_MODE
+        size_t          headerSize;         // Offset of the first byte of pixel data
+        uint64_t        dataSize;           // Total bytes of pixel data described by the header
+
+        // Field by field, since the struct has padding
+        bool operator==(const DDSMetadata& other) const noexcept
+        {
+            return width == other.width
+                && height == other.height
+                && depthOrArraySize == other.depthOrArraySize
+                && mipLevels == other.mipLevels
+                && format == other.format
+                && dimension == other.dimension
+                && miscFlags == other.miscFlags
+                && alphaMode == other.alphaMode
+                && headerSize == other.headerSize
+                && dataSize == other.dataSize;
+        }
+
+        bool operator!=(const DDSMetadata& other) const noexcept { return !(*this == other); }
+    };
+
+    // One entry per sub-resource, in D3D11CalcSubresource order (mip + item * mipLevels)
+    struct DDSSubresource
+    {
+        uint64_t    offset;         // From the start of the file
+        size_t      rowPitch;       // Bytes per row of pixels (or row of blocks)
+        size_t      slicePitch;     // Bytes per 2D slice
+        size_t      numRows;
+        uint32_t    width;
+        uint32_t    height;
+        uint32_t    depth;
+    };
+
+    namespace Internal
+    {
+    #pragma pack(push,1)
+        struct DDS_PIXELFORMAT
+        {
+            uint32_t    size;
+            uint32_t    flags;
+            uint32_t    fourCC;
+            uint32_t    RGBBitCount;
+            uint32_t    RBitMask;
+            uint32_t    GBitMask;
+            uint32_t    BBitMask;
+            uint32_t    ABitMask;
+        };
+
+        struct DDS_HEADER
+        {
+            uint32_t        size;
+            uint32_t        flags;
+            uint32_t        height;
+            uint32_t        width;
+            uint32_t        pitchOrLinearSize;
+            uint32_t        depth;
+            uint32_t        mipMapCount;
+            uint32_t        reserved1[11];
+            DDS_PIXELFORMAT ddspf;
+            uint32_t        caps;
+            uint32_t        caps2;
+            uint32_t        caps3;
+            uint32_t        caps4;
+            uint32_t        reserved2;
+        };
+
+        struct DDS_HEADER_DXT10
+        {
+            DXGI_FORMAT     dxgiFormat;
+            uint32_t        resourceDimension;
+            uint32_t        miscFlag;
+            uint32_t        arraySize;
+            uint32_t        miscFlags2;
+        };
+    #pragma pack(pop)
+
+        static_assert(sizeof(DDS_HEADER) == 124, "DDS Header size mismatch");
+        static_assert(sizeof(DDS_HEADER_DXT10) == 20, "DDS DX10 Extended Header size mismatch");
+        static_assert(sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10) == DDS_MAX_HEADER_SIZE, "DDS header size mismatch");
+
+        constexpr uint32_t MakeFourCC(char a, char b, char c, char d) noexcept
+        {
+            return static_cast<uint32_t>(static_cast<uint8_t>(a))
+                | (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8)
+                | (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16)
+                | (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+        }
+
+        constexpr uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+        constexpr uint32_t DDS_FOURCC = 0x00000004;
+        constexpr uint32_t DDS_RGB = 0x00000040;
+        constexpr uint32_t DDS_LUMINANCE = 0x00020000;
+        constexpr uint32_t DDS_ALPHA = 0x00000002;
+        constexpr uint32_t DDS_BUMPDUDV = 0x00080000;
+
+        constexpr uint32_t DDS_HEADER_FLAGS_VOLUME = 0x00800000;
+        constexpr uint32_t DDS_HEIGHT = 0x00000002;
+
+        constexpr uint32_t DDS_CUBEMAP = 0x00000200;
+        constexpr uint32_t DDS_CUBEMAP_ALLFACES = 0x0000FE00;
+
+        constexpr uint32_t DDS_DIMENSION_BUFFER = 1;
+        constexpr uint32_t DDS_MISC_FLAGS2_ALPHA_MODE_MASK = 0x7;
+
+        // Direct3D 11 hardware limits (feature level 11.0)
+        constexpr uint32_t c_MaxMipLevels = 15;
+        constexpr uint32_t c_MaxArraySize = 2048;
+        constexpr uint32_t c_MaxTexture1D = 16384;
+        constexpr uint32_t c_MaxTexture2D = 16384;
+        constexpr uint32_t c_MaxTextureCube = 16384;
+        constexpr uint32_t c_MaxTexture3D = 2048;
+
+        inline bool IsBitMask(const DDS_PIXELFORMAT& ddpf, uint32_t r, uint32_t g, uint32_t b, uint32_t a) noexcept
+        {
+            return ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a;
+        }
+
+        inline DXGI_FORMAT GetDXGIFormat(const DDS_PIXELFORMAT& ddpf) noexcept
+        {
+            if (ddpf.flags & DDS_RGB)
+            {
+                switch (ddpf.RGBBitCount)
+                {
+                case 32:
+                    if (IsBitMask(ddpf, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
+                        return DXGI_FORMAT_R8G8B8A8_UNORM;
+
+                    if (IsBitMask(ddpf, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000))
+                        return DXGI_FORMAT_B8G8R8A8_UNORM;
+
+                    if (IsBitMask(ddpf, 0x00ff0000, 0x0000ff00, 0x000000ff, 0))
+                        return DXGI_FORMAT_B8G8R8X8_UNORM;
+
+                    // Legacy D3DX writers swapped the RGB masks for 10:10:10:2 formats
+                    if (IsBitMask(ddpf, 0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000))
+                        return DXGI_FORMAT_R10G10B10A2_UNORM;
+
+                    if (IsBitMask(ddpf, 0x0000ffff, 0xffff0000, 0, 0))
+                        return DXGI_FORMAT_R16G16_UNORM;
+
+                    // The only 32-bit color channel format in D3D9 was R32F
+                    if (IsBitMask(ddpf, 0xffffffff, 0, 0, 0))
+                        return DXGI_FORMAT_R32_FLOAT;
+                    break;
+
+                case 16:
+                    if (IsBitMask(ddpf, 0x7c00, 0x03e0, 0x001f, 0x8000))
+                        return DXGI_FORMAT_B5G5R5A1_UNORM;
+
+                    if (IsBitMask(ddpf, 0xf800, 0x07e0, 0x001f, 0))
+                        return DXGI_FORMAT_B5G6R5_UNORM;
+
+                    if (IsBitMask(ddpf, 0x0f00, 0x00f0, 0x000f, 0xf000))
+                        return DXGI_FORMAT_B4G4R4A4_UNORM;
+
+                    // NVTT versions 1.x wrote these as RGB instead of LUMINANCE
+                    if (IsBitMask(ddpf, 0x00ff, 0, 0, 0xff00))
+                        return DXGI_FORMAT_R8G8_UNORM;
+
+                    if (IsBitMask(ddpf, 0xffff, 0, 0, 0))
+                        return DXGI_FORMAT_R16_UNORM;
+                    break;
+
+                case 8:
+                    if (IsBitMask(ddpf, 0xff, 0, 0, 0))
+                        return DXGI_FORMAT_R8_UNORM;
+                    break;
+
+                default:
+                    break;
+                }
+            }
+            else if (ddpf.flags & DDS_LUMINANCE)
+            {
+                switch (ddpf.RGBBitCount)
+                {
+                case 16:
+                    if (IsBitMask(ddpf, 0xffff, 0, 0, 0))
+                        return DXGI_FORMAT_R16_UNORM;
+
+                    if (IsBitMask(ddpf, 0x00ff, 0, 0, 0xff00))
+                        return DXGI_FORMAT_R8G8_UNORM;
+                    break;
+
+                case 8:
+                    if (IsBitMask(ddpf, 0xff, 0, 0, 0))
+                        return DXGI_FORMAT_R8_UNORM;
+
+                    // Some DDS writers assume the bitcount should be 8 instead of 16
+                    if (IsBitMask(ddpf, 0x00ff, 0, 0, 0xff00))
+                        return DXGI_FORMAT_R8G8_UNORM;
+                    break;
+
+                default:
+                    break;
+                }
+            }
+            else if (ddpf.flags & DDS_ALPHA)
+            {
+                if (8 == ddpf.RGBBitCount)
+                    return DXGI_FORMAT_A8_UNORM;
+            }
+            else if (ddpf.flags & DDS_BUMPDUDV)
+            {
+                switch (ddpf.RGBBitCount)
+                {
+                case 32:
+                    if (IsBitMask(ddpf, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
+                        return DXGI_FORMAT_R8G8B8A8_SNORM;
+
+                    if (IsBitMask(ddpf, 0x0000ffff, 0xffff0000, 0, 0))
+                        return DXGI_FORMAT_R16G16_SNORM;
+                    break;
+
+                case 16:
+                    if (IsBitMask(ddpf, 0x00ff, 0xff00, 0, 0))
+                        return DXGI_FORMAT_R8G8_SNORM;
+                    break;
+
+                default:
+                    break;
+                }
+            }
+            else if (ddpf.flags & DDS_FOURCC)
+            {
+                switch (ddpf.fourCC)
+                {
+                case MakeFourCC('D', 'X', 'T', '1'): return DXGI_FORMAT_BC1_UNORM;
+                case MakeFourCC('D', 'X', 'T', '3'): return DXGI_FORMAT_BC2_UNORM;
+                case MakeFourCC('D', 'X', 'T', '5'): return DXGI_FORMAT_BC3_UNORM;
+
+                // Premultiplied alpha variants, which are reported by the alpha mode
+                case MakeFourCC('D', 'X', 'T', '2'): return DXGI_FORMAT_BC2_UNORM;
+                case MakeFourCC('D', 'X', 'T', '4'): return DXGI_FORMAT_BC3_UNORM;
+
+                case MakeFourCC('A', 'T', 'I', '1'): return DXGI_FORMAT_BC4_UNORM;
+                case MakeFourCC('B', 'C', '4', 'U'): return DXGI_FORMAT_BC4_UNORM;
+                case MakeFourCC('B', 'C', '4', 'S'): return DXGI_FORMAT_BC4_SNORM;
+
+                case MakeFourCC('A', 'T', 'I', '2'): return DXGI_FORMAT_BC5_UNORM;
+                case MakeFourCC('B', 'C', '5', 'U'): return DXGI_FORMAT_BC5_UNORM;
+                case MakeFourCC('B', 'C', '5', 'S'): return DXGI_FORMAT_BC5_SNORM;
+
+                // BC6H and BC7 are written using the "DX10" extended header
+                case MakeFourCC('R', 'G', 'B', 'G'): return DXGI_FORMAT_R8G8_B8G8_UNORM;
+                case MakeFourCC('G', 'R', 'G', 'B'): return DXGI_FORMAT_G8R8_G8B8_UNORM;
+                case MakeFourCC('Y', 'U', 'Y', '2'): return DXGI_FORMAT_YUY2;
+
+                // Legacy D3DFMT values stored directly in the fourCC field
+                case 36:  return DXGI_FORMAT_R16G16B16A16_UNORM; // D3DFMT_A16B16G16R16
+                case 110: return DXGI_FORMAT_R16G16B16A16_SNORM; // D3DFMT_Q16W16V16U16
+                case 111: return DXGI_FORMAT_R16_FLOAT;          // D3DFMT_R16F
+                case 112: return DXGI_FORMAT_R16G16_FLOAT;       // D3DFMT_G16R16F
+                case 113: return DXGI_FORMAT_R16G16B16A16_FLOAT; // D3DFMT_A16B16G16R16F
+                case 114: return DXGI_FORMAT_R32_FLOAT;          // D3DFMT_R32F
+                case 115: return DXGI_FORMAT_R32G32_FLOAT;       // D3DFMT_G32R32F
+                case 116: return DXGI_FORMAT_R32G32B32A32_FLOAT; // D3DFMT_A32B32G32R32F
+
+                default:
+                    break;
+                }
+            }
+
+            return DXGI_FORMAT_UNKNOWN;
+        }
+
+        inline uint32_t GetAlphaMode(const DDS_HEADER& header, _In_opt_ const DDS_HEADER_DXT10* d3d10ext) noexcept
+        {
+            if (d3d10ext)
+            {
+                const uint32_t mode = d3d10ext->miscFlags2 & DDS_MISC_FLAGS2_ALPHA_MODE_MASK;
+                if (mode <= 4) // UNKNOWN, STRAIGHT, PREMULTIPLIED, OPAQUE, CUSTOM
+                    return mode;
+            }
+            else if ((header.ddspf.flags & DDS_FOURCC)
+                && (header.ddspf.fourCC == MakeFourCC('D', 'X', 'T', '2') || header.ddspf.fourCC == MakeFourCC('D', 'X', 'T', '4')))
+            {
+                return 2; // DDS_ALPHA_MODE_PREMULTIPLIED
+            }
+
+            return 0; // DDS_ALPHA_MODE_UNKNOWN
+        }
+    }
+
+    //----------------------------------------------------------------------------------
+    // Returns 0 for unknown or unsupported formats.
+    inline size_t DDSBitsPerPixel(DXGI_FORMAT fmt) noexcept
+    {
+        switch (static_cast<int>(fmt))
+        {
+        case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        case DXGI_FORMAT_R32G32B32A32_UINT:
+        case DXGI_FORMAT_R32G32B32A32_SINT:
+            return 128;
+
+        case DXGI_FORMAT_R32G32B32_TYPELESS:
+        case DXGI_FORMAT_R32G32B32_FLOAT:
+        case DXGI_FORMAT_R32G32B32_UINT:
+        case DXGI_FORMAT_R32G32B32_SINT:
+            return 96;
+
+        case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        case DXGI_FORMAT_R16G16B16A16_UNORM:
+        case DXGI_FORMAT_R16G16B16A16_UINT:
+        case DXGI_FORMAT_R16G16B16A16_SNORM:
+        case DXGI_FORMAT_R16G16B16A16_SINT:
+        case DXGI_FORMAT_R32G32_TYPELESS:
+        case DXGI_FORMAT_R32G32_FLOAT:
+        case DXGI_FORMAT_R32G32_UINT:
+        case DXGI_FORMAT_R32G32_SINT:
+        case DXGI_FORMAT_R32G8X24_TYPELESS:
+        case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+        case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+        case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+        case DXGI_FORMAT_Y416:
+        case DXGI_FORMAT_Y210:
+        case DXGI_FORMAT_Y216:
+            return 64;
+
+        case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+        case DXGI_FORMAT_R10G10B10A2_UINT:
+        case DXGI_FORMAT_R11G11B10_FLOAT:
+        case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_R8G8B8A8_UINT:
+        case DXGI_FORMAT_R8G8B8A8_SNORM:
+        case DXGI_FORMAT_R8G8B8A8_SINT:
+        case DXGI_FORMAT_R16G16_TYPELESS:
+        case DXGI_FORMAT_R16G16_FLOAT:
+        case DXGI_FORMAT_R16G16_UNORM:
+        case DXGI_FORMAT_R16G16_UINT:
+        case DXGI_FORMAT_R16G16_SNORM:
+        case DXGI_FORMAT_R16G16_SINT:
+        case DXGI_FORMAT_R32_TYPELESS:
+        case DXGI_FORMAT_D32_FLOAT:
+        case DXGI_FORMAT_R32_FLOAT:
+        case DXGI_FORMAT_R32_UINT:
+        case DXGI_FORMAT_R32_SINT:
+        case DXGI_FORMAT_R24G8_TYPELESS:
+        case DXGI_FORMAT_D24_UNORM_S8_UINT:
+        case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+        case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+        case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+        case DXGI_FORMAT_R8G8_B8G8_UNORM:
+        case DXGI_FORMAT_G8R8_G8B8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+        case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+        case DXGI_FORMAT_AYUV:
+        case DXGI_FORMAT_Y410:
+        case DXGI_FORMAT_YUY2:
+            return 32;
+
+        case DXGI_FORMAT_P010:
+        case DXGI_FORMAT_P016:
+        case DXGI_FORMAT_V408:
+            return 24;
+
+        case DXGI_FORMAT_R8G8_TYPELESS:
+        case DXGI_FORMAT_R8G8_UNORM:
+        case DXGI_FORMAT_R8G8_UINT:
+        case DXGI_FORMAT_R8G8_SNORM:
+        case DXGI_FORMAT_R8G8_SINT:
+        case DXGI_FORMAT_R16_TYPELESS:
+        case DXGI_FORMAT_R16_FLOAT:
+        case DXGI_FORMAT_D16_UNORM:
+        case DXGI_FORMAT_R16_UNORM:
+        case DXGI_FORMAT_R16_UINT:
+        case DXGI_FORMAT_R16_SNORM:
+        case DXGI_FORMAT_R16_SINT:
+        case DXGI_FORMAT_B5G6R5_UNORM:
+        case DXGI_FORMAT_B5G5R5A1_UNORM:
+        case DXGI_FORMAT_A8P8:
+        case DXGI_FORMAT_B4G4R4A4_UNORM:
+            return 16;
+
+        case DXGI_FORMAT_NV12:
+        case DXGI_FORMAT_420_OPAQUE:
+        case DXGI_FORMAT_NV11:
+            return 12;
+
+        case DXGI_FORMAT_R8_TYPELESS:
+        case DXGI_FORMAT_R8_UNORM:
+        case DXGI_FORMAT_R8_UINT:
+        case DXGI_FORMAT_R8_SNORM:
+        case DXGI_FORMAT_R8_SINT:
+        case DXGI_FORMAT_A8_UNORM:
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_TYPELESS:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+        case DXGI_FORMAT_BC6H_TYPELESS:
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_TYPELESS:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+        case DXGI_FORMAT_AI44:
+        case DXGI_FORMAT_IA44:
+        case DXGI_FORMAT_P8:
+            return 8;
+
+        case DXGI_FORMAT_R1_UNORM:
+            return 1;
+
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+            return 4;
+
+        default:
+            return 0;
+        }
+    }
+
+    //----------------------------------------------------------------------------------
+    // Computes the pitch of a single 2D surface. For block-compressed formats, rows are
+    // rows of 4x4 blocks. For planar video formats, all planes are included.
+    inline HRESULT GetDDSSurfaceInfo(
+        size_t width,
+        size_t height,
+        DXGI_FORMAT fmt,
+        _Out_opt_ size_t* outNumBytes,
+        _Out_opt_ size_t* outRowBytes,
+        _Out_opt_ size_t* outNumRows) noexcept
+    {
+        uint64_t numBytes = 0;
+        uint64_t rowBytes = 0;
+        uint64_t numRows = 0;
+
+        bool bc = false;
+        bool packed = false;
+        bool planar = false;
+        size_t bpe = 0;
+        switch (static_cast<int>(fmt))
+        {
+        case DXGI_FORMAT_UNKNOWN:
+            return E_INVALIDARG;
+
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+            bc = true;
+            bpe = 8;
+            break;
+
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_TYPELESS:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+        case DXGI_FORMAT_BC6H_TYPELESS:
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_TYPELESS:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            bc = true;
+            bpe = 16;
+            break;
+
+        case DXGI_FORMAT_R8G8_B8G8_UNORM:
+        case DXGI_FORMAT_G8R8_G8B8_UNORM:
+        case DXGI_FORMAT_YUY2:
+            packed = true;
+            bpe = 4;
+            break;
+
+        case DXGI_FORMAT_Y210:
+        case DXGI_FORMAT_Y216:
+            packed = true;
+            bpe = 8;
+            break;
+
+        case DXGI_FORMAT_NV12:
+        case DXGI_FORMAT_420_OPAQUE:
+            if ((height % 2) != 0)
+            {
+                // Requires a height alignment of 2.
+                return E_INVALIDARG;
+            }
+            planar = true;
+            bpe = 2;
+            break;
+
+        case DXGI_FORMAT_P010:
+        case DXGI_FORMAT_P016:
+            if ((height % 2) != 0)
+            {
+                // Requires a height alignment of 2.
+                return E_INVALIDARG;
+            }
+            planar = true;
+            bpe = 4;
+            break;
+
+        default:
+            break;
+        }
+
+        if (bc)
+        {
+            uint64_t numBlocksWide = 0;
+            if (width > 0)
+            {
+                numBlocksWide = std::max<uint64_t>(1u, (uint64_t(width) + 3u) / 4u);
+            }
+            uint64_t numBlocksHigh = 0;
+            if (height > 0)
+            {
+                numBlocksHigh = std::max<uint64_t>(1u, (uint64_t(height) + 3u) / 4u);
+            }
+            rowBytes = numBlocksWide * bpe;
+            numRows = numBlocksHigh;
+            numBytes = rowBytes * numBlocksHigh;
+        }
+        else if (packed)
+        {
+            rowBytes = ((uint64_t(width) + 1u) >> 1) * bpe;
+            numRows = uint64_t(height);
+            numBytes = rowBytes * height;
+        }
+        else if (fmt == DXGI_FORMAT_NV11)
+        {
+            rowBytes = ((uint64_t(width) + 3u) >> 2) * 4u;
+            numRows = uint64_t(height) * 2u; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
+            numBytes = rowBytes * numRows;
+        }
+        else if (planar)
+        {
+            rowBytes = ((uint64_t(width) + 1u) >> 1) * bpe;
+            numBytes = (rowBytes * uint64_t(height)) + ((rowBytes * uint64_t(height) + 1u) >> 1);
+            numRows = height + ((uint64_t(height) + 1u) >> 1);
+        }
+        else
+        {
+            const size_t bpp = DDSBitsPerPixel(fmt);
+            if (!bpp)
+                return E_INVALIDARG;
+
+            rowBytes = (uint64_t(width) * bpp + 7u) / 8u; // round up to nearest byte
+            numRows = uint64_t(height);
+            numBytes = rowBytes * height;
+        }
+
+    #if defined(_M_IX86) || defined(_M_ARM) || defined(_M_HYBRID_X86_ARM64) || defined(__i386__) || defined(__arm__)
+        static_assert(sizeof(size_t) == 4, "Not a 32-bit platform!");
+        if (numBytes > UINT32_MAX || rowBytes > UINT32_MAX || numRows > UINT32_MAX)
+            return HRESULT_FROM_WIN32(ERROR_ARITHMETIC_OVERFLOW);
+    #endif
+
+        if (outNumBytes)
+        {
+            *outNumBytes = static_cast<size_t>(numBytes);
+        }
+        if (outRowBytes)
+        {
+            *outRowBytes = static_cast<size_t>(rowBytes);
+        }
+        if (outNumRows)
+        {
+            *outNumRows = static_cast<size_t>(numRows);
+        }
+
+        return S_OK;
+    }
+
+    //----------------------------------------------------------------------------------
+    // Parses the DDS header in 'headerData' (which only needs to hold the first
+    // DDS_MAX_HEADER_SIZE bytes of the file) and validates the layout against 'fileSize'.
+    // If 'subresources' is provided, it receives one entry per sub-resource.
+    //
+    // Returns E_FAIL for a malformed header, HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED)
+    // for content DDSTextureLoader rejects, and HRESULT_FROM_WIN32(ERROR_HANDLE_EOF)
+    // if the file is too small for the data the header describes.
+    inline HRESULT GetDDSMetadata(
+        _In_reads_bytes_(headerSize) const uint8_t* headerData,
+        size_t headerSize,
+        uint64_t fileSize,
+        DDSMetadata& metadata,
+        _Inout_opt_ std::vector<DDSSubresource>* subresources = nullptr)
+    {
+        using namespace Internal;
+
+        metadata = {};
+
+        if (subresources)
+        {
+            subresources->clear();
+        }
+
+        if (!headerData)
+            return E_INVALIDARG;
+
+        if (headerSize < (sizeof(uint32_t) + sizeof(DDS_HEADER)) || fileSize < headerSize)
+            return E_FAIL;
+
+        uint32_t magic = 0;
+        memcpy(&magic, headerData, sizeof(uint32_t));
+        if (magic != DDS_MAGIC)
+            return E_FAIL;
+
+        DDS_HEADER header;
+        memcpy(&header, headerData + sizeof(uint32_t), sizeof(DDS_HEADER));
+
+        if (header.size != sizeof(DDS_HEADER) || header.ddspf.size != sizeof(DDS_PIXELFORMAT))
+            return E_FAIL;
+
+        DDS_HEADER_DXT10 d3d10ext = {};
+        bool isDXT10 = false;
+        if ((header.ddspf.flags & DDS_FOURCC) && (MakeFourCC('D', 'X', '1', '0') == header.ddspf.fourCC))
+        {
+            if (headerSize < DDS_MAX_HEADER_SIZE)
+                return E_FAIL;
+
+            memcpy(&d3d10ext, headerData + sizeof(uint32_t) + sizeof(DDS_HEADER), sizeof(DDS_HEADER_DXT10));
+            isDXT10 = true;
+        }
+
+        const size_t offset = sizeof(uint32_t) + sizeof(DDS_HEADER) + (isDXT10 ? sizeof(DDS_HEADER_DXT10) : 0u);
+
+        uint32_t width = header.width;
+        uint32_t height = header.height;
+        uint32_t depth = header.depth;
+
+        DDS_DIMENSION resDim = DDS_DIMENSION_UNKNOWN;
+        uint32_t arraySize = 1;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        bool isCubeMap = false;
+
+        uint32_t mipCount = header.mipMapCount;
+        if (0 == mipCount)
+        {
+            mipCount = 1;
+        }
+
+        if (isDXT10)
+        {
+            arraySize = d3d10ext.arraySize;
+            if (arraySize == 0)
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+            switch (d3d10ext.dxgiFormat)
+            {
+            case DXGI_FORMAT_AI44:
+            case DXGI_FORMAT_IA44:
+            case DXGI_FORMAT_P8:
+            case DXGI_FORMAT_A8P8:
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+            default:
+                if (DDSBitsPerPixel(d3d10ext.dxgiFormat) == 0)
+                    return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+                break;
+            }
+
+            format = d3d10ext.dxgiFormat;
+
+            switch (d3d10ext.resourceDimension)
+            {
+            case DDS_DIMENSION_TEXTURE1D:
+                // D3DX writes 1D textures with a fixed Height of 1
+                if ((header.flags & DDS_HEIGHT) && height != 1)
+                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                height = depth = 1;
+                break;
+
+            case DDS_DIMENSION_TEXTURE2D:
+                if (d3d10ext.miscFlag & DDS_MISC_TEXTURECUBE)
+                {
+                    if (arraySize > (UINT32_MAX / 6u))
+                        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+                    arraySize *= 6;
+                    isCubeMap = true;
+                }
+                depth = 1;
+                break;
+
+            case DDS_DIMENSION_TEXTURE3D:
+                if (!(header.flags & DDS_HEADER_FLAGS_VOLUME))
+                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+                if (arraySize > 1)
+                    return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+                break;
+
+            case DDS_DIMENSION_BUFFER:
+            default:
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            }
+
+            resDim = static_cast<DDS_DIMENSION>(d3d10ext.resourceDimension);
+        }
+        else
+        {
+            format = GetDXGIFormat(header.ddspf);
+            if (format == DXGI_FORMAT_UNKNOWN)
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+            if (header.flags & DDS_HEADER_FLAGS_VOLUME)
+            {
+                resDim = DDS_DIMENSION_TEXTURE3D;
+            }
+            else
+            {
+                if (header.caps2 & DDS_CUBEMAP)
+                {
+                    // We require all six faces to be defined
+                    if ((header.caps2 & DDS_CUBEMAP_ALLFACES) != DDS_CUBEMAP_ALLFACES)
+                        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+                    arraySize = 6;
+                    isCubeMap = true;
+                }
+
+                depth = 1;
+                resDim = DDS_DIMENSION_TEXTURE2D;
+
+                // Note there's no way for a legacy Direct3D 9 DDS to express a '1D' texture
+            }
+        }
+
+        // Bound sizes (for security purposes we don't trust DDS file metadata larger than the Direct3D hardware requirements)
+        if (mipCount > c_MaxMipLevels)
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+        switch (resDim)
+        {
+        case DDS_DIMENSION_TEXTURE1D:
+            if ((arraySize > c_MaxArraySize) || (width > c_MaxTexture1D))
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            break;
+
+        case DDS_DIMENSION_TEXTURE2D:
+            if (isCubeMap)
+            {
+                // This is the right bound because we set arraySize to (NumCubes*6) above
+                if ((arraySize > c_MaxArraySize) || (width > c_MaxTextureCube) || (height > c_MaxTextureCube))
+                    return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            }
+            else if ((arraySize > c_MaxArraySize) || (width > c_MaxTexture2D) || (height > c_MaxTexture2D))
+            {
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            }
+            break;
+
+        case DDS_DIMENSION_TEXTURE3D:
+            if ((arraySize > 1) || (width > c_MaxTexture3D) || (height > c_MaxTexture3D) || (depth > c_MaxTexture3D))
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            break;
+
+        default:
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+        }
+
+        // The Direct3D runtime rejects these when creating the resource
+        if (!width || !height || !depth)
+            return E_INVALIDARG;
+
+        {
+            uint32_t maxMips = 1;
+            for (uint32_t size = std::max(std::max(width, height), depth); size > 1; size >>= 1)
+            {
+                ++maxMips;
+            }
+
+            if (mipCount > maxMips)
+                return E_INVALIDARG;
+        }
+
+        // Walk the sub-resources to compute the layout and validate the file size
+        if (subresources)
+        {
+            subresources->reserve(size_t(arraySize) * mipCount);
+        }
+
+        uint64_t dataOffset = offset;
+        for (uint32_t j = 0; j < arraySize; ++j)
+        {
+            uint32_t w = width;
+            uint32_t h = height;
+            uint32_t d = depth;
+            for (uint32_t i = 0; i < mipCount; ++i)
+            {
+                size_t numBytes = 0;
+                size_t rowBytes = 0;
+                size_t numRows = 0;
+                const HRESULT hr = GetDDSSurfaceInfo(w, h, format, &numBytes, &rowBytes, &numRows);
+                if (FAILED(hr))
+                    return hr;
+
+                if (subresources)
+                {
+                    subresources->emplace_back(DDSSubresource{ dataOffset, rowBytes, numBytes, numRows, w, h, d });
+                }
+
+                dataOffset += uint64_t(numBytes) * d;
+                if (dataOffset > fileSize)
+                {
+                    if (subresources)
+                    {
+                        subresources->clear();
+                    }
+                    return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+                }
+
+                w = std::max(w >> 1, 1u);
+                h = std::max(h >> 1, 1u);
+                d = std::max(d >> 1, 1u);
+            }
+        }
+
+        metadata.width = width;
+        metadata.height = height;
+        metadata.depthOrArraySize = (resDim == DDS_DIMENSION_TEXTURE3D) ? depth : arraySize;
+        metadata.mipLevels = mipCount;
+        metadata.format = format;
+        metadata.dimension = resDim;
+        metadata.miscFlags = isCubeMap ? DDS_MISC_TEXTURECUBE : 0u;
+        metadata.alphaMode = GetAlphaMode(header, isDXT10 ? &d3d10ext : nullptr);
+        metadata.headerSize = offset;
+        metadata.dataSize = dataOffset - offset;
+
+        return S_OK;
+    }
+
+    // Overload for a DDS file that has been fully read or mapped into memory.
+    inline HRESULT GetDDSMetadata(
+        _In_reads_bytes_(dataSize) const uint8_t* ddsData,
+        size_t dataSize,
+        DDSMetadata& metadata,
+        _Inout_opt_ std::vector<DDSSubresource>* subresources = nullptr)
+    {
+        return GetDDSMetadata(ddsData, dataSize, dataSize, metadata, subresources);
+    }
+}
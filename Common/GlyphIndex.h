@@ -0,0 +1,257 @@
+//--------------------------------------------------------------------------------------
+// File: GlyphIndex.h
+//
+// Constant-time glyph lookup for SpriteFont glyph tables, and text measurement using the
+// same layout rules as SpriteFont::MeasureString
+//
+// SpriteFont stores its glyphs sorted by character and binary searches them for every
+// character drawn or measured. GlyphIndex is built once per font: Latin-1 characters
+// map through a 256-entry direct table, and everything else goes through a small open
+// addressing hash table, so lookups touch one or two cache lines.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cwctype>
+#include <stdexcept>
+#include <vector>
+
+
+namespace DX
+{
+    struct TextExtent
+    {
+        float width;
+        float height;
+    };
+
+    // Calls action(glyph, x, y, advance) for each visible glyph of 'text', following the layout
+    // rules of SpriteFont. 'find' maps a character to its glyph (or the default glyph).
+    template<typename Glyph, typename TFind, typename TAction>
+    void ForEachGlyph(_In_z_ const wchar_t* text, float lineSpacing, TFind&& find, TAction&& action, bool ignoreWhitespace)
+    {
+        float x = 0;
+        float y = 0;
+
+        for (; *text; ++text)
+        {
+            const wchar_t character = *text;
+
+            switch (character)
+            {
+            case '\r':
+                // Skip carriage returns.
+                continue;
+
+            case '\n':
+                // New line.
+                x = 0;
+                y += lineSpacing;
+                break;
+
+            default:
+                {
+                    const Glyph* glyph = find(character);
+
+                    x += glyph->XOffset;
+
+                    if (x < 0)
+                        x = 0;
+
+                    const float advance = float(glyph->Subrect.right) - float(glyph->Subrect.left) + glyph->XAdvance;
+
+                    if (!ignoreWhitespace
+                        || !iswspace(character)
+                        || ((glyph->Subrect.right - glyph->Subrect.left) > 1)
+                        || ((glyph->Subrect.bottom - glyph->Subrect.top) > 1))
+                    {
+                        action(glyph, x, y, advance);
+                    }
+
+                    x += advance;
+                }
+                break;
+            }
+        }
+    }
+
+    // Same result as SpriteFont::MeasureString
+    template<typename Glyph, typename TFind>
+    TextExtent MeasureGlyphs(_In_z_ const wchar_t* text, float lineSpacing, TFind&& find, bool ignoreWhitespace = true)
+    {
+        TextExtent result = {};
+
+        ForEachGlyph<Glyph>(text, lineSpacing, find, [&](const Glyph* glyph, float x, float y, float)
+            {
+                const auto w = static_cast<float>(glyph->Subrect.right - glyph->Subrect.left);
+                auto h = static_cast<float>(glyph->Subrect.bottom - glyph->Subrect.top) + glyph->YOffset;
+
+                h = iswspace(wchar_t(glyph->Character)) ? lineSpacing : std::max(h, lineSpacing);
+
+                result.width = std::max(result.width, x + w);
+                result.height = std::max(result.height, y + h);
+            }, ignoreWhitespace);
+
+        return result;
+    }
+
+    // 'Glyph' is SpriteFont::Glyph or a type with the same members. The index refers to the
+    // caller's glyph array, which must outlive it and be sorted by character.
+    template<typename Glyph>
+    class GlyphIndex
+    {
+    public:
+        GlyphIndex(_In_reads_(glyphCount) const Glyph* glyphs, size_t glyphCount, float lineSpacing, uint32_t defaultCharacter = 0) noexcept(false) :
+            m_glyphs(glyphs),
+            m_glyphCount(glyphCount),
+            m_lineSpacing(lineSpacing),
+            m_defaultGlyph(nullptr),
+            m_shift(0)
+        {
+            if (!glyphs && glyphCount > 0)
+                throw std::invalid_argument("GlyphIndex");
+
+            if (glyphCount >= c_Empty)
+                throw std::out_of_range("GlyphIndex");
+
+            std::fill(std::begin(m_direct), std::end(m_direct), c_Empty);
+
+            size_t extended = 0;
+            for (size_t j = 0; j < glyphCount; ++j)
+            {
+                if (glyphs[j].Character < c_DirectSize)
+                {
+                    m_direct[glyphs[j].Character] = static_cast<uint32_t>(j);
+                }
+                else
+                {
+                    ++extended;
+                }
+            }
+
+            if (extended > 0)
+            {
+                // At most half full, so probe sequences stay short
+                size_t capacity = 4;
+                uint32_t bits = 2;
+                while (capacity < extended * 2)
+                {
+                    capacity <<= 1;
+                    ++bits;
+                }
+
+                m_shift = 32 - bits;
+                m_slots.resize(capacity, Slot{ 0, c_Empty });
+
+                for (size_t j = 0; j < glyphCount; ++j)
+                {
+                    const uint32_t character = glyphs[j].Character;
+                    if (character < c_DirectSize)
+                        continue;
+
+                    size_t slot = Hash(character);
+                    while (m_slots[slot].index != c_Empty)
+                    {
+                        slot = (slot + 1) & (capacity - 1);
+                    }
+                    m_slots[slot] = Slot{ character, static_cast<uint32_t>(j) };
+                }
+            }
+
+            SetDefaultCharacter(defaultCharacter);
+        }
+
+        GlyphIndex(GlyphIndex&&) = default;
+        GlyphIndex& operator= (GlyphIndex&&) = default;
+
+        GlyphIndex(GlyphIndex const&) = default;
+        GlyphIndex& operator= (GlyphIndex const&) = default;
+
+        // Returns nullptr if the font has no glyph for 'character'
+        const Glyph* Find(uint32_t character) const noexcept
+        {
+            if (character < c_DirectSize)
+            {
+                const uint32_t index = m_direct[character];
+                return (index != c_Empty) ? &m_glyphs[index] : nullptr;
+            }
+
+            if (m_slots.empty())
+                return nullptr;
+
+            const size_t mask = m_slots.size() - 1;
+            for (size_t slot = Hash(character);; slot = (slot + 1) & mask)
+            {
+                const Slot& it = m_slots[slot];
+                if (it.index == c_Empty)
+                    return nullptr;
+
+                if (it.character == character)
+                    return &m_glyphs[it.index];
+            }
+        }
+
+        // Same behavior as SpriteFont::FindGlyph
+        const Glyph* FindGlyph(wchar_t character) const
+        {
+            const Glyph* glyph = Find(static_cast<uint32_t>(character));
+            if (glyph)
+                return glyph;
+
+            if (m_defaultGlyph)
+                return m_defaultGlyph;
+
+            throw std::runtime_error("Character not in font");
+        }
+
+        void SetDefaultCharacter(uint32_t character) noexcept
+        {
+            m_defaultGlyph = character ? Find(character) : nullptr;
+        }
+
+        TextExtent MeasureString(_In_z_ const wchar_t* text, bool ignoreWhitespace = true) const
+        {
+            return MeasureGlyphs<Glyph>(text, m_lineSpacing, [this](wchar_t character) { return FindGlyph(character); }, ignoreWhitespace);
+        }
+
+        template<typename TAction>
+        void ForEachGlyph(_In_z_ const wchar_t* text, TAction&& action, bool ignoreWhitespace = true) const
+        {
+            DX::ForEachGlyph<Glyph>(text, m_lineSpacing, [this](wchar_t character) { return FindGlyph(character); }, action, ignoreWhitespace);
+        }
+
+        size_t GetGlyphCount() const noexcept { return m_glyphCount; }
+        size_t GetHashCapacity() const noexcept { return m_slots.size(); }
+        float GetLineSpacing() const noexcept { return m_lineSpacing; }
+
+    private:
+        static constexpr uint32_t c_DirectSize = 256;
+        static constexpr uint32_t c_Empty = UINT32_MAX;
+
+        struct Slot
+        {
+            uint32_t character;
+            uint32_t index;
+        };
+
+        // Fibonacci hashing
+        size_t Hash(uint32_t character) const noexcept
+        {
+            return static_cast<size_t>((character * 0x9E3779B1u) >> m_shift);
+        }
+
+        const Glyph*        m_glyphs;
+        size_t              m_glyphCount;
+        float               m_lineSpacing;
+        const Glyph*        m_defaultGlyph;
+        uint32_t            m_shift;
+        uint32_t            m_direct[c_DirectSize];
+        std::vector<Slot>   m_slots;
+    };
+}
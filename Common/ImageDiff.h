@@ -0,0 +1,686 @@
+//--------------------------------------------------------------------------------------
+// File: ImageDiff.h
+//
+// Reference image store and pixel diff for headless comparison of rendered frames
+//
+// Golden images are stored losslessly in the QOI format ("Quite OK Image"), which is
+// compact for rendered content and simple enough to encode and decode without any
+// imaging library. Reference images can also be read from DDS files, decoding BC
+// formats with BCDecode.h.
+//
+// The diff first tests every channel against a tolerance, using SSE2 four pixels at a
+// time where available. Only pixels outside the tolerance are tested with the slower
+// perceptual metric, which is the YIQ color distance used by pixelmatch, after
+// blending with white by alpha. Rows are split into bands that are spread across a
+// pool of threads.
+//
+// Nothing here depends on Direct3D, so goldens captured on Windows can be diffed on
+// Linux (see the imagediff tool).
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "BCDecode.h"
+#include "DDSMetadata.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define DX_IMAGEDIFF_SSE2
+#endif
+
+#ifndef ERROR_FILE_NOT_FOUND
+#define ERROR_FILE_NOT_FOUND 2L
+#endif
+
+
+namespace DX
+{
+    // Tightly packed RGBA8 pixels, top row first
+    struct RGBAImage
+    {
+        uint32_t                width;
+        uint32_t                height;
+        std::vector<uint8_t>    pixels;
+    };
+
+    // The defaults require an exact match
+    struct ImageDiffOptions
+    {
+        uint8_t     channelTolerance;       // Largest per-channel difference treated as equal
+        float       perceptualThreshold;    // YIQ distance (0 to 1) a pixel must also exceed to differ
+        double      maxDifferentRatio;      // Fraction of pixels allowed to differ
+        bool        ignoreAlpha;
+    };
+
+    struct ImageDiffResult
+    {
+        uint64_t    pixels;
+        uint64_t    differentPixels;
+        uint32_t    maxChannelDelta;
+        double      meanAbsError;           // Per channel, 0 to 255
+        double      psnr;                   // In dB, infinite when identical
+        bool        passed;
+    };
+
+    namespace Internal
+    {
+        constexpr uint32_t c_QOIMagic = 0x716f6966; // "qoif"
+        constexpr size_t c_QOIHeaderSize = 14;
+        constexpr uint8_t c_QOIPadding[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+        constexpr uint32_t c_QOIMaxPixels = 400000000;
+
+        enum : uint8_t
+        {
+            QOI_OP_INDEX = 0x00,
+            QOI_OP_DIFF = 0x40,
+            QOI_OP_LUMA = 0x80,
+            QOI_OP_RUN = 0xC0,
+            QOI_OP_RGB = 0xFE,
+            QOI_OP_RGBA = 0xFF,
+            QOI_MASK_2 = 0xC0,
+        };
+
+        struct QOIPixel
+        {
+            uint8_t r, g, b, a;
+
+            bool operator==(const QOIPixel& other) const noexcept
+            {
+                return r == other.r && g == other.g && b == other.b && a == other.a;
+            }
+
+            size_t Hash() const noexcept
+            {
+                return (size_t(r) * 3 + size_t(g) * 5 + size_t(b) * 7 + size_t(a) * 11) % 64;
+            }
+        };
+
+        inline void WriteBE32(uint8_t* dst, uint32_t value) noexcept
+        {
+            dst[0] = static_cast<uint8_t>(value >> 24);
+            dst[1] = static_cast<uint8_t>(value >> 16);
+            dst[2] = static_cast<uint8_t>(value >> 8);
+            dst[3] = static_cast<uint8_t>(value);
+        }
+
+        inline uint32_t ReadBE32(const uint8_t* src) noexcept
+        {
+            return (uint32_t(src[0]) << 24) | (uint32_t(src[1]) << 16) | (uint32_t(src[2]) << 8) | uint32_t(src[3]);
+        }
+
+        inline bool IsValidImage(const RGBAImage& image) noexcept
+        {
+            return image.width > 0 && image.height > 0
+                && image.pixels.size() == size_t(image.width) * image.height * 4;
+        }
+
+        // Squared YIQ distance, normalized so 1 is the distance from black to white
+        inline float PerceptualDelta(const uint8_t* a, const uint8_t* b, bool ignoreAlpha) noexcept
+        {
+            auto blend = [ignoreAlpha](const uint8_t* p, float* rgb)
+            {
+                const float alpha = ignoreAlpha ? 1.f : float(p[3]) / 255.f;
+                for (size_t c = 0; c < 3; ++c)
+                {
+                    rgb[c] = 255.f + (float(p[c]) - 255.f) * alpha;
+                }
+            };
+
+            float ca[3], cb[3];
+            blend(a, ca);
+            blend(b, cb);
+
+            const float dr = ca[0] - cb[0];
+            const float dg = ca[1] - cb[1];
+            const float db = ca[2] - cb[2];
+
+            const float y = dr * 0.29889531f + dg * 0.58662247f + db * 0.11448223f;
+            const float i = dr * 0.59597799f - dg * 0.27417610f - db * 0.32180189f;
+            const float q = dr * 0.21147017f - dg * 0.52261711f + db * 0.31114694f;
+
+            return (0.5053f * y * y + 0.299f * i * i + 0.1957f * q * q) / 35215.f;
+        }
+
+        struct DiffTotals
+        {
+            uint64_t    different;
+            uint64_t    absSum;
+            uint64_t    sqSum;
+            uint32_t    maxDelta;
+        };
+
+        // Differences in red over a faded grayscale copy of the reference
+        inline void WriteDiffPixel(const uint8_t* ref, bool differs, uint8_t* dst) noexcept
+        {
+            if (differs)
+            {
+                dst[0] = 255;
+                dst[1] = 0;
+                dst[2] = 0;
+            }
+            else
+            {
+                const uint32_t y = (uint32_t(ref[0]) * 77 + uint32_t(ref[1]) * 150 + uint32_t(ref[2]) * 29) >> 8;
+                const auto faded = static_cast<uint8_t>(255 - ((255 - y) * 26 >> 8));
+                dst[0] = dst[1] = dst[2] = faded;
+            }
+            dst[3] = 255;
+        }
+
+        // Pixels that exceed the tolerance but not the perceptual threshold are still counted
+        // in the error totals.
+        inline bool TestPixel(const uint8_t* a, const uint8_t* b, const ImageDiffOptions& options, float threshold2) noexcept
+        {
+            return options.perceptualThreshold <= 0.f || PerceptualDelta(a, b, options.ignoreAlpha) > threshold2;
+        }
+
+        inline void DiffRow(const uint8_t* ref, const uint8_t* cand, uint32_t width, const ImageDiffOptions& options,
+            DiffTotals& totals, _Out_writes_opt_(width * 4) uint8_t* diffRow) noexcept
+        {
+            const float threshold2 = options.perceptualThreshold * options.perceptualThreshold;
+            const uint32_t alphaMask = options.ignoreAlpha ? 0xFF000000u : 0u;
+            const size_t channels = options.ignoreAlpha ? 3u : 4u;
+
+            uint32_t x = 0;
+
+#ifdef DX_IMAGEDIFF_SSE2
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i tolerance = _mm_set1_epi8(static_cast<char>(options.channelTolerance));
+            const __m128i forceAlpha = _mm_set1_epi32(static_cast<int>(alphaMask));
+
+            __m128i maxDelta = zero;
+            __m128i absSum = zero;
+            __m128i sqSum = zero;
+            uint32_t pending = 0;
+
+            for (; x + 4 <= width; x += 4)
+            {
+                const __m128i va = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ref + size_t(x) * 4)), forceAlpha);
+                const __m128i vb = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cand + size_t(x) * 4)), forceAlpha);
+                const __m128i delta = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+
+                maxDelta = _mm_max_epu8(maxDelta, delta);
+                absSum = _mm_add_epi64(absSum, _mm_sad_epu8(delta, zero));
+
+                const __m128i lo = _mm_unpacklo_epi8(delta, zero);
+                const __m128i hi = _mm_unpackhi_epi8(delta, zero);
+                sqSum = _mm_add_epi32(sqSum, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+
+                // Each 32-bit lane gains at most 4 * 255^2 per step
+                if (++pending == 1024)
+                {
+                    alignas(16) uint32_t lanes[4];
+                    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), sqSum);
+                    totals.sqSum += uint64_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+                    sqSum = zero;
+                    pending = 0;
+                }
+
+                const int equal = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(delta, tolerance), zero));
+                if (equal != 0xFFFF || diffRow)
+                {
+                    for (uint32_t j = 0; j < 4; ++j)
+                    {
+                        const size_t offset = size_t(x + j) * 4;
+                        bool differs = false;
+                        if (((equal >> (j * 4)) & 0xF) != 0xF)
+                        {
+                            uint8_t pa[4], pb[4];
+                            memcpy(pa, ref + offset, 4);
+                            memcpy(pb, cand + offset, 4);
+                            differs = TestPixel(pa, pb, options, threshold2);
+                        }
+
+                        if (differs)
+                            ++totals.different;
+
+                        if (diffRow)
+                            WriteDiffPixel(ref + offset, differs, diffRow + offset);
+                    }
+                }
+            }
+
+            alignas(16) uint32_t lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), sqSum);
+            totals.sqSum += uint64_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+
+            alignas(16) uint64_t sums[2];
+            _mm_store_si128(reinterpret_cast<__m128i*>(sums), absSum);
+            totals.absSum += sums[0] + sums[1];
+
+            alignas(16) uint8_t deltas[16];
+            _mm_store_si128(reinterpret_cast<__m128i*>(deltas), maxDelta);
+            for (size_t j = 0; j < 16; ++j)
+            {
+                totals.maxDelta = std::max<uint32_t>(totals.maxDelta, deltas[j]);
+            }
+#endif
+
+            for (; x < width; ++x)
+            {
+                const size_t offset = size_t(x) * 4;
+                const uint8_t* pa = ref + offset;
+                const uint8_t* pb = cand + offset;
+
+                bool exceeds = false;
+                for (size_t c = 0; c < channels; ++c)
+                {
+                    const uint32_t delta = static_cast<uint32_t>(std::abs(int(pa[c]) - int(pb[c])));
+                    totals.absSum += delta;
+                    totals.sqSum += delta * delta;
+                    totals.maxDelta = std::max(totals.maxDelta, delta);
+                    exceeds |= (delta > options.channelTolerance);
+                }
+
+                const bool differs = exceeds && TestPixel(pa, pb, options, threshold2);
+                if (differs)
+                    ++totals.different;
+
+                if (diffRow)
+                    WriteDiffPixel(pa, differs, diffRow + offset);
+            }
+        }
+
+        inline HRESULT LoadDDSImage(const std::vector<uint8_t>& data, RGBAImage& image)
+        {
+            DDSMetadata metadata = {};
+            std::vector<DDSSubresource> layout;
+            HRESULT hr = GetDDSMetadata(data.data(), data.size(), metadata, &layout);
+            if (FAILED(hr))
+                return hr;
+
+            const DDSSubresource& top = layout[0];
+            if (top.depth != 1)
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+            image.width = top.width;
+            image.height = top.height;
+            image.pixels.resize(size_t(top.width) * top.height * 4);
+
+            const uint8_t* src = data.data() + top.offset;
+            uint8_t* dst = image.pixels.data();
+
+            if (IsBCFormat(metadata.format))
+            {
+                return DecodeBCImage(metadata.format, src, top.rowPitch, top.width, top.height, dst, size_t(top.width) * 4);
+            }
+
+            switch (metadata.format)
+            {
+            case DXGI_FORMAT_R8G8B8A8_UNORM:
+            case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            case DXGI_FORMAT_B8G8R8A8_UNORM:
+            case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            case DXGI_FORMAT_B8G8R8X8_UNORM:
+            case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+                break;
+
+            default:
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            }
+
+            const bool bgr = metadata.format != DXGI_FORMAT_R8G8B8A8_UNORM && metadata.format != DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+            const bool opaque = metadata.format == DXGI_FORMAT_B8G8R8X8_UNORM || metadata.format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+
+            for (uint32_t y = 0; y < top.height; ++y)
+            {
+                const uint8_t* row = src + size_t(y) * top.rowPitch;
+                for (uint32_t x = 0; x < top.width; ++x, row += 4, dst += 4)
+                {
+                    dst[0] = bgr ? row[2] : row[0];
+                    dst[1] = row[1];
+                    dst[2] = bgr ? row[0] : row[2];
+                    dst[3] = opaque ? 255 : row[3];
+                }
+            }
+
+            return S_OK;
+        }
+    }
+
+    //--------------------------------------------------------------------------------------
+    // QOI codec (https://qoiformat.org/qoi-specification.pdf), always 4 channels
+    inline HRESULT EncodeQOI(const RGBAImage& image, std::vector<uint8_t>& data)
+    {
+        using namespace Internal;
+
+        if (!IsValidImage(image) || uint64_t(image.width) * image.height > c_QOIMaxPixels)
+            return E_INVALIDARG;
+
+        const size_t count = size_t(image.width) * image.height;
+
+        data.resize(c_QOIHeaderSize + count * 5 + sizeof(c_QOIPadding));
+        uint8_t* out = data.data();
+
+        WriteBE32(out, c_QOIMagic);
+        WriteBE32(out + 4, image.width);
+        WriteBE32(out + 8, image.height);
+        out[12] = 4;
+        out[13] = 0;
+        out += c_QOIHeaderSize;
+
+        QOIPixel index[64] = {};
+        QOIPixel prev = { 0, 0, 0, 255 };
+        uint32_t run = 0;
+
+        const uint8_t* src = image.pixels.data();
+        for (size_t j = 0; j < count; ++j, src += 4)
+        {
+            const QOIPixel px = { src[0], src[1], src[2], src[3] };
+
+            if (px == prev)
+            {
+                if (++run == 62 || j + 1 == count)
+                {
+                    *out++ = static_cast<uint8_t>(QOI_OP_RUN | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+
+            if (run > 0)
+            {
+                *out++ = static_cast<uint8_t>(QOI_OP_RUN | (run - 1));
+                run = 0;
+            }
+
+            const size_t hash = px.Hash();
+            if (index[hash] == px)
+            {
+                *out++ = static_cast<uint8_t>(QOI_OP_INDEX | hash);
+            }
+            else
+            {
+                index[hash] = px;
+
+                if (px.a == prev.a)
+                {
+                    const auto vr = static_cast<int8_t>(px.r - prev.r);
+                    const auto vg = static_cast<int8_t>(px.g - prev.g);
+                    const auto vb = static_cast<int8_t>(px.b - prev.b);
+                    const int vgr = vr - vg;
+                    const int vgb = vb - vg;
+
+                    if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2)
+                    {
+                        *out++ = static_cast<uint8_t>(QOI_OP_DIFF | ((vr + 2) << 4) | ((vg + 2) << 2) | (vb + 2));
+                    }
+                    else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8)
+                    {
+                        *out++ = static_cast<uint8_t>(QOI_OP_LUMA | (vg + 32));
+                        *out++ = static_cast<uint8_t>(((vgr + 8) << 4) | (vgb + 8));
+                    }
+                    else
+                    {
+                        *out++ = QOI_OP_RGB;
+                        *out++ = px.r;
+                        *out++ = px.g;
+                        *out++ = px.b;
+                    }
+                }
+                else
+                {
+                    *out++ = QOI_OP_RGBA;
+                    *out++ = px.r;
+                    *out++ = px.g;
+                    *out++ = px.b;
+                    *out++ = px.a;
+                }
+            }
+
+            prev = px;
+        }
+
+        memcpy(out, c_QOIPadding, sizeof(c_QOIPadding));
+        out += sizeof(c_QOIPadding);
+
+        data.resize(static_cast<size_t>(out - data.data()));
+        return S_OK;
+    }
+
+    inline HRESULT DecodeQOI(_In_reads_bytes_(size) const uint8_t* data, size_t size, RGBAImage& image)
+    {
+        using namespace Internal;
+
+        if (!data)
+            return E_INVALIDARG;
+
+        if (size < c_QOIHeaderSize + sizeof(c_QOIPadding) || ReadBE32(data) != c_QOIMagic)
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+        const uint32_t width = ReadBE32(data + 4);
+        const uint32_t height = ReadBE32(data + 8);
+        if (!width || !height || uint64_t(width) * height > c_QOIMaxPixels
+            || (data[12] != 3 && data[12] != 4) || data[13] > 1)
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+        const size_t count = size_t(width) * height;
+        image.width = width;
+        image.height = height;
+        image.pixels.resize(count * 4);
+
+        const uint8_t* in = data + c_QOIHeaderSize;
+        const uint8_t* end = data + size - sizeof(c_QOIPadding);
+
+        QOIPixel index[64] = {};
+        QOIPixel px = { 0, 0, 0, 255 };
+        uint32_t run = 0;
+
+        uint8_t* dst = image.pixels.data();
+        for (size_t j = 0; j < count; ++j, dst += 4)
+        {
+            if (run > 0)
+            {
+                --run;
+            }
+            else
+            {
+                if (in >= end)
+                    return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+                const uint8_t b1 = *in++;
+                if (b1 == QOI_OP_RGB || b1 == QOI_OP_RGBA)
+                {
+                    const size_t length = (b1 == QOI_OP_RGB) ? 3u : 4u;
+                    if (size_t(end - in) < length)
+                        return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+                    px.r = in[0];
+                    px.g = in[1];
+                    px.b = in[2];
+                    if (b1 == QOI_OP_RGBA)
+                        px.a = in[3];
+                    in += length;
+                }
+                else if ((b1 & QOI_MASK_2) == QOI_OP_INDEX)
+                {
+                    px = index[b1];
+                }
+                else if ((b1 & QOI_MASK_2) == QOI_OP_DIFF)
+                {
+                    px.r = static_cast<uint8_t>(px.r + ((b1 >> 4) & 3) - 2);
+                    px.g = static_cast<uint8_t>(px.g + ((b1 >> 2) & 3) - 2);
+                    px.b = static_cast<uint8_t>(px.b + (b1 & 3) - 2);
+                }
+                else if ((b1 & QOI_MASK_2) == QOI_OP_LUMA)
+                {
+                    if (in >= end)
+                        return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+                    const uint8_t b2 = *in++;
+                    const int vg = (b1 & 0x3F) - 32;
+                    px.r = static_cast<uint8_t>(px.r + vg - 8 + ((b2 >> 4) & 0xF));
+                    px.g = static_cast<uint8_t>(px.g + vg);
+                    px.b = static_cast<uint8_t>(px.b + vg - 8 + (b2 & 0xF));
+                }
+                else
+                {
+                    run = b1 & 0x3F;
+                }
+
+                index[px.Hash()] = px;
+            }
+
+            dst[0] = px.r;
+            dst[1] = px.g;
+            dst[2] = px.b;
+            dst[3] = px.a;
+        }
+
+        return S_OK;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Golden images are written as QOI. Reading also accepts the top mip of a 2D DDS file in
+    // a BC, RGBA8, or BGRA8 format.
+    inline HRESULT SaveReferenceImage(const std::filesystem::path& fileName, const RGBAImage& image)
+    {
+        std::vector<uint8_t> data;
+        HRESULT hr = EncodeQOI(image, data);
+        if (FAILED(hr))
+            return hr;
+
+        std::ofstream outFile(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!outFile)
+            return E_FAIL;
+
+        outFile.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        outFile.close();
+        return outFile ? S_OK : E_FAIL;
+    }
+
+    inline HRESULT LoadReferenceImage(const std::filesystem::path& fileName, RGBAImage& image)
+    {
+        std::ifstream inFile(fileName, std::ios::in | std::ios::binary | std::ios::ate);
+        if (!inFile)
+            return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+
+        const auto size = static_cast<size_t>(inFile.tellg());
+        inFile.seekg(0);
+
+        std::vector<uint8_t> data(size);
+        inFile.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+        if (static_cast<size_t>(inFile.gcount()) != size)
+            return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+        if (size >= sizeof(uint32_t) && Internal::ReadBE32(data.data()) == Internal::c_QOIMagic)
+        {
+            return DecodeQOI(data.data(), data.size(), image);
+        }
+
+        return Internal::LoadDDSImage(data, image);
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Compares 'candidate' against 'reference' using up to 'threads' threads (0 for the
+    // number of cores). If 'diffImage' is provided, it receives a visualization of the
+    // differing pixels.
+    inline HRESULT DiffImages(const RGBAImage& reference, const RGBAImage& candidate, const ImageDiffOptions& options,
+        ImageDiffResult& result, _Out_opt_ RGBAImage* diffImage = nullptr, size_t threads = 0)
+    {
+        using namespace Internal;
+
+        result = {};
+
+        if (!IsValidImage(reference) || !IsValidImage(candidate)
+            || reference.width != candidate.width || reference.height != candidate.height)
+            return E_INVALIDARG;
+
+        const uint32_t width = reference.width;
+        const uint32_t height = reference.height;
+
+        if (diffImage)
+        {
+            diffImage->width = width;
+            diffImage->height = height;
+            diffImage->pixels.resize(reference.pixels.size());
+        }
+
+        if (!threads)
+        {
+            threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        }
+
+        // Bands of at least 64K pixels so small images stay on one thread
+        const size_t rowsPerBand = std::max<size_t>(1, 65536 / width);
+        const size_t bands = (size_t(height) + rowsPerBand - 1) / rowsPerBand;
+        threads = std::min(threads, bands);
+
+        std::vector<DiffTotals> totals(threads, DiffTotals{});
+        std::atomic<size_t> next(0);
+
+        auto worker = [&](size_t thread)
+        {
+            DiffTotals& local = totals[thread];
+            for (;;)
+            {
+                const size_t band = next.fetch_add(1);
+                if (band >= bands)
+                    break;
+
+                const size_t y1 = std::min<size_t>(size_t(height), (band + 1) * rowsPerBand);
+                for (size_t y = band * rowsPerBand; y < y1; ++y)
+                {
+                    const size_t offset = y * width * 4;
+                    DiffRow(reference.pixels.data() + offset, candidate.pixels.data() + offset, width, options, local,
+                        diffImage ? diffImage->pixels.data() + offset : nullptr);
+                }
+            }
+        };
+
+        if (threads <= 1)
+        {
+            worker(0);
+        }
+        else
+        {
+            std::vector<std::thread> pool;
+            pool.reserve(threads - 1);
+            for (size_t j = 1; j < threads; ++j)
+            {
+                pool.emplace_back(worker, j);
+            }
+            worker(0);
+            for (auto& t : pool)
+            {
+                t.join();
+            }
+        }
+
+        DiffTotals sum = {};
+        for (const auto& it : totals)
+        {
+            sum.different += it.different;
+            sum.absSum += it.absSum;
+            sum.sqSum += it.sqSum;
+            sum.maxDelta = std::max(sum.maxDelta, it.maxDelta);
+        }
+
+        const double samples = double(width) * double(height) * (options.ignoreAlpha ? 3.0 : 4.0);
+        const double mse = double(sum.sqSum) / samples;
+
+        result.pixels = uint64_t(width) * height;
+        result.differentPixels = sum.different;
+        result.maxChannelDelta = sum.maxDelta;
+        result.meanAbsError = double(sum.absSum) / samples;
+        result.psnr = (mse > 0.) ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+        result.passed = double(sum.different) <= options.maxDifferentRatio * double(result.pixels);
+
+        return S_OK;
+    }
+}
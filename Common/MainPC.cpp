@@ -4,6 +4,7 @@
 
 #include "pch.h"
 #include "Game.h"
+#include "Profiler.h"
 
 #pragma warning(push)
 #pragma warning(disable : 4265)
@@ -29,6 +30,7 @@ namespace
 {
     std::unique_ptr<Game> g_game;
     bool g_testTimer = false;
+    wchar_t g_profilePath[MAX_PATH] = {};
 
 #ifdef WM_DEVICECHANGE
     HDEVNOTIFY g_hNewAudio;
@@ -37,6 +39,7 @@ namespace
 
 LRESULT CALLBACK WndProc(HWND, UINT, WPARAM, LPARAM);
 void ExitGame() noexcept;
+void ExitGame(int exitCode) noexcept;
 void ParseCommandLine(_In_ LPWSTR lpCmdLine);
 
 // Indicates to hybrid graphics systems to prefer the discrete part by default
@@ -81,6 +84,12 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 
     ParseCommandLine(lpCmdLine);
 
+    if (*g_profilePath)
+    {
+        DX::Profiler::SetThreadName("Main");
+        DX::Profiler::Enable(true);
+    }
+
     g_game = std::make_unique<Game>();
 
     // Register class and create window
@@ -153,6 +162,14 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 
     g_game.reset();
 
+    if (*g_profilePath)
+    {
+        if (!DX::Profiler::SaveChromeTrace(g_profilePath))
+        {
+            OutputDebugStringA("ERROR: Failed to write profile trace\n");
+        }
+    }
+
 #ifdef WM_DEVICECHANGE
     UnregisterDeviceNotification(g_hNewAudio);
 #endif
@@ -437,6 +454,18 @@ void ParseCommandLine(_In_ LPWSTR lpCmdLine)
             {
                 g_testTimer = true;
             }
+            else if (_wcsicmp(pArg, L"profile") == 0)
+            {
+                const wchar_t* path = (pValue && *pValue != 0) ? pValue : L"profile.json";
+                if (wcslen(path) < MAX_PATH)
+                {
+                    wcscpy_s(g_profilePath, path);
+                }
+                else
+                {
+                    OutputDebugStringA("ERROR: Profile path is too long, profiling disabled\n");
+                }
+            }
             else if (_wcsicmp(pArg, L"forcewarp") == 0)
             {
                 DX::DeviceResources::DebugForceWarp(true);
@@ -461,5 +490,11 @@ void ParseCommandLine(_In_ LPWSTR lpCmdLine)
 // Exit helper
 void ExitGame() noexcept
 {
-    PostQuitMessage(0);
+    ExitGame(0);
+}
+
+// Exit helper for tests that report a result; the code is returned from wWinMain
+void ExitGame(int exitCode) noexcept
+{
+    PostQuitMessage(exitCode);
 }
@@ -0,0 +1,367 @@
+//--------------------------------------------------------------------------------------
+// File: PrefetchScheduler.h
+//
+// Central read scheduler for streaming wave bank data
+//
+// Multiple streams submit read requests against the same asynchronous file handle
+// (such as WaveBankReader::GetAsyncHandle). Pending requests are ordered by their
+// underrun deadline, requests for adjacent or overlapping ranges are merged into a
+// single sector-aligned read, and the total number of bytes in flight is capped.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <malloc.h>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+
+namespace DX
+{
+    class PrefetchScheduler
+    {
+    public:
+        struct Stats
+        {
+            size_t      queueDepth;         // Requests waiting to be issued
+            size_t      readsInFlight;      // Merged reads currently issued
+            size_t      bytesInFlight;      // Aligned bytes currently being read
+            size_t      maxBytesInFlight;   // High-water mark for bytesInFlight
+            uint64_t    requestsSubmitted;
+            uint64_t    requestsCompleted;
+            uint64_t    requestsMerged;     // Requests satisfied by a read issued for another request
+            uint64_t    readsIssued;
+            uint64_t    bytesRead;
+            uint64_t    underruns;          // Requests that completed after their deadline
+            uint64_t    errors;
+        };
+
+        using RequestId = uint64_t;
+
+        static constexpr RequestId c_InvalidRequest = 0;
+
+        // 'alignment' must match the sector alignment required by the handle (e.g. 4096
+        // for FILE_FLAG_NO_BUFFERING). 'maxBytesInFlight' caps outstanding I/O, and
+        // 'maxReadSize' limits how large a merged read may become.
+        PrefetchScheduler(_In_ HANDLE async, uint32_t alignment = 4096, size_t maxBytesInFlight = 1024 * 1024, size_t maxReadSize = 256 * 1024) noexcept(false) :
+            m_async(async),
+            m_alignment(alignment),
+            m_maxBytesInFlight(maxBytesInFlight),
+            m_maxReadSize(maxReadSize),
+            m_nextId(1),
+            m_stats{}
+        {
+            if (!async || async == INVALID_HANDLE_VALUE)
+                throw std::invalid_argument("PrefetchScheduler");
+
+            if (!alignment || (alignment & (alignment - 1)) != 0)
+                throw std::invalid_argument("Alignment must be a power of 2");
+
+            m_maxBytesInFlight = std::max<size_t>(m_maxBytesInFlight, m_alignment);
+            m_maxReadSize = std::max<size_t>(AlignUp(m_maxReadSize), m_alignment);
+        }
+
+        PrefetchScheduler(PrefetchScheduler&&) = delete;
+        PrefetchScheduler& operator= (PrefetchScheduler&&) = delete;
+
+        PrefetchScheduler(PrefetchScheduler const&) = delete;
+        PrefetchScheduler& operator= (PrefetchScheduler const&) = delete;
+
+        ~PrefetchScheduler()
+        {
+            Cancel();
+        }
+
+        // Queues a read of 'length' bytes at file 'offset' into 'dest'. The 'deadline' is the
+        // time (in the caller's units, typically milliseconds) at which the stream will underrun
+        // if the data has not arrived.
+        RequestId Submit(uint64_t offset, uint32_t length, _Out_writes_bytes_(length) uint8_t* dest, uint64_t deadline)
+        {
+            if (!length || !dest)
+                throw std::invalid_argument("Submit");
+
+            Request req = {};
+            req.id = m_nextId++;
+            req.offset = offset;
+            req.length = length;
+            req.dest = dest;
+            req.deadline = deadline;
+            m_pending.push_back(req);
+
+            ++m_stats.requestsSubmitted;
+            m_stats.queueDepth = m_pending.size();
+
+            return req.id;
+        }
+
+        // Retires finished reads and issues new ones. Call once per frame with the current time.
+        void Update(uint64_t now)
+        {
+            Retire(now, false);
+            Issue();
+        }
+
+        // Blocks until all submitted requests are complete.
+        void Flush(uint64_t now)
+        {
+            while (!m_pending.empty() || !m_inflight.empty())
+            {
+                Issue();
+                Retire(now, true);
+            }
+        }
+
+        bool IsComplete(RequestId id) const noexcept
+        {
+            for (const auto& it : m_pending)
+            {
+                if (it.id == id)
+                    return false;
+            }
+
+            for (const auto& read : m_inflight)
+            {
+                for (const auto& it : read->requests)
+                {
+                    if (it.id == id)
+                        return false;
+                }
+            }
+
+            return true;
+        }
+
+        // Cancels all outstanding I/O and drops any pending requests.
+        void Cancel() noexcept
+        {
+            for (auto& read : m_inflight)
+            {
+                std::ignore = CancelIoEx(m_async, &read->request);
+                DWORD cb = 0;
+                std::ignore = GetOverlappedResult(m_async, &read->request, &cb, TRUE);
+            }
+
+            m_inflight.clear();
+            m_pending.clear();
+
+            m_stats.queueDepth = 0;
+            m_stats.readsInFlight = 0;
+            m_stats.bytesInFlight = 0;
+        }
+
+        const Stats& GetStats() const noexcept { return m_stats; }
+
+        void ResetStats() noexcept
+        {
+            const size_t queueDepth = m_stats.queueDepth;
+            const size_t readsInFlight = m_stats.readsInFlight;
+            const size_t bytesInFlight = m_stats.bytesInFlight;
+            m_stats = {};
+            m_stats.queueDepth = queueDepth;
+            m_stats.readsInFlight = readsInFlight;
+            m_stats.bytesInFlight = bytesInFlight;
+            m_stats.maxBytesInFlight = bytesInFlight;
+        }
+
+    private:
+        struct Request
+        {
+            RequestId   id;
+            uint64_t    offset;
+            uint32_t    length;
+            uint8_t*    dest;
+            uint64_t    deadline;
+        };
+
+        struct aligned_deleter { void operator()(void* p) noexcept { _aligned_free(p); } };
+
+        struct event_closer { void operator()(HANDLE h) noexcept { if (h) CloseHandle(h); } };
+
+        struct Read
+        {
+            OVERLAPPED                                  request;
+            std::unique_ptr<void, event_closer>         event;
+            std::unique_ptr<uint8_t, aligned_deleter>   buffer;
+            uint64_t                                    offset;
+            size_t                                      size;
+            std::vector<Request>                        requests;
+        };
+
+        size_t AlignUp(size_t value) const noexcept
+        {
+            const size_t mask = size_t(m_alignment) - 1;
+            return (value + mask) & ~mask;
+        }
+
+        uint64_t AlignDown(uint64_t value) const noexcept
+        {
+            return value & ~uint64_t(m_alignment - 1);
+        }
+
+        void Issue()
+        {
+            if (m_pending.empty())
+                return;
+
+            // Most urgent first
+            std::stable_sort(m_pending.begin(), m_pending.end(),
+                [](const Request& a, const Request& b) noexcept { return a.deadline < b.deadline; });
+
+            while (!m_pending.empty())
+            {
+                const Request& head = m_pending.front();
+
+                uint64_t start = AlignDown(head.offset);
+                uint64_t end = start + AlignUp(size_t(head.offset + head.length - start));
+
+                // A single request larger than the cap still has to go through once the pipe is empty
+                const size_t headSize = size_t(end - start);
+                if (m_stats.bytesInFlight > 0 && (m_stats.bytesInFlight + headSize) > m_maxBytesInFlight)
+                    break;
+
+                auto read = std::make_unique<Read>();
+                read->requests.push_back(head);
+                m_pending.erase(m_pending.begin());
+
+                // Grow the read to cover other queued requests that touch the same sectors
+                const size_t budget = std::max(m_maxReadSize, headSize);
+                bool grew = true;
+                while (grew)
+                {
+                    grew = false;
+                    for (auto it = m_pending.begin(); it != m_pending.end(); )
+                    {
+                        const uint64_t rstart = AlignDown(it->offset);
+                        const uint64_t rend = rstart + AlignUp(size_t(it->offset + it->length - rstart));
+
+                        const uint64_t nstart = std::min(start, rstart);
+                        const uint64_t nend = std::max(end, rend);
+
+                        if (rstart <= end && rend >= start
+                            && size_t(nend - nstart) <= budget
+                            && (m_stats.bytesInFlight + size_t(nend - nstart)) <= std::max(m_maxBytesInFlight, headSize))
+                        {
+                            start = nstart;
+                            end = nend;
+                            read->requests.push_back(*it);
+                            it = m_pending.erase(it);
+                            ++m_stats.requestsMerged;
+                            grew = true;
+                        }
+                        else
+                        {
+                            ++it;
+                        }
+                    }
+                }
+
+                read->offset = start;
+                read->size = size_t(end - start);
+
+                read->buffer.reset(static_cast<uint8_t*>(_aligned_malloc(read->size, m_alignment)));
+                if (!read->buffer)
+                    throw std::bad_alloc();
+
+                read->event.reset(CreateEventExW(nullptr, nullptr, CREATE_EVENT_MANUAL_RESET, EVENT_MODIFY_STATE | SYNCHRONIZE));
+                if (!read->event)
+                    throw std::system_error(std::error_code(static_cast<int>(GetLastError()), std::system_category()), "CreateEventExW");
+
+                memset(&read->request, 0, sizeof(OVERLAPPED));
+                read->request.Offset = static_cast<DWORD>(start);
+                read->request.OffsetHigh = static_cast<DWORD>(start >> 32);
+                read->request.hEvent = read->event.get();
+
+                if (!ReadFile(m_async, read->buffer.get(), static_cast<DWORD>(read->size), nullptr, &read->request))
+                {
+                    const DWORD error = GetLastError();
+                    if (error != ERROR_IO_PENDING)
+                        throw std::system_error(std::error_code(static_cast<int>(error), std::system_category()), "ReadFile");
+                }
+
+                ++m_stats.readsIssued;
+                m_stats.bytesInFlight += read->size;
+                m_stats.maxBytesInFlight = std::max(m_stats.maxBytesInFlight, m_stats.bytesInFlight);
+
+                m_inflight.emplace_back(std::move(read));
+            }
+
+            m_stats.queueDepth = m_pending.size();
+            m_stats.readsInFlight = m_inflight.size();
+        }
+
+        void Retire(uint64_t now, bool wait)
+        {
+            for (auto it = m_inflight.begin(); it != m_inflight.end(); )
+            {
+                Read* read = it->get();
+
+                DWORD cb = 0;
+                if (!GetOverlappedResult(m_async, &read->request, &cb, wait ? TRUE : FALSE))
+                {
+                    const DWORD error = GetLastError();
+                    if (error == ERROR_IO_INCOMPLETE)
+                    {
+                        ++it;
+                        continue;
+                    }
+
+                    // Failed reads (including reading past the end of the file) complete their requests with no data
+                    ++m_stats.errors;
+                    cb = 0;
+                }
+
+                for (const auto& req : read->requests)
+                {
+                    const size_t skip = size_t(req.offset - read->offset);
+                    if (skip + req.length <= cb)
+                    {
+                        memcpy(req.dest, read->buffer.get() + skip, req.length);
+                    }
+                    else
+                    {
+                        ++m_stats.errors;
+                    }
+
+                    if (now > req.deadline)
+                    {
+                        ++m_stats.underruns;
+                    }
+
+                    ++m_stats.requestsCompleted;
+                }
+
+                m_stats.bytesRead += cb;
+
+                assert(m_stats.bytesInFlight >= read->size);
+                m_stats.bytesInFlight -= read->size;
+
+                it = m_inflight.erase(it);
+            }
+
+            m_stats.readsInFlight = m_inflight.size();
+        }
+
+        HANDLE                              m_async;
+        uint32_t                            m_alignment;
+        size_t                              m_maxBytesInFlight;
+        size_t                              m_maxReadSize;
+        RequestId                           m_nextId;
+
+        std::vector<Request>                m_pending;
+        std::list<std::unique_ptr<Read>>    m_inflight;
+
+        Stats                               m_stats;
+    };
+}
@@ -0,0 +1,305 @@
+//--------------------------------------------------------------------------------------
+// File: Profiler.h
+//
+// Lightweight scoped CPU profiler with Chrome trace (Perfetto / chrome://tracing) export
+//
+// Use DX_PROFILE_SCOPE("Name") at the top of a block to time it; zones nest naturally.
+// Names must be string literals (or otherwise outlive the profiler). While the profiler is
+// disabled a zone costs one relaxed atomic load. Each thread appends to its own buffer
+// without locking; the registry mutex is only taken the first time a thread records and
+// when exporting.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+namespace DX
+{
+    class Profiler
+    {
+    public:
+        // Events kept per thread (allocated in chunks on demand); further events are dropped.
+        static constexpr size_t c_EventsPerChunk = 4096;
+        static constexpr size_t c_MaxChunks = 256;
+
+        static void Enable(bool enable) noexcept
+        {
+            GetRegistry().enabled.store(enable, std::memory_order_relaxed);
+        }
+
+        static bool IsEnabled() noexcept
+        {
+            return GetRegistry().enabled.load(std::memory_order_relaxed);
+        }
+
+        // Label for the calling thread in the exported trace.
+        static void SetThreadName(_In_z_ const char* name)
+        {
+            ThreadBuffer* buffer = GetThreadBuffer();
+            if (!buffer)
+                return;
+
+            auto& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            buffer->name = name;
+        }
+
+        // Nanoseconds since the profiler was first used.
+        static uint64_t Now() noexcept
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - GetRegistry().epoch).count());
+        }
+
+        static void Record(_In_z_ const char* name, uint64_t start, uint64_t end) noexcept
+        {
+            ThreadBuffer* buffer = GetThreadBuffer();
+            if (!buffer)
+            {
+                GetRegistry().dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            // Only this thread writes to the buffer, so the count can be published with a plain store.
+            const size_t index = buffer->count.load(std::memory_order_relaxed);
+            const size_t chunkIndex = index / c_EventsPerChunk;
+            if (chunkIndex >= c_MaxChunks)
+            {
+                GetRegistry().dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            Event* chunk = buffer->chunks[chunkIndex].load(std::memory_order_relaxed);
+            if (!chunk)
+            {
+                chunk = new (std::nothrow) Event[c_EventsPerChunk];
+                if (!chunk)
+                {
+                    GetRegistry().dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                buffer->chunks[chunkIndex].store(chunk, std::memory_order_release);
+            }
+
+            chunk[index % c_EventsPerChunk] = Event{ name, start, end };
+            buffer->count.store(index + 1, std::memory_order_release);
+        }
+
+        static uint64_t GetDroppedEvents() noexcept
+        {
+            return GetRegistry().dropped.load(std::memory_order_relaxed);
+        }
+
+        // Trace Event Format JSON, loadable by ui.perfetto.dev and chrome://tracing. Safe to call
+        // while other threads are recording; events recorded during the export may be omitted.
+        static void ExportChromeTrace(std::ostream& out)
+        {
+            auto& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+
+            // Microseconds with nanosecond resolution
+            const auto flags = out.flags();
+            const auto precision = out.precision();
+            out << std::fixed << std::setprecision(3);
+
+            out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+            bool first = true;
+            for (const auto& buffer : registry.threads)
+            {
+                if (!buffer->name.empty())
+                {
+                    out << (first ? "" : ",\n")
+                        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+                        << ",\"args\":{\"name\":\"";
+                    WriteEscaped(out, buffer->name.c_str());
+                    out << "\"}}";
+                    first = false;
+                }
+
+                const size_t count = buffer->count.load(std::memory_order_acquire);
+                for (size_t j = 0; j < count; ++j)
+                {
+                    const Event* chunk = buffer->chunks[j / c_EventsPerChunk].load(std::memory_order_acquire);
+                    const Event& event = chunk[j % c_EventsPerChunk];
+
+                    out << (first ? "" : ",\n") << "{\"name\":\"";
+                    WriteEscaped(out, event.name);
+                    out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                        << ",\"ts\":" << Microseconds(event.start)
+                        << ",\"dur\":" << Microseconds(event.end - event.start) << "}";
+                    first = false;
+                }
+            }
+
+            out << "\n]}\n";
+
+            out.flags(flags);
+            out.precision(precision);
+        }
+
+        static bool SaveChromeTrace(const std::filesystem::path& path)
+        {
+            std::ofstream out(path, std::ios::out | std::ios::trunc);
+            if (!out)
+                return false;
+
+            ExportChromeTrace(out);
+            return static_cast<bool>(out);
+        }
+
+        // Discards all recorded events. Must not race with recording threads.
+        static void Reset() noexcept
+        {
+            auto& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+
+            for (auto& buffer : registry.threads)
+            {
+                buffer->count.store(0, std::memory_order_relaxed);
+            }
+            registry.dropped.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        struct Event
+        {
+            const char* name;
+            uint64_t    start;
+            uint64_t    end;
+        };
+
+        struct ThreadBuffer
+        {
+            uint32_t                        tid = 0;
+            std::string                     name;
+            std::atomic<size_t>             count{ 0 };
+            std::atomic<Event*>             chunks[c_MaxChunks] = {};
+
+            ~ThreadBuffer()
+            {
+                for (auto& chunk : chunks)
+                {
+                    delete[] chunk.load(std::memory_order_relaxed);
+                }
+            }
+        };
+
+        struct Registry
+        {
+            std::mutex                                  mutex;
+            std::vector<std::unique_ptr<ThreadBuffer>>  threads;
+            std::atomic<bool>                           enabled{ false };
+            std::atomic<uint64_t>                       dropped{ 0 };
+            std::chrono::steady_clock::time_point       epoch = std::chrono::steady_clock::now();
+        };
+
+        static Registry& GetRegistry() noexcept
+        {
+            static Registry s_registry;
+            return s_registry;
+        }
+
+        // Buffers are owned by the registry so events survive their thread.
+        static ThreadBuffer* GetThreadBuffer() noexcept
+        {
+            thread_local ThreadBuffer* t_buffer = nullptr;
+            if (!t_buffer)
+            {
+                try
+                {
+                    auto& registry = GetRegistry();
+                    auto buffer = std::make_unique<ThreadBuffer>();
+
+                    std::lock_guard<std::mutex> lock(registry.mutex);
+                    buffer->tid = static_cast<uint32_t>(registry.threads.size() + 1);
+                    registry.threads.emplace_back(std::move(buffer));
+                    t_buffer = registry.threads.back().get();
+                }
+                catch (...)
+                {
+                    return nullptr;
+                }
+            }
+            return t_buffer;
+        }
+
+        static double Microseconds(uint64_t ns) noexcept { return static_cast<double>(ns) / 1000.0; }
+
+        static void WriteEscaped(std::ostream& out, const char* str)
+        {
+            for (; *str; ++str)
+            {
+                const char c = *str;
+                if (c == '"' || c == '\\')
+                {
+                    out << '\\' << c;
+                }
+                else if (static_cast<unsigned char>(c) >= 0x20)
+                {
+                    out << c;
+                }
+            }
+        }
+    };
+
+    class ProfileScope
+    {
+    public:
+        explicit ProfileScope(_In_z_ const char* name) noexcept :
+            m_name(nullptr),
+            m_start(0)
+        {
+            if (Profiler::IsEnabled())
+            {
+                m_name = name;
+                m_start = Profiler::Now();
+            }
+        }
+
+        ~ProfileScope()
+        {
+            if (m_name)
+            {
+                Profiler::Record(m_name, m_start, Profiler::Now());
+            }
+        }
+
+        ProfileScope(ProfileScope&&) = delete;
+        ProfileScope& operator= (ProfileScope&&) = delete;
+
+        ProfileScope(ProfileScope const&) = delete;
+        ProfileScope& operator= (ProfileScope const&) = delete;
+
+    private:
+        const char* m_name;
+        uint64_t    m_start;
+    };
+}
+
+#define DX_PROFILE_CONCAT_IMPL(a, b) a##b
+#define DX_PROFILE_CONCAT(a, b) DX_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef DX_DISABLE_PROFILER
+#define DX_PROFILE_SCOPE(name)
+#else
+#define DX_PROFILE_SCOPE(name) DX::ProfileScope DX_PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#endif
@@ -0,0 +1,745 @@
+//--------------------------------------------------------------------------------------
+// File: RayPacket.h
+//
+// SIMD ray intersection for picking and visibility queries over many rays or primitives
+//
+// RayPacket holds many rays in structure-of-arrays form and tests all of them against one
+// BoundingBox or BoundingSphere. BoxStream, SphereStream and TriangleStream hold many
+// primitives the same way and test one Ray against all of them. Both directions use the
+// SoAMath lane width (8 with AVX, otherwise 4) and follow the same math as the matching
+// Ray::Intersects overload, so hits and distances agree within floating-point rounding:
+//
+// - Boxes use the slab test of BoundingBox::Intersects; the distance is negative when the
+//   ray starts inside the box.
+// - Spheres expect unit-length ray directions, as BoundingSphere::Intersects does.
+// - Triangles are two-sided, as TriangleTests::Intersects.
+//
+// Distances are written for every ray or primitive, with FLT_MAX for misses. 'Nearest'
+// returns only the closest hit, skipping any block of lanes that cannot improve on it.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SoAMath.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+
+namespace DX
+{
+    namespace SoADetail
+    {
+        struct BoxAccess;
+        struct SphereAccess;
+        struct TriangleAccess;
+    }
+
+    //----------------------------------------------------------------------------------
+    class RayPacket
+    {
+    public:
+        RayPacket() noexcept = default;
+
+        explicit RayPacket(size_t count) { Resize(count); }
+
+        RayPacket(_In_reads_(count) const DirectX::SimpleMath::Ray* rays, size_t count) { Load(rays, count); }
+
+        RayPacket(RayPacket&&) = default;
+        RayPacket& operator= (RayPacket&&) = default;
+
+        RayPacket(RayPacket const&) = default;
+        RayPacket& operator= (RayPacket const&) = default;
+
+        // New rays are Ray() (at the origin, facing +Z)
+        void Resize(size_t count)
+        {
+            const size_t old = m_position.Size();
+            m_position.Resize(count);
+            m_direction.Resize(count);
+            m_inverse.Resize(count);
+            for (size_t j = old; j < count; ++j)
+            {
+                Set(j, DirectX::SimpleMath::Ray());
+            }
+        }
+
+        size_t Size() const noexcept { return m_position.Size(); }
+
+        const Vector3Stream& Positions() const noexcept { return m_position; }
+        const Vector3Stream& Directions() const noexcept { return m_direction; }
+
+        DirectX::SimpleMath::Ray Get(size_t index) const noexcept
+        {
+            return DirectX::SimpleMath::Ray(m_position.Get(index), m_direction.Get(index));
+        }
+
+        void Set(size_t index, const DirectX::SimpleMath::Ray& ray) noexcept
+        {
+            m_position.Set(index, ray.position);
+            m_direction.Set(index, ray.direction);
+            m_inverse.Set(index, DirectX::SimpleMath::Vector3(1.f / ray.direction.x, 1.f / ray.direction.y, 1.f / ray.direction.z));
+        }
+
+        void Load(_In_reads_(count) const DirectX::SimpleMath::Ray* rays, size_t count)
+        {
+            if (!rays && count > 0)
+                throw std::invalid_argument("RayPacket");
+
+            m_position.Resize(count);
+            m_direction.Resize(count);
+            m_inverse.Resize(count);
+            for (size_t j = 0; j < count; ++j)
+            {
+                Set(j, rays[j]);
+            }
+        }
+
+        void Store(_Out_writes_(Size()) DirectX::SimpleMath::Ray* rays) const noexcept
+        {
+            for (size_t j = 0; j < Size(); ++j)
+            {
+                rays[j] = Get(j);
+            }
+        }
+
+        // Tests every ray; returns the number of hits
+        size_t Intersects(const DirectX::BoundingBox& box, _Out_writes_(Size()) float* dist) const;
+        size_t Intersects(const DirectX::BoundingSphere& sphere, _Out_writes_(Size()) float* dist) const;
+
+        // Closest ray to hit the primitive; false if none do
+        bool Nearest(const DirectX::BoundingBox& box, size_t& index, float& dist) const;
+        bool Nearest(const DirectX::BoundingSphere& sphere, size_t& index, float& dist) const;
+
+    private:
+        Vector3Stream   m_position;
+        Vector3Stream   m_direction;
+        Vector3Stream   m_inverse;
+    };
+
+    //----------------------------------------------------------------------------------
+    class BoxStream
+    {
+    public:
+        BoxStream() noexcept = default;
+
+        explicit BoxStream(size_t count) { Resize(count); }
+
+        BoxStream(_In_reads_(count) const DirectX::BoundingBox* boxes, size_t count) { Load(boxes, count); }
+
+        BoxStream(BoxStream&&) = default;
+        BoxStream& operator= (BoxStream&&) = default;
+
+        BoxStream(BoxStream const&) = default;
+        BoxStream& operator= (BoxStream const&) = default;
+
+        // New boxes are empty (zero extents at the origin)
+        void Resize(size_t count)
+        {
+            m_center.Resize(count);
+            m_extents.Resize(count);
+        }
+
+        size_t Size() const noexcept { return m_center.Size(); }
+
+        DirectX::BoundingBox Get(size_t index) const noexcept
+        {
+            return DirectX::BoundingBox(m_center.Get(index), m_extents.Get(index));
+        }
+
+        void Set(size_t index, const DirectX::BoundingBox& box) noexcept
+        {
+            m_center.Set(index, box.Center);
+            m_extents.Set(index, box.Extents);
+        }
+
+        void Load(_In_reads_(count) const DirectX::BoundingBox* boxes, size_t count)
+        {
+            if (!boxes && count > 0)
+                throw std::invalid_argument("BoxStream");
+
+            Resize(count);
+            for (size_t j = 0; j < count; ++j)
+            {
+                Set(j, boxes[j]);
+            }
+        }
+
+        // Tests every box; returns the number of hits
+        size_t Intersects(const DirectX::SimpleMath::Ray& ray, _Out_writes_(Size()) float* dist) const;
+
+        // Closest box hit by the ray; false if none are
+        bool Nearest(const DirectX::SimpleMath::Ray& ray, size_t& index, float& dist) const;
+
+    private:
+        friend struct SoADetail::BoxAccess;
+
+        Vector3Stream   m_center;
+        Vector3Stream   m_extents;
+    };
+
+    //----------------------------------------------------------------------------------
+    class SphereStream
+    {
+    public:
+        SphereStream() noexcept = default;
+
+        explicit SphereStream(size_t count) { Resize(count); }
+
+        SphereStream(_In_reads_(count) const DirectX::BoundingSphere* spheres, size_t count) { Load(spheres, count); }
+
+        SphereStream(SphereStream&&) = default;
+        SphereStream& operator= (SphereStream&&) = default;
+
+        SphereStream(SphereStream const&) = default;
+        SphereStream& operator= (SphereStream const&) = default;
+
+        // New spheres have zero radius at the origin
+        void Resize(size_t count)
+        {
+            const size_t keep = std::min(m_center.Size(), count);
+            m_center.Resize(count);
+            m_radius.resize(m_center.PaddedSize());
+            std::fill(m_radius.begin() + ptrdiff_t(keep), m_radius.end(), 0.f);
+        }
+
+        size_t Size() const noexcept { return m_center.Size(); }
+
+        DirectX::BoundingSphere Get(size_t index) const noexcept
+        {
+            return DirectX::BoundingSphere(m_center.Get(index), m_radius[index]);
+        }
+
+        void Set(size_t index, const DirectX::BoundingSphere& sphere) noexcept
+        {
+            m_center.Set(index, sphere.Center);
+            m_radius[index] = sphere.Radius;
+        }
+
+        void Load(_In_reads_(count) const DirectX::BoundingSphere* spheres, size_t count)
+        {
+            if (!spheres && count > 0)
+                throw std::invalid_argument("SphereStream");
+
+            Resize(count);
+            for (size_t j = 0; j < count; ++j)
+            {
+                Set(j, spheres[j]);
+            }
+        }
+
+        // Tests every sphere; returns the number of hits. The ray direction must be normalized.
+        size_t Intersects(const DirectX::SimpleMath::Ray& ray, _Out_writes_(Size()) float* dist) const;
+
+        bool Nearest(const DirectX::SimpleMath::Ray& ray, size_t& index, float& dist) const;
+
+    private:
+        friend struct SoADetail::SphereAccess;
+
+        Vector3Stream       m_center;
+        std::vector<float>  m_radius;
+    };
+
+    //----------------------------------------------------------------------------------
+    class TriangleStream
+    {
+    public:
+        TriangleStream() noexcept = default;
+
+        explicit TriangleStream(size_t count) { Resize(count); }
+
+        TriangleStream(TriangleStream&&) = default;
+        TriangleStream& operator= (TriangleStream&&) = default;
+
+        TriangleStream(TriangleStream const&) = default;
+        TriangleStream& operator= (TriangleStream const&) = default;
+
+        // New triangles are degenerate and never hit
+        void Resize(size_t count)
+        {
+            m_v0.Resize(count);
+            m_e1.Resize(count);
+            m_e2.Resize(count);
+        }
+
+        size_t Size() const noexcept { return m_v0.Size(); }
+
+        void Get(size_t index, DirectX::SimpleMath::Vector3& v0, DirectX::SimpleMath::Vector3& v1, DirectX::SimpleMath::Vector3& v2) const noexcept
+        {
+            v0 = m_v0.Get(index);
+            v1 = v0 + m_e1.Get(index);
+            v2 = v0 + m_e2.Get(index);
+        }
+
+        // Edges are kept rather than vertices, as every ray test needs them
+        void Set(size_t index, const DirectX::SimpleMath::Vector3& v0, const DirectX::SimpleMath::Vector3& v1, const DirectX::SimpleMath::Vector3& v2) noexcept
+        {
+            m_v0.Set(index, v0);
+            m_e1.Set(index, v1 - v0);
+            m_e2.Set(index, v2 - v0);
+        }
+
+        // Triangle list, three vertices per triangle
+        void Load(_In_reads_(count * 3) const DirectX::SimpleMath::Vector3* vertices, size_t count)
+        {
+            if (!vertices && count > 0)
+                throw std::invalid_argument("TriangleStream");
+
+            Resize(count);
+            for (size_t j = 0; j < count; ++j)
+            {
+                Set(j, vertices[j * 3], vertices[j * 3 + 1], vertices[j * 3 + 2]);
+            }
+        }
+
+        // Indexed triangle list (uint16_t or uint32_t indices, three per triangle)
+        template<typename TIndex>
+        void Load(
+            _In_reads_(vertexCount) const DirectX::SimpleMath::Vector3* vertices, size_t vertexCount,
+            _In_reads_(count * 3) const TIndex* indices, size_t count)
+        {
+            static_assert(std::is_unsigned<TIndex>::value, "Indices must be unsigned");
+
+            if ((!vertices && vertexCount > 0) || (!indices && count > 0))
+                throw std::invalid_argument("TriangleStream");
+
+            Resize(count);
+            for (size_t j = 0; j < count; ++j)
+            {
+                const size_t i0 = indices[j * 3];
+                const size_t i1 = indices[j * 3 + 1];
+                const size_t i2 = indices[j * 3 + 2];
+                if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount)
+                    throw std::out_of_range("TriangleStream");
+
+                Set(j, vertices[i0], vertices[i1], vertices[i2]);
+            }
+        }
+
+        // Tests every triangle; returns the number of hits
+        size_t Intersects(const DirectX::SimpleMath::Ray& ray, _Out_writes_(Size()) float* dist) const;
+
+        bool Nearest(const DirectX::SimpleMath::Ray& ray, size_t& index, float& dist) const;
+
+    private:
+        friend struct SoADetail::TriangleAccess;
+
+        Vector3Stream   m_v0;
+        Vector3Stream   m_e1;
+        Vector3Stream   m_e2;
+    };
+
+
+    //==================================================================================
+    // Implementation
+    //==================================================================================
+
+    namespace SoADetail
+    {
+        // Same threshold as DirectXCollision for rays parallel to a slab or triangle
+        constexpr float c_RayEpsilon = 1e-20f;
+
+        inline size_t CountBits(uint32_t mask) noexcept
+        {
+            size_t count = 0;
+            for (; mask; mask &= mask - 1)
+                ++count;
+            return count;
+        }
+
+        // Lanes of block 'j' that hold real elements rather than padding
+        template<typename L>
+        inline uint32_t ValidLanes(size_t j, size_t count) noexcept
+        {
+            const size_t remaining = count - j;
+            return (remaining >= L::Width) ? ((1u << L::Width) - 1) : ((1u << remaining) - 1);
+        }
+
+        //------------------------------------------------------------------------------
+        // Per-lane tests. Each returns a hit mask and the hit distance, with inputs
+        // either loaded from a stream or splatted from a single ray or primitive.
+
+        // BoundingBox::Intersects; 'toCenter' is center - origin
+        template<typename L>
+        inline typename L::V XM_CALLCONV BoxTest(
+            typename L::V cx, typename L::V cy, typename L::V cz,
+            typename L::V ex, typename L::V ey, typename L::V ez,
+            typename L::V dx, typename L::V dy, typename L::V dz,
+            typename L::V ix, typename L::V iy, typename L::V iz,
+            typename L::V& dist) noexcept
+        {
+            using V = typename L::V;
+
+            const V epsilon = L::Splat(c_RayEpsilon);
+            const V lowest = L::Splat(-FLT_MAX);
+            const V highest = L::Splat(FLT_MAX);
+
+            V tmin = lowest;
+            V tmax = highest;
+            V outside = L::Zero();
+
+            const V toCenter[3] = { cx, cy, cz };
+            const V extents[3] = { ex, ey, ez };
+            const V direction[3] = { dx, dy, dz };
+            const V inverse[3] = { ix, iy, iz };
+
+            for (size_t axis = 0; axis < 3; ++axis)
+            {
+                const V parallel = L::LessOrEqual(L::Abs(direction[axis]), epsilon);
+                const V t1 = L::Multiply(L::Subtract(toCenter[axis], extents[axis]), inverse[axis]);
+                const V t2 = L::Multiply(L::Add(toCenter[axis], extents[axis]), inverse[axis]);
+
+                tmin = L::Max(tmin, L::Select(L::Min(t1, t2), lowest, parallel));
+                tmax = L::Min(tmax, L::Select(L::Max(t1, t2), highest, parallel));
+                outside = L::Or(outside, L::And(parallel, L::Greater(L::Abs(toCenter[axis]), extents[axis])));
+            }
+
+            dist = tmin;
+            return L::AndNot(L::And(L::LessOrEqual(tmin, tmax), L::GreaterOrEqual(tmax, L::Zero())), outside);
+        }
+
+        // BoundingSphere::Intersects; 'toCenter' is center - origin
+        template<typename L>
+        inline typename L::V XM_CALLCONV SphereTest(
+            typename L::V lx, typename L::V ly, typename L::V lz, typename L::V radius,
+            typename L::V dx, typename L::V dy, typename L::V dz,
+            typename L::V& dist) noexcept
+        {
+            using V = typename L::V;
+
+            const V s = Dot3<L>(lx, ly, lz, dx, dy, dz);
+            const V l2 = Dot3<L>(lx, ly, lz, lx, ly, lz);
+            const V r2 = L::Multiply(radius, radius);
+            const V m2 = L::Subtract(l2, L::Multiply(s, s));
+
+            // Passes within the radius, and the center is ahead unless the origin is inside
+            const V inside = L::LessOrEqual(l2, r2);
+            const V hit = L::And(L::LessOrEqual(m2, r2), L::Or(L::GreaterOrEqual(s, L::Zero()), inside));
+
+            const V q = L::Sqrt(L::Max(L::Subtract(r2, m2), L::Zero()));
+            dist = L::Select(L::Subtract(s, q), L::Add(s, q), inside);
+            return hit;
+        }
+
+        // TriangleTests::Intersects (Moller-Trumbore, both faces); 's' is origin - v0
+        template<typename L>
+        inline typename L::V XM_CALLCONV TriangleTest(
+            typename L::V sx, typename L::V sy, typename L::V sz,
+            typename L::V e1x, typename L::V e1y, typename L::V e1z,
+            typename L::V e2x, typename L::V e2y, typename L::V e2z,
+            typename L::V dx, typename L::V dy, typename L::V dz,
+            typename L::V& dist) noexcept
+        {
+            using V = typename L::V;
+
+            const V zero = L::Zero();
+            const V epsilon = L::Splat(c_RayEpsilon);
+
+            // p = direction x e2, det = e1 . p
+            const V px = L::Subtract(L::Multiply(dy, e2z), L::Multiply(dz, e2y));
+            const V py = L::Subtract(L::Multiply(dz, e2x), L::Multiply(dx, e2z));
+            const V pz = L::Subtract(L::Multiply(dx, e2y), L::Multiply(dy, e2x));
+            const V det = Dot3<L>(e1x, e1y, e1z, px, py, pz);
+
+            // q = s x e1
+            const V qx = L::Subtract(L::Multiply(sy, e1z), L::Multiply(sz, e1y));
+            const V qy = L::Subtract(L::Multiply(sz, e1x), L::Multiply(sx, e1z));
+            const V qz = L::Subtract(L::Multiply(sx, e1y), L::Multiply(sy, e1x));
+
+            const V u = Dot3<L>(sx, sy, sz, px, py, pz);
+            const V v = Dot3<L>(dx, dy, dz, qx, qy, qz);
+            const V t = Dot3<L>(e2x, e2y, e2z, qx, qy, qz);
+            const V uv = L::Add(u, v);
+
+            V front = L::GreaterOrEqual(det, epsilon);
+            front = L::And(front, L::And(L::GreaterOrEqual(u, zero), L::LessOrEqual(u, det)));
+            front = L::And(front, L::And(L::GreaterOrEqual(v, zero), L::LessOrEqual(uv, det)));
+            front = L::And(front, L::GreaterOrEqual(t, zero));
+
+            V back = L::LessOrEqual(det, L::Splat(-c_RayEpsilon));
+            back = L::And(back, L::And(L::LessOrEqual(u, zero), L::GreaterOrEqual(u, det)));
+            back = L::And(back, L::And(L::LessOrEqual(v, zero), L::GreaterOrEqual(uv, det)));
+            back = L::And(back, L::LessOrEqual(t, zero));
+
+            const V hit = L::Or(front, back);
+            dist = L::Divide(t, L::Select(L::Splat(1.f), det, hit));
+            return hit;
+        }
+
+        //------------------------------------------------------------------------------
+        // Drivers: 'test(j, dist)' evaluates block j and returns its hit mask
+
+        template<typename L, typename TTest>
+        size_t WriteAll(size_t count, _Out_writes_(count) float* result, TTest test)
+        {
+            using V = typename L::V;
+
+            const V miss = L::Splat(FLT_MAX);
+
+            size_t hits = 0;
+            for (size_t j = 0; j < count; j += L::Width)
+            {
+                V dist;
+                const V hit = test(j, dist);
+                dist = L::Select(miss, dist, hit);
+
+                if (j + L::Width <= count)
+                {
+                    L::Store(result + j, dist);
+                }
+                else
+                {
+                    float tail[L::Width];
+                    L::Store(tail, dist);
+                    std::copy(tail, tail + (count - j), result + j);
+                }
+
+                hits += CountBits(L::Mask(hit) & ValidLanes<L>(j, count));
+            }
+            return hits;
+        }
+
+        template<typename L, typename TTest>
+        bool FindNearest(size_t count, size_t& index, float& nearest, TTest test)
+        {
+            using V = typename L::V;
+
+            bool found = false;
+            float best = FLT_MAX;
+            size_t bestIndex = 0;
+
+            for (size_t j = 0; j < count; j += L::Width)
+            {
+                V dist;
+                const V hit = test(j, dist);
+
+                // Most blocks either miss entirely or cannot beat the current best
+                uint32_t mask = L::Mask(L::And(hit, L::Less(dist, L::Splat(best)))) & ValidLanes<L>(j, count);
+                if (!mask)
+                    continue;
+
+                float lanes[L::Width];
+                L::Store(lanes, dist);
+                for (; mask; mask &= mask - 1)
+                {
+                    size_t lane = 0;
+                    while (!(mask & (1u << lane)))
+                        ++lane;
+
+                    if (lanes[lane] < best)
+                    {
+                        best = lanes[lane];
+                        bestIndex = j + lane;
+                        found = true;
+                    }
+                }
+            }
+
+            if (found)
+            {
+                index = bestIndex;
+                nearest = best;
+            }
+            return found;
+        }
+
+        inline void CheckOutput(size_t count, const float* dist, _In_z_ const char* name)
+        {
+            if (!dist && count > 0)
+                throw std::invalid_argument(name);
+        }
+
+        //------------------------------------------------------------------------------
+        // Block evaluation for each pairing
+
+        struct BoxAccess
+        {
+            static const Vector3Stream& Center(const BoxStream& s) noexcept { return s.m_center; }
+            static const Vector3Stream& Extents(const BoxStream& s) noexcept { return s.m_extents; }
+        };
+
+        struct SphereAccess
+        {
+            static const Vector3Stream& Center(const SphereStream& s) noexcept { return s.m_center; }
+            static const float* Radius(const SphereStream& s) noexcept { return s.m_radius.data(); }
+        };
+
+        struct TriangleAccess
+        {
+            static const Vector3Stream& V0(const TriangleStream& s) noexcept { return s.m_v0; }
+            static const Vector3Stream& E1(const TriangleStream& s) noexcept { return s.m_e1; }
+            static const Vector3Stream& E2(const TriangleStream& s) noexcept { return s.m_e2; }
+        };
+
+        template<typename L>
+        inline auto RayBoxes(const DirectX::SimpleMath::Ray& ray, const BoxStream& boxes) noexcept
+        {
+            using V = typename L::V;
+
+            const DirectX::SimpleMath::Vector3& o = ray.position;
+            const DirectX::SimpleMath::Vector3& d = ray.direction;
+            const V ox = L::Splat(o.x), oy = L::Splat(o.y), oz = L::Splat(o.z);
+            const V dx = L::Splat(d.x), dy = L::Splat(d.y), dz = L::Splat(d.z);
+            const V ix = L::Splat(1.f / d.x), iy = L::Splat(1.f / d.y), iz = L::Splat(1.f / d.z);
+
+            const Vector3Stream& center = BoxAccess::Center(boxes);
+            const Vector3Stream& extents = BoxAccess::Extents(boxes);
+
+            return [=, &center, &extents](size_t j, V& dist) noexcept
+            {
+                return BoxTest<L>(
+                    L::Subtract(L::Load(center.X() + j), ox), L::Subtract(L::Load(center.Y() + j), oy), L::Subtract(L::Load(center.Z() + j), oz),
+                    L::Load(extents.X() + j), L::Load(extents.Y() + j), L::Load(extents.Z() + j),
+                    dx, dy, dz, ix, iy, iz, dist);
+            };
+        }
+
+        template<typename L>
+        inline auto RaySpheres(const DirectX::SimpleMath::Ray& ray, const SphereStream& spheres) noexcept
+        {
+            using V = typename L::V;
+
+            const V ox = L::Splat(ray.position.x), oy = L::Splat(ray.position.y), oz = L::Splat(ray.position.z);
+            const V dx = L::Splat(ray.direction.x), dy = L::Splat(ray.direction.y), dz = L::Splat(ray.direction.z);
+
+            const Vector3Stream& center = SphereAccess::Center(spheres);
+            const float* radius = SphereAccess::Radius(spheres);
+
+            return [=, &center](size_t j, V& dist) noexcept
+            {
+                return SphereTest<L>(
+                    L::Subtract(L::Load(center.X() + j), ox), L::Subtract(L::Load(center.Y() + j), oy), L::Subtract(L::Load(center.Z() + j), oz),
+                    L::Load(radius + j), dx, dy, dz, dist);
+            };
+        }
+
+        template<typename L>
+        inline auto RayTriangles(const DirectX::SimpleMath::Ray& ray, const TriangleStream& triangles) noexcept
+        {
+            using V = typename L::V;
+
+            const V ox = L::Splat(ray.position.x), oy = L::Splat(ray.position.y), oz = L::Splat(ray.position.z);
+            const V dx = L::Splat(ray.direction.x), dy = L::Splat(ray.direction.y), dz = L::Splat(ray.direction.z);
+
+            const Vector3Stream& v0 = TriangleAccess::V0(triangles);
+            const Vector3Stream& e1 = TriangleAccess::E1(triangles);
+            const Vector3Stream& e2 = TriangleAccess::E2(triangles);
+
+            return [=, &v0, &e1, &e2](size_t j, V& dist) noexcept
+            {
+                return TriangleTest<L>(
+                    L::Subtract(ox, L::Load(v0.X() + j)), L::Subtract(oy, L::Load(v0.Y() + j)), L::Subtract(oz, L::Load(v0.Z() + j)),
+                    L::Load(e1.X() + j), L::Load(e1.Y() + j), L::Load(e1.Z() + j),
+                    L::Load(e2.X() + j), L::Load(e2.Y() + j), L::Load(e2.Z() + j),
+                    dx, dy, dz, dist);
+            };
+        }
+
+        template<typename L>
+        inline auto PacketBox(const Vector3Stream& position, const Vector3Stream& direction, const Vector3Stream& inverse,
+            const DirectX::BoundingBox& box) noexcept
+        {
+            using V = typename L::V;
+
+            const V cx = L::Splat(box.Center.x), cy = L::Splat(box.Center.y), cz = L::Splat(box.Center.z);
+            const V ex = L::Splat(box.Extents.x), ey = L::Splat(box.Extents.y), ez = L::Splat(box.Extents.z);
+
+            return [=, &position, &direction, &inverse](size_t j, V& dist) noexcept
+            {
+                return BoxTest<L>(
+                    L::Subtract(cx, L::Load(position.X() + j)), L::Subtract(cy, L::Load(position.Y() + j)), L::Subtract(cz, L::Load(position.Z() + j)),
+                    ex, ey, ez,
+                    L::Load(direction.X() + j), L::Load(direction.Y() + j), L::Load(direction.Z() + j),
+                    L::Load(inverse.X() + j), L::Load(inverse.Y() + j), L::Load(inverse.Z() + j),
+                    dist);
+            };
+        }
+
+        template<typename L>
+        inline auto PacketSphere(const Vector3Stream& position, const Vector3Stream& direction,
+            const DirectX::BoundingSphere& sphere) noexcept
+        {
+            using V = typename L::V;
+
+            const V cx = L::Splat(sphere.Center.x), cy = L::Splat(sphere.Center.y), cz = L::Splat(sphere.Center.z);
+            const V radius = L::Splat(sphere.Radius);
+
+            return [=, &position, &direction](size_t j, V& dist) noexcept
+            {
+                return SphereTest<L>(
+                    L::Subtract(cx, L::Load(position.X() + j)), L::Subtract(cy, L::Load(position.Y() + j)), L::Subtract(cz, L::Load(position.Z() + j)),
+                    radius,
+                    L::Load(direction.X() + j), L::Load(direction.Y() + j), L::Load(direction.Z() + j),
+                    dist);
+            };
+        }
+    }
+
+    //----------------------------------------------------------------------------------
+    inline size_t RayPacket::Intersects(const DirectX::BoundingBox& box, float* dist) const
+    {
+        SoADetail::CheckOutput(Size(), dist, "RayPacket::Intersects");
+        return SoADetail::WriteAll<SoADetail::Lanes>(Size(), dist,
+            SoADetail::PacketBox<SoADetail::Lanes>(m_position, m_direction, m_inverse, box));
+    }
+
+    inline size_t RayPacket::Intersects(const DirectX::BoundingSphere& sphere, float* dist) const
+    {
+        SoADetail::CheckOutput(Size(), dist, "RayPacket::Intersects");
+        return SoADetail::WriteAll<SoADetail::Lanes>(Size(), dist,
+            SoADetail::PacketSphere<SoADetail::Lanes>(m_position, m_direction, sphere));
+    }
+
+    inline bool RayPacket::Nearest(const DirectX::BoundingBox& box, size_t& index, float& dist) const
+    {
+        return SoADetail::FindNearest<SoADetail::Lanes>(Size(), index, dist,
+            SoADetail::PacketBox<SoADetail::Lanes>(m_position, m_direction, m_inverse, box));
+    }
+
+    inline bool RayPacket::Nearest(const DirectX::BoundingSphere& sphere, size_t& index, float& dist) const
+    {
+        return SoADetail::FindNearest<SoADetail::Lanes>(Size(), index, dist,
+            SoADetail::PacketSphere<SoADetail::Lanes>(m_position, m_direction, sphere));
+    }
+
+    inline size_t BoxStream::Intersects(const DirectX::SimpleMath::Ray& ray, float* dist) const
+    {
+        SoADetail::CheckOutput(Size(), dist, "BoxStream::Intersects");
+        return SoADetail::WriteAll<SoADetail::Lanes>(Size(), dist, SoADetail::RayBoxes<SoADetail::Lanes>(ray, *this));
+    }
+
+    inline bool BoxStream::Nearest(const DirectX::SimpleMath::Ray& ray, size_t& index, float& dist) const
+    {
+        return SoADetail::FindNearest<SoADetail::Lanes>(Size(), index, dist, SoADetail::RayBoxes<SoADetail::Lanes>(ray, *this));
+    }
+
+    inline size_t SphereStream::Intersects(const DirectX::SimpleMath::Ray& ray, float* dist) const
+    {
+        SoADetail::CheckOutput(Size(), dist, "SphereStream::Intersects");
+        return SoADetail::WriteAll<SoADetail::Lanes>(Size(), dist, SoADetail::RaySpheres<SoADetail::Lanes>(ray, *this));
+    }
+
+    inline bool SphereStream::Nearest(const DirectX::SimpleMath::Ray& ray, size_t& index, float& dist) const
+    {
+        return SoADetail::FindNearest<SoADetail::Lanes>(Size(), index, dist, SoADetail::RaySpheres<SoADetail::Lanes>(ray, *this));
+    }
+
+    inline size_t TriangleStream::Intersects(const DirectX::SimpleMath::Ray& ray, float* dist) const
+    {
+        SoADetail::CheckOutput(Size(), dist, "TriangleStream::Intersects");
+        return SoADetail::WriteAll<SoADetail::Lanes>(Size(), dist, SoADetail::RayTriangles<SoADetail::Lanes>(ray, *this));
+    }
+
+    inline bool TriangleStream::Nearest(const DirectX::SimpleMath::Ray& ray, size_t& index, float& dist) const
+    {
+        return SoADetail::FindNearest<SoADetail::Lanes>(Size(), index, dist, SoADetail::RayTriangles<SoADetail::Lanes>(ray, *this));
+    }
+}
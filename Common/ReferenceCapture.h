@@ -0,0 +1,332 @@
+//--------------------------------------------------------------------------------------
+// File: ReferenceCapture.h
+//
+// Reads back rendered frames and compares them against golden images (see ImageDiff.h)
+//
+// Set DIRECTXTK_REFERENCE_PATH to a directory to enable checking; goldens are stored as
+// <path>\<test>\<name>.qoi. With DIRECTXTK_REFERENCE_UPDATE=1 the goldens are written
+// instead. A mismatch writes <name>.actual.qoi and <name>.diff.qoi next to the golden,
+// and whole golden trees can be compared offline with the imagediff tool.
+//
+// Results go to stderr as well as the debugger, and tests end the run with the exit
+// code from Summarize so that a mismatch or missing golden fails under CTest.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "ImageDiff.h"
+
+#include <d3d11_1.h>
+
+#include <DirectXPackedVector.h>
+
+#include <wrl/client.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
+
+
+namespace DX
+{
+    // Reads back the first sub-resource of a 2D texture as RGBA8, resolving MSAA first.
+    // Float formats are clamped to 0..1, so capture HDR scenes after tone mapping.
+    inline HRESULT CaptureTexture(_In_ ID3D11DeviceContext* context, _In_ ID3D11Resource* source, RGBAImage& image)
+    {
+        if (!context || !source)
+            return E_INVALIDARG;
+
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+        HRESULT hr = source->QueryInterface(IID_PPV_ARGS(texture.GetAddressOf()));
+        if (FAILED(hr))
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+        D3D11_TEXTURE2D_DESC desc = {};
+        texture->GetDesc(&desc);
+
+        switch (desc.Format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+            break;
+
+        default:
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+        }
+
+        Microsoft::WRL::ComPtr<ID3D11Device> device;
+        context->GetDevice(device.GetAddressOf());
+
+        D3D11_TEXTURE2D_DESC copyDesc = desc;
+        copyDesc.MipLevels = 1;
+        copyDesc.ArraySize = 1;
+        copyDesc.SampleDesc.Count = 1;
+        copyDesc.SampleDesc.Quality = 0;
+        copyDesc.Usage = D3D11_USAGE_DEFAULT;
+        copyDesc.BindFlags = 0;
+        copyDesc.CPUAccessFlags = 0;
+        copyDesc.MiscFlags = 0;
+
+        if (desc.SampleDesc.Count > 1)
+        {
+            Microsoft::WRL::ComPtr<ID3D11Texture2D> resolved;
+            hr = device->CreateTexture2D(&copyDesc, nullptr, resolved.GetAddressOf());
+            if (FAILED(hr))
+                return hr;
+
+            context->ResolveSubresource(resolved.Get(), 0, texture.Get(), 0, desc.Format);
+            texture.Swap(resolved);
+        }
+
+        copyDesc.Usage = D3D11_USAGE_STAGING;
+        copyDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> staging;
+        hr = device->CreateTexture2D(&copyDesc, nullptr, staging.GetAddressOf());
+        if (FAILED(hr))
+            return hr;
+
+        context->CopySubresourceRegion(staging.Get(), 0, 0, 0, 0, texture.Get(), 0, nullptr);
+
+        D3D11_MAPPED_SUBRESOURCE mapped = {};
+        hr = context->Map(staging.Get(), 0, D3D11_MAP_READ, 0, &mapped);
+        if (FAILED(hr))
+            return hr;
+
+        image.width = desc.Width;
+        image.height = desc.Height;
+        image.pixels.resize(size_t(desc.Width) * desc.Height * 4);
+
+        uint8_t* dst = image.pixels.data();
+        for (uint32_t y = 0; y < desc.Height; ++y)
+        {
+            const uint8_t* row = static_cast<const uint8_t*>(mapped.pData) + size_t(y) * mapped.RowPitch;
+
+            switch (desc.Format)
+            {
+            case DXGI_FORMAT_R8G8B8A8_UNORM:
+            case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+                memcpy(dst, row, size_t(desc.Width) * 4);
+                dst += size_t(desc.Width) * 4;
+                break;
+
+            case DXGI_FORMAT_B8G8R8A8_UNORM:
+            case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            case DXGI_FORMAT_B8G8R8X8_UNORM:
+            case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+                {
+                    const bool opaque = desc.Format == DXGI_FORMAT_B8G8R8X8_UNORM || desc.Format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+                    for (uint32_t x = 0; x < desc.Width; ++x, row += 4, dst += 4)
+                    {
+                        dst[0] = row[2];
+                        dst[1] = row[1];
+                        dst[2] = row[0];
+                        dst[3] = opaque ? 255 : row[3];
+                    }
+                }
+                break;
+
+            case DXGI_FORMAT_R10G10B10A2_UNORM:
+                for (uint32_t x = 0; x < desc.Width; ++x, row += 4, dst += 4)
+                {
+                    uint32_t v;
+                    memcpy(&v, row, sizeof(v));
+                    dst[0] = static_cast<uint8_t>((v >> 2) & 0xFF);
+                    dst[1] = static_cast<uint8_t>((v >> 12) & 0xFF);
+                    dst[2] = static_cast<uint8_t>((v >> 22) & 0xFF);
+                    dst[3] = static_cast<uint8_t>((v >> 30) * 85);
+                }
+                break;
+
+            default: // DXGI_FORMAT_R16G16B16A16_FLOAT
+                for (uint32_t x = 0; x < desc.Width; ++x, row += 8, dst += 4)
+                {
+                    for (size_t c = 0; c < 4; ++c)
+                    {
+                        DirectX::PackedVector::HALF h;
+                        memcpy(&h, row + c * 2, sizeof(h));
+                        const float f = std::min(std::max(DirectX::PackedVector::XMConvertHalfToFloat(h), 0.f), 1.f);
+                        dst[c] = static_cast<uint8_t>(f * 255.f + 0.5f);
+                    }
+                }
+                break;
+            }
+        }
+
+        context->Unmap(staging.Get(), 0);
+
+        return S_OK;
+    }
+
+    // Allows for small rasterization differences between GPUs
+    constexpr ImageDiffOptions c_defaultReferenceOptions = { 2, 0.05f, 0.001, true };
+
+    class ReferenceCapture
+    {
+    public:
+        explicit ReferenceCapture(_In_z_ const wchar_t* testName, const ImageDiffOptions& options = c_defaultReferenceOptions) noexcept(false) :
+            m_update(false),
+            m_options(options),
+            m_checked(0),
+            m_failures(0)
+        {
+            if (!testName)
+                throw std::invalid_argument("ReferenceCapture");
+
+            wchar_t path[MAX_PATH] = {};
+            const DWORD length = GetEnvironmentVariableW(L"DIRECTXTK_REFERENCE_PATH", path, MAX_PATH);
+            if (length > 0 && length < MAX_PATH)
+            {
+                m_directory = std::filesystem::path(path) / testName;
+
+                wchar_t update[8] = {};
+                if (GetEnvironmentVariableW(L"DIRECTXTK_REFERENCE_UPDATE", update, static_cast<DWORD>(std::size(update))) > 0)
+                {
+                    m_update = (wcscmp(update, L"0") != 0);
+                }
+            }
+        }
+
+        ReferenceCapture(ReferenceCapture&&) = default;
+        ReferenceCapture& operator= (ReferenceCapture&&) = default;
+
+        ReferenceCapture(ReferenceCapture const&) = delete;
+        ReferenceCapture& operator= (ReferenceCapture const&) = delete;
+
+        bool IsEnabled() const noexcept { return !m_directory.empty(); }
+        bool IsUpdating() const noexcept { return m_update; }
+
+        // Returns S_OK if the frame matches (or the golden was written), S_FALSE on a mismatch
+        HRESULT Check(_In_ ID3D11DeviceContext* context, _In_ ID3D11Resource* source, _In_z_ const wchar_t* name)
+        {
+            if (!IsEnabled())
+                return S_OK;
+
+            if (!name)
+                return E_INVALIDARG;
+
+            ++m_checked;
+
+            RGBAImage image = {};
+            HRESULT hr = CaptureTexture(context, source, image);
+            if (FAILED(hr))
+            {
+                Log(L"ERROR: Failed to capture %ls (%08X)\n", name, static_cast<unsigned int>(hr));
+                ++m_failures;
+                return hr;
+            }
+
+            const auto golden = GetPath(name, L".qoi");
+
+            if (m_update)
+            {
+                std::error_code ec;
+                std::filesystem::create_directories(m_directory, ec);
+
+                hr = SaveReferenceImage(golden, image);
+                if (FAILED(hr))
+                {
+                    Log(L"ERROR: Failed to write reference image %ls (%08X)\n", golden.c_str(), static_cast<unsigned int>(hr));
+                    ++m_failures;
+                    return hr;
+                }
+
+                Log(L"Wrote reference image %ls\n", golden.c_str());
+                return S_OK;
+            }
+
+            RGBAImage reference = {};
+            hr = LoadReferenceImage(golden, reference);
+            if (FAILED(hr))
+            {
+                Log(L"ERROR: Missing reference image %ls (%08X)\n", golden.c_str(), static_cast<unsigned int>(hr));
+                ++m_failures;
+                std::ignore = SaveReferenceImage(GetPath(name, L".actual.qoi"), image);
+                return hr;
+            }
+
+            if (reference.width != image.width || reference.height != image.height)
+            {
+                Log(L"ERROR: %ls is %ux%u, but the reference image is %ux%u\n", name, image.width, image.height, reference.width, reference.height);
+                ++m_failures;
+                std::ignore = SaveReferenceImage(GetPath(name, L".actual.qoi"), image);
+                return S_FALSE;
+            }
+
+            ImageDiffResult result = {};
+            RGBAImage diff = {};
+            hr = DiffImages(reference, image, m_options, result, &diff);
+            if (FAILED(hr))
+            {
+                ++m_failures;
+                return hr;
+            }
+
+            if (!result.passed)
+            {
+                Log(L"ERROR: %ls differs from the reference image: %llu of %llu pixels, max delta %u, PSNR %.2f dB\n",
+                    name, static_cast<unsigned long long>(result.differentPixels), static_cast<unsigned long long>(result.pixels),
+                    result.maxChannelDelta, result.psnr);
+                ++m_failures;
+                std::ignore = SaveReferenceImage(GetPath(name, L".actual.qoi"), image);
+                std::ignore = SaveReferenceImage(GetPath(name, L".diff.qoi"), diff);
+                return S_FALSE;
+            }
+
+            Log(L"%ls matches the reference image\n", name);
+            return S_OK;
+        }
+
+        size_t GetChecked() const noexcept { return m_checked; }
+        size_t GetFailures() const noexcept { return m_failures; }
+
+        // Reports the totals and returns the process exit code: 0 if every check passed
+        int Summarize() const noexcept
+        {
+            if (!IsEnabled())
+                return 0;
+
+            Log(L"Reference images: %zu checked, %zu failed\n", m_checked, m_failures);
+            return (m_failures > 0) ? 1 : 0;
+        }
+
+    private:
+        std::filesystem::path GetPath(const wchar_t* name, const wchar_t* extension) const
+        {
+            return m_directory / (std::wstring(name) + extension);
+        }
+
+        template<typename... Args>
+        static void Log(_In_z_ _Printf_format_string_ const wchar_t* format, Args... args) noexcept
+        {
+            wchar_t buff[512] = {};
+            swprintf_s(buff, format, args...);
+            OutputDebugStringW(buff);
+            fputws(buff, stderr);
+            fflush(stderr);
+        }
+
+        std::filesystem::path   m_directory;
+        bool                    m_update;
+        ImageDiffOptions        m_options;
+        size_t                  m_checked;
+        size_t                  m_failures;
+    };
+}
@@ -0,0 +1,399 @@
+//--------------------------------------------------------------------------------------
+// File: SimpleMathConstexpr.h
+//
+// Compile-time arithmetic, comparisons and table builders for SimpleMath value types
+//
+// SimpleMath operators go through XMVECTOR and so cannot appear in constant expressions,
+// but Vector2/3/4, Color, Rectangle and Viewport all have constexpr component constructors.
+// These functions use those constructors with plain scalar math, so lookup tables (UI
+// layouts, palettes, gradients) can be declared constexpr and placed in read-only data
+// with no startup initialization.
+//
+// Results follow the SimpleMath operators of the same name. Add, Subtract, Multiply,
+// Divide, Negate, Min, Max and the Rectangle/Viewport helpers produce the same values;
+// functions that sum products (Dot, Cross, LengthSquared, Lerp) may differ in the last
+// bit where DirectXMath uses fused multiply-add or a different summation order.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SimpleMath.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+
+namespace DX
+{
+    namespace ConstexprMath
+    {
+        namespace Detail
+        {
+            template<typename T> struct Dimension;
+            template<> struct Dimension<DirectX::SimpleMath::Vector2> { static constexpr size_t value = 2; };
+            template<> struct Dimension<DirectX::SimpleMath::Vector3> { static constexpr size_t value = 3; };
+            template<> struct Dimension<DirectX::SimpleMath::Vector4> { static constexpr size_t value = 4; };
+            template<> struct Dimension<DirectX::SimpleMath::Color> { static constexpr size_t value = 4; };
+
+            template<typename T, typename TOp>
+            constexpr T Map(const T& a, TOp op) noexcept
+            {
+                if constexpr (Dimension<T>::value == 2)
+                    return T(op(a.x), op(a.y));
+                else if constexpr (Dimension<T>::value == 3)
+                    return T(op(a.x), op(a.y), op(a.z));
+                else
+                    return T(op(a.x), op(a.y), op(a.z), op(a.w));
+            }
+
+            template<typename T, typename TOp>
+            constexpr T Map(const T& a, const T& b, TOp op) noexcept
+            {
+                if constexpr (Dimension<T>::value == 2)
+                    return T(op(a.x, b.x), op(a.y, b.y));
+                else if constexpr (Dimension<T>::value == 3)
+                    return T(op(a.x, b.x), op(a.y, b.y), op(a.z, b.z));
+                else
+                    return T(op(a.x, b.x), op(a.y, b.y), op(a.z, b.z), op(a.w, b.w));
+            }
+
+            template<typename T, typename TOp>
+            constexpr bool All(const T& a, const T& b, TOp op) noexcept
+            {
+                if constexpr (Dimension<T>::value == 2)
+                    return op(a.x, b.x) && op(a.y, b.y);
+                else if constexpr (Dimension<T>::value == 3)
+                    return op(a.x, b.x) && op(a.y, b.y) && op(a.z, b.z);
+                else
+                    return op(a.x, b.x) && op(a.y, b.y) && op(a.z, b.z) && op(a.w, b.w);
+            }
+
+            template<typename T>
+            using EnableVector = typename std::enable_if<(Dimension<T>::value > 0), T>::type;
+
+            constexpr float Min(float a, float b) noexcept { return (a < b) ? a : b; }
+            constexpr float Max(float a, float b) noexcept { return (a > b) ? a : b; }
+            constexpr long Min(long a, long b) noexcept { return (a < b) ? a : b; }
+            constexpr long Max(long a, long b) noexcept { return (a > b) ? a : b; }
+        }
+
+        //------------------------------------------------------------------------------
+        // Vector2, Vector3, Vector4 and Color
+
+        template<typename T>
+        constexpr Detail::EnableVector<T> Add(const T& a, const T& b) noexcept
+        {
+            return Detail::Map(a, b, [](float l, float r) constexpr { return l + r; });
+        }
+
+        template<typename T>
+        constexpr Detail::EnableVector<T> Subtract(const T& a, const T& b) noexcept
+        {
+            return Detail::Map(a, b, [](float l, float r) constexpr { return l - r; });
+        }
+
+        // Per-component product, like operator*(V, V)
+        template<typename T>
+        constexpr Detail::EnableVector<T> Multiply(const T& a, const T& b) noexcept
+        {
+            return Detail::Map(a, b, [](float l, float r) constexpr { return l * r; });
+        }
+
+        template<typename T>
+        constexpr Detail::EnableVector<T> Multiply(const T& a, float s) noexcept
+        {
+            return Detail::Map(a, [s](float v) constexpr { return v * s; });
+        }
+
+        template<typename T>
+        constexpr Detail::EnableVector<T> Divide(const T& a, const T& b) noexcept
+        {
+            return Detail::Map(a, b, [](float l, float r) constexpr { return l / r; });
+        }
+
+        // Like operator/(V, float), which scales by the reciprocal
+        template<typename T>
+        constexpr Detail::EnableVector<T> Divide(const T& a, float s) noexcept
+        {
+            return Multiply(a, 1.f / s);
+        }
+
+        template<typename T>
+        constexpr Detail::EnableVector<T> Negate(const T& a) noexcept
+        {
+            return Detail::Map(a, [](float v) constexpr { return -v; });
+        }
+
+        template<typename T>
+        constexpr Detail::EnableVector<T> Min(const T& a, const T& b) noexcept
+        {
+            return Detail::Map(a, b, [](float l, float r) constexpr { return Detail::Min(l, r); });
+        }
+
+        template<typename T>
+        constexpr Detail::EnableVector<T> Max(const T& a, const T& b) noexcept
+        {
+            return Detail::Map(a, b, [](float l, float r) constexpr { return Detail::Max(l, r); });
+        }
+
+        template<typename T>
+        constexpr Detail::EnableVector<T> Clamp(const T& v, const T& vmin, const T& vmax) noexcept
+        {
+            return Min(Max(v, vmin), vmax);
+        }
+
+        // v1 + t * (v2 - v1), as XMVectorLerp
+        template<typename T>
+        constexpr Detail::EnableVector<T> Lerp(const T& v1, const T& v2, float t) noexcept
+        {
+            return Detail::Map(v1, v2, [t](float a, float b) constexpr { return a + t * (b - a); });
+        }
+
+        template<typename T>
+        constexpr float Dot(const T& a, const T& b) noexcept
+        {
+            if constexpr (Detail::Dimension<T>::value == 2)
+                return a.x * b.x + a.y * b.y;
+            else if constexpr (Detail::Dimension<T>::value == 3)
+                return a.x * b.x + a.y * b.y + a.z * b.z;
+            else
+                return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+        }
+
+        template<typename T>
+        constexpr float LengthSquared(const T& v) noexcept
+        {
+            return Dot(v, v);
+        }
+
+        template<typename T>
+        constexpr float DistanceSquared(const T& a, const T& b) noexcept
+        {
+            return LengthSquared(Subtract(a, b));
+        }
+
+        constexpr DirectX::SimpleMath::Vector3 Cross(const DirectX::SimpleMath::Vector3& a, const DirectX::SimpleMath::Vector3& b) noexcept
+        {
+            return DirectX::SimpleMath::Vector3(
+                a.y * b.z - a.z * b.y,
+                a.z * b.x - a.x * b.z,
+                a.x * b.y - a.y * b.x);
+        }
+
+        // Same as operator==, which compares every component exactly
+        template<typename T>
+        constexpr bool Equal(const T& a, const T& b) noexcept
+        {
+            return Detail::All(a, b, [](float l, float r) constexpr { return l == r; });
+        }
+
+        template<typename T>
+        constexpr bool NotEqual(const T& a, const T& b) noexcept
+        {
+            return !Equal(a, b);
+        }
+
+        //------------------------------------------------------------------------------
+        // Color
+
+        // 0xAARRGGBB, the layout of PackedVector::XMCOLOR and Colors.h hex values
+        constexpr DirectX::SimpleMath::Color ColorFromARGB(uint32_t argb) noexcept
+        {
+            return DirectX::SimpleMath::Color(
+                float((argb >> 16) & 0xFF) / 255.f,
+                float((argb >> 8) & 0xFF) / 255.f,
+                float(argb & 0xFF) / 255.f,
+                float((argb >> 24) & 0xFF) / 255.f);
+        }
+
+        // 0xAABBGGRR, the layout of PackedVector::XMUBYTEN4 and DXGI_FORMAT_R8G8B8A8_UNORM texels
+        constexpr DirectX::SimpleMath::Color ColorFromABGR(uint32_t abgr) noexcept
+        {
+            return DirectX::SimpleMath::Color(
+                float(abgr & 0xFF) / 255.f,
+                float((abgr >> 8) & 0xFF) / 255.f,
+                float((abgr >> 16) & 0xFF) / 255.f,
+                float((abgr >> 24) & 0xFF) / 255.f);
+        }
+
+        // Color::Negate (1 - rgb, alpha unchanged)
+        constexpr DirectX::SimpleMath::Color NegateColor(const DirectX::SimpleMath::Color& c) noexcept
+        {
+            return DirectX::SimpleMath::Color(1.f - c.x, 1.f - c.y, 1.f - c.z, c.w);
+        }
+
+        constexpr DirectX::SimpleMath::Color Saturate(const DirectX::SimpleMath::Color& c) noexcept
+        {
+            return DirectX::SimpleMath::Color(
+                Detail::Min(Detail::Max(c.x, 0.f), 1.f),
+                Detail::Min(Detail::Max(c.y, 0.f), 1.f),
+                Detail::Min(Detail::Max(c.z, 0.f), 1.f),
+                Detail::Min(Detail::Max(c.w, 0.f), 1.f));
+        }
+
+        constexpr DirectX::SimpleMath::Color Premultiply(const DirectX::SimpleMath::Color& c) noexcept
+        {
+            return DirectX::SimpleMath::Color(c.x * c.w, c.y * c.w, c.z * c.w, c.w);
+        }
+
+        //------------------------------------------------------------------------------
+        // Rectangle
+
+        constexpr bool Equal(const DirectX::SimpleMath::Rectangle& a, const DirectX::SimpleMath::Rectangle& b) noexcept
+        {
+            return (a.x == b.x) && (a.y == b.y) && (a.width == b.width) && (a.height == b.height);
+        }
+
+        constexpr bool NotEqual(const DirectX::SimpleMath::Rectangle& a, const DirectX::SimpleMath::Rectangle& b) noexcept
+        {
+            return !Equal(a, b);
+        }
+
+        constexpr bool IsEmpty(const DirectX::SimpleMath::Rectangle& r) noexcept
+        {
+            return (r.width == 0 && r.height == 0 && r.x == 0 && r.y == 0);
+        }
+
+        constexpr DirectX::SimpleMath::Vector2 Location(const DirectX::SimpleMath::Rectangle& r) noexcept
+        {
+            return DirectX::SimpleMath::Vector2(float(r.x), float(r.y));
+        }
+
+        constexpr DirectX::SimpleMath::Vector2 Center(const DirectX::SimpleMath::Rectangle& r) noexcept
+        {
+            return DirectX::SimpleMath::Vector2(float(r.x) + (float(r.width) / 2.f), float(r.y) + (float(r.height) / 2.f));
+        }
+
+        constexpr bool Contains(const DirectX::SimpleMath::Rectangle& r, long ix, long iy) noexcept
+        {
+            return (r.x <= ix) && (ix < (r.x + r.width)) && (r.y <= iy) && (iy < (r.y + r.height));
+        }
+
+        constexpr bool Contains(const DirectX::SimpleMath::Rectangle& r, const DirectX::SimpleMath::Vector2& point) noexcept
+        {
+            return (float(r.x) <= point.x) && (point.x < float(r.x + r.width))
+                && (float(r.y) <= point.y) && (point.y < float(r.y + r.height));
+        }
+
+        constexpr bool Contains(const DirectX::SimpleMath::Rectangle& r, const DirectX::SimpleMath::Rectangle& inner) noexcept
+        {
+            return (r.x <= inner.x) && ((inner.x + inner.width) <= (r.x + r.width))
+                && (r.y <= inner.y) && ((inner.y + inner.height) <= (r.y + r.height));
+        }
+
+        constexpr bool Intersects(const DirectX::SimpleMath::Rectangle& a, const DirectX::SimpleMath::Rectangle& b) noexcept
+        {
+            return (b.x < (a.x + a.width)) && (a.x < (b.x + b.width))
+                && (b.y < (a.y + a.height)) && (a.y < (b.y + b.height));
+        }
+
+        // Rectangle::Intersect; an empty (all zero) rectangle if they do not overlap
+        constexpr DirectX::SimpleMath::Rectangle Intersect(const DirectX::SimpleMath::Rectangle& a, const DirectX::SimpleMath::Rectangle& b) noexcept
+        {
+            const long maxX = Detail::Max(a.x, b.x);
+            const long maxY = Detail::Max(a.y, b.y);
+            const long minRight = Detail::Min(a.x + a.width, b.x + b.width);
+            const long minBottom = Detail::Min(a.y + a.height, b.y + b.height);
+
+            return ((minRight > maxX) && (minBottom > maxY))
+                ? DirectX::SimpleMath::Rectangle(maxX, maxY, minRight - maxX, minBottom - maxY)
+                : DirectX::SimpleMath::Rectangle(0, 0, 0, 0);
+        }
+
+        constexpr DirectX::SimpleMath::Rectangle Union(const DirectX::SimpleMath::Rectangle& a, const DirectX::SimpleMath::Rectangle& b) noexcept
+        {
+            const long minX = Detail::Min(a.x, b.x);
+            const long minY = Detail::Min(a.y, b.y);
+            const long maxRight = Detail::Max(a.x + a.width, b.x + b.width);
+            const long maxBottom = Detail::Max(a.y + a.height, b.y + b.height);
+
+            return DirectX::SimpleMath::Rectangle(minX, minY, maxRight - minX, maxBottom - minY);
+        }
+
+        constexpr DirectX::SimpleMath::Rectangle Offset(const DirectX::SimpleMath::Rectangle& r, long ox, long oy) noexcept
+        {
+            return DirectX::SimpleMath::Rectangle(r.x + ox, r.y + oy, r.width, r.height);
+        }
+
+        // Rectangle::Inflate, which grows the width and height by the amount (not twice it)
+        constexpr DirectX::SimpleMath::Rectangle Inflate(const DirectX::SimpleMath::Rectangle& r, long horizAmount, long vertAmount) noexcept
+        {
+            return DirectX::SimpleMath::Rectangle(r.x - horizAmount, r.y - vertAmount, r.width + horizAmount, r.height + vertAmount);
+        }
+
+        //------------------------------------------------------------------------------
+        // Viewport
+
+        constexpr bool Equal(const DirectX::SimpleMath::Viewport& a, const DirectX::SimpleMath::Viewport& b) noexcept
+        {
+            return (a.x == b.x) && (a.y == b.y) && (a.width == b.width) && (a.height == b.height)
+                && (a.minDepth == b.minDepth) && (a.maxDepth == b.maxDepth);
+        }
+
+        constexpr float AspectRatio(const DirectX::SimpleMath::Viewport& vp) noexcept
+        {
+            return (vp.width == 0.f || vp.height == 0.f) ? 0.f : (vp.width / vp.height);
+        }
+
+        constexpr DirectX::SimpleMath::Rectangle ToRectangle(const DirectX::SimpleMath::Viewport& vp) noexcept
+        {
+            return DirectX::SimpleMath::Rectangle(long(vp.x), long(vp.y), long(vp.width), long(vp.height));
+        }
+
+        //------------------------------------------------------------------------------
+        // Table builders
+
+        namespace Detail
+        {
+            template<size_t Columns, size_t... I>
+            constexpr std::array<DirectX::SimpleMath::Rectangle, sizeof...(I)> Grid(
+                const DirectX::SimpleMath::Rectangle& area, long spacing, std::index_sequence<I...>) noexcept
+            {
+                constexpr long columns = long(Columns);
+                constexpr long rows = long(sizeof...(I) / Columns);
+
+                const long cellWidth = (area.width - spacing * (columns - 1)) / columns;
+                const long cellHeight = (area.height - spacing * (rows - 1)) / rows;
+
+                return { {
+                    DirectX::SimpleMath::Rectangle(
+                        area.x + long(I % Columns) * (cellWidth + spacing),
+                        area.y + long(I / Columns) * (cellHeight + spacing),
+                        cellWidth, cellHeight)...
+                } };
+            }
+
+            template<typename T, size_t... I>
+            constexpr std::array<T, sizeof...(I)> Gradient(const T& first, const T& last, std::index_sequence<I...>) noexcept
+            {
+                return { {
+                    ((sizeof...(I) > 1) ? ConstexprMath::Lerp(first, last, float(I) / float(sizeof...(I) - 1)) : first)...
+                } };
+            }
+        }
+
+        // Splits 'area' into Columns x Rows equal cells in row-major order, with 'spacing'
+        // between neighbors; any remainder from integer division is left on the right/bottom.
+        template<size_t Columns, size_t Rows>
+        constexpr std::array<DirectX::SimpleMath::Rectangle, Columns * Rows> GridLayout(
+            const DirectX::SimpleMath::Rectangle& area, long spacing = 0) noexcept
+        {
+            static_assert(Columns > 0 && Rows > 0, "Grid must have at least one cell");
+            return Detail::Grid<Columns>(area, spacing, std::make_index_sequence<Columns * Rows>());
+        }
+
+        // Count evenly spaced values from 'first' to 'last' inclusive (palettes, ramps)
+        template<size_t Count, typename T>
+        constexpr std::array<Detail::EnableVector<T>, Count> Gradient(const T& first, const T& last) noexcept
+        {
+            static_assert(Count > 0, "Gradient must have at least one entry");
+            return Detail::Gradient(first, last, std::make_index_sequence<Count>());
+        }
+    }
+}
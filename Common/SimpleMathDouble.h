@@ -0,0 +1,618 @@
+//--------------------------------------------------------------------------------------
+// File: SimpleMathDouble.h
+//
+// Double-precision Vector3d and Matrix4d companions to SimpleMath for large worlds
+//
+// Float positions have millimeter steps about 16 km from the origin, which shows up as
+// vertex and camera jitter. Keep world positions and transforms in Vector3d / Matrix4d,
+// and each frame convert them to float *relative to the camera* with ToCameraRelative().
+// The subtraction happens in double, so the float results are small numbers with full
+// precision wherever the camera is. Render with CameraRelativeView() as the view matrix,
+// and the float hot path (culling, skinning, shaders) is unchanged.
+//
+// The batch ToCameraRelative overloads convert with SIMD double-to-float instructions:
+// four doubles at a time with AVX, two with SSE2 or ARM64 NEON, scalar otherwise.
+//
+// Vector3d and Matrix4d follow the SimpleMath conventions: row vectors, v' = v * M, and
+// right-handed CreateLookAt / CreateWorld.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SimpleMath.h"
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(_XM_AVX_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+#include <immintrin.h>
+#elif defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+#include <emmintrin.h>
+#elif defined(_XM_ARM_NEON_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_) && (defined(_M_ARM64) || defined(_M_ARM64EC) || defined(__aarch64__))
+#include <arm_neon.h>
+#define DX_DOUBLE_NEON64
+#endif
+
+
+namespace DX
+{
+    struct Matrix4d;
+
+    //----------------------------------------------------------------------------------
+    struct Vector3d
+    {
+        double x;
+        double y;
+        double z;
+
+        Vector3d() noexcept : x(0.), y(0.), z(0.) {}
+        constexpr explicit Vector3d(double ix) noexcept : x(ix), y(ix), z(ix) {}
+        constexpr Vector3d(double ix, double iy, double iz) noexcept : x(ix), y(iy), z(iz) {}
+        explicit Vector3d(const DirectX::XMFLOAT3& v) noexcept : x(v.x), y(v.y), z(v.z) {}
+
+        Vector3d(const Vector3d&) = default;
+        Vector3d& operator=(const Vector3d&) = default;
+
+        Vector3d(Vector3d&&) = default;
+        Vector3d& operator=(Vector3d&&) = default;
+
+        DirectX::SimpleMath::Vector3 ToVector3() const noexcept
+        {
+            return DirectX::SimpleMath::Vector3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z));
+        }
+
+        // Comparison operators
+        bool operator == (const Vector3d& v) const noexcept { return x == v.x && y == v.y && z == v.z; }
+        bool operator != (const Vector3d& v) const noexcept { return !(*this == v); }
+
+        // Assignment operators
+        Vector3d& operator+= (const Vector3d& v) noexcept { x += v.x; y += v.y; z += v.z; return *this; }
+        Vector3d& operator-= (const Vector3d& v) noexcept { x -= v.x; y -= v.y; z -= v.z; return *this; }
+        Vector3d& operator*= (const Vector3d& v) noexcept { x *= v.x; y *= v.y; z *= v.z; return *this; }
+        Vector3d& operator*= (double s) noexcept { x *= s; y *= s; z *= s; return *this; }
+        Vector3d& operator/= (double s) noexcept { x /= s; y /= s; z /= s; return *this; }
+
+        // Unary operators
+        Vector3d operator+ () const noexcept { return *this; }
+        Vector3d operator- () const noexcept { return Vector3d(-x, -y, -z); }
+
+        // Vector operations
+        double Length() const noexcept { return std::sqrt(LengthSquared()); }
+        double LengthSquared() const noexcept { return Dot(*this); }
+
+        double Dot(const Vector3d& v) const noexcept { return x * v.x + y * v.y + z * v.z; }
+        void Cross(const Vector3d& v, Vector3d& result) const noexcept { result = Cross(v); }
+        Vector3d Cross(const Vector3d& v) const noexcept
+        {
+            return Vector3d(y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x);
+        }
+
+        // Zero length gives zero, as with Vector3::Normalize
+        void Normalize() noexcept { Normalize(*this); }
+        void Normalize(Vector3d& result) const noexcept
+        {
+            const double length = Length();
+            result = (length > 0.) ? Vector3d(x / length, y / length, z / length) : Vector3d(0.);
+        }
+
+        void Clamp(const Vector3d& vmin, const Vector3d& vmax) noexcept { Clamp(vmin, vmax, *this); }
+        void Clamp(const Vector3d& vmin, const Vector3d& vmax, Vector3d& result) const noexcept
+        {
+            result = Min(Max(*this, vmin), vmax);
+        }
+
+        // Static functions
+        static double Distance(const Vector3d& v1, const Vector3d& v2) noexcept { return (v2 - v1).Length(); }
+        static double DistanceSquared(const Vector3d& v1, const Vector3d& v2) noexcept { return (v2 - v1).LengthSquared(); }
+
+        static Vector3d Min(const Vector3d& v1, const Vector3d& v2) noexcept
+        {
+            return Vector3d(v1.x < v2.x ? v1.x : v2.x, v1.y < v2.y ? v1.y : v2.y, v1.z < v2.z ? v1.z : v2.z);
+        }
+
+        static Vector3d Max(const Vector3d& v1, const Vector3d& v2) noexcept
+        {
+            return Vector3d(v1.x > v2.x ? v1.x : v2.x, v1.y > v2.y ? v1.y : v2.y, v1.z > v2.z ? v1.z : v2.z);
+        }
+
+        static Vector3d Lerp(const Vector3d& v1, const Vector3d& v2, double t) noexcept { return v1 + (v2 - v1) * t; }
+
+        static Vector3d Transform(const Vector3d& v, const Matrix4d& m) noexcept;
+        static void Transform(const Vector3d& v, const Matrix4d& m, Vector3d& result) noexcept { result = Transform(v, m); }
+
+        static Vector3d TransformNormal(const Vector3d& v, const Matrix4d& m) noexcept;
+        static void TransformNormal(const Vector3d& v, const Matrix4d& m, Vector3d& result) noexcept { result = TransformNormal(v, m); }
+
+        // Constants
+        static const Vector3d Zero;
+        static const Vector3d One;
+        static const Vector3d UnitX;
+        static const Vector3d UnitY;
+        static const Vector3d UnitZ;
+        static const Vector3d Up;
+        static const Vector3d Down;
+        static const Vector3d Right;
+        static const Vector3d Left;
+        static const Vector3d Forward;
+        static const Vector3d Backward;
+
+        // Binary operators
+        friend Vector3d operator+ (const Vector3d& v1, const Vector3d& v2) noexcept { return Vector3d(v1.x + v2.x, v1.y + v2.y, v1.z + v2.z); }
+        friend Vector3d operator- (const Vector3d& v1, const Vector3d& v2) noexcept { return Vector3d(v1.x - v2.x, v1.y - v2.y, v1.z - v2.z); }
+        friend Vector3d operator* (const Vector3d& v1, const Vector3d& v2) noexcept { return Vector3d(v1.x * v2.x, v1.y * v2.y, v1.z * v2.z); }
+        friend Vector3d operator* (const Vector3d& v, double s) noexcept { return Vector3d(v.x * s, v.y * s, v.z * s); }
+        friend Vector3d operator* (double s, const Vector3d& v) noexcept { return Vector3d(v.x * s, v.y * s, v.z * s); }
+        friend Vector3d operator/ (const Vector3d& v1, const Vector3d& v2) noexcept { return Vector3d(v1.x / v2.x, v1.y / v2.y, v1.z / v2.z); }
+        friend Vector3d operator/ (const Vector3d& v, double s) noexcept { return Vector3d(v.x / s, v.y / s, v.z / s); }
+    };
+
+    static_assert(sizeof(Vector3d) == 3 * sizeof(double), "Vector3d arrays are converted as packed doubles");
+
+    inline const Vector3d Vector3d::Zero(0., 0., 0.);
+    inline const Vector3d Vector3d::One(1., 1., 1.);
+    inline const Vector3d Vector3d::UnitX(1., 0., 0.);
+    inline const Vector3d Vector3d::UnitY(0., 1., 0.);
+    inline const Vector3d Vector3d::UnitZ(0., 0., 1.);
+    inline const Vector3d Vector3d::Up(0., 1., 0.);
+    inline const Vector3d Vector3d::Down(0., -1., 0.);
+    inline const Vector3d Vector3d::Right(1., 0., 0.);
+    inline const Vector3d Vector3d::Left(-1., 0., 0.);
+    inline const Vector3d Vector3d::Forward(0., 0., -1.);
+    inline const Vector3d Vector3d::Backward(0., 0., 1.);
+
+    //----------------------------------------------------------------------------------
+    struct Matrix4d
+    {
+        double _11, _12, _13, _14;
+        double _21, _22, _23, _24;
+        double _31, _32, _33, _34;
+        double _41, _42, _43, _44;
+
+        Matrix4d() noexcept :
+            _11(1.), _12(0.), _13(0.), _14(0.),
+            _21(0.), _22(1.), _23(0.), _24(0.),
+            _31(0.), _32(0.), _33(1.), _34(0.),
+            _41(0.), _42(0.), _43(0.), _44(1.)
+        {
+        }
+
+        constexpr Matrix4d(
+            double m00, double m01, double m02, double m03,
+            double m10, double m11, double m12, double m13,
+            double m20, double m21, double m22, double m23,
+            double m30, double m31, double m32, double m33) noexcept :
+            _11(m00), _12(m01), _13(m02), _14(m03),
+            _21(m10), _22(m11), _23(m12), _24(m13),
+            _31(m20), _32(m21), _33(m22), _34(m23),
+            _41(m30), _42(m31), _43(m32), _44(m33)
+        {
+        }
+
+        explicit Matrix4d(const DirectX::XMFLOAT4X4& m) noexcept :
+            _11(m._11), _12(m._12), _13(m._13), _14(m._14),
+            _21(m._21), _22(m._22), _23(m._23), _24(m._24),
+            _31(m._31), _32(m._32), _33(m._33), _34(m._34),
+            _41(m._41), _42(m._42), _43(m._43), _44(m._44)
+        {
+        }
+
+        Matrix4d(const Matrix4d&) = default;
+        Matrix4d& operator=(const Matrix4d&) = default;
+
+        Matrix4d(Matrix4d&&) = default;
+        Matrix4d& operator=(Matrix4d&&) = default;
+
+        // Rounds every element; prefer ToCameraRelative for transforms far from the origin
+        DirectX::SimpleMath::Matrix ToMatrix() const noexcept;
+
+        double operator() (size_t row, size_t column) const noexcept { return (&_11)[row * 4 + column]; }
+        double& operator() (size_t row, size_t column) noexcept { return (&_11)[row * 4 + column]; }
+
+        // Comparison operators
+        bool operator == (const Matrix4d& m) const noexcept;
+        bool operator != (const Matrix4d& m) const noexcept { return !(*this == m); }
+
+        // Assignment operators
+        Matrix4d& operator*= (const Matrix4d& m) noexcept { *this = *this * m; return *this; }
+
+        // Properties
+        Vector3d Translation() const noexcept { return Vector3d(_41, _42, _43); }
+        void Translation(const Vector3d& v) noexcept { _41 = v.x; _42 = v.y; _43 = v.z; }
+
+        // Matrix operations
+        Matrix4d Transpose() const noexcept;
+        void Transpose(Matrix4d& result) const noexcept { result = Transpose(); }
+
+        // Returns all zeros when the determinant is exactly zero
+        Matrix4d Invert() const noexcept;
+        void Invert(Matrix4d& result) const noexcept { result = Invert(); }
+
+        double Determinant() const noexcept;
+
+        // Static functions
+        static Matrix4d CreateTranslation(const Vector3d& position) noexcept;
+        static Matrix4d CreateTranslation(double x, double y, double z) noexcept { return CreateTranslation(Vector3d(x, y, z)); }
+
+        static Matrix4d CreateScale(const Vector3d& scales) noexcept;
+        static Matrix4d CreateScale(double scale) noexcept { return CreateScale(Vector3d(scale)); }
+
+        static Matrix4d CreateFromQuaternion(const DirectX::SimpleMath::Quaternion& quat) noexcept;
+
+        static Matrix4d CreateWorld(const Vector3d& position, const Vector3d& forward, const Vector3d& up) noexcept;
+        static Matrix4d CreateLookAt(const Vector3d& position, const Vector3d& target, const Vector3d& up) noexcept;
+
+        // Constants
+        static const Matrix4d Identity;
+
+        // Binary operators
+        friend Matrix4d operator* (const Matrix4d& m1, const Matrix4d& m2) noexcept;
+    };
+
+    static_assert(sizeof(Matrix4d) == 16 * sizeof(double), "Matrix4d rows are converted as packed doubles");
+
+    inline const Matrix4d Matrix4d::Identity;
+
+    //----------------------------------------------------------------------------------
+    // Camera-relative conversion to float
+
+    // world * CreateTranslation(-camera), rounded to float
+    DirectX::SimpleMath::Matrix ToCameraRelative(const Matrix4d& world, const Vector3d& camera) noexcept;
+    void ToCameraRelative(
+        _In_reads_(count) const Matrix4d* worlds,
+        size_t count,
+        const Vector3d& camera,
+        _Out_writes_(count) DirectX::SimpleMath::Matrix* result) noexcept;
+
+    // position - camera, rounded to float
+    DirectX::SimpleMath::Vector3 ToCameraRelative(const Vector3d& position, const Vector3d& camera) noexcept;
+    void ToCameraRelative(
+        _In_reads_(count) const Vector3d* positions,
+        size_t count,
+        const Vector3d& camera,
+        _Out_writes_(count) DirectX::SimpleMath::Vector3* result) noexcept;
+
+    // CreateTranslation(camera) * view: the view matrix to use with camera-relative worlds.
+    // For a view matrix created at 'camera' this is just its rotation.
+    DirectX::SimpleMath::Matrix CameraRelativeView(const Matrix4d& view, const Vector3d& camera) noexcept;
+
+
+    //==================================================================================
+    // Implementation
+    //==================================================================================
+
+    inline Vector3d Vector3d::Transform(const Vector3d& v, const Matrix4d& m) noexcept
+    {
+        // XMVector3TransformCoord
+        const double w = v.x * m._14 + v.y * m._24 + v.z * m._34 + m._44;
+        return Vector3d(
+            (v.x * m._11 + v.y * m._21 + v.z * m._31 + m._41) / w,
+            (v.x * m._12 + v.y * m._22 + v.z * m._32 + m._42) / w,
+            (v.x * m._13 + v.y * m._23 + v.z * m._33 + m._43) / w);
+    }
+
+    inline Vector3d Vector3d::TransformNormal(const Vector3d& v, const Matrix4d& m) noexcept
+    {
+        return Vector3d(
+            v.x * m._11 + v.y * m._21 + v.z * m._31,
+            v.x * m._12 + v.y * m._22 + v.z * m._32,
+            v.x * m._13 + v.y * m._23 + v.z * m._33);
+    }
+
+    inline DirectX::SimpleMath::Matrix Matrix4d::ToMatrix() const noexcept
+    {
+        DirectX::SimpleMath::Matrix result;
+        ToCameraRelative(this, 1, Vector3d::Zero, &result);
+        return result;
+    }
+
+    inline bool Matrix4d::operator == (const Matrix4d& m) const noexcept
+    {
+        const double* a = &_11;
+        const double* b = &m._11;
+        for (size_t j = 0; j < 16; ++j)
+        {
+            if (a[j] != b[j])
+                return false;
+        }
+        return true;
+    }
+
+    inline Matrix4d operator* (const Matrix4d& m1, const Matrix4d& m2) noexcept
+    {
+        Matrix4d result;
+        for (size_t r = 0; r < 4; ++r)
+        {
+            for (size_t c = 0; c < 4; ++c)
+            {
+                result(r, c) = m1(r, 0) * m2(0, c) + m1(r, 1) * m2(1, c) + m1(r, 2) * m2(2, c) + m1(r, 3) * m2(3, c);
+            }
+        }
+        return result;
+    }
+
+    inline Matrix4d Matrix4d::Transpose() const noexcept
+    {
+        return Matrix4d(
+            _11, _21, _31, _41,
+            _12, _22, _32, _42,
+            _13, _23, _33, _43,
+            _14, _24, _34, _44);
+    }
+
+    inline double Matrix4d::Determinant() const noexcept
+    {
+        // Expansion along the first row using 2x2 minors of the bottom two rows
+        const double s0 = _31 * _42 - _32 * _41;
+        const double s1 = _31 * _43 - _33 * _41;
+        const double s2 = _31 * _44 - _34 * _41;
+        const double s3 = _32 * _43 - _33 * _42;
+        const double s4 = _32 * _44 - _34 * _42;
+        const double s5 = _33 * _44 - _34 * _43;
+
+        return _11 * (_22 * s5 - _23 * s4 + _24 * s3)
+            - _12 * (_21 * s5 - _23 * s2 + _24 * s1)
+            + _13 * (_21 * s4 - _22 * s2 + _24 * s0)
+            - _14 * (_21 * s3 - _22 * s1 + _23 * s0);
+    }
+
+    inline Matrix4d Matrix4d::Invert() const noexcept
+    {
+        // Adjugate from 2x2 minors of the top and bottom row pairs
+        const double a0 = _11 * _22 - _12 * _21;
+        const double a1 = _11 * _23 - _13 * _21;
+        const double a2 = _11 * _24 - _14 * _21;
+        const double a3 = _12 * _23 - _13 * _22;
+        const double a4 = _12 * _24 - _14 * _22;
+        const double a5 = _13 * _24 - _14 * _23;
+        const double b0 = _31 * _42 - _32 * _41;
+        const double b1 = _31 * _43 - _33 * _41;
+        const double b2 = _31 * _44 - _34 * _41;
+        const double b3 = _32 * _43 - _33 * _42;
+        const double b4 = _32 * _44 - _34 * _42;
+        const double b5 = _33 * _44 - _34 * _43;
+
+        const double det = a0 * b5 - a1 * b4 + a2 * b3 + a3 * b2 - a4 * b1 + a5 * b0;
+        if (det == 0.)
+        {
+            return Matrix4d(0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0.);
+        }
+
+        const double inv = 1. / det;
+        return Matrix4d(
+            (_22 * b5 - _23 * b4 + _24 * b3) * inv,
+            (-_12 * b5 + _13 * b4 - _14 * b3) * inv,
+            (_42 * a5 - _43 * a4 + _44 * a3) * inv,
+            (-_32 * a5 + _33 * a4 - _34 * a3) * inv,
+
+            (-_21 * b5 + _23 * b2 - _24 * b1) * inv,
+            (_11 * b5 - _13 * b2 + _14 * b1) * inv,
+            (-_41 * a5 + _43 * a2 - _44 * a1) * inv,
+            (_31 * a5 - _33 * a2 + _34 * a1) * inv,
+
+            (_21 * b4 - _22 * b2 + _24 * b0) * inv,
+            (-_11 * b4 + _12 * b2 - _14 * b0) * inv,
+            (_41 * a4 - _42 * a2 + _44 * a0) * inv,
+            (-_31 * a4 + _32 * a2 - _34 * a0) * inv,
+
+            (-_21 * b3 + _22 * b1 - _23 * b0) * inv,
+            (_11 * b3 - _12 * b1 + _13 * b0) * inv,
+            (-_41 * a3 + _42 * a1 - _43 * a0) * inv,
+            (_31 * a3 - _32 * a1 + _33 * a0) * inv);
+    }
+
+    inline Matrix4d Matrix4d::CreateTranslation(const Vector3d& position) noexcept
+    {
+        Matrix4d result;
+        result.Translation(position);
+        return result;
+    }
+
+    inline Matrix4d Matrix4d::CreateScale(const Vector3d& scales) noexcept
+    {
+        Matrix4d result;
+        result._11 = scales.x;
+        result._22 = scales.y;
+        result._33 = scales.z;
+        return result;
+    }
+
+    inline Matrix4d Matrix4d::CreateFromQuaternion(const DirectX::SimpleMath::Quaternion& quat) noexcept
+    {
+        // XMMatrixRotationQuaternion
+        const double x = quat.x;
+        const double y = quat.y;
+        const double z = quat.z;
+        const double w = quat.w;
+
+        return Matrix4d(
+            1. - 2. * (y * y + z * z), 2. * (x * y + z * w), 2. * (x * z - y * w), 0.,
+            2. * (x * y - z * w), 1. - 2. * (x * x + z * z), 2. * (y * z + x * w), 0.,
+            2. * (x * z + y * w), 2. * (y * z - x * w), 1. - 2. * (x * x + y * y), 0.,
+            0., 0., 0., 1.);
+    }
+
+    inline Matrix4d Matrix4d::CreateWorld(const Vector3d& position, const Vector3d& forward, const Vector3d& up) noexcept
+    {
+        Vector3d zaxis;
+        (-forward).Normalize(zaxis);
+
+        Vector3d xaxis;
+        up.Cross(zaxis).Normalize(xaxis);
+
+        const Vector3d yaxis = zaxis.Cross(xaxis);
+
+        return Matrix4d(
+            xaxis.x, xaxis.y, xaxis.z, 0.,
+            yaxis.x, yaxis.y, yaxis.z, 0.,
+            zaxis.x, zaxis.y, zaxis.z, 0.,
+            position.x, position.y, position.z, 1.);
+    }
+
+    inline Matrix4d Matrix4d::CreateLookAt(const Vector3d& position, const Vector3d& target, const Vector3d& up) noexcept
+    {
+        // XMMatrixLookAtRH
+        Vector3d zaxis;
+        (position - target).Normalize(zaxis);
+
+        Vector3d xaxis;
+        up.Cross(zaxis).Normalize(xaxis);
+
+        const Vector3d yaxis = zaxis.Cross(xaxis);
+
+        return Matrix4d(
+            xaxis.x, yaxis.x, zaxis.x, 0.,
+            xaxis.y, yaxis.y, zaxis.y, 0.,
+            xaxis.z, yaxis.z, zaxis.z, 0.,
+            -xaxis.Dot(position), -yaxis.Dot(position), -zaxis.Dot(position), 1.);
+    }
+
+    //----------------------------------------------------------------------------------
+    inline void ToCameraRelative(
+        const Matrix4d* worlds,
+        size_t count,
+        const Vector3d& camera,
+        DirectX::SimpleMath::Matrix* result) noexcept
+    {
+        // Each row loses its w column times the camera position; for affine worlds that is
+        // just the translation row
+    #if defined(_XM_AVX_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        const __m256d origin = _mm256_set_pd(0., camera.z, camera.y, camera.x);
+        for (size_t j = 0; j < count; ++j)
+        {
+            const double* src = &worlds[j]._11;
+            float* dst = &result[j]._11;
+            for (size_t r = 0; r < 4; ++r)
+            {
+                const __m256d row = _mm256_loadu_pd(src + r * 4);
+                const __m256d rebased = _mm256_sub_pd(row, _mm256_mul_pd(_mm256_set1_pd(src[r * 4 + 3]), origin));
+                _mm_storeu_ps(dst + r * 4, _mm256_cvtpd_ps(rebased));
+            }
+        }
+    #elif defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        const __m128d originXY = _mm_set_pd(camera.y, camera.x);
+        const __m128d originZW = _mm_set_pd(0., camera.z);
+        for (size_t j = 0; j < count; ++j)
+        {
+            const double* src = &worlds[j]._11;
+            float* dst = &result[j]._11;
+            for (size_t r = 0; r < 4; ++r)
+            {
+                const __m128d w = _mm_set1_pd(src[r * 4 + 3]);
+                const __m128d xy = _mm_sub_pd(_mm_loadu_pd(src + r * 4), _mm_mul_pd(w, originXY));
+                const __m128d zw = _mm_sub_pd(_mm_loadu_pd(src + r * 4 + 2), _mm_mul_pd(w, originZW));
+                _mm_storeu_ps(dst + r * 4, _mm_movelh_ps(_mm_cvtpd_ps(xy), _mm_cvtpd_ps(zw)));
+            }
+        }
+    #elif defined(DX_DOUBLE_NEON64)
+        const float64x2_t originXY = { camera.x, camera.y };
+        const float64x2_t originZW = { camera.z, 0. };
+        for (size_t j = 0; j < count; ++j)
+        {
+            const double* src = &worlds[j]._11;
+            float* dst = &result[j]._11;
+            for (size_t r = 0; r < 4; ++r)
+            {
+                const float64x2_t w = vdupq_n_f64(src[r * 4 + 3]);
+                const float64x2_t xy = vsubq_f64(vld1q_f64(src + r * 4), vmulq_f64(w, originXY));
+                const float64x2_t zw = vsubq_f64(vld1q_f64(src + r * 4 + 2), vmulq_f64(w, originZW));
+                vst1q_f32(dst + r * 4, vcombine_f32(vcvt_f32_f64(xy), vcvt_f32_f64(zw)));
+            }
+        }
+    #else
+        const double origin[4] = { camera.x, camera.y, camera.z, 0. };
+        for (size_t j = 0; j < count; ++j)
+        {
+            const double* src = &worlds[j]._11;
+            float* dst = &result[j]._11;
+            for (size_t r = 0; r < 4; ++r)
+            {
+                const double w = src[r * 4 + 3];
+                for (size_t c = 0; c < 4; ++c)
+                {
+                    dst[r * 4 + c] = static_cast<float>(src[r * 4 + c] - w * origin[c]);
+                }
+            }
+        }
+    #endif
+    }
+
+    inline DirectX::SimpleMath::Matrix ToCameraRelative(const Matrix4d& world, const Vector3d& camera) noexcept
+    {
+        DirectX::SimpleMath::Matrix result;
+        ToCameraRelative(&world, 1, camera, &result);
+        return result;
+    }
+
+    inline void ToCameraRelative(
+        const Vector3d* positions,
+        size_t count,
+        const Vector3d& camera,
+        DirectX::SimpleMath::Vector3* result) noexcept
+    {
+        size_t j = 0;
+
+        // Four points are 12 packed doubles in, 12 packed floats out, so the conversion runs
+        // straight through without shuffles; only the camera offsets rotate
+    #if defined(_XM_AVX_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        const __m256d o0 = _mm256_set_pd(camera.x, camera.z, camera.y, camera.x);
+        const __m256d o1 = _mm256_set_pd(camera.y, camera.x, camera.z, camera.y);
+        const __m256d o2 = _mm256_set_pd(camera.z, camera.y, camera.x, camera.z);
+        for (; j + 4 <= count; j += 4)
+        {
+            const double* s = &positions[j].x;
+            float* d = &result[j].x;
+            _mm_storeu_ps(d, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(s), o0)));
+            _mm_storeu_ps(d + 4, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(s + 4), o1)));
+            _mm_storeu_ps(d + 8, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(s + 8), o2)));
+        }
+    #elif defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        const __m128d o0 = _mm_set_pd(camera.y, camera.x);
+        const __m128d o1 = _mm_set_pd(camera.x, camera.z);
+        const __m128d o2 = _mm_set_pd(camera.z, camera.y);
+        for (; j + 4 <= count; j += 4)
+        {
+            const double* s = &positions[j].x;
+            float* d = &result[j].x;
+            const __m128 f0 = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(s), o0));
+            const __m128 f1 = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(s + 2), o1));
+            const __m128 f2 = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(s + 4), o2));
+            const __m128 f3 = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(s + 6), o0));
+            const __m128 f4 = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(s + 8), o1));
+            const __m128 f5 = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(s + 10), o2));
+            _mm_storeu_ps(d, _mm_movelh_ps(f0, f1));
+            _mm_storeu_ps(d + 4, _mm_movelh_ps(f2, f3));
+            _mm_storeu_ps(d + 8, _mm_movelh_ps(f4, f5));
+        }
+    #elif defined(DX_DOUBLE_NEON64)
+        const float64x2_t o0 = { camera.x, camera.y };
+        const float64x2_t o1 = { camera.z, camera.x };
+        const float64x2_t o2 = { camera.y, camera.z };
+        for (; j + 4 <= count; j += 4)
+        {
+            const double* s = &positions[j].x;
+            float* d = &result[j].x;
+            vst1q_f32(d, vcombine_f32(vcvt_f32_f64(vsubq_f64(vld1q_f64(s), o0)), vcvt_f32_f64(vsubq_f64(vld1q_f64(s + 2), o1))));
+            vst1q_f32(d + 4, vcombine_f32(vcvt_f32_f64(vsubq_f64(vld1q_f64(s + 4), o2)), vcvt_f32_f64(vsubq_f64(vld1q_f64(s + 6), o0))));
+            vst1q_f32(d + 8, vcombine_f32(vcvt_f32_f64(vsubq_f64(vld1q_f64(s + 8), o1)), vcvt_f32_f64(vsubq_f64(vld1q_f64(s + 10), o2))));
+        }
+    #endif
+
+        for (; j < count; ++j)
+        {
+            result[j] = (positions[j] - camera).ToVector3();
+        }
+    }
+
+    inline DirectX::SimpleMath::Vector3 ToCameraRelative(const Vector3d& position, const Vector3d& camera) noexcept
+    {
+        return (position - camera).ToVector3();
+    }
+
+    inline DirectX::SimpleMath::Matrix CameraRelativeView(const Matrix4d& view, const Vector3d& camera) noexcept
+    {
+        return (Matrix4d::CreateTranslation(camera) * view).ToMatrix();
+    }
+}
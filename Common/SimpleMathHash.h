@@ -0,0 +1,620 @@
+//--------------------------------------------------------------------------------------
+// File: SimpleMathHash.h
+//
+// std::hash support for SimpleMath types, and a spatial hash grid over Vector3 positions
+//
+// The std::hash specializations hash the bit patterns of the components (with -0 and +0
+// hashing alike, since they compare equal), so SimpleMath types work directly as keys
+// in std::unordered_map / std::unordered_set alongside the std::less support in
+// SimpleMath.h.
+//
+// QuantizedHash / QuantizedEqualTo instead snap each component to a grid of the given
+// cell size, so keys that round to the same cell are treated as one. Values that
+// straddle a cell boundary still land in different buckets; use SpatialHashGrid when
+// "within a tolerance" has to be exact.
+//
+// SpatialHashGrid buckets positions by cell in an open-addressed table of 16-byte slots,
+// with the positions of each cell chained through a flat array (contiguous per cell after
+// Build). Query() and Nearest() find every position within a radius, and FindOrInsert()
+// and WeldPositions() merge positions that lie within a tolerance of each other.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SimpleMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace DX
+{
+    namespace HashDetail
+    {
+        constexpr uint64_t c_Multiplier = 0x9E3779B97F4A7C15ull;
+
+        // MurmurHash3 finalizer
+        inline uint64_t Finalize(uint64_t h) noexcept
+        {
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 33;
+            h *= 0xC4CEB9FE1A85EC53ull;
+            h ^= h >> 33;
+            return h;
+        }
+
+        inline uint64_t Combine(uint64_t h, uint64_t value) noexcept
+        {
+            h = (h ^ value) * c_Multiplier;
+            return h ^ (h >> 32);
+        }
+
+        // -0 and +0 compare equal, so they have to hash alike
+        inline uint32_t FloatBits(float value) noexcept
+        {
+            uint32_t bits = 0;
+            if (value != 0.f)
+            {
+                memcpy(&bits, &value, sizeof(bits));
+            }
+            return bits;
+        }
+
+        inline uint64_t HashFloats(_In_reads_(count) const float* values, size_t count) noexcept
+        {
+            uint64_t h = count;
+            size_t j = 0;
+            for (; j + 2 <= count; j += 2)
+            {
+                h = Combine(h, uint64_t(FloatBits(values[j])) | (uint64_t(FloatBits(values[j + 1])) << 32));
+            }
+            if (j < count)
+            {
+                h = Combine(h, FloatBits(values[j]));
+            }
+            return Finalize(h);
+        }
+
+        // Snapped values are clamped well inside int64; NaN snaps to 0
+        inline int64_t Quantize(float value, float invCellSize) noexcept
+        {
+            constexpr float c_Limit = 4.0e18f;
+            const float q = std::floor(value * invCellSize);
+            if (q >= c_Limit)
+                return static_cast<int64_t>(c_Limit);
+            if (q <= -c_Limit)
+                return -static_cast<int64_t>(c_Limit);
+            return (q == q) ? static_cast<int64_t>(q) : 0;
+        }
+
+        // Component access for the float-only SimpleMath types
+        inline const float* Floats(const DirectX::XMFLOAT2& v) noexcept { return &v.x; }
+        inline const float* Floats(const DirectX::XMFLOAT3& v) noexcept { return &v.x; }
+        inline const float* Floats(const DirectX::XMFLOAT4& v) noexcept { return &v.x; }
+        inline const float* Floats(const DirectX::XMFLOAT4X4& m) noexcept { return &m._11; }
+
+        template<typename T>
+        constexpr size_t FloatCount() noexcept
+        {
+            static_assert(sizeof(T) % sizeof(float) == 0, "Type must be made of floats");
+            return sizeof(T) / sizeof(float);
+        }
+    }
+
+    //----------------------------------------------------------------------------------
+    // Tolerance-quantized hashing for Vector2/3/4, Quaternion, Plane, Color and Matrix keys
+    template<typename T>
+    struct QuantizedHash
+    {
+        float invCellSize;
+
+        explicit QuantizedHash(float cellSize = 1.f) noexcept : invCellSize(1.f / cellSize) {}
+
+        size_t operator()(const T& value) const noexcept
+        {
+            const float* f = HashDetail::Floats(value);
+            uint64_t h = HashDetail::FloatCount<T>();
+            for (size_t j = 0; j < HashDetail::FloatCount<T>(); ++j)
+            {
+                h = HashDetail::Combine(h, static_cast<uint64_t>(HashDetail::Quantize(f[j], invCellSize)));
+            }
+            return static_cast<size_t>(HashDetail::Finalize(h));
+        }
+    };
+
+    template<typename T>
+    struct QuantizedEqualTo
+    {
+        float invCellSize;
+
+        explicit QuantizedEqualTo(float cellSize = 1.f) noexcept : invCellSize(1.f / cellSize) {}
+
+        bool operator()(const T& a, const T& b) const noexcept
+        {
+            const float* fa = HashDetail::Floats(a);
+            const float* fb = HashDetail::Floats(b);
+            for (size_t j = 0; j < HashDetail::FloatCount<T>(); ++j)
+            {
+                if (HashDetail::Quantize(fa[j], invCellSize) != HashDetail::Quantize(fb[j], invCellSize))
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    //----------------------------------------------------------------------------------
+    class SpatialHashGrid
+    {
+    public:
+        struct Cell
+        {
+            int32_t x;
+            int32_t y;
+            int32_t z;
+        };
+
+        static constexpr uint32_t c_Empty = UINT32_MAX;
+
+        SpatialHashGrid() noexcept :
+            m_cellCount(0),
+            m_cellSize(1.f),
+            m_invCellSize(1.f)
+        {
+        }
+
+        // Query cost is lowest when the cell size is close to the usual query radius
+        explicit SpatialHashGrid(float cellSize, size_t capacity = 0);
+
+        SpatialHashGrid(SpatialHashGrid&&) = default;
+        SpatialHashGrid& operator= (SpatialHashGrid&&) = default;
+
+        SpatialHashGrid(SpatialHashGrid const&) = default;
+        SpatialHashGrid& operator= (SpatialHashGrid const&) = default;
+
+        // Replaces the contents; the index of each position is its place in the array
+        void Build(_In_reads_(count) const DirectX::SimpleMath::Vector3* positions, size_t count);
+
+        // Returns the index of the new position (the number inserted before it)
+        uint32_t Insert(const DirectX::SimpleMath::Vector3& position);
+
+        // The nearest existing position within 'tolerance' (lowest index on ties), or a new one
+        std::pair<uint32_t, bool> FindOrInsert(const DirectX::SimpleMath::Vector3& position, float tolerance);
+
+        void Reserve(size_t count);
+        void Clear() noexcept;
+
+        size_t Size() const noexcept { return m_items.size(); }
+        size_t CellCount() const noexcept { return m_cellCount; }
+        float CellSize() const noexcept { return m_cellSize; }
+
+        Cell GetCell(const DirectX::SimpleMath::Vector3& position) const noexcept
+        {
+            return Cell{ Snap(position.x), Snap(position.y), Snap(position.z) };
+        }
+
+        // Calls 'callback(index, distanceSquared)' for every position within 'radius' of 'center'
+        template<typename TCallback>
+        void Query(const DirectX::SimpleMath::Vector3& center, float radius, TCallback&& callback) const;
+
+        // Nearest position within 'radius' (lowest index on ties)
+        bool Nearest(const DirectX::SimpleMath::Vector3& center, float radius, uint32_t& index, float& distanceSquared) const;
+
+    private:
+        struct Slot
+        {
+            Cell        cell;
+            uint32_t    head;   // First item of the cell, or c_Empty for an unused slot
+        };
+
+        static_assert(sizeof(Slot) == 16, "Slot should be 16 bytes");
+
+        struct Item
+        {
+            DirectX::XMFLOAT3   position;
+            uint32_t            next;   // Next item in the same cell, or c_Empty
+        };
+
+        std::vector<Slot>       m_slots;    // Power of two, at most half full
+        std::vector<Item>       m_items;
+        std::vector<uint32_t>   m_indices;  // Index of each item, as returned by Insert
+        size_t                  m_cellCount;
+        float                   m_cellSize;
+        float                   m_invCellSize;
+
+        // Cells are clamped so that query ranges cannot overflow
+        int32_t Snap(float value) const noexcept
+        {
+            constexpr int64_t c_Limit = 1 << 30;
+            return static_cast<int32_t>(std::max(-c_Limit, std::min(HashDetail::Quantize(value, m_invCellSize), c_Limit)));
+        }
+
+        static uint64_t HashCell(const Cell& cell) noexcept
+        {
+            const uint64_t xy = uint64_t(uint32_t(cell.x)) | (uint64_t(uint32_t(cell.y)) << 32);
+            return HashDetail::Finalize(HashDetail::Combine(xy, uint32_t(cell.z)));
+        }
+
+        // The slot holding 'cell', or the empty slot where it belongs
+        size_t FindSlot(const Cell& cell) const noexcept
+        {
+            const size_t mask = m_slots.size() - 1;
+            size_t s = static_cast<size_t>(HashCell(cell)) & mask;
+            for (;;)
+            {
+                const Slot& slot = m_slots[s];
+                if (slot.head == c_Empty
+                    || (slot.cell.x == cell.x && slot.cell.y == cell.y && slot.cell.z == cell.z))
+                    return s;
+                s = (s + 1) & mask;
+            }
+        }
+
+        // Finds or claims the slot for 'cell', growing the table as needed
+        size_t AddCell(const Cell& cell, uint32_t initialHead);
+        void Rehash(size_t slotCount);
+
+        template<typename TCallback>
+        void VisitCell(const Slot& slot, const DirectX::SimpleMath::Vector3& center, float radiusSquared, TCallback& callback) const;
+    };
+
+    // Merges positions within 'tolerance' of an earlier kept position. 'remap[j]' is the
+    // kept index for position j, 'unique' (if given) receives the kept positions in order,
+    // and the return value is the number kept. A tolerance of 0 merges exact duplicates.
+    size_t WeldPositions(
+        _In_reads_(count) const DirectX::SimpleMath::Vector3* positions,
+        size_t count,
+        float tolerance,
+        _Out_writes_(count) uint32_t* remap,
+        _Out_writes_opt_(count) DirectX::SimpleMath::Vector3* unique = nullptr);
+
+
+    //==================================================================================
+    // Implementation
+    //==================================================================================
+
+    inline SpatialHashGrid::SpatialHashGrid(float cellSize, size_t capacity) :
+        m_cellCount(0),
+        m_cellSize(cellSize),
+        m_invCellSize(1.f / cellSize)
+    {
+        if (!(cellSize > 0.f) || !std::isfinite(cellSize) || !std::isfinite(m_invCellSize))
+            throw std::invalid_argument("Cell size must be positive and finite");
+
+        Reserve(capacity);
+    }
+
+    inline void SpatialHashGrid::Reserve(size_t count)
+    {
+        m_items.reserve(count);
+        m_indices.reserve(count);
+    }
+
+    inline void SpatialHashGrid::Clear() noexcept
+    {
+        for (auto& slot : m_slots)
+        {
+            slot.head = c_Empty;
+        }
+        m_items.clear();
+        m_indices.clear();
+        m_cellCount = 0;
+    }
+
+    inline void SpatialHashGrid::Rehash(size_t slotCount)
+    {
+        std::vector<Slot> old(slotCount, Slot{ Cell{ 0, 0, 0 }, c_Empty });
+        std::swap(old, m_slots);
+
+        for (const auto& slot : old)
+        {
+            if (slot.head != c_Empty)
+            {
+                m_slots[FindSlot(slot.cell)] = slot;
+            }
+        }
+    }
+
+    inline size_t SpatialHashGrid::AddCell(const Cell& cell, uint32_t initialHead)
+    {
+        if ((m_cellCount + 1) * 2 > m_slots.size())
+        {
+            Rehash(std::max<size_t>(m_slots.size() * 2, 16));
+        }
+
+        const size_t s = FindSlot(cell);
+        if (m_slots[s].head == c_Empty)
+        {
+            m_slots[s] = Slot{ cell, initialHead };
+            ++m_cellCount;
+        }
+        return s;
+    }
+
+    inline void SpatialHashGrid::Build(const DirectX::SimpleMath::Vector3* positions, size_t count)
+    {
+        if (count > 0 && !positions)
+            throw std::invalid_argument("Invalid positions");
+
+        if (count >= c_Empty)
+            throw std::out_of_range("Too many positions");
+
+        Clear();
+        Reserve(count);
+
+        // Count the positions in each cell (the head holds the count for now)...
+        for (size_t j = 0; j < count; ++j)
+        {
+            const size_t s = AddCell(GetCell(positions[j]), 0);
+            ++m_slots[s].head;
+        }
+
+        // ...turn the counts into the first item of each cell...
+        std::vector<uint32_t> cursor(m_slots.size(), c_Empty);
+        uint32_t first = 0;
+        for (size_t s = 0; s < m_slots.size(); ++s)
+        {
+            if (m_slots[s].head != c_Empty)
+            {
+                const uint32_t cellCount = m_slots[s].head;
+                m_slots[s].head = cursor[s] = first;
+                first += cellCount;
+            }
+        }
+
+        // ...and store each cell's positions contiguously
+        m_items.resize(count);
+        m_indices.resize(count);
+        for (size_t j = 0; j < count; ++j)
+        {
+            const size_t s = FindSlot(GetCell(positions[j]));
+            const uint32_t pos = cursor[s]++;
+            m_items[pos] = Item{ positions[j], pos + 1 };
+            m_indices[pos] = static_cast<uint32_t>(j);
+        }
+
+        for (size_t s = 0; s < m_slots.size(); ++s)
+        {
+            if (m_slots[s].head != c_Empty)
+            {
+                m_items[cursor[s] - 1].next = c_Empty;
+            }
+        }
+    }
+
+    inline uint32_t SpatialHashGrid::Insert(const DirectX::SimpleMath::Vector3& position)
+    {
+        if (m_items.size() >= c_Empty)
+            throw std::out_of_range("Too many positions");
+
+        const auto item = static_cast<uint32_t>(m_items.size());
+        const size_t cells = m_cellCount;
+        Slot& slot = m_slots[AddCell(GetCell(position), item)];
+
+        // New items go to the front of their cell's list
+        m_items.push_back(Item{ position, (m_cellCount != cells) ? c_Empty : slot.head });
+        slot.head = item;
+
+        const auto index = static_cast<uint32_t>(m_indices.size());
+        m_indices.push_back(index);
+        return index;
+    }
+
+    inline std::pair<uint32_t, bool> SpatialHashGrid::FindOrInsert(const DirectX::SimpleMath::Vector3& position, float tolerance)
+    {
+        uint32_t index;
+        float distanceSquared;
+        if (Nearest(position, tolerance, index, distanceSquared))
+            return std::make_pair(index, false);
+
+        return std::make_pair(Insert(position), true);
+    }
+
+    template<typename TCallback>
+    inline void SpatialHashGrid::VisitCell(const Slot& slot, const DirectX::SimpleMath::Vector3& center, float radiusSquared, TCallback& callback) const
+    {
+        for (uint32_t i = slot.head; i != c_Empty; i = m_items[i].next)
+        {
+            const auto& p = m_items[i].position;
+            const float dx = p.x - center.x;
+            const float dy = p.y - center.y;
+            const float dz = p.z - center.z;
+            const float d = dx * dx + dy * dy + dz * dz;
+            if (d <= radiusSquared)
+            {
+                callback(m_indices[i], d);
+            }
+        }
+    }
+
+    template<typename TCallback>
+    inline void SpatialHashGrid::Query(const DirectX::SimpleMath::Vector3& center, float radius, TCallback&& callback) const
+    {
+        if (m_cellCount == 0 || !(radius >= 0.f))
+            return;
+
+        const float radiusSquared = radius * radius;
+        const Cell lo = GetCell(DirectX::SimpleMath::Vector3(center.x - radius, center.y - radius, center.z - radius));
+        const Cell hi = GetCell(DirectX::SimpleMath::Vector3(center.x + radius, center.y + radius, center.z + radius));
+
+        // A radius much larger than the cells covers more cells than are in use, in which
+        // case walking the occupied slots is cheaper
+        const double range = double(int64_t(hi.x) - lo.x + 1) * double(int64_t(hi.y) - lo.y + 1) * double(int64_t(hi.z) - lo.z + 1);
+        if (range > double(m_slots.size()))
+        {
+            for (const auto& slot : m_slots)
+            {
+                if (slot.head != c_Empty
+                    && slot.cell.x >= lo.x && slot.cell.x <= hi.x
+                    && slot.cell.y >= lo.y && slot.cell.y <= hi.y
+                    && slot.cell.z >= lo.z && slot.cell.z <= hi.z)
+                {
+                    VisitCell(slot, center, radiusSquared, callback);
+                }
+            }
+            return;
+        }
+
+        for (int32_t z = lo.z; z <= hi.z; ++z)
+        {
+            for (int32_t y = lo.y; y <= hi.y; ++y)
+            {
+                for (int32_t x = lo.x; x <= hi.x; ++x)
+                {
+                    const Slot& slot = m_slots[FindSlot(Cell{ x, y, z })];
+                    if (slot.head != c_Empty)
+                    {
+                        VisitCell(slot, center, radiusSquared, callback);
+                    }
+                }
+            }
+        }
+    }
+
+    inline bool SpatialHashGrid::Nearest(const DirectX::SimpleMath::Vector3& center, float radius, uint32_t& index, float& distanceSquared) const
+    {
+        index = c_Empty;
+        distanceSquared = 0.f;
+
+        Query(center, radius, [&](uint32_t i, float d)
+            {
+                if (index == c_Empty || d < distanceSquared || (d == distanceSquared && i < index))
+                {
+                    index = i;
+                    distanceSquared = d;
+                }
+            });
+
+        return index != c_Empty;
+    }
+
+    //----------------------------------------------------------------------------------
+    inline size_t WeldPositions(
+        const DirectX::SimpleMath::Vector3* positions,
+        size_t count,
+        float tolerance,
+        uint32_t* remap,
+        DirectX::SimpleMath::Vector3* unique)
+    {
+        if (count > 0 && (!positions || !remap))
+            throw std::invalid_argument("Invalid arguments");
+
+        if (!(tolerance >= 0.f) || !std::isfinite(tolerance))
+            throw std::invalid_argument("Tolerance must be non-negative and finite");
+
+        SpatialHashGrid grid((tolerance > 0.f) ? tolerance : 1.f, count);
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            const auto result = grid.FindOrInsert(positions[j], tolerance);
+            remap[j] = result.first;
+            if (result.second && unique)
+            {
+                unique[result.first] = positions[j];
+            }
+        }
+
+        return grid.Size();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Support for SimpleMath types as keys in unordered containers
+namespace std
+{
+    template<> struct hash<DirectX::SimpleMath::Rectangle>
+    {
+        size_t operator()(const DirectX::SimpleMath::Rectangle& r) const noexcept
+        {
+            uint64_t h = DX::HashDetail::Combine(4, uint64_t(uint32_t(r.x)) | (uint64_t(uint32_t(r.y)) << 32));
+            h = DX::HashDetail::Combine(h, uint64_t(uint32_t(r.width)) | (uint64_t(uint32_t(r.height)) << 32));
+            return static_cast<size_t>(DX::HashDetail::Finalize(h));
+        }
+    };
+
+    template<> struct hash<DirectX::SimpleMath::Vector2>
+    {
+        size_t operator()(const DirectX::SimpleMath::Vector2& v) const noexcept
+        {
+            return static_cast<size_t>(DX::HashDetail::HashFloats(&v.x, 2));
+        }
+    };
+
+    template<> struct hash<DirectX::SimpleMath::Vector3>
+    {
+        size_t operator()(const DirectX::SimpleMath::Vector3& v) const noexcept
+        {
+            return static_cast<size_t>(DX::HashDetail::HashFloats(&v.x, 3));
+        }
+    };
+
+    template<> struct hash<DirectX::SimpleMath::Vector4>
+    {
+        size_t operator()(const DirectX::SimpleMath::Vector4& v) const noexcept
+        {
+            return static_cast<size_t>(DX::HashDetail::HashFloats(&v.x, 4));
+        }
+    };
+
+    template<> struct hash<DirectX::SimpleMath::Matrix>
+    {
+        size_t operator()(const DirectX::SimpleMath::Matrix& m) const noexcept
+        {
+            return static_cast<size_t>(DX::HashDetail::HashFloats(&m._11, 16));
+        }
+    };
+
+    template<> struct hash<DirectX::SimpleMath::Plane>
+    {
+        size_t operator()(const DirectX::SimpleMath::Plane& p) const noexcept
+        {
+            return static_cast<size_t>(DX::HashDetail::HashFloats(&p.x, 4));
+        }
+    };
+
+    template<> struct hash<DirectX::SimpleMath::Quaternion>
+    {
+        size_t operator()(const DirectX::SimpleMath::Quaternion& q) const noexcept
+        {
+            return static_cast<size_t>(DX::HashDetail::HashFloats(&q.x, 4));
+        }
+    };
+
+    template<> struct hash<DirectX::SimpleMath::Color>
+    {
+        size_t operator()(const DirectX::SimpleMath::Color& c) const noexcept
+        {
+            return static_cast<size_t>(DX::HashDetail::HashFloats(&c.x, 4));
+        }
+    };
+
+    template<> struct hash<DirectX::SimpleMath::Ray>
+    {
+        size_t operator()(const DirectX::SimpleMath::Ray& r) const noexcept
+        {
+            const float values[6] = { r.position.x, r.position.y, r.position.z, r.direction.x, r.direction.y, r.direction.z };
+            return static_cast<size_t>(DX::HashDetail::HashFloats(values, 6));
+        }
+    };
+
+    template<> struct hash<DirectX::SimpleMath::Viewport>
+    {
+        size_t operator()(const DirectX::SimpleMath::Viewport& vp) const noexcept
+        {
+            const float values[6] = { vp.x, vp.y, vp.width, vp.height, vp.minDepth, vp.maxDepth };
+            return static_cast<size_t>(DX::HashDetail::HashFloats(values, 6));
+        }
+    };
+}
@@ -0,0 +1,905 @@
+//--------------------------------------------------------------------------------------
+// File: SoAMath.h
+//
+// Structure-of-arrays companions to the SimpleMath Vector3 and Quaternion value types
+//
+// Vector3Stream and QuaternionStream keep each component in its own array, so the batch
+// kernels below process one component of several elements per SIMD register instead of
+// shuffling xyz(w) lanes. Kernels run 8 elements at a time when DirectXMath is built for
+// AVX (/arch:AVX, /arch:AVX2, -mavx), and 4 at a time with XMVECTOR otherwise, including
+// ARM-NEON and _XM_NO_INTRINSICS_ builds. Results match the equivalent SimpleMath calls
+// within floating-point rounding.
+//
+// Streams are padded to a multiple of 8 elements so kernels never need a scalar tail;
+// the padding elements are scratch space and are not part of the stream's contents.
+// Kernels may be run in place (the output stream may also be an input).
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SimpleMath.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(_XM_AVX_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+#include <immintrin.h>
+#define DX_SOA_AVX
+#endif
+
+
+namespace DX
+{
+    namespace SoADetail
+    {
+        // Lane operations used by the kernels, so each kernel is written once for both widths
+        struct Lanes4
+        {
+            using V = DirectX::XMVECTOR;
+            static constexpr size_t Width = 4;
+
+            static V XM_CALLCONV Load(_In_reads_(4) const float* ptr) noexcept { return DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(ptr)); }
+            static void XM_CALLCONV Store(_Out_writes_(4) float* ptr, V v) noexcept { DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(ptr), v); }
+            static V XM_CALLCONV Splat(float value) noexcept { return DirectX::XMVectorReplicate(value); }
+            static V XM_CALLCONV Zero() noexcept { return DirectX::XMVectorZero(); }
+
+            static V XM_CALLCONV Add(V a, V b) noexcept { return DirectX::XMVectorAdd(a, b); }
+            static V XM_CALLCONV Subtract(V a, V b) noexcept { return DirectX::XMVectorSubtract(a, b); }
+            static V XM_CALLCONV Multiply(V a, V b) noexcept { return DirectX::XMVectorMultiply(a, b); }
+            static V XM_CALLCONV MultiplyAdd(V a, V b, V c) noexcept { return DirectX::XMVectorMultiplyAdd(a, b, c); }
+            static V XM_CALLCONV Divide(V a, V b) noexcept { return DirectX::XMVectorDivide(a, b); }
+            static V XM_CALLCONV Sqrt(V a) noexcept { return DirectX::XMVectorSqrt(a); }
+            static V XM_CALLCONV Min(V a, V b) noexcept { return DirectX::XMVectorMin(a, b); }
+            static V XM_CALLCONV Max(V a, V b) noexcept { return DirectX::XMVectorMax(a, b); }
+            static V XM_CALLCONV Abs(V a) noexcept { return DirectX::XMVectorAbs(a); }
+
+            static V XM_CALLCONV Less(V a, V b) noexcept { return DirectX::XMVectorLess(a, b); }
+            static V XM_CALLCONV LessOrEqual(V a, V b) noexcept { return DirectX::XMVectorLessOrEqual(a, b); }
+            static V XM_CALLCONV Greater(V a, V b) noexcept { return DirectX::XMVectorGreater(a, b); }
+            static V XM_CALLCONV GreaterOrEqual(V a, V b) noexcept { return DirectX::XMVectorGreaterOrEqual(a, b); }
+            static V XM_CALLCONV And(V a, V b) noexcept { return DirectX::XMVectorAndInt(a, b); }
+            static V XM_CALLCONV Or(V a, V b) noexcept { return DirectX::XMVectorOrInt(a, b); }
+            static V XM_CALLCONV AndNot(V a, V b) noexcept { return DirectX::XMVectorAndCInt(a, b); }
+            static V XM_CALLCONV Select(V a, V b, V control) noexcept { return DirectX::XMVectorSelect(a, b, control); }
+
+            // One bit per lane of a comparison result, lane 0 in bit 0
+            static uint32_t XM_CALLCONV Mask(V a) noexcept
+            {
+            #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+                return static_cast<uint32_t>(_mm_movemask_ps(a));
+            #else
+                DirectX::XMUINT4 bits;
+                DirectX::XMStoreUInt4(&bits, a);
+                return (bits.x >> 31) | ((bits.y >> 31) << 1) | ((bits.z >> 31) << 2) | ((bits.w >> 31) << 3);
+            #endif
+            }
+
+            static V XM_CALLCONV Sin(V a) noexcept { return DirectX::XMVectorSin(a); }
+            static V XM_CALLCONV ATan2(V y, V x) noexcept { return DirectX::XMVectorATan2(y, x); }
+            static V XM_CALLCONV Log2(V a) noexcept { return DirectX::XMVectorLog2(a); }
+            static V XM_CALLCONV Exp2(V a) noexcept { return DirectX::XMVectorExp2(a); }
+        };
+
+    #ifdef DX_SOA_AVX
+        struct Lanes8
+        {
+            using V = __m256;
+            static constexpr size_t Width = 8;
+
+            static V XM_CALLCONV Load(_In_reads_(8) const float* ptr) noexcept { return _mm256_loadu_ps(ptr); }
+            static void XM_CALLCONV Store(_Out_writes_(8) float* ptr, V v) noexcept { _mm256_storeu_ps(ptr, v); }
+            static V XM_CALLCONV Splat(float value) noexcept { return _mm256_set1_ps(value); }
+            static V XM_CALLCONV Zero() noexcept { return _mm256_setzero_ps(); }
+
+            static V XM_CALLCONV Add(V a, V b) noexcept { return _mm256_add_ps(a, b); }
+            static V XM_CALLCONV Subtract(V a, V b) noexcept { return _mm256_sub_ps(a, b); }
+            static V XM_CALLCONV Multiply(V a, V b) noexcept { return _mm256_mul_ps(a, b); }
+            static V XM_CALLCONV Divide(V a, V b) noexcept { return _mm256_div_ps(a, b); }
+            static V XM_CALLCONV Sqrt(V a) noexcept { return _mm256_sqrt_ps(a); }
+            static V XM_CALLCONV Min(V a, V b) noexcept { return _mm256_min_ps(a, b); }
+            static V XM_CALLCONV Max(V a, V b) noexcept { return _mm256_max_ps(a, b); }
+            static V XM_CALLCONV Abs(V a) noexcept { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+
+            static V XM_CALLCONV MultiplyAdd(V a, V b, V c) noexcept
+            {
+            #ifdef _XM_FMA3_INTRINSICS_
+                return _mm256_fmadd_ps(a, b, c);
+            #else
+                return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+            #endif
+            }
+
+            static V XM_CALLCONV Less(V a, V b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+            static V XM_CALLCONV LessOrEqual(V a, V b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+            static V XM_CALLCONV Greater(V a, V b) noexcept { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+            static V XM_CALLCONV GreaterOrEqual(V a, V b) noexcept { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+            static V XM_CALLCONV And(V a, V b) noexcept { return _mm256_and_ps(a, b); }
+            static V XM_CALLCONV Or(V a, V b) noexcept { return _mm256_or_ps(a, b); }
+            static V XM_CALLCONV AndNot(V a, V b) noexcept { return _mm256_andnot_ps(b, a); }
+            static V XM_CALLCONV Select(V a, V b, V control) noexcept { return _mm256_blendv_ps(a, b, control); }
+
+            static uint32_t XM_CALLCONV Mask(V a) noexcept { return static_cast<uint32_t>(_mm256_movemask_ps(a)); }
+
+            // Transcendentals reuse the DirectXMath approximations on each half
+            static V XM_CALLCONV Sin(V a) noexcept
+            {
+                const DirectX::XMVECTOR lo = DirectX::XMVectorSin(_mm256_castps256_ps128(a));
+                const DirectX::XMVECTOR hi = DirectX::XMVectorSin(_mm256_extractf128_ps(a, 1));
+                return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+            }
+
+            static V XM_CALLCONV ATan2(V y, V x) noexcept
+            {
+                const DirectX::XMVECTOR lo = DirectX::XMVectorATan2(_mm256_castps256_ps128(y), _mm256_castps256_ps128(x));
+                const DirectX::XMVECTOR hi = DirectX::XMVectorATan2(_mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(x, 1));
+                return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+            }
+
+            static V XM_CALLCONV Log2(V a) noexcept
+            {
+                const DirectX::XMVECTOR lo = DirectX::XMVectorLog2(_mm256_castps256_ps128(a));
+                const DirectX::XMVECTOR hi = DirectX::XMVectorLog2(_mm256_extractf128_ps(a, 1));
+                return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+            }
+
+            static V XM_CALLCONV Exp2(V a) noexcept
+            {
+                const DirectX::XMVECTOR lo = DirectX::XMVectorExp2(_mm256_castps256_ps128(a));
+                const DirectX::XMVECTOR hi = DirectX::XMVectorExp2(_mm256_extractf128_ps(a, 1));
+                return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+            }
+        };
+
+        using Lanes = Lanes8;
+    #else
+        using Lanes = Lanes4;
+    #endif
+
+        // Every stream is padded to this many elements, whichever width the kernels use
+        constexpr size_t c_Padding = 8;
+
+        inline size_t PaddedSize(size_t count) noexcept
+        {
+            return (count + c_Padding - 1) & ~(c_Padding - 1);
+        }
+    }
+
+    // Elements processed per kernel iteration in this build (4 or 8)
+    constexpr size_t c_SoAWidth = SoADetail::Lanes::Width;
+
+    class QuaternionStream;
+
+    //----------------------------------------------------------------------------------
+    class Vector3Stream
+    {
+    public:
+        Vector3Stream() noexcept : m_size(0) {}
+
+        explicit Vector3Stream(size_t count) : m_size(0) { Resize(count); }
+
+        Vector3Stream(_In_reads_(count) const DirectX::SimpleMath::Vector3* values, size_t count) : m_size(0) { Load(values, count); }
+
+        Vector3Stream(Vector3Stream&&) = default;
+        Vector3Stream& operator= (Vector3Stream&&) = default;
+
+        Vector3Stream(Vector3Stream const&) = default;
+        Vector3Stream& operator= (Vector3Stream const&) = default;
+
+        // New elements are zero
+        void Resize(size_t count)
+        {
+            const size_t padded = SoADetail::PaddedSize(count);
+            const size_t keep = std::min(m_size, count);
+            for (auto& c : m_data)
+            {
+                c.resize(padded);
+                std::fill(c.begin() + ptrdiff_t(keep), c.end(), 0.f);
+            }
+            m_size = count;
+        }
+
+        size_t Size() const noexcept { return m_size; }
+        size_t PaddedSize() const noexcept { return m_data[0].size(); }
+
+        float* X() noexcept { return m_data[0].data(); }
+        float* Y() noexcept { return m_data[1].data(); }
+        float* Z() noexcept { return m_data[2].data(); }
+        const float* X() const noexcept { return m_data[0].data(); }
+        const float* Y() const noexcept { return m_data[1].data(); }
+        const float* Z() const noexcept { return m_data[2].data(); }
+
+        DirectX::SimpleMath::Vector3 Get(size_t index) const noexcept
+        {
+            return DirectX::SimpleMath::Vector3(m_data[0][index], m_data[1][index], m_data[2][index]);
+        }
+
+        void Set(size_t index, const DirectX::SimpleMath::Vector3& value) noexcept
+        {
+            m_data[0][index] = value.x;
+            m_data[1][index] = value.y;
+            m_data[2][index] = value.z;
+        }
+
+        // Conversion from and to SimpleMath (AoS) arrays
+        void Load(_In_reads_(count) const DirectX::SimpleMath::Vector3* values, size_t count)
+        {
+            if (!values && count > 0)
+                throw std::invalid_argument("Vector3Stream");
+
+            Resize(count);
+            for (size_t j = 0; j < count; ++j)
+            {
+                Set(j, values[j]);
+            }
+        }
+
+        void Store(_Out_writes_(Size()) DirectX::SimpleMath::Vector3* values) const noexcept
+        {
+            for (size_t j = 0; j < m_size; ++j)
+            {
+                values[j] = Get(j);
+            }
+        }
+
+        // Batch kernels; see SimpleMath::Vector3 for the per-element equivalents
+        static void Transform(const Vector3Stream& v, const DirectX::SimpleMath::Matrix& m, Vector3Stream& result);
+        static void TransformNormal(const Vector3Stream& v, const DirectX::SimpleMath::Matrix& m, Vector3Stream& result);
+        static void Transform(const Vector3Stream& v, const DirectX::SimpleMath::Quaternion& quat, Vector3Stream& result);
+        static void Transform(const Vector3Stream& v, const QuaternionStream& quat, Vector3Stream& result);
+        static void Normalize(const Vector3Stream& v, Vector3Stream& result);
+        static void Dot(const Vector3Stream& v1, const Vector3Stream& v2, _Out_writes_(v1.Size()) float* result);
+        static void Cross(const Vector3Stream& v1, const Vector3Stream& v2, Vector3Stream& result);
+        static void Lerp(const Vector3Stream& v1, const Vector3Stream& v2, float t, Vector3Stream& result);
+
+    private:
+        std::vector<float>  m_data[3];
+        size_t              m_size;
+    };
+
+    //----------------------------------------------------------------------------------
+    class QuaternionStream
+    {
+    public:
+        QuaternionStream() noexcept : m_size(0) {}
+
+        // New elements are the identity
+        explicit QuaternionStream(size_t count) : m_size(0) { Resize(count); }
+
+        QuaternionStream(_In_reads_(count) const DirectX::SimpleMath::Quaternion* values, size_t count) : m_size(0) { Load(values, count); }
+
+        QuaternionStream(QuaternionStream&&) = default;
+        QuaternionStream& operator= (QuaternionStream&&) = default;
+
+        QuaternionStream(QuaternionStream const&) = default;
+        QuaternionStream& operator= (QuaternionStream const&) = default;
+
+        void Resize(size_t count)
+        {
+            const size_t padded = SoADetail::PaddedSize(count);
+            const size_t keep = std::min(m_size, count);
+            for (size_t c = 0; c < 4; ++c)
+            {
+                m_data[c].resize(padded);
+                std::fill(m_data[c].begin() + ptrdiff_t(keep), m_data[c].end(), (c == 3) ? 1.f : 0.f);
+            }
+            m_size = count;
+        }
+
+        size_t Size() const noexcept { return m_size; }
+        size_t PaddedSize() const noexcept { return m_data[0].size(); }
+
+        float* X() noexcept { return m_data[0].data(); }
+        float* Y() noexcept { return m_data[1].data(); }
+        float* Z() noexcept { return m_data[2].data(); }
+        float* W() noexcept { return m_data[3].data(); }
+        const float* X() const noexcept { return m_data[0].data(); }
+        const float* Y() const noexcept { return m_data[1].data(); }
+        const float* Z() const noexcept { return m_data[2].data(); }
+        const float* W() const noexcept { return m_data[3].data(); }
+
+        DirectX::SimpleMath::Quaternion Get(size_t index) const noexcept
+        {
+            return DirectX::SimpleMath::Quaternion(m_data[0][index], m_data[1][index], m_data[2][index], m_data[3][index]);
+        }
+
+        void Set(size_t index, const DirectX::SimpleMath::Quaternion& value) noexcept
+        {
+            m_data[0][index] = value.x;
+            m_data[1][index] = value.y;
+            m_data[2][index] = value.z;
+            m_data[3][index] = value.w;
+        }
+
+        void Load(_In_reads_(count) const DirectX::SimpleMath::Quaternion* values, size_t count)
+        {
+            if (!values && count > 0)
+                throw std::invalid_argument("QuaternionStream");
+
+            Resize(count);
+            for (size_t j = 0; j < count; ++j)
+            {
+                Set(j, values[j]);
+            }
+        }
+
+        void Store(_Out_writes_(Size()) DirectX::SimpleMath::Quaternion* values) const noexcept
+        {
+            for (size_t j = 0; j < m_size; ++j)
+            {
+                values[j] = Get(j);
+            }
+        }
+
+        // Batch kernels; see SimpleMath::Quaternion for the per-element equivalents.
+        // Multiply matches operator*, so q1 * q2 is the rotation q1 followed by q2.
+        static void Normalize(const QuaternionStream& q, QuaternionStream& result);
+        static void Multiply(const QuaternionStream& q1, const QuaternionStream& q2, QuaternionStream& result);
+        static void Lerp(const QuaternionStream& q1, const QuaternionStream& q2, float t, QuaternionStream& result);
+        static void Slerp(const QuaternionStream& q1, const QuaternionStream& q2, float t, QuaternionStream& result);
+
+    private:
+        std::vector<float>  m_data[4];
+        size_t              m_size;
+    };
+
+    //----------------------------------------------------------------------------------
+    // Batch matrix multiply over SimpleMath arrays: result[i] = m1[i] * m2 (or m2[i]).
+    // With AVX each step multiplies two rows at once. 'result' may alias 'm1'.
+    void MultiplyMatrices(
+        _In_reads_(count) const DirectX::SimpleMath::Matrix* m1,
+        const DirectX::SimpleMath::Matrix& m2,
+        _Out_writes_(count) DirectX::SimpleMath::Matrix* result,
+        size_t count) noexcept;
+
+    void MultiplyMatrices(
+        _In_reads_(count) const DirectX::SimpleMath::Matrix* m1,
+        _In_reads_(count) const DirectX::SimpleMath::Matrix* m2,
+        _Out_writes_(count) DirectX::SimpleMath::Matrix* result,
+        size_t count) noexcept;
+
+
+    //==================================================================================
+    // Implementation
+    //==================================================================================
+
+    namespace SoADetail
+    {
+        template<typename L>
+        inline typename L::V XM_CALLCONV Dot3(
+            typename L::V ax, typename L::V ay, typename L::V az,
+            typename L::V bx, typename L::V by, typename L::V bz) noexcept
+        {
+            return L::MultiplyAdd(ax, bx, L::MultiplyAdd(ay, by, L::Multiply(az, bz)));
+        }
+
+        // Same as XMVector3Normalize / XMVector4Normalize: zero length gives zero
+        template<typename L>
+        inline typename L::V XM_CALLCONV ScaleToUnit(typename L::V value, typename L::V length) noexcept
+        {
+            return L::Select(L::Zero(), L::Divide(value, length), L::Greater(length, L::Zero()));
+        }
+
+        inline void Prepare(size_t count, Vector3Stream& result)
+        {
+            if (result.Size() != count)
+                result.Resize(count);
+        }
+
+        inline void Prepare(size_t count, QuaternionStream& result)
+        {
+            if (result.Size() != count)
+                result.Resize(count);
+        }
+
+        template<typename L>
+        void TransformCoord(const Vector3Stream& v, const DirectX::SimpleMath::Matrix& m, Vector3Stream& result, bool coord)
+        {
+            using V = typename L::V;
+
+            Prepare(v.Size(), result);
+
+            const V m11 = L::Splat(m._11), m12 = L::Splat(m._12), m13 = L::Splat(m._13), m14 = L::Splat(m._14);
+            const V m21 = L::Splat(m._21), m22 = L::Splat(m._22), m23 = L::Splat(m._23), m24 = L::Splat(m._24);
+            const V m31 = L::Splat(m._31), m32 = L::Splat(m._32), m33 = L::Splat(m._33), m34 = L::Splat(m._34);
+            const V m41 = L::Splat(m._41), m42 = L::Splat(m._42), m43 = L::Splat(m._43), m44 = L::Splat(m._44);
+
+            const size_t padded = v.PaddedSize();
+            for (size_t j = 0; j < padded; j += L::Width)
+            {
+                const V x = L::Load(v.X() + j);
+                const V y = L::Load(v.Y() + j);
+                const V z = L::Load(v.Z() + j);
+
+                if (coord)
+                {
+                    // XMVector3TransformCoord
+                    const V w = L::MultiplyAdd(x, m14, L::MultiplyAdd(y, m24, L::MultiplyAdd(z, m34, m44)));
+                    L::Store(result.X() + j, L::Divide(L::MultiplyAdd(x, m11, L::MultiplyAdd(y, m21, L::MultiplyAdd(z, m31, m41))), w));
+                    L::Store(result.Y() + j, L::Divide(L::MultiplyAdd(x, m12, L::MultiplyAdd(y, m22, L::MultiplyAdd(z, m32, m42))), w));
+                    L::Store(result.Z() + j, L::Divide(L::MultiplyAdd(x, m13, L::MultiplyAdd(y, m23, L::MultiplyAdd(z, m33, m43))), w));
+                }
+                else
+                {
+                    // XMVector3TransformNormal
+                    L::Store(result.X() + j, L::MultiplyAdd(x, m11, L::MultiplyAdd(y, m21, L::Multiply(z, m31))));
+                    L::Store(result.Y() + j, L::MultiplyAdd(x, m12, L::MultiplyAdd(y, m22, L::Multiply(z, m32))));
+                    L::Store(result.Z() + j, L::MultiplyAdd(x, m13, L::MultiplyAdd(y, m23, L::Multiply(z, m33))));
+                }
+            }
+        }
+
+        // v' = v + 2w(u x v) + 2u x (u x v) for a unit quaternion (u, w); same as XMVector3Rotate
+        template<typename L>
+        inline void XM_CALLCONV Rotate(
+            typename L::V& x, typename L::V& y, typename L::V& z,
+            typename L::V qx, typename L::V qy, typename L::V qz, typename L::V qw) noexcept
+        {
+            using V = typename L::V;
+
+            const V two = L::Splat(2.f);
+            const V tx = L::Multiply(two, L::Subtract(L::Multiply(qy, z), L::Multiply(qz, y)));
+            const V ty = L::Multiply(two, L::Subtract(L::Multiply(qz, x), L::Multiply(qx, z)));
+            const V tz = L::Multiply(two, L::Subtract(L::Multiply(qx, y), L::Multiply(qy, x)));
+
+            const V rx = L::Add(L::MultiplyAdd(qw, tx, x), L::Subtract(L::Multiply(qy, tz), L::Multiply(qz, ty)));
+            const V ry = L::Add(L::MultiplyAdd(qw, ty, y), L::Subtract(L::Multiply(qz, tx), L::Multiply(qx, tz)));
+            const V rz = L::Add(L::MultiplyAdd(qw, tz, z), L::Subtract(L::Multiply(qx, ty), L::Multiply(qy, tx)));
+
+            x = rx;
+            y = ry;
+            z = rz;
+        }
+
+        template<typename L>
+        void Rotate(const Vector3Stream& v, const DirectX::SimpleMath::Quaternion& quat, Vector3Stream& result)
+        {
+            using V = typename L::V;
+
+            Prepare(v.Size(), result);
+
+            const V qx = L::Splat(quat.x);
+            const V qy = L::Splat(quat.y);
+            const V qz = L::Splat(quat.z);
+            const V qw = L::Splat(quat.w);
+
+            const size_t padded = v.PaddedSize();
+            for (size_t j = 0; j < padded; j += L::Width)
+            {
+                V x = L::Load(v.X() + j);
+                V y = L::Load(v.Y() + j);
+                V z = L::Load(v.Z() + j);
+
+                Rotate<L>(x, y, z, qx, qy, qz, qw);
+
+                L::Store(result.X() + j, x);
+                L::Store(result.Y() + j, y);
+                L::Store(result.Z() + j, z);
+            }
+        }
+
+        template<typename L>
+        void Rotate(const Vector3Stream& v, const QuaternionStream& quat, Vector3Stream& result)
+        {
+            using V = typename L::V;
+
+            Prepare(v.Size(), result);
+
+            const size_t padded = v.PaddedSize();
+            for (size_t j = 0; j < padded; j += L::Width)
+            {
+                V x = L::Load(v.X() + j);
+                V y = L::Load(v.Y() + j);
+                V z = L::Load(v.Z() + j);
+
+                Rotate<L>(x, y, z, L::Load(quat.X() + j), L::Load(quat.Y() + j), L::Load(quat.Z() + j), L::Load(quat.W() + j));
+
+                L::Store(result.X() + j, x);
+                L::Store(result.Y() + j, y);
+                L::Store(result.Z() + j, z);
+            }
+        }
+
+        template<typename L>
+        void Normalize(const Vector3Stream& v, Vector3Stream& result)
+        {
+            using V = typename L::V;
+
+            Prepare(v.Size(), result);
+
+            const size_t padded = v.PaddedSize();
+            for (size_t j = 0; j < padded; j += L::Width)
+            {
+                const V x = L::Load(v.X() + j);
+                const V y = L::Load(v.Y() + j);
+                const V z = L::Load(v.Z() + j);
+
+                const V length = L::Sqrt(Dot3<L>(x, y, z, x, y, z));
+
+                L::Store(result.X() + j, ScaleToUnit<L>(x, length));
+                L::Store(result.Y() + j, ScaleToUnit<L>(y, length));
+                L::Store(result.Z() + j, ScaleToUnit<L>(z, length));
+            }
+        }
+
+        template<typename L>
+        void Dot(const Vector3Stream& v1, const Vector3Stream& v2, float* result)
+        {
+            using V = typename L::V;
+
+            const size_t count = v1.Size();
+            for (size_t j = 0; j < count; j += L::Width)
+            {
+                const V dot = Dot3<L>(
+                    L::Load(v1.X() + j), L::Load(v1.Y() + j), L::Load(v1.Z() + j),
+                    L::Load(v2.X() + j), L::Load(v2.Y() + j), L::Load(v2.Z() + j));
+
+                if (count - j >= L::Width)
+                {
+                    L::Store(result + j, dot);
+                }
+                else
+                {
+                    float tail[L::Width];
+                    L::Store(tail, dot);
+                    memcpy(result + j, tail, (count - j) * sizeof(float));
+                }
+            }
+        }
+
+        template<typename L>
+        void Cross(const Vector3Stream& v1, const Vector3Stream& v2, Vector3Stream& result)
+        {
+            using V = typename L::V;
+
+            Prepare(v1.Size(), result);
+
+            const size_t padded = v1.PaddedSize();
+            for (size_t j = 0; j < padded; j += L::Width)
+            {
+                const V ax = L::Load(v1.X() + j);
+                const V ay = L::Load(v1.Y() + j);
+                const V az = L::Load(v1.Z() + j);
+                const V bx = L::Load(v2.X() + j);
+                const V by = L::Load(v2.Y() + j);
+                const V bz = L::Load(v2.Z() + j);
+
+                L::Store(result.X() + j, L::Subtract(L::Multiply(ay, bz), L::Multiply(az, by)));
+                L::Store(result.Y() + j, L::Subtract(L::Multiply(az, bx), L::Multiply(ax, bz)));
+                L::Store(result.Z() + j, L::Subtract(L::Multiply(ax, by), L::Multiply(ay, bx)));
+            }
+        }
+
+        template<typename L>
+        void Lerp(const Vector3Stream& v1, const Vector3Stream& v2, float t, Vector3Stream& result)
+        {
+            using V = typename L::V;
+
+            Prepare(v1.Size(), result);
+
+            const V tv = L::Splat(t);
+
+            // XMVectorLerp: v1 + t * (v2 - v1)
+            const size_t padded = v1.PaddedSize();
+            for (size_t j = 0; j < padded; j += L::Width)
+            {
+                const V ax = L::Load(v1.X() + j);
+                const V ay = L::Load(v1.Y() + j);
+                const V az = L::Load(v1.Z() + j);
+
+                L::Store(result.X() + j, L::MultiplyAdd(tv, L::Subtract(L::Load(v2.X() + j), ax), ax));
+                L::Store(result.Y() + j, L::MultiplyAdd(tv, L::Subtract(L::Load(v2.Y() + j), ay), ay));
+                L::Store(result.Z() + j, L::MultiplyAdd(tv, L::Subtract(L::Load(v2.Z() + j), az), az));
+            }
+        }
+
+        template<typename L>
+        inline void XM_CALLCONV StoreQuaternion(QuaternionStream& result, size_t j,
+            typename L::V x, typename L::V y, typename L::V z, typename L::V w) noexcept
+        {
+            L::Store(result.X() + j, x);
+            L::Store(result.Y() + j, y);
+            L::Store(result.Z() + j, z);
+            L::Store(result.W() + j, w);
+        }
+
+        template<typename L>
+        void Normalize(const QuaternionStream& q, QuaternionStream& result)
+        {
+            using V = typename L::V;
+
+            Prepare(q.Size(), result);
+
+            const size_t padded = q.PaddedSize();
+            for (size_t j = 0; j < padded; j += L::Width)
+            {
+                const V x = L::Load(q.X() + j);
+                const V y = L::Load(q.Y() + j);
+                const V z = L::Load(q.Z() + j);
+                const V w = L::Load(q.W() + j);
+
+                const V length = L::Sqrt(L::MultiplyAdd(w, w, Dot3<L>(x, y, z, x, y, z)));
+
+                StoreQuaternion<L>(result, j,
+                    ScaleToUnit<L>(x, length), ScaleToUnit<L>(y, length), ScaleToUnit<L>(z, length), ScaleToUnit<L>(w, length));
+            }
+        }
+
+        // XMQuaternionMultiply(q1, q2), which is the Hamilton product q2 q1
+        template<typename L>
+        void Multiply(const QuaternionStream& q1, const QuaternionStream& q2, QuaternionStream& result)
+        {
+            using V = typename L::V;
+
+            Prepare(q1.Size(), result);
+
+            const size_t padded = q1.PaddedSize();
+            for (size_t j = 0; j < padded; j += L::Width)
+            {
+                const V ax = L::Load(q1.X() + j);
+                const V ay = L::Load(q1.Y() + j);
+                const V az = L::Load(q1.Z() + j);
+                const V aw = L::Load(q1.W() + j);
+                const V bx = L::Load(q2.X() + j);
+                const V by = L::Load(q2.Y() + j);
+                const V bz = L::Load(q2.Z() + j);
+                const V bw = L::Load(q2.W() + j);
+
+                const V x = L::Add(L::MultiplyAdd(bw, ax, L::Multiply(bx, aw)), L::Subtract(L::Multiply(by, az), L::Multiply(bz, ay)));
+                const V y = L::Add(L::MultiplyAdd(bw, ay, L::Multiply(by, aw)), L::Subtract(L::Multiply(bz, ax), L::Multiply(bx, az)));
+                const V z = L::Add(L::MultiplyAdd(bw, az, L::Multiply(bz, aw)), L::Subtract(L::Multiply(bx, ay), L::Multiply(by, ax)));
+                const V w = L::Subtract(L::Multiply(bw, aw), Dot3<L>(bx, by, bz, ax, ay, az));
+
+                StoreQuaternion<L>(result, j, x, y, z, w);
+            }
+        }
+
+        // Same as Quaternion::Lerp: takes the shorter arc, then normalizes
+        template<typename L>
+        void Lerp(const QuaternionStream& q1, const QuaternionStream& q2, float t, QuaternionStream& result)
+        {
+            using V = typename L::V;
+
+            Prepare(q1.Size(), result);
+
+            const V t0 = L::Splat(1.f - t);
+            const V t1 = L::Splat(t);
+            const V negT1 = L::Splat(-t);
+
+            const size_t padded = q1.PaddedSize();
+            for (size_t j = 0; j < padded; j += L::Width)
+            {
+                const V ax = L::Load(q1.X() + j);
+                const V ay = L::Load(q1.Y() + j);
+                const V az = L::Load(q1.Z() + j);
+                const V aw = L::Load(q1.W() + j);
+                const V bx = L::Load(q2.X() + j);
+                const V by = L::Load(q2.Y() + j);
+                const V bz = L::Load(q2.Z() + j);
+                const V bw = L::Load(q2.W() + j);
+
+                const V dot = L::MultiplyAdd(aw, bw, Dot3<L>(ax, ay, az, bx, by, bz));
+                const V s1 = L::Select(t1, negT1, L::Less(dot, L::Zero()));
+
+                const V x = L::MultiplyAdd(ax, t0, L::Multiply(bx, s1));
+                const V y = L::MultiplyAdd(ay, t0, L::Multiply(by, s1));
+                const V z = L::MultiplyAdd(az, t0, L::Multiply(bz, s1));
+                const V w = L::MultiplyAdd(aw, t0, L::Multiply(bw, s1));
+
+                const V length = L::Sqrt(L::MultiplyAdd(w, w, Dot3<L>(x, y, z, x, y, z)));
+
+                StoreQuaternion<L>(result, j,
+                    ScaleToUnit<L>(x, length), ScaleToUnit<L>(y, length), ScaleToUnit<L>(z, length), ScaleToUnit<L>(w, length));
+            }
+        }
+
+        // Same as XMQuaternionSlerp, including the linear fallback for nearly equal rotations
+        template<typename L>
+        void Slerp(const QuaternionStream& q1, const QuaternionStream& q2, float t, QuaternionStream& result)
+        {
+            using V = typename L::V;
+
+            Prepare(q1.Size(), result);
+
+            const V one = L::Splat(1.f);
+            const V negOne = L::Splat(-1.f);
+            const V oneMinusEpsilon = L::Splat(1.0f - 0.00001f);
+            const V t0 = L::Splat(1.f - t);
+            const V t1 = L::Splat(t);
+
+            const size_t padded = q1.PaddedSize();
+            for (size_t j = 0; j < padded; j += L::Width)
+            {
+                const V ax = L::Load(q1.X() + j);
+                const V ay = L::Load(q1.Y() + j);
+                const V az = L::Load(q1.Z() + j);
+                const V aw = L::Load(q1.W() + j);
+                const V bx = L::Load(q2.X() + j);
+                const V by = L::Load(q2.Y() + j);
+                const V bz = L::Load(q2.Z() + j);
+                const V bw = L::Load(q2.W() + j);
+
+                V cosOmega = L::MultiplyAdd(aw, bw, Dot3<L>(ax, ay, az, bx, by, bz));
+                const V sign = L::Select(one, negOne, L::Less(cosOmega, L::Zero()));
+                cosOmega = L::Multiply(cosOmega, sign);
+
+                const V sinOmega = L::Sqrt(L::Max(L::Subtract(one, L::Multiply(cosOmega, cosOmega)), L::Zero()));
+                const V omega = L::ATan2(sinOmega, cosOmega);
+
+                V s0 = L::Divide(L::Sin(L::Multiply(t0, omega)), sinOmega);
+                V s1 = L::Divide(L::Sin(L::Multiply(t1, omega)), sinOmega);
+
+                const V useSin = L::Less(cosOmega, oneMinusEpsilon);
+                s0 = L::Select(t0, s0, useSin);
+                s1 = L::Multiply(L::Select(t1, s1, useSin), sign);
+
+                StoreQuaternion<L>(result, j,
+                    L::MultiplyAdd(ax, s0, L::Multiply(bx, s1)),
+                    L::MultiplyAdd(ay, s0, L::Multiply(by, s1)),
+                    L::MultiplyAdd(az, s0, L::Multiply(bz, s1)),
+                    L::MultiplyAdd(aw, s0, L::Multiply(bw, s1)));
+            }
+        }
+
+        inline void CheckSizes(size_t a, size_t b, _In_z_ const char* name)
+        {
+            if (a != b)
+                throw std::invalid_argument(name);
+        }
+
+    #ifdef DX_SOA_AVX
+        // Two rows of 'a' per register; each row is a linear combination of the rows of 'b'
+        inline void XM_CALLCONV MultiplyMatrixAVX(const float* a, const __m256 b[4], float* result) noexcept
+        {
+            const __m256 a01 = _mm256_loadu_ps(a);
+            const __m256 a23 = _mm256_loadu_ps(a + 8);
+
+            __m256 r01 = _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, _MM_SHUFFLE(0, 0, 0, 0)), b[0]);
+            __m256 r23 = _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, _MM_SHUFFLE(0, 0, 0, 0)), b[0]);
+            r01 = Lanes8::MultiplyAdd(_mm256_shuffle_ps(a01, a01, _MM_SHUFFLE(1, 1, 1, 1)), b[1], r01);
+            r23 = Lanes8::MultiplyAdd(_mm256_shuffle_ps(a23, a23, _MM_SHUFFLE(1, 1, 1, 1)), b[1], r23);
+            r01 = Lanes8::MultiplyAdd(_mm256_shuffle_ps(a01, a01, _MM_SHUFFLE(2, 2, 2, 2)), b[2], r01);
+            r23 = Lanes8::MultiplyAdd(_mm256_shuffle_ps(a23, a23, _MM_SHUFFLE(2, 2, 2, 2)), b[2], r23);
+            r01 = Lanes8::MultiplyAdd(_mm256_shuffle_ps(a01, a01, _MM_SHUFFLE(3, 3, 3, 3)), b[3], r01);
+            r23 = Lanes8::MultiplyAdd(_mm256_shuffle_ps(a23, a23, _MM_SHUFFLE(3, 3, 3, 3)), b[3], r23);
+
+            _mm256_storeu_ps(result, r01);
+            _mm256_storeu_ps(result + 8, r23);
+        }
+
+        inline void LoadRowsAVX(const float* m, __m256 rows[4]) noexcept
+        {
+            for (size_t r = 0; r < 4; ++r)
+            {
+                rows[r] = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + r * 4));
+            }
+        }
+    #endif
+    }
+
+    //----------------------------------------------------------------------------------
+    inline void Vector3Stream::Transform(const Vector3Stream& v, const DirectX::SimpleMath::Matrix& m, Vector3Stream& result)
+    {
+        SoADetail::TransformCoord<SoADetail::Lanes>(v, m, result, true);
+    }
+
+    inline void Vector3Stream::TransformNormal(const Vector3Stream& v, const DirectX::SimpleMath::Matrix& m, Vector3Stream& result)
+    {
+        SoADetail::TransformCoord<SoADetail::Lanes>(v, m, result, false);
+    }
+
+    inline void Vector3Stream::Transform(const Vector3Stream& v, const DirectX::SimpleMath::Quaternion& quat, Vector3Stream& result)
+    {
+        SoADetail::Rotate<SoADetail::Lanes>(v, quat, result);
+    }
+
+    inline void Vector3Stream::Transform(const Vector3Stream& v, const QuaternionStream& quat, Vector3Stream& result)
+    {
+        SoADetail::CheckSizes(v.Size(), quat.Size(), "Vector3Stream::Transform");
+        SoADetail::Rotate<SoADetail::Lanes>(v, quat, result);
+    }
+
+    inline void Vector3Stream::Normalize(const Vector3Stream& v, Vector3Stream& result)
+    {
+        SoADetail::Normalize<SoADetail::Lanes>(v, result);
+    }
+
+    inline void Vector3Stream::Dot(const Vector3Stream& v1, const Vector3Stream& v2, float* result)
+    {
+        SoADetail::CheckSizes(v1.Size(), v2.Size(), "Vector3Stream::Dot");
+        if (!result && v1.Size() > 0)
+            throw std::invalid_argument("Vector3Stream::Dot");
+
+        SoADetail::Dot<SoADetail::Lanes>(v1, v2, result);
+    }
+
+    inline void Vector3Stream::Cross(const Vector3Stream& v1, const Vector3Stream& v2, Vector3Stream& result)
+    {
+        SoADetail::CheckSizes(v1.Size(), v2.Size(), "Vector3Stream::Cross");
+        SoADetail::Cross<SoADetail::Lanes>(v1, v2, result);
+    }
+
+    inline void Vector3Stream::Lerp(const Vector3Stream& v1, const Vector3Stream& v2, float t, Vector3Stream& result)
+    {
+        SoADetail::CheckSizes(v1.Size(), v2.Size(), "Vector3Stream::Lerp");
+        SoADetail::Lerp<SoADetail::Lanes>(v1, v2, t, result);
+    }
+
+    inline void QuaternionStream::Normalize(const QuaternionStream& q, QuaternionStream& result)
+    {
+        SoADetail::Normalize<SoADetail::Lanes>(q, result);
+    }
+
+    inline void QuaternionStream::Multiply(const QuaternionStream& q1, const QuaternionStream& q2, QuaternionStream& result)
+    {
+        SoADetail::CheckSizes(q1.Size(), q2.Size(), "QuaternionStream::Multiply");
+        SoADetail::Multiply<SoADetail::Lanes>(q1, q2, result);
+    }
+
+    inline void QuaternionStream::Lerp(const QuaternionStream& q1, const QuaternionStream& q2, float t, QuaternionStream& result)
+    {
+        SoADetail::CheckSizes(q1.Size(), q2.Size(), "QuaternionStream::Lerp");
+        SoADetail::Lerp<SoADetail::Lanes>(q1, q2, t, result);
+    }
+
+    inline void QuaternionStream::Slerp(const QuaternionStream& q1, const QuaternionStream& q2, float t, QuaternionStream& result)
+    {
+        SoADetail::CheckSizes(q1.Size(), q2.Size(), "QuaternionStream::Slerp");
+        SoADetail::Slerp<SoADetail::Lanes>(q1, q2, t, result);
+    }
+
+    //----------------------------------------------------------------------------------
+    inline void MultiplyMatrices(
+        const DirectX::SimpleMath::Matrix* m1,
+        const DirectX::SimpleMath::Matrix& m2,
+        DirectX::SimpleMath::Matrix* result,
+        size_t count) noexcept
+    {
+    #ifdef DX_SOA_AVX
+        __m256 rows[4];
+        SoADetail::LoadRowsAVX(&m2._11, rows);
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            SoADetail::MultiplyMatrixAVX(&m1[j]._11, rows, &result[j]._11);
+        }
+    #else
+        using namespace DirectX;
+
+        const XMMATRIX b = XMLoadFloat4x4(&m2);
+        for (size_t j = 0; j < count; ++j)
+        {
+            XMStoreFloat4x4(&result[j], XMMatrixMultiply(XMLoadFloat4x4(&m1[j]), b));
+        }
+    #endif
+    }
+
+    inline void MultiplyMatrices(
+        const DirectX::SimpleMath::Matrix* m1,
+        const DirectX::SimpleMath::Matrix* m2,
+        DirectX::SimpleMath::Matrix* result,
+        size_t count) noexcept
+    {
+    #ifdef DX_SOA_AVX
+        for (size_t j = 0; j < count; ++j)
+        {
+            __m256 rows[4];
+            SoADetail::LoadRowsAVX(&m2[j]._11, rows);
+            SoADetail::MultiplyMatrixAVX(&m1[j]._11, rows, &result[j]._11);
+        }
+    #else
+        using namespace DirectX;
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            XMStoreFloat4x4(&result[j], XMMatrixMultiply(XMLoadFloat4x4(&m1[j]), XMLoadFloat4x4(&m2[j])));
+        }
+    #endif
+    }
+}
@@ -4,13 +4,43 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <exception>
+#include <ostream>
+#include <vector>
+
+#ifndef _WIN32
+#include <chrono>
+#endif
 
 
 namespace DX
 {
+    // Summary of the most recent frames recorded by StepTimer. Times are in milliseconds.
+    struct FrameStatistics
+    {
+        uint32_t frames;                // Ticks in the history window
+        uint32_t updates;               // Update calls in the history window
+
+        double frameP50;
+        double frameP95;
+        double frameP99;
+        double frameMax;
+
+        double updateP50;
+        double updateP95;
+        double updateP99;
+        double updateMax;
+
+        uint64_t hitches;               // Ticks longer than the hitch threshold (since reset)
+        uint64_t catchUpTicks;          // Fixed timestep ticks that ran more than one Update (since reset)
+        uint64_t catchUpUpdates;        // Extra Update calls made by those ticks (since reset)
+        uint32_t maxUpdatesPerTick;     // Since reset
+    };
+
     // Helper class for animation and simulation timing.
     class StepTimer
     {
@@ -24,20 +54,23 @@ namespace DX
             m_framesThisSecond(0),
             m_qpcSecondCounter(0),
             m_isFixedTimeStep(false),
-            m_targetElapsedTicks(TicksPerSecond / 60)
+            m_targetElapsedTicks(TicksPerSecond / 60),
+            m_hitchTicks(TicksPerSecond / 30),
+            m_frameHistory(c_HistorySize),
+            m_updateHistory(c_HistorySize),
+            m_frameSamples(0),
+            m_updateSamples(0),
+            m_currentUpdateTicks(0),
+            m_hitches(0),
+            m_catchUpTicks(0),
+            m_catchUpUpdates(0),
+            m_maxUpdatesPerTick(0)
         {
-            if (!QueryPerformanceFrequency(&m_qpcFrequency))
-            {
-                throw std::exception();
-            }
-
-            if (!QueryPerformanceCounter(&m_qpcLastTime))
-            {
-                throw std::exception();
-            }
+            m_qpcFrequency = QueryFrequency();
+            m_qpcLastTime = QueryCounter();
 
             // Initialize max delta to 1/10 of a second.
-            m_qpcMaxDelta = static_cast<uint64_t>(m_qpcFrequency.QuadPart / 10);
+            m_qpcMaxDelta = m_qpcFrequency / 10;
         }
 
         // Get elapsed time since the previous Update call.
@@ -61,22 +94,26 @@ namespace DX
         void SetTargetElapsedTicks(uint64_t targetElapsed) noexcept { m_targetElapsedTicks = targetElapsed; }
         void SetTargetElapsedSeconds(double targetElapsed) noexcept { m_targetElapsedTicks = SecondsToTicks(targetElapsed); }
 
+        // Set the frame time above which a tick counts as a hitch (defaults to 1/30 of a second).
+        void SetHitchThresholdTicks(uint64_t ticks) noexcept { m_hitchTicks = ticks; }
+        void SetHitchThresholdSeconds(double seconds) noexcept { m_hitchTicks = SecondsToTicks(seconds); }
+
         // Integer format represents time using 10,000,000 ticks per second.
         static constexpr uint64_t TicksPerSecond = 10000000;
 
         static constexpr double TicksToSeconds(uint64_t ticks) noexcept { return static_cast<double>(ticks) / TicksPerSecond; }
         static constexpr uint64_t SecondsToTicks(double seconds) noexcept { return static_cast<uint64_t>(seconds * TicksPerSecond); }
 
+        // Number of frames and updates kept for percentile statistics.
+        static constexpr size_t c_HistorySize = 1024;
+
         // After an intentional timing discontinuity (for instance a blocking IO operation)
         // call this to avoid having the fixed timestep logic attempt a set of catch-up
         // Update calls.
 
         void ResetElapsedTime()
         {
-            if (!QueryPerformanceCounter(&m_qpcLastTime))
-            {
-                throw std::exception();
-            }
+            m_qpcLastTime = QueryCounter();
 
             m_leftOverTicks = 0;
             m_framesPerSecond = 0;
@@ -89,18 +126,16 @@ namespace DX
         void Tick(const TUpdate& update)
         {
             // Query the current time.
-            LARGE_INTEGER currentTime;
+            const uint64_t currentTime = QueryCounter();
 
-            if (!QueryPerformanceCounter(&currentTime))
-            {
-                throw std::exception();
-            }
-
-            uint64_t timeDelta = static_cast<uint64_t>(currentTime.QuadPart - m_qpcLastTime.QuadPart);
+            uint64_t timeDelta = currentTime - m_qpcLastTime;
 
             m_qpcLastTime = currentTime;
             m_qpcSecondCounter += timeDelta;
 
+            // Record the real frame time before clamping.
+            const uint64_t frameTicks = QpcToTicks(timeDelta);
+
             // Clamp excessively large time deltas (e.g. after paused in the debugger).
             if (timeDelta > m_qpcMaxDelta)
             {
@@ -109,7 +144,7 @@ namespace DX
 
             // Convert QPC units into a canonical tick format. This cannot overflow due to the previous clamp.
             timeDelta *= TicksPerSecond;
-            timeDelta /= static_cast<uint64_t>(m_qpcFrequency.QuadPart);
+            timeDelta /= m_qpcFrequency;
 
             const uint32_t lastFrameCount = m_frameCount;
 
@@ -138,7 +173,7 @@ namespace DX
                     m_leftOverTicks -= m_targetElapsedTicks;
                     m_frameCount++;
 
-                    update();
+                    TimedUpdate(update);
                 }
             }
             else
@@ -149,7 +184,7 @@ namespace DX
                 m_leftOverTicks = 0;
                 m_frameCount++;
 
-                update();
+                TimedUpdate(update);
             }
 
             // Track the current framerate.
@@ -158,18 +193,207 @@ namespace DX
                 m_framesThisSecond++;
             }
 
-            if (m_qpcSecondCounter >= static_cast<uint64_t>(m_qpcFrequency.QuadPart))
+            if (m_qpcSecondCounter >= m_qpcFrequency)
             {
                 m_framesPerSecond = m_framesThisSecond;
                 m_framesThisSecond = 0;
-                m_qpcSecondCounter %= static_cast<uint64_t>(m_qpcFrequency.QuadPart);
+                m_qpcSecondCounter %= m_qpcFrequency;
+            }
+
+            RecordFrame(frameTicks, m_frameCount - lastFrameCount);
+        }
+
+        // Percentiles over the last c_HistorySize frames and updates, plus hitch and catch-up counts.
+        FrameStatistics GetFrameStatistics() const
+        {
+            FrameStatistics stats = {};
+
+            const auto frames = static_cast<size_t>(std::min<uint64_t>(m_frameSamples, c_HistorySize));
+            const auto updates = static_cast<size_t>(std::min<uint64_t>(m_updateSamples, c_HistorySize));
+
+            stats.frames = static_cast<uint32_t>(frames);
+            stats.updates = static_cast<uint32_t>(updates);
+
+            std::vector<uint64_t> sorted(frames);
+            for (size_t j = 0; j < frames; ++j)
+            {
+                sorted[j] = m_frameHistory[j].ticks;
             }
+            std::sort(sorted.begin(), sorted.end());
+
+            stats.frameP50 = Percentile(sorted, 50);
+            stats.frameP95 = Percentile(sorted, 95);
+            stats.frameP99 = Percentile(sorted, 99);
+            stats.frameMax = Percentile(sorted, 100);
+
+            sorted.assign(m_updateHistory.cbegin(), m_updateHistory.cbegin() + static_cast<ptrdiff_t>(updates));
+            std::sort(sorted.begin(), sorted.end());
+
+            stats.updateP50 = Percentile(sorted, 50);
+            stats.updateP95 = Percentile(sorted, 95);
+            stats.updateP99 = Percentile(sorted, 99);
+            stats.updateMax = Percentile(sorted, 100);
+
+            stats.hitches = m_hitches;
+            stats.catchUpTicks = m_catchUpTicks;
+            stats.catchUpUpdates = m_catchUpUpdates;
+            stats.maxUpdatesPerTick = m_maxUpdatesPerTick;
+
+            return stats;
+        }
+
+        void ResetStatistics() noexcept
+        {
+            m_frameSamples = m_updateSamples = 0;
+            m_hitches = m_catchUpTicks = m_catchUpUpdates = 0;
+            m_maxUpdatesPerTick = 0;
+        }
+
+        // One row per recorded frame, oldest first: frame time, update count, and time spent in Update.
+        void ExportFrameTimesCSV(std::ostream& out) const
+        {
+            out << "frame,frameMs,updates,updateMs\n";
+
+            ForEachFrame([&](uint64_t index, const FrameRecord& frame)
+                {
+                    out << index << ',' << TicksToMilliseconds(frame.ticks) << ',' << frame.updates << ',' << TicksToMilliseconds(frame.updateTicks) << '\n';
+                });
+        }
+
+        // Summary statistics plus the recorded frame times (ms), oldest first.
+        void ExportStatisticsJSON(std::ostream& out) const
+        {
+            const FrameStatistics stats = GetFrameStatistics();
+
+            out << "{\n"
+                << "  \"frames\": " << stats.frames << ",\n"
+                << "  \"updates\": " << stats.updates << ",\n"
+                << "  \"frameMs\": { \"p50\": " << stats.frameP50 << ", \"p95\": " << stats.frameP95
+                    << ", \"p99\": " << stats.frameP99 << ", \"max\": " << stats.frameMax << " },\n"
+                << "  \"updateMs\": { \"p50\": " << stats.updateP50 << ", \"p95\": " << stats.updateP95
+                    << ", \"p99\": " << stats.updateP99 << ", \"max\": " << stats.updateMax << " },\n"
+                << "  \"hitchThresholdMs\": " << TicksToMilliseconds(m_hitchTicks) << ",\n"
+                << "  \"hitches\": " << stats.hitches << ",\n"
+                << "  \"catchUpTicks\": " << stats.catchUpTicks << ",\n"
+                << "  \"catchUpUpdates\": " << stats.catchUpUpdates << ",\n"
+                << "  \"maxUpdatesPerTick\": " << stats.maxUpdatesPerTick << ",\n"
+                << "  \"frameTimesMs\": [";
+
+            bool first = true;
+            ForEachFrame([&](uint64_t, const FrameRecord& frame)
+                {
+                    out << (first ? "" : ", ") << TicksToMilliseconds(frame.ticks);
+                    first = false;
+                });
+
+            out << "]\n}\n";
         }
 
     private:
+        struct FrameRecord
+        {
+            uint64_t ticks;
+            uint64_t updateTicks;
+            uint32_t updates;
+        };
+
+        // QPC on Windows, std::chrono::steady_clock elsewhere.
+        static uint64_t QueryFrequency()
+        {
+#ifdef _WIN32
+            LARGE_INTEGER frequency;
+            if (!QueryPerformanceFrequency(&frequency))
+            {
+                throw std::exception();
+            }
+            return static_cast<uint64_t>(frequency.QuadPart);
+#else
+            using period = std::chrono::steady_clock::period;
+            static_assert(period::num == 1, "steady_clock period must be a fraction of a second");
+            return static_cast<uint64_t>(period::den);
+#endif
+        }
+
+        static uint64_t QueryCounter()
+        {
+#ifdef _WIN32
+            LARGE_INTEGER counter;
+            if (!QueryPerformanceCounter(&counter))
+            {
+                throw std::exception();
+            }
+            return static_cast<uint64_t>(counter.QuadPart);
+#else
+            return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+        }
+
+        // Unclamped conversion for statistics; splits the division so long stalls cannot overflow.
+        uint64_t QpcToTicks(uint64_t qpc) const noexcept
+        {
+            return (qpc / m_qpcFrequency) * TicksPerSecond + ((qpc % m_qpcFrequency) * TicksPerSecond) / m_qpcFrequency;
+        }
+
+        static constexpr double TicksToMilliseconds(uint64_t ticks) noexcept { return static_cast<double>(ticks) * 1000.0 / TicksPerSecond; }
+
+        // Nearest-rank percentile of sorted tick values, in milliseconds.
+        static double Percentile(const std::vector<uint64_t>& sorted, uint32_t percent) noexcept
+        {
+            if (sorted.empty())
+                return 0.0;
+
+            size_t rank = (sorted.size() * percent + 99) / 100;
+            rank = std::max<size_t>(rank, 1);
+            return TicksToMilliseconds(sorted[rank - 1]);
+        }
+
+        template<typename TUpdate>
+        void TimedUpdate(const TUpdate& update)
+        {
+            const uint64_t start = QueryCounter();
+
+            update();
+
+            const uint64_t ticks = QpcToTicks(QueryCounter() - start);
+            m_updateHistory[m_updateSamples % c_HistorySize] = ticks;
+            ++m_updateSamples;
+            m_currentUpdateTicks += ticks;
+        }
+
+        void RecordFrame(uint64_t ticks, uint32_t updates) noexcept
+        {
+            m_frameHistory[m_frameSamples % c_HistorySize] = FrameRecord{ ticks, m_currentUpdateTicks, updates };
+            ++m_frameSamples;
+            m_currentUpdateTicks = 0;
+
+            if (ticks > m_hitchTicks)
+            {
+                ++m_hitches;
+            }
+
+            // More than one Update in a tick means the fixed timestep loop was catching up.
+            if (updates > 1)
+            {
+                ++m_catchUpTicks;
+                m_catchUpUpdates += updates - 1;
+            }
+
+            m_maxUpdatesPerTick = std::max(m_maxUpdatesPerTick, updates);
+        }
+
+        template<typename TFunc>
+        void ForEachFrame(TFunc&& func) const
+        {
+            const uint64_t count = std::min<uint64_t>(m_frameSamples, c_HistorySize);
+            for (uint64_t index = m_frameSamples - count; index < m_frameSamples; ++index)
+            {
+                func(index, m_frameHistory[index % c_HistorySize]);
+            }
+        }
+
         // Source timing data uses QPC units.
-        LARGE_INTEGER m_qpcFrequency;
-        LARGE_INTEGER m_qpcLastTime;
+        uint64_t m_qpcFrequency;
+        uint64_t m_qpcLastTime;
         uint64_t m_qpcMaxDelta;
 
         // Derived timing data uses a canonical tick format.
@@ -186,5 +410,17 @@ namespace DX
         // Members for configuring fixed timestep mode.
         bool m_isFixedTimeStep;
         uint64_t m_targetElapsedTicks;
+
+        // Members for frame statistics (ring buffers of the last c_HistorySize entries).
+        uint64_t m_hitchTicks;
+        std::vector<FrameRecord> m_frameHistory;
+        std::vector<uint64_t> m_updateHistory;
+        uint64_t m_frameSamples;
+        uint64_t m_updateSamples;
+        uint64_t m_currentUpdateTicks;
+        uint64_t m_hitches;
+        uint64_t m_catchUpTicks;
+        uint64_t m_catchUpUpdates;
+        uint32_t m_maxUpdatesPerTick;
     };
 }
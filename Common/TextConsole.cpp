@@ -8,6 +8,7 @@
 #include "pch.h"
 #include "TextConsole.h"
 
+#include "GlyphIndex.h"
 #include "SimpleMath.h"
 #include "DDSTextureLoader.h"
 #include "WICTextureLoader.h"
@@ -23,13 +24,19 @@ using Microsoft::WRL::ComPtr;
 using namespace DirectX;
 using namespace DX;
 
-TextConsole::TextConsole() noexcept
+TextConsole::TextConsole() noexcept(false)
     : m_layout{},
     m_textColor(1.f, 1.f, 1.f, 1.f),
     m_debugOutput(false),
     m_columns(0),
-    m_rows(0)
+    m_rows(0),
+    m_enqueuePos(0),
+    m_dequeuePos(0),
+    m_queuedMessages(0),
+    m_droppedMessages(0)
 {
+    InitializeQueue();
+
     Clear();
 }
 
@@ -40,8 +47,14 @@ TextConsole::TextConsole(ID3D11DeviceContext* context, const wchar_t* fontName)
     m_textColor(1.f, 1.f, 1.f, 1.f),
     m_debugOutput(false),
     m_columns(0),
-    m_rows(0)
+    m_rows(0),
+    m_enqueuePos(0),
+    m_dequeuePos(0),
+    m_queuedMessages(0),
+    m_droppedMessages(0)
 {
+    InitializeQueue();
+
     RestoreDevice(context, fontName);
 
     Clear();
@@ -50,11 +63,13 @@ TextConsole::TextConsole(ID3D11DeviceContext* context, const wchar_t* fontName)
 
 void TextConsole::Render()
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    DrainQueue(true);
+
     if (!m_lines)
         return;
 
-    std::lock_guard<std::mutex> lock(m_mutex);
-
     const float lineSpacing = m_font->GetLineSpacing();
 
     const float x = float(m_layout.left);
@@ -68,11 +83,18 @@ void TextConsole::Render()
 
     for (unsigned int line = 0; line < m_rows; ++line)
     {
-        const XMFLOAT2 pos(x, y + lineSpacing * float(line));
+        auto& layout = m_lineLayouts[textLine];
+        if (layout.dirty)
+        {
+            LayoutLine(textLine);
+        }
 
-        if (*m_lines[textLine])
+        const float lineY = y + lineSpacing * float(line);
+
+        // Equivalent to SpriteFont::DrawString with no rotation, scale, or effects
+        for (const auto& quad : layout.quads)
         {
-            m_font->DrawString(m_batch.get(), m_lines[textLine], pos, color);
+            m_batch->Draw(m_spriteSheet.Get(), XMFLOAT2(x + quad.x, lineY + quad.y), &quad.source, color);
         }
 
         textLine = static_cast<unsigned int>(textLine + 1) % m_rows;
@@ -91,6 +113,11 @@ void TextConsole::Clear() noexcept
         memset(m_buffer.get(), 0, sizeof(wchar_t) * (m_columns + 1) * m_rows);
     }
 
+    // Anything queued before the clear is discarded
+    DrainQueue(false);
+
+    InvalidateLines();
+
     m_currentColumn = m_currentLine = 0;
 }
 
@@ -98,9 +125,7 @@ void TextConsole::Clear() noexcept
 _Use_decl_annotations_
 void TextConsole::Write(const wchar_t* str)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    ProcessString(str);
+    Enqueue(str, false);
 
 #ifndef NDEBUG
     if (m_debugOutput)
@@ -114,10 +139,7 @@ void TextConsole::Write(const wchar_t* str)
 _Use_decl_annotations_
 void TextConsole::WriteLine(const wchar_t* str)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    ProcessString(str);
-    IncrementLine();
+    Enqueue(str, true);
 
 #ifndef NDEBUG
     if (m_debugOutput)
@@ -132,28 +154,29 @@ void TextConsole::WriteLine(const wchar_t* str)
 _Use_decl_annotations_
 void TextConsole::Format(const wchar_t* strFormat, ...)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    // Each producer thread formats into its own buffer
+    thread_local std::vector<wchar_t> s_formatBuffer;
 
     va_list argList;
     va_start(argList, strFormat);
 
     const auto len = size_t(_vscwprintf(strFormat, argList) + 1);
 
-    if (m_tempBuffer.size() < len)
-        m_tempBuffer.resize(len);
+    if (s_formatBuffer.size() < len)
+        s_formatBuffer.resize(len);
 
-    memset(m_tempBuffer.data(), 0, sizeof(wchar_t) * len);
+    memset(s_formatBuffer.data(), 0, sizeof(wchar_t) * len);
 
-    vswprintf_s(m_tempBuffer.data(), m_tempBuffer.size(), strFormat, argList);
+    vswprintf_s(s_formatBuffer.data(), s_formatBuffer.size(), strFormat, argList);
 
     va_end(argList);
 
-    ProcessString(m_tempBuffer.data());
+    Enqueue(s_formatBuffer.data(), false);
 
 #ifndef NDEBUG
     if (m_debugOutput)
     {
-        OutputDebugStringW(m_tempBuffer.data());
+        OutputDebugStringW(s_formatBuffer.data());
     }
 #endif
 }
@@ -177,9 +200,11 @@ void TextConsole::SetWindow(const RECT& layout)
     memset(buffer.get(), 0, sizeof(wchar_t) * (columns + 1) * rows);
 
     auto lines = std::make_unique<wchar_t* []>(rows);
+    auto lineLayouts = std::make_unique<LineLayout[]>(rows);
     for (unsigned int line = 0; line < rows; ++line)
     {
         lines[line] = buffer.get() + (columns + 1) * line;
+        lineLayouts[line].quads.reserve(columns);
     }
 
     if (m_lines)
@@ -197,6 +222,7 @@ void TextConsole::SetWindow(const RECT& layout)
     std::swap(rows, m_rows);
     std::swap(buffer, m_buffer);
     std::swap(lines, m_lines);
+    std::swap(lineLayouts, m_lineLayouts);
 
     if ((m_currentColumn >= m_columns) || (m_currentLine >= m_rows))
     {
@@ -209,6 +235,7 @@ void TextConsole::ReleaseDevice() noexcept
 {
     m_batch.reset();
     m_font.reset();
+    m_spriteSheet.Reset();
     m_context.Reset();
 }
 
@@ -225,6 +252,10 @@ void TextConsole::RestoreDevice(ID3D11DeviceContext* context, const wchar_t* fon
     m_font = std::make_unique<SpriteFont>(device.Get(), fontName);
 
     m_font->SetDefaultCharacter(L' ');
+
+    m_font->GetSpriteSheet(m_spriteSheet.ReleaseAndGetAddressOf());
+
+    InvalidateLines();
 }
 
 
@@ -246,6 +277,102 @@ void TextConsole::SetRotation(DXGI_MODE_ROTATION rotation)
 }
 
 
+void TextConsole::InitializeQueue()
+{
+    static_assert((c_QueueSize & (c_QueueSize - 1)) == 0, "Queue size must be a power of 2");
+
+    m_queue = std::make_unique<Message[]>(c_QueueSize);
+    for (size_t j = 0; j < c_QueueSize; ++j)
+    {
+        m_queue[j].sequence.store(j, std::memory_order_relaxed);
+        m_queue[j].newLine = false;
+    }
+}
+
+
+// Bounded multi-producer queue (after Dmitry Vyukov's MPMC design). A slot whose sequence
+// equals the enqueue position is free; the consumer side runs under m_mutex.
+_Use_decl_annotations_
+void TextConsole::Enqueue(const wchar_t* str, bool newLine)
+{
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Message& msg = m_queue[pos & (c_QueueSize - 1)];
+        const size_t seq = msg.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+        if (diff == 0)
+        {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // Full: the render thread hasn't caught up
+            m_droppedMessages.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    Message& msg = m_queue[pos & (c_QueueSize - 1)];
+
+    bool stored = true;
+    try
+    {
+        msg.text.assign(str);
+    }
+    catch (...)
+    {
+        msg.text.clear();
+        stored = false;
+    }
+
+    msg.newLine = stored && newLine;
+    msg.sequence.store(pos + 1, std::memory_order_release);
+
+    if (stored)
+    {
+        m_queuedMessages.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        m_droppedMessages.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+
+void TextConsole::DrainQueue(bool process)
+{
+    if (!m_queue)
+        return;
+
+    for (;;)
+    {
+        Message& msg = m_queue[m_dequeuePos & (c_QueueSize - 1)];
+        if (msg.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1)
+            break;
+
+        if (process)
+        {
+            ProcessString(msg.text.c_str());
+
+            if (msg.newLine)
+            {
+                IncrementLine();
+            }
+        }
+
+        msg.sequence.store(m_dequeuePos + c_QueueSize, std::memory_order_release);
+        ++m_dequeuePos;
+    }
+}
+
+
 void TextConsole::ProcessString(_In_z_ const wchar_t* str)
 {
     if (!m_lines)
@@ -270,6 +397,7 @@ void TextConsole::ProcessString(_In_z_ const wchar_t* str)
         else
         {
             m_lines[m_currentLine][m_currentColumn] = *ch;
+            m_lineLayouts[m_currentLine].dirty = true;
 
             auto fontSize = m_font->MeasureString(m_lines[m_currentLine]);
             if (XMVectorGetX(fontSize) > width)
@@ -284,6 +412,7 @@ void TextConsole::ProcessString(_In_z_ const wchar_t* str)
         {
             IncrementLine();
             m_lines[m_currentLine][0] = *ch;
+            m_lineLayouts[m_currentLine].dirty = true;
         }
 
         ++m_currentColumn;
@@ -299,4 +428,34 @@ void TextConsole::IncrementLine()
     m_currentLine = (m_currentLine + 1) % m_rows;
     m_currentColumn = 0;
     memset(m_lines[m_currentLine], 0, sizeof(wchar_t) * (m_columns + 1));
+    m_lineLayouts[m_currentLine].dirty = true;
+}
+
+
+void TextConsole::InvalidateLines() noexcept
+{
+    if (!m_lineLayouts)
+        return;
+
+    for (unsigned int line = 0; line < m_rows; ++line)
+    {
+        m_lineLayouts[line].dirty = true;
+    }
+}
+
+
+void TextConsole::LayoutLine(unsigned int line)
+{
+    auto& layout = m_lineLayouts[line];
+
+    layout.quads.clear();
+
+    DX::ForEachGlyph<SpriteFont::Glyph>(m_lines[line], m_font->GetLineSpacing(),
+        [this](wchar_t character) { return m_font->FindGlyph(character); },
+        [&layout](SpriteFont::Glyph const* glyph, float x, float y, float)
+        {
+            layout.quads.push_back(GlyphQuad{ x, y + glyph->YOffset, glyph->Subrect });
+        }, true);
+
+    layout.dirty = false;
 }
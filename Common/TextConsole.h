@@ -6,6 +6,13 @@
 //
 // Note: This is best used with monospace rather than proportional fonts
 //
+// Each line caches its glyph quads, so Render only lays out lines that changed since the
+// previous frame and emits everything else straight to the sprite batch.
+//
+// Write, WriteLine, and Format are lock-free and may be called from any thread: text goes
+// into a bounded multi-producer queue that Render drains once per frame. When the queue is
+// full the message is dropped and counted rather than stalling the caller.
+//
 // Copyright (c) Microsoft Corporation.
 // Licensed under the MIT License.
 //--------------------------------------------------------------------------------------
@@ -15,8 +22,11 @@
 #include "SpriteBatch.h"
 #include "SpriteFont.h"
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 #include <wrl/client.h>
@@ -27,7 +37,7 @@ namespace DX
     class TextConsole
     {
     public:
-        TextConsole() noexcept;
+        TextConsole() noexcept(false);
         TextConsole(_In_ ID3D11DeviceContext* context, _In_z_ const wchar_t* fontName) noexcept(false);
 
         TextConsole(TextConsole&&) = delete;
@@ -57,9 +67,40 @@ namespace DX
 
         void SetRotation(DXGI_MODE_ROTATION rotation);
 
+        // Messages accepted into the queue, and messages dropped because it was full
+        uint64_t GetQueuedMessages() const noexcept { return m_queuedMessages.load(std::memory_order_relaxed); }
+        uint64_t GetDroppedMessages() const noexcept { return m_droppedMessages.load(std::memory_order_relaxed); }
+
     private:
+        static constexpr size_t c_QueueSize = 1024;
+
+        struct Message
+        {
+            std::atomic<size_t>     sequence;
+            std::wstring            text;
+            bool                    newLine;
+        };
+
+        struct GlyphQuad
+        {
+            float   x;
+            float   y;
+            RECT    source;
+        };
+
+        struct LineLayout
+        {
+            std::vector<GlyphQuad>  quads;
+            bool                    dirty = true;
+        };
+
+        void InitializeQueue();
+        void Enqueue(_In_z_ const wchar_t* str, bool newLine);
+        void DrainQueue(bool process);
         void ProcessString(_In_z_ const wchar_t* str);
         void IncrementLine();
+        void InvalidateLines() noexcept;
+        void LayoutLine(unsigned int line);
 
         RECT                                            m_layout;
         DirectX::XMFLOAT4                               m_textColor;
@@ -73,10 +114,16 @@ namespace DX
 
         std::unique_ptr<wchar_t[]>                      m_buffer;
         std::unique_ptr<wchar_t*[]>                     m_lines;
-        std::vector<wchar_t>                            m_tempBuffer;
+        std::unique_ptr<Message[]>                      m_queue;
+        std::atomic<size_t>                             m_enqueuePos;
+        size_t                                          m_dequeuePos;
+        std::atomic<uint64_t>                           m_queuedMessages;
+        std::atomic<uint64_t>                           m_droppedMessages;
+        std::unique_ptr<LineLayout[]>                   m_lineLayouts;
 
         std::unique_ptr<DirectX::SpriteBatch>           m_batch;
         std::unique_ptr<DirectX::SpriteFont>            m_font;
+        Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_spriteSheet;
         Microsoft::WRL::ComPtr<ID3D11DeviceContext>     m_context;
 
         std::mutex                                      m_mutex;
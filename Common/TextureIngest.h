@@ -0,0 +1,509 @@
+//--------------------------------------------------------------------------------------
+// File: TextureIngest.h
+//
+// Parallel, cached texture ingest for validating large texture collections
+//
+// Files are read by a small set of I/O threads and handed to a bounded pool of worker
+// threads that parse the DDS metadata (see DDSMetadata.h) and hash the contents, so
+// reads of later files overlap with parsing of earlier ones. The number of bytes read
+// but not yet processed is capped. A persistent cache keyed by path, size, and
+// last-write time lets unchanged files be skipped on later runs. Non-DDS files are
+// only hashed.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "DDSMetadata.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifndef ERROR_FILE_NOT_FOUND
+#define ERROR_FILE_NOT_FOUND 2L
+#endif
+
+
+namespace DX
+{
+    class TextureIngest
+    {
+    public:
+        struct Entry
+        {
+            std::filesystem::path   path;
+            uint64_t                fileSize;
+            int64_t                 writeTime;
+            uint64_t                contentHash;
+            HRESULT                 hr;             // Result of reading and parsing the file
+            bool                    isDDS;
+            bool                    cached;         // Taken from the cache without reading the file
+            DDSMetadata             metadata;       // Only valid if isDDS and SUCCEEDED(hr)
+        };
+
+        struct Stats
+        {
+            size_t      files;
+            size_t      filesRead;
+            size_t      cacheHits;
+            size_t      failures;
+            uint64_t    bytesRead;
+            uint64_t    bytesTotal;         // Including files skipped by the cache
+            size_t      maxBytesInFlight;   // High-water mark of bytes read but not yet processed
+            double      seconds;
+
+            double FilesPerSecond() const noexcept { return (seconds > 0) ? double(files) / seconds : 0.; }
+            double MBPerSecond() const noexcept { return (seconds > 0) ? double(bytesRead) / (1024.0 * 1024.0) / seconds : 0.; }
+        };
+
+        // 'workers' is the number of parse/hash threads (0 for the number of cores), 'ioThreads' the
+        // number of reader threads, and 'maxBytesInFlight' caps the file data held between the two.
+        explicit TextureIngest(size_t workers = 0, size_t ioThreads = 2, size_t maxBytesInFlight = 64 * 1024 * 1024) noexcept(false) :
+            m_workers(workers),
+            m_ioThreads(std::max<size_t>(ioThreads, 1)),
+            m_maxBytesInFlight(std::max<size_t>(maxBytesInFlight, 1)),
+            m_stats{}
+        {
+            if (!m_workers)
+            {
+                m_workers = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+            }
+        }
+
+        TextureIngest(TextureIngest&&) = default;
+        TextureIngest& operator= (TextureIngest&&) = default;
+
+        TextureIngest(TextureIngest const&) = delete;
+        TextureIngest& operator= (TextureIngest const&) = delete;
+
+        // Processes 'files' and returns one entry per file in the same order. Files whose
+        // size and last-write time match the cache are not read.
+        std::vector<Entry> Ingest(const std::vector<std::filesystem::path>& files)
+        {
+            const auto start = std::chrono::steady_clock::now();
+
+            m_stats = {};
+            m_stats.files = files.size();
+
+            std::vector<Entry> results(files.size());
+            std::vector<size_t> pending;
+            pending.reserve(files.size());
+
+            for (size_t j = 0; j < files.size(); ++j)
+            {
+                Entry& entry = results[j];
+                entry.path = files[j];
+                entry.isDDS = IsDDS(files[j]);
+
+                std::error_code ec;
+                entry.fileSize = std::filesystem::file_size(files[j], ec);
+                if (!ec)
+                {
+                    entry.writeTime = static_cast<int64_t>(std::filesystem::last_write_time(files[j], ec).time_since_epoch().count());
+                }
+
+                if (ec)
+                {
+                    entry.hr = E_FAIL;
+                    continue;
+                }
+
+                m_stats.bytesTotal += entry.fileSize;
+
+                auto it = m_cache.find(files[j].native());
+                if (it != m_cache.end()
+                    && it->second.fileSize == entry.fileSize
+                    && it->second.writeTime == entry.writeTime)
+                {
+                    entry = it->second;
+                    entry.path = files[j];
+                    entry.cached = true;
+                    continue;
+                }
+
+                pending.push_back(j);
+            }
+
+            Process(results, pending);
+
+            for (auto& entry : results)
+            {
+                if (entry.cached)
+                {
+                    ++m_stats.cacheHits;
+                }
+                if (FAILED(entry.hr))
+                {
+                    ++m_stats.failures;
+                }
+                else
+                {
+                    m_cache[entry.path.native()] = entry;
+                }
+            }
+
+            m_stats.filesRead = pending.size();
+
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            m_stats.seconds = elapsed.count();
+
+            return results;
+        }
+
+        const Stats& GetStats() const noexcept { return m_stats; }
+
+        void ClearCache() noexcept { m_cache.clear(); }
+        size_t GetCacheSize() const noexcept { return m_cache.size(); }
+
+        // The cache file stores native paths, so it is only meaningful on the platform that wrote it.
+        HRESULT LoadCache(const std::filesystem::path& cacheFile)
+        {
+            m_cache.clear();
+
+            std::ifstream inFile(cacheFile, std::ios::in | std::ios::binary);
+            if (!inFile)
+                return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+
+            uint64_t magic = 0;
+            uint64_t count = 0;
+            inFile.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+            inFile.read(reinterpret_cast<char*>(&count), sizeof(count));
+            if (!inFile || magic != c_CacheMagic)
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+            for (uint64_t j = 0; j < count; ++j)
+            {
+                uint32_t length = 0;
+                inFile.read(reinterpret_cast<char*>(&length), sizeof(length));
+                if (!inFile || length > c_MaxCachedPath)
+                {
+                    m_cache.clear();
+                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                }
+
+                std::filesystem::path::string_type name(length, 0);
+                inFile.read(reinterpret_cast<char*>(name.data()), std::streamsize(length) * std::streamsize(sizeof(name[0])));
+
+                CacheRecord record = {};
+                inFile.read(reinterpret_cast<char*>(&record), sizeof(record));
+                if (!inFile)
+                {
+                    m_cache.clear();
+                    return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+                }
+
+                Entry entry = {};
+                entry.path = name;
+                entry.fileSize = record.fileSize;
+                entry.writeTime = record.writeTime;
+                entry.contentHash = record.contentHash;
+                entry.hr = record.hr;
+                entry.isDDS = record.isDDS != 0;
+                entry.metadata = record.metadata;
+
+                m_cache.emplace(std::move(name), std::move(entry));
+            }
+
+            return S_OK;
+        }
+
+        HRESULT SaveCache(const std::filesystem::path& cacheFile) const
+        {
+            std::ofstream outFile(cacheFile, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!outFile)
+                return E_FAIL;
+
+            const uint64_t magic = c_CacheMagic;
+            const uint64_t count = m_cache.size();
+            outFile.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+            outFile.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+            for (const auto& it : m_cache)
+            {
+                const auto length = static_cast<uint32_t>(it.first.size());
+                outFile.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                outFile.write(reinterpret_cast<const char*>(it.first.data()), std::streamsize(length) * std::streamsize(sizeof(it.first[0])));
+
+                CacheRecord record = {};
+                record.fileSize = it.second.fileSize;
+                record.writeTime = it.second.writeTime;
+                record.contentHash = it.second.contentHash;
+                record.hr = it.second.hr;
+                record.isDDS = it.second.isDDS ? 1u : 0u;
+                record.metadata = it.second.metadata;
+                outFile.write(reinterpret_cast<const char*>(&record), sizeof(record));
+            }
+
+            outFile.close();
+            return outFile ? S_OK : E_FAIL;
+        }
+
+        // 64-bit content hash (xxHash64 algorithm, seed 0)
+        static uint64_t HashContent(_In_reads_bytes_(size) const uint8_t* data, size_t size) noexcept
+        {
+            constexpr uint64_t P1 = 0x9E3779B185EBCA87ull;
+            constexpr uint64_t P2 = 0xC2B2AE3D27D4EB4Full;
+            constexpr uint64_t P3 = 0x165667B19E3779F9ull;
+            constexpr uint64_t P4 = 0x85EBCA77C2B2AE63ull;
+            constexpr uint64_t P5 = 0x27D4EB2F165667C5ull;
+
+            auto rotl = [](uint64_t x, int r) noexcept { return (x << r) | (x >> (64 - r)); };
+            auto read64 = [](const uint8_t* p) noexcept { uint64_t v; memcpy(&v, p, sizeof(v)); return v; };
+            auto read32 = [](const uint8_t* p) noexcept { uint32_t v; memcpy(&v, p, sizeof(v)); return v; };
+            auto round = [&](uint64_t acc, uint64_t input) noexcept { acc += input * P2; acc = rotl(acc, 31); return acc * P1; };
+            auto merge = [&](uint64_t acc, uint64_t val) noexcept { acc ^= round(0, val); return acc * P1 + P4; };
+
+            const uint8_t* p = data;
+            const uint8_t* const end = data + size;
+
+            uint64_t h;
+            if (size >= 32)
+            {
+                uint64_t v1 = P1 + P2;
+                uint64_t v2 = P2;
+                uint64_t v3 = 0;
+                uint64_t v4 = 0 - P1;
+
+                const uint8_t* const limit = end - 32;
+                do
+                {
+                    v1 = round(v1, read64(p));
+                    v2 = round(v2, read64(p + 8));
+                    v3 = round(v3, read64(p + 16));
+                    v4 = round(v4, read64(p + 24));
+                    p += 32;
+                } while (p <= limit);
+
+                h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+                h = merge(h, v1);
+                h = merge(h, v2);
+                h = merge(h, v3);
+                h = merge(h, v4);
+            }
+            else
+            {
+                h = P5;
+            }
+
+            h += static_cast<uint64_t>(size);
+
+            for (; p + 8 <= end; p += 8)
+            {
+                h ^= round(0, read64(p));
+                h = rotl(h, 27) * P1 + P4;
+            }
+
+            if (p + 4 <= end)
+            {
+                h ^= static_cast<uint64_t>(read32(p)) * P1;
+                h = rotl(h, 23) * P2 + P3;
+                p += 4;
+            }
+
+            for (; p < end; ++p)
+            {
+                h ^= static_cast<uint64_t>(*p) * P5;
+                h = rotl(h, 11) * P1;
+            }
+
+            h ^= h >> 33;
+            h *= P2;
+            h ^= h >> 29;
+            h *= P3;
+            h ^= h >> 32;
+            return h;
+        }
+
+    private:
+        static constexpr uint64_t c_CacheMagic = 0x3130304348435854ull; // "TXCHC001"
+        static constexpr uint32_t c_MaxCachedPath = 32768;
+
+        struct CacheRecord
+        {
+            uint64_t    fileSize;
+            int64_t     writeTime;
+            uint64_t    contentHash;
+            HRESULT     hr;
+            uint32_t    isDDS;
+            DDSMetadata metadata;
+        };
+
+        struct Buffer
+        {
+            size_t                      index;
+            std::unique_ptr<uint8_t[]>  data;
+            size_t                      size;
+            HRESULT                     hr;
+        };
+
+        static bool IsDDS(const std::filesystem::path& path)
+        {
+            auto ext = path.extension().native();
+            for (auto& c : ext)
+            {
+                if (c >= 'A' && c <= 'Z')
+                    c = static_cast<std::filesystem::path::value_type>(c - 'A' + 'a');
+            }
+            return ext == std::filesystem::path(".dds").native();
+        }
+
+        void Process(std::vector<Entry>& results, const std::vector<size_t>& pending)
+        {
+            if (pending.empty())
+                return;
+
+            std::mutex mutex;
+            std::condition_variable readyCV;    // Signaled when a buffer is queued or reading is done
+            std::condition_variable spaceCV;    // Signaled when bytes in flight drop
+            std::deque<Buffer> ready;
+            size_t bytesInFlight = 0;
+            size_t readersDone = 0;
+            uint64_t bytesRead = 0;
+
+            std::atomic<size_t> nextRead(0);
+
+            const size_t ioThreads = std::min(m_ioThreads, pending.size());
+            const size_t workers = std::min(m_workers, pending.size());
+
+            auto reader = [&]()
+            {
+                for (;;)
+                {
+                    const size_t slot = nextRead++;
+                    if (slot >= pending.size())
+                        break;
+
+                    Buffer buffer = {};
+                    buffer.index = pending[slot];
+
+                    const auto fileSize = static_cast<size_t>(results[buffer.index].fileSize);
+                    const size_t charge = std::min(fileSize, m_maxBytesInFlight);
+
+                    // Wait for room in the budget; a single file larger than the budget still proceeds alone
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        spaceCV.wait(lock, [&] { return bytesInFlight == 0 || bytesInFlight + charge <= m_maxBytesInFlight; });
+                        bytesInFlight += charge;
+                        m_stats.maxBytesInFlight = std::max(m_stats.maxBytesInFlight, bytesInFlight);
+                    }
+
+                    buffer.hr = ReadFile(results[buffer.index].path, fileSize, buffer.data, buffer.size);
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        bytesRead += buffer.size;
+                        ready.emplace_back(std::move(buffer));
+                    }
+                    readyCV.notify_one();
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    ++readersDone;
+                }
+                readyCV.notify_all();
+            };
+
+            auto worker = [&]()
+            {
+                for (;;)
+                {
+                    Buffer buffer;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        readyCV.wait(lock, [&] { return !ready.empty() || readersDone == ioThreads; });
+                        if (ready.empty())
+                            break;
+
+                        buffer = std::move(ready.front());
+                        ready.pop_front();
+                    }
+
+                    Entry& entry = results[buffer.index];
+                    entry.hr = buffer.hr;
+                    if (SUCCEEDED(buffer.hr))
+                    {
+                        entry.contentHash = HashContent(buffer.data.get(), buffer.size);
+
+                        if (entry.isDDS)
+                        {
+                            entry.hr = (buffer.size > 0) ? GetDDSMetadata(buffer.data.get(), buffer.size, entry.metadata) : E_FAIL;
+                        }
+                    }
+
+                    const size_t charge = std::min(static_cast<size_t>(entry.fileSize), m_maxBytesInFlight);
+                    buffer.data.reset();
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        bytesInFlight -= charge;
+                    }
+                    spaceCV.notify_all();
+                }
+            };
+
+            std::vector<std::thread> threads;
+            threads.reserve(ioThreads + workers);
+            for (size_t j = 0; j < ioThreads; ++j)
+            {
+                threads.emplace_back(reader);
+            }
+            for (size_t j = 0; j < workers; ++j)
+            {
+                threads.emplace_back(worker);
+            }
+
+            for (auto& t : threads)
+            {
+                t.join();
+            }
+
+            m_stats.bytesRead = bytesRead;
+        }
+
+        static HRESULT ReadFile(const std::filesystem::path& path, size_t expectedSize, std::unique_ptr<uint8_t[]>& data, size_t& size) noexcept
+        {
+            size = 0;
+
+            std::ifstream inFile(path, std::ios::in | std::ios::binary);
+            if (!inFile)
+                return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+
+            if (!expectedSize)
+                return S_OK;
+
+            data.reset(new (std::nothrow) uint8_t[expectedSize]);
+            if (!data)
+                return E_OUTOFMEMORY;
+
+            inFile.read(reinterpret_cast<char*>(data.get()), static_cast<std::streamsize>(expectedSize));
+            size = static_cast<size_t>(inFile.gcount());
+
+            return (size == expectedSize) ? S_OK : HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+        }
+
+        size_t                                                          m_workers;
+        size_t                                                          m_ioThreads;
+        size_t                                                          m_maxBytesInFlight;
+        Stats                                                           m_stats;
+        std::unordered_map<std::filesystem::path::string_type, Entry>   m_cache;
+    };
+}
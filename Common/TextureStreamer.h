@@ -0,0 +1,589 @@
+//--------------------------------------------------------------------------------------
+// File: TextureStreamer.h
+//
+// Mip-chain streaming for large 2D DDS textures under a memory budget
+//
+// Loading a texture reads only the DDS header and the low-resolution mip tail, which
+// stays resident. Higher mips are requested per frame and read on demand with
+// byte-range reads computed from the DDS layout (see DDSMetadata.h). Direct3D 11 can't
+// partially commit a texture, so each texture is recreated at its resident size: mips
+// already on the GPU are copied across and only the missing ones are read from disk.
+// When the budget is exceeded, mips of the least recently used textures are evicted.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "DDSMetadata.h"
+
+#include <d3d11_1.h>
+
+#include <wrl/client.h>
+#include <wrl/wrappers/corewrappers.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace DX
+{
+    class TextureStreamer
+    {
+    public:
+        using Handle = uint32_t;
+
+        static constexpr Handle c_InvalidHandle = 0;
+
+        struct Stats
+        {
+            size_t      textures;
+            uint64_t    budgetBytes;
+            uint64_t    residentBytes;
+            uint64_t    peakResidentBytes;
+            uint64_t    tailBytes;          // Always-resident mip tails (included in residentBytes)
+            uint64_t    fullBytes;          // What every texture would use with all mips resident
+            uint64_t    bytesRead;          // Texture data read from disk, excluding headers
+            uint64_t    readsIssued;
+            uint64_t    mipsLoaded;
+            uint64_t    mipsEvicted;
+            uint64_t    evictions;          // Textures trimmed to make room for others
+            uint64_t    requestsDeferred;   // Upgrades that could not be fully satisfied within the budget
+        };
+
+        // 'tailDimension' is the largest mip size that is loaded up front. 'maxBytesPerUpdate'
+        // limits how much data each Update reads from disk (0 for unlimited).
+        TextureStreamer(_In_ ID3D11Device* device, uint64_t budgetBytes, uint32_t tailDimension = 128, uint64_t maxBytesPerUpdate = 0) noexcept(false) :
+            m_device(device),
+            m_tailDimension(std::max<uint32_t>(tailDimension, 1)),
+            m_maxBytesPerUpdate(maxBytesPerUpdate),
+            m_frame(0),
+            m_stats{}
+        {
+            if (!device)
+                throw std::invalid_argument("TextureStreamer");
+
+            m_stats.budgetBytes = budgetBytes;
+        }
+
+        TextureStreamer(TextureStreamer&&) = default;
+        TextureStreamer& operator= (TextureStreamer&&) = default;
+
+        TextureStreamer(TextureStreamer const&) = delete;
+        TextureStreamer& operator= (TextureStreamer const&) = delete;
+
+        // Reads the header and mip tail of a 2D, 2D array, or cubemap DDS file. Other
+        // dimensions return ERROR_NOT_SUPPORTED and should use DDSTextureLoader instead.
+        HRESULT Load(_In_z_ const wchar_t* fileName, _Out_ Handle* handle)
+        {
+            if (!fileName || !handle)
+                return E_INVALIDARG;
+
+            *handle = c_InvalidHandle;
+
+            Microsoft::WRL::Wrappers::FileHandle hFile(CreateFileW(fileName,
+                GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+            if (!hFile.IsValid())
+                return HRESULT_FROM_WIN32(GetLastError());
+
+            LARGE_INTEGER fileSize = {};
+            if (!GetFileSizeEx(hFile.Get(), &fileSize))
+                return HRESULT_FROM_WIN32(GetLastError());
+
+            uint8_t header[DDS_MAX_HEADER_SIZE] = {};
+            const size_t headerSize = static_cast<size_t>(std::min<int64_t>(fileSize.QuadPart, DDS_MAX_HEADER_SIZE));
+            HRESULT hr = ReadRange(hFile.Get(), 0, headerSize, header, false);
+            if (FAILED(hr))
+                return hr;
+
+            auto tex = std::make_unique<Texture>();
+            tex->fileName = fileName;
+
+            hr = GetDDSMetadata(header, headerSize, static_cast<uint64_t>(fileSize.QuadPart), tex->metadata, &tex->layout);
+            if (FAILED(hr))
+                return hr;
+
+            if (tex->metadata.dimension != DDS_DIMENSION_TEXTURE2D)
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+            const uint32_t mipLevels = tex->metadata.mipLevels;
+
+            uint32_t tailMip = 0;
+            while (tailMip + 1 < mipLevels
+                && std::max(tex->layout[tailMip].width, tex->layout[tailMip].height) > m_tailDimension)
+            {
+                ++tailMip;
+            }
+            tailMip = ValidTopMip(*tex, tailMip);
+
+            tex->tailMip = tex->residentMip = tex->requestedMip = tailMip;
+            tex->lastUsed = m_frame;
+
+            // The tail of each array item is one contiguous range of the file
+            std::vector<std::unique_ptr<uint8_t[]>> itemData;
+            std::vector<D3D11_SUBRESOURCE_DATA> initData;
+            initData.reserve(size_t(tex->metadata.depthOrArraySize) * (mipLevels - tailMip));
+
+            for (uint32_t item = 0; item < tex->metadata.depthOrArraySize; ++item)
+            {
+                uint64_t offset;
+                size_t size;
+                ItemRange(*tex, item, tailMip, mipLevels, offset, size);
+
+                itemData.emplace_back(new (std::nothrow) uint8_t[size]);
+                if (!itemData.back())
+                    return E_OUTOFMEMORY;
+
+                hr = ReadRange(hFile.Get(), offset, size, itemData.back().get(), true);
+                if (FAILED(hr))
+                    return hr;
+
+                for (uint32_t mip = tailMip; mip < mipLevels; ++mip)
+                {
+                    const DDSSubresource& sub = tex->layout[size_t(item) * mipLevels + mip];
+
+                    D3D11_SUBRESOURCE_DATA data = {};
+                    data.pSysMem = itemData.back().get() + (sub.offset - offset);
+                    data.SysMemPitch = static_cast<UINT>(sub.rowPitch);
+                    data.SysMemSlicePitch = static_cast<UINT>(sub.slicePitch);
+                    initData.push_back(data);
+                }
+            }
+
+            hr = CreateTexture(*tex, tailMip, initData.data(), tex->texture.GetAddressOf(), tex->srv.GetAddressOf());
+            if (FAILED(hr))
+                return hr;
+
+            const uint64_t tailBytes = MipBytes(*tex, tailMip);
+            m_stats.tailBytes += tailBytes;
+            m_stats.fullBytes += MipBytes(*tex, 0);
+            AddResident(tailBytes);
+            ++m_stats.textures;
+
+            m_textures.emplace_back(std::move(tex));
+            *handle = static_cast<Handle>(m_textures.size());
+
+            return S_OK;
+        }
+
+        void Unload(Handle handle) noexcept
+        {
+            Texture* tex = Get(handle);
+            if (!tex)
+                return;
+
+            m_stats.residentBytes -= MipBytes(*tex, tex->residentMip);
+            m_stats.tailBytes -= MipBytes(*tex, tex->tailMip);
+            m_stats.fullBytes -= MipBytes(*tex, 0);
+            --m_stats.textures;
+
+            m_textures[handle - 1].reset();
+        }
+
+        // Asks for 'mip' (0 is full resolution) to be resident and marks the texture as used
+        // this frame. Requests coarser than the tail are clamped to the tail.
+        void Request(Handle handle, uint32_t mip) noexcept
+        {
+            Texture* tex = Get(handle);
+            if (!tex)
+                return;
+
+            tex->requestedMip = ValidTopMip(*tex, std::min(mip, tex->tailMip));
+            tex->lastUsed = m_frame;
+        }
+
+        // Loads the mips requested this frame, most under-resolved textures first, evicting
+        // from textures that were not used this frame (or hold more than they asked for)
+        // when over budget. Then starts a new frame.
+        HRESULT Update(_In_ ID3D11DeviceContext* context)
+        {
+            if (!context)
+                return E_INVALIDARG;
+
+            std::vector<Texture*> wanted;
+            for (auto& it : m_textures)
+            {
+                if (it && it->lastUsed == m_frame && it->requestedMip < it->residentMip)
+                    wanted.push_back(it.get());
+            }
+
+            std::stable_sort(wanted.begin(), wanted.end(), [](const Texture* a, const Texture* b)
+                {
+                    return (a->residentMip - a->requestedMip) > (b->residentMip - b->requestedMip);
+                });
+
+            uint64_t readBudget = m_maxBytesPerUpdate ? m_maxBytesPerUpdate : UINT64_MAX;
+            bool readAny = false;
+
+            for (Texture* tex : wanted)
+            {
+                const uint64_t current = MipBytes(*tex, tex->residentMip);
+
+                uint32_t target = tex->requestedMip;
+                for (;;)
+                {
+                    // A single mip step is always allowed so mips larger than the read limit still load
+                    const uint64_t added = MipBytes(*tex, target) - current;
+                    if (added <= readBudget || (!readAny && NextCoarserTopMip(*tex, target) == tex->residentMip))
+                    {
+                        while (m_stats.residentBytes + added > m_stats.budgetBytes)
+                        {
+                            if (!EvictOne(context, tex))
+                                break;
+                        }
+
+                        if (m_stats.residentBytes + added <= m_stats.budgetBytes)
+                            break;
+                    }
+
+                    // Settle for a coarser mip than requested
+                    target = NextCoarserTopMip(*tex, target);
+                    if (target >= tex->residentMip)
+                        break;
+                }
+
+                if (target != tex->requestedMip)
+                {
+                    ++m_stats.requestsDeferred;
+                }
+
+                if (target >= tex->residentMip)
+                    continue;
+
+                const uint64_t added = MipBytes(*tex, target) - current;
+                HRESULT hr = Rebuild(context, *tex, target);
+                if (FAILED(hr))
+                    return hr;
+
+                readBudget -= std::min(added, readBudget);
+                readAny = true;
+            }
+
+            ++m_frame;
+            return S_OK;
+        }
+
+        ID3D11ShaderResourceView* GetSRV(Handle handle) const noexcept
+        {
+            const Texture* tex = Get(handle);
+            return tex ? tex->srv.Get() : nullptr;
+        }
+
+        ID3D11Texture2D* GetTexture(Handle handle) const noexcept
+        {
+            const Texture* tex = Get(handle);
+            return tex ? tex->texture.Get() : nullptr;
+        }
+
+        // Most detailed resident mip in terms of the full mip chain (0 when fully resident)
+        uint32_t GetResidentMip(Handle handle) const noexcept
+        {
+            const Texture* tex = Get(handle);
+            return tex ? tex->residentMip : 0;
+        }
+
+        uint32_t GetTailMip(Handle handle) const noexcept
+        {
+            const Texture* tex = Get(handle);
+            return tex ? tex->tailMip : 0;
+        }
+
+        const DDSMetadata* GetMetadata(Handle handle) const noexcept
+        {
+            const Texture* tex = Get(handle);
+            return tex ? &tex->metadata : nullptr;
+        }
+
+        void SetBudget(uint64_t budgetBytes) noexcept { m_stats.budgetBytes = budgetBytes; }
+
+        const Stats& GetStats() const noexcept { return m_stats; }
+
+    private:
+        struct Texture
+        {
+            std::wstring                                        fileName;
+            DDSMetadata                                         metadata;
+            std::vector<DDSSubresource>                         layout;
+            uint32_t                                            tailMip;
+            uint32_t                                            residentMip;
+            uint32_t                                            requestedMip;
+            uint64_t                                            lastUsed;
+            Microsoft::WRL::ComPtr<ID3D11Texture2D>             texture;
+            Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>    srv;
+        };
+
+        Texture* Get(Handle handle) const noexcept
+        {
+            if (handle == c_InvalidHandle || handle > m_textures.size())
+                return nullptr;
+
+            return m_textures[handle - 1].get();
+        }
+
+        static bool IsBlockCompressed(DXGI_FORMAT format) noexcept
+        {
+            return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM)
+                || (format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+        }
+
+        // Direct3D 11 requires the top mip of a block-compressed texture to be a multiple of 4
+        static uint32_t ValidTopMip(const Texture& tex, uint32_t mip) noexcept
+        {
+            if (IsBlockCompressed(tex.metadata.format))
+            {
+                while (mip > 0 && ((tex.layout[mip].width % 4) != 0 || (tex.layout[mip].height % 4) != 0))
+                    --mip;
+            }
+            return mip;
+        }
+
+        static uint32_t NextCoarserTopMip(const Texture& tex, uint32_t mip) noexcept
+        {
+            for (uint32_t next = mip + 1; next < tex.residentMip; ++next)
+            {
+                if (ValidTopMip(tex, next) == next)
+                    return next;
+            }
+            return tex.residentMip;
+        }
+
+        static uint64_t MipBytes(const Texture& tex, uint32_t firstMip) noexcept
+        {
+            uint64_t total = 0;
+            for (uint32_t mip = firstMip; mip < tex.metadata.mipLevels; ++mip)
+            {
+                total += uint64_t(tex.layout[mip].slicePitch) * tex.layout[mip].depth;
+            }
+            return total * tex.metadata.depthOrArraySize;
+        }
+
+        // Mips [firstMip, lastMip) of one array item are stored contiguously
+        static void ItemRange(const Texture& tex, uint32_t item, uint32_t firstMip, uint32_t lastMip, uint64_t& offset, size_t& size) noexcept
+        {
+            const size_t base = size_t(item) * tex.metadata.mipLevels;
+            const DDSSubresource& first = tex.layout[base + firstMip];
+            const DDSSubresource& last = tex.layout[base + lastMip - 1];
+
+            offset = first.offset;
+            size = static_cast<size_t>(last.offset + uint64_t(last.slicePitch) * last.depth - first.offset);
+        }
+
+        HRESULT ReadRange(HANDLE hFile, uint64_t offset, size_t size, _Out_writes_bytes_(size) uint8_t* data, bool countStats) noexcept
+        {
+            if (size > UINT32_MAX)
+                return HRESULT_FROM_WIN32(ERROR_FILE_TOO_LARGE);
+
+            OVERLAPPED ov = {};
+            ov.Offset = static_cast<DWORD>(offset);
+            ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+            DWORD bytesRead = 0;
+            if (!ReadFile(hFile, data, static_cast<DWORD>(size), &bytesRead, &ov))
+                return HRESULT_FROM_WIN32(GetLastError());
+
+            if (bytesRead != size)
+                return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+            if (countStats)
+            {
+                ++m_stats.readsIssued;
+                m_stats.bytesRead += size;
+            }
+
+            return S_OK;
+        }
+
+        HRESULT CreateTexture(const Texture& tex, uint32_t topMip, _In_opt_ const D3D11_SUBRESOURCE_DATA* initData,
+            _Outptr_ ID3D11Texture2D** texture, _Outptr_ ID3D11ShaderResourceView** srv) const
+        {
+            const bool isCube = (tex.metadata.miscFlags & DDS_MISC_TEXTURECUBE) != 0;
+            const uint32_t mipLevels = tex.metadata.mipLevels - topMip;
+            const uint32_t arraySize = tex.metadata.depthOrArraySize;
+
+            D3D11_TEXTURE2D_DESC desc = {};
+            desc.Width = tex.layout[topMip].width;
+            desc.Height = tex.layout[topMip].height;
+            desc.MipLevels = mipLevels;
+            desc.ArraySize = arraySize;
+            desc.Format = tex.metadata.format;
+            desc.SampleDesc.Count = 1;
+            desc.Usage = D3D11_USAGE_DEFAULT;
+            desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+            desc.MiscFlags = isCube ? static_cast<UINT>(D3D11_RESOURCE_MISC_TEXTURECUBE) : 0u;
+
+            Microsoft::WRL::ComPtr<ID3D11Texture2D> result;
+            HRESULT hr = m_device->CreateTexture2D(&desc, initData, result.GetAddressOf());
+            if (FAILED(hr))
+                return hr;
+
+            D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+            srvDesc.Format = desc.Format;
+            if (isCube && arraySize > 6)
+            {
+                srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBEARRAY;
+                srvDesc.TextureCubeArray.MipLevels = mipLevels;
+                srvDesc.TextureCubeArray.NumCubes = arraySize / 6;
+            }
+            else if (isCube)
+            {
+                srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+                srvDesc.TextureCube.MipLevels = mipLevels;
+            }
+            else if (arraySize > 1)
+            {
+                srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+                srvDesc.Texture2DArray.MipLevels = mipLevels;
+                srvDesc.Texture2DArray.ArraySize = arraySize;
+            }
+            else
+            {
+                srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+                srvDesc.Texture2D.MipLevels = mipLevels;
+            }
+
+            hr = m_device->CreateShaderResourceView(result.Get(), &srvDesc, srv);
+            if (FAILED(hr))
+                return hr;
+
+            *texture = result.Detach();
+            return S_OK;
+        }
+
+        // Recreates 'tex' with 'topMip' as its most detailed mip, copying the mips both versions
+        // share on the GPU and reading any new ones from disk.
+        HRESULT Rebuild(_In_ ID3D11DeviceContext* context, Texture& tex, uint32_t topMip)
+        {
+            if (topMip == tex.residentMip)
+                return S_OK;
+
+            Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+            Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+            HRESULT hr = CreateTexture(tex, topMip, nullptr, texture.GetAddressOf(), srv.GetAddressOf());
+            if (FAILED(hr))
+                return hr;
+
+            const uint32_t mipLevels = tex.metadata.mipLevels;
+            const uint32_t newMips = mipLevels - topMip;
+            const uint32_t oldMips = mipLevels - tex.residentMip;
+
+            if (topMip < tex.residentMip)
+            {
+                Microsoft::WRL::Wrappers::FileHandle hFile(CreateFileW(tex.fileName.c_str(),
+                    GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+                if (!hFile.IsValid())
+                    return HRESULT_FROM_WIN32(GetLastError());
+
+                std::unique_ptr<uint8_t[]> data;
+                size_t capacity = 0;
+
+                for (uint32_t item = 0; item < tex.metadata.depthOrArraySize; ++item)
+                {
+                    uint64_t offset;
+                    size_t size;
+                    ItemRange(tex, item, topMip, tex.residentMip, offset, size);
+
+                    if (size > capacity)
+                    {
+                        data.reset(new (std::nothrow) uint8_t[size]);
+                        if (!data)
+                            return E_OUTOFMEMORY;
+                        capacity = size;
+                    }
+
+                    hr = ReadRange(hFile.Get(), offset, size, data.get(), true);
+                    if (FAILED(hr))
+                        return hr;
+
+                    for (uint32_t mip = topMip; mip < tex.residentMip; ++mip)
+                    {
+                        const DDSSubresource& sub = tex.layout[size_t(item) * mipLevels + mip];
+                        context->UpdateSubresource(texture.Get(), D3D11CalcSubresource(mip - topMip, item, newMips), nullptr,
+                            data.get() + (sub.offset - offset), static_cast<UINT>(sub.rowPitch), static_cast<UINT>(sub.slicePitch));
+                    }
+                }
+
+                m_stats.mipsLoaded += tex.residentMip - topMip;
+            }
+            else
+            {
+                m_stats.mipsEvicted += topMip - tex.residentMip;
+            }
+
+            const uint32_t firstShared = std::max(topMip, tex.residentMip);
+            for (uint32_t item = 0; item < tex.metadata.depthOrArraySize; ++item)
+            {
+                for (uint32_t mip = firstShared; mip < mipLevels; ++mip)
+                {
+                    context->CopySubresourceRegion(
+                        texture.Get(), D3D11CalcSubresource(mip - topMip, item, newMips), 0, 0, 0,
+                        tex.texture.Get(), D3D11CalcSubresource(mip - tex.residentMip, item, oldMips), nullptr);
+                }
+            }
+
+            const uint64_t before = MipBytes(tex, tex.residentMip);
+            const uint64_t after = MipBytes(tex, topMip);
+
+            tex.texture.Swap(texture);
+            tex.srv.Swap(srv);
+            tex.residentMip = topMip;
+
+            m_stats.residentBytes -= before;
+            AddResident(after);
+
+            return S_OK;
+        }
+
+        // Trims the least recently used texture that holds more than it needs
+        bool EvictOne(_In_ ID3D11DeviceContext* context, const Texture* exclude)
+        {
+            Texture* victim = nullptr;
+            uint32_t victimTop = 0;
+
+            for (auto& it : m_textures)
+            {
+                Texture* tex = it.get();
+                if (!tex || tex == exclude || tex->residentMip >= tex->tailMip)
+                    continue;
+
+                const uint32_t keep = (tex->lastUsed < m_frame) ? tex->tailMip : tex->requestedMip;
+                if (keep <= tex->residentMip)
+                    continue;
+
+                if (!victim || tex->lastUsed < victim->lastUsed)
+                {
+                    victim = tex;
+                    victimTop = keep;
+                }
+            }
+
+            if (!victim)
+                return false;
+
+            if (FAILED(Rebuild(context, *victim, victimTop)))
+                return false;
+
+            ++m_stats.evictions;
+            return true;
+        }
+
+        void AddResident(uint64_t bytes) noexcept
+        {
+            m_stats.residentBytes += bytes;
+            m_stats.peakResidentBytes = std::max(m_stats.peakResidentBytes, m_stats.residentBytes);
+        }
+
+        Microsoft::WRL::ComPtr<ID3D11Device>    m_device;
+        uint32_t                                m_tailDimension;
+        uint64_t                                m_maxBytesPerUpdate;
+        uint64_t                                m_frame;
+        Stats                                   m_stats;
+        std::vector<std::unique_ptr<Texture>>   m_textures;
+    };
+}
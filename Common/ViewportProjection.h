@@ -0,0 +1,353 @@
+//--------------------------------------------------------------------------------------
+// File: ViewportProjection.h
+//
+// Batch versions of SimpleMath::Viewport::Project and Unproject for large point sets
+//
+// Viewport::Project multiplies world, view and projection for every call. Here they are
+// folded, together with the viewport mapping, into a single matrix up front, so that each
+// point costs one transform and one divide. Points stream straight through SimpleMath
+// Vector3 arrays: each block of 4 (or 8 with AVX) points is transposed into registers,
+// transformed with the SoAMath lane operations, and transposed back.
+//
+// Project can also report which points lie in front of the near plane (including points
+// behind the eye); their screen positions are not meaningful. The mask has one bit per
+// point: bit (j % 32) of word (j / 32), with NearClipWords(count) words written.
+//
+// Results match the per-point Viewport calls within floating-point rounding. 'result' may
+// be the same array as 'points'.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SoAMath.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_XM_ARM_NEON_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+#include <arm_neon.h>
+#endif
+
+
+namespace DX
+{
+    class ViewportProjection
+    {
+    public:
+        // Identity; points pass through unchanged and none are clipped
+        ViewportProjection() noexcept : m_near(0.f, 0.f, 0.f, 1.f) {}
+
+        ViewportProjection(
+            const DirectX::SimpleMath::Viewport& viewport,
+            const DirectX::SimpleMath::Matrix& proj,
+            const DirectX::SimpleMath::Matrix& view,
+            const DirectX::SimpleMath::Matrix& world) noexcept;
+
+        ViewportProjection(ViewportProjection&&) = default;
+        ViewportProjection& operator= (ViewportProjection&&) = default;
+
+        ViewportProjection(ViewportProjection const&) = default;
+        ViewportProjection& operator= (ViewportProjection const&) = default;
+
+        // Returns the number of points in front of the near plane
+        size_t Project(
+            _In_reads_(count) const DirectX::SimpleMath::Vector3* points,
+            size_t count,
+            _Out_writes_(count) DirectX::SimpleMath::Vector3* result,
+            _Out_writes_opt_(NearClipWords(count)) uint32_t* nearClip = nullptr) const;
+
+        void Unproject(
+            _In_reads_(count) const DirectX::SimpleMath::Vector3* points,
+            size_t count,
+            _Out_writes_(count) DirectX::SimpleMath::Vector3* result) const;
+
+        // Object space to screen, and back; Vector3::Transform by these matches Project/Unproject
+        const DirectX::SimpleMath::Matrix& GetProjectMatrix() const noexcept { return m_project; }
+        const DirectX::SimpleMath::Matrix& GetUnprojectMatrix() const noexcept { return m_unproject; }
+
+        static constexpr size_t NearClipWords(size_t count) noexcept { return (count + 31) / 32; }
+
+        static bool IsNearClipped(_In_ const uint32_t* nearClip, size_t index) noexcept
+        {
+            return (nearClip[index / 32] >> (index % 32)) & 1u;
+        }
+
+    private:
+        DirectX::SimpleMath::Matrix     m_project;
+        DirectX::SimpleMath::Matrix     m_unproject;
+        DirectX::SimpleMath::Vector4    m_near;     // Clip-space z as a function of object position
+    };
+
+    // Array overloads with the same arguments as Viewport::Project and Viewport::Unproject
+    size_t ProjectPoints(
+        const DirectX::SimpleMath::Viewport& viewport,
+        _In_reads_(count) const DirectX::SimpleMath::Vector3* points,
+        size_t count,
+        const DirectX::SimpleMath::Matrix& proj,
+        const DirectX::SimpleMath::Matrix& view,
+        const DirectX::SimpleMath::Matrix& world,
+        _Out_writes_(count) DirectX::SimpleMath::Vector3* result,
+        _Out_writes_opt_(ViewportProjection::NearClipWords(count)) uint32_t* nearClip = nullptr);
+
+    void UnprojectPoints(
+        const DirectX::SimpleMath::Viewport& viewport,
+        _In_reads_(count) const DirectX::SimpleMath::Vector3* points,
+        size_t count,
+        const DirectX::SimpleMath::Matrix& proj,
+        const DirectX::SimpleMath::Matrix& view,
+        const DirectX::SimpleMath::Matrix& world,
+        _Out_writes_(count) DirectX::SimpleMath::Vector3* result);
+
+
+    //==================================================================================
+    // Implementation
+    //==================================================================================
+
+    namespace SoADetail
+    {
+        // Transposes four packed XMFLOAT3s into x, y and z registers and back
+        inline void XM_CALLCONV LoadPoints(_In_reads_(4) const DirectX::XMFLOAT3* p, DirectX::XMVECTOR& x, DirectX::XMVECTOR& y, DirectX::XMVECTOR& z) noexcept
+        {
+        #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            const float* f = &p->x;
+            const __m128 a = _mm_loadu_ps(f);                                   // x0 y0 z0 x1
+            const __m128 b = _mm_loadu_ps(f + 4);                               // y1 z1 x2 y2
+            const __m128 c = _mm_loadu_ps(f + 8);                               // z2 x3 y3 z3
+            const __m128 t0 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 3, 2));    // x2 y2 z2 x3
+            const __m128 t1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));    // y0 z0 y1 z1
+            const __m128 t2 = _mm_shuffle_ps(t0, c, _MM_SHUFFLE(3, 2, 2, 1));   // y2 z2 y3 z3
+            x = _mm_shuffle_ps(a, t0, _MM_SHUFFLE(3, 0, 3, 0));
+            y = _mm_shuffle_ps(t1, t2, _MM_SHUFFLE(2, 0, 2, 0));
+            z = _mm_shuffle_ps(t1, t2, _MM_SHUFFLE(3, 1, 3, 1));
+        #elif defined(_XM_ARM_NEON_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            const float32x4x3_t v = vld3q_f32(&p->x);
+            x = v.val[0];
+            y = v.val[1];
+            z = v.val[2];
+        #else
+            x = DirectX::XMVectorSet(p[0].x, p[1].x, p[2].x, p[3].x);
+            y = DirectX::XMVectorSet(p[0].y, p[1].y, p[2].y, p[3].y);
+            z = DirectX::XMVectorSet(p[0].z, p[1].z, p[2].z, p[3].z);
+        #endif
+        }
+
+        inline void XM_CALLCONV StorePoints(_Out_writes_(4) DirectX::XMFLOAT3* p, DirectX::FXMVECTOR x, DirectX::FXMVECTOR y, DirectX::FXMVECTOR z) noexcept
+        {
+        #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            float* f = &p->x;
+            const __m128 xy0 = _mm_unpacklo_ps(x, y);                           // x0 y0 x1 y1
+            const __m128 xy1 = _mm_unpackhi_ps(x, y);                           // x2 y2 x3 y3
+            const __m128 t0 = _mm_shuffle_ps(z, xy0, _MM_SHUFFLE(2, 2, 0, 0));  // z0 z0 x1 x1
+            const __m128 t1 = _mm_shuffle_ps(xy0, z, _MM_SHUFFLE(1, 1, 3, 3));  // y1 y1 z1 z1
+            const __m128 t2 = _mm_shuffle_ps(z, xy1, _MM_SHUFFLE(2, 2, 2, 2));  // z2 z2 x3 x3
+            const __m128 t3 = _mm_shuffle_ps(xy1, z, _MM_SHUFFLE(3, 3, 3, 3));  // y3 y3 z3 z3
+            _mm_storeu_ps(f, _mm_shuffle_ps(xy0, t0, _MM_SHUFFLE(2, 0, 1, 0)));
+            _mm_storeu_ps(f + 4, _mm_shuffle_ps(t1, xy1, _MM_SHUFFLE(1, 0, 2, 0)));
+            _mm_storeu_ps(f + 8, _mm_shuffle_ps(t2, t3, _MM_SHUFFLE(2, 0, 2, 0)));
+        #elif defined(_XM_ARM_NEON_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            float32x4x3_t v;
+            v.val[0] = x;
+            v.val[1] = y;
+            v.val[2] = z;
+            vst3q_f32(&p->x, v);
+        #else
+            DirectX::XMFLOAT4 fx, fy, fz;
+            DirectX::XMStoreFloat4(&fx, x);
+            DirectX::XMStoreFloat4(&fy, y);
+            DirectX::XMStoreFloat4(&fz, z);
+            p[0] = DirectX::XMFLOAT3(fx.x, fy.x, fz.x);
+            p[1] = DirectX::XMFLOAT3(fx.y, fy.y, fz.y);
+            p[2] = DirectX::XMFLOAT3(fx.z, fy.z, fz.z);
+            p[3] = DirectX::XMFLOAT3(fx.w, fy.w, fz.w);
+        #endif
+        }
+
+    #ifdef DX_SOA_AVX
+        inline void XM_CALLCONV LoadPoints(_In_reads_(8) const DirectX::XMFLOAT3* p, __m256& x, __m256& y, __m256& z) noexcept
+        {
+            __m128 x0, y0, z0, x1, y1, z1;
+            LoadPoints(p, x0, y0, z0);
+            LoadPoints(p + 4, x1, y1, z1);
+            x = _mm256_insertf128_ps(_mm256_castps128_ps256(x0), x1, 1);
+            y = _mm256_insertf128_ps(_mm256_castps128_ps256(y0), y1, 1);
+            z = _mm256_insertf128_ps(_mm256_castps128_ps256(z0), z1, 1);
+        }
+
+        inline void XM_CALLCONV StorePoints(_Out_writes_(8) DirectX::XMFLOAT3* p, __m256 x, __m256 y, __m256 z) noexcept
+        {
+            StorePoints(p, _mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z));
+            StorePoints(p + 4, _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1));
+        }
+    #endif
+
+        inline size_t PopCount(uint32_t bits) noexcept
+        {
+            size_t count = 0;
+            for (; bits; bits &= bits - 1)
+                ++count;
+            return count;
+        }
+
+        // XMVector3TransformCoord over packed points; with 'nearPlane', also counts (and
+        // optionally flags) points whose clip-space z is negative
+        template<typename L>
+        size_t TransformPoints(
+            const DirectX::SimpleMath::Matrix& m,
+            _In_opt_ const DirectX::SimpleMath::Vector4* nearPlane,
+            _In_reads_(count) const DirectX::XMFLOAT3* points,
+            size_t count,
+            _Out_writes_(count) DirectX::XMFLOAT3* result,
+            _Out_writes_opt_((count + 31) / 32) uint32_t* nearClip)
+        {
+            using V = typename L::V;
+
+            const V m11 = L::Splat(m._11), m12 = L::Splat(m._12), m13 = L::Splat(m._13), m14 = L::Splat(m._14);
+            const V m21 = L::Splat(m._21), m22 = L::Splat(m._22), m23 = L::Splat(m._23), m24 = L::Splat(m._24);
+            const V m31 = L::Splat(m._31), m32 = L::Splat(m._32), m33 = L::Splat(m._33), m34 = L::Splat(m._34);
+            const V m41 = L::Splat(m._41), m42 = L::Splat(m._42), m43 = L::Splat(m._43), m44 = L::Splat(m._44);
+
+            const DirectX::SimpleMath::Vector4 np = nearPlane ? *nearPlane : DirectX::SimpleMath::Vector4(0.f, 0.f, 0.f, 0.f);
+            const V n1 = L::Splat(np.x), n2 = L::Splat(np.y), n3 = L::Splat(np.z), n4 = L::Splat(np.w);
+
+            size_t clipped = 0;
+            for (size_t j = 0; j < count; j += L::Width)
+            {
+                const size_t remaining = count - j;
+
+                // The last partial block goes through a local copy
+                DirectX::XMFLOAT3 tail[L::Width] = {};
+                const bool partial = remaining < L::Width;
+                if (partial)
+                {
+                    memcpy(tail, points + j, remaining * sizeof(DirectX::XMFLOAT3));
+                }
+
+                V x, y, z;
+                LoadPoints(partial ? tail : points + j, x, y, z);
+
+                const V w = L::MultiplyAdd(x, m14, L::MultiplyAdd(y, m24, L::MultiplyAdd(z, m34, m44)));
+                const V rx = L::Divide(L::MultiplyAdd(x, m11, L::MultiplyAdd(y, m21, L::MultiplyAdd(z, m31, m41))), w);
+                const V ry = L::Divide(L::MultiplyAdd(x, m12, L::MultiplyAdd(y, m22, L::MultiplyAdd(z, m32, m42))), w);
+                const V rz = L::Divide(L::MultiplyAdd(x, m13, L::MultiplyAdd(y, m23, L::MultiplyAdd(z, m33, m43))), w);
+
+                if (nearPlane)
+                {
+                    const V clipZ = L::MultiplyAdd(x, n1, L::MultiplyAdd(y, n2, L::MultiplyAdd(z, n3, n4)));
+                    uint32_t bits = L::Mask(L::Less(clipZ, L::Zero()));
+                    if (partial)
+                    {
+                        bits &= (1u << remaining) - 1u;
+                    }
+                    clipped += PopCount(bits);
+
+                    // Blocks never straddle a mask word, since 32 is a multiple of the width
+                    if (nearClip)
+                    {
+                        uint32_t& word = nearClip[j / 32];
+                        word = (j % 32) ? (word | (bits << (j % 32))) : bits;
+                    }
+                }
+
+                if (partial)
+                {
+                    StorePoints(tail, rx, ry, rz);
+                    memcpy(result + j, tail, remaining * sizeof(DirectX::XMFLOAT3));
+                }
+                else
+                {
+                    StorePoints(result + j, rx, ry, rz);
+                }
+            }
+
+            return clipped;
+        }
+    }
+
+    //----------------------------------------------------------------------------------
+    inline ViewportProjection::ViewportProjection(
+        const DirectX::SimpleMath::Viewport& viewport,
+        const DirectX::SimpleMath::Matrix& proj,
+        const DirectX::SimpleMath::Matrix& view,
+        const DirectX::SimpleMath::Matrix& world) noexcept
+    {
+        using DirectX::SimpleMath::Matrix;
+
+        const Matrix wvp = world * view * proj;
+
+        // Same scale and offset as XMVector3Project, applied in clip space ahead of the divide
+        const float halfWidth = viewport.width * 0.5f;
+        const float halfHeight = viewport.height * 0.5f;
+        const Matrix toScreen(
+            halfWidth, 0.f, 0.f, 0.f,
+            0.f, -halfHeight, 0.f, 0.f,
+            0.f, 0.f, viewport.maxDepth - viewport.minDepth, 0.f,
+            viewport.x + halfWidth, viewport.y + halfHeight, viewport.minDepth, 1.f);
+        m_project = wvp * toScreen;
+
+        // XMVector3Unproject maps back to normalized device coordinates, then inverts wvp
+        const float sx = 1.f / halfWidth;
+        const float sy = -1.f / halfHeight;
+        const float sz = 1.f / (viewport.maxDepth - viewport.minDepth);
+        const Matrix fromScreen(
+            sx, 0.f, 0.f, 0.f,
+            0.f, sy, 0.f, 0.f,
+            0.f, 0.f, sz, 0.f,
+            -viewport.x * sx - 1.f, -viewport.y * sy + 1.f, -viewport.minDepth * sz, 1.f);
+        m_unproject = fromScreen * wvp.Invert();
+
+        m_near = DirectX::SimpleMath::Vector4(wvp._13, wvp._23, wvp._33, wvp._43);
+    }
+
+    inline size_t ViewportProjection::Project(
+        const DirectX::SimpleMath::Vector3* points,
+        size_t count,
+        DirectX::SimpleMath::Vector3* result,
+        uint32_t* nearClip) const
+    {
+        if (count > 0 && (!points || !result))
+            throw std::invalid_argument("ViewportProjection::Project");
+
+        return SoADetail::TransformPoints<SoADetail::Lanes>(m_project, &m_near, points, count, result, nearClip);
+    }
+
+    inline void ViewportProjection::Unproject(
+        const DirectX::SimpleMath::Vector3* points,
+        size_t count,
+        DirectX::SimpleMath::Vector3* result) const
+    {
+        if (count > 0 && (!points || !result))
+            throw std::invalid_argument("ViewportProjection::Unproject");
+
+        SoADetail::TransformPoints<SoADetail::Lanes>(m_unproject, nullptr, points, count, result, nullptr);
+    }
+
+    inline size_t ProjectPoints(
+        const DirectX::SimpleMath::Viewport& viewport,
+        const DirectX::SimpleMath::Vector3* points,
+        size_t count,
+        const DirectX::SimpleMath::Matrix& proj,
+        const DirectX::SimpleMath::Matrix& view,
+        const DirectX::SimpleMath::Matrix& world,
+        DirectX::SimpleMath::Vector3* result,
+        uint32_t* nearClip)
+    {
+        return ViewportProjection(viewport, proj, view, world).Project(points, count, result, nearClip);
+    }
+
+    inline void UnprojectPoints(
+        const DirectX::SimpleMath::Viewport& viewport,
+        const DirectX::SimpleMath::Vector3* points,
+        size_t count,
+        const DirectX::SimpleMath::Matrix& proj,
+        const DirectX::SimpleMath::Matrix& view,
+        const DirectX::SimpleMath::Matrix& world,
+        DirectX::SimpleMath::Vector3* result)
+    {
+        ViewportProjection(viewport, proj, view, world).Unproject(points, count, result);
+    }
+}
@@ -46,6 +46,10 @@ extern bool Test04(_In_ ID3D11Device* pDevice);
 extern bool Test05(_In_ ID3D11Device* pDevice);
 extern bool Test06(_In_ ID3D11Device* pDevice);
 extern bool Test07(_In_ ID3D11Device* pDevice);
+extern bool Test08(_In_ ID3D11Device* pDevice);
+extern bool Test09(_In_ ID3D11Device* pDevice);
+extern bool Test10(_In_ ID3D11Device* pDevice);
+extern bool Test11(_In_ ID3D11Device* pDevice);
 
 TestInfo g_Tests[] =
 {
@@ -56,6 +60,10 @@ TestInfo g_Tests[] =
     { "ScreenGrab (DDS)", Test05 },
     { "ScreenGrab (WIC)", Test06 },
     { "Fuzzing (DDS)", Test07 },
+    { "DDSMetadata", Test08 },
+    { "DDS ingest (parallel)", Test09 },
+    { "BCDecode", Test10 },
+    { "DDS streaming", Test11 },
 };
 
 using Microsoft::WRL::ComPtr;
@@ -23,12 +23,24 @@
 #include "DDSTextureLoader.h"
 #include "ScreenGrab.h"
 
+#include "BCDecode.h"
+#include "DDSMetadata.h"
+#include "TextureIngest.h"
+#include "TextureStreamer.h"
+
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <chrono>
 #include <cstdio>
 #include <cstdint>
 #include <cwchar>
+#include <filesystem>
 #include <memory>
 #include <stdexcept>
+#include <system_error>
+#include <tuple>
+#include <vector>
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -1858,4 +1870,732 @@ bool Test07(_In_ ID3D11Device* pDevice)
     printf(" %zu images tested ", ncount);
 
     return success;
-}
\ No newline at end of file
+}
+
+
+//-------------------------------------------------------------------------------------
+// DDSMetadata (device-free)
+bool Test08(_In_ ID3D11Device*)
+{
+    bool success = true;
+
+    size_t ncount = 0;
+    size_t npass = 0;
+
+    bool skipped = false;
+
+    std::vector<DX::DDSSubresource> subresources;
+
+    for( size_t index=0; index < std::size(g_TestMedia); ++index )
+    {
+        wchar_t szPath[MAX_PATH] = {};
+        DWORD ret = ExpandEnvironmentStringsW(g_TestMedia[index].fname, szPath, MAX_PATH);
+        if ( !ret || ret > MAX_PATH )
+        {
+            printf( "ERROR: ExpandEnvironmentStrings FAILED\n" );
+            return false;
+        }
+
+#ifdef _DEBUG
+        OutputDebugString(szPath);
+        OutputDebugStringA("\n");
+#endif
+
+        Blob blob;
+        size_t blobSize = 0;
+        HRESULT hr = LoadBlobFromFile(szPath, blob, blobSize);
+        if (FAILED(hr))
+        {
+            if (((hr == HRESULT_FROM_WIN32(ERROR_PATH_NOT_FOUND)) || (hr == HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND)))
+                && wcsstr(g_TestMedia[index].fname, DXTEX_MEDIA_PATH) != nullptr)
+            {
+                // DIRECTX_TEX_MEDIA test cases are optional
+                skipped = true;
+                continue;
+            }
+
+            success = false;
+            printf( "ERROR: Failed getting raw file data (HRESULT %08X):\n%ls\n", static_cast<unsigned int>(hr), szPath );
+            ++ncount;
+            continue;
+        }
+
+        bool pass = true;
+
+        DX::DDSMetadata metadata = {};
+        hr = DX::GetDDSMetadata(blob.get(), blobSize, metadata, &subresources);
+        if (FAILED(hr))
+        {
+            success = pass = false;
+            printf( "ERROR: Failed parsing dds metadata (HRESULT %08X):\n%ls\n", static_cast<unsigned int>(hr), szPath );
+        }
+        else
+        {
+            // The YUY2 cases are loaded by Test01 with DDS_LOADER_IGNORE_MIPS
+            const bool ignoreMips = (g_TestMedia[index].format == DXGI_FORMAT_YUY2);
+
+            if (metadata.width != g_TestMedia[index].width
+                || metadata.height != g_TestMedia[index].height
+                || metadata.depthOrArraySize != g_TestMedia[index].depthOrArray
+                || (!ignoreMips && metadata.mipLevels != g_TestMedia[index].mipLevels)
+                || metadata.format != g_TestMedia[index].format
+                || static_cast<uint32_t>(metadata.dimension) != static_cast<uint32_t>(g_TestMedia[index].dimension)
+                || metadata.miscFlags != g_TestMedia[index].miscFlags
+                || metadata.alphaMode != static_cast<uint32_t>(g_TestMedia[index].alphaMode))
+            {
+                success = pass = false;
+                printf( "ERROR: Unexpected dds metadata\n%ls\n", szPath );
+                printf( "\t%u x %u x %u, %u mips, format %d, dimension %u, misc %08X, alpha %u\n...\n",
+                    metadata.width, metadata.height, metadata.depthOrArraySize, metadata.mipLevels,
+                    metadata.format, static_cast<unsigned int>(metadata.dimension), metadata.miscFlags, metadata.alphaMode );
+                printf( "\t%u x %u x %u, %u mips, format %d, dimension %d, misc %08X, alpha %u\n",
+                    g_TestMedia[index].width, g_TestMedia[index].height, g_TestMedia[index].depthOrArray, g_TestMedia[index].mipLevels,
+                    g_TestMedia[index].format, g_TestMedia[index].dimension, g_TestMedia[index].miscFlags, g_TestMedia[index].alphaMode );
+            }
+
+            const size_t items = (metadata.dimension == DX::DDS_DIMENSION_TEXTURE3D) ? 1u : metadata.depthOrArraySize;
+            if (subresources.size() != items * metadata.mipLevels
+                || subresources.front().offset != metadata.headerSize
+                || (metadata.headerSize + metadata.dataSize) > blobSize)
+            {
+                success = pass = false;
+                printf( "ERROR: Unexpected dds sub-resource layout (%zu entries, %zu + %llu bytes of %zu)\n%ls\n",
+                    subresources.size(), metadata.headerSize, metadata.dataSize, blobSize, szPath );
+            }
+            else
+            {
+                const auto& last = subresources.back();
+                if (last.offset + uint64_t(last.slicePitch) * last.depth > metadata.headerSize + metadata.dataSize)
+                {
+                    success = pass = false;
+                    printf( "ERROR: dds sub-resource extends past data\n%ls\n", szPath );
+                }
+            }
+
+            // Header-only parse must give the same answer
+            const size_t headerSize = std::min(blobSize, DX::DDS_MAX_HEADER_SIZE);
+
+            DX::DDSMetadata headerOnly = {};
+            hr = DX::GetDDSMetadata(blob.get(), headerSize, blobSize, headerOnly);
+            if (FAILED(hr) || headerOnly != metadata)
+            {
+                success = pass = false;
+                printf( "ERROR: Header-only dds metadata mismatch (HRESULT %08X):\n%ls\n", static_cast<unsigned int>(hr), szPath );
+            }
+
+            // Truncated file
+            const uint64_t truncated = metadata.headerSize + metadata.dataSize - 1;
+            hr = DX::GetDDSMetadata(blob.get(), headerSize, truncated, headerOnly);
+            if (hr != HRESULT_FROM_WIN32(ERROR_HANDLE_EOF))
+            {
+                success = pass = false;
+                printf( "ERROR: Expected failure for truncated dds (HRESULT %08X):\n%ls\n", static_cast<unsigned int>(hr), szPath );
+            }
+        }
+
+        if (pass)
+            ++npass;
+
+        ++ncount;
+    }
+
+    if (skipped)
+    {
+        printf("\nSkipped DIRECTX_TEX_MEDIA cases...\n");
+    }
+
+    // invalid args
+    {
+        DX::DDSMetadata metadata = {};
+        HRESULT hr = DX::GetDDSMetadata(nullptr, 0, metadata);
+        if (hr != E_INVALIDARG)
+        {
+            success = false;
+            printf("ERROR: Expected failure for invalid args (HRESULT %08X)\n", static_cast<unsigned int>(hr));
+        }
+
+        static const uint8_t s_notDDS[DX::DDS_MAX_HEADER_SIZE] = { 'D', 'D', 'S', '!' };
+        hr = DX::GetDDSMetadata(s_notDDS, sizeof(s_notDDS), metadata);
+        if (hr != E_FAIL)
+        {
+            success = false;
+            printf("ERROR: Expected failure for bad magic (HRESULT %08X)\n", static_cast<unsigned int>(hr));
+        }
+    }
+
+    printf("%zu files tested, %zu files passed ", ncount, npass );
+
+    return success;
+}
+
+
+//-------------------------------------------------------------------------------------
+// TextureIngest
+bool Test09(_In_ ID3D11Device*)
+{
+    bool success = true;
+
+    size_t ncount = 0;
+    size_t npass = 0;
+
+    bool skipped = false;
+
+    std::vector<std::filesystem::path> files;
+    std::vector<size_t> mediaIndex;
+
+    for( size_t index=0; index < std::size(g_TestMedia); ++index )
+    {
+        wchar_t szPath[MAX_PATH] = {};
+        DWORD ret = ExpandEnvironmentStringsW(g_TestMedia[index].fname, szPath, MAX_PATH);
+        if ( !ret || ret > MAX_PATH )
+        {
+            printf( "ERROR: ExpandEnvironmentStrings FAILED\n" );
+            return false;
+        }
+
+        if (GetFileAttributesW(szPath) == INVALID_FILE_ATTRIBUTES
+            && wcsstr(g_TestMedia[index].fname, DXTEX_MEDIA_PATH) != nullptr)
+        {
+            // DIRECTX_TEX_MEDIA test cases are optional
+            skipped = true;
+            continue;
+        }
+
+        files.emplace_back(szPath);
+        mediaIndex.push_back(index);
+    }
+
+    wchar_t tempPath[MAX_PATH] = {};
+    if (!GetTempPathW(MAX_PATH, tempPath))
+    {
+        printf( "ERROR: GetTempPath FAILED\n" );
+        return false;
+    }
+
+    const std::filesystem::path cacheFile = std::filesystem::path(tempPath) / L"ddswictest-ingest.cache";
+    std::error_code ec;
+    std::filesystem::remove(cacheFile, ec);
+
+    // Cold run reads, parses, and hashes everything
+    DX::TextureIngest ingest;
+    const auto cold = ingest.Ingest(files);
+    const auto coldStats = ingest.GetStats();
+
+    for (size_t j = 0; j < cold.size(); ++j)
+    {
+        const auto& entry = cold[j];
+        const auto& media = g_TestMedia[mediaIndex[j]];
+
+        bool pass = true;
+
+        const bool ignoreMips = (media.format == DXGI_FORMAT_YUY2);
+
+        if (FAILED(entry.hr) || entry.cached || !entry.isDDS)
+        {
+            success = pass = false;
+            printf( "ERROR: Failed ingesting dds (HRESULT %08X):\n%ls\n", static_cast<unsigned int>(entry.hr), entry.path.c_str() );
+        }
+        else if (entry.metadata.width != media.width
+            || entry.metadata.height != media.height
+            || entry.metadata.depthOrArraySize != media.depthOrArray
+            || (!ignoreMips && entry.metadata.mipLevels != media.mipLevels)
+            || entry.metadata.format != media.format
+            || static_cast<uint32_t>(entry.metadata.dimension) != static_cast<uint32_t>(media.dimension)
+            || entry.metadata.miscFlags != media.miscFlags
+            || entry.metadata.alphaMode != static_cast<uint32_t>(media.alphaMode))
+        {
+            success = pass = false;
+            printf( "ERROR: Unexpected ingested dds metadata\n%ls\n", entry.path.c_str() );
+        }
+
+        if (pass)
+            ++npass;
+
+        ++ncount;
+    }
+
+    if (coldStats.files != files.size() || coldStats.filesRead != files.size() || coldStats.cacheHits != 0)
+    {
+        success = false;
+        printf( "ERROR: Unexpected cold ingest stats (%zu files, %zu read, %zu cached)\n",
+            coldStats.files, coldStats.filesRead, coldStats.cacheHits );
+    }
+
+    HRESULT hr = ingest.SaveCache(cacheFile);
+    if (FAILED(hr))
+    {
+        success = false;
+        printf( "ERROR: Failed saving ingest cache (HRESULT %08X)\n", static_cast<unsigned int>(hr) );
+    }
+
+    // Warm run from a reloaded cache must not read any file and give the same results
+    DX::TextureIngest warmIngest(1);
+    hr = warmIngest.LoadCache(cacheFile);
+    if (FAILED(hr) || warmIngest.GetCacheSize() != files.size())
+    {
+        success = false;
+        printf( "ERROR: Failed loading ingest cache (HRESULT %08X, %zu entries)\n", static_cast<unsigned int>(hr), warmIngest.GetCacheSize() );
+    }
+
+    const auto warm = warmIngest.Ingest(files);
+    const auto warmStats = warmIngest.GetStats();
+
+    for (size_t j = 0; j < warm.size(); ++j)
+    {
+        if (!warm[j].cached
+            || warm[j].hr != cold[j].hr
+            || warm[j].contentHash != cold[j].contentHash
+            || warm[j].metadata != cold[j].metadata)
+        {
+            success = false;
+            printf( "ERROR: Cached ingest mismatch\n%ls\n", warm[j].path.c_str() );
+        }
+    }
+
+    if (warmStats.filesRead != 0 || warmStats.bytesRead != 0 || warmStats.cacheHits != files.size())
+    {
+        success = false;
+        printf( "ERROR: Unexpected warm ingest stats (%zu read, %zu cached)\n", warmStats.filesRead, warmStats.cacheHits );
+    }
+
+    std::filesystem::remove(cacheFile, ec);
+
+    // Hash sanity check (xxHash64 reference value)
+    {
+        static const uint8_t s_abc[] = { 'a', 'b', 'c' };
+        if (DX::TextureIngest::HashContent(s_abc, sizeof(s_abc)) != 0x44BC2CF5AD770999ull)
+        {
+            success = false;
+            printf( "ERROR: Unexpected content hash\n" );
+        }
+    }
+
+    if (skipped)
+    {
+        printf("\nSkipped DIRECTX_TEX_MEDIA cases...\n");
+    }
+
+    printf("\n\tcold: %.0f files/sec, %.1f MB/sec (%.1f MB peak in flight)\n\twarm: %.0f files/sec\n",
+        coldStats.FilesPerSecond(), coldStats.MBPerSecond(), double(coldStats.maxBytesInFlight) / (1024.0 * 1024.0),
+        warmStats.FilesPerSecond());
+
+    printf("%zu files tested, %zu files passed ", ncount, npass );
+
+    return success;
+}
+
+
+//-------------------------------------------------------------------------------------
+// BCDecode
+bool Test10(_In_ ID3D11Device*)
+{
+    bool success = true;
+
+    size_t ncount = 0;
+    size_t npass = 0;
+
+    // Known-answer blocks
+    {
+        static const uint8_t s_bc1[8] = { 0xFF, 0xFF, 0x00, 0x00, 0xE4, 0xE4, 0xE4, 0xE4 };
+        static const uint8_t s_bc1PunchThrough[8] = { 0x00, 0x00, 0xFF, 0xFF, 0xE4, 0xE4, 0xE4, 0xE4 };
+
+        // Mode 6 with per-endpoint p-bits, indices 0..15
+        static const uint8_t s_bc7Mode6[16] = { 0x40, 0xB2, 0x42, 0xC6, 0x03, 0xFC, 0xFF, 0xFF, 0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE };
+
+        // Mode 1, partition 13 (top half black, bottom half white)
+        static const uint8_t s_bc7Mode1[16] = { 0x36, 0x00, 0xF0, 0xFF, 0x00, 0xF0, 0xFF, 0x00, 0xF0, 0xFF, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+        // Mode 11 (10-bit endpoints, untransformed)
+        static const uint8_t s_bc6hMode11[16] = { 0x03, 0x00, 0x00, 0x00, 0xF8, 0x1F, 0xC0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+        uint8_t rgba[64] = {};
+        float rgbaf[64] = {};
+
+        auto check = [&](const char* name, size_t pixel, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+        {
+            const uint8_t* p = &rgba[pixel * 4];
+            if (p[0] != r || p[1] != g || p[2] != b || p[3] != a)
+            {
+                success = false;
+                printf("ERROR: %s pixel %zu decoded as %u,%u,%u,%u, expected %u,%u,%u,%u\n", name, pixel, p[0], p[1], p[2], p[3], r, g, b, a);
+            }
+        };
+
+        HRESULT hr = DX::DecodeBCBlock(DXGI_FORMAT_BC1_UNORM, s_bc1, rgba);
+        if (FAILED(hr))
+        {
+            success = false;
+            printf("ERROR: DecodeBCBlock BC1 failed (%08X)\n", static_cast<unsigned int>(hr));
+        }
+        check("BC1", 0, 255, 255, 255, 255);
+        check("BC1", 1, 0, 0, 0, 255);
+        check("BC1", 2, 170, 170, 170, 255);
+        check("BC1", 3, 85, 85, 85, 255);
+
+        std::ignore = DX::DecodeBCBlock(DXGI_FORMAT_BC1_UNORM, s_bc1PunchThrough, rgba);
+        check("BC1 (3 color)", 2, 128, 128, 128, 255);
+        check("BC1 (3 color)", 3, 0, 0, 0, 0);
+
+        std::ignore = DX::DecodeBCBlock(DXGI_FORMAT_BC7_UNORM, s_bc7Mode6, rgba);
+        check("BC7 mode 6", 0, 201, 101, 1, 255);
+        check("BC7 mode 6", 1, 190, 102, 17, 255);
+        check("BC7 mode 6", 15, 20, 120, 254, 254);
+
+        std::ignore = DX::DecodeBCBlock(DXGI_FORMAT_BC7_UNORM, s_bc7Mode1, rgba);
+        check("BC7 mode 1", 7, 0, 0, 0, 255);
+        check("BC7 mode 1", 8, 255, 255, 255, 255);
+
+        hr = DX::DecodeBCBlock(DXGI_FORMAT_BC6H_UF16, s_bc6hMode11, rgbaf);
+        if (FAILED(hr)
+            || rgbaf[0] != 0.765625f || rgbaf[2] != 0.765625f || rgbaf[3] != 1.f
+            || rgbaf[4] != 65504.f || fabsf(rgbaf[5] - 1.5146f) > 0.001f)
+        {
+            success = false;
+            printf("ERROR: BC6H mode 11 decoded as %f,%f,%f / %f,%f,%f\n", rgbaf[0], rgbaf[1], rgbaf[2], rgbaf[4], rgbaf[5], rgbaf[6]);
+        }
+
+        hr = DX::DecodeBCBlock(DXGI_FORMAT_R8G8B8A8_UNORM, s_bc7Mode6, rgba);
+        if (hr != HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED))
+        {
+            success = false;
+            printf("ERROR: Expected failure for non-BC format (HRESULT %08X)\n", static_cast<unsigned int>(hr));
+        }
+    }
+
+    // Full mip chains of the BC test media
+    bool skipped = false;
+    uint64_t totalPixels = 0;
+    double totalSeconds = 0.;
+
+    std::vector<DX::BCImage> images;
+    std::vector<uint8_t> pixels;
+    std::vector<float> pixelsf;
+
+    for( size_t index=0; index < std::size(g_TestMedia); ++index )
+    {
+        if (!DX::IsBCFormat(g_TestMedia[index].format))
+            continue;
+
+        wchar_t szPath[MAX_PATH] = {};
+        DWORD ret = ExpandEnvironmentStringsW(g_TestMedia[index].fname, szPath, MAX_PATH);
+        if ( !ret || ret > MAX_PATH )
+        {
+            printf( "ERROR: ExpandEnvironmentStrings FAILED\n" );
+            return false;
+        }
+
+        Blob blob;
+        size_t blobSize = 0;
+        HRESULT hr = LoadBlobFromFile(szPath, blob, blobSize);
+        if (FAILED(hr))
+        {
+            if (((hr == HRESULT_FROM_WIN32(ERROR_PATH_NOT_FOUND)) || (hr == HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND)))
+                && wcsstr(g_TestMedia[index].fname, DXTEX_MEDIA_PATH) != nullptr)
+            {
+                // DIRECTX_TEX_MEDIA test cases are optional
+                skipped = true;
+                continue;
+            }
+
+            success = false;
+            printf( "ERROR: Failed getting raw file data (HRESULT %08X):\n%ls\n", static_cast<unsigned int>(hr), szPath );
+            ++ncount;
+            continue;
+        }
+
+        bool pass = true;
+
+        DX::DDSMetadata metadata = {};
+        const auto start = std::chrono::steady_clock::now();
+        hr = DX::DecodeBCDDS(blob.get(), blobSize, metadata, images, pixels);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (FAILED(hr))
+        {
+            success = pass = false;
+            printf( "ERROR: Failed decoding dds (HRESULT %08X):\n%ls\n", static_cast<unsigned int>(hr), szPath );
+        }
+        else
+        {
+            const size_t items = (metadata.dimension == DX::DDS_DIMENSION_TEXTURE3D) ? 1u : metadata.depthOrArraySize;
+            const auto& last = images.back();
+            const size_t count = last.offset + size_t(last.width) * last.height * last.depth;
+            if (images.size() != items * metadata.mipLevels
+                || images.front().width != metadata.width
+                || images.front().height != metadata.height
+                || pixels.size() != count * 4)
+            {
+                success = pass = false;
+                printf( "ERROR: Unexpected decoded layout (%zu images, %zu pixels)\n%ls\n", images.size(), pixels.size() / 4, szPath );
+            }
+
+            totalPixels += count;
+            totalSeconds += elapsed.count();
+
+            // Float and RGBA8 decodes must agree for 8-bit formats
+            if (pass && DX::Internal::IsBCUNorm8(metadata.format))
+            {
+                hr = DX::DecodeBCDDS(blob.get(), blobSize, metadata, images, pixelsf, 1);
+                if (FAILED(hr) || pixelsf.size() != pixels.size())
+                {
+                    success = pass = false;
+                    printf( "ERROR: Failed float decoding dds (HRESULT %08X):\n%ls\n", static_cast<unsigned int>(hr), szPath );
+                }
+                else
+                {
+                    for (size_t j = 0; j < pixels.size(); ++j)
+                    {
+                        if (static_cast<uint8_t>(pixelsf[j] * 255.f + 0.5f) != pixels[j])
+                        {
+                            success = pass = false;
+                            printf( "ERROR: Float and RGBA8 decode mismatch at %zu\n%ls\n", j, szPath );
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (pass)
+            ++npass;
+
+        ++ncount;
+    }
+
+    if (skipped)
+    {
+        printf("\nSkipped DIRECTX_TEX_MEDIA cases...\n");
+    }
+
+    if (totalSeconds > 0.)
+    {
+        printf("\n\t%.1f megapixels/sec decoded\n", double(totalPixels) / totalSeconds / 1000000.0);
+    }
+
+    printf("%zu files tested, %zu files passed ", ncount, npass );
+
+    return success;
+}
+
+
+//-------------------------------------------------------------------------------------
+// TextureStreamer
+bool Test11(_In_ ID3D11Device* pDevice)
+{
+    bool success = true;
+
+    size_t ncount = 0;
+    size_t npass = 0;
+
+    ComPtr<ID3D11DeviceContext> context;
+    pDevice->GetImmediateContext(context.GetAddressOf());
+
+    constexpr uint32_t c_tailDimension = 64;
+
+    bool skipped = false;
+    uint64_t tailBytes = 0;
+    uint64_t fullBytes = 0;
+
+    for( size_t index=0; index < std::size(g_TestMedia); ++index )
+    {
+        if (g_TestMedia[index].dimension != D3D11_RESOURCE_DIMENSION_TEXTURE2D
+            || g_TestMedia[index].mipLevels <= 1
+            || g_TestMedia[index].format == DXGI_FORMAT_YUY2)
+            continue;
+
+        wchar_t szPath[MAX_PATH] = {};
+        DWORD ret = ExpandEnvironmentStringsW(g_TestMedia[index].fname, szPath, MAX_PATH);
+        if ( !ret || ret > MAX_PATH )
+        {
+            printf( "ERROR: ExpandEnvironmentStrings FAILED\n" );
+            return false;
+        }
+
+        Blob blob;
+        size_t blobSize = 0;
+        HRESULT hr = LoadBlobFromFile(szPath, blob, blobSize);
+        if (FAILED(hr))
+        {
+            if (((hr == HRESULT_FROM_WIN32(ERROR_PATH_NOT_FOUND)) || (hr == HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND)))
+                && wcsstr(g_TestMedia[index].fname, DXTEX_MEDIA_PATH) != nullptr)
+            {
+                // DIRECTX_TEX_MEDIA test cases are optional
+                skipped = true;
+                continue;
+            }
+
+            success = false;
+            printf( "ERROR: Failed getting raw file data (HRESULT %08X):\n%ls\n", static_cast<unsigned int>(hr), szPath );
+            ++ncount;
+            continue;
+        }
+
+        bool pass = true;
+
+        DX::DDSMetadata metadata = {};
+        std::ignore = DX::GetDDSMetadata(blob.get(), blobSize, blobSize, metadata);
+
+        ComPtr<ID3D11Resource> res;
+        hr = CreateDDSTextureFromMemory(pDevice, blob.get(), blobSize, res.GetAddressOf(), nullptr);
+        if (FAILED(hr))
+        {
+            success = false;
+            printf( "ERROR: Failed loading reference texture (HRESULT %08X):\n%ls\n", static_cast<unsigned int>(hr), szPath );
+            ++ncount;
+            continue;
+        }
+
+        ComPtr<ID3D11Texture2D> reference;
+        std::ignore = res.As(&reference);
+
+        D3D11_TEXTURE2D_DESC refDesc = {};
+        reference->GetDesc(&refDesc);
+
+        try
+        {
+            DX::TextureStreamer streamer(pDevice, UINT64_MAX, c_tailDimension);
+
+            DX::TextureStreamer::Handle handle = DX::TextureStreamer::c_InvalidHandle;
+            hr = streamer.Load(szPath, &handle);
+            if (FAILED(hr))
+            {
+                success = pass = false;
+                printf( "ERROR: Failed streaming dds (HRESULT %08X):\n%ls\n", static_cast<unsigned int>(hr), szPath );
+            }
+            else
+            {
+                const uint32_t tailMip = streamer.GetTailMip(handle);
+
+                D3D11_TEXTURE2D_DESC desc = {};
+                streamer.GetTexture(handle)->GetDesc(&desc);
+
+                const auto& stats = streamer.GetStats();
+                tailBytes += stats.tailBytes;
+                fullBytes += stats.fullBytes;
+
+                if (streamer.GetResidentMip(handle) != tailMip
+                    || !streamer.GetSRV(handle)
+                    || desc.MipLevels != refDesc.MipLevels - tailMip
+                    || desc.Width != std::max(refDesc.Width >> tailMip, 1u)
+                    || desc.Height != std::max(refDesc.Height >> tailMip, 1u)
+                    || stats.bytesRead != stats.tailBytes
+                    || stats.residentBytes != stats.tailBytes
+                    || stats.fullBytes != metadata.dataSize)
+                {
+                    success = pass = false;
+                    printf( "ERROR: Unexpected mip tail (mip %u, %ux%u, %llu bytes read):\n%ls\n",
+                        tailMip, desc.Width, desc.Height, static_cast<unsigned long long>(stats.bytesRead), szPath );
+                }
+
+                // Full upgrade reads every byte of pixel data exactly once
+                streamer.Request(handle, 0);
+                hr = streamer.Update(context.Get());
+
+                streamer.GetTexture(handle)->GetDesc(&desc);
+                if (FAILED(hr)
+                    || streamer.GetResidentMip(handle) != 0
+                    || desc.Width != refDesc.Width
+                    || desc.Height != refDesc.Height
+                    || desc.MipLevels != refDesc.MipLevels
+                    || desc.ArraySize != refDesc.ArraySize
+                    || desc.Format != refDesc.Format
+                    || stats.bytesRead != metadata.dataSize
+                    || stats.residentBytes != stats.fullBytes)
+                {
+                    success = pass = false;
+                    printf( "ERROR: Failed full upgrade (HRESULT %08X, %llu of %llu bytes read):\n%ls\n",
+                        static_cast<unsigned int>(hr), static_cast<unsigned long long>(stats.bytesRead),
+                        static_cast<unsigned long long>(metadata.dataSize), szPath );
+                }
+
+                // Not requested for a frame, but kept until there is budget pressure
+                hr = streamer.Update(context.Get());
+                if (FAILED(hr) || streamer.GetResidentMip(handle) != 0 || stats.mipsEvicted != 0)
+                {
+                    success = pass = false;
+                    printf( "ERROR: Unexpected eviction without budget pressure:\n%ls\n", szPath );
+                }
+            }
+
+            // Two copies competing for a budget that fits only one at full resolution
+            if (pass && streamer.GetTailMip(handle) > 0)
+            {
+                const uint64_t tail = streamer.GetStats().tailBytes;
+                const uint64_t full = streamer.GetStats().fullBytes;
+
+                DX::TextureStreamer budgeted(pDevice, full + tail, c_tailDimension);
+
+                DX::TextureStreamer::Handle a = DX::TextureStreamer::c_InvalidHandle;
+                DX::TextureStreamer::Handle b = DX::TextureStreamer::c_InvalidHandle;
+                std::ignore = budgeted.Load(szPath, &a);
+                std::ignore = budgeted.Load(szPath, &b);
+
+                const auto& stats = budgeted.GetStats();
+
+                budgeted.Request(a, 0);
+                budgeted.Request(b, budgeted.GetTailMip(b));
+                hr = budgeted.Update(context.Get());
+                if (FAILED(hr) || budgeted.GetResidentMip(a) != 0 || budgeted.GetResidentMip(b) != budgeted.GetTailMip(b))
+                {
+                    success = pass = false;
+                    printf( "ERROR: Failed budgeted upgrade (HRESULT %08X):\n%ls\n", static_cast<unsigned int>(hr), szPath );
+                }
+
+                budgeted.Request(b, 0);
+                hr = budgeted.Update(context.Get());
+                if (FAILED(hr)
+                    || budgeted.GetResidentMip(b) != 0
+                    || budgeted.GetResidentMip(a) != budgeted.GetTailMip(a)
+                    || stats.evictions != 1
+                    || stats.residentBytes > stats.budgetBytes
+                    || stats.peakResidentBytes > stats.budgetBytes)
+                {
+                    success = pass = false;
+                    printf( "ERROR: Failed LRU eviction (%llu evictions, %llu of %llu bytes resident):\n%ls\n",
+                        static_cast<unsigned long long>(stats.evictions), static_cast<unsigned long long>(stats.residentBytes),
+                        static_cast<unsigned long long>(stats.budgetBytes), szPath );
+                }
+
+                // Both in use this frame: the second request can't fit, so it is deferred
+                budgeted.Request(a, 0);
+                budgeted.Request(b, 0);
+                hr = budgeted.Update(context.Get());
+                if (FAILED(hr)
+                    || budgeted.GetResidentMip(b) != 0
+                    || budgeted.GetResidentMip(a) == 0
+                    || stats.requestsDeferred == 0
+                    || stats.residentBytes > stats.budgetBytes)
+                {
+                    success = pass = false;
+                    printf( "ERROR: Failed deferring over-budget request:\n%ls\n", szPath );
+                }
+            }
+        }
+        catch(const std::exception& e)
+        {
+            success = pass = false;
+            printf( "ERROR: Failed with exception: %s\n%ls\n", e.what(), szPath );
+        }
+
+        if (pass)
+            ++npass;
+
+        ++ncount;
+    }
+
+    if (skipped)
+    {
+        printf("\nSkipped DIRECTX_TEX_MEDIA cases...\n");
+    }
+
+    if (fullBytes > 0)
+    {
+        printf("\n\tMip tails: %llu KB of %llu KB (%.1f%%)\n",
+            static_cast<unsigned long long>(tailBytes / 1024), static_cast<unsigned long long>(fullBytes / 1024),
+            double(tailBytes) * 100.0 / double(fullBytes));
+    }
+
+    printf("%zu files tested, %zu files passed ", ncount, npass );
+
+    return success;
+}
@@ -23,11 +23,16 @@
 #include <crtdbg.h>
 
 #include "Audio.h"
+#include "AudioSynth.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <iterator>
 #include <stdexcept>
 #include <tuple>
+#include <vector>
 
 using namespace DirectX;
 
@@ -127,18 +132,203 @@ namespace
     //----------------------------------------------------------------------------------
     void GenerateSineWave(_Out_writes_(sampleRate) int16_t* data, int sampleRate, int frequency)
     {
-        const double timeStep = 1.0 / double(sampleRate);
-        const double freq = double(frequency);
+        DX::ToneGenerator tone(uint32_t(sampleRate), DX::Waveform::Sine, float(frequency));
+        tone.Generate(data, size_t(sampleRate));
+    }
+
+
+    //----------------------------------------------------------------------------------
+    bool TestToneGenerator()
+    {
+        bool success = true;
+
+        constexpr uint32_t sampleRate = 48000;
+
+        // Sine at 1/8th of the sample rate hits peaks every 2 samples
+        {
+            DX::ToneGenerator tone(sampleRate, DX::Waveform::Sine, float(sampleRate) / 8.f);
+
+            float samples[19] = {};
+            tone.Generate(samples, std::size(samples));
+
+            static const float s_expected[8] = { 0.f, 0.707107f, 1.f, 0.707107f, 0.f, -0.707107f, -1.f, -0.707107f };
+            for (size_t j = 0; j < std::size(samples); ++j)
+            {
+                if (fabsf(samples[j] - s_expected[j % 8]) > 0.001f)
+                {
+                    printf("ERROR: Sine sample %zu is %f (expected %f)\n", j, samples[j], s_expected[j % 8]);
+                    success = false;
+                }
+            }
+        }
+
+        // 16-bit output matches float output
+        {
+            DX::ToneGenerator ftone(sampleRate, DX::Waveform::Sine, 440.f, 0.5f);
+            DX::ToneGenerator itone(sampleRate, DX::Waveform::Sine, 440.f, 0.5f);
+
+            std::vector<float> fsamples(1023);
+            std::vector<int16_t> isamples(1023);
+            ftone.Generate(fsamples.data(), fsamples.size());
+            itone.Generate(isamples.data(), isamples.size());
+
+            for (size_t j = 0; j < fsamples.size(); ++j)
+            {
+                const int expected = int(lroundf(fsamples[j] * 32767.f));
+                if (abs(int(isamples[j]) - expected) > 1)
+                {
+                    printf("ERROR: int16 sample %zu is %d (expected %d)\n", j, isamples[j], expected);
+                    success = false;
+                    break;
+                }
+            }
+        }
+
+        // Buffer sizes that are not a multiple of 4 give the same stream as one long call
+        {
+            static const size_t s_sizes[] = { 1, 3, 5, 2, 7, 4, 6, 9, 13, 1, 2, 3 };
+
+            for (auto waveform : { DX::Waveform::Sine, DX::Waveform::Sawtooth, DX::Waveform::Noise })
+            {
+                DX::ToneGenerator whole(sampleRate, waveform, 440.f);
+                DX::ToneGenerator split(sampleRate, waveform, 440.f);
+                whole.SetEnvelope({ 0.0002f, 0.0002f, 0.5f, 0.01f });
+                split.SetEnvelope({ 0.0002f, 0.0002f, 0.5f, 0.01f });
+
+                float fwhole[56] = {};
+                float fsplit[56] = {};
+                whole.Generate(fwhole, std::size(fwhole));
+
+                size_t offset = 0;
+                for (auto size : s_sizes)
+                {
+                    split.Generate(fsplit + offset, size);
+                    offset += size;
+                }
+
+                for (size_t j = 0; j < std::size(fwhole); ++j)
+                {
+                    if (fsplit[j] != fwhole[j])
+                    {
+                        printf("ERROR: Waveform %u split sample %zu is %f (expected %f)\n", unsigned(waveform), j, fsplit[j], fwhole[j]);
+                        success = false;
+                        break;
+                    }
+                }
+
+                whole.Reset();
+                split.Reset();
+
+                int16_t iwhole[56] = {};
+                int16_t isplit[56] = {};
+                whole.Generate(iwhole, std::size(iwhole));
+
+                offset = 0;
+                for (auto size : s_sizes)
+                {
+                    split.GenerateBuffer(reinterpret_cast<uint8_t*>(isplit + offset), size * sizeof(int16_t));
+                    offset += size;
+                }
+
+                if (memcmp(iwhole, isplit, sizeof(iwhole)) != 0)
+                {
+                    printf("ERROR: Waveform %u split int16 samples do not match\n", unsigned(waveform));
+                    success = false;
+                }
+            }
+        }
 
-        int16_t* ptr = data;
-        double time = 0.0;
-        for (int j = 0; j < sampleRate; ++j, ++ptr)
+        // Square and sawtooth
         {
-            double angle = (2.0 * XM_PI * freq) * time;
-            double factor = 0.5 * (sin(angle) + 1.0);
-            *ptr = int16_t(32768 * factor);
-            time += timeStep;
+            DX::ToneGenerator square(sampleRate, DX::Waveform::Square, float(sampleRate) / 4.f, 0.25f);
+            DX::ToneGenerator saw(sampleRate, DX::Waveform::Sawtooth, float(sampleRate) / 4.f);
+
+            float sq[8] = {};
+            float sw[8] = {};
+            square.Generate(sq, std::size(sq));
+            saw.Generate(sw, std::size(sw));
+
+            static const float s_square[4] = { 0.25f, 0.25f, -0.25f, -0.25f };
+            static const float s_saw[4] = { -1.f, -0.5f, 0.f, 0.5f };
+            for (size_t j = 0; j < 8; ++j)
+            {
+                if (fabsf(sq[j] - s_square[j % 4]) > 0.0001f
+                    || fabsf(sw[j] - s_saw[j % 4]) > 0.0001f)
+                {
+                    printf("ERROR: Square/sawtooth sample %zu is %f, %f\n", j, sq[j], sw[j]);
+                    success = false;
+                }
+            }
+        }
+
+        // Noise stays in range and is not constant
+        {
+            DX::ToneGenerator noise(sampleRate, DX::Waveform::Noise, 0.f);
+
+            std::vector<float> samples(4096);
+            noise.Generate(samples.data(), samples.size());
+
+            float minv = 1.f;
+            float maxv = -1.f;
+            for (auto it : samples)
+            {
+                minv = std::min(minv, it);
+                maxv = std::max(maxv, it);
+            }
+
+            if (minv < -1.f || maxv > 1.f || (maxv - minv) < 1.f)
+            {
+                printf("ERROR: Noise range unexpected (%f..%f)\n", minv, maxv);
+                success = false;
+            }
+        }
+
+        // ADSR envelope
+        {
+            DX::ToneGenerator tone(sampleRate, DX::Waveform::Square, 100.f);
+            tone.SetEnvelope({ 0.01f, 0.01f, 0.5f, 0.02f });
+
+            // Attack + decay is 960 samples, so we should be at sustain afterwards
+            std::vector<float> samples(2000);
+            tone.Generate(samples.data(), samples.size());
+
+            if (fabsf(fabsf(samples[1999]) - 0.5f) > 0.0001f)
+            {
+                printf("ERROR: ADSR sustain level %f (expected 0.5)\n", fabsf(samples[1999]));
+                success = false;
+            }
+
+            float peak = 0.f;
+            for (auto it : samples)
+            {
+                peak = std::max(peak, fabsf(it));
+            }
+
+            if (fabsf(peak - 1.f) > 0.01f)
+            {
+                printf("ERROR: ADSR attack peak %f (expected 1.0)\n", peak);
+                success = false;
+            }
+
+            tone.NoteOff();
+
+            if (tone.IsFinished())
+            {
+                printf("ERROR: ADSR finished before release\n");
+                success = false;
+            }
+
+            // Release is 960 samples
+            tone.Generate(samples.data(), 961);
+
+            if (!tone.IsFinished() || samples[960] != 0.f)
+            {
+                printf("ERROR: ADSR failed to finish release (%f)\n", samples[960]);
+                success = false;
+            }
         }
+
+        return success;
     }
 
 
@@ -275,6 +465,20 @@ int __cdecl wmain()
 
 #ifdef TEST_SINE_WAVE
 
+    //
+    // Procedural tone generator
+    //
+
+    printf("\nProcedural tone generator\n");
+
+    if (!TestToneGenerator())
+    {
+        printf("ERROR: Tone generator failed\n");
+        return 1;
+    }
+
+    printf("\tPASS\n");
+
     //
     // DynamicSoundEffectInstance constructor
     //
@@ -11,6 +11,7 @@
 
 #include "pch.h"
 #include "Game.h"
+#include "Profiler.h"
 
 #define GAMMA_CORRECT_RENDERING
 #define USE_FAST_SEMANTICS
@@ -226,6 +227,8 @@ void Game::Initialize(
 #endif
     int width, int height, DXGI_MODE_ROTATION rotation)
 {
+    DX_PROFILE_SCOPE("Initialize");
+
     m_gamePad = std::make_unique<GamePad>();
     m_keyboard = std::make_unique<Keyboard>();
 
@@ -256,6 +259,8 @@ void Game::Initialize(
 // Executes the basic game loop.
 void Game::Tick()
 {
+    DX_PROFILE_SCOPE("Tick");
+
     m_timer.Tick([&]()
     {
         Update(m_timer);
@@ -267,6 +272,8 @@ void Game::Tick()
 // Updates the world.
 void Game::Update(DX::StepTimer const&)
 {
+    DX_PROFILE_SCOPE("Update");
+
     auto pad = m_gamePad->GetState(0);
     auto kb = m_keyboard->GetState();
     if (kb.Escape || (pad.IsConnected() && pad.IsViewPressed()))
@@ -280,6 +287,8 @@ void Game::Update(DX::StepTimer const&)
 // Draws the scene.
 void Game::Render()
 {
+    DX_PROFILE_SCOPE("Render");
+
     // Don't try to render anything before the first Update.
     if (m_timer.GetFrameCount() == 0)
     {
@@ -863,6 +872,8 @@ void Game::GetDefaultSize(int& width, int& height) const
 // These are the resources that depend on the device.
 void Game::CreateDeviceDependentResources()
 {
+    DX_PROFILE_SCOPE("CreateDeviceDependentResources");
+
     auto device = m_deviceResources->GetD3DDevice();
 
 #ifdef XBOX
@@ -1065,6 +1076,8 @@ void Game::CreateDeviceDependentResources()
 // Allocate all memory resources that change on a window SizeChanged event.
 void Game::CreateWindowSizeDependentResources()
 {
+    DX_PROFILE_SCOPE("CreateWindowSizeDependentResources");
+
     static const XMVECTORF32 cameraPosition = { { { 0.f, 0.f, 6.f, 0.f } } };
 
     const auto size = m_deviceResources->GetOutputSize();
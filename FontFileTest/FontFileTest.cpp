@@ -38,11 +38,13 @@ struct TestInfo
 
 extern bool Test01();
 extern bool Test02();
+extern bool Test03();
 
 TestInfo g_Tests[] =
 {
     { "BinaryReader", Test01 },
     { "Fuzzing", Test02 },
+    { "Glyph lookup", Test03 },
 };
 
 
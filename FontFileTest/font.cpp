@@ -27,9 +27,15 @@
 #include "BinaryReader.h"
 #include "SpriteFont.h"
 
+#include "GlyphIndex.h"
+
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <fstream>
 #include <stdexcept>
+#include <string>
+#include <tuple>
 #include <vector>
 
 using namespace DirectX;
@@ -231,6 +237,48 @@ namespace
         return true;
     }
 
+    // Same lookup as SpriteFont::Impl::FindGlyph
+    const SpriteFont::Glyph* BinarySearchGlyph(const std::vector<SpriteFont::Glyph>& glyphs, uint32_t character) noexcept
+    {
+        auto it = std::lower_bound(glyphs.cbegin(), glyphs.cend(), character,
+            [](const SpriteFont::Glyph& glyph, uint32_t value) noexcept { return glyph.Character < value; });
+        return (it != glyphs.cend() && it->Character == character) ? &*it : nullptr;
+    }
+
+    // Deterministic text using only characters present in the font, broken into 64 character lines
+    std::wstring MakeBenchmarkText(const std::vector<SpriteFont::Glyph>& glyphs, size_t length)
+    {
+        // Some fonts (consolas) include glyphs for control characters
+        std::vector<wchar_t> characters;
+        for (const auto& glyph : glyphs)
+        {
+            if (glyph.Character != 0 && glyph.Character != '\r' && glyph.Character != '\n')
+            {
+                characters.push_back(static_cast<wchar_t>(glyph.Character));
+            }
+        }
+
+        std::wstring text;
+        if (characters.empty())
+            return text;
+
+        text.reserve(length + length / 64 + 1);
+
+        uint32_t seed = 0x2545F491u;
+        for (size_t j = 0; j < length; ++j)
+        {
+            if (j > 0 && !(j % 64))
+            {
+                text += L'\n';
+            }
+
+            seed = seed * 1664525u + 1013904223u;
+            text += characters[(seed >> 8) % characters.size()];
+        }
+
+        return text;
+    }
+
     struct find_closer { void operator()(HANDLE h) noexcept { assert(h != INVALID_HANDLE_VALUE); if (h) FindClose(h); } };
 
     using ScopedFindHandle = std::unique_ptr<void, find_closer>;
@@ -528,3 +576,187 @@ bool Test02()
 
     return success;
 }
+
+//-------------------------------------------------------------------------------------
+// Glyph lookup
+bool Test03()
+{
+    using clock = std::chrono::steady_clock;
+
+    bool success = true;
+
+    size_t ncount = 0;
+    size_t npass = 0;
+
+    for (size_t index = 0; index < std::size(g_TestMedia); ++index)
+    {
+        wchar_t szPath[MAX_PATH] = {};
+        DWORD ret = ExpandEnvironmentStringsW(g_TestMedia[index].fname, szPath, MAX_PATH);
+        if (!ret || ret > MAX_PATH)
+        {
+            printf("ERROR: ExpandEnvironmentStrings FAILED\n");
+            return false;
+        }
+
+        bool pass = true;
+
+        try
+        {
+            std::vector<SpriteFont::Glyph> glyphs;
+            float lineSpacing = 0.f;
+            uint32_t defaultChar = 0;
+            {
+                BinaryReader reader(szPath);
+
+                static const char spriteFontMagic[] = "DXTKfont";
+                for (const char* magic = spriteFontMagic; *magic; magic++)
+                {
+                    if (reader.Read<uint8_t>() != *magic)
+                        throw std::runtime_error("Invalid magic header");
+                }
+
+                auto glyphCount = reader.Read<uint32_t>();
+                auto glyphData = reader.ReadArray<SpriteFont::Glyph>(glyphCount);
+                glyphs.assign(glyphData, glyphData + glyphCount);
+
+                lineSpacing = reader.Read<float>();
+                defaultChar = reader.Read<uint32_t>();
+            }
+
+            DX::GlyphIndex<SpriteFont::Glyph> glyphIndex(glyphs.data(), glyphs.size(), lineSpacing, defaultChar);
+
+            // Every BMP code point must resolve to the same glyph as a binary search
+            for (uint32_t character = 0; character <= 0x10FFFF; character = (character < 0xFFFF) ? character + 1 : character * 2 + 1)
+            {
+                if (glyphIndex.Find(character) != BinarySearchGlyph(glyphs, character))
+                {
+                    printf("ERROR: Glyph lookup mismatch for character %u:\n%ls\n", character, szPath);
+                    pass = false;
+                    break;
+                }
+            }
+
+            // Missing characters follow SpriteFont::FindGlyph
+            uint32_t missing = 0;
+            while (BinarySearchGlyph(glyphs, missing))
+                ++missing;
+
+            if (!defaultChar)
+            {
+                bool threw = false;
+                try
+                {
+                    std::ignore = glyphIndex.FindGlyph(static_cast<wchar_t>(missing));
+                }
+                catch (const std::runtime_error&)
+                {
+                    threw = true;
+                }
+
+                if (!threw)
+                {
+                    printf("ERROR: Expected exception for missing character %u:\n%ls\n", missing, szPath);
+                    pass = false;
+                }
+            }
+
+            auto fallback = glyphIndex;
+            fallback.SetDefaultCharacter(glyphs.back().Character);
+            if (fallback.FindGlyph(static_cast<wchar_t>(missing)) != &glyphs.back())
+            {
+                printf("ERROR: Expected default glyph for missing character %u:\n%ls\n", missing, szPath);
+                pass = false;
+            }
+
+            // MeasureString must match the binary search layout exactly
+            auto binarySearch = [&](wchar_t character)
+                {
+                    auto glyph = BinarySearchGlyph(glyphs, static_cast<uint32_t>(character));
+                    if (!glyph)
+                        throw std::runtime_error("Character not in font");
+                    return glyph;
+                };
+
+            const std::wstring text = MakeBenchmarkText(glyphs, 256 * 1024);
+
+            const std::wstring samples[] =
+            {
+                std::wstring(),
+                text.substr(0, 1),
+                text.substr(0, 63),
+                text.substr(0, 200) + L"\r\n" + text.substr(300, 10),
+                text,
+            };
+
+            for (const auto& sample : samples)
+            {
+                for (const bool ignoreWhitespace : { true, false })
+                {
+                    const auto expected = DX::MeasureGlyphs<SpriteFont::Glyph>(sample.c_str(), lineSpacing, binarySearch, ignoreWhitespace);
+                    const auto actual = glyphIndex.MeasureString(sample.c_str(), ignoreWhitespace);
+                    if (expected.width != actual.width || expected.height != actual.height)
+                    {
+                        printf("ERROR: MeasureString mismatch (expected %f x %f, got %f x %f):\n%ls\n",
+                            double(expected.width), double(expected.height), double(actual.width), double(actual.height), szPath);
+                        pass = false;
+                    }
+                }
+            }
+
+            // Benchmark for the fonts with the most and the widest-spread character sets
+            if (wcsstr(szPath, L"consolas") || wcsstr(szPath, L"japanese"))
+            {
+                constexpr int c_iterations = 16;
+
+                float searchWidth = 0.f;
+                float indexWidth = 0.f;
+
+                auto start = clock::now();
+                for (int j = 0; j < c_iterations; ++j)
+                {
+                    searchWidth += DX::MeasureGlyphs<SpriteFont::Glyph>(text.c_str(), lineSpacing, binarySearch).width;
+                }
+                const std::chrono::duration<double> searchTime = clock::now() - start;
+
+                start = clock::now();
+                for (int j = 0; j < c_iterations; ++j)
+                {
+                    indexWidth += glyphIndex.MeasureString(text.c_str()).width;
+                }
+                const std::chrono::duration<double> indexTime = clock::now() - start;
+
+                if (searchWidth != indexWidth)
+                {
+                    printf("ERROR: MeasureString benchmark mismatch:\n%ls\n", szPath);
+                    pass = false;
+                }
+
+                const double chars = double(text.size()) * c_iterations / 1000000.0;
+                printf("\n\t%ls: %zu glyphs (%zu hash slots), MeasureString %.1f Mchars/s (binary search %.1f Mchars/s, %.2fx)",
+                    wcsrchr(szPath, L'\\') + 1, glyphs.size(), glyphIndex.GetHashCapacity(),
+                    chars / indexTime.count(), chars / searchTime.count(),
+                    searchTime.count() / indexTime.count());
+            }
+        }
+        catch (const std::exception& e)
+        {
+            pass = false;
+            printf("ERROR: C++ Exception testing glyph lookup (except: %s):\n%ls\n", e.what(), szPath);
+        }
+        catch (...)
+        {
+            pass = false;
+            printf("ERROR: Unknown C++ Exception testing glyph lookup:\n%ls\n", szPath);
+        }
+
+        if (pass)
+            ++npass;
+        else
+            success = false;
+        ++ncount;
+    }
+
+    printf("\n%zu files tested, %zu files passed ", ncount, npass);
+
+    return success;
+}
@@ -10,6 +10,7 @@
 //--------------------------------------------------------------------------------------
 #include "pch.h"
 #include "Game.h"
+#include "Profiler.h"
 
 #include "FindMedia.h"
 
@@ -113,6 +114,8 @@ void Game::Initialize(
 #endif
     int width, int height, DXGI_MODE_ROTATION rotation)
 {
+    DX_PROFILE_SCOPE("Initialize");
+
 #ifdef XBOX
     UNREFERENCED_PARAMETER(rotation);
     UNREFERENCED_PARAMETER(width);
@@ -200,6 +203,8 @@ void Game::Initialize(
 // Executes the basic game loop.
 void Game::Tick()
 {
+    DX_PROFILE_SCOPE("Tick");
+
     m_timer.Tick([&]()
     {
         Update(m_timer);
@@ -211,6 +216,8 @@ void Game::Tick()
 // Updates the world.
 void Game::Update(DX::StepTimer const&)
 {
+    DX_PROFILE_SCOPE("Update");
+
     m_state.connected = false;
 
 #ifdef USING_GAMEINPUT
@@ -475,6 +482,8 @@ void Game::Update(DX::StepTimer const&)
 // Draws the scene.
 void Game::Render()
 {
+    DX_PROFILE_SCOPE("Render");
+
     // Don't try to render anything before the first Update.
     if (m_timer.GetFrameCount() == 0)
     {
@@ -696,6 +705,8 @@ void Game::GetDefaultSize(int& width, int& height) const
 // These are the resources that depend on the device.
 void Game::CreateDeviceDependentResources()
 {
+    DX_PROFILE_SCOPE("CreateDeviceDependentResources");
+
     auto device = m_deviceResources->GetD3DDevice();
     auto context = m_deviceResources->GetD3DDeviceContext();
 
@@ -739,6 +750,8 @@ void Game::CreateDeviceDependentResources()
 // Allocate all memory resources that change on a window SizeChanged event.
 void Game::CreateWindowSizeDependentResources()
 {
+    DX_PROFILE_SCOPE("CreateWindowSizeDependentResources");
+
     const auto viewPort = m_deviceResources->GetScreenViewport();
     m_spriteBatch->SetViewport(viewPort);
 
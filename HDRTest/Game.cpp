@@ -11,6 +11,7 @@
 
 #include "pch.h"
 #include "Game.h"
+#include "Profiler.h"
 
 //#define USE_FAST_SEMANTICS
 
@@ -21,6 +22,9 @@
 //#define TEST_HDR_LINEAR
 
 extern void ExitGame() noexcept;
+#ifdef PC
+extern void ExitGame(int exitCode) noexcept;
+#endif
 
 using namespace DirectX;
 using namespace DirectX::SimpleMath;
@@ -54,6 +58,12 @@ namespace
     constexpr float col4 = 3.5f;
     constexpr float col5 = 5.f;
 
+#ifdef PC
+    // Reference images are captured at a fixed point in the animation.
+    constexpr float c_referenceTime = 1.f;
+    constexpr uint64_t c_referenceFrame = 4;
+#endif
+
     const XMMATRIX c_fromExpanded709to2020 = // Custom Rec.709 into Rec.2020
     {
           0.6274040f, 0.0457456f, -0.00121055f, 0.f,
@@ -69,6 +79,9 @@ extern bool g_HDRMode;
 
 // Constructor.
 Game::Game() noexcept(false) :
+#ifdef PC
+    m_reference(L"HDRTest"),
+#endif
     m_toneMapMode(ToneMapPostProcess::Reinhard),
     m_hdr10Rotation(ToneMapPostProcess::HDTV_to_UHDTV)
 {
@@ -113,6 +126,8 @@ void Game::Initialize(
 #endif
     int width, int height, DXGI_MODE_ROTATION rotation)
 {
+    DX_PROFILE_SCOPE("Initialize");
+
     m_gamePad = std::make_unique<GamePad>();
     m_keyboard = std::make_unique<Keyboard>();
 
@@ -143,6 +158,8 @@ void Game::Initialize(
 // Executes the basic game loop.
 void Game::Tick()
 {
+    DX_PROFILE_SCOPE("Tick");
+
     m_timer.Tick([&]()
     {
         Update(m_timer);
@@ -154,6 +171,8 @@ void Game::Tick()
 // Updates the world.
 void Game::Update(DX::StepTimer const&)
 {
+    DX_PROFILE_SCOPE("Update");
+
     auto pad = m_gamePad->GetState(0);
     auto kb = m_keyboard->GetState();
     if (kb.Escape || (pad.IsConnected() && pad.IsViewPressed()))
@@ -198,6 +217,8 @@ void Game::Update(DX::StepTimer const&)
 // Draws the scene.
 void Game::Render()
 {
+    DX_PROFILE_SCOPE("Render");
+
     // Don't try to render anything before the first Update.
     if (m_timer.GetFrameCount() == 0)
     {
@@ -248,7 +269,11 @@ void Game::Render()
     m_batch->End();
 
     // Time-based animation
+#ifdef PC
+    float time = m_reference.IsEnabled() ? c_referenceTime : static_cast<float>(m_timer.GetTotalSeconds());
+#else
     float time = static_cast<float>(m_timer.GetTotalSeconds());
+#endif
 
     float alphaFade = (sin(time * 2) + 1) / 2;
 
@@ -395,6 +420,20 @@ void Game::Render()
     ID3D11ShaderResourceView* nullsrv[] = { nullptr };
     context->PSSetShaderResources(0, 1, nullsrv);
 
+#ifdef PC
+    if (m_reference.IsEnabled() && m_timer.GetFrameCount() == c_referenceFrame)
+    {
+        // Only the tone-mapped output is compared, since captures clamp to 0..1. It depends
+        // on the display, so it is only compared for SDR.
+        if (m_deviceResources->GetColorSpace() == DXGI_COLOR_SPACE_RGB_FULL_G22_NONE_P709)
+        {
+            m_reference.Check(context, m_deviceResources->GetRenderTarget(), L"tonemapped");
+        }
+
+        ExitGame(m_reference.Summarize());
+    }
+#endif
+
     // Show the new frame.
     m_deviceResources->Present();
 
@@ -493,6 +532,8 @@ void Game::GetDefaultSize(int& width, int& height) const
 // These are the resources that depend on the device.
 void Game::CreateDeviceDependentResources()
 {
+    DX_PROFILE_SCOPE("CreateDeviceDependentResources");
+
     auto device = m_deviceResources->GetD3DDevice();
 
 #ifdef XBOX
@@ -548,6 +589,8 @@ void Game::CreateDeviceDependentResources()
 // Allocate all memory resources that change on a window SizeChanged event.
 void Game::CreateWindowSizeDependentResources()
 {
+    DX_PROFILE_SCOPE("CreateWindowSizeDependentResources");
+
     static const XMVECTORF32 cameraPosition = { { { 0.f, 0.f, 7.f, 0.f } } };
 
     const auto size = m_deviceResources->GetOutputSize();
@@ -15,6 +15,10 @@
 
 #include "RenderTexture.h"
 
+#ifdef PC
+#include "ReferenceCapture.h"
+#endif
+
 constexpr uint32_t c_testTimeout = 10000;
 
 // A basic game implementation that creates a D3D11 device and
@@ -113,6 +117,11 @@ private:
     std::unique_ptr<DirectX::ToneMapPostProcess>    m_toneMap;
     std::unique_ptr<DX::RenderTexture>              m_hdrScene;
 
+#ifdef PC
+    // Golden image checks enabled by DIRECTXTK_REFERENCE_PATH
+    DX::ReferenceCapture                            m_reference;
+#endif
+
     // Test resources.
     std::unique_ptr<DirectX::SpriteBatch>               m_batch;
     std::unique_ptr<DirectX::SpriteFont>                m_font;
@@ -49,6 +49,7 @@
 #include <cstdint>
 #include <fstream>
 #include <locale>
+#include <sstream>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -82,24 +83,57 @@ namespace DX
             if (!szFileName)
                 return E_INVALIDARG;
 
-            constexpr size_t MAX_POLY = 64;
-
-            using namespace DirectX;
-
+    #ifdef _WIN32
             std::wifstream InFile(szFileName);
+    #else
+            std::wifstream InFile{ std::filesystem::path(szFileName) };
+    #endif
             if (!InFile)
                 return /* HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND) */ static_cast<HRESULT>(0x80070002L);
 
             InFile.imbue(std::locale::classic());
 
+            const HRESULT hr = Load(InFile, szFileName, ccw, loadmtl);
+
+            InFile.close();
+
+            return hr;
+        }
+
+        // Parses OBJ text from memory. Any material library reference is ignored.
+        HRESULT LoadFromMemory(_In_reads_bytes_(dataSize) const uint8_t* data, size_t dataSize, bool ccw = true)
+        {
+            Clear();
+
+            if (!data || !dataSize)
+                return E_INVALIDARG;
+
+            std::wistringstream InFile(Widen(data, dataSize));
+            InFile.imbue(std::locale::classic());
+
+            return Load(InFile, nullptr, ccw, false);
+        }
+
+        // Parses OBJ text from a stream. 'szFileName', if given, names the mesh and locates its material library.
+        HRESULT Load(std::wistream& InFile, _In_opt_z_ const wchar_t* szFileName, bool ccw, bool loadmtl)
+        {
+            Clear();
+
+            constexpr size_t MAX_POLY = 64;
+
+            using namespace DirectX;
+
+            if (szFileName)
+            {
     #ifdef _WIN32
-            wchar_t fname[_MAX_FNAME] = {};
-            _wsplitpath_s(szFileName, nullptr, 0, nullptr, 0, fname, _MAX_FNAME, nullptr, 0);
-            name = fname;
+                wchar_t fname[_MAX_FNAME] = {};
+                _wsplitpath_s(szFileName, nullptr, 0, nullptr, 0, fname, _MAX_FNAME, nullptr, 0);
+                name = fname;
     #else
-            auto path = std::filesystem::path(szFileName);
-            name = path.filename().c_str();
+                auto path = std::filesystem::path(szFileName);
+                name = path.filename().wstring();
     #endif
+            }
 
             std::vector<XMFLOAT3>   positions;
             std::vector<XMFLOAT3>   normals;
@@ -109,7 +143,11 @@ namespace DX
 
             Material defmat;
 
+    #ifdef _WIN32
             wcscpy_s(defmat.strName, L"default");
+    #else
+            wcscpy(defmat.strName, L"default");
+    #endif
             materials.emplace_back(defmat);
 
             uint32_t curSubset = 0;
@@ -373,7 +411,12 @@ namespace DX
                     {
                         Material mat;
                         curSubset = static_cast<uint32_t>(materials.size());
-                        wcscpy_s(mat.strName, MAX_PATH - 1, strName);
+                        // strName was read with a width of MAX_PATH, so it always fits
+    #ifdef _WIN32
+                        wcscpy_s(mat.strName, MAX_PATH, strName);
+    #else
+                        wcsncpy(mat.strName, strName, MAX_PATH - 1);
+    #endif
                         materials.emplace_back(mat);
                     }
                 }
@@ -396,15 +439,13 @@ namespace DX
             if (positions.empty())
                 return E_FAIL;
 
-            // Cleanup
-            InFile.close();
-
             BoundingBox::CreateFromPoints(bounds, positions.size(), positions.data(), sizeof(XMFLOAT3));
 
             // If an associated material file was found, read that in as well.
-            if (*strMaterialFilename && loadmtl)
+            if (*strMaterialFilename && loadmtl && szFileName)
             {
     #ifdef _WIN32
+                wchar_t fname[_MAX_FNAME] = {};
                 wchar_t ext[_MAX_EXT] = {};
                 _wsplitpath_s(strMaterialFilename, nullptr, 0, nullptr, 0, fname, _MAX_FNAME, ext, _MAX_EXT);
 
@@ -423,7 +464,7 @@ namespace DX
                 path.replace_filename(mtlpath.filename());
                 path.replace_extension(mtlpath.extension());
 
-                HRESULT hr = LoadMTL(path.c_str());
+                HRESULT hr = LoadMTL(path.wstring().c_str());
                 if (FAILED(hr))
                     return hr;
     #endif
@@ -437,15 +478,41 @@ namespace DX
             if (!szFileName)
                 return E_INVALIDARG;
 
-            using namespace DirectX;
-
             // Assumes MTL is in CWD along with OBJ
+    #ifdef _WIN32
             std::wifstream InFile(szFileName);
+    #else
+            std::wifstream InFile{ std::filesystem::path(szFileName) };
+    #endif
             if (!InFile)
                 return /* HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND) */ static_cast<HRESULT>(0x80070002L);
 
             InFile.imbue(std::locale::classic());
 
+            const HRESULT hr = LoadMTL(InFile);
+
+            InFile.close();
+
+            return hr;
+        }
+
+        // Parses MTL text from memory, adding to any materials already loaded.
+        HRESULT LoadMTLFromMemory(_In_reads_bytes_(dataSize) const uint8_t* data, size_t dataSize)
+        {
+            if (!data || !dataSize)
+                return E_INVALIDARG;
+
+            std::wistringstream InFile(Widen(data, dataSize));
+            InFile.imbue(std::locale::classic());
+
+            return LoadMTL(InFile);
+        }
+
+        // Parses MTL text from a stream, adding to any materials already loaded.
+        HRESULT LoadMTL(std::wistream& InFile)
+        {
+            using namespace DirectX;
+
             auto curMaterial = materials.end();
             bool foundmat = false;
 
@@ -591,8 +658,6 @@ namespace DX
                 InFile.ignore(1000, L'\n');
             }
 
-            InFile.close();
-
             return (foundmat) ? S_OK : E_FAIL;
         }
 
@@ -617,7 +682,33 @@ namespace DX
             if (!szFileName)
                 return E_INVALIDARG;
 
-            using namespace DirectX;
+    #ifdef _WIN32
+            std::ifstream vboFile(szFileName, std::ifstream::in | std::ifstream::binary | std::ifstream::ate);
+    #else
+            std::ifstream vboFile{ std::filesystem::path(szFileName), std::ifstream::in | std::ifstream::binary | std::ifstream::ate };
+    #endif
+            if (!vboFile.is_open())
+                return /* HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND) */ static_cast<HRESULT>(0x80070002L);
+
+            const std::streampos len = vboFile.tellg();
+            if (!vboFile || len <= 0)
+                return E_FAIL;
+
+            if (len > UINT32_MAX)
+                return /* HRESULT_FROM_WIN32(ERROR_FILE_TOO_LARGE) */ static_cast<HRESULT>(0x800700DFL);
+
+            std::vector<uint8_t> blob(static_cast<size_t>(len));
+
+            vboFile.seekg(0, std::ios::beg);
+            vboFile.read(reinterpret_cast<char*>(blob.data()), len);
+            if (!vboFile)
+                return E_FAIL;
+
+            vboFile.close();
+
+            HRESULT hr = LoadVBOFromMemory(blob.data(), blob.size());
+            if (FAILED(hr))
+                return hr;
 
     #ifdef _WIN32
             wchar_t fname[_MAX_FNAME] = {};
@@ -625,32 +716,52 @@ namespace DX
             name = fname;
     #else
             auto path = std::filesystem::path(szFileName);
-            name = path.filename().c_str();
+            name = path.filename().wstring();
     #endif
 
+            return S_OK;
+        }
+
+        HRESULT LoadVBOFromMemory(_In_reads_bytes_(dataSize) const uint8_t* data, size_t dataSize)
+        {
+            Clear();
+
+            if (!data || !dataSize)
+                return E_INVALIDARG;
+
+            using namespace DirectX;
+
             Material defmat;
+    #ifdef _WIN32
             wcscpy_s(defmat.strName, L"default");
+    #else
+            wcscpy(defmat.strName, L"default");
+    #endif
             materials.emplace_back(defmat);
 
-            std::ifstream vboFile(szFileName, std::ifstream::in | std::ifstream::binary);
-            if (!vboFile.is_open())
-                return /* HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND) */ static_cast<HRESULT>(0x80070002L);
-
             hasNormals = hasTexcoords = true;
 
+            if (dataSize < sizeof(uint32_t) * 2)
+                return E_FAIL;
+
             uint32_t numVertices = 0;
             uint32_t numIndices = 0;
+            memcpy(&numVertices, data, sizeof(uint32_t));
+            memcpy(&numIndices, data + sizeof(uint32_t), sizeof(uint32_t));
 
-            vboFile.read(reinterpret_cast<char*>(&numVertices), sizeof(uint32_t));
-            if (!numVertices)
+            if (!numVertices || !numIndices)
                 return E_FAIL;
 
-            vboFile.read(reinterpret_cast<char*>(&numIndices), sizeof(uint32_t));
-            if (!numIndices)
+            const uint64_t vertSize = uint64_t(sizeof(Vertex)) * numVertices;
+            const uint64_t indexSize = uint64_t(sizeof(uint16_t)) * numIndices;
+            if (uint64_t(dataSize) < sizeof(uint32_t) * 2 + vertSize + indexSize)
                 return E_FAIL;
 
+            const uint8_t* ptr = data + sizeof(uint32_t) * 2;
+
             vertices.resize(numVertices);
-            vboFile.read(reinterpret_cast<char*>(vertices.data()), sizeof(Vertex) * numVertices);
+            memcpy(vertices.data(), ptr, static_cast<size_t>(vertSize));
+            ptr += vertSize;
 
     #if (__cplusplus >= 201703L)
             if constexpr (sizeof(index_t) == 2)
@@ -660,13 +771,13 @@ namespace DX
     #endif
             {
                 indices.resize(numIndices);
-                vboFile.read(reinterpret_cast<char*>(indices.data()), sizeof(uint16_t) * numIndices);
+                memcpy(indices.data(), ptr, static_cast<size_t>(indexSize));
             }
             else
             {
                 std::vector<uint16_t> tmp;
                 tmp.resize(numIndices);
-                vboFile.read(reinterpret_cast<char*>(tmp.data()), sizeof(uint16_t) * numIndices);
+                memcpy(tmp.data(), ptr, static_cast<size_t>(indexSize));
 
                 indices.reserve(numIndices);
                 for (const auto it : tmp)
@@ -677,8 +788,6 @@ namespace DX
 
             BoundingBox::CreateFromPoints(bounds, vertices.size(), reinterpret_cast<const XMFLOAT3*>(vertices.data()), sizeof(Vertex));
 
-            vboFile.close();
-
             return S_OK;
         }
 
@@ -756,7 +865,7 @@ namespace DX
             return index;
         }
 
-        void LoadTexturePath(std::wifstream& InFile, _Out_writes_(maxChar) wchar_t* texture, size_t maxChar)
+        void LoadTexturePath(std::wistream& InFile, _Out_writes_(maxChar) wchar_t* texture, size_t maxChar)
         {
             wchar_t buff[1024] = {};
             InFile.getline(buff, 1024, L'\n');
@@ -785,7 +894,8 @@ namespace DX
                 path = path.substr(pos + 1);
             }
 
-            if (!path.empty())
+            // Paths that do not fit are ignored rather than truncated
+            if (!path.empty() && path.size() < maxChar)
             {
     #ifdef _WIN32
                 wcscpy_s(texture, maxChar, path.c_str());
@@ -794,5 +904,17 @@ namespace DX
     #endif
             }
         }
+
+        // Matches how std::wifstream with the classic locale widens each byte
+        static std::wstring Widen(_In_reads_bytes_(dataSize) const uint8_t* data, size_t dataSize)
+        {
+            std::wstring result;
+            result.reserve(dataSize);
+            for (size_t j = 0; j < dataSize; ++j)
+            {
+                result.push_back(static_cast<wchar_t>(data[j]));
+            }
+            return result;
+        }
     };
 }
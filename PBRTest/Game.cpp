@@ -11,6 +11,7 @@
 
 #include "pch.h"
 #include "Game.h"
+#include "Profiler.h"
 #include "vbo.h"
 
 //#define USE_FAST_SEMANTICS
@@ -22,6 +23,9 @@
 //#define TEST_HDR_LINEAR
 
 extern void ExitGame() noexcept;
+#ifdef PC
+extern void ExitGame(int exitCode) noexcept;
+#endif
 
 #ifdef XBOX
 extern bool g_HDRMode;
@@ -60,6 +64,12 @@ namespace
     constexpr float row2 = -1.1f;
     constexpr float row3 = -2.5f;
 
+#ifdef PC
+    // Reference images are captured at a fixed point in the animation.
+    constexpr float c_referenceTime = 1.f;
+    constexpr uint32_t c_referenceFrame = 4;
+#endif
+
     void ReadVBO(_In_z_ const wchar_t* name, GeometricPrimitive::VertexCollection& vertices, GeometricPrimitive::IndexCollection& indices)
     {
         std::vector<uint8_t> blob;
@@ -125,6 +135,9 @@ Game::Game() noexcept(false) :
     m_debugMode(DebugEffect::Mode_Default),
     m_pitch(0),
     m_yaw(0)
+#ifdef PC
+    , m_reference(L"PBRTest")
+#endif
 {
 #if defined(TEST_HDR_LINEAR) && !defined(XBOX)
     constexpr DXGI_FORMAT c_DisplayFormat = DXGI_FORMAT_R16G16B16A16_FLOAT;
@@ -167,6 +180,8 @@ void Game::Initialize(
 #endif
     int width, int height, DXGI_MODE_ROTATION rotation)
 {
+    DX_PROFILE_SCOPE("Initialize");
+
     m_gamePad = std::make_unique<GamePad>();
     m_keyboard = std::make_unique<Keyboard>();
 
@@ -197,6 +212,8 @@ void Game::Initialize(
 // Executes the basic game loop.
 void Game::Tick()
 {
+    DX_PROFILE_SCOPE("Tick");
+
     m_timer.Tick([&]()
     {
         Update(m_timer);
@@ -208,6 +225,8 @@ void Game::Tick()
 // Updates the world.
 void Game::Update(DX::StepTimer const&)
 {
+    DX_PROFILE_SCOPE("Update");
+
     auto kb = m_keyboard->GetState();
     m_keyboardButtons.Update(kb);
 
@@ -339,6 +358,8 @@ void Game::Update(DX::StepTimer const&)
 // Draws the scene.
 void Game::Render()
 {
+    DX_PROFILE_SCOPE("Render");
+
     // Don't try to render anything before the first Update.
     if (m_timer.GetFrameCount() == 0)
     {
@@ -357,7 +378,11 @@ void Game::Render()
     const auto safeRect = Viewport::ComputeTitleSafeArea(UINT(vp.right - vp.left), UINT(vp.bottom - vp.top));
 
     // Time-based animation
+#ifdef PC
+    float time = m_reference.IsEnabled() ? c_referenceTime : static_cast<float>(m_timer.GetTotalSeconds());
+#else
     float time = static_cast<float>(m_timer.GetTotalSeconds());
+#endif
 
     float alphaFade = (sin(time * 2) + 1) / 2;
 
@@ -740,6 +765,19 @@ void Game::Render()
     ID3D11ShaderResourceView* nullsrv[] = { nullptr };
     context->PSSetShaderResources(0, 1, nullsrv);
 
+#ifdef PC
+    if (m_reference.IsEnabled() && m_timer.GetFrameCount() == c_referenceFrame)
+    {
+        // Tone-mapped output depends on the display, so it is only compared for SDR
+        if (m_deviceResources->GetColorSpace() == DXGI_COLOR_SPACE_RGB_FULL_G22_NONE_P709)
+        {
+            m_reference.Check(context, m_deviceResources->GetRenderTarget(), L"tonemapped");
+        }
+
+        ExitGame(m_reference.Summarize());
+    }
+#endif
+
     // Show the new frame.
     m_deviceResources->Present();
 
@@ -838,6 +876,8 @@ void Game::GetDefaultSize(int& width, int& height) const
 // These are the resources that depend on the device.
 void Game::CreateDeviceDependentResources()
 {
+    DX_PROFILE_SCOPE("CreateDeviceDependentResources");
+
     auto device = m_deviceResources->GetD3DDevice();
 
 #ifdef XBOX
@@ -1019,6 +1059,8 @@ void Game::CreateDeviceDependentResources()
 // Allocate all memory resources that change on a window SizeChanged event.
 void Game::CreateWindowSizeDependentResources()
 {
+    DX_PROFILE_SCOPE("CreateWindowSizeDependentResources");
+
     static const XMVECTORF32 cameraPosition = { { { 0.f, 0.f, 6.f, 0.f } } };
 
     const auto size = m_deviceResources->GetOutputSize();
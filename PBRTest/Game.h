@@ -15,6 +15,10 @@
 
 #include "RenderTexture.h"
 
+#ifdef PC
+#include "ReferenceCapture.h"
+#endif
+
 constexpr uint32_t c_testTimeout = 10000;
 
 // A basic game implementation that creates a D3D11 device and
@@ -152,4 +156,9 @@ private:
     DirectX::DebugEffect::Mode m_debugMode;
     float m_pitch;
     float m_yaw;
+
+#ifdef PC
+    // Golden image checks enabled by DIRECTXTK_REFERENCE_PATH
+    DX::ReferenceCapture m_reference;
+#endif
 };
@@ -11,10 +11,14 @@
 
 #include "pch.h"
 #include "Game.h"
+#include "Profiler.h"
 
 #define USE_FAST_SEMANTICS
 
 extern void ExitGame() noexcept;
+#ifdef PC
+extern void ExitGame(int exitCode) noexcept;
+#endif
 
 using namespace DirectX;
 using namespace DirectX::SimpleMath;
@@ -37,6 +41,12 @@ namespace
 
     constexpr DXGI_FORMAT c_sdrFormat = DXGI_FORMAT_R10G10B10A2_UNORM;
     constexpr DXGI_FORMAT c_hdrFormat = DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+#ifdef PC
+    // Reference images are captured for every scene in turn, one per frame, at a fixed
+    // rotation.
+    constexpr float c_referenceTime = 1.f;
+#endif
 }
 
 //--------------------------------------------------------------------------------------
@@ -45,6 +55,9 @@ namespace
 Game::Game() noexcept(false) :
     m_scene(0),
     m_delay(0)
+#ifdef PC
+    , m_reference(L"PostProcessTest")
+#endif
 {
 #ifdef XBOX
     m_deviceResources = std::make_unique<DX::DeviceResources>(
@@ -79,6 +92,8 @@ void Game::Initialize(
 #endif
     int width, int height, DXGI_MODE_ROTATION rotation)
 {
+    DX_PROFILE_SCOPE("Initialize");
+
     m_gamePad = std::make_unique<GamePad>();
     m_keyboard = std::make_unique<Keyboard>();
 
@@ -111,6 +126,8 @@ void Game::Initialize(
 // Executes the basic game loop.
 void Game::Tick()
 {
+    DX_PROFILE_SCOPE("Tick");
+
     m_timer.Tick([&]()
     {
         Update(m_timer);
@@ -122,6 +139,8 @@ void Game::Tick()
 // Updates the world.
 void Game::Update(DX::StepTimer const& timer)
 {
+    DX_PROFILE_SCOPE("Update");
+
     auto pad = m_gamePad->GetState(0);
     auto kb = m_keyboard->GetState();
     if (kb.Escape || (pad.IsConnected() && pad.IsViewPressed()))
@@ -189,6 +208,14 @@ void Game::Update(DX::StepTimer const& timer)
             m_scene = 0;
     }
 
+#ifdef PC
+    if (m_reference.IsEnabled())
+    {
+        m_scene = static_cast<int>((timer.GetFrameCount() - 1) % MaxScene);
+        time = c_referenceTime;
+    }
+#endif
+
     m_world = Matrix::CreateRotationY(time);
 }
 #pragma endregion
@@ -197,6 +224,8 @@ void Game::Update(DX::StepTimer const& timer)
 // Draws the scene.
 void Game::Render()
 {
+    DX_PROFILE_SCOPE("Render");
+
     // Don't try to render anything before the first Update.
     if (m_timer.GetFrameCount() == 0)
     {
@@ -621,6 +650,20 @@ void Game::Render()
     ID3D11ShaderResourceView* nullsrv[] = { nullptr, nullptr };
     context->PSSetShaderResources(0, 2, nullsrv);
 
+#ifdef PC
+    if (m_reference.IsEnabled())
+    {
+        wchar_t name[16] = {};
+        swprintf_s(name, L"scene%02d", m_scene);
+        m_reference.Check(context, m_deviceResources->GetRenderTarget(), name);
+
+        if (m_scene == MaxScene - 1)
+        {
+            ExitGame(m_reference.Summarize());
+        }
+    }
+#endif
+
     // Show the new frame.
 #if defined(XBOX) && defined(USE_FAST_SEMANTICS)
     m_deviceResources->Present(0);
@@ -725,6 +768,8 @@ void Game::GetDefaultSize(int& width, int& height) const
 // These are the resources that depend on the device.
 void Game::CreateDeviceDependentResources()
 {
+    DX_PROFILE_SCOPE("CreateDeviceDependentResources");
+
     auto device = m_deviceResources->GetD3DDevice();
 
 #ifdef XBOX
@@ -767,6 +812,8 @@ void Game::CreateDeviceDependentResources()
 // Allocate all memory resources that change on a window SizeChanged event.
 void Game::CreateWindowSizeDependentResources()
 {
+    DX_PROFILE_SCOPE("CreateWindowSizeDependentResources");
+
     const auto size = m_deviceResources->GetOutputSize();
 
     auto width = UINT(size.right - size.left);
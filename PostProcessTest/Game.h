@@ -13,6 +13,10 @@
 #include "DirectXTKTest.h"
 #include "StepTimer.h"
 
+#ifdef PC
+#include "ReferenceCapture.h"
+#endif
+
 constexpr uint32_t c_testTimeout = 30000;
 
 // A basic game implementation that creates a D3D11 device and
@@ -136,4 +140,9 @@ private:
     Microsoft::WRL::ComPtr<ID3D11RenderTargetView>      m_blur2RT;
 
     float                                               m_delay;
+
+#ifdef PC
+    // Golden image checks enabled by DIRECTXTK_REFERENCE_PATH
+    DX::ReferenceCapture                                m_reference;
+#endif
 };
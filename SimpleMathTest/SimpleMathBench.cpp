@@ -0,0 +1,1169 @@
+//-------------------------------------------------------------------------------------
+// SimpleMathBench.cpp
+//
+// Microbenchmarks for the hot SimpleMath operations, reported in ns/op, millions of ops per
+// second, and ops per cycle
+//
+// Build the same source with each of the SSE2, AVX, AVX2 and no-intrinsics presets, save
+// each run with -csv:<file>, then use -compare to line the results up side by side:
+//
+//   simplemathbench -csv:sse2.csv
+//   simplemathbench -compare sse2.csv avx2.csv ni.csv
+//
+// With -threshold:<pct>, -compare exits with a failure code if any benchmark in a later
+// file is slower than the first file by more than that percentage.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX 1
+#define NODRAWTEXT
+#define NOGDI
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#ifndef _WIN32
+#include "pch.h"
+#endif
+
+#include "SimpleMath.h"
+
+#include "RayPacket.h"
+#include "SoAMath.h"
+#include "BoundingVolumeHierarchy.h"
+#include "ViewportProjection.h"
+#include "SimpleMathDouble.h"
+#include "SimpleMathHash.h"
+#include "AtlasPacker.h"
+#include "ColorConversion.h"
+#include "AudioSpatializer.h"
+#include "AudioSynth.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define BENCH_HAS_TSC
+#endif
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+
+namespace
+{
+    // Elements per pass; small enough that every input array stays in L1/L2
+    constexpr size_t c_Count = 1024;
+    constexpr int c_Trials = 5;
+
+    // Objects in the scene used for hierarchy queries
+    constexpr size_t c_SceneCount = 16384;
+
+    struct BenchData
+    {
+        Vector2     v2a[c_Count];
+        Vector2     v2b[c_Count];
+        Vector2     v2out[c_Count];
+        Vector3     v3a[c_Count];
+        Vector3     v3b[c_Count];
+        Vector3     v3c[c_Count];
+        Vector3     v3out[c_Count];
+        Vector4     v4a[c_Count];
+        Vector4     v4b[c_Count];
+        Vector4     v4out[c_Count];
+        Matrix      ma[c_Count];
+        Matrix      mb[c_Count];
+        Matrix      mout[c_Count];
+        Quaternion  qa[c_Count];
+        Quaternion  qb[c_Count];
+        Quaternion  qout[c_Count];
+        Plane       pa[c_Count];
+        Plane       pout[c_Count];
+        Color       ca[c_Count];
+        Color       cb[c_Count];
+        Color       cout[c_Count];
+        uint32_t    packed[c_Count];
+        Ray         rays[c_Count];
+        BoundingSphere  spheres[c_Count];
+        BoundingBox     boxes[c_Count];
+        float       scalars[c_Count];
+        float       fout[c_Count];
+
+        // v3a in structure-of-arrays form
+        DX::Vector3Stream   v3stream;
+        DX::Vector3Stream   v3streamOut;
+
+        // Same rays and primitives in structure-of-arrays form
+        DX::RayPacket       rayPacket;
+        DX::BoxStream       boxStream;
+        DX::SphereStream    sphereStream;
+        DX::TriangleStream  triangleStream;
+
+        // Larger scene for picking and culling with and without a hierarchy
+        std::vector<BoundingBox>    sceneBoxes;
+        DX::BoxStream               sceneStream;
+        DX::BoundingVolumeHierarchy bvh;
+
+        // Camera for projecting v3a to the screen and 'screen' back
+        Viewport    viewport;
+        Matrix      proj;
+        Matrix      view;
+        Matrix      world;
+        Vector3     screen[c_Count];
+        uint32_t    nearClip[DX::ViewportProjection::NearClipWords(c_Count)];
+        DX::ViewportProjection projection;
+
+        // Large-world transforms and positions around a camera 20 km out
+        DX::Vector3d    camera;
+        DX::Matrix4d    worldsd[c_Count];
+        DX::Vector3d    positionsd[c_Count];
+
+        // Positions with exact duplicates for welding, and v3a bucketed for radius queries
+        Vector3     weld[c_Count];
+        uint32_t    remap[c_Count];
+        DX::SpatialHashGrid grid;
+
+        // Sprite sizes for atlas packing
+        DirectX::SimpleMath::Rectangle  spriteSizes[c_Count];
+
+        // v3a and v3b as emitter positions and velocities, with a 7.1 output matrix
+        float       emitterPos[3][c_Count];
+        float       emitterVel[3][c_Count];
+        float       channelMatrix[8 * c_Count];
+
+        // 16-bit PCM output for the tone generator
+        int16_t     pcm[c_Count];
+    };
+
+    BenchData* g_data = nullptr;
+
+    // Deterministic so that runs from different presets see identical inputs
+    class Random
+    {
+    public:
+        explicit Random(uint32_t seed) noexcept : m_state(seed) {}
+
+        float Next(float minValue, float maxValue) noexcept
+        {
+            m_state = m_state * 1664525u + 1013904223u;
+            const float t = static_cast<float>(m_state >> 8) / 16777216.f;
+            return minValue + (maxValue - minValue) * t;
+        }
+
+        Vector3 NextVector3(float range) noexcept
+        {
+            const float x = Next(-range, range);
+            const float y = Next(-range, range);
+            const float z = Next(-range, range);
+            return Vector3(x, y, z);
+        }
+
+        Vector3 NextDirection() noexcept
+        {
+            Vector3 v = NextVector3(1.f);
+            if (v.LengthSquared() < 0.0001f)
+            {
+                v = Vector3::UnitZ;
+            }
+            v.Normalize();
+            return v;
+        }
+
+        Quaternion NextRotation() noexcept
+        {
+            const float yaw = Next(-XM_PI, XM_PI);
+            const float pitch = Next(-XM_PIDIV2, XM_PIDIV2);
+            const float roll = Next(-XM_PI, XM_PI);
+            return Quaternion::CreateFromYawPitchRoll(yaw, pitch, roll);
+        }
+
+    private:
+        uint32_t m_state;
+    };
+
+    void InitializeData(BenchData& data)
+    {
+        Random rng(0x5EED1234u);
+
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            data.v2a[j] = Vector2(rng.Next(-10.f, 10.f), rng.Next(-10.f, 10.f));
+            data.v2b[j] = Vector2(rng.Next(-10.f, 10.f), rng.Next(-10.f, 10.f));
+            data.v3a[j] = rng.NextVector3(10.f);
+            data.v3b[j] = rng.NextVector3(10.f);
+            data.v3c[j] = rng.NextVector3(10.f);
+
+            const Vector3 w = rng.NextVector3(10.f);
+            data.v4a[j] = Vector4(w.x, w.y, w.z, 1.f);
+            data.v4b[j] = Vector4(rng.Next(-10.f, 10.f), rng.Next(-10.f, 10.f), rng.Next(-10.f, 10.f), rng.Next(-10.f, 10.f));
+
+            data.qa[j] = rng.NextRotation();
+            data.qb[j] = rng.NextRotation();
+
+            const Vector3 scale(rng.Next(0.5f, 2.f), rng.Next(0.5f, 2.f), rng.Next(0.5f, 2.f));
+            data.ma[j] = Matrix::CreateScale(scale) * Matrix::CreateFromQuaternion(data.qa[j]) * Matrix::CreateTranslation(rng.NextVector3(100.f));
+            data.mb[j] = Matrix::CreateFromQuaternion(data.qb[j]) * Matrix::CreateTranslation(rng.NextVector3(100.f));
+
+            data.pa[j] = Plane(rng.NextVector3(10.f), rng.NextDirection());
+
+            data.ca[j] = Color(rng.Next(0.f, 1.f), rng.Next(0.f, 1.f), rng.Next(0.f, 1.f), rng.Next(0.f, 1.f));
+            data.cb[j] = Color(rng.Next(0.f, 1.f), rng.Next(0.f, 1.f), rng.Next(0.f, 1.f), rng.Next(0.f, 1.f));
+
+            // Roughly half of the rays hit their sphere, box, plane and triangle
+            const Vector3 origin = rng.NextVector3(50.f);
+            data.rays[j] = Ray(origin, rng.NextDirection());
+            const Vector3 target = origin + data.rays[j].direction * rng.Next(5.f, 50.f) + rng.NextVector3(4.f);
+            data.spheres[j] = BoundingSphere(target, rng.Next(1.f, 4.f));
+            data.boxes[j] = BoundingBox(target, Vector3(rng.Next(1.f, 4.f), rng.Next(1.f, 4.f), rng.Next(1.f, 4.f)));
+
+            data.scalars[j] = rng.Next(0.f, 1.f);
+        }
+
+        data.v3stream.Load(data.v3a, c_Count);
+        data.v3streamOut.Resize(c_Count);
+
+        data.rayPacket.Load(data.rays, c_Count);
+        data.boxStream.Load(data.boxes, c_Count);
+        data.sphereStream.Load(data.spheres, c_Count);
+
+        data.triangleStream.Resize(c_Count);
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            const Vector3 center = data.spheres[j].Center;
+            data.triangleStream.Set(j, center + data.v3a[j], center + data.v3b[j], center + data.v3c[j]);
+        }
+
+        data.sceneBoxes.resize(c_SceneCount);
+        for (auto& box : data.sceneBoxes)
+        {
+            box = BoundingBox(rng.NextVector3(200.f), Vector3(rng.Next(0.5f, 3.f), rng.Next(0.5f, 3.f), rng.Next(0.5f, 3.f)));
+        }
+
+        data.sceneStream.Load(data.sceneBoxes.data(), c_SceneCount);
+        data.bvh.Build(data.sceneBoxes.data(), c_SceneCount);
+
+        data.viewport = Viewport(0.f, 0.f, 1920.f, 1080.f);
+        data.proj = Matrix::CreatePerspectiveFieldOfView(XM_PIDIV4, 1920.f / 1080.f, 0.1f, 1000.f);
+        data.view = Matrix::CreateLookAt(Vector3(0.f, 5.f, 30.f), Vector3::Zero, Vector3::UnitY);
+        data.world = Matrix::CreateRotationY(0.5f);
+        data.projection = DX::ViewportProjection(data.viewport, data.proj, data.view, data.world);
+
+        for (auto& s : data.screen)
+        {
+            s = Vector3(rng.Next(0.f, 1920.f), rng.Next(0.f, 1080.f), rng.Next(0.f, 0.99f));
+        }
+
+        data.camera = DX::Vector3d(20000.125, 150.5, -18000.75);
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            const DX::Vector3d offset(data.v3a[j] * 50.f);
+            data.worldsd[j] = DX::Matrix4d(Matrix::CreateFromQuaternion(data.qa[j]));
+            data.worldsd[j].Translation(data.camera + offset);
+            data.positionsd[j] = data.camera + offset;
+        }
+
+        for (auto& w : data.weld)
+        {
+            w = data.v3a[static_cast<size_t>(rng.Next(0.f, float(c_Count / 4))) % (c_Count / 4)];
+        }
+
+        data.grid = DX::SpatialHashGrid(1.f);
+        data.grid.Build(data.v3a, c_Count);
+
+        for (auto& size : data.spriteSizes)
+        {
+            size = DirectX::SimpleMath::Rectangle(0, 0, long(rng.Next(4.f, 64.f)), long(rng.Next(4.f, 64.f)));
+        }
+
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            data.emitterPos[0][j] = data.v3a[j].x * 10.f;
+            data.emitterPos[1][j] = data.v3a[j].y * 10.f;
+            data.emitterPos[2][j] = data.v3a[j].z * 10.f;
+            data.emitterVel[0][j] = data.v3b[j].x;
+            data.emitterVel[1][j] = data.v3b[j].y;
+            data.emitterVel[2][j] = data.v3b[j].z;
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    // Each benchmark performs c_Count operations per call and writes every result out
+    // so the compiler cannot discard the work.
+
+    void Vector2Dot()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->fout[j] = g_data->v2a[j].Dot(g_data->v2b[j]);
+    }
+
+    void Vector2Normalize()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->v2a[j].Normalize(g_data->v2out[j]);
+    }
+
+    void Vector2Transform()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->v2out[j] = Vector2::Transform(g_data->v2a[j], g_data->ma[j]);
+    }
+
+    void Vector2Lerp()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->v2out[j] = Vector2::Lerp(g_data->v2a[j], g_data->v2b[j], g_data->scalars[j]);
+    }
+
+    void Vector3Dot()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->fout[j] = g_data->v3a[j].Dot(g_data->v3b[j]);
+    }
+
+    void Vector3Cross()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->v3out[j] = g_data->v3a[j].Cross(g_data->v3b[j]);
+    }
+
+    void Vector3Normalize()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->v3a[j].Normalize(g_data->v3out[j]);
+    }
+
+    void Vector3Transform()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->v3out[j] = Vector3::Transform(g_data->v3a[j], g_data->ma[j]);
+    }
+
+    void Vector3TransformNormal()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->v3out[j] = Vector3::TransformNormal(g_data->v3a[j], g_data->ma[j]);
+    }
+
+    void Vector3TransformQuaternion()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->v3out[j] = Vector3::Transform(g_data->v3a[j], g_data->qa[j]);
+    }
+
+    // One matrix applied to every point, per point and as a stream
+    void Vector3TransformShared()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->v3out[j] = Vector3::Transform(g_data->v3a[j], g_data->ma[0]);
+    }
+
+    void Vector3StreamTransform()
+    {
+        DX::Vector3Stream::Transform(g_data->v3stream, g_data->ma[0], g_data->v3streamOut);
+    }
+
+    void Vector4Dot()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->fout[j] = g_data->v4a[j].Dot(g_data->v4b[j]);
+    }
+
+    void Vector4Transform()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->v4out[j] = Vector4::Transform(g_data->v4a[j], g_data->ma[j]);
+    }
+
+    void MatrixMultiply()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->mout[j] = g_data->ma[j] * g_data->mb[j];
+    }
+
+    void MatrixInvert()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->mout[j] = g_data->ma[j].Invert();
+    }
+
+    void MatrixTranspose()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->mout[j] = g_data->ma[j].Transpose();
+    }
+
+    void MatrixCreateFromQuaternion()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->mout[j] = Matrix::CreateFromQuaternion(g_data->qa[j]);
+    }
+
+    void MatrixCreateLookAt()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->mout[j] = Matrix::CreateLookAt(g_data->v3a[j], g_data->v3b[j], Vector3::Up);
+    }
+
+    void MatrixDecompose()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            Vector3 scale;
+            Vector3 translation;
+            Matrix m = g_data->ma[j];
+            m.Decompose(scale, g_data->qout[j], translation);
+            g_data->v3out[j] = scale + translation;
+        }
+    }
+
+    void QuaternionMultiply()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->qout[j] = g_data->qa[j] * g_data->qb[j];
+    }
+
+    void QuaternionSlerp()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->qout[j] = Quaternion::Slerp(g_data->qa[j], g_data->qb[j], g_data->scalars[j]);
+    }
+
+    void QuaternionNormalize()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->qa[j].Normalize(g_data->qout[j]);
+    }
+
+    void QuaternionCreateFromYawPitchRoll()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->qout[j] = Quaternion::CreateFromYawPitchRoll(g_data->v3a[j]);
+    }
+
+    void PlaneNormalize()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->pa[j].Normalize(g_data->pout[j]);
+    }
+
+    void PlaneDotCoordinate()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->fout[j] = g_data->pa[j].DotCoordinate(g_data->v3a[j]);
+    }
+
+    void PlaneTransform()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->pout[j] = Plane::Transform(g_data->pa[j], g_data->ma[j]);
+    }
+
+    void ColorLerp()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->cout[j] = Color::Lerp(g_data->ca[j], g_data->cb[j], g_data->scalars[j]);
+    }
+
+    void ColorAdjustSaturation()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->ca[j].AdjustSaturation(g_data->scalars[j] * 2.f, g_data->cout[j]);
+    }
+
+    void ColorBGRA()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->packed[j] = g_data->ca[j].BGRA().c;
+    }
+
+    void RayIntersectsSphere()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            float dist = 0.f;
+            g_data->fout[j] = g_data->rays[j].Intersects(g_data->spheres[j], dist) ? dist : -1.f;
+        }
+    }
+
+    void RayIntersectsBox()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            float dist = 0.f;
+            g_data->fout[j] = g_data->rays[j].Intersects(g_data->boxes[j], dist) ? dist : -1.f;
+        }
+    }
+
+    void RayIntersectsPlane()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            float dist = 0.f;
+            g_data->fout[j] = g_data->rays[j].Intersects(g_data->pa[j], dist) ? dist : -1.f;
+        }
+    }
+
+    void RayIntersectsTriangle()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            float dist = 0.f;
+            const Vector3 center = g_data->spheres[j].Center;
+            g_data->fout[j] = g_data->rays[j].Intersects(center + g_data->v3a[j], center + g_data->v3b[j], center + g_data->v3c[j], dist) ? dist : -1.f;
+        }
+    }
+
+    // Packet versions: many rays against one primitive, or one ray against many primitives
+    void RayPacketIntersectsSphere()
+    {
+        g_data->rayPacket.Intersects(g_data->spheres[0], g_data->fout);
+    }
+
+    void RayPacketIntersectsBox()
+    {
+        g_data->rayPacket.Intersects(g_data->boxes[0], g_data->fout);
+    }
+
+    void SphereStreamIntersects()
+    {
+        g_data->sphereStream.Intersects(g_data->rays[0], g_data->fout);
+    }
+
+    void BoxStreamIntersects()
+    {
+        g_data->boxStream.Intersects(g_data->rays[0], g_data->fout);
+    }
+
+    void TriangleStreamIntersects()
+    {
+        g_data->triangleStream.Intersects(g_data->rays[0], g_data->fout);
+    }
+
+    void TriangleStreamNearest()
+    {
+        size_t index = 0;
+        float dist = 0.f;
+        g_data->fout[0] = g_data->triangleStream.Nearest(g_data->rays[0], index, dist) ? dist : -1.f;
+        g_data->fout[1] = static_cast<float>(index);
+    }
+
+    // Building a hierarchy over c_Count boxes on the calling thread
+    void BoundingVolumeHierarchyBuild()
+    {
+        DX::BoundingVolumeHierarchy bvh;
+        bvh.Build(g_data->boxes, c_Count, 1);
+        g_data->fout[0] = static_cast<float>(bvh.NodeCount());
+    }
+
+    // Picking and culling against c_SceneCount boxes, one query per element
+    void BoundingVolumeHierarchyNearest()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            uint32_t index = 0;
+            float dist = 0.f;
+            g_data->fout[j] = g_data->bvh.Nearest(g_data->rays[j], index, dist) ? dist : -1.f;
+        }
+    }
+
+    void BoundingVolumeHierarchyQuerySphere()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            const BoundingSphere sphere(g_data->spheres[j].Center, g_data->spheres[j].Radius * 4.f);
+
+            uint32_t hits = 0;
+            g_data->bvh.Query(sphere, [&hits](uint32_t) { ++hits; });
+            g_data->fout[j] = static_cast<float>(hits);
+        }
+    }
+
+    void SceneStreamNearest()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            size_t index = 0;
+            float dist = 0.f;
+            g_data->fout[j] = g_data->sceneStream.Nearest(g_data->rays[j], index, dist) ? dist : -1.f;
+        }
+    }
+
+    // Screen-space projection of c_Count points, per point and batched
+    void ViewportProject()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->v3out[j] = g_data->viewport.Project(g_data->v3a[j], g_data->proj, g_data->view, g_data->world);
+    }
+
+    void ViewportUnproject()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->v3out[j] = g_data->viewport.Unproject(g_data->screen[j], g_data->proj, g_data->view, g_data->world);
+    }
+
+    void ProjectPoints()
+    {
+        DX::ProjectPoints(g_data->viewport, g_data->v3a, c_Count, g_data->proj, g_data->view, g_data->world, g_data->v3out);
+    }
+
+    void ViewportProjectionProject()
+    {
+        g_data->fout[0] = static_cast<float>(g_data->projection.Project(g_data->v3a, c_Count, g_data->v3out, g_data->nearClip));
+    }
+
+    void ViewportProjectionUnproject()
+    {
+        g_data->projection.Unproject(g_data->screen, c_Count, g_data->v3out);
+    }
+
+    // Double-precision world data rebased to float around the camera
+    void ToCameraRelativeMatrix()
+    {
+        DX::ToCameraRelative(g_data->worldsd, c_Count, g_data->camera, g_data->mout);
+    }
+
+    void ToCameraRelativeVector3()
+    {
+        DX::ToCameraRelative(g_data->positionsd, c_Count, g_data->camera, g_data->v3out);
+    }
+
+    // Welding c_Count positions (a quarter of them unique) with ordered, unordered and grid lookups
+    void MapWeld()
+    {
+        std::map<Vector3, uint32_t> map;
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->remap[j] = map.emplace(g_data->weld[j], static_cast<uint32_t>(map.size())).first->second;
+    }
+
+    void UnorderedMapWeld()
+    {
+        std::unordered_map<Vector3, uint32_t> map(c_Count);
+        for (size_t j = 0; j < c_Count; ++j)
+            g_data->remap[j] = map.emplace(g_data->weld[j], static_cast<uint32_t>(map.size())).first->second;
+    }
+
+    void WeldPositions()
+    {
+        DX::WeldPositions(g_data->weld, c_Count, 0.f, g_data->remap);
+    }
+
+    void SpatialHashGridQuery()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            uint32_t hits = 0;
+            g_data->grid.Query(g_data->v3b[j], 1.f, [&hits](uint32_t, float) { ++hits; });
+            g_data->packed[j] = hits;
+        }
+    }
+
+    // Packing c_Count sprites into an empty 2048 x 2048 atlas
+    void AtlasPackerMaxRects()
+    {
+        DX::AtlasPacker packer(2048, 2048, DX::AtlasPacker::Method::MaxRects);
+        packer.Insert(g_data->spriteSizes, c_Count, g_data->remap);
+    }
+
+    void AtlasPackerSkyline()
+    {
+        DX::AtlasPacker packer(2048, 2048, DX::AtlasPacker::Method::Skyline);
+        packer.Insert(g_data->spriteSizes, c_Count, g_data->remap);
+    }
+
+    void ColorSRGBToRGB()
+    {
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            g_data->cout[j] = XMColorSRGBToRGB(g_data->ca[j]);
+        }
+    }
+
+    void ColorSRGBToLinear()
+    {
+        DX::SRGBToLinear(g_data->ca, c_Count, g_data->cout);
+    }
+
+    void ColorLinearToSRGB()
+    {
+        DX::LinearToSRGB(g_data->ca, c_Count, g_data->cout);
+    }
+
+    void ColorLinearToHDR10()
+    {
+        DX::LinearToHDR10(g_data->ca, c_Count, g_data->cout);
+    }
+
+    // Positional audio for c_Count moving emitters into 7.1
+    void AudioSpatializerCalculate()
+    {
+        static const DX::AudioSpatializer s_surround(DX::SpatialSpeaker_7Point1Surround);
+
+        DX::SpatialListener listener = {};
+        listener.orientFront = XMFLOAT3(0.f, 0.f, -1.f);
+        listener.orientTop = XMFLOAT3(0.f, 1.f, 0.f);
+
+        DX::SpatialEmitters emitters = {};
+        emitters.count = c_Count;
+        emitters.positionX = g_data->emitterPos[0];
+        emitters.positionY = g_data->emitterPos[1];
+        emitters.positionZ = g_data->emitterPos[2];
+        emitters.velocityX = g_data->emitterVel[0];
+        emitters.velocityY = g_data->emitterVel[1];
+        emitters.velocityZ = g_data->emitterVel[2];
+        emitters.curveDistanceScaler = 14.f;
+        emitters.dopplerScaler = 1.f;
+
+        DX::SpatialResults results = {};
+        results.matrix = g_data->channelMatrix;
+        results.stride = c_Count;
+        results.doppler = g_data->fout;
+
+        s_surround.Calculate(listener, emitters, results);
+    }
+
+    // c_Count samples of a 440 Hz sine at 48 kHz as 16-bit PCM
+    void ToneGeneratorGenerate()
+    {
+        static DX::ToneGenerator s_tone(48000, DX::Waveform::Sine, 440.f);
+        s_tone.Generate(g_data->pcm, c_Count);
+    }
+
+    typedef void(*BenchFunc)();
+
+    struct Benchmark
+    {
+        const char* name;
+        BenchFunc func;
+    };
+
+    const Benchmark g_Benchmarks[] =
+    {
+        { "Vector2::Dot", Vector2Dot },
+        { "Vector2::Normalize", Vector2Normalize },
+        { "Vector2::Transform(Matrix)", Vector2Transform },
+        { "Vector2::Lerp", Vector2Lerp },
+        { "Vector3::Dot", Vector3Dot },
+        { "Vector3::Cross", Vector3Cross },
+        { "Vector3::Normalize", Vector3Normalize },
+        { "Vector3::Transform(Matrix)", Vector3Transform },
+        { "Vector3::TransformNormal", Vector3TransformNormal },
+        { "Vector3::Transform(Quaternion)", Vector3TransformQuaternion },
+        { "Vector3::Transform(Matrix) shared", Vector3TransformShared },
+        { "Vector3Stream::Transform(Matrix)", Vector3StreamTransform },
+        { "Vector4::Dot", Vector4Dot },
+        { "Vector4::Transform(Matrix)", Vector4Transform },
+        { "Matrix::operator*", MatrixMultiply },
+        { "Matrix::Invert", MatrixInvert },
+        { "Matrix::Transpose", MatrixTranspose },
+        { "Matrix::CreateFromQuaternion", MatrixCreateFromQuaternion },
+        { "Matrix::CreateLookAt", MatrixCreateLookAt },
+        { "Matrix::Decompose", MatrixDecompose },
+        { "Quaternion::operator*", QuaternionMultiply },
+        { "Quaternion::Slerp", QuaternionSlerp },
+        { "Quaternion::Normalize", QuaternionNormalize },
+        { "Quaternion::CreateFromYawPitchRoll", QuaternionCreateFromYawPitchRoll },
+        { "Plane::Normalize", PlaneNormalize },
+        { "Plane::DotCoordinate", PlaneDotCoordinate },
+        { "Plane::Transform", PlaneTransform },
+        { "Color::Lerp", ColorLerp },
+        { "Color::AdjustSaturation", ColorAdjustSaturation },
+        { "Color::BGRA", ColorBGRA },
+        { "Ray::Intersects(BoundingSphere)", RayIntersectsSphere },
+        { "Ray::Intersects(BoundingBox)", RayIntersectsBox },
+        { "Ray::Intersects(Plane)", RayIntersectsPlane },
+        { "Ray::Intersects(Triangle)", RayIntersectsTriangle },
+        { "RayPacket::Intersects(BoundingSphere)", RayPacketIntersectsSphere },
+        { "RayPacket::Intersects(BoundingBox)", RayPacketIntersectsBox },
+        { "SphereStream::Intersects(Ray)", SphereStreamIntersects },
+        { "BoxStream::Intersects(Ray)", BoxStreamIntersects },
+        { "TriangleStream::Intersects(Ray)", TriangleStreamIntersects },
+        { "TriangleStream::Nearest(Ray)", TriangleStreamNearest },
+        { "BoundingVolumeHierarchy::Build", BoundingVolumeHierarchyBuild },
+        { "BoundingVolumeHierarchy::Nearest(Ray)", BoundingVolumeHierarchyNearest },
+        { "BoundingVolumeHierarchy::Query(BoundingSphere)", BoundingVolumeHierarchyQuerySphere },
+        { "BoxStream::Nearest(Ray) over scene", SceneStreamNearest },
+        { "Viewport::Project", ViewportProject },
+        { "Viewport::Unproject", ViewportUnproject },
+        { "ProjectPoints", ProjectPoints },
+        { "ViewportProjection::Project(nearClip)", ViewportProjectionProject },
+        { "ViewportProjection::Unproject", ViewportProjectionUnproject },
+        { "ToCameraRelative(Matrix4d)", ToCameraRelativeMatrix },
+        { "ToCameraRelative(Vector3d)", ToCameraRelativeVector3 },
+        { "std::map<Vector3> weld", MapWeld },
+        { "std::unordered_map<Vector3> weld", UnorderedMapWeld },
+        { "WeldPositions", WeldPositions },
+        { "SpatialHashGrid::Query(radius)", SpatialHashGridQuery },
+        { "AtlasPacker::Insert(MaxRects)", AtlasPackerMaxRects },
+        { "AtlasPacker::Insert(Skyline)", AtlasPackerSkyline },
+        { "XMColorSRGBToRGB", ColorSRGBToRGB },
+        { "SRGBToLinear", ColorSRGBToLinear },
+        { "LinearToSRGB", ColorLinearToSRGB },
+        { "LinearToHDR10", ColorLinearToHDR10 },
+        { "AudioSpatializer::Calculate(7.1)", AudioSpatializerCalculate },
+        { "ToneGenerator::Generate(int16)", ToneGeneratorGenerate },
+    };
+
+    //---------------------------------------------------------------------------------
+    const char* GetPresetName() noexcept
+    {
+#if defined(_XM_NO_INTRINSICS_)
+        return "NI";
+#elif defined(_XM_ARM_NEON_INTRINSICS_)
+        return "NEON";
+#elif defined(_XM_AVX2_INTRINSICS_)
+        return "AVX2";
+#elif defined(_XM_AVX_INTRINSICS_)
+        return "AVX";
+#elif defined(_XM_SSE4_INTRINSICS_)
+        return "SSE4";
+#elif defined(_XM_SSE3_INTRINSICS_)
+        return "SSE3";
+#else
+        return "SSE2";
+#endif
+    }
+
+    uint64_t ReadCycleCounter() noexcept
+    {
+#ifdef BENCH_HAS_TSC
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    struct Measurement
+    {
+        double nsPerOp;
+        double opsPerCycle;
+    };
+
+    // Best of several trials, each long enough to swamp timer resolution. Cycles are
+    // counted with the time stamp counter, which ticks at the processor's nominal rate,
+    // so ops per cycle is only reported on x86/x64.
+    Measurement Measure(BenchFunc func, double targetSeconds)
+    {
+        using clock = std::chrono::steady_clock;
+
+        func();
+
+        size_t reps = 1;
+        for (;;)
+        {
+            const auto start = clock::now();
+            for (size_t r = 0; r < reps; ++r)
+                func();
+            const std::chrono::duration<double> elapsed = clock::now() - start;
+            if (elapsed.count() >= targetSeconds || reps >= (size_t(1) << 30))
+                break;
+            reps *= 2;
+        }
+
+        Measurement best = { 0., 0. };
+        double bestSeconds = 0.;
+        for (int trial = 0; trial < c_Trials; ++trial)
+        {
+            const uint64_t startCycles = ReadCycleCounter();
+            const auto start = clock::now();
+            for (size_t r = 0; r < reps; ++r)
+                func();
+            const std::chrono::duration<double> elapsed = clock::now() - start;
+            const uint64_t cycles = ReadCycleCounter() - startCycles;
+
+            if (trial == 0 || elapsed.count() < bestSeconds)
+            {
+                const double ops = double(reps) * double(c_Count);
+                bestSeconds = elapsed.count();
+                best.nsPerOp = bestSeconds * 1.0e9 / ops;
+                best.opsPerCycle = (cycles > 0) ? ops / double(cycles) : 0.;
+            }
+        }
+
+        return best;
+    }
+
+    //---------------------------------------------------------------------------------
+    struct ResultSet
+    {
+        std::string label;
+        std::map<std::string, Measurement> results;
+        std::vector<std::string> order;
+    };
+
+    bool SplitCSV(const std::string& line, std::vector<std::string>& fields)
+    {
+        fields.clear();
+        std::string field;
+        std::istringstream stream(line);
+        while (std::getline(stream, field, ','))
+        {
+            fields.emplace_back(field);
+        }
+        return fields.size() >= 4;
+    }
+
+    bool LoadResults(const char* path, ResultSet& set)
+    {
+        std::ifstream in(path);
+        if (!in)
+        {
+            printf("ERROR: Failed to open %s\n", path);
+            return false;
+        }
+
+        std::string line;
+        std::vector<std::string> fields;
+        bool header = true;
+        while (std::getline(in, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+
+            if (header)
+            {
+                header = false;
+                if (line.compare(0, 7, "preset,") == 0)
+                    continue;
+            }
+
+            if (line.empty())
+                continue;
+
+            if (!SplitCSV(line, fields))
+            {
+                printf("ERROR: Malformed line in %s: %s\n", path, line.c_str());
+                return false;
+            }
+
+            if (set.label.empty())
+                set.label = fields[0];
+
+            Measurement m = { atof(fields[2].c_str()), atof(fields[3].c_str()) };
+            if (set.results.find(fields[1]) == set.results.end())
+                set.order.emplace_back(fields[1]);
+            set.results[fields[1]] = m;
+        }
+
+        if (set.results.empty())
+        {
+            printf("ERROR: No results in %s\n", path);
+            return false;
+        }
+
+        if (set.label.empty())
+            set.label = path;
+
+        return true;
+    }
+
+    int Compare(const std::vector<const char*>& files, double threshold)
+    {
+        std::vector<ResultSet> sets(files.size());
+        for (size_t j = 0; j < files.size(); ++j)
+        {
+            if (!LoadResults(files[j], sets[j]))
+                return 1;
+        }
+
+        printf("%-48s", "ns/op");
+        for (const auto& set : sets)
+            printf(" %20s", set.label.c_str());
+        printf("\n");
+
+        size_t regressions = 0;
+        for (const auto& name : sets[0].order)
+        {
+            const double base = sets[0].results[name].nsPerOp;
+
+            printf("%-48s %20.3f", name.c_str(), base);
+            for (size_t j = 1; j < sets.size(); ++j)
+            {
+                auto it = sets[j].results.find(name);
+                if (it == sets[j].results.end())
+                {
+                    printf(" %20s", "-");
+                    continue;
+                }
+
+                const double value = it->second.nsPerOp;
+                const double speedup = (value > 0.) ? base / value : 0.;
+                const bool regressed = (threshold > 0.) && (value > base * (1. + threshold / 100.));
+                if (regressed)
+                    ++regressions;
+
+                char cell[32] = {};
+                snprintf(cell, sizeof(cell), "%.3f (%.2fx)%s", value, speedup, regressed ? "!" : "");
+                printf(" %20s", cell);
+            }
+            printf("\n");
+        }
+
+        if (threshold > 0.)
+        {
+            if (regressions > 0)
+            {
+                printf("FAILED: %zu benchmarks are more than %.1f%% slower than %s\n", regressions, threshold, sets[0].label.c_str());
+                return 1;
+            }
+
+            printf("No benchmarks are more than %.1f%% slower than %s\n", threshold, sets[0].label.c_str());
+        }
+
+        return 0;
+    }
+
+    void PrintUsage()
+    {
+        printf("Usage: simplemathbench [-quick] [-filter:<text>] [-preset:<name>] [-csv:<file>]\n");
+        printf("       simplemathbench -compare <baseline.csv> <other.csv>... [-threshold:<pct>]\n");
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    bool quick = false;
+    bool compare = false;
+    double threshold = 0.;
+    const char* filter = nullptr;
+    const char* csvPath = nullptr;
+    const char* preset = GetPresetName();
+    std::vector<const char*> files;
+
+    for (int j = 1; j < argc; ++j)
+    {
+        const char* arg = argv[j];
+        if (!strcmp(arg, "-quick"))
+        {
+            quick = true;
+        }
+        else if (!strcmp(arg, "-compare"))
+        {
+            compare = true;
+        }
+        else if (!strncmp(arg, "-threshold:", 11))
+        {
+            threshold = atof(arg + 11);
+        }
+        else if (!strncmp(arg, "-filter:", 8))
+        {
+            filter = arg + 8;
+        }
+        else if (!strncmp(arg, "-preset:", 8))
+        {
+            preset = arg + 8;
+        }
+        else if (!strncmp(arg, "-csv:", 5))
+        {
+            csvPath = arg + 5;
+        }
+        else if (compare && *arg != '-')
+        {
+            files.push_back(arg);
+        }
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (compare)
+    {
+        if (files.empty())
+        {
+            PrintUsage();
+            return 1;
+        }
+
+        return Compare(files, threshold);
+    }
+
+    printf("*** SimpleMathBench (using DirectXMath version %03d, %s)\n", DIRECTX_MATH_VERSION, preset);
+
+    if (!XMVerifyCPUSupport())
+    {
+        printf("FAILED: XMVerifyCPUSupport reports a failure on this platform\n");
+        return 1;
+    }
+
+    std::unique_ptr<BenchData> data(new BenchData);
+    g_data = data.get();
+    InitializeData(*data);
+
+    std::ofstream csv;
+    if (csvPath)
+    {
+        csv.open(csvPath, std::ios::out | std::ios::trunc);
+        if (!csv)
+        {
+            printf("ERROR: Failed to create %s\n", csvPath);
+            return 1;
+        }
+        csv << "preset,benchmark,ns_per_op,ops_per_cycle\n";
+    }
+
+    const double targetSeconds = quick ? 0.002 : 0.02;
+
+    printf("%-48s %12s %12s %12s\n", "benchmark", "ns/op", "Mops/s", "ops/cycle");
+
+    for (const auto& bench : g_Benchmarks)
+    {
+        if (filter && !strstr(bench.name, filter))
+            continue;
+
+        const Measurement m = Measure(bench.func, targetSeconds);
+
+        printf("%-48s %12.3f %12.2f %12.3f\n", bench.name, m.nsPerOp, (m.nsPerOp > 0.) ? 1000. / m.nsPerOp : 0., m.opsPerCycle);
+
+        if (csv.is_open())
+        {
+            char line[256] = {};
+            snprintf(line, sizeof(line), "%s,%s,%.4f,%.4f\n", preset, bench.name, m.nsPerOp, m.opsPerCycle);
+            csv << line;
+        }
+    }
+
+    float checksum = 0.f;
+    for (size_t j = 0; j < c_Count; ++j)
+        checksum += g_data->fout[j];
+    printf("checksum %f\n", double(checksum));
+
+    g_data = nullptr;
+
+    if (csv.is_open())
+    {
+        csv.flush();
+        if (!csv)
+        {
+            printf("ERROR: Failed to write %s\n", csvPath);
+            return 1;
+        }
+    }
+
+    return 0;
+}
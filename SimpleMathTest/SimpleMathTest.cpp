@@ -6159,6 +6159,20 @@ extern int TestD3D11();
 extern int TestD3D12();
 #endif
 
+extern int TestAudio();
+extern int TestSoA();
+extern int TestConstexpr();
+extern int TestRayPacket();
+extern int TestBVH();
+extern int TestViewportProjection();
+extern int TestV3d();
+extern int TestM4d();
+extern int TestCameraRelative();
+extern int TestHash();
+extern int TestSpatialHashGrid();
+extern int TestAtlasPacker();
+extern int TestColorConversion();
+
 typedef int (*TestFN)();
 
 static struct Test
@@ -6184,6 +6198,19 @@ static struct Test
     { "D3D12", TestD3D12 },
 #endif
     { "std::less", TestL },
+    { "AudioSpatializer", TestAudio },
+    { "SoAMath", TestSoA },
+    { "ConstexprMath", TestConstexpr },
+    { "RayPacket", TestRayPacket },
+    { "BVH", TestBVH },
+    { "ViewportProjection", TestViewportProjection },
+    { "Vector3d", TestV3d },
+    { "Matrix4d", TestM4d },
+    { "CameraRelative", TestCameraRelative },
+    { "Hash", TestHash },
+    { "SpatialHashGrid", TestSpatialHashGrid },
+    { "AtlasPacker", TestAtlasPacker },
+    { "ColorConversion", TestColorConversion },
 };
 
 #ifdef _WIN32
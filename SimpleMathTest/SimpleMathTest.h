@@ -16,6 +16,8 @@
 #include <crtdbg.h>
 #endif
 
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <functional>
 #include <iterator>
@@ -34,6 +36,9 @@ XMGLOBALCONST DirectX::XMVECTORF32 VEPSILON = { { { EPSILON, EPSILON, EPSILON, E
 XMGLOBALCONST DirectX::XMVECTORF32 VEPSILON2 = { { { EPSILON2, EPSILON2, EPSILON2, EPSILON2 } } };
 XMGLOBALCONST DirectX::XMVECTORF32 VEPSILON3 = { { { EPSILON3, EPSILON3, EPSILON3, EPSILON3 } } };
 
+// Element counts for batch kernels: none, partial and full SIMD lanes, and several 32-bit mask words
+constexpr size_t c_BatchCounts[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 64, 100 };
+
 inline void FormatValue(bool value, char* output, size_t outputSize)
 {
 #ifdef _WIN32
@@ -136,6 +141,26 @@ struct near_equal_to
     }
 };
 
+// Batch kernels may fuse or reorder operations, so this scales the tolerance by the expected magnitude
+struct relative_near_equal_to
+{
+    bool operator() (float a, float b) const
+    {
+        return std::fabs(a - b) <= EPSILON3 * std::max(1.f, std::fabs(b));
+    }
+
+    bool operator() (DirectX::FXMVECTOR a, DirectX::FXMVECTOR b) const
+    {
+        const DirectX::XMVECTOR epsilon = DirectX::XMVectorMultiply(VEPSILON3, DirectX::XMVectorMax(DirectX::g_XMOne, DirectX::XMVectorAbs(b)));
+        return DirectX::XMVector4NearEqual(a, b, epsilon);
+    }
+
+    bool operator() (DirectX::CXMMATRIX a, DirectX::CXMMATRIX b) const
+    {
+        return (*this)(a.r[0], b.r[0]) && (*this)(a.r[1], b.r[1]) && (*this)(a.r[2], b.r[2]) && (*this)(a.r[3], b.r[3]);
+    }
+};
+
 
 template<typename TValue, typename TCompare>
 inline bool VerifyValue(TValue const& value, TValue const& expected, TCompare const& compare, char const* file, int line)
@@ -160,3 +185,6 @@ inline bool VerifyValue(TValue const& value, TValue const& expected, TCompare co
 
 #define VerifyNearEqual(value, expected) \
     success &= VerifyValue(value, expected, near_equal_to(), __FUNCTION__, __LINE__)
+
+#define VerifyRelativeEqual(value, expected) \
+    success &= VerifyValue(value, expected, relative_near_equal_to(), __FUNCTION__, __LINE__)
@@ -0,0 +1,399 @@
+//-------------------------------------------------------------------------------------
+// SimpleMathTestAtlas.cpp
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX 1
+#define NODRAWTEXT
+#define NOGDI
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#ifndef _WIN32
+#include "pch.h"
+#endif
+
+#include "SimpleMath.h"
+
+#include "SimpleMathTest.h"
+
+#include "AtlasPacker.h"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DX;
+
+namespace
+{
+    using Rectangle = SimpleMath::Rectangle;
+
+    bool SameRect(const Rectangle& a, const Rectangle& b)
+    {
+        return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+    }
+
+    // Every live rectangle is inside the atlas and (with padding) overlaps no other
+    bool VerifyLayout(const char* name, const AtlasPacker& packer, std::vector<uint32_t> ids, long padding)
+    {
+        const Rectangle atlas(0, 0, packer.Width(), packer.Height());
+
+        // Removed ids come back for later rectangles, so the same id can be listed twice
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+        std::vector<Rectangle> padded;
+        uint64_t area = 0;
+        for (const uint32_t id : ids)
+        {
+            if (!packer.IsValid(id))
+                continue;
+
+            const Rectangle rect = packer.Get(id);
+            const Rectangle reserved(rect.x, rect.y, rect.width + padding, rect.height + padding);
+            if (!atlas.Contains(reserved))
+            {
+                printf("ERROR: %s rectangle %u outside the atlas\n", name, id);
+                return false;
+            }
+
+            padded.push_back(reserved);
+            area += uint64_t(rect.width) * uint64_t(rect.height);
+        }
+
+        for (size_t j = 0; j < padded.size(); ++j)
+        {
+            for (size_t k = j + 1; k < padded.size(); ++k)
+            {
+                if (padded[j].Intersects(padded[k]))
+                {
+                    printf("ERROR: %s rectangles overlap (%ld,%ld %ldx%ld) (%ld,%ld %ldx%ld)\n", name,
+                        padded[j].x, padded[j].y, padded[j].width, padded[j].height,
+                        padded[k].x, padded[k].y, padded[k].width, padded[k].height);
+                    return false;
+                }
+            }
+        }
+
+        if (padded.size() != packer.Count() || area != packer.UsedArea())
+        {
+            printf("ERROR: %s count %zu / %zu, area %llu / %llu\n", name, padded.size(), packer.Count(),
+                static_cast<unsigned long long>(area), static_cast<unsigned long long>(packer.UsedArea()));
+            return false;
+        }
+
+        return true;
+    }
+
+    std::vector<Rectangle> RandomSizes(std::mt19937& gen, size_t count)
+    {
+        // Mostly small sprites with a few larger panels, as a UI atlas would see
+        std::uniform_int_distribution<long> small(4, 48);
+        std::uniform_int_distribution<long> large(64, 160);
+        std::uniform_int_distribution<int> pick(0, 15);
+
+        std::vector<Rectangle> sizes(count);
+        for (auto& size : sizes)
+        {
+            const bool panel = pick(gen) == 0;
+            size.width = panel ? large(gen) : small(gen);
+            size.height = panel ? large(gen) : small(gen);
+        }
+        return sizes;
+    }
+}
+
+int TestAtlasPacker()
+{
+    bool success = true;
+
+    std::mt19937 gen(2027);
+
+    const struct
+    {
+        const char*         name;
+        AtlasPacker::Method method;
+        long                padding;
+        float               minOccupancy;
+    } configs[] =
+    {
+        { "MaxRects", AtlasPacker::Method::MaxRects, 0, 0.9f },
+        { "MaxRects padded", AtlasPacker::Method::MaxRects, 2, 0.8f },
+        { "Skyline", AtlasPacker::Method::Skyline, 0, 0.85f },
+        { "Skyline padded", AtlasPacker::Method::Skyline, 2, 0.75f },
+    };
+
+    for (const auto& config : configs)
+    {
+        const long padding = config.padding;
+
+        // Exact fit, then full
+        {
+            AtlasPacker packer(256, 256, config.method, padding);
+            for (size_t j = 0; j < 4; ++j)
+            {
+                uint32_t id;
+                Rectangle placed;
+                if (!packer.Insert(128 - padding, 128 - padding, id, placed) || id != j)
+                {
+                    printf("ERROR: %s exact fit %zu\n", config.name, j);
+                    success = false;
+                }
+            }
+
+            uint32_t id;
+            Rectangle placed;
+            if (packer.Insert(1, 1, id, placed) || id != AtlasPacker::c_Invalid || packer.Count() != 4)
+            {
+                printf("ERROR: %s full atlas\n", config.name);
+                success = false;
+            }
+
+            if (packer.Insert(257, 1, id, placed) || packer.Insert(1, 257, id, placed))
+            {
+                printf("ERROR: %s larger than the atlas\n", config.name);
+                success = false;
+            }
+
+            const std::vector<uint32_t> ids = { 0, 1, 2, 3 };
+            if (!VerifyLayout(config.name, packer, ids, padding))
+                success = false;
+        }
+
+        // Fill with a batch, then check layout and occupancy
+        AtlasPacker packer(1024, 1024, config.method, padding);
+        const std::vector<Rectangle> sizes = RandomSizes(gen, 2000);
+
+        std::vector<uint32_t> ids(sizes.size());
+        std::vector<Rectangle> placed(sizes.size());
+
+        const size_t count = packer.Insert(sizes.data(), sizes.size(), ids.data(), placed.data());
+
+        size_t valid = 0;
+        for (size_t j = 0; j < sizes.size(); ++j)
+        {
+            if (ids[j] == AtlasPacker::c_Invalid)
+                continue;
+
+            ++valid;
+            const Rectangle rect = packer.Get(ids[j]);
+            if (!SameRect(rect, placed[j]) || rect.width != sizes[j].width || rect.height != sizes[j].height)
+            {
+                printf("ERROR: %s batch %zu\n", config.name, j);
+                success = false;
+            }
+        }
+
+        if (valid != count || count == sizes.size() || !VerifyLayout(config.name, packer, ids, padding))
+        {
+            printf("ERROR: %s batch placed %zu of %zu\n", config.name, count, sizes.size());
+            success = false;
+        }
+
+        // Only the part of the atlas actually used counts; the last row is partly empty
+        const Rectangle bounds = packer.UsedBounds();
+        const float occupancy = float(double(packer.UsedArea()) / (double(bounds.width) * double(bounds.height)));
+        if (occupancy < config.minOccupancy || packer.Occupancy() > 1.f)
+        {
+            printf("ERROR: %s occupancy %f (%f of the atlas)\n", config.name, occupancy, packer.Occupancy());
+            success = false;
+        }
+
+        // Remove every third rectangle; ids come back in use for new rectangles
+        size_t removed = 0;
+        for (size_t j = 0; j < ids.size(); j += 3)
+        {
+            if (ids[j] == AtlasPacker::c_Invalid)
+                continue;
+
+            if (!packer.Remove(ids[j]) || packer.Remove(ids[j]) || packer.IsValid(ids[j]))
+            {
+                printf("ERROR: %s Remove %u\n", config.name, ids[j]);
+                success = false;
+            }
+            ++removed;
+        }
+
+        VerifyEqual(static_cast<uint32_t>(packer.Count()), static_cast<uint32_t>(count - removed));
+        if (!VerifyLayout(config.name, packer, ids, padding))
+            success = false;
+
+        // MaxRects reuses the space straight away; Skyline only after Defragment
+        size_t reinserted = 0;
+        for (size_t j = 0; j < 64; ++j)
+        {
+            uint32_t id;
+            Rectangle rect;
+            if (packer.Insert(sizes[j].width, sizes[j].height, id, rect))
+            {
+                ids.push_back(id);
+                ++reinserted;
+            }
+        }
+
+        if (config.method == AtlasPacker::Method::MaxRects && reinserted == 0)
+        {
+            printf("ERROR: %s space not reused after Remove\n", config.name);
+            success = false;
+        }
+
+        if (!VerifyLayout(config.name, packer, ids, padding))
+            success = false;
+
+        // Defragment keeps ids and sizes, and reports every move
+        {
+            std::vector<Rectangle> before(ids.size());
+            for (size_t j = 0; j < ids.size(); ++j)
+            {
+                if (packer.IsValid(ids[j]))
+                {
+                    before[j] = packer.Get(ids[j]);
+                }
+            }
+
+            const uint64_t area = packer.UsedArea();
+            const long height = packer.UsedBounds().height;
+
+            std::vector<AtlasPacker::Move> moves;
+            if (!packer.Defragment(&moves))
+            {
+                printf("ERROR: %s Defragment\n", config.name);
+                success = false;
+            }
+
+            if (packer.UsedArea() != area || packer.UsedBounds().height > height || moves.empty())
+            {
+                printf("ERROR: %s Defragment area %llu, height %ld -> %ld, moves %zu\n", config.name,
+                    static_cast<unsigned long long>(packer.UsedArea()), height, packer.UsedBounds().height, moves.size());
+                success = false;
+            }
+
+            for (const auto& move : moves)
+            {
+                if (!SameRect(packer.Get(move.id), move.to)
+                    || move.from.width != move.to.width || move.from.height != move.to.height)
+                {
+                    printf("ERROR: %s Defragment move %u\n", config.name, move.id);
+                    success = false;
+                }
+            }
+
+            for (size_t j = 0; j < ids.size(); ++j)
+            {
+                if (!packer.IsValid(ids[j]))
+                    continue;
+
+                const Rectangle after = packer.Get(ids[j]);
+                const bool moved = std::any_of(moves.cbegin(), moves.cend(), [&](const AtlasPacker::Move& m) { return m.id == ids[j]; });
+                if (after.width != before[j].width || after.height != before[j].height || (!moved && !SameRect(after, before[j])))
+                {
+                    printf("ERROR: %s Defragment id %u\n", config.name, ids[j]);
+                    success = false;
+                }
+            }
+
+            if (!VerifyLayout(config.name, packer, ids, padding))
+                success = false;
+        }
+
+        // Clear starts over
+        packer.Clear();
+        {
+            uint32_t id;
+            Rectangle rect;
+            if (packer.Count() != 0 || packer.UsedArea() != 0 || !packer.Insert(1024 - padding, 1024 - padding, id, rect) || id != 0)
+            {
+                printf("ERROR: %s Clear\n", config.name);
+                success = false;
+            }
+        }
+    }
+
+    // A repack that cannot fit leaves the atlas as it was
+    {
+        AtlasPacker packer(100, 100, AtlasPacker::Method::Skyline);
+        uint32_t id;
+        Rectangle rect;
+        std::vector<uint32_t> ids;
+        for (size_t j = 0; j < 10; ++j)
+        {
+            if (packer.Insert(10, 100, id, rect))
+                ids.push_back(id);
+        }
+        VerifyEqual(static_cast<uint32_t>(ids.size()), 10u);
+
+        const Rectangle before = packer.Get(ids[5]);
+        if (!packer.Defragment() || !SameRect(packer.Get(ids[5]), before))
+        {
+            printf("ERROR: Defragment of a full atlas\n");
+            success = false;
+        }
+    }
+
+    // Invalid arguments
+    {
+        const long badSizes[][3] = { { 0, 16, 0 }, { 16, 0, 0 }, { -1, 16, 0 }, { 16, 16, -1 } };
+        for (const auto& bad : badSizes)
+        {
+            try
+            {
+                AtlasPacker packer(bad[0], bad[1], AtlasPacker::Method::MaxRects, bad[2]);
+                printf("ERROR: expected to throw for %ld x %ld padding %ld\n", bad[0], bad[1], bad[2]);
+                success = false;
+            }
+            catch (const std::invalid_argument&)
+            {
+            }
+        }
+
+        AtlasPacker packer(64, 64);
+        uint32_t id;
+        Rectangle rect;
+        try
+        {
+            packer.Insert(0, 4, id, rect);
+            printf("ERROR: Insert expected to throw for an empty rectangle\n");
+            success = false;
+        }
+        catch (const std::invalid_argument&)
+        {
+        }
+
+        try
+        {
+            packer.Get(7);
+            printf("ERROR: Get expected to throw for an unknown id\n");
+            success = false;
+        }
+        catch (const std::out_of_range&)
+        {
+        }
+
+        if (packer.Remove(7) || packer.Remove(AtlasPacker::c_Invalid))
+        {
+            printf("ERROR: Remove of an unknown id\n");
+            success = false;
+        }
+
+        // A default atlas has no room
+        AtlasPacker empty;
+        if (empty.Insert(1, 1, id, rect) || empty.Occupancy() != 0.f || !empty.Defragment())
+        {
+            printf("ERROR: default atlas\n");
+            success = false;
+        }
+    }
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,409 @@
+//-------------------------------------------------------------------------------------
+// SimpleMathTestAudio.cpp
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX 1
+#define NODRAWTEXT
+#define NOGDI
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#ifndef _WIN32
+#include "pch.h"
+#endif
+
+#include "SimpleMath.h"
+
+#include "SimpleMathTest.h"
+
+#include "AudioSpatializer.h"
+
+#include <cmath>
+#include <random>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DX;
+
+namespace
+{
+    // Same values as the Audio3DTest cones and curves
+    constexpr SpatialCone Listener_DirectionalCone = { XM_PI*5.0f/6.0f, XM_PI*11.0f/6.0f, 1.0f, 0.75f, 0.0f, 0.25f, 0.708f, 1.0f };
+
+    constexpr SpatialCurvePoint Emitter_LFE_CurvePoints[3] = { { 0.0f, 1.0f }, { 0.25f, 0.0f}, { 1.0f, 0.0f } };
+    constexpr SpatialCurve      Emitter_LFE_Curve = { &Emitter_LFE_CurvePoints[0], 3 };
+
+    constexpr SpatialCurvePoint Emitter_Reverb_CurvePoints[3] = { { 0.0f, 0.5f}, { 0.75f, 1.0f }, { 1.0f, 0.0f } };
+    constexpr SpatialCurve      Emitter_Reverb_Curve = { &Emitter_Reverb_CurvePoints[0], 3 };
+
+    constexpr float c_Sqrt2Over2 = 0.70710678f;
+
+    SpatialListener DefaultListener() noexcept
+    {
+        SpatialListener listener = {};
+        listener.orientFront = XMFLOAT3(0.f, 0.f, -1.f);
+        listener.orientTop = XMFLOAT3(0.f, 1.f, 0.f);
+        return listener;
+    }
+
+    // Spatializes a single emitter, returning the channel matrix in 'matrix'
+    struct OneEmitter
+    {
+        float x, y, z;
+        float vx, vy, vz;
+        float innerRadius;
+
+        float matrix[11];
+        float doppler;
+        float lpf;
+        float reverb;
+        float distance;
+    };
+
+    void Spatialize(
+        const AudioSpatializer& spatializer,
+        const SpatialListener& listener,
+        OneEmitter& emitter,
+        float curveDistanceScaler = 1.f,
+        const SpatialCurve* lfeCurve = nullptr,
+        const SpatialCurve* reverbCurve = nullptr,
+        bool rhcoords = true)
+    {
+        SpatialEmitters emitters = {};
+        emitters.count = 1;
+        emitters.positionX = &emitter.x;
+        emitters.positionY = &emitter.y;
+        emitters.positionZ = &emitter.z;
+        emitters.velocityX = &emitter.vx;
+        emitters.velocityY = &emitter.vy;
+        emitters.velocityZ = &emitter.vz;
+        emitters.innerRadius = &emitter.innerRadius;
+        emitters.curveDistanceScaler = curveDistanceScaler;
+        emitters.dopplerScaler = 1.f;
+        emitters.pLFECurve = lfeCurve;
+        emitters.pReverbCurve = reverbCurve;
+
+        SpatialResults results = {};
+        results.matrix = emitter.matrix;
+        results.stride = 1;
+        results.doppler = &emitter.doppler;
+        results.lpfDirect = &emitter.lpf;
+        results.reverbLevel = &emitter.reverb;
+        results.distance = &emitter.distance;
+
+        spatializer.Calculate(listener, emitters, results, rhcoords);
+    }
+}
+
+int TestAudio()
+{
+    bool success = true;
+
+    // Channel layouts
+    {
+        const AudioSpatializer mono(SpatialSpeaker_Mono);
+        const AudioSpatializer stereo(SpatialSpeaker_Stereo);
+        const AudioSpatializer surround(SpatialSpeaker_5Point1);
+        const AudioSpatializer surround7(SpatialSpeaker_7Point1Surround);
+
+        VerifyEqual(mono.GetChannelCount(), 1u);
+        VerifyEqual(stereo.GetChannelCount(), 2u);
+        VerifyEqual(surround.GetChannelCount(), 6u);
+        VerifyEqual(surround7.GetChannelCount(), 8u);
+
+        if (mono.GetLFEChannel() != -1 || stereo.GetLFEChannel() != -1
+            || surround.GetLFEChannel() != 3 || surround7.GetLFEChannel() != 3)
+        {
+            printf("ERROR: LFE channel index\n");
+            success = false;
+        }
+
+        bool thrown = false;
+        try
+        {
+            const AudioSpatializer lfeOnly(SpatialSpeaker_LowFrequency);
+        }
+        catch (const std::invalid_argument&)
+        {
+            thrown = true;
+        }
+
+        if (!thrown)
+        {
+            printf("ERROR: expected LFE-only layout to be rejected\n");
+            success = false;
+        }
+    }
+
+    const SpatialListener listener = DefaultListener();
+
+    // Stereo panning
+    {
+        const AudioSpatializer stereo(SpatialSpeaker_Stereo);
+
+        // Straight ahead
+        OneEmitter e = {};
+        e.z = -1.f;
+        Spatialize(stereo, listener, e);
+        VerifyNearEqual(e.matrix[0], c_Sqrt2Over2);
+        VerifyNearEqual(e.matrix[1], c_Sqrt2Over2);
+        VerifyNearEqual(e.distance, 1.f);
+        VerifyNearEqual(e.doppler, 1.f);
+        VerifyNearEqual(e.lpf, 0.f);
+        VerifyNearEqual(e.reverb, 1.f);
+
+        // On the front-right speaker
+        e = {};
+        e.x = c_Sqrt2Over2;
+        e.z = -c_Sqrt2Over2;
+        Spatialize(stereo, listener, e);
+        VerifyNearEqual(e.matrix[0], 0.f);
+        VerifyNearEqual(e.matrix[1], 1.f);
+
+        // Hard right, panned between front-right and (around the back) front-left
+        e = {};
+        e.x = 1.f;
+        Spatialize(stereo, listener, e);
+        if (!XMScalarNearEqual(e.matrix[0], std::sin(XM_PI / 12.f), EPSILON2)
+            || !XMScalarNearEqual(e.matrix[1], std::cos(XM_PI / 12.f), EPSILON2))
+        {
+            printf("ERROR: stereo hard right %f %f\n", e.matrix[0], e.matrix[1]);
+            success = false;
+        }
+
+        // Left-handed coordinates flip the sides
+        SpatialListener lh = listener;
+        lh.orientFront = XMFLOAT3(0.f, 0.f, 1.f);
+        e = {};
+        e.x = c_Sqrt2Over2;
+        e.z = c_Sqrt2Over2;
+        Spatialize(stereo, lh, e, 1.f, nullptr, nullptr, false);
+        VerifyNearEqual(e.matrix[0], 0.f);
+        VerifyNearEqual(e.matrix[1], 1.f);
+
+        // Constant power around the full circle
+        for (int j = 0; j < 64; ++j)
+        {
+            const float angle = XM_2PI * float(j) / 64.f;
+            e = {};
+            e.x = std::sin(angle);
+            e.z = -std::cos(angle);
+            Spatialize(stereo, listener, e);
+
+            const float power = e.matrix[0] * e.matrix[0] + e.matrix[1] * e.matrix[1];
+            if (!XMScalarNearEqual(power, 1.f, EPSILON3))
+            {
+                printf("ERROR: stereo power %f at angle %f\n", power, angle);
+                success = false;
+            }
+        }
+    }
+
+    // 5.1 panning, LFE curve, and distance attenuation
+    {
+        const AudioSpatializer surround(SpatialSpeaker_5Point1);
+
+        OneEmitter e = {};
+        e.z = -1.75f;
+        Spatialize(surround, listener, e, 14.f, &Emitter_LFE_Curve);
+
+        // FL FR FC LFE BL BR
+        VerifyNearEqual(e.matrix[0], 0.f);
+        VerifyNearEqual(e.matrix[1], 0.f);
+        VerifyNearEqual(e.matrix[2], 1.f);
+        VerifyNearEqual(e.matrix[3], 0.5f);
+        VerifyNearEqual(e.matrix[4], 0.f);
+        VerifyNearEqual(e.matrix[5], 0.f);
+
+        // Directly behind is split between the back speakers
+        e = {};
+        e.z = 4.f;
+        Spatialize(surround, listener, e);
+        VerifyNearEqual(e.matrix[2], 0.f);
+        VerifyNearEqual(e.matrix[4], 0.25f * c_Sqrt2Over2);
+        VerifyNearEqual(e.matrix[5], 0.25f * c_Sqrt2Over2);
+
+        // Default curves are inverse distance beyond the curve distance scaler
+        VerifyNearEqual(e.matrix[3], 0.25f);
+        VerifyNearEqual(e.distance, 4.f);
+
+        // Reverb curve
+        e = {};
+        e.z = -7.5f;
+        Spatialize(surround, listener, e, 10.f, nullptr, &Emitter_Reverb_Curve);
+        VerifyNearEqual(e.reverb, 1.f);
+    }
+
+    // Inner radius
+    {
+        const AudioSpatializer quad(SpatialSpeaker_Quad);
+
+        // FL FR BL BR; halfway inside the inner radius blends the front pan with a uniform 0.5
+        OneEmitter e = {};
+        e.z = -1.f;
+        e.innerRadius = 2.f;
+        Spatialize(quad, listener, e);
+        VerifyNearEqual(e.matrix[0], 0.25f + 0.5f * c_Sqrt2Over2);
+        VerifyNearEqual(e.matrix[1], 0.25f + 0.5f * c_Sqrt2Over2);
+        VerifyNearEqual(e.matrix[2], 0.25f);
+        VerifyNearEqual(e.matrix[3], 0.25f);
+
+        // Coincident with the listener
+        e = {};
+        Spatialize(quad, listener, e);
+        for (size_t j = 0; j < 4; ++j)
+        {
+            VerifyNearEqual(e.matrix[j], 0.5f);
+        }
+        VerifyNearEqual(e.doppler, 1.f);
+    }
+
+    // Doppler
+    {
+        const AudioSpatializer stereo(SpatialSpeaker_Stereo);
+        constexpr float c = AudioSpatializer::c_DefaultSpeedOfSound;
+
+        // Emitter approaching at 10% of the speed of sound
+        OneEmitter e = {};
+        e.z = -10.f;
+        e.vz = c * 0.1f;
+        Spatialize(stereo, listener, e);
+        if (!XMScalarNearEqual(e.doppler, 1.f / 0.9f, EPSILON2))
+        {
+            printf("ERROR: emitter doppler %f\n", e.doppler);
+            success = false;
+        }
+
+        // Listener approaching at 10% of the speed of sound
+        SpatialListener moving = listener;
+        moving.velocity = XMFLOAT3(0.f, 0.f, -c * 0.1f);
+        e = {};
+        e.z = -10.f;
+        Spatialize(stereo, moving, e);
+        if (!XMScalarNearEqual(e.doppler, 1.1f, EPSILON2))
+        {
+            printf("ERROR: listener doppler %f\n", e.doppler);
+            success = false;
+        }
+
+        // Emitter receding faster than sound is clamped
+        e = {};
+        e.z = -10.f;
+        e.vz = -c * 4.f;
+        Spatialize(stereo, listener, e);
+        if (!XMScalarNearEqual(e.doppler, 1.f / 1.5f, EPSILON2))
+        {
+            printf("ERROR: clamped doppler %f\n", e.doppler);
+            success = false;
+        }
+    }
+
+    // Listener cone
+    {
+        const AudioSpatializer stereo(SpatialSpeaker_Stereo);
+
+        SpatialListener cone = listener;
+        cone.pCone = &Listener_DirectionalCone;
+
+        OneEmitter e = {};
+        e.z = -1.f;
+        Spatialize(stereo, cone, e);
+        VerifyNearEqual(e.matrix[0], c_Sqrt2Over2);
+        VerifyNearEqual(e.lpf, 0.f);
+        VerifyNearEqual(e.reverb, 0.708f);
+
+        e = {};
+        e.z = 1.f;
+        Spatialize(stereo, cone, e);
+        VerifyNearEqual(e.matrix[0], 0.75f * c_Sqrt2Over2);
+        VerifyNearEqual(e.lpf, 0.25f);
+        VerifyNearEqual(e.reverb, 1.f);
+    }
+
+    // Batches match single emitter results in every lane and for partial blocks
+    {
+        const AudioSpatializer surround(SpatialSpeaker_7Point1Surround);
+        const size_t channels = surround.GetChannelCount();
+
+        constexpr size_t c_Count = 37;
+
+        std::mt19937 gen(0);
+        std::uniform_real_distribution<float> dist(-20.f, 20.f);
+
+        std::vector<float> px(c_Count), py(c_Count), pz(c_Count), vx(c_Count), vy(c_Count), vz(c_Count), radius(c_Count);
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            px[j] = dist(gen);
+            py[j] = dist(gen) * 0.1f;
+            pz[j] = dist(gen);
+            vx[j] = dist(gen);
+            vy[j] = 0.f;
+            vz[j] = dist(gen);
+            radius[j] = (j & 1) ? 2.f : 0.f;
+        }
+
+        SpatialListener cone = listener;
+        cone.pCone = &Listener_DirectionalCone;
+        cone.velocity = XMFLOAT3(1.f, 0.f, -2.f);
+
+        SpatialEmitters emitters = {};
+        emitters.count = c_Count;
+        emitters.positionX = px.data();
+        emitters.positionY = py.data();
+        emitters.positionZ = pz.data();
+        emitters.velocityX = vx.data();
+        emitters.velocityY = vy.data();
+        emitters.velocityZ = vz.data();
+        emitters.innerRadius = radius.data();
+        emitters.curveDistanceScaler = 14.f;
+        emitters.dopplerScaler = 1.f;
+        emitters.pLFECurve = &Emitter_LFE_Curve;
+        emitters.pReverbCurve = &Emitter_Reverb_Curve;
+
+        std::vector<float> matrix(channels * c_Count);
+        std::vector<float> doppler(c_Count), lpf(c_Count), reverb(c_Count);
+
+        SpatialResults results = {};
+        results.matrix = matrix.data();
+        results.stride = c_Count;
+        results.doppler = doppler.data();
+        results.lpfDirect = lpf.data();
+        results.reverbLevel = reverb.data();
+
+        surround.Calculate(cone, emitters, results);
+
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            OneEmitter e = {};
+            e.x = px[j]; e.y = py[j]; e.z = pz[j];
+            e.vx = vx[j]; e.vy = vy[j]; e.vz = vz[j];
+            e.innerRadius = radius[j];
+            Spatialize(surround, cone, e, 14.f, &Emitter_LFE_Curve, &Emitter_Reverb_Curve);
+
+            bool match = XMScalarNearEqual(e.doppler, doppler[j], EPSILON2)
+                && XMScalarNearEqual(e.lpf, lpf[j], EPSILON2)
+                && XMScalarNearEqual(e.reverb, reverb[j], EPSILON2);
+
+            for (size_t c = 0; c < channels; ++c)
+            {
+                match &= XMScalarNearEqual(e.matrix[c], matrix[c * c_Count + j], EPSILON2);
+            }
+
+            if (!match)
+            {
+                printf("ERROR: batch result mismatch for emitter %zu\n", j);
+                success = false;
+            }
+        }
+    }
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,462 @@
+//-------------------------------------------------------------------------------------
+// SimpleMathTestBVH.cpp
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX 1
+#define NODRAWTEXT
+#define NOGDI
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#ifndef _WIN32
+#include "pch.h"
+#endif
+
+#include "SimpleMath.h"
+
+#include "SimpleMathTest.h"
+
+#include "BoundingVolumeHierarchy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DX;
+
+namespace
+{
+    using Hits = std::vector<std::pair<uint32_t, float>>;
+
+    // Mix of scattered boxes, a tight cluster sharing one center, and a few large boxes
+    std::vector<BoundingBox> CreateBoxes(size_t count, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+        std::vector<BoundingBox> boxes(count);
+        for (size_t j = 0; j < count; ++j)
+        {
+            XMFLOAT3 center(dist(rng) * 100.f, dist(rng) * 20.f, dist(rng) * 100.f);
+            XMFLOAT3 extents(std::fabs(dist(rng)) + 0.01f, std::fabs(dist(rng)) + 0.01f, std::fabs(dist(rng)) + 0.01f);
+            if ((j % 11) == 4)
+            {
+                center = XMFLOAT3(25.f, 5.f, -25.f);
+            }
+            else if ((j % 97) == 13)
+            {
+                extents = XMFLOAT3(30.f, 10.f, 30.f);
+            }
+            boxes[j] = BoundingBox(center, extents);
+        }
+        return boxes;
+    }
+
+    std::vector<Ray> CreateRays(size_t count, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+        std::vector<Ray> rays(count);
+        for (size_t j = 0; j < count; ++j)
+        {
+            Vector3 direction(dist(rng), dist(rng) * 0.25f, dist(rng));
+            if ((j % 5) == 1)
+            {
+                direction = (j & 2) ? Vector3::UnitX : -Vector3::UnitZ;
+            }
+            else if (direction.LengthSquared() < 0.0001f)
+            {
+                direction = Vector3::UnitY;
+            }
+            direction.Normalize();
+
+            rays[j] = Ray(Vector3(dist(rng) * 120.f, dist(rng) * 25.f, dist(rng) * 120.f), direction);
+        }
+        return rays;
+    }
+
+    // Every node must enclose its children, and every slot must be reached exactly once
+    bool ValidateTree(const BoundingVolumeHierarchy& bvh, const std::vector<BoundingBox>& boxes)
+    {
+        auto encloses = [](const XMFLOAT3& min, const XMFLOAT3& max, const XMFLOAT3& bmin, const XMFLOAT3& bmax)
+        {
+            return min.x <= bmin.x && min.y <= bmin.y && min.z <= bmin.z
+                && max.x >= bmax.x && max.y >= bmax.y && max.z >= bmax.z;
+        };
+
+        std::vector<uint32_t> found;
+
+        const auto* nodes = bvh.GetNodes();
+        for (size_t j = 0; j < bvh.NodeCount(); ++j)
+        {
+            const auto& node = nodes[j];
+            if (node.count)
+            {
+                if (node.count > BoundingVolumeHierarchy::c_MaxLeafSize * 4)
+                    return false;
+                continue;
+            }
+
+            if (node.leftFirst <= j || node.leftFirst + 1 >= bvh.NodeCount())
+                return false;
+
+            for (uint32_t k = 0; k < 2; ++k)
+            {
+                const auto& child = nodes[node.leftFirst + k];
+                if (!encloses(node.min, node.max, child.min, child.max))
+                    return false;
+            }
+        }
+
+        // Full-coverage sphere query emits every object
+        const BoundingBox bounds = bvh.GetBounds();
+        const BoundingSphere all(bounds.Center,
+            std::sqrt(bounds.Extents.x * bounds.Extents.x + bounds.Extents.y * bounds.Extents.y + bounds.Extents.z * bounds.Extents.z) * 2.f);
+        bvh.Query(all, [&](uint32_t index) { found.push_back(index); });
+
+        std::sort(found.begin(), found.end());
+        if (found.size() != boxes.size())
+            return false;
+
+        for (size_t j = 0; j < found.size(); ++j)
+        {
+            if (found[j] != j)
+                return false;
+        }
+
+        return bvh.NodeCount() <= std::max<size_t>(boxes.size() * 2, 1) - 1
+            && bvh.Depth() <= BoundingVolumeHierarchy::c_MaxDepth;
+    }
+
+    template<typename TVolume>
+    bool CompareVolume(const BoundingVolumeHierarchy& bvh, const std::vector<BoundingBox>& boxes, const TVolume& volume)
+    {
+        std::vector<uint32_t> expected;
+        for (size_t j = 0; j < boxes.size(); ++j)
+        {
+            if (volume.Intersects(boxes[j]))
+                expected.push_back(static_cast<uint32_t>(j));
+        }
+
+        std::vector<uint32_t> found;
+        bvh.Query(volume, [&](uint32_t index) { found.push_back(index); });
+        std::sort(found.begin(), found.end());
+
+        return found == expected;
+    }
+
+    // Compares every query type against testing each box in turn
+    bool CompareQueries(const BoundingVolumeHierarchy& bvh, const std::vector<BoundingBox>& boxes, const std::vector<Ray>& rays, const char* name)
+    {
+        bool success = true;
+
+        for (size_t r = 0; r < rays.size(); ++r)
+        {
+            const Ray& ray = rays[r];
+
+            Hits expected;
+            float best = FLT_MAX;
+            for (size_t j = 0; j < boxes.size(); ++j)
+            {
+                float d = 0.f;
+                if (ray.Intersects(boxes[j], d))
+                {
+                    expected.emplace_back(static_cast<uint32_t>(j), d);
+                    best = std::min(best, d);
+                }
+            }
+
+            Hits found;
+            bvh.Query(ray, [&](uint32_t index, float d) { found.emplace_back(index, d); });
+            std::sort(found.begin(), found.end());
+
+            if (found != expected)
+            {
+                printf("ERROR: %s ray %zu hits %zu (expecting %zu)\n", name, r, found.size(), expected.size());
+                success = false;
+            }
+
+            uint32_t index = UINT32_MAX;
+            float dist = 0.f;
+            const bool hit = bvh.Nearest(ray, index, dist);
+            if (hit != !expected.empty()
+                || (hit && (dist != best || index >= boxes.size())))
+            {
+                printf("ERROR: %s ray %zu nearest %f (expecting %f)\n", name, r, hit ? dist : -1.f, expected.empty() ? -1.f : best);
+                success = false;
+            }
+            else if (hit)
+            {
+                float d = 0.f;
+                if (!ray.Intersects(boxes[index], d) || d != dist)
+                {
+                    printf("ERROR: %s ray %zu nearest index %u\n", name, r, index);
+                    success = false;
+                }
+            }
+
+            // Volumes centered along the ray
+            const Vector3 center = ray.position + ray.direction * 40.f;
+            const float radius = 2.f + float(r % 7) * 6.f;
+
+            if (!CompareVolume(bvh, boxes, BoundingSphere(center, radius)))
+            {
+                printf("ERROR: %s sphere query %zu\n", name, r);
+                success = false;
+            }
+
+            if (!CompareVolume(bvh, boxes, BoundingBox(center, XMFLOAT3(radius, radius * 0.5f, radius))))
+            {
+                printf("ERROR: %s box query %zu\n", name, r);
+                success = false;
+            }
+
+            const float slope = 0.25f + float(r % 5) * 0.25f;
+            const BoundingFrustum frustum(ray.position, XMFLOAT4(0.f, 0.f, 0.f, 1.f),
+                slope, -slope, slope * 0.5f, -slope * 0.5f, 0.5f, 60.f + float(r % 3) * 40.f);
+            if (!CompareVolume(bvh, boxes, frustum))
+            {
+                printf("ERROR: %s frustum query %zu\n", name, r);
+                success = false;
+            }
+        }
+
+        return success;
+    }
+}
+
+int TestBVH()
+{
+    bool success = true;
+
+    std::mt19937 rng(1009);
+
+    // Empty and invalid
+    {
+        BoundingVolumeHierarchy bvh;
+        bvh.Build(nullptr, 0);
+        VerifyEqual(static_cast<uint32_t>(bvh.Size()), 0u);
+        VerifyEqual(static_cast<uint32_t>(bvh.NodeCount()), 0u);
+
+        uint32_t index = 0;
+        float dist = 0.f;
+        VerifyEqual(bvh.Nearest(Ray(Vector3::Zero, Vector3::UnitZ), index, dist), false);
+
+        size_t calls = 0;
+        bvh.Query(BoundingSphere(XMFLOAT3(0.f, 0.f, 0.f), 1000.f), [&](uint32_t) { ++calls; });
+        VerifyEqual(static_cast<uint32_t>(calls), 0u);
+
+        try
+        {
+            bvh.Build(nullptr, 4);
+            printf("ERROR: Build expected to throw for null boxes\n");
+            success = false;
+        }
+        catch (const std::invalid_argument&)
+        {
+        }
+
+        const auto boxes = CreateBoxes(8, rng);
+        bvh.Build(boxes.data(), boxes.size());
+        try
+        {
+            bvh.Refit(boxes.data(), boxes.size() - 1);
+            printf("ERROR: Refit expected to throw for count mismatch\n");
+            success = false;
+        }
+        catch (const std::invalid_argument&)
+        {
+        }
+    }
+
+    // Queries match brute force, before and after refitting
+    {
+        static const size_t s_counts[] = { 1, 2, 3, 5, 17, 64, 1000, 12000 };
+
+        const auto rays = CreateRays(64, rng);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+        for (const size_t count : s_counts)
+        {
+            auto boxes = CreateBoxes(count, rng);
+
+            BoundingVolumeHierarchy bvh;
+            bvh.Build(boxes.data(), boxes.size());
+
+            VerifyEqual(static_cast<uint32_t>(bvh.Size()), static_cast<uint32_t>(count));
+            if (!ValidateTree(bvh, boxes))
+            {
+                printf("ERROR: invalid tree for %zu boxes\n", count);
+                success = false;
+            }
+
+            if (!CompareQueries(bvh, boxes, rays, "build"))
+            {
+                printf("ERROR: queries failed for %zu boxes\n", count);
+                success = false;
+            }
+
+            for (auto& box : boxes)
+            {
+                box.Center.x += dist(rng) * 10.f;
+                box.Center.y += dist(rng) * 10.f;
+                box.Extents.z *= 1.5f;
+            }
+
+            bvh.Refit(boxes.data(), boxes.size());
+            if (!ValidateTree(bvh, boxes))
+            {
+                printf("ERROR: invalid tree after refit for %zu boxes\n", count);
+                success = false;
+            }
+
+            if (!CompareQueries(bvh, boxes, rays, "refit"))
+            {
+                printf("ERROR: queries failed after refit for %zu boxes\n", count);
+                success = false;
+            }
+        }
+    }
+
+    // All centers coincide, so SAH has nothing to split on
+    {
+        std::vector<BoundingBox> boxes(500, BoundingBox(XMFLOAT3(1.f, 2.f, 3.f), XMFLOAT3(0.5f, 0.5f, 0.5f)));
+        for (size_t j = 0; j < boxes.size(); ++j)
+        {
+            boxes[j].Extents.x += float(j) * 0.01f;
+        }
+
+        BoundingVolumeHierarchy bvh;
+        bvh.Build(boxes.data(), boxes.size());
+        if (!ValidateTree(bvh, boxes)
+            || !CompareQueries(bvh, boxes, CreateRays(16, rng), "coincident"))
+        {
+            printf("ERROR: coincident boxes\n");
+            success = false;
+        }
+    }
+
+    // Caller intersection test for exact primitives
+    {
+        constexpr size_t c_Count = 2000;
+
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        std::vector<Vector3> vertices(c_Count * 3);
+        std::vector<BoundingBox> boxes(c_Count);
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            const Vector3 base(dist(rng) * 100.f, dist(rng) * 20.f, dist(rng) * 100.f);
+            for (size_t k = 0; k < 3; ++k)
+            {
+                vertices[j * 3 + k] = base + Vector3(dist(rng) * 3.f, dist(rng) * 3.f, dist(rng) * 3.f);
+            }
+            BoundingBox::CreateFromPoints(boxes[j], 3, &vertices[j * 3], sizeof(Vector3));
+        }
+
+        BoundingVolumeHierarchy bvh;
+        bvh.Build(boxes.data(), boxes.size());
+
+        for (const auto& ray : CreateRays(256, rng))
+        {
+            float best = FLT_MAX;
+            for (size_t j = 0; j < c_Count; ++j)
+            {
+                float d = 0.f;
+                if (ray.Intersects(vertices[j * 3], vertices[j * 3 + 1], vertices[j * 3 + 2], d))
+                    best = std::min(best, d);
+            }
+
+            uint32_t index = 0;
+            float d = 0.f;
+            const bool hit = bvh.Nearest(ray,
+                [&](uint32_t j, float& t) { return ray.Intersects(vertices[j * 3], vertices[j * 3 + 1], vertices[j * 3 + 2], t); },
+                index, d);
+
+            if (hit != (best < FLT_MAX) || (hit && d != best))
+            {
+                printf("ERROR: triangle nearest %f (expecting %f)\n", hit ? d : -1.f, best < FLT_MAX ? best : -1.f);
+                success = false;
+            }
+        }
+    }
+
+    // Parallel build gives the same answers as a serial one and as brute force. At least four
+    // workers so the threaded path is exercised even on single-core machines.
+    {
+        constexpr size_t c_Count = 100000;
+        constexpr size_t c_Rays = 256;
+
+        const auto boxes = CreateBoxes(c_Count, rng);
+        const auto rays = CreateRays(c_Rays, rng);
+
+        BoundingVolumeHierarchy serial;
+        serial.Build(boxes.data(), boxes.size(), 1);
+
+        BoundingVolumeHierarchy parallel;
+        parallel.Build(boxes.data(), boxes.size(), std::max<size_t>(std::thread::hardware_concurrency(), 4));
+
+        if (!ValidateTree(parallel, boxes))
+        {
+            printf("ERROR: invalid tree from parallel build\n");
+            success = false;
+        }
+
+        for (size_t r = 0; r < c_Rays; ++r)
+        {
+            uint32_t index[2] = {};
+            float dist[2] = {};
+            const bool hit0 = serial.Nearest(rays[r], index[0], dist[0]);
+            const bool hit1 = parallel.Nearest(rays[r], index[1], dist[1]);
+            if (hit0 != hit1 || (hit0 && dist[0] != dist[1]))
+            {
+                printf("ERROR: parallel build ray %zu nearest %f (expecting %f)\n", r, hit1 ? dist[1] : -1.f, hit0 ? dist[0] : -1.f);
+                success = false;
+            }
+
+            size_t counts[2] = {};
+            const BoundingSphere sphere(rays[r].position, 15.f);
+            serial.Query(sphere, [&](uint32_t) { ++counts[0]; });
+            parallel.Query(sphere, [&](uint32_t) { ++counts[1]; });
+            VerifyEqual(static_cast<uint32_t>(counts[1]), static_cast<uint32_t>(counts[0]));
+        }
+
+        size_t bruteHits = 0;
+        for (const auto& ray : rays)
+        {
+            float best = FLT_MAX;
+            for (const auto& box : boxes)
+            {
+                float d = 0.f;
+                if (ray.Intersects(box, d) && d < best)
+                    best = d;
+            }
+            bruteHits += (best < FLT_MAX) ? 1 : 0;
+        }
+
+        size_t bvhHits = 0;
+        for (const auto& ray : rays)
+        {
+            uint32_t index = 0;
+            float d = 0.f;
+            bvhHits += parallel.Nearest(ray, index, d) ? 1 : 0;
+        }
+
+        VerifyEqual(static_cast<uint32_t>(bvhHits), static_cast<uint32_t>(bruteHits));
+    }
+
+    return success ? 0 : 1;
+}
@@ -26,3 +26,62 @@
 #pragma warning(pop)
 
 #include "SimpleMath.h"
+#include "SimpleMathConstexpr.h"
+
+using namespace DirectX::SimpleMath;
+namespace CM = DX::ConstexprMath;
+
+namespace
+{
+    // Tables below must be usable as constant expressions so they land in read-only data.
+
+    constexpr Rectangle c_screen(0, 0, 1920, 1080);
+
+    constexpr auto c_buttons = CM::GridLayout<4, 3>(CM::Offset(Rectangle(0, 0, 1792, 932), 64, 64), 16);
+    static_assert(c_buttons.size() == 12, "GridLayout size");
+    static_assert(CM::Equal(c_buttons[0], Rectangle(64, 64, 436, 300)), "GridLayout first cell");
+    static_assert(CM::Equal(c_buttons[5], Rectangle(516, 380, 436, 300)), "GridLayout inner cell");
+    static_assert(CM::Equal(c_buttons[11], Rectangle(1420, 696, 436, 300)), "GridLayout last cell");
+    static_assert(CM::Contains(c_screen, c_buttons[11]), "GridLayout stays inside the area");
+    static_assert(!CM::Intersects(c_buttons[0], c_buttons[1]), "GridLayout cells do not overlap");
+
+    constexpr Color c_palette[] =
+    {
+        CM::ColorFromARGB(0xFFFF0000),
+        CM::ColorFromARGB(0x8000FF00),
+        CM::ColorFromABGR(0xFFFF0000),
+        CM::NegateColor(CM::ColorFromARGB(0xFFFFFFFF)),
+    };
+    static_assert(CM::Equal(c_palette[0], Color(1.f, 0.f, 0.f, 1.f)), "ColorFromARGB");
+    static_assert(c_palette[1].y == 1.f && c_palette[1].w == 128.f / 255.f, "ColorFromARGB alpha");
+    static_assert(CM::Equal(c_palette[2], Color(0.f, 0.f, 1.f, 1.f)), "ColorFromABGR");
+    static_assert(CM::Equal(c_palette[3], Color(0.f, 0.f, 0.f, 1.f)), "NegateColor");
+    static_assert(CM::Equal(CM::Premultiply(Color(1.f, 0.5f, 0.25f, 0.5f)), Color(0.5f, 0.25f, 0.125f, 0.5f)), "Premultiply");
+    static_assert(CM::Equal(CM::Saturate(Color(-1.f, 0.5f, 2.f, 1.f)), Color(0.f, 0.5f, 1.f, 1.f)), "Saturate");
+
+    constexpr auto c_ramp = CM::Gradient<5>(Color(0.f, 0.f, 0.f, 1.f), Color(1.f, 1.f, 1.f, 1.f));
+    static_assert(CM::Equal(c_ramp[2], Color(0.5f, 0.5f, 0.5f, 1.f)), "Gradient midpoint");
+    static_assert(CM::Equal(c_ramp[4], Color(1.f, 1.f, 1.f, 1.f)), "Gradient end");
+
+    constexpr Vector3 c_x(1.f, 0.f, 0.f);
+    constexpr Vector3 c_y(0.f, 1.f, 0.f);
+    static_assert(CM::Equal(CM::Cross(c_x, c_y), Vector3(0.f, 0.f, 1.f)), "Cross");
+    static_assert(CM::Dot(c_x, c_y) == 0.f, "Dot");
+    static_assert(CM::Equal(CM::Add(Vector2(1.f, 2.f), Vector2(3.f, 4.f)), Vector2(4.f, 6.f)), "Add");
+    static_assert(CM::Equal(CM::Subtract(Vector4(1.f, 2.f, 3.f, 4.f), Vector4(4.f, 3.f, 2.f, 1.f)), Vector4(-3.f, -1.f, 1.f, 3.f)), "Subtract");
+    static_assert(CM::Equal(CM::Divide(Vector3(2.f, 4.f, 8.f), 2.f), Vector3(1.f, 2.f, 4.f)), "Divide");
+    static_assert(CM::LengthSquared(Vector3(1.f, 2.f, 2.f)) == 9.f, "LengthSquared");
+    static_assert(CM::Equal(CM::Clamp(Vector2(-2.f, 2.f), Vector2(-1.f, -1.f), Vector2(1.f, 1.f)), Vector2(-1.f, 1.f)), "Clamp");
+    static_assert(CM::NotEqual(CM::Negate(c_x), c_x), "Negate");
+
+    constexpr Viewport c_viewport(0.f, 0.f, 1920.f, 1080.f);
+    static_assert(CM::AspectRatio(c_viewport) == 1920.f / 1080.f, "AspectRatio");
+    static_assert(CM::AspectRatio(Viewport(0.f, 0.f, 0.f, 0.f)) == 0.f, "AspectRatio empty");
+    static_assert(CM::Equal(CM::ToRectangle(c_viewport), c_screen), "ToRectangle");
+
+    static_assert(CM::Equal(CM::Intersect(Rectangle(0, 0, 10, 10), Rectangle(5, 5, 10, 10)), Rectangle(5, 5, 5, 5)), "Intersect");
+    static_assert(CM::IsEmpty(CM::Intersect(Rectangle(0, 0, 10, 10), Rectangle(10, 0, 10, 10))), "Intersect edge");
+    static_assert(CM::Equal(CM::Union(Rectangle(0, 0, 10, 10), Rectangle(5, 5, 10, 10)), Rectangle(0, 0, 15, 15)), "Union");
+    static_assert(CM::Contains(c_screen, Vector2(0.f, 1079.5f)) && !CM::Contains(c_screen, 1920, 0), "Contains is half-open");
+    static_assert(CM::Equal(CM::Center(c_screen), Vector2(960.f, 540.f)), "Center");
+}
@@ -26,3 +26,91 @@
 #pragma warning(pop)
 
 #include "SimpleMath.h"
+#include "SimpleMathConstexpr.h"
+
+using namespace DirectX::SimpleMath;
+namespace CM = DX::ConstexprMath;
+
+namespace
+{
+    // consteval guarantees these run entirely in the compiler.
+
+    consteval bool TestVectors()
+    {
+        constexpr Vector3 a(1.f, 2.f, 3.f);
+        constexpr Vector3 b(4.f, 5.f, 6.f);
+
+        if (!CM::Equal(CM::Add(a, b), Vector3(5.f, 7.f, 9.f)))
+            return false;
+        if (!CM::Equal(CM::Multiply(a, b), Vector3(4.f, 10.f, 18.f)))
+            return false;
+        if (!CM::Equal(CM::Multiply(a, 2.f), Vector3(2.f, 4.f, 6.f)))
+            return false;
+        if (!CM::Equal(CM::Cross(a, b), Vector3(-3.f, 6.f, -3.f)))
+            return false;
+        if (CM::Dot(a, b) != 32.f)
+            return false;
+        if (CM::DistanceSquared(a, b) != 27.f)
+            return false;
+        if (!CM::Equal(CM::Lerp(Vector4(0.f, 0.f, 0.f, 0.f), Vector4(2.f, 4.f, 8.f, 16.f), 0.5f), Vector4(1.f, 2.f, 4.f, 8.f)))
+            return false;
+        if (!CM::Equal(CM::Min(Vector2(1.f, 5.f), Vector2(3.f, 2.f)), Vector2(1.f, 2.f)))
+            return false;
+        if (!CM::Equal(CM::Max(Vector2(1.f, 5.f), Vector2(3.f, 2.f)), Vector2(3.f, 5.f)))
+            return false;
+
+        return true;
+    }
+
+    consteval bool TestRectangles()
+    {
+        constexpr Rectangle a(10, 20, 100, 200);
+
+        const auto cells = CM::GridLayout<2, 2>(a, 0);
+        Rectangle all(cells[0].x, cells[0].y, cells[0].width, cells[0].height);
+        for (const auto& cell : cells)
+        {
+            if (!CM::Contains(a, cell))
+                return false;
+            all = CM::Union(all, cell);
+        }
+        if (!CM::Equal(all, a))
+            return false;
+
+        if (!CM::Equal(CM::Inflate(a, 5, 10), Rectangle(5, 10, 105, 210)))
+            return false;
+        if (!CM::Equal(CM::Location(a), Vector2(10.f, 20.f)))
+            return false;
+        if (!CM::Intersects(a, cells[3]) || CM::Intersects(cells[0], cells[3]))
+            return false;
+        if (CM::Contains(a, 110, 20) || !CM::Contains(a, 109, 219))
+            return false;
+
+        return true;
+    }
+
+    consteval bool TestColors()
+    {
+        const auto ramp = CM::Gradient<3>(Color(1.f, 0.f, 0.f, 1.f), Color(0.f, 0.f, 1.f, 1.f));
+        if (!CM::Equal(ramp[1], Color(0.5f, 0.f, 0.5f, 1.f)))
+            return false;
+
+        if (!CM::Equal(CM::ColorFromARGB(0xFF0000FF), CM::ColorFromABGR(0xFFFF0000)))
+            return false;
+
+        return CM::Equal(CM::Divide(Color(1.f, 1.f, 1.f, 1.f), Color(2.f, 4.f, 8.f, 1.f)), Color(0.5f, 0.25f, 0.125f, 1.f));
+    }
+
+    consteval bool TestViewports()
+    {
+        constexpr Viewport vp(0.f, 0.f, 640.f, 480.f, 0.f, 1.f);
+        return CM::Equal(vp, Viewport(0.f, 0.f, 640.f, 480.f))
+            && CM::AspectRatio(vp) == 640.f / 480.f
+            && CM::AspectRatio(Viewport(0.f, 0.f, 640.f, 0.f)) == 0.f;
+    }
+
+    static_assert(TestVectors());
+    static_assert(TestRectangles());
+    static_assert(TestColors());
+    static_assert(TestViewports());
+}
@@ -0,0 +1,479 @@
+//-------------------------------------------------------------------------------------
+// SimpleMathTestColor.cpp
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX 1
+#define NODRAWTEXT
+#define NOGDI
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#ifndef _WIN32
+#include "pch.h"
+#endif
+
+#include "SimpleMath.h"
+
+#include "SimpleMathTest.h"
+
+#include "ColorConversion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DX;
+
+namespace
+{
+    // Written after the last element of every result to catch overruns
+    const Color c_Sentinel(-123.f, 456.f, -789.f, 0.5f);
+
+    // Published linear conversion matrices, as used by the ToneMapPostProcess shaders (result = m * rgb)
+    constexpr double c_709to2020[3][3] =
+    {
+        { 0.6274040, 0.3292820, 0.0433136 },
+        { 0.0690970, 0.9195400, 0.0113612 },
+        { 0.0163916, 0.0880132, 0.8955950 },
+    };
+
+    constexpr double c_2020to709[3][3] =
+    {
+        { 1.6604910, -0.5876411, -0.0728499 },
+        { -0.1245505, 1.1328999, -0.0083494 },
+        { -0.0181508, -0.1005789, 1.1187297 },
+    };
+
+    constexpr double c_709toP3[3][3] =
+    {
+        { 0.8224620, 0.1775380, 0.0000000 },
+        { 0.0331942, 0.9668058, 0.0000000 },
+        { 0.0170826, 0.0723974, 0.9105199 },
+    };
+
+    // Scalar references in double precision
+    double Saturate(double x)
+    {
+        return std::min(std::max(x, 0.0), 1.0);
+    }
+
+    double SRGBToLinearRef(double x)
+    {
+        x = Saturate(x);
+        return (x > 0.04045) ? std::pow((x + 0.055) / 1.055, 2.4) : x / 12.92;
+    }
+
+    double LinearToSRGBRef(double x)
+    {
+        x = Saturate(x);
+        return (x < 0.0031308) ? x * 12.92 : 1.055 * std::pow(x, 1.0 / 2.4) - 0.055;
+    }
+
+    constexpr double c_M1 = 2610.0 / 16384.0;
+    constexpr double c_M2 = 2523.0 / 4096.0 * 128.0;
+    constexpr double c_C1 = 3424.0 / 4096.0;
+    constexpr double c_C2 = 2413.0 / 4096.0 * 32.0;
+    constexpr double c_C3 = 2392.0 / 4096.0 * 32.0;
+
+    // Luminance normalized to 10,000 nits
+    double ST2084EncodeRef(double y)
+    {
+        const double p = std::pow(std::max(y, 0.0), c_M1);
+        return std::pow((c_C1 + c_C2 * p) / (1.0 + c_C3 * p), c_M2);
+    }
+
+    double ST2084DecodeRef(double e)
+    {
+        const double p = std::pow(Saturate(e), 1.0 / c_M2);
+        return std::pow(std::max(p - c_C1, 0.0) / (c_C2 - c_C3 * p), 1.0 / c_M1);
+    }
+
+    Color Rotate(const double m[3][3], const Color& c, double scale = 1.0)
+    {
+        return Color(
+            static_cast<float>((m[0][0] * c.R() + m[0][1] * c.G() + m[0][2] * c.B()) * scale),
+            static_cast<float>((m[1][0] * c.R() + m[1][1] * c.G() + m[1][2] * c.B()) * scale),
+            static_cast<float>((m[2][0] * c.R() + m[2][1] * c.G() + m[2][2] * c.B()) * scale),
+            c.A());
+    }
+
+    template<typename F>
+    Color Apply(const Color& c, F&& func)
+    {
+        return Color(
+            static_cast<float>(func(c.R())),
+            static_cast<float>(func(c.G())),
+            static_cast<float>(func(c.B())),
+            c.A());
+    }
+
+    // Within an absolute tolerance, or a relative one for larger values; alpha must be exact
+    bool NearEqual(const Color& a, const Color& b, float absolute, float relative = 0.f)
+    {
+        auto equal = [=](float x, float y) { return std::fabs(x - y) <= std::max(absolute, relative * std::fabs(y)); };
+        return equal(a.R(), b.R()) && equal(a.G(), b.G()) && equal(a.B(), b.B()) && a.A() == b.A();
+    }
+
+    bool IsSentinel(const Color& c)
+    {
+        return c.R() == c_Sentinel.R() && c.G() == c_Sentinel.G() && c.B() == c_Sentinel.B() && c.A() == c_Sentinel.A();
+    }
+
+    using Kernel = void(*)(const Color*, size_t, Color*);
+
+    // Runs 'kernel' over every count, out of place and in place, and compares against 'expected'
+    template<typename Expected>
+    bool VerifyKernel(
+        const char* name,
+        Kernel kernel,
+        const std::vector<Color>& source,
+        Expected&& expected,
+        float absolute,
+        float relative = 0.f)
+    {
+        bool success = true;
+
+        for (const size_t count : c_BatchCounts)
+        {
+            std::vector<Color> result(count + 1);
+            result[count] = c_Sentinel;
+            kernel(source.data(), count, result.data());
+
+            for (size_t j = 0; j < count; ++j)
+            {
+                const Color ref = expected(source[j]);
+                if (!NearEqual(result[j], ref, absolute, relative))
+                {
+                    printf("ERROR: %s %zu of %zu: %f %f %f %f ... %f %f %f %f\n", name, j, count,
+                        result[j].R(), result[j].G(), result[j].B(), result[j].A(),
+                        ref.R(), ref.G(), ref.B(), ref.A());
+                    success = false;
+                    break;
+                }
+            }
+
+            if (!IsSentinel(result[count]))
+            {
+                printf("ERROR: %s wrote past %zu elements\n", name, count);
+                success = false;
+            }
+
+            // In place must give the same answer
+            std::vector<Color> inplace(source.begin(), source.begin() + static_cast<ptrdiff_t>(count + 1));
+            inplace[count] = c_Sentinel;
+            kernel(inplace.data(), count, inplace.data());
+
+            for (size_t j = 0; j < count; ++j)
+            {
+                if (!NearEqual(inplace[j], result[j], 0.f))
+                {
+                    printf("ERROR: %s in place %zu of %zu\n", name, j, count);
+                    success = false;
+                    break;
+                }
+            }
+
+            if (!IsSentinel(inplace[count]))
+            {
+                printf("ERROR: %s in place wrote past %zu elements\n", name, count);
+                success = false;
+            }
+        }
+
+        return success;
+    }
+}
+
+int TestColorConversion()
+{
+    bool success = true;
+
+    std::mt19937 gen(2050);
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+
+    const size_t maxCount = *std::max_element(std::begin(c_BatchCounts), std::end(c_BatchCounts));
+
+    // Colors in [0,1], with a few out of range values to exercise clamping
+    std::vector<Color> colors(maxCount + 1);
+    for (auto& c : colors)
+    {
+        c = Color(dist(gen), dist(gen), dist(gen), dist(gen));
+    }
+    colors[1] = Color(-0.5f, 1.5f, 0.f, 1.f);
+    colors[2] = Color(0.04045f, 0.0031308f, 1.f, 0.f);
+
+    // sRGB against the double reference and XMColorSRGBToRGB / XMColorRGBToSRGB
+    {
+        success &= VerifyKernel("SRGBToLinear", SRGBToLinear, colors,
+            [](const Color& c) { return Apply(c, SRGBToLinearRef); }, EPSILON2);
+
+        success &= VerifyKernel("LinearToSRGB", LinearToSRGB, colors,
+            [](const Color& c) { return Apply(c, LinearToSRGBRef); }, EPSILON2);
+
+        success &= VerifyKernel("SRGBToLinear vs. XMColorSRGBToRGB", SRGBToLinear, colors,
+            [](const Color& c) { return Color(XMColorSRGBToRGB(c)); }, EPSILON2);
+
+        success &= VerifyKernel("LinearToSRGB vs. XMColorRGBToSRGB", LinearToSRGB, colors,
+            [](const Color& c) { return Color(XMColorRGBToSRGB(c)); }, EPSILON2);
+
+        // Every 8-bit code value survives the round trip
+        std::vector<Color> codes(256);
+        for (size_t j = 0; j < codes.size(); ++j)
+        {
+            const float v = float(j) / 255.f;
+            codes[j] = Color(v, v, v, v);
+        }
+
+        std::vector<Color> linear(codes.size());
+        SRGBToLinear(codes.data(), codes.size(), linear.data());
+        LinearToSRGB(linear.data(), linear.size(), linear.data());
+
+        for (size_t j = 0; j < codes.size(); ++j)
+        {
+            if (static_cast<int>(linear[j].R() * 255.f + 0.5f) != static_cast<int>(j))
+            {
+                printf("ERROR: sRGB round trip of code %zu gave %f\n", j, linear[j].R() * 255.f);
+                success = false;
+                break;
+            }
+        }
+    }
+
+    // Primaries against the published matrices
+    {
+        success &= VerifyKernel("HDTV to UHDTV",
+            [](const Color* c, size_t n, Color* r) { ConvertColorPrimaries(c, n, r, ColorPrimaries::HDTV, ColorPrimaries::UHDTV); },
+            colors, [](const Color& c) { return Rotate(c_709to2020, c); }, EPSILON2);
+
+        success &= VerifyKernel("UHDTV to HDTV",
+            [](const Color* c, size_t n, Color* r) { ConvertColorPrimaries(c, n, r, ColorPrimaries::UHDTV, ColorPrimaries::HDTV); },
+            colors, [](const Color& c) { return Rotate(c_2020to709, c); }, EPSILON2);
+
+        success &= VerifyKernel("HDTV to DCI_P3_D65",
+            [](const Color* c, size_t n, Color* r) { ConvertColorPrimaries(c, n, r, ColorPrimaries::HDTV, ColorPrimaries::DCI_P3_D65); },
+            colors, [](const Color& c) { return Rotate(c_709toP3, c); }, EPSILON2);
+
+        success &= VerifyKernel("HDTV to HDTV",
+            [](const Color* c, size_t n, Color* r) { ConvertColorPrimaries(c, n, r, ColorPrimaries::HDTV, ColorPrimaries::HDTV); },
+            colors, [](const Color& c) { return c; }, 0.f);
+
+        // White is preserved by every conversion, and P3 to UHDTV matches going through HDTV
+        const ColorPrimaries primaries[] = { ColorPrimaries::HDTV, ColorPrimaries::UHDTV, ColorPrimaries::DCI_P3_D65 };
+        for (const auto from : primaries)
+        {
+            for (const auto to : primaries)
+            {
+                Color white(1.f, 1.f, 1.f, 0.25f);
+                ConvertColorPrimaries(&white, 1, &white, from, to);
+                if (!NearEqual(white, Color(1.f, 1.f, 1.f, 0.25f), EPSILON2))
+                {
+                    printf("ERROR: white %d to %d: %f %f %f\n", int(from), int(to), white.R(), white.G(), white.B());
+                    success = false;
+                }
+
+                std::vector<Color> direct(colors.size());
+                std::vector<Color> chained(colors.size());
+                ConvertColorPrimaries(colors.data(), colors.size(), direct.data(), from, to);
+                ConvertColorPrimaries(colors.data(), colors.size(), chained.data(), from, ColorPrimaries::HDTV);
+                ConvertColorPrimaries(chained.data(), chained.size(), chained.data(), ColorPrimaries::HDTV, to);
+
+                for (size_t j = 0; j < colors.size(); ++j)
+                {
+                    if (!NearEqual(direct[j], chained[j], EPSILON2))
+                    {
+                        printf("ERROR: %d to %d does not match going through HDTV\n", int(from), int(to));
+                        success = false;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // ST.2084 against the double reference, for code values and luminance up to the peak
+    {
+        success &= VerifyKernel("LinearToST2084", [](const Color* c, size_t n, Color* r) { LinearToST2084(c, n, r); },
+            colors, [](const Color& c) { return Apply(c, ST2084EncodeRef); }, EPSILON3);
+
+        success &= VerifyKernel("ST2084ToLinear", [](const Color* c, size_t n, Color* r) { ST2084ToLinear(c, n, r); },
+            colors, [](const Color& c) { return Apply(c, ST2084DecodeRef); }, EPSILON, EPSILON3);
+
+        // 1.0 is 80 nits, as for scRGB
+        success &= VerifyKernel("LinearToST2084(80)", [](const Color* c, size_t n, Color* r) { LinearToST2084(c, n, r, 80.f); },
+            colors, [](const Color& c) { return Apply(c, [](double x) { return ST2084EncodeRef(x * 0.008); }); }, EPSILON3);
+
+        success &= VerifyKernel("ST2084ToLinear(80)", [](const Color* c, size_t n, Color* r) { ST2084ToLinear(c, n, r, 80.f); },
+            colors, [](const Color& c) { return Apply(c, [](double x) { return ST2084DecodeRef(x) * 125.0; }); }, EPSILON, EPSILON3);
+
+        // Reference points: black, 100 nits, and the peak
+        Color pq[3] = { Color(0.f, 0.f, 0.f, 1.f), Color(100.f, 100.f, 100.f, 1.f), Color(10000.f, 10000.f, 10000.f, 1.f) };
+        LinearToST2084(pq, 3, pq, 1.f);
+
+        if (std::fabs(pq[0].R()) > EPSILON2
+            || std::fabs(pq[1].R() - 0.508078f) > EPSILON3
+            || std::fabs(pq[2].R() - 1.f) > EPSILON3)
+        {
+            printf("ERROR: ST2084 reference points %f %f %f\n", pq[0].R(), pq[1].R(), pq[2].R());
+            success = false;
+        }
+
+        ST2084ToLinear(pq, 3, pq, 1.f);
+        if (std::fabs(pq[0].R()) > EPSILON2
+            || std::fabs(pq[1].R() - 100.f) > 100.f * EPSILON3
+            || std::fabs(pq[2].R() - 10000.f) > 10000.f * EPSILON3)
+        {
+            printf("ERROR: ST2084 reference points decoded to %f %f %f\n", pq[0].R(), pq[1].R(), pq[2].R());
+            success = false;
+        }
+    }
+
+    // HDR10 is the rotation, paper white scale and curve
+    {
+        success &= VerifyKernel("LinearToHDR10", [](const Color* c, size_t n, Color* r) { LinearToHDR10(c, n, r); },
+            colors, [](const Color& c) { return Apply(Rotate(c_709to2020, c, c_HDR10PaperWhiteNits / c_ST2084MaxNits), ST2084EncodeRef); }, EPSILON3);
+
+        // Round trip of scene values up to 50x paper white
+        std::vector<Color> scene(colors.size());
+        for (size_t j = 0; j < scene.size(); ++j)
+        {
+            scene[j] = Color(colors[j].R() * 50.f, colors[j].G() * 10.f, std::fabs(colors[j].B()), colors[j].A());
+        }
+        scene[1] = Color(0.f, 1.f, 0.f, 1.f);
+
+        std::vector<Color> hdr10(scene.size());
+        LinearToHDR10(scene.data(), scene.size(), hdr10.data(), 300.f);
+        HDR10ToLinear(hdr10.data(), hdr10.size(), hdr10.data(), 300.f);
+
+        for (size_t j = 0; j < scene.size(); ++j)
+        {
+            if (!NearEqual(hdr10[j], scene[j], EPSILON3, EPSILON3))
+            {
+                printf("ERROR: HDR10 round trip %zu: %f %f %f ... %f %f %f\n", j,
+                    hdr10[j].R(), hdr10[j].G(), hdr10[j].B(), scene[j].R(), scene[j].G(), scene[j].B());
+                success = false;
+                break;
+            }
+        }
+    }
+
+    // Premultiplied alpha
+    {
+        success &= VerifyKernel("PremultiplyAlpha", PremultiplyAlpha, colors,
+            [](const Color& c) { return Color(c.R() * c.A(), c.G() * c.A(), c.B() * c.A(), c.A()); }, 0.f);
+
+        success &= VerifyKernel("UnpremultiplyAlpha", UnpremultiplyAlpha, colors,
+            [](const Color& c)
+            {
+                return (c.A() > 0.f) ? Color(c.R() / c.A(), c.G() / c.A(), c.B() / c.A(), c.A()) : Color(0.f, 0.f, 0.f, c.A());
+            }, 0.f, EPSILON);
+
+        std::vector<Color> premul(colors.size());
+        PremultiplyAlpha(colors.data(), colors.size(), premul.data());
+        UnpremultiplyAlpha(premul.data(), premul.size(), premul.data());
+
+        for (size_t j = 0; j < colors.size(); ++j)
+        {
+            const Color expected = (colors[j].A() > 0.f) ? colors[j] : Color(0.f, 0.f, 0.f, 0.f);
+            if (!NearEqual(premul[j], expected, EPSILON2, EPSILON2))
+            {
+                printf("ERROR: premultiplied alpha round trip %zu\n", j);
+                success = false;
+                break;
+            }
+        }
+    }
+
+    // Invalid arguments
+    {
+        Color c;
+
+        try
+        {
+            SRGBToLinear(nullptr, 4, &c);
+            printf("ERROR: SRGBToLinear expected to throw for null colors\n");
+            success = false;
+        }
+        catch (const std::invalid_argument&)
+        {
+        }
+
+        try
+        {
+            PremultiplyAlpha(&c, 4, nullptr);
+            printf("ERROR: PremultiplyAlpha expected to throw for null result\n");
+            success = false;
+        }
+        catch (const std::invalid_argument&)
+        {
+        }
+
+        try
+        {
+            LinearToST2084(&c, 1, &c, 0.f);
+            printf("ERROR: LinearToST2084 expected to throw for zero nits\n");
+            success = false;
+        }
+        catch (const std::invalid_argument&)
+        {
+        }
+
+        try
+        {
+            ConvertColorPrimaries(&c, 1, &c, ColorPrimaries::HDTV, static_cast<ColorPrimaries>(42));
+            printf("ERROR: ConvertColorPrimaries expected to throw for unknown primaries\n");
+            success = false;
+        }
+        catch (const std::invalid_argument&)
+        {
+        }
+
+        // Empty arrays are fine
+        SRGBToLinear(nullptr, 0, nullptr);
+        HDR10ToLinear(nullptr, 0, nullptr);
+    }
+
+    // A large batch matches XMColorSRGBToRGB
+    {
+        constexpr size_t c_Count = 65536;
+
+        std::vector<Color> source(c_Count);
+        for (auto& c : source)
+        {
+            c = Color(dist(gen), dist(gen), dist(gen), dist(gen));
+        }
+
+        std::vector<Color> expected(c_Count);
+        std::vector<Color> result(c_Count);
+
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            expected[j] = XMColorSRGBToRGB(source[j]);
+        }
+
+        SRGBToLinear(source.data(), c_Count, result.data());
+
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            if (!NearEqual(result[j], expected[j], EPSILON2))
+            {
+                printf("ERROR: SRGBToLinear %zu of %zu\n", j, c_Count);
+                success = false;
+                break;
+            }
+        }
+    }
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+//-------------------------------------------------------------------------------------
+// SimpleMathTestConstexpr.cpp
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX 1
+#define NODRAWTEXT
+#define NOGDI
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#ifndef _WIN32
+#include "pch.h"
+#endif
+
+#include "SimpleMath.h"
+
+#include "SimpleMathTest.h"
+
+#include "SimpleMathConstexpr.h"
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+namespace CM = DX::ConstexprMath;
+
+namespace
+{
+    // Built at compile time; the runtime checks below confirm they match the SimpleMath operators.
+    constexpr Vector4 c_vectors[] =
+    {
+        Vector4(1.f, 2.f, 3.f, 4.f),
+        Vector4(-0.5f, 8.f, 0.25f, -16.f),
+        Vector4(0.75f, -2.f, 0.f, -0.f),
+        Vector4(3.f, 5.f, 7.f, 9.f),
+    };
+
+    constexpr Rectangle c_rects[] =
+    {
+        Rectangle(10, 20, 4, 5),
+        Rectangle(12, 15, 100, 7),
+        Rectangle(0, 0, 10, 23),
+        Rectangle(10, 20, 0, 0),
+        Rectangle(0, 0, 0, 0),
+        Rectangle(-5, -5, 30, 30),
+        Rectangle(13, 24, 1, 1),
+    };
+
+    constexpr uint32_t c_packed[] = { 0xFF000000, 0xFFFFFFFF, 0x80FF4020, 0x00123456, 0xC0A0B0F0 };
+
+    constexpr auto c_grid = CM::GridLayout<3, 2>(Rectangle(100, 50, 640, 480), 8);
+}
+
+int TestConstexpr()
+{
+    bool success = true;
+
+    // Vector arithmetic
+    for (const auto& a : c_vectors)
+    {
+        for (const auto& b : c_vectors)
+        {
+            VerifyEqual(CM::Add(a, b), a + b);
+            VerifyEqual(CM::Subtract(a, b), a - b);
+            VerifyEqual(CM::Multiply(a, b), a * b);
+            VerifyEqual(CM::Multiply(a, 3.f), a * 3.f);
+            VerifyEqual(CM::Divide(a, 3.f), a / 3.f);
+            VerifyEqual(CM::Negate(a), -a);
+            VerifyEqual(CM::Min(a, b), Vector4::Min(a, b));
+            VerifyEqual(CM::Max(a, b), Vector4::Max(a, b));
+            VerifyEqual(CM::Equal(a, b), a == b);
+            VerifyEqual(CM::NotEqual(a, b), a != b);
+
+            // Summed products may be fused or reordered by DirectXMath
+            VerifyNearEqual(CM::Dot(a, b), a.Dot(b));
+            VerifyNearEqual(CM::DistanceSquared(a, b), Vector4::DistanceSquared(a, b));
+            VerifyNearEqual(CM::Lerp(a, b, 0.25f), Vector4::Lerp(a, b, 0.25f));
+
+            const Vector3 a3(a.x, a.y, a.z);
+            const Vector3 b3(b.x, b.y, b.z);
+            VerifyEqual(CM::Add(a3, b3), a3 + b3);
+            VerifyNearEqual(CM::Cross(a3, b3), a3.Cross(b3));
+            VerifyNearEqual(CM::LengthSquared(a3), a3.LengthSquared());
+
+            const Vector2 a2(a.x, a.y);
+            const Vector2 b2(b.x, b.y);
+            if (CM::NotEqual(CM::Subtract(a2, b2), a2 - b2)
+                || CM::NotEqual(CM::Divide(a2, b2), a2 / b2))
+            {
+                printf("ERROR: Vector2 arithmetic\n");
+                success = false;
+            }
+        }
+
+        Vector4 clamped;
+        a.Clamp(Vector4(0.f, 0.f, 0.f, 0.f), Vector4(4.f, 4.f, 4.f, 4.f), clamped);
+        VerifyEqual(CM::Clamp(a, Vector4(0.f, 0.f, 0.f, 0.f), Vector4(4.f, 4.f, 4.f, 4.f)), clamped);
+    }
+
+    // Color
+    for (const auto packed : c_packed)
+    {
+        const Color argb = CM::ColorFromARGB(packed);
+        VerifyNearEqual(argb, Color(PackedVector::XMCOLOR(packed)));
+        VerifyEqual(argb.BGRA().c, packed);
+
+        const Color abgr = CM::ColorFromABGR(packed);
+        VerifyNearEqual(abgr, Color(PackedVector::XMUBYTEN4(packed)));
+        VerifyEqual(abgr.RGBA().v, packed);
+
+        Color expected;
+        argb.Negate(expected);
+        VerifyNearEqual(CM::NegateColor(argb), expected);
+
+        argb.Premultiply(expected);
+        VerifyNearEqual(CM::Premultiply(argb), expected);
+
+        const Color scaled = CM::Multiply(argb, 2.f);
+        scaled.Saturate(expected);
+        VerifyEqual(CM::Saturate(scaled), expected);
+    }
+
+    // Rectangle
+    for (const auto& a : c_rects)
+    {
+        if (CM::IsEmpty(a) != a.IsEmpty()
+            || CM::NotEqual(CM::Location(a), a.Location())
+            || CM::NotEqual(CM::Center(a), a.Center()))
+        {
+            printf("ERROR: Rectangle properties %ld %ld %ld %ld\n", a.x, a.y, a.width, a.height);
+            success = false;
+        }
+
+        Rectangle offset = a;
+        offset.Offset(3, -7);
+        Rectangle inflated = a;
+        inflated.Inflate(2, 6);
+        if (CM::NotEqual(CM::Offset(a, 3, -7), offset)
+            || CM::NotEqual(CM::Inflate(a, 2, 6), inflated))
+        {
+            printf("ERROR: Rectangle Offset/Inflate %ld %ld %ld %ld\n", a.x, a.y, a.width, a.height);
+            success = false;
+        }
+
+        for (long y = -6; y < 30; y += 3)
+        {
+            for (long x = -6; x < 30; x += 3)
+            {
+                const Vector2 point(float(x) + 0.5f, float(y));
+                if (CM::Contains(a, x, y) != a.Contains(x, y)
+                    || CM::Contains(a, point) != a.Contains(point))
+                {
+                    printf("ERROR: Rectangle Contains %ld %ld\n", x, y);
+                    success = false;
+                }
+            }
+        }
+
+        for (const auto& b : c_rects)
+        {
+            if (CM::Contains(a, b) != a.Contains(b)
+                || CM::Intersects(a, b) != a.Intersects(b)
+                || CM::NotEqual(CM::Intersect(a, b), Rectangle::Intersect(a, b))
+                || CM::NotEqual(CM::Union(a, b), Rectangle::Union(a, b))
+                || CM::Equal(a, b) != (a == b))
+            {
+                printf("ERROR: Rectangle %ld %ld %ld %ld vs. %ld %ld %ld %ld\n",
+                    a.x, a.y, a.width, a.height, b.x, b.y, b.width, b.height);
+                success = false;
+            }
+        }
+    }
+
+    // GridLayout
+    {
+        const Rectangle area(100, 50, 640, 480);
+        for (size_t j = 0; j < c_grid.size(); ++j)
+        {
+            const Rectangle& cell = c_grid[j];
+            if (!area.Contains(cell) || cell.width != 208 || cell.height != 236)
+            {
+                printf("ERROR: GridLayout cell %zu\n", j);
+                success = false;
+            }
+
+            for (size_t k = j + 1; k < c_grid.size(); ++k)
+            {
+                if (cell.Intersects(c_grid[k]))
+                {
+                    printf("ERROR: GridLayout cells %zu and %zu overlap\n", j, k);
+                    success = false;
+                }
+            }
+        }
+    }
+
+    // Viewport
+    {
+        const Viewport vp[] =
+        {
+            Viewport(0.f, 0.f, 1920.f, 1080.f),
+            Viewport(10.f, 20.f, 640.f, 480.f, 0.25f, 0.75f),
+            Viewport(0.f, 0.f, 0.f, 0.f),
+            Viewport(0.f, 0.f, 512.f, 0.f),
+        };
+
+        for (const auto& a : vp)
+        {
+            VerifyEqual(CM::AspectRatio(a), a.AspectRatio());
+
+            for (const auto& b : vp)
+            {
+                VerifyEqual(CM::Equal(a, b), a == b);
+            }
+        }
+    }
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,610 @@
+//-------------------------------------------------------------------------------------
+// SimpleMathTestDouble.cpp
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX 1
+#define NODRAWTEXT
+#define NOGDI
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#ifndef _WIN32
+#include "pch.h"
+#endif
+
+#include "SimpleMath.h"
+
+#include "SimpleMathTest.h"
+
+#include "SimpleMathDouble.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DX;
+
+namespace
+{
+    constexpr double c_DoubleEpsilon = 1e-12;
+
+    bool NearEqual(double a, double b, double epsilon = c_DoubleEpsilon)
+    {
+        return std::fabs(a - b) <= epsilon * std::max(1., std::fabs(b));
+    }
+
+    bool NearEqual(const Vector3d& a, const Vector3d& b, double epsilon = c_DoubleEpsilon)
+    {
+        return NearEqual(a.x, b.x, epsilon) && NearEqual(a.y, b.y, epsilon) && NearEqual(a.z, b.z, epsilon);
+    }
+
+    bool NearEqual(const Matrix4d& a, const Matrix4d& b, double epsilon = c_DoubleEpsilon)
+    {
+        for (size_t r = 0; r < 4; ++r)
+        {
+            for (size_t c = 0; c < 4; ++c)
+            {
+                if (!NearEqual(a(r, c), b(r, c), epsilon))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // Float results checked against a double reference, so the tolerance is relative to float precision
+    bool NearEqual(const Matrix& a, const Matrix& b)
+    {
+        const float* fa = &a._11;
+        const float* fb = &b._11;
+        for (size_t j = 0; j < 16; ++j)
+        {
+            if (std::fabs(fa[j] - fb[j]) > EPSILON2 * std::max(1.f, std::fabs(fb[j])))
+                return false;
+        }
+        return true;
+    }
+
+    bool SameBits(const Matrix& a, const Matrix& b)
+    {
+        return memcmp(&a, &b, sizeof(Matrix)) == 0;
+    }
+
+    bool SameBits(const Vector3& a, const Vector3& b)
+    {
+        return memcmp(&a, &b, sizeof(Vector3)) == 0;
+    }
+
+    Quaternion AxisAngle(const Vector3d& axis, double angle)
+    {
+        Vector3d n;
+        axis.Normalize(n);
+        const double s = std::sin(angle * 0.5);
+        return Quaternion(static_cast<float>(n.x * s), static_cast<float>(n.y * s), static_cast<float>(n.z * s), static_cast<float>(std::cos(angle * 0.5)));
+    }
+}
+
+int TestV3d()
+{
+    // Vector3d
+    static_assert(std::is_nothrow_default_constructible<Vector3d>::value, "Default Ctor.");
+    static_assert(std::is_nothrow_copy_constructible<Vector3d>::value, "Copy Ctor.");
+    static_assert(std::is_copy_assignable<Vector3d>::value, "Copy Assign.");
+    static_assert(std::is_nothrow_move_constructible<Vector3d>::value, "Move Ctor.");
+    static_assert(std::is_move_assignable<Vector3d>::value, "Move Assign.");
+
+    bool success = true;
+
+    const Vector3d upVector(0, 1., 0);
+    const Vector3d rightVector(1., 0, 0);
+    const Vector3d v1(1., 2., 3.);
+    const Vector3d v2(4., 5., 6.);
+    const Vector3d v3(3., -23., 100.);
+
+    if (upVector == rightVector)
+    {
+        printf("ERROR: ==\n");
+        success = false;
+    }
+
+    if (upVector != upVector)
+    {
+        printf("ERROR: !=\n");
+        success = false;
+    }
+
+    {
+        const XMFLOAT3 xm(6.f, -2.f, 7.f);
+        const Vector3d vi(xm);
+        if (vi != Vector3d(6., -2., 7.))
+        {
+            printf("ERROR: XMFLOAT3 ctor\n");
+            success = false;
+        }
+
+        const Vector3 vf = vi.ToVector3();
+        if (vf.x != xm.x || vf.y != xm.y || vf.z != xm.z)
+        {
+            printf("ERROR: ToVector3\n");
+            success = false;
+        }
+    }
+
+    if (Vector3d::Zero != Vector3d(0.)
+        || Vector3d::One != Vector3d(1.)
+        || rightVector != Vector3d::UnitX
+        || upVector != Vector3d::UnitY
+        || Vector3d(0, 0, 1.) != Vector3d::UnitZ
+        || upVector != Vector3d::Up
+        || Vector3d(0, -1., 0) != Vector3d::Down
+        || rightVector != Vector3d::Right
+        || Vector3d(-1., 0, 0) != Vector3d::Left
+        || Vector3d(0, 0, -1.) != Vector3d::Forward
+        || Vector3d(0, 0, 1.) != Vector3d::Backward)
+    {
+        printf("ERROR: constants\n");
+        success = false;
+    }
+
+    // Assignment and binary operators
+    {
+        Vector3d v = v1;
+        v += v2;
+        if (v != Vector3d(5., 7., 9.) || v != v1 + v2)
+        {
+            printf("ERROR: +=\n");
+            success = false;
+        }
+
+        v = v1;
+        v -= v2;
+        if (v != Vector3d(-3., -3., -3.) || v != v1 - v2)
+        {
+            printf("ERROR: -=\n");
+            success = false;
+        }
+
+        v = v1;
+        v *= v2;
+        if (v != Vector3d(4., 10., 18.) || v != v1 * v2)
+        {
+            printf("ERROR: *=\n");
+            success = false;
+        }
+
+        v = v1;
+        v *= 0.5;
+        if (v != Vector3d(0.5, 1., 1.5) || v != v1 * 0.5 || v != 0.5 * v1)
+        {
+            printf("ERROR: *= scalar\n");
+            success = false;
+        }
+
+        v = v2;
+        v /= 2.;
+        if (v != Vector3d(2., 2.5, 3.) || v != v2 / 2.)
+        {
+            printf("ERROR: /=\n");
+            success = false;
+        }
+
+        if (v2 / v1 != Vector3d(4., 2.5, 2.))
+        {
+            printf("ERROR: / vector\n");
+            success = false;
+        }
+
+        if (-v1 != Vector3d(-1., -2., -3.) || +v1 != v1)
+        {
+            printf("ERROR: unary\n");
+            success = false;
+        }
+    }
+
+    // Vector operations
+    if (!NearEqual(v3.Length(), std::sqrt(10538.)) || v3.LengthSquared() != 10538.)
+    {
+        printf("ERROR: Length %f %f\n", v3.Length(), v3.LengthSquared());
+        success = false;
+    }
+
+    if (v1.Dot(v2) != 32.)
+    {
+        printf("ERROR: Dot %f\n", v1.Dot(v2));
+        success = false;
+    }
+
+    {
+        Vector3d result;
+        v1.Cross(v2, result);
+        if (result != Vector3d(-3., 6., -3.) || v1.Cross(v2) != result || rightVector.Cross(upVector) != Vector3d::UnitZ)
+        {
+            printf("ERROR: Cross\n");
+            success = false;
+        }
+    }
+
+    {
+        Vector3d v = v3;
+        v.Normalize();
+        if (!NearEqual(v, v3 / std::sqrt(10538.)) || !NearEqual(v.Length(), 1.))
+        {
+            printf("ERROR: Normalize\n");
+            success = false;
+        }
+
+        Vector3d z;
+        Vector3d::Zero.Normalize(z);
+        if (z != Vector3d::Zero)
+        {
+            printf("ERROR: Normalize zero\n");
+            success = false;
+        }
+    }
+
+    {
+        Vector3d v = v3;
+        v.Clamp(Vector3d(0., 0., 0.), Vector3d(2., 2., 2.));
+        if (v != Vector3d(2., 0., 2.))
+        {
+            printf("ERROR: Clamp\n");
+            success = false;
+        }
+    }
+
+    if (Vector3d::Min(v1, v3) != Vector3d(1., -23., 3.) || Vector3d::Max(v1, v3) != Vector3d(3., 2., 100.))
+    {
+        printf("ERROR: Min/Max\n");
+        success = false;
+    }
+
+    if (Vector3d::Distance(v1, v2) != std::sqrt(27.) || Vector3d::DistanceSquared(v1, v2) != 27.)
+    {
+        printf("ERROR: Distance\n");
+        success = false;
+    }
+
+    if (Vector3d::Lerp(v1, v2, 0.) != v1 || Vector3d::Lerp(v1, v2, 1.) != v2 || Vector3d::Lerp(v1, v2, 0.5) != Vector3d(2.5, 3.5, 4.5))
+    {
+        printf("ERROR: Lerp\n");
+        success = false;
+    }
+
+    // Transform keeps full precision far from the origin
+    {
+        const Vector3d position(6378137.25, -1.5, 4000000.125);
+        const Matrix4d m = Matrix4d::CreateScale(2.) * Matrix4d::CreateTranslation(position);
+
+        Vector3d result;
+        Vector3d::Transform(v1, m, result);
+        if (result != Vector3d(6378139.25, 2.5, 4000006.125) || Vector3d::Transform(v1, m) != result)
+        {
+            printf("ERROR: Transform %f %f %f\n", result.x, result.y, result.z);
+            success = false;
+        }
+
+        Vector3d::TransformNormal(v1, m, result);
+        if (result != Vector3d(2., 4., 6.) || Vector3d::TransformNormal(v1, m) != result)
+        {
+            printf("ERROR: TransformNormal\n");
+            success = false;
+        }
+    }
+
+    return success ? 0 : 1;
+}
+
+int TestM4d()
+{
+    // Matrix4d
+    static_assert(std::is_nothrow_default_constructible<Matrix4d>::value, "Default Ctor.");
+    static_assert(std::is_nothrow_copy_constructible<Matrix4d>::value, "Copy Ctor.");
+    static_assert(std::is_copy_assignable<Matrix4d>::value, "Copy Assign.");
+    static_assert(std::is_nothrow_move_constructible<Matrix4d>::value, "Move Ctor.");
+    static_assert(std::is_move_assignable<Matrix4d>::value, "Move Assign.");
+
+    bool success = true;
+
+    const Matrix4d a(
+        0., 1., 2., 3.,
+        4., 5., 6., 7.,
+        8., 9., 10., 11.,
+        12., 13., 14., 15.);
+
+    if (Matrix4d() != Matrix4d::Identity || a == Matrix4d::Identity || a != a)
+    {
+        printf("ERROR: ==\n");
+        success = false;
+    }
+
+    if (a(2, 1) != 9. || a._32 != 9.)
+    {
+        printf("ERROR: operator()\n");
+        success = false;
+    }
+
+    {
+        const Matrix m = Matrix::CreateLookAt(Vector3(10, 10, 10), Vector3(0, 0, 0), Vector3::UnitY);
+        const Matrix4d md(m);
+        const Matrix mf = md.ToMatrix();
+        if (!SameBits(mf, m))
+        {
+            printf("ERROR: XMFLOAT4X4 ctor / ToMatrix\n");
+            success = false;
+        }
+    }
+
+    {
+        const Matrix4d product = a * a;
+        const Matrix4d expected(
+            56., 62., 68., 74.,
+            152., 174., 196., 218.,
+            248., 286., 324., 362.,
+            344., 398., 452., 506.);
+        if (product != expected)
+        {
+            printf("ERROR: *\n");
+            success = false;
+        }
+
+        Matrix4d m = a;
+        m *= a;
+        if (m != expected || a * Matrix4d::Identity != a)
+        {
+            printf("ERROR: *=\n");
+            success = false;
+        }
+    }
+
+    if (a.Transpose() != Matrix4d(0., 4., 8., 12., 1., 5., 9., 13., 2., 6., 10., 14., 3., 7., 11., 15.))
+    {
+        printf("ERROR: Transpose\n");
+        success = false;
+    }
+
+    {
+        Matrix4d m = Matrix4d::CreateTranslation(1., 2., 3.);
+        if (m.Translation() != Vector3d(1., 2., 3.))
+        {
+            printf("ERROR: CreateTranslation\n");
+            success = false;
+        }
+
+        m.Translation(Vector3d(-4., 5., 1e7));
+        if (m._41 != -4. || m._42 != 5. || m._43 != 1e7)
+        {
+            printf("ERROR: Translation set\n");
+            success = false;
+        }
+
+        if (Matrix4d::CreateScale(2.) != Matrix4d::CreateScale(Vector3d(2., 2., 2.)) || Matrix4d::CreateScale(Vector3d(2., 3., 4.)).Determinant() != 24.)
+        {
+            printf("ERROR: CreateScale\n");
+            success = false;
+        }
+    }
+
+    // Determinant and inverse
+    {
+        if (a.Determinant() != 0.)
+        {
+            printf("ERROR: Determinant singular\n");
+            success = false;
+        }
+
+        Matrix4d inv;
+        a.Invert(inv);
+        if (inv != Matrix4d(0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0.))
+        {
+            printf("ERROR: Invert singular\n");
+            success = false;
+        }
+
+        const Matrix4d m = Matrix4d::CreateScale(Vector3d(2., 3., 0.5))
+            * Matrix4d::CreateFromQuaternion(AxisAngle(Vector3d(1., 2., 3.), 0.75))
+            * Matrix4d::CreateTranslation(6378137., -25., 1e6);
+
+        if (!NearEqual(m.Determinant(), 3., 1e-6))
+        {
+            printf("ERROR: Determinant %f\n", m.Determinant());
+            success = false;
+        }
+
+        if (!NearEqual(m * m.Invert(), Matrix4d::Identity, 1e-9) || !NearEqual(m.Invert() * m, Matrix4d::Identity, 1e-9))
+        {
+            printf("ERROR: Invert\n");
+            success = false;
+        }
+
+        const Vector3d p(6378000.5, 12.25, 999999.75);
+        if (!NearEqual(Vector3d::Transform(Vector3d::Transform(p, m), m.Invert()), p, 1e-8))
+        {
+            printf("ERROR: Invert round trip\n");
+            success = false;
+        }
+    }
+
+    // Factories agree with SimpleMath near the origin
+    {
+        const Quaternion q = AxisAngle(Vector3d(-1., 0.5, 2.), 1.25);
+        if (!NearEqual(Matrix4d::CreateFromQuaternion(q).ToMatrix(), Matrix::CreateFromQuaternion(q)))
+        {
+            printf("ERROR: CreateFromQuaternion\n");
+            success = false;
+        }
+
+        const Vector3d eye(10., 4., -7.);
+        const Vector3d target(1., 2., 3.);
+        const Matrix view = Matrix::CreateLookAt(eye.ToVector3(), target.ToVector3(), Vector3::UnitY);
+        if (!NearEqual(Matrix4d::CreateLookAt(eye, target, Vector3d::UnitY).ToMatrix(), view))
+        {
+            printf("ERROR: CreateLookAt\n");
+            success = false;
+        }
+
+        const Vector3d forward(0.25, -0.5, 1.);
+        const Matrix world = Matrix::CreateWorld(eye.ToVector3(), forward.ToVector3(), Vector3::UnitY);
+        if (!NearEqual(Matrix4d::CreateWorld(eye, forward, Vector3d::UnitY).ToMatrix(), world))
+        {
+            printf("ERROR: CreateWorld\n");
+            success = false;
+        }
+
+        // The view matrix takes the eye to the origin, looking down -z
+        const Matrix4d viewd = Matrix4d::CreateLookAt(eye, target, Vector3d::UnitY);
+        const Vector3d t = Vector3d::Transform(target, viewd);
+        if (!NearEqual(Vector3d::Transform(eye, viewd), Vector3d::Zero, 1e-12)
+            || !NearEqual(t, Vector3d(0., 0., -Vector3d::Distance(eye, target)), 1e-12))
+        {
+            printf("ERROR: CreateLookAt eye/target\n");
+            success = false;
+        }
+    }
+
+    return success ? 0 : 1;
+}
+
+int TestCameraRelative()
+{
+    bool success = true;
+
+    std::mt19937 gen(2025);
+    std::uniform_real_distribution<double> dist(-1., 1.);
+
+    // A camera 20 km out, and objects within a few hundred meters of it
+    const Vector3d camera(20000.123456789, 153.25, -18000.987654321);
+
+    // Matrices: single vs. batch are bit-identical, and match the double reference
+    for (const size_t count : c_BatchCounts)
+    {
+        std::vector<Matrix4d> worlds(count);
+        for (auto& w : worlds)
+        {
+            const Vector3d offset(dist(gen) * 500., dist(gen) * 50., dist(gen) * 500.);
+            const Vector3d axis(dist(gen), dist(gen), 1.);
+            w = Matrix4d::CreateScale(1. + dist(gen) * 0.5)
+                * Matrix4d::CreateFromQuaternion(AxisAngle(axis, dist(gen) * XM_PI))
+                * Matrix4d::CreateTranslation(camera + offset);
+        }
+
+        const Matrix sentinel(-1.f, -2.f, -3.f, -4.f, -5.f, -6.f, -7.f, -8.f, -9.f, -10.f, -11.f, -12.f, -13.f, -14.f, -15.f, -16.f);
+        std::vector<Matrix> result(count + 1, sentinel);
+        ToCameraRelative(worlds.data(), count, camera, result.data());
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            const Matrix4d reference = worlds[j] * Matrix4d::CreateTranslation(-camera);
+            const Matrix expected = reference.ToMatrix();
+            if (!NearEqual(result[j], expected))
+            {
+                printf("ERROR: ToCameraRelative matrix %zu of %zu\n", j, count);
+                success = false;
+            }
+
+            if (!SameBits(ToCameraRelative(worlds[j], camera), result[j]))
+            {
+                printf("ERROR: ToCameraRelative matrix single vs. batch %zu of %zu\n", j, count);
+                success = false;
+            }
+        }
+
+        if (!SameBits(result[count], sentinel))
+        {
+            printf("ERROR: ToCameraRelative matrix overrun %zu\n", count);
+            success = false;
+        }
+    }
+
+    // Points
+    for (const size_t count : c_BatchCounts)
+    {
+        std::vector<Vector3d> positions(count);
+        for (auto& p : positions)
+        {
+            p = camera + Vector3d(dist(gen) * 500., dist(gen) * 50., dist(gen) * 500.);
+        }
+
+        const Vector3 sentinel(-12345.f, 0.f, 12345.f);
+        std::vector<Vector3> result(count + 1, sentinel);
+        ToCameraRelative(positions.data(), count, camera, result.data());
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            const Vector3d delta = positions[j] - camera;
+            const Vector3 expected(static_cast<float>(delta.x), static_cast<float>(delta.y), static_cast<float>(delta.z));
+            if (!SameBits(result[j], expected) || !SameBits(ToCameraRelative(positions[j], camera), expected))
+            {
+                printf("ERROR: ToCameraRelative point %zu of %zu: %f %f %f ... %f %f %f\n", j, count,
+                    result[j].x, result[j].y, result[j].z, expected.x, expected.y, expected.z);
+                success = false;
+            }
+        }
+
+        Vector3 last = result[count];
+        VerifyEqual(last, sentinel);
+    }
+
+    // The camera-relative view and world compose to the full double-precision world-view
+    {
+        const Vector3d eye = camera + Vector3d(3., 2., 10.);
+        const Vector3d target = camera + Vector3d(-1., 0., -4.);
+        const Matrix4d view = Matrix4d::CreateLookAt(eye, target, Vector3d::UnitY);
+        const Matrix4d world = Matrix4d::CreateFromQuaternion(AxisAngle(Vector3d(0., 1., 0.), 0.5)) * Matrix4d::CreateTranslation(target);
+
+        const Matrix relativeView = CameraRelativeView(view, eye);
+        const Matrix worldView = ToCameraRelative(world, eye) * relativeView;
+        const Matrix expected = (world * view).ToMatrix();
+        if (!NearEqual(worldView, expected))
+        {
+            printf("ERROR: CameraRelativeView\n");
+            success = false;
+        }
+
+        // A look-at view rebased on its own eye has no translation left
+        if (std::fabs(relativeView._41) > EPSILON || std::fabs(relativeView._42) > EPSILON || std::fabs(relativeView._43) > EPSILON)
+        {
+            printf("ERROR: CameraRelativeView translation %f %f %f\n", relativeView._41, relativeView._42, relativeView._43);
+            success = false;
+        }
+    }
+
+    // Jitter: an object a few centimeters from a camera 20 km out, in float world space vs. camera-relative
+    {
+        double floatError = 0.;
+        double relativeError = 0.;
+        for (size_t j = 0; j < 256; ++j)
+        {
+            const Vector3d position = camera + Vector3d(dist(gen), dist(gen), dist(gen)) * 0.05;
+            const Vector3d delta = position - camera;
+
+            const Vector3 pf = position.ToVector3();
+            const Vector3 cf = camera.ToVector3();
+            const Vector3d floatDelta(double(pf.x) - double(cf.x), double(pf.y) - double(cf.y), double(pf.z) - double(cf.z));
+            floatError = std::max(floatError, Vector3d::Distance(floatDelta, delta));
+
+            const Vector3 rf = ToCameraRelative(position, camera);
+            relativeError = std::max(relativeError, Vector3d::Distance(Vector3d(rf), delta));
+        }
+
+        // Float steps are ~2mm at 20 km; camera-relative is well below a micron at 5 cm
+        if (relativeError > 1e-8 || floatError < 1e-4)
+        {
+            printf("ERROR: jitter float %g m, camera-relative %g m\n", floatError, relativeError);
+            success = false;
+        }
+    }
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,502 @@
+//-------------------------------------------------------------------------------------
+// SimpleMathTestHash.cpp
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX 1
+#define NODRAWTEXT
+#define NOGDI
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#ifndef _WIN32
+#include "pch.h"
+#endif
+
+#include "SimpleMath.h"
+
+#include "SimpleMathTest.h"
+
+#include "SimpleMathHash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DX;
+
+namespace
+{
+    // Every value is found again, and a value not inserted is not
+    template<typename T, size_t N>
+    bool VerifyUnordered(const char* name, const T(&values)[N], const T& missing)
+    {
+        bool success = true;
+
+        std::unordered_map<T, int> map;
+        for (size_t j = 0; j < N; ++j)
+        {
+            map[values[j]] = static_cast<int>(j);
+        }
+
+        if (map.size() != N)
+        {
+            printf("ERROR: unordered_map<%s> size %zu\n", name, map.size());
+            success = false;
+        }
+
+        for (size_t j = 0; j < N; ++j)
+        {
+            auto it = map.find(values[j]);
+            if (it == map.end() || it->second != static_cast<int>(j))
+            {
+                printf("ERROR: unordered_map<%s> find %zu\n", name, j);
+                success = false;
+            }
+
+            // Same value, same hash
+            const T copy = values[j];
+            if (std::hash<T>()(copy) != std::hash<T>()(values[j]))
+            {
+                printf("ERROR: hash<%s> %zu\n", name, j);
+                success = false;
+            }
+        }
+
+        if (map.find(missing) != map.end())
+        {
+            printf("ERROR: unordered_map<%s> found missing value\n", name);
+            success = false;
+        }
+
+        return success;
+    }
+
+    std::vector<uint32_t> Sorted(std::vector<uint32_t> values)
+    {
+        std::sort(values.begin(), values.end());
+        return values;
+    }
+}
+
+int TestHash()
+{
+    // std::hash
+    using Rectangle = SimpleMath::Rectangle;
+
+    bool success = true;
+
+    // Same keys as TestL uses for std::map
+    {
+        const Rectangle rects[] = { Rectangle(0, 0, 100, 100), Rectangle(10, 20, 4, 5), Rectangle(12, 15, 100, 7), Rectangle(0, 0, 10, 23), Rectangle(10, 20, 0, 0), Rectangle(0, 0, 0, 0) };
+        if (!VerifyUnordered("Rectangle", rects, Rectangle(20, 10, 5, 4)))
+            success = false;
+
+        const Vector2 v2[] = { Vector2(3.f, 2.f), Vector2(1.f, 2.f), Vector2(2.f, 2.f), Vector2(2.f, 1.f) };
+        if (!VerifyUnordered("Vector2", v2, Vector2(1.f, 1.f)))
+            success = false;
+
+        const Vector3 v3[] = { Vector3(3.f, 2.f, 3.f), Vector3(1.f, 2.f, 3.f), Vector3(2.f, 3.f, 3.f), Vector3(2.f, 1.f, 3.f), Vector3(2.f, 2.f, 3.f), Vector3(2.f, 2.f, 1.f) };
+        if (!VerifyUnordered("Vector3", v3, Vector3(3.f, 2.f, 1.f)))
+            success = false;
+
+        const Vector4 v4[] = { Vector4(3.f, 2.f, 3.f, 4.f), Vector4(1.f, 2.f, 3.f, 4.f), Vector4(2.f, 3.f, 3.f, 4.f), Vector4(2.f, 1.f, 3.f, 4.f),
+            Vector4(2.f, 2.f, 3.f, 4.f), Vector4(2.f, 2.f, 1.f, 4.f), Vector4(2.f, 2.f, 2.f, 3.f), Vector4(2.f, 2.f, 2.f, 1.f) };
+        if (!VerifyUnordered("Vector4", v4, Vector4(4.f, 3.f, 2.f, 2.f)))
+            success = false;
+
+        const Matrix m[] = { Matrix(1, 2, 3, 4, 2, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16), Matrix(1, 2, 6, 4, 5, 6, 7, 4, 9, 10, 11, 12, 13, 14, 15, 16),
+            Matrix(1, 2, 3, 4, 8, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16), Matrix(1, 2, 3, 4, 8, 6, 7, 8, 9, 10, 11, 12, 19, 14, 15, 16) };
+        if (!VerifyUnordered("Matrix", m, Matrix::Identity))
+            success = false;
+
+        const Plane p[] = { Plane(3.f, 2.f, 3.f, 4.f), Plane(1.f, 2.f, 3.f, 4.f), Plane(2.f, 3.f, 3.f, 4.f), Plane(2.f, 1.f, 3.f, 4.f) };
+        if (!VerifyUnordered("Plane", p, Plane(4.f, 3.f, 2.f, 1.f)))
+            success = false;
+
+        const Quaternion q[] = { Quaternion(3.f, 2.f, 3.f, 4.f), Quaternion(1.f, 2.f, 3.f, 4.f), Quaternion(2.f, 3.f, 3.f, 4.f), Quaternion(2.f, 1.f, 3.f, 4.f) };
+        if (!VerifyUnordered("Quaternion", q, Quaternion::Identity))
+            success = false;
+
+        const Color c[] = { Color(3.f, 2.f, 3.f, 4.f), Color(1.f, 2.f, 3.f, 4.f), Color(2.f, 3.f, 3.f, 4.f), Color(2.f, 1.f, 3.f, 4.f) };
+        if (!VerifyUnordered("Color", c, Color(0.f, 0.f, 0.f, 0.f)))
+            success = false;
+
+        const Ray rays[] = { Ray(Vector3(3.f, 2.f, 3.f), Vector3(1, 1, 1)), Ray(Vector3(1.f, 2.f, 3.f), Vector3(2, 3, 4)), Ray(Vector3(2.f, 3.f, 3.f), Vector3(3, 5, 2)),
+            Ray(Vector3(2.f, 1.f, 3.f), Vector3(4, 9, 5)), Ray(Vector3(2.f, 2.f, 3.f), Vector3(5, 8, 2)) };
+        if (!VerifyUnordered("Ray", rays, Ray(Vector3(3.f, 2.f, 3.f), Vector3(1, 1, 2))))
+            success = false;
+
+        const Viewport vp[] = { Viewport(0.f, 0.f, 640.f, 480.f), Viewport(0.f, 0.f, 1920.f, 1080.f), Viewport(0.f, 0.f, 640.f, 480.f, 0.25f, 0.75f), Viewport(32.f, 16.f, 640.f, 480.f) };
+        if (!VerifyUnordered("Viewport", vp, Viewport(16.f, 32.f, 640.f, 480.f)))
+            success = false;
+    }
+
+    // -0 and +0 compare equal, so they must find each other
+    {
+        std::unordered_set<Vector3> set;
+        set.insert(Vector3(0.f, 1.f, 0.f));
+
+        const Vector3 negative(-0.f, 1.f, -0.f);
+        if (set.find(negative) == set.end() || std::hash<Vector3>()(negative) != std::hash<Vector3>()(Vector3(0.f, 1.f, 0.f)))
+        {
+            printf("ERROR: hash -0\n");
+            success = false;
+        }
+    }
+
+    // Lattice points (the worst case for weak float hashes) spread over the buckets
+    {
+        constexpr size_t c_Buckets = 4096;
+        std::vector<uint32_t> buckets(c_Buckets);
+        std::unordered_set<size_t> distinct;
+
+        size_t count = 0;
+        for (int z = 0; z < 32; ++z)
+        {
+            for (int y = 0; y < 32; ++y)
+            {
+                for (int x = 0; x < 32; ++x)
+                {
+                    const size_t h = std::hash<Vector3>()(Vector3(float(x), float(y), float(z) * 0.5f));
+                    ++buckets[h % c_Buckets];
+                    distinct.insert(h);
+                    ++count;
+                }
+            }
+        }
+
+        // Eight per bucket on average
+        const uint32_t worst = *std::max_element(buckets.cbegin(), buckets.cend());
+        if (distinct.size() != count || worst > 24)
+        {
+            printf("ERROR: hash distribution %zu distinct of %zu, worst bucket %u\n", distinct.size(), count, worst);
+            success = false;
+        }
+    }
+
+    // Tolerance-quantized keys
+    {
+        std::unordered_set<Vector3, QuantizedHash<Vector3>, QuantizedEqualTo<Vector3>> set(16, QuantizedHash<Vector3>(0.01f), QuantizedEqualTo<Vector3>(0.01f));
+
+        set.insert(Vector3(1.001f, 2.002f, 3.003f));
+        set.insert(Vector3(1.004f, 2.f, 3.009f));
+        set.insert(Vector3(1.011f, 2.002f, 3.003f));
+        set.insert(Vector3(-1.001f, 2.002f, 3.003f));
+
+        if (set.size() != 3)
+        {
+            printf("ERROR: QuantizedHash<Vector3> size %zu\n", set.size());
+            success = false;
+        }
+
+        const QuantizedHash<Matrix> hash(0.001f);
+        const QuantizedEqualTo<Matrix> equal(0.001f);
+        Matrix a = Matrix::CreateRotationY(0.5f);
+        Matrix b = a;
+        b._41 = 0.0002f;
+        if (!equal(a, b) || hash(a) != hash(b))
+        {
+            printf("ERROR: QuantizedHash<Matrix>\n");
+            success = false;
+        }
+
+        b._41 = 0.0012f;
+        if (equal(a, b))
+        {
+            printf("ERROR: QuantizedEqualTo<Matrix>\n");
+            success = false;
+        }
+
+        const QuantizedEqualTo<Color> colorEqual(1.f / 255.f);
+        if (!colorEqual(Color(0.5f, 0.25f, 1.f, 1.f), Color(0.5001f, 0.2501f, 1.f, 1.f)))
+        {
+            printf("ERROR: QuantizedEqualTo<Color>\n");
+            success = false;
+        }
+    }
+
+    return success ? 0 : 1;
+}
+
+int TestSpatialHashGrid()
+{
+    bool success = true;
+
+    std::mt19937 gen(2026);
+    std::uniform_real_distribution<float> dist(-10.f, 10.f);
+
+    std::vector<Vector3> points(2000);
+    for (auto& p : points)
+    {
+        p = Vector3(dist(gen), dist(gen), dist(gen) * 0.25f);
+    }
+
+    // Built in one go, and inserted one at a time
+    SpatialHashGrid built(0.5f);
+    built.Build(points.data(), points.size());
+
+    SpatialHashGrid inserted(0.75f);
+    for (size_t j = 0; j < points.size(); ++j)
+    {
+        const uint32_t index = inserted.Insert(points[j]);
+        VerifyEqual(index, static_cast<uint32_t>(j));
+    }
+
+    VerifyEqual(static_cast<uint32_t>(built.Size()), static_cast<uint32_t>(points.size()));
+    VerifyEqual(static_cast<uint32_t>(inserted.Size()), static_cast<uint32_t>(points.size()));
+
+    if (built.CellCount() == 0 || built.CellCount() > points.size() || built.CellSize() != 0.5f)
+    {
+        printf("ERROR: CellCount %zu\n", built.CellCount());
+        success = false;
+    }
+
+    // Radius queries and nearest against brute force, including radii far larger than the cells
+    const float radii[] = { 0.f, 0.1f, 0.5f, 1.7f, 4.f, 50.f };
+    for (const float radius : radii)
+    {
+        for (size_t q = 0; q < 64; ++q)
+        {
+            // Half the queries centered on existing points, so radius 0 finds something
+            const Vector3 center = (q & 1) ? points[q * 7] : Vector3(dist(gen), dist(gen), dist(gen) * 0.25f);
+
+            std::vector<uint32_t> expected;
+            uint32_t nearest = SpatialHashGrid::c_Empty;
+            float nearestDist = 0.f;
+            for (size_t j = 0; j < points.size(); ++j)
+            {
+                const float dx = points[j].x - center.x;
+                const float dy = points[j].y - center.y;
+                const float dz = points[j].z - center.z;
+                const float d = dx * dx + dy * dy + dz * dz;
+                if (d <= radius * radius)
+                {
+                    expected.push_back(static_cast<uint32_t>(j));
+                    if (nearest == SpatialHashGrid::c_Empty || d < nearestDist)
+                    {
+                        nearest = static_cast<uint32_t>(j);
+                        nearestDist = d;
+                    }
+                }
+            }
+
+            for (const auto* grid : { &built, &inserted })
+            {
+                std::vector<uint32_t> found;
+                bool distances = true;
+                grid->Query(center, radius, [&](uint32_t index, float d)
+                    {
+                        found.push_back(index);
+                        const Vector3 delta = points[index] - center;
+                        distances &= (std::fabs(delta.LengthSquared() - d) <= EPSILON2 * std::max(1.f, d));
+                    });
+
+                if (Sorted(found) != expected || !distances)
+                {
+                    printf("ERROR: Query radius %f: found %zu, expected %zu (cell size %f)\n", radius, found.size(), expected.size(), grid->CellSize());
+                    success = false;
+                }
+
+                uint32_t index;
+                float d;
+                const bool hit = grid->Nearest(center, radius, index, d);
+                if (hit != (nearest != SpatialHashGrid::c_Empty) || (hit && (index != nearest || d != nearestDist)))
+                {
+                    printf("ERROR: Nearest radius %f: %u ... %u\n", radius, hit ? index : SpatialHashGrid::c_Empty, nearest);
+                    success = false;
+                }
+            }
+        }
+    }
+
+    // Insert after Build continues the numbering
+    {
+        SpatialHashGrid grid(1.f);
+        grid.Build(points.data(), 100);
+        const uint32_t index = grid.Insert(points[0]);
+        VerifyEqual(index, 100u);
+
+        std::vector<uint32_t> found;
+        grid.Query(points[0], 0.f, [&](uint32_t i, float) { found.push_back(i); });
+        if (Sorted(found) != std::vector<uint32_t>{ 0u, 100u })
+        {
+            printf("ERROR: Insert after Build\n");
+            success = false;
+        }
+
+        uint32_t nearest;
+        float d;
+        if (!grid.Nearest(points[0], 0.f, nearest, d) || nearest != 0)
+        {
+            printf("ERROR: Nearest ties go to the lowest index\n");
+            success = false;
+        }
+
+        grid.Clear();
+        if (grid.Size() != 0 || grid.CellCount() != 0 || grid.Nearest(points[0], 100.f, nearest, d))
+        {
+            printf("ERROR: Clear\n");
+            success = false;
+        }
+    }
+
+    // Welding: jittered copies of well-separated points merge, exact duplicates merge at tolerance 0
+    {
+        std::vector<Vector3> bases;
+        for (int z = 0; z < 5; ++z)
+        {
+            for (int y = 0; y < 10; ++y)
+            {
+                for (int x = 0; x < 10; ++x)
+                {
+                    bases.emplace_back(float(x) * 1.5f - 7.f, float(y) * 2.f, float(z) - 2.5f);
+                }
+            }
+        }
+
+        std::uniform_int_distribution<size_t> pick(0, bases.size() / 2);
+        std::uniform_real_distribution<float> jitter(-0.01f, 0.01f);
+
+        std::vector<size_t> source(3000);
+        std::vector<Vector3> positions(source.size());
+        for (size_t j = 0; j < positions.size(); ++j)
+        {
+            source[j] = pick(gen);
+            positions[j] = bases[source[j]] + Vector3(jitter(gen), jitter(gen), jitter(gen));
+        }
+
+        std::vector<uint32_t> remap(positions.size());
+        std::vector<Vector3> unique(positions.size());
+        const size_t kept = WeldPositions(positions.data(), positions.size(), 0.05f, remap.data(), unique.data());
+
+        std::map<size_t, uint32_t> sourceToKept;
+        for (size_t j = 0; j < positions.size(); ++j)
+        {
+            const auto it = sourceToKept.emplace(source[j], remap[j]).first;
+            const Vector3 delta = positions[j] - unique[remap[j]];
+            if (it->second != remap[j] || remap[j] >= kept || delta.Length() > 0.05f)
+            {
+                printf("ERROR: WeldPositions %zu\n", j);
+                success = false;
+                break;
+            }
+        }
+
+        if (kept != sourceToKept.size())
+        {
+            printf("ERROR: WeldPositions kept %zu, expected %zu\n", kept, sourceToKept.size());
+            success = false;
+        }
+
+        // Exact duplicates, against std::map
+        std::vector<Vector3> exact(positions.size());
+        for (size_t j = 0; j < exact.size(); ++j)
+        {
+            exact[j] = bases[source[j]];
+        }
+        exact[1] = Vector3(exact[0].x, exact[0].y, std::nextafter(exact[0].z, 100.f));
+
+        std::map<Vector3, uint32_t> ordered;
+        const size_t exactKept = WeldPositions(exact.data(), exact.size(), 0.f, remap.data());
+        for (size_t j = 0; j < exact.size(); ++j)
+        {
+            const auto it = ordered.emplace(exact[j], static_cast<uint32_t>(ordered.size())).first;
+            if (it->second != remap[j])
+            {
+                printf("ERROR: WeldPositions exact %zu\n", j);
+                success = false;
+                break;
+            }
+        }
+        VerifyEqual(static_cast<uint32_t>(exactKept), static_cast<uint32_t>(ordered.size()));
+
+        // FindOrInsert reports whether the position was new
+        SpatialHashGrid grid(0.05f);
+        const auto first = grid.FindOrInsert(Vector3(1.f, 2.f, 3.f), 0.05f);
+        const auto second = grid.FindOrInsert(Vector3(1.01f, 2.f, 3.f), 0.05f);
+        const auto third = grid.FindOrInsert(Vector3(1.1f, 2.f, 3.f), 0.05f);
+        if (first != std::make_pair(0u, true) || second != std::make_pair(0u, false) || third != std::make_pair(1u, true))
+        {
+            printf("ERROR: FindOrInsert\n");
+            success = false;
+        }
+    }
+
+    // Extreme and non-finite positions are stored and skipped over without trouble
+    {
+        const Vector3 odd[] = { Vector3(1e30f, -1e30f, 0.f), Vector3(INFINITY, 0.f, 0.f), Vector3(NAN, 1.f, 2.f), Vector3(0.f, 0.f, 0.f) };
+        SpatialHashGrid grid(1.f);
+        grid.Build(odd, std::size(odd));
+
+        std::vector<uint32_t> found;
+        grid.Query(Vector3(0.f, 0.f, 0.f), 2.f, [&](uint32_t i, float) { found.push_back(i); });
+        grid.Query(Vector3(0.f, 0.f, 0.f), INFINITY, [&](uint32_t i, float) { found.push_back(i); });
+        if (Sorted(found) != std::vector<uint32_t>{ 0u, 1u, 3u, 3u })
+        {
+            printf("ERROR: non-finite positions %zu\n", found.size());
+            success = false;
+        }
+    }
+
+    // Invalid arguments
+    {
+        const float badSizes[] = { 0.f, -1.f, NAN, INFINITY, 1e-40f };
+        for (const float size : badSizes)
+        {
+            try
+            {
+                SpatialHashGrid grid(size);
+                printf("ERROR: expected to throw for cell size %g\n", size);
+                success = false;
+            }
+            catch (const std::invalid_argument&)
+            {
+            }
+        }
+
+        try
+        {
+            SpatialHashGrid grid(1.f);
+            grid.Build(nullptr, 4);
+            printf("ERROR: Build expected to throw for null positions\n");
+            success = false;
+        }
+        catch (const std::invalid_argument&)
+        {
+        }
+
+        try
+        {
+            uint32_t remap = 0;
+            WeldPositions(points.data(), 1, -1.f, &remap);
+            printf("ERROR: WeldPositions expected to throw for negative tolerance\n");
+            success = false;
+        }
+        catch (const std::invalid_argument&)
+        {
+        }
+
+        // Empty input is fine
+        SpatialHashGrid grid;
+        grid.Build(nullptr, 0);
+        VerifyEqual(static_cast<uint32_t>(WeldPositions(nullptr, 0, 0.f, nullptr)), 0u);
+    }
+
+    return success ? 0 : 1;
+}
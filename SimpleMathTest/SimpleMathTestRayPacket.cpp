@@ -0,0 +1,336 @@
+//-------------------------------------------------------------------------------------
+// SimpleMathTestRayPacket.cpp
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX 1
+#define NODRAWTEXT
+#define NOGDI
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#ifndef _WIN32
+#include "pch.h"
+#endif
+
+#include "SimpleMath.h"
+
+#include "SimpleMathTest.h"
+
+#include "RayPacket.h"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DX;
+
+namespace
+{
+    struct Scene
+    {
+        std::vector<Ray>            rays;
+        std::vector<BoundingBox>    boxes;
+        std::vector<BoundingSphere> spheres;
+        std::vector<Vector3>        vertices;
+    };
+
+    // Each ray i is aimed near primitive i, with axis-aligned rays, rays starting inside
+    // their primitive and degenerate triangles mixed in
+    Scene CreateScene(size_t count, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        auto random = [&](float range) { return Vector3(dist(rng) * range, dist(rng) * range, dist(rng) * range); };
+
+        Scene scene;
+        scene.rays.resize(count);
+        scene.boxes.resize(count);
+        scene.spheres.resize(count);
+        scene.vertices.resize(count * 3);
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            const Vector3 origin = random(20.f);
+
+            Vector3 direction = random(1.f);
+            if ((j % 5) == 1)
+            {
+                direction = (j & 2) ? Vector3::UnitZ : -Vector3::UnitZ;
+            }
+            else if ((j % 7) == 3)
+            {
+                direction = Vector3::UnitX;
+            }
+            else if (direction.LengthSquared() < 0.0001f)
+            {
+                direction = Vector3::UnitY;
+            }
+            direction.Normalize();
+
+            scene.rays[j] = Ray(origin, direction);
+
+            const Vector3 target = ((j % 6) == 2) ? origin : origin + direction * (8.f + fabsf(dist(rng)) * 10.f) + random(3.f);
+
+            scene.boxes[j] = BoundingBox(target, Vector3(1.f + fabsf(dist(rng)) * 3.f, 1.f + fabsf(dist(rng)) * 3.f, 1.f + fabsf(dist(rng)) * 3.f));
+            scene.spheres[j] = BoundingSphere(target, 1.f + fabsf(dist(rng)) * 3.f);
+
+            scene.vertices[j * 3] = target + random(4.f);
+            scene.vertices[j * 3 + 1] = target + random(4.f);
+            scene.vertices[j * 3 + 2] = ((j % 9) == 4) ? scene.vertices[j * 3] : target + random(4.f);
+        }
+
+        return scene;
+    }
+
+    bool dist_near_equal(float a, float b)
+    {
+        return fabsf(a - b) <= EPSILON3 * std::max(1.f, fabsf(b));
+    }
+
+    // Compares every distance (FLT_MAX for a miss) and the hit count with the Ray::Intersects results
+    template<typename TIntersects>
+    bool VerifyAll(size_t count, const float* dist, size_t hits, TIntersects intersects, const char* name)
+    {
+        bool success = true;
+        size_t expectedHits = 0;
+        for (size_t j = 0; j < count; ++j)
+        {
+            float expected = 0.f;
+            if (intersects(j, expected))
+            {
+                ++expectedHits;
+                if (!dist_near_equal(dist[j], expected))
+                {
+                    printf("ERROR: %s %zu: %f (expecting %f)\n", name, j, dist[j], expected);
+                    success = false;
+                }
+            }
+            else if (dist[j] != FLT_MAX)
+            {
+                printf("ERROR: %s %zu: %f (expecting a miss)\n", name, j, dist[j]);
+                success = false;
+            }
+        }
+
+        if (hits != expectedHits)
+        {
+            printf("ERROR: %s hit count %zu (expecting %zu)\n", name, hits, expectedHits);
+            success = false;
+        }
+        return success;
+    }
+
+    template<typename TNearest, typename TIntersects>
+    bool VerifyNearest(size_t count, TNearest nearest, TIntersects intersects, const char* name)
+    {
+        size_t index = 0;
+        float dist = 0.f;
+        const bool found = nearest(index, dist);
+
+        bool expectedFound = false;
+        float expectedDist = FLT_MAX;
+        for (size_t j = 0; j < count; ++j)
+        {
+            float d = 0.f;
+            if (intersects(j, d) && d < expectedDist)
+            {
+                expectedDist = d;
+                expectedFound = true;
+            }
+        }
+
+        if (found != expectedFound || (found && !dist_near_equal(dist, expectedDist)))
+        {
+            printf("ERROR: %s nearest %f (expecting %f)\n", name, found ? dist : -1.f, expectedFound ? expectedDist : -1.f);
+            return false;
+        }
+
+        // Ties may resolve to either index, but it must be a hit at that distance
+        float d = 0.f;
+        if (found && (index >= count || !intersects(index, d) || !dist_near_equal(d, dist)))
+        {
+            printf("ERROR: %s nearest index %zu\n", name, index);
+            return false;
+        }
+        return true;
+    }
+}
+
+int TestRayPacket()
+{
+    bool success = true;
+
+    std::mt19937 rng(0x52415950);
+
+    // Containers
+    {
+        RayPacket empty;
+        VerifyEqual(static_cast<uint32_t>(empty.Size()), 0u);
+
+        RayPacket rays(5);
+        rays.Set(4, Ray(Vector3(1.f, 2.f, 3.f), Vector3::UnitX));
+        rays.Resize(2);
+        rays.Resize(5);
+        VerifyEqual(rays.Get(4).direction, Vector3::UnitZ);
+        VerifyEqual(rays.Get(4).position, Vector3::Zero);
+
+        SphereStream spheres(3);
+        spheres.Set(1, BoundingSphere(Vector3(1.f, 1.f, 1.f), 4.f));
+        spheres.Resize(1);
+        spheres.Resize(3);
+        VerifyEqual(spheres.Get(1).Radius, 0.f);
+
+        TriangleStream triangles;
+        const Vector3 tri[3] = { Vector3(1.f, 2.f, 3.f), Vector3(4.f, 5.f, 6.f), Vector3(-1.f, 0.5f, 2.f) };
+        triangles.Load(tri, 1);
+        Vector3 v0, v1, v2;
+        triangles.Get(0, v0, v1, v2);
+        VerifyEqual(v0, tri[0]);
+        VerifyNearEqual(v1, tri[1]);
+        VerifyNearEqual(v2, tri[2]);
+
+        const uint16_t indices[] = { 2, 0, 1 };
+        triangles.Load(tri, 3, indices, 1);
+        triangles.Get(0, v0, v1, v2);
+        VerifyEqual(v0, tri[2]);
+    }
+
+    // Invalid arguments
+    {
+        bool threw = false;
+        try
+        {
+            RayPacket rays(3);
+            rays.Intersects(BoundingBox(), nullptr);
+        }
+        catch (const std::invalid_argument&)
+        {
+            threw = true;
+        }
+        VerifyEqual(threw, true);
+
+        threw = false;
+        try
+        {
+            const Vector3 tri[3] = {};
+            const uint32_t indices[] = { 0, 1, 3 };
+            TriangleStream triangles;
+            triangles.Load(tri, 3, indices, 1);
+        }
+        catch (const std::out_of_range&)
+        {
+            threw = true;
+        }
+        VerifyEqual(threw, true);
+
+        threw = false;
+        try
+        {
+            BoxStream boxes(nullptr, 4);
+        }
+        catch (const std::invalid_argument&)
+        {
+            threw = true;
+        }
+        VerifyEqual(threw, true);
+    }
+
+    // Agreement with Ray::Intersects, including partial blocks
+    for (const size_t count : { 0u, 1u, 3u, 4u, 7u, 8u, 9u, 31u, 64u, 257u })
+    {
+        const Scene scene = CreateScene(count, rng);
+
+        const RayPacket rays(scene.rays.data(), count);
+        const BoxStream boxes(scene.boxes.data(), count);
+        const SphereStream spheres(scene.spheres.data(), count);
+        TriangleStream triangles;
+        triangles.Load(scene.vertices.data(), count);
+
+        // One extra element to catch writes past the end
+        std::vector<float> dist(count + 1, -1.f);
+
+        const size_t tests = std::min<size_t>(count, 12);
+        for (size_t k = 0; k < tests; ++k)
+        {
+            const BoundingBox& box = scene.boxes[k];
+            const BoundingSphere& sphere = scene.spheres[k];
+            const Ray& ray = scene.rays[k];
+
+            auto rayBox = [&](size_t j, float& d) { return scene.rays[j].Intersects(box, d); };
+            auto raySphere = [&](size_t j, float& d) { return scene.rays[j].Intersects(sphere, d); };
+            auto boxRay = [&](size_t j, float& d) { return ray.Intersects(scene.boxes[j], d); };
+            auto sphereRay = [&](size_t j, float& d) { return ray.Intersects(scene.spheres[j], d); };
+            auto triangleRay = [&](size_t j, float& d) { return ray.Intersects(scene.vertices[j * 3], scene.vertices[j * 3 + 1], scene.vertices[j * 3 + 2], d); };
+
+            success &= VerifyAll(count, dist.data(), rays.Intersects(box, dist.data()), rayBox, "RayPacket box");
+            success &= VerifyAll(count, dist.data(), rays.Intersects(sphere, dist.data()), raySphere, "RayPacket sphere");
+            success &= VerifyNearest(count, [&](size_t& i, float& d) { return rays.Nearest(box, i, d); }, rayBox, "RayPacket box");
+            success &= VerifyNearest(count, [&](size_t& i, float& d) { return rays.Nearest(sphere, i, d); }, raySphere, "RayPacket sphere");
+
+            success &= VerifyAll(count, dist.data(), boxes.Intersects(ray, dist.data()), boxRay, "BoxStream");
+            success &= VerifyAll(count, dist.data(), spheres.Intersects(ray, dist.data()), sphereRay, "SphereStream");
+            success &= VerifyAll(count, dist.data(), triangles.Intersects(ray, dist.data()), triangleRay, "TriangleStream");
+            success &= VerifyNearest(count, [&](size_t& i, float& d) { return boxes.Nearest(ray, i, d); }, boxRay, "BoxStream");
+            success &= VerifyNearest(count, [&](size_t& i, float& d) { return spheres.Nearest(ray, i, d); }, sphereRay, "SphereStream");
+            success &= VerifyNearest(count, [&](size_t& i, float& d) { return triangles.Nearest(ray, i, d); }, triangleRay, "TriangleStream");
+
+            // Aimed at the centroid, so every triangle gets hit from one face or the other
+            const Vector3 centroid = (scene.vertices[k * 3] + scene.vertices[k * 3 + 1] + scene.vertices[k * 3 + 2]) / 3.f;
+            Vector3 origin = centroid + Vector3(float(k) - 6.f, 10.f - float(k), (k & 1) ? 7.f : -7.f);
+            Vector3 toCentroid = centroid - origin;
+            toCentroid.Normalize();
+            const Ray aimed(origin, toCentroid);
+
+            auto triangleAimed = [&](size_t j, float& d) { return aimed.Intersects(scene.vertices[j * 3], scene.vertices[j * 3 + 1], scene.vertices[j * 3 + 2], d); };
+            success &= VerifyAll(count, dist.data(), triangles.Intersects(aimed, dist.data()), triangleAimed, "TriangleStream aimed");
+
+            if (dist[count] != -1.f)
+            {
+                printf("ERROR: wrote past the end for %zu elements\n", count);
+                success = false;
+            }
+        }
+    }
+
+    // Picking against a larger scene finds a hit for the same rays as the scalar test
+    {
+        constexpr size_t c_Count = 4096;
+        constexpr size_t c_Rays = 64;
+
+        const Scene scene = CreateScene(c_Count, rng);
+        TriangleStream triangles;
+        triangles.Load(scene.vertices.data(), c_Count);
+
+        size_t scalarHits = 0;
+        size_t packetHits = 0;
+        for (size_t r = 0; r < c_Rays; ++r)
+        {
+            float best = FLT_MAX;
+            for (size_t j = 0; j < c_Count; ++j)
+            {
+                float d = 0.f;
+                if (scene.rays[r].Intersects(scene.vertices[j * 3], scene.vertices[j * 3 + 1], scene.vertices[j * 3 + 2], d) && d < best)
+                    best = d;
+            }
+            scalarHits += (best < FLT_MAX) ? 1 : 0;
+
+            size_t index = 0;
+            float d = 0.f;
+            packetHits += triangles.Nearest(scene.rays[r], index, d) ? 1 : 0;
+        }
+
+        VerifyEqual(static_cast<uint32_t>(packetHits), static_cast<uint32_t>(scalarHits));
+    }
+
+    return success ? 0 : 1;
+}
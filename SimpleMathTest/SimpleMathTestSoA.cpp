@@ -0,0 +1,295 @@
+//-------------------------------------------------------------------------------------
+// SimpleMathTestSoA.cpp
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX 1
+#define NODRAWTEXT
+#define NOGDI
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#ifndef _WIN32
+#include "pch.h"
+#endif
+
+#include "SimpleMath.h"
+
+#include "SimpleMathTest.h"
+
+#include "SoAMath.h"
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DX;
+
+namespace
+{
+    Vector3 RandomVector3(std::mt19937& gen, std::uniform_real_distribution<float>& dist)
+    {
+        const float x = dist(gen);
+        const float y = dist(gen);
+        const float z = dist(gen);
+        return Vector3(x, y, z);
+    }
+
+    Quaternion RandomRotation(std::mt19937& gen, std::uniform_real_distribution<float>& dist)
+    {
+        const float yaw = dist(gen);
+        const float pitch = dist(gen);
+        const float roll = dist(gen);
+        return Quaternion::CreateFromYawPitchRoll(yaw, pitch, roll);
+    }
+
+    template<typename TException, typename TFunc>
+    bool Throws(TFunc&& func)
+    {
+        try
+        {
+            func();
+        }
+        catch (const TException&)
+        {
+            return true;
+        }
+        return false;
+    }
+}
+
+int TestSoA()
+{
+    bool success = true;
+
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<float> dist(-10.f, 10.f);
+
+    const Matrix world = Matrix::CreateScale(1.5f, 0.5f, 2.f)
+        * Matrix::CreateFromYawPitchRoll(0.3f, -1.1f, 2.f)
+        * Matrix::CreateTranslation(10.f, -20.f, 30.f);
+    const Matrix projection = Matrix::CreatePerspectiveFieldOfView(XM_PIDIV4, 1.5f, 0.1f, 100.f);
+    const Quaternion rotation = Quaternion::CreateFromYawPitchRoll(-0.7f, 0.2f, 1.3f);
+
+    // Containers
+    {
+        Vector3Stream empty;
+        VerifyEqual(static_cast<uint32_t>(empty.Size()), 0u);
+        VerifyEqual(static_cast<uint32_t>(empty.PaddedSize()), 0u);
+
+        Vector3Stream v(5);
+        VerifyEqual(static_cast<uint32_t>(v.Size()), 5u);
+        VerifyEqual(static_cast<uint32_t>(v.PaddedSize()), 8u);
+        VerifyEqual(v.Get(4), Vector3::Zero);
+
+        v.Set(4, Vector3(1.f, 2.f, 3.f));
+        VerifyEqual(v.Get(4), Vector3(1.f, 2.f, 3.f));
+        VerifyEqual(v.X()[4], 1.f);
+        VerifyEqual(v.Y()[4], 2.f);
+        VerifyEqual(v.Z()[4], 3.f);
+
+        // Elements that come back after shrinking are reset
+        v.Resize(3);
+        v.Resize(6);
+        VerifyEqual(v.Get(4), Vector3::Zero);
+
+        QuaternionStream q(9);
+        VerifyEqual(static_cast<uint32_t>(q.PaddedSize()), 16u);
+        VerifyEqual(q.Get(8), Quaternion::Identity);
+
+        const Vector3 points[3] = { Vector3(1.f, 2.f, 3.f), Vector3(4.f, 5.f, 6.f), Vector3(7.f, 8.f, 9.f) };
+        const Vector3Stream loaded(points, 3);
+
+        Vector3 stored[3] = {};
+        loaded.Store(stored);
+        for (size_t j = 0; j < 3; ++j)
+        {
+            VerifyEqual(stored[j], points[j]);
+        }
+
+        const Quaternion rotations[2] = { rotation, Quaternion::Identity };
+        const QuaternionStream qloaded(rotations, 2);
+
+        Quaternion qstored[2] = {};
+        qloaded.Store(qstored);
+        VerifyEqual(qstored[0], rotation);
+        VerifyEqual(qstored[1], Quaternion::Identity);
+
+        if (!Throws<std::invalid_argument>([&]() { Vector3Stream::Cross(loaded, Vector3Stream(4), v); })
+            || !Throws<std::invalid_argument>([&]() { QuaternionStream::Multiply(qloaded, QuaternionStream(3), q); })
+            || !Throws<std::invalid_argument>([&]() { Vector3Stream bad(static_cast<const Vector3*>(nullptr), 2); }))
+        {
+            printf("ERROR: expected mismatched or null inputs to be rejected\n");
+            success = false;
+        }
+    }
+
+    for (const size_t count : c_BatchCounts)
+    {
+        std::vector<Vector3> a(count);
+        std::vector<Vector3> b(count);
+        std::vector<Quaternion> qa(count);
+        std::vector<Quaternion> qb(count);
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            a[j] = RandomVector3(gen, dist);
+            b[j] = RandomVector3(gen, dist);
+            qa[j] = RandomRotation(gen, dist);
+            qb[j] = RandomRotation(gen, dist);
+        }
+
+        // Zero vectors normalize to zero, and identical rotations take the Slerp linear path
+        if (count > 2)
+        {
+            a[1] = Vector3::Zero;
+            qb[2] = qa[2];
+        }
+
+        const Vector3Stream sa(a.data(), count);
+        const Vector3Stream sb(b.data(), count);
+        const QuaternionStream sqa(qa.data(), count);
+        const QuaternionStream sqb(qb.data(), count);
+
+        Vector3Stream vresult;
+        QuaternionStream qresult;
+
+        // Vector3
+        Vector3Stream::Transform(sa, world, vresult);
+        VerifyEqual(static_cast<uint32_t>(vresult.Size()), static_cast<uint32_t>(count));
+        for (size_t j = 0; j < count; ++j)
+        {
+            VerifyRelativeEqual(vresult.Get(j), Vector3::Transform(a[j], world));
+        }
+
+        Vector3Stream::Transform(sa, projection, vresult);
+        for (size_t j = 0; j < count; ++j)
+        {
+            VerifyRelativeEqual(vresult.Get(j), Vector3::Transform(a[j], projection));
+        }
+
+        Vector3Stream::TransformNormal(sa, world, vresult);
+        for (size_t j = 0; j < count; ++j)
+        {
+            VerifyRelativeEqual(vresult.Get(j), Vector3::TransformNormal(a[j], world));
+        }
+
+        Vector3Stream::Transform(sa, rotation, vresult);
+        for (size_t j = 0; j < count; ++j)
+        {
+            VerifyRelativeEqual(vresult.Get(j), Vector3::Transform(a[j], rotation));
+        }
+
+        Vector3Stream::Transform(sa, sqa, vresult);
+        for (size_t j = 0; j < count; ++j)
+        {
+            VerifyRelativeEqual(vresult.Get(j), Vector3::Transform(a[j], qa[j]));
+        }
+
+        Vector3Stream::Normalize(sa, vresult);
+        for (size_t j = 0; j < count; ++j)
+        {
+            Vector3 expected;
+            a[j].Normalize(expected);
+            VerifyRelativeEqual(vresult.Get(j), expected);
+        }
+
+        std::vector<float> dots(count + 1, -1.f);
+        Vector3Stream::Dot(sa, sb, dots.data());
+        for (size_t j = 0; j < count; ++j)
+        {
+            VerifyRelativeEqual(dots[j], a[j].Dot(b[j]));
+        }
+        VerifyEqual(dots[count], -1.f);
+
+        Vector3Stream::Cross(sa, sb, vresult);
+        for (size_t j = 0; j < count; ++j)
+        {
+            VerifyRelativeEqual(vresult.Get(j), a[j].Cross(b[j]));
+        }
+
+        Vector3Stream::Lerp(sa, sb, 0.25f, vresult);
+        for (size_t j = 0; j < count; ++j)
+        {
+            VerifyRelativeEqual(vresult.Get(j), Vector3::Lerp(a[j], b[j], 0.25f));
+        }
+
+        // In place
+        Vector3Stream inplace = sa;
+        Vector3Stream::Cross(inplace, sb, inplace);
+        for (size_t j = 0; j < count; ++j)
+        {
+            VerifyRelativeEqual(inplace.Get(j), a[j].Cross(b[j]));
+        }
+
+        // Quaternion
+        QuaternionStream::Multiply(sqa, sqb, qresult);
+        VerifyEqual(static_cast<uint32_t>(qresult.Size()), static_cast<uint32_t>(count));
+        for (size_t j = 0; j < count; ++j)
+        {
+            VerifyRelativeEqual(qresult.Get(j), qa[j] * qb[j]);
+        }
+
+        QuaternionStream::Normalize(sqa, qresult);
+        for (size_t j = 0; j < count; ++j)
+        {
+            Quaternion expected;
+            qa[j].Normalize(expected);
+            VerifyRelativeEqual(qresult.Get(j), expected);
+        }
+
+        for (const float t : { 0.f, 0.3f, 1.f })
+        {
+            QuaternionStream::Lerp(sqa, sqb, t, qresult);
+            for (size_t j = 0; j < count; ++j)
+            {
+                VerifyRelativeEqual(qresult.Get(j), Quaternion::Lerp(qa[j], qb[j], t));
+            }
+
+            QuaternionStream::Slerp(sqa, sqb, t, qresult);
+            for (size_t j = 0; j < count; ++j)
+            {
+                VerifyRelativeEqual(qresult.Get(j), Quaternion::Slerp(qa[j], qb[j], t));
+            }
+        }
+
+        // Matrix
+        std::vector<Matrix> ma(count);
+        std::vector<Matrix> mb(count);
+        std::vector<Matrix> mresult(count);
+        for (size_t j = 0; j < count; ++j)
+        {
+            ma[j] = Matrix::CreateFromQuaternion(qa[j]) * Matrix::CreateTranslation(a[j]);
+            mb[j] = Matrix::CreateFromQuaternion(qb[j]) * Matrix::CreateTranslation(b[j]);
+        }
+
+        MultiplyMatrices(ma.data(), world, mresult.data(), count);
+        for (size_t j = 0; j < count; ++j)
+        {
+            VerifyRelativeEqual(mresult[j], ma[j] * world);
+        }
+
+        MultiplyMatrices(ma.data(), mb.data(), mresult.data(), count);
+        for (size_t j = 0; j < count; ++j)
+        {
+            VerifyRelativeEqual(mresult[j], ma[j] * mb[j]);
+        }
+
+        MultiplyMatrices(ma.data(), world, ma.data(), count);
+        for (size_t j = 0; j < count; ++j)
+        {
+            VerifyRelativeEqual(ma[j], Matrix::CreateFromQuaternion(qa[j]) * Matrix::CreateTranslation(a[j]) * world);
+        }
+    }
+
+    return success ? 0 : 1;
+}
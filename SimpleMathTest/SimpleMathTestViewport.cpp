@@ -0,0 +1,271 @@
+//-------------------------------------------------------------------------------------
+// SimpleMathTestViewport.cpp
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX 1
+#define NODRAWTEXT
+#define NOGDI
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#ifndef _WIN32
+#include "pch.h"
+#endif
+
+#include "SimpleMath.h"
+
+#include "SimpleMathTest.h"
+
+#include "ViewportProjection.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+using namespace DirectX;
+using namespace DirectX::SimpleMath;
+using namespace DX;
+
+namespace
+{
+    struct Camera
+    {
+        const char* name;
+        Viewport    viewport;
+        Matrix      proj;
+        Matrix      view;
+        Matrix      world;
+    };
+
+    Vector3 RandomVector3(std::mt19937& gen, std::uniform_real_distribution<float>& dist, float range)
+    {
+        const float x = dist(gen) * range;
+        const float y = dist(gen) * range;
+        const float z = dist(gen) * range;
+        return Vector3(x, y, z);
+    }
+
+    // Clip-space z below zero means in front of the near plane (or behind the eye)
+    bool InFrontOfNear(const Camera& camera, const Vector3& p)
+    {
+        const Vector4 clip = Vector4::Transform(Vector4(p.x, p.y, p.z, 1.f), camera.world * camera.view * camera.proj);
+        return clip.z < 0.f;
+    }
+}
+
+int TestViewportProjection()
+{
+    bool success = true;
+
+    std::mt19937 gen(2024);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+    const Camera cameras[] =
+    {
+        { "perspective",
+            Viewport(0.f, 0.f, 640.f, 480.f),
+            Matrix::CreatePerspectiveFieldOfView(XM_PI / 4.f, 640.f / 480.f, 0.1f, 100.f),
+            Matrix::CreateLookAt(Vector3(10, 10, 10), Vector3(0, 0, 0), Vector3::UnitY),
+            Matrix::CreateWorld(Vector3(1, 2, 3), Vector3::UnitX, Vector3::UnitZ) },
+        { "offset viewport",
+            Viewport(32.f, 16.f, 1024.f, 768.f, 0.25f, 0.75f),
+            Matrix::CreatePerspectiveFieldOfView(XM_PIDIV2, 1024.f / 768.f, 1.f, 50.f),
+            Matrix::CreateLookAt(Vector3(-5, 2, 8), Vector3(0, 1, 0), Vector3::UnitY),
+            Matrix::CreateScale(2.f) * Matrix::CreateFromYawPitchRoll(0.5f, -0.25f, 0.125f) },
+        { "orthographic",
+            Viewport(0.f, 0.f, 1920.f, 1080.f),
+            Matrix::CreateOrthographic(40.f, 22.5f, 0.5f, 60.f),
+            Matrix::CreateLookAt(Vector3(0, 20, 20), Vector3(0, 0, 0), Vector3::UnitY),
+            Matrix::Identity },
+    };
+
+    for (const auto& camera : cameras)
+    {
+        const ViewportProjection projection(camera.viewport, camera.proj, camera.view, camera.world);
+
+        for (const size_t count : c_BatchCounts)
+        {
+            // Points around the scene, some behind the eye; one extra element checks for overruns
+            std::vector<Vector3> points(count + 1);
+            for (auto& p : points)
+            {
+                p = RandomVector3(gen, dist, 15.f);
+            }
+
+            const Vector3 sentinel(-12345.f, 0.f, 12345.f);
+            std::vector<Vector3> result(count + 1, sentinel);
+
+            const size_t words = ViewportProjection::NearClipWords(count);
+            std::vector<uint32_t> mask(words + 1, 0xCDCDCDCDu);
+
+            const size_t clipped = projection.Project(points.data(), count, result.data(), mask.data());
+
+            size_t expectedClipped = 0;
+            for (size_t j = 0; j < count; ++j)
+            {
+                const bool front = InFrontOfNear(camera, points[j]);
+                if (ViewportProjection::IsNearClipped(mask.data(), j) != front)
+                {
+                    printf("ERROR: %s near clip %zu of %zu\n", camera.name, j, count);
+                    success = false;
+                }
+
+                if (front)
+                {
+                    ++expectedClipped;
+                    continue;
+                }
+
+                const Vector3 expected = camera.viewport.Project(points[j], camera.proj, camera.view, camera.world);
+                if (!relative_near_equal_to()(result[j], expected))
+                {
+                    printf("ERROR: %s Project %zu of %zu: %f %f %f ... %f %f %f\n", camera.name, j, count,
+                        result[j].x, result[j].y, result[j].z, expected.x, expected.y, expected.z);
+                    success = false;
+                }
+
+                // Folded matrix on its own
+                if (!relative_near_equal_to()(Vector3::Transform(points[j], projection.GetProjectMatrix()), expected))
+                {
+                    printf("ERROR: %s GetProjectMatrix %zu\n", camera.name, j);
+                    success = false;
+                }
+            }
+
+            VerifyEqual(static_cast<uint32_t>(clipped), static_cast<uint32_t>(expectedClipped));
+
+            // Unused bits of the last word are clear, and nothing is written past the end
+            if (count % 32)
+            {
+                const uint32_t unused = mask[words - 1] >> (count % 32);
+                VerifyEqual(unused, 0u);
+            }
+            const uint32_t guard = mask[words];
+            VerifyEqual(guard, 0xCDCDCDCDu);
+            Vector3 last = result[count];
+            VerifyEqual(last, sentinel);
+
+            // Back from screen space, keeping depth away from the far plane where unprojection is ill-conditioned
+            std::vector<Vector3> screen(count + 1);
+            for (auto& s : screen)
+            {
+                const float sx = camera.viewport.x + (dist(gen) * 0.5f + 0.5f) * camera.viewport.width;
+                const float sy = camera.viewport.y + (dist(gen) * 0.5f + 0.5f) * camera.viewport.height;
+                const float depth = dist(gen) * 0.45f + 0.45f;
+                s = Vector3(sx, sy, camera.viewport.minDepth + depth * (camera.viewport.maxDepth - camera.viewport.minDepth));
+            }
+
+            std::fill(result.begin(), result.end(), sentinel);
+            projection.Unproject(screen.data(), count, result.data());
+            for (size_t j = 0; j < count; ++j)
+            {
+                const Vector3 expected = camera.viewport.Unproject(screen[j], camera.proj, camera.view, camera.world);
+                if (!relative_near_equal_to()(result[j], expected))
+                {
+                    printf("ERROR: %s Unproject %zu of %zu: %f %f %f ... %f %f %f\n", camera.name, j, count,
+                        result[j].x, result[j].y, result[j].z, expected.x, expected.y, expected.z);
+                    success = false;
+                }
+            }
+            last = result[count];
+            VerifyEqual(last, sentinel);
+
+            // In place, without a mask, through the free functions
+            std::vector<Vector3> inplace(points);
+            const size_t inplaceClipped = ProjectPoints(camera.viewport, inplace.data(), count, camera.proj, camera.view, camera.world, inplace.data());
+            VerifyEqual(static_cast<uint32_t>(inplaceClipped), static_cast<uint32_t>(expectedClipped));
+
+            UnprojectPoints(camera.viewport, inplace.data(), count, camera.proj, camera.view, camera.world, inplace.data());
+            for (size_t j = 0; j < count; ++j)
+            {
+                // Round trip is only meaningful for points between the near and far planes
+                const Vector3 s = camera.viewport.Project(points[j], camera.proj, camera.view, camera.world);
+                if (InFrontOfNear(camera, points[j]) || s.z > camera.viewport.minDepth + 0.9f * (camera.viewport.maxDepth - camera.viewport.minDepth))
+                    continue;
+
+                if (!relative_near_equal_to()(inplace[j], points[j]))
+                {
+                    printf("ERROR: %s round trip %zu of %zu: %f %f %f ... %f %f %f\n", camera.name, j, count,
+                        inplace[j].x, inplace[j].y, inplace[j].z, points[j].x, points[j].y, points[j].z);
+                    success = false;
+                }
+            }
+            last = inplace[count];
+            VerifyEqual(last, Vector3(points[count]));
+        }
+    }
+
+    // Invalid arguments
+    {
+        const ViewportProjection projection(cameras[0].viewport, cameras[0].proj, cameras[0].view, cameras[0].world);
+        Vector3 p;
+
+        try
+        {
+            projection.Project(nullptr, 4, &p);
+            printf("ERROR: Project expected to throw for null points\n");
+            success = false;
+        }
+        catch (const std::invalid_argument&)
+        {
+        }
+
+        try
+        {
+            projection.Unproject(&p, 4, nullptr);
+            printf("ERROR: Unproject expected to throw for null result\n");
+            success = false;
+        }
+        catch (const std::invalid_argument&)
+        {
+        }
+
+        // Empty arrays are fine
+        VerifyEqual(static_cast<uint32_t>(projection.Project(nullptr, 0, nullptr)), 0u);
+        projection.Unproject(nullptr, 0, nullptr);
+    }
+
+    // A large batch matches Viewport::Project
+    {
+        constexpr size_t c_Count = 16384;
+        const Camera& camera = cameras[0];
+
+        std::vector<Vector3> points(c_Count);
+        for (auto& p : points)
+        {
+            p = RandomVector3(gen, dist, 15.f);
+        }
+
+        std::vector<Vector3> expected(c_Count);
+        std::vector<Vector3> result(c_Count);
+        std::vector<uint32_t> mask(ViewportProjection::NearClipWords(c_Count));
+
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            expected[j] = camera.viewport.Project(points[j], camera.proj, camera.view, camera.world);
+        }
+
+        ProjectPoints(camera.viewport, points.data(), c_Count, camera.proj, camera.view, camera.world, result.data(), mask.data());
+
+        for (size_t j = 0; j < c_Count; ++j)
+        {
+            if (!ViewportProjection::IsNearClipped(mask.data(), j) && !relative_near_equal_to()(result[j], expected[j]))
+            {
+                printf("ERROR: Project %zu of %zu\n", j, c_Count);
+                success = false;
+                break;
+            }
+        }
+    }
+
+    return success ? 0 : 1;
+}
@@ -40,11 +40,13 @@ extern bool Test01();
 extern bool Test02();
 extern bool Test03();
 extern bool Test04();
+extern bool Test05();
 
 TestInfo g_Tests[] =
 {
     { "WAVFileReader", Test01 },
     { "WaveBankReader", Test02 },
+    { "WaveBankReader (prefetch)", Test05 },
     { "Fuzzing (wav)", Test03 },
     { "Fuzzing (xwb)", Test04 },
 };
@@ -20,11 +20,14 @@
 #include <Windows.h>
 
 #include "WaveBankReader.h"
+#include "PrefetchScheduler.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <stdexcept>
 #include <tuple>
+#include <vector>
 
 using namespace DirectX;
 
@@ -432,3 +435,209 @@ bool Test04()
 
     return success;
 }
+
+
+//-------------------------------------------------------------------------------------
+// Prefetch scheduler
+bool Test05()
+{
+    bool success = true;
+
+    size_t ncount = 0;
+    size_t npass = 0;
+
+    for( size_t index=0; index < std::size(g_TestMedia); ++index )
+    {
+        if (!g_TestMedia[index].streaming)
+            continue;
+
+        wchar_t szPath[MAX_PATH] = {};
+        DWORD ret = ExpandEnvironmentStringsW(g_TestMedia[index].fname, szPath, MAX_PATH);
+        if ( !ret || ret > MAX_PATH )
+        {
+            printf( "ERROR: ExpandEnvironmentStrings FAILED\n" );
+            return false;
+        }
+
+        auto wb = std::make_unique<DirectX::WaveBankReader>();
+        HRESULT hr = wb->Open(szPath);
+        if (FAILED(hr))
+        {
+            success = false;
+            printf( "ERROR: Failed loading wavebank from file (HRESULT %08X):\n%ls\n", static_cast<unsigned int>(hr), szPath );
+            ++ncount;
+            continue;
+        }
+
+        wb->WaitOnPrepare();
+
+        // Simulate concurrent streams, two per wave, reading the same entries in small
+        // chunks that do not line up with sectors. The second stream of each pair
+        // lags by one chunk so its reads are adjacent to the first.
+        constexpr uint32_t c_ChunkSize = 10000;
+
+        std::vector<std::vector<uint8_t>> streams;
+        std::vector<WaveBankReader::Metadata> entries;
+
+        bool pass = true;
+        for (uint32_t entry = 0; entry < wb->Count(); ++entry)
+        {
+            WaveBankReader::Metadata metadata = {};
+            hr = wb->GetMetadata(entry, metadata);
+            if (FAILED(hr) || !metadata.lengthBytes)
+            {
+                success = pass = false;
+                printf( "ERROR: Failed getting metadata for entry %u (HRESULT %08X):\n%ls\n", entry, static_cast<unsigned int>(hr), szPath );
+                break;
+            }
+
+            entries.push_back(metadata);
+            streams.emplace_back(metadata.lengthBytes);
+            streams.emplace_back(metadata.lengthBytes);
+        }
+
+        if (!pass)
+        {
+            ++ncount;
+            continue;
+        }
+
+        constexpr size_t c_MaxInFlight = 128 * 1024;
+
+        DX::PrefetchScheduler scheduler(wb->GetAsyncHandle(), 4096, c_MaxInFlight, 64 * 1024);
+
+        uint64_t now = 0;
+        bool pending = true;
+        for (uint32_t chunk = 0; pending; ++chunk)
+        {
+            pending = false;
+
+            for (size_t entry = 0; entry < entries.size(); ++entry)
+            {
+                for (size_t s = 0; s < 2; ++s)
+                {
+                    const uint32_t pos = (chunk + uint32_t(s)) * c_ChunkSize;
+                    if (pos >= entries[entry].lengthBytes)
+                        continue;
+
+                    pending = true;
+
+                    const uint32_t length = std::min(c_ChunkSize, entries[entry].lengthBytes - pos);
+
+                    // The lagging stream has one more chunk buffered, so it can wait longer
+                    std::ignore = scheduler.Submit(uint64_t(entries[entry].offsetBytes) + pos, length,
+                        streams[entry * 2 + s].data() + pos, now + 100 + s * 50);
+                }
+            }
+
+            now += 16;
+            scheduler.Update(now);
+
+            if (scheduler.GetStats().bytesInFlight > c_MaxInFlight)
+            {
+                success = pass = false;
+                printf( "ERROR: Exceeded in-flight budget (%zu bytes):\n%ls\n", scheduler.GetStats().bytesInFlight, szPath );
+            }
+        }
+
+        scheduler.Flush(now);
+
+        const auto& stats = scheduler.GetStats();
+
+        if (stats.requestsCompleted != stats.requestsSubmitted
+            || stats.queueDepth != 0
+            || stats.readsInFlight != 0
+            || stats.bytesInFlight != 0
+            || stats.errors != 0)
+        {
+            success = pass = false;
+            printf( "ERROR: Unexpected prefetch stats (%llu submitted, %llu completed, %zu queued, %zu bytes in flight, %llu errors):\n%ls\n",
+                stats.requestsSubmitted, stats.requestsCompleted, stats.queueDepth, stats.bytesInFlight, stats.errors, szPath );
+        }
+        else if (!stats.requestsMerged || stats.readsIssued >= stats.requestsSubmitted)
+        {
+            success = pass = false;
+            printf( "ERROR: Expected adjacent reads to merge (%llu submitted, %llu reads, %llu merged):\n%ls\n",
+                stats.requestsSubmitted, stats.readsIssued, stats.requestsMerged, szPath );
+        }
+        else if (stats.maxBytesInFlight > c_MaxInFlight)
+        {
+            success = pass = false;
+            printf( "ERROR: Exceeded in-flight budget (%zu bytes):\n%ls\n", stats.maxBytesInFlight, szPath );
+        }
+
+        // Both streams for entry 0 must match the expected contents
+        for (size_t s = 0; s < 2 && pass; ++s)
+        {
+            uint8_t digest[16];
+            hr = MD5Checksum( streams[s].data(), streams[s].size(), digest );
+            if ( FAILED(hr) )
+            {
+                success = pass = false;
+                printf( "Failed computing MD5 checksum of wavebank (HRESULT %08X):\n%ls\n", static_cast<unsigned int>(hr), szPath );
+            }
+            else if ( memcmp( digest, g_TestMedia[index].md5, 16 ) != 0 )
+            {
+                success = pass = false;
+                printf( "Failed comparing MD5 checksum for stream %zu:\n%ls\n", s, szPath );
+                printdigest( "computed", digest );
+                printdigest( "expected", g_TestMedia[index].md5 );
+            }
+        }
+
+        for (size_t entry = 0; entry < entries.size() && pass; ++entry)
+        {
+            if (streams[entry * 2] != streams[entry * 2 + 1])
+            {
+                success = pass = false;
+                printf( "ERROR: Streams for entry %zu do not match:\n%ls\n", entry, szPath );
+            }
+        }
+
+#ifdef _DEBUG
+        char buff[256] = {};
+        sprintf_s(buff, "%llu requests, %llu reads, %llu merged, %zu max bytes in flight, %llu underruns\n",
+            stats.requestsSubmitted, stats.readsIssued, stats.requestsMerged, stats.maxBytesInFlight, stats.underruns);
+        OutputDebugStringA(buff);
+#endif
+
+        if (pass)
+            ++npass;
+
+        ++ncount;
+    }
+
+    printf("%zu files tested, %zu files passed ", ncount, npass );
+
+    // Underrun accounting
+    {
+        auto wb = std::make_unique<DirectX::WaveBankReader>();
+        HRESULT hr = wb->Open(L"StreamingAudioTest\\WaveBank.xwb");
+        if (FAILED(hr))
+        {
+            printf("\nERROR: Failed loading wavebank (HRESULT %08X)\n", static_cast<unsigned int>(hr));
+            return false;
+        }
+
+        wb->WaitOnPrepare();
+
+        WaveBankReader::Metadata metadata = {};
+        std::ignore = wb->GetMetadata(0, metadata);
+
+        std::vector<uint8_t> data(8192);
+
+        DX::PrefetchScheduler scheduler(wb->GetAsyncHandle());
+        std::ignore = scheduler.Submit(metadata.offsetBytes, 4096, data.data(), 10);
+        std::ignore = scheduler.Submit(uint64_t(metadata.offsetBytes) + 4096, 4096, data.data() + 4096, 1000);
+        scheduler.Flush(100);
+
+        if (scheduler.GetStats().underruns != 1 || scheduler.GetStats().readsIssued != 1)
+        {
+            printf("\nERROR: Expected one underrun and one read (%llu, %llu)\n",
+                scheduler.GetStats().underruns, scheduler.GetStats().readsIssued);
+            success = false;
+        }
+    }
+
+    return success;
+}
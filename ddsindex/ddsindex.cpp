@@ -0,0 +1,394 @@
+//--------------------------------------------------------------------------------------
+// File: ddsindex.cpp
+//
+// Command-line tool that validates and indexes DDS files using DDSMetadata.h without
+// any Direct3D runtime. Only the header of each file is read, so it also serves as a
+// throughput benchmark for the metadata parser. With -j the files are instead read in
+// full, parsed, and hashed by TextureIngest.h, optionally using a persistent cache.
+// With -d every BC-compressed file is fully decoded by BCDecode.h.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//--------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define NODRAWTEXT
+#define NOGDI
+#define NOBITMAP
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#include <Windows.h>
+#else
+// Workarounds to avoid conflicts between sal.h and GCC runtime headers
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cinttypes>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <utility>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cwchar>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "BCDecode.h"
+#include "DDSMetadata.h"
+#include "TextureIngest.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    struct Totals
+    {
+        uint64_t files;
+        uint64_t failures;
+        uint64_t headerBytes;
+        uint64_t dataBytes;
+        uint64_t subresources;
+        uint64_t decodedFiles;
+        uint64_t decodedPixels;
+        double decodeSeconds;
+    };
+
+    void PrintPath(const fs::path& path)
+    {
+#ifdef _WIN32
+        wprintf(L"%ls", path.c_str());
+#else
+        printf("%s", path.c_str());
+#endif
+    }
+
+    bool IsDDS(const fs::path& path)
+    {
+        auto ext = path.extension().native();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](auto c) { return (c >= 'A' && c <= 'Z') ? static_cast<decltype(c)>(c - 'A' + 'a') : c; });
+        return ext == fs::path(".dds").native();
+    }
+
+    void PrintMetadata(const DX::DDSMetadata& metadata)
+    {
+        printf("\n    %u x %u x %u, %u mips, format %d, dimension %u, misc %08X, alpha %u\n",
+            metadata.width, metadata.height, metadata.depthOrArraySize, metadata.mipLevels,
+            static_cast<int>(metadata.format), static_cast<unsigned int>(metadata.dimension),
+            metadata.miscFlags, metadata.alphaMode);
+    }
+
+    void DecodeFile(const fs::path& path, uint64_t fileSize, size_t jobs, Totals& totals)
+    {
+        std::ifstream inFile(path, std::ios::in | std::ios::binary);
+        if (!inFile)
+            return;
+
+        std::vector<uint8_t> data(static_cast<size_t>(fileSize));
+        inFile.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (static_cast<size_t>(inFile.gcount()) != data.size())
+            return;
+
+        DX::DDSMetadata metadata = {};
+        std::vector<DX::BCImage> images;
+        std::vector<uint8_t> pixels;
+
+        const auto start = std::chrono::steady_clock::now();
+        const HRESULT hr = DX::DecodeBCDDS(data.data(), data.size(), metadata, images, pixels, jobs);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (hr == HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED))
+            return;
+
+        if (FAILED(hr))
+        {
+            ++totals.failures;
+            printf("DECODE FAILED (%08X) ", static_cast<unsigned int>(hr));
+            PrintPath(path);
+            printf("\n");
+            return;
+        }
+
+        ++totals.decodedFiles;
+        totals.decodedPixels += pixels.size() / 4;
+        totals.decodeSeconds += elapsed.count();
+    }
+
+    void IndexFile(const fs::path& path, uint64_t fileSize, bool verbose, Totals& totals, std::vector<DX::DDSSubresource>& subresources)
+    {
+        ++totals.files;
+
+        uint8_t header[DX::DDS_MAX_HEADER_SIZE] = {};
+
+        std::ifstream inFile(path, std::ios::in | std::ios::binary);
+        if (!inFile)
+        {
+            ++totals.failures;
+            printf("ERROR: Failed to open ");
+            PrintPath(path);
+            printf("\n");
+            return;
+        }
+
+        inFile.read(reinterpret_cast<char*>(header), sizeof(header));
+        const auto headerSize = static_cast<size_t>(inFile.gcount());
+        totals.headerBytes += headerSize;
+
+        DX::DDSMetadata metadata = {};
+        const HRESULT hr = DX::GetDDSMetadata(header, headerSize, fileSize, metadata, &subresources);
+        if (FAILED(hr))
+        {
+            ++totals.failures;
+            printf("FAILED (%08X) ", static_cast<unsigned int>(hr));
+            PrintPath(path);
+            printf("\n");
+            return;
+        }
+
+        totals.dataBytes += metadata.dataSize;
+        totals.subresources += subresources.size();
+
+        if (verbose)
+        {
+            PrintPath(path);
+            PrintMetadata(metadata);
+
+            for (size_t j = 0; j < subresources.size(); ++j)
+            {
+                const auto& sub = subresources[j];
+                printf("    [%zu] offset %" PRIu64 ", %u x %u x %u, rowPitch %zu, slicePitch %zu, rows %zu\n",
+                    j, sub.offset, sub.width, sub.height, sub.depth, sub.rowPitch, sub.slicePitch, sub.numRows);
+            }
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Entry-point
+//--------------------------------------------------------------------------------------
+#ifdef _WIN32
+int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
+#else
+int main(int argc, char* argv[])
+#endif
+{
+    bool recursive = false;
+    bool verbose = false;
+    bool ingest = false;
+    bool decode = false;
+    size_t jobs = 0;
+    fs::path cacheFile;
+
+    std::vector<fs::path> inputs;
+    for (int iArg = 1; iArg < argc; ++iArg)
+    {
+        const fs::path arg(argv[iArg]);
+        if (arg == "-r")
+        {
+            recursive = true;
+        }
+        else if (arg == "-v")
+        {
+            verbose = true;
+        }
+        else if (arg == "-d")
+        {
+            decode = true;
+        }
+        else if (arg == "-j" || arg == "-c")
+        {
+            if (iArg + 1 >= argc)
+            {
+                printf("ERROR: Missing value for %s\n", (arg == "-j") ? "-j" : "-c");
+                return 1;
+            }
+
+            ingest = true;
+            if (arg == "-j")
+            {
+#ifdef _WIN32
+                jobs = static_cast<size_t>(wcstoul(argv[++iArg], nullptr, 10));
+#else
+                jobs = static_cast<size_t>(strtoul(argv[++iArg], nullptr, 10));
+#endif
+            }
+            else
+            {
+                cacheFile = argv[++iArg];
+            }
+        }
+        else
+        {
+            inputs.emplace_back(arg);
+        }
+    }
+
+    // With -d, -j sets the decode threads instead of selecting the ingest pipeline (-c still ingests)
+    if (decode && cacheFile.empty())
+    {
+        ingest = false;
+    }
+
+    if (inputs.empty())
+    {
+        printf("Usage: ddsindex [-r] [-v] [-d] [-j <n>] [-c <cachefile>] <files or directories>\n"
+            "\n"
+            "   -r      search directories recursively for .dds files\n"
+            "   -v      print the metadata and sub-resource layout of each file\n"
+            "   -d      decode every BC-compressed file and report megapixels/sec\n"
+            "   -j <n>  read, parse, and hash whole files using <n> worker threads (0 for all cores);\n"
+            "           with -d, the number of decode threads\n"
+            "   -c <f>  use <f> as a persistent cache so unchanged files are skipped (implies -j 0)\n");
+        return 0;
+    }
+
+    std::vector<fs::path> files;
+    std::vector<uint64_t> fileSizes;
+
+    for (const auto& input : inputs)
+    {
+        std::error_code ec;
+        if (fs::is_directory(input, ec))
+        {
+            auto visit = [&](const fs::directory_entry& entry)
+            {
+                std::error_code err;
+                if (entry.is_regular_file(err) && IsDDS(entry.path()))
+                {
+                    files.emplace_back(entry.path());
+                    fileSizes.emplace_back(entry.file_size(err));
+                }
+            };
+
+            if (recursive)
+            {
+                for (const auto& entry : fs::recursive_directory_iterator(input, fs::directory_options::skip_permission_denied, ec))
+                    visit(entry);
+            }
+            else
+            {
+                for (const auto& entry : fs::directory_iterator(input, fs::directory_options::skip_permission_denied, ec))
+                    visit(entry);
+            }
+        }
+        else
+        {
+            const auto fileSize = fs::file_size(input, ec);
+            if (ec)
+            {
+                printf("ERROR: File not found: ");
+                PrintPath(input);
+                printf("\n");
+                return 1;
+            }
+
+            files.emplace_back(input);
+            fileSizes.emplace_back(fileSize);
+        }
+    }
+
+    if (ingest)
+    {
+        DX::TextureIngest engine(jobs);
+
+        if (!cacheFile.empty())
+        {
+            const HRESULT hr = engine.LoadCache(cacheFile);
+            if (FAILED(hr) && hr != HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND))
+            {
+                printf("WARNING: Ignoring invalid cache file (%08X)\n", static_cast<unsigned int>(hr));
+            }
+        }
+
+        const auto results = engine.Ingest(files);
+
+        for (const auto& entry : results)
+        {
+            if (FAILED(entry.hr))
+            {
+                printf("FAILED (%08X) ", static_cast<unsigned int>(entry.hr));
+                PrintPath(entry.path);
+                printf("\n");
+            }
+            else if (verbose)
+            {
+                PrintPath(entry.path);
+                printf("%s, hash %016" PRIX64, entry.cached ? " (cached)" : "", entry.contentHash);
+                PrintMetadata(entry.metadata);
+            }
+        }
+
+        if (!cacheFile.empty())
+        {
+            const HRESULT hr = engine.SaveCache(cacheFile);
+            if (FAILED(hr))
+            {
+                printf("WARNING: Failed to write cache file (%08X)\n", static_cast<unsigned int>(hr));
+            }
+        }
+
+        const auto& stats = engine.GetStats();
+        printf("\n%zu files ingested, %zu failed, %zu read, %zu from cache\n",
+            stats.files, stats.failures, stats.filesRead, stats.cacheHits);
+        printf("%.3f seconds: %.0f files/sec, %.1f MB/sec read (%.1f MB peak in flight)\n",
+            stats.seconds, stats.FilesPerSecond(), stats.MBPerSecond(),
+            double(stats.maxBytesInFlight) / (1024.0 * 1024.0));
+
+        return (stats.failures > 0) ? 1 : 0;
+    }
+
+    Totals totals = {};
+    std::vector<DX::DDSSubresource> subresources;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (size_t j = 0; j < files.size(); ++j)
+    {
+        IndexFile(files[j], fileSizes[j], verbose, totals, subresources);
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (decode)
+    {
+        for (size_t j = 0; j < files.size(); ++j)
+        {
+            DecodeFile(files[j], fileSizes[j], jobs, totals);
+        }
+    }
+
+    const double seconds = std::max(elapsed.count(), 1e-9);
+
+    printf("\n%" PRIu64 " files indexed, %" PRIu64 " failed, %" PRIu64 " sub-resources\n",
+        totals.files, totals.failures, totals.subresources);
+    printf("%.3f seconds: %.0f files/sec, %.1f MB/sec of headers read, %.1f GB/sec of texture data indexed\n",
+        seconds,
+        double(totals.files) / seconds,
+        double(totals.headerBytes) / seconds / (1024.0 * 1024.0),
+        double(totals.dataBytes) / seconds / (1024.0 * 1024.0 * 1024.0));
+
+    if (decode)
+    {
+        printf("%" PRIu64 " files decoded, %.1f megapixels in %.3f seconds: %.1f megapixels/sec\n",
+            totals.decodedFiles, double(totals.decodedPixels) / 1000000.0, totals.decodeSeconds,
+            (totals.decodeSeconds > 0.) ? double(totals.decodedPixels) / totals.decodeSeconds / 1000000.0 : 0.);
+    }
+
+    return (totals.failures > 0) ? 1 : 0;
+}
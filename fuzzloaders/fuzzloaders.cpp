@@ -26,13 +26,18 @@
 #include <d3d11_1.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cwchar>
 #include <iterator>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -73,6 +78,8 @@ namespace
         OPT_CMO,
         OPT_SDKMESH,
         OPT_VBO,
+        OPT_JOBS,
+        OPT_TIMEOUT,
         OPT_MAX
     };
 
@@ -87,7 +94,9 @@ namespace
         { L"r",         OPT_RECURSIVE },
         { L"cmo",       OPT_CMO },
         { L"dds",       OPT_DDS },
+        { L"j",         OPT_JOBS },
         { L"sdkmesh",   OPT_SDKMESH },
+        { L"timeout",   OPT_TIMEOUT },
         { L"vbo",       OPT_VBO },
         { L"wav",       OPT_WAV },
         { L"wic",       OPT_WIC },
@@ -113,7 +122,10 @@ namespace
             L"   -vbo                force use of VBO loader\n"
             L"   -wav                force use of WAVFileReader\n"
             L"   -wic                force use of WICTextureLoader\n"
-            L"   -xwb                force use of WaveBankReader\n";
+            L"   -xwb                force use of WaveBankReader\n"
+            L"\n"
+            L"   -j <number>         replay the files using <number> worker threads (0 for all cores)\n"
+            L"   -timeout <ms>       fail if any single file takes longer than <ms> milliseconds\n";
 
         wprintf(L"%ls", s_usage);
     }
@@ -224,114 +236,23 @@ namespace
 #pragma prefast(disable : 28198, "Command-line tool, frees all memory on exit")
 #endif
 
-int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
+namespace
 {
-    // Initialize COM (needed for WIC)
-    HRESULT hr = hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
-    if (FAILED(hr))
-    {
-        wprintf(L"Failed to initialize COM (%08X)\n", static_cast<unsigned int>(hr));
-        return 1;
-    }
-
-    // Process command line
-    uint32_t dwOptions = 0;
-    std::list<SConversion> conversion;
-
-    for (int iArg = 1; iArg < argc; iArg++)
-    {
-        PWSTR pArg = argv[iArg];
-
-        if (('-' == pArg[0]) || ('/' == pArg[0]))
-        {
-            pArg++;
-            PWSTR pValue;
-
-            for (pValue = pArg; *pValue && (':' != *pValue); pValue++);
-
-            if (*pValue)
-                *pValue++ = 0;
-
-            uint32_t dwOption = LookupByName(pArg, g_pOptions);
-
-            if (!dwOption || (dwOptions & (1 << dwOption)))
-            {
-                PrintUsage();
-                return 1;
-            }
-
-            dwOptions |= 1 << dwOption;
-
-            switch (dwOption)
-            {
-            case OPT_DDS:
-            case OPT_WAV:
-            case OPT_WIC:
-            case OPT_XWB:
-            case OPT_CMO:
-            case OPT_SDKMESH:
-            case OPT_VBO:
-                {
-                    uint32_t mask = (1 << OPT_DDS)
-                        | (1 << OPT_WAV)
-                        | (1 << OPT_WIC)
-                        | (1 << OPT_XWB)
-                        | (1 << OPT_CMO)
-                        | (1 << OPT_SDKMESH)
-                        | (1 << OPT_VBO)
-                        ;
-                    mask &= ~(1u << dwOption);
-                    if (dwOptions & mask)
-                    {
-                        wprintf(L"-cmo, -dds, -sdkmesh, -vbo, -wav, -wic, and -xwb are mutually exclusive options\n");
-                        return 1;
-                    }
-                }
-                break;
-
-            default:
-                break;
-            }
-        }
-        else if (wcspbrk(pArg, L"?*") != nullptr)
-        {
-            size_t count = conversion.size();
-            SearchForFiles(pArg, conversion, (dwOptions & (1 << OPT_RECURSIVE)) != 0, nullptr);
-            if (conversion.size() <= count)
-            {
-                wprintf(L"No matching files found for %ls\n", pArg);
-                return 1;
-            }
-        }
-        else
-        {
-            SConversion conv = {};
-            conv.szSrc = pArg;
-
-            conversion.push_back(conv);
-        }
-    }
-
-    if (conversion.empty())
-    {
-        wprintf(L"ERROR: Need at least 1 image file to fuzz\n\n");
-        PrintUsage();
-        return 0;
-    }
-
-    ComPtr<ID3D11Device> device;
-    ComPtr<ID3D11DeviceContext> context;
-    hr = CreateDevice(device.GetAddressOf(), context.GetAddressOf());
-    if (FAILED(hr))
-    {
-        wprintf(L"ERROR: Failed to create required Direct3D device to fuzz: %08X\n", static_cast<unsigned int>(hr));
-        return 1;
-    }
+    //////////////////////////////////////////////////////////////////////////////
+    //////////////////////////////////////////////////////////////////////////////
+    //////////////////////////////////////////////////////////////////////////////
 
-    for (auto& pConv : conversion)
+    // Runs the selected loaders over a single file, appending progress marks to 'marks'.
+    // Returns false if the file could not be found, in which case 'marks' holds the error.
+    bool FuzzFile(
+        _In_ ID3D11Device* device,
+        StubEffectFactory& fxFactory,
+        const std::wstring& szSrc,
+        uint32_t dwOptions,
+        std::wstring& marks)
     {
         wchar_t ext[_MAX_EXT];
-        _wsplitpath_s(pConv.szSrc.c_str(), nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT);
+        _wsplitpath_s(szSrc.c_str(), nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT);
         const bool isdds = (_wcsicmp(ext, L".dds") == 0);
         const bool iswav = (_wcsicmp(ext, L".wav") == 0);
         const bool isxwb = (_wcsicmp(ext, L".xwb") == 0);
@@ -384,20 +305,22 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
         // Load source image
 #ifdef _DEBUG
-        OutputDebugStringW(pConv.szSrc.c_str());
+        OutputDebugStringW(szSrc.c_str());
         OutputDebugStringA("\n");
 #endif
 
+        HRESULT hr;
+
         ComPtr<ID3D11Resource> tex;
         if (usedds)
         {
-            hr = DirectX::CreateDDSTextureFromFileEx(device.Get(), pConv.szSrc.c_str(), 0,
+            hr = DirectX::CreateDDSTextureFromFileEx(device, szSrc.c_str(), 0,
                 D3D11_USAGE_STAGING, 0, D3D11_CPU_ACCESS_WRITE, 0,
                 DirectX::DDS_LOADER_DEFAULT, tex.GetAddressOf(), nullptr, nullptr);
             if (hr == HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND))
             {
-                wprintf(L"ERROR: DDSTexture file not not found:\n%ls\n", pConv.szSrc.c_str());
-                return 1;
+                marks = L"ERROR: DDSTexture file not not found:\n" + szSrc + L"\n";
+                return false;
             }
             else if (FAILED(hr)
                 && hr != E_INVALIDARG
@@ -412,11 +335,11 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 sprintf_s(buff, "DDSTexture failed with %08X\n", static_cast<unsigned int>(hr));
                 OutputDebugStringA(buff);
 #endif
-                wprintf(L"!");
+                marks += L'!';
             }
             else
             {
-                wprintf(L"%ls", SUCCEEDED(hr) ? L"*" : L".");
+                marks += SUCCEEDED(hr) ? L'*' : L'.';
             }
         }
 
@@ -424,11 +347,11 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         {
             std::unique_ptr<uint8_t[]> data;
             DirectX::WAVData result = {};
-            hr = DirectX::LoadWAVAudioFromFileEx(pConv.szSrc.c_str(), data, result);
+            hr = DirectX::LoadWAVAudioFromFileEx(szSrc.c_str(), data, result);
             if (hr == HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND))
             {
-                wprintf(L"ERROR: WAVAudio file not not found:\n%ls\n", pConv.szSrc.c_str());
-                return 1;
+                marks = L"ERROR: WAVAudio file not not found:\n" + szSrc + L"\n";
+                return false;
             }
             else if (FAILED(hr)
                 && hr != E_INVALIDARG
@@ -443,22 +366,22 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 sprintf_s(buff, "WAVAudio failed with %08X\n", static_cast<unsigned int>(hr));
                 OutputDebugStringA(buff);
 #endif
-                wprintf(L"!");
+                marks += L'!';
             }
             else
             {
-                wprintf(L"%ls", SUCCEEDED(hr) ? L"*" : L".");
+                marks += SUCCEEDED(hr) ? L'*' : L'.';
             }
         }
 
         if (usexwb)
         {
             auto wb = std::make_unique<DirectX::WaveBankReader>();
-            hr = wb->Open(pConv.szSrc.c_str());
+            hr = wb->Open(szSrc.c_str());
             if (hr == HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND))
             {
-                wprintf(L"ERROR: XWBAudio file not not found:\n%ls\n", pConv.szSrc.c_str());
-                return 1;
+                marks = L"ERROR: XWBAudio file not not found:\n" + szSrc + L"\n";
+                return false;
             }
             else if (FAILED(hr)
                 && hr != E_INVALIDARG
@@ -473,27 +396,26 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 sprintf_s(buff, "XWBAudio failed with %08X\n", static_cast<unsigned int>(hr));
                 OutputDebugStringA(buff);
 #endif
-                wprintf(L"!");
+                marks += L'!';
             }
             else if (SUCCEEDED(hr))
             {
-                wprintf(L"w");
                 wb->WaitOnPrepare();
-                wprintf(L"\b*");
+                marks += L'*';
             }
             else
             {
-                wprintf(L".");
+                marks += L'.';
             }
         }
 
         if (usewic)
         {
-            hr = DirectX::CreateWICTextureFromFileEx(device.Get(), pConv.szSrc.c_str(), 0, D3D11_USAGE_STAGING, 0, D3D11_CPU_ACCESS_WRITE, 0, DirectX::WIC_LOADER_DEFAULT, tex.GetAddressOf(), nullptr);
+            hr = DirectX::CreateWICTextureFromFileEx(device, szSrc.c_str(), 0, D3D11_USAGE_STAGING, 0, D3D11_CPU_ACCESS_WRITE, 0, DirectX::WIC_LOADER_DEFAULT, tex.ReleaseAndGetAddressOf(), nullptr);
             if (hr == HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND))
             {
-                wprintf(L"ERROR: WICTexture file not found:\n%ls\n", pConv.szSrc.c_str());
-                return 1;
+                marks = L"ERROR: WICTexture file not found:\n" + szSrc + L"\n";
+                return false;
             }
             else if (FAILED(hr)
                 && hr != E_INVALIDARG
@@ -507,27 +429,25 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 sprintf_s(buff, "WICTexture failed with %08X\n", static_cast<unsigned int>(hr));
                 OutputDebugStringA(buff);
 #endif
-                wprintf(L"!");
+                marks += L'!';
             }
             else
             {
-                wprintf(L"%ls", SUCCEEDED(hr) ? L"*" : L".");
+                marks += SUCCEEDED(hr) ? L'*' : L'.';
             }
         }
 
         // Load meshes
-        StubEffectFactory fxFactory(device.Get());
-
         if(usecmo)
         {
             try
             {
-                std::ignore = DirectX::Model::CreateFromCMO(device.Get(), pConv.szSrc.c_str(), fxFactory, DirectX::ModelLoader_AllowLargeModels);
-                wprintf(L".");
+                std::ignore = DirectX::Model::CreateFromCMO(device, szSrc.c_str(), fxFactory, DirectX::ModelLoader_AllowLargeModels);
+                marks += L'.';
             }
             catch(const std::exception&)
             {
-                wprintf(L"*");
+                marks += L'*';
             }
         }
 
@@ -535,12 +455,12 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         {
             try
             {
-                std::ignore = DirectX::Model::CreateFromSDKMESH(device.Get(), pConv.szSrc.c_str(), fxFactory, DirectX::ModelLoader_AllowLargeModels);
-                wprintf(L".");
+                std::ignore = DirectX::Model::CreateFromSDKMESH(device, szSrc.c_str(), fxFactory, DirectX::ModelLoader_AllowLargeModels);
+                marks += L'.';
             }
             catch(const std::exception&)
             {
-                wprintf(L"*");
+                marks += L'*';
             }
         }
 
@@ -548,20 +468,343 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         {
             try
             {
-                std::ignore = DirectX::Model::CreateFromVBO(device.Get(), pConv.szSrc.c_str(), nullptr, DirectX::ModelLoader_AllowLargeModels);
-                wprintf(L".");
+                std::ignore = DirectX::Model::CreateFromVBO(device, szSrc.c_str(), nullptr, DirectX::ModelLoader_AllowLargeModels);
+                marks += L'.';
             }
             catch(const std::exception&)
             {
-                wprintf(L"*");
+                marks += L'*';
+            }
+        }
+
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////
+    //////////////////////////////////////////////////////////////////////////////
+    //////////////////////////////////////////////////////////////////////////////
+
+    constexpr size_t c_Idle = size_t(-1);
+    constexpr size_t c_SlowestToReport = 10;
+
+    // Per-thread state polled by the timeout watchdog
+    struct Worker
+    {
+        std::thread thread;
+        std::atomic<size_t> current{ c_Idle };
+        std::atomic<int64_t> started{ 0 };
+    };
+
+    struct Replay
+    {
+        std::vector<std::wstring> files;
+        std::vector<float> elapsedMs;
+        uint32_t dwOptions = 0;
+
+        std::atomic<size_t> next{ 0 };
+        std::atomic<size_t> finished{ 0 };
+        std::atomic<bool> failed{ false };
+        std::mutex outputLock;
+
+        void Print(const std::wstring& text)
+        {
+            const std::lock_guard<std::mutex> lock(outputLock);
+            wprintf(L"%ls", text.c_str());
+            fflush(stdout);
+        }
+    };
+
+    int64_t Now() noexcept
+    {
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    float ToMilliseconds(int64_t ticks) noexcept
+    {
+        using ticks_t = std::chrono::steady_clock::duration;
+        return std::chrono::duration<float, std::milli>(ticks_t(ticks)).count();
+    }
+
+    // Each worker owns its own device and effect factory, and pulls files from the shared list.
+    void WorkerThread(Replay& replay, Worker& worker)
+    {
+        std::ignore = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+        ComPtr<ID3D11Device> device;
+        ComPtr<ID3D11DeviceContext> context;
+        HRESULT hr = CreateDevice(device.GetAddressOf(), context.GetAddressOf());
+        if (FAILED(hr))
+        {
+            wchar_t buff[128] = {};
+            swprintf_s(buff, L"ERROR: Failed to create required Direct3D device to fuzz: %08X\n", static_cast<unsigned int>(hr));
+            replay.Print(buff);
+            replay.failed = true;
+        }
+        else
+        {
+            try
+            {
+                StubEffectFactory fxFactory(device.Get());
+
+                std::wstring marks;
+                while (!replay.failed)
+                {
+                    const size_t index = replay.next++;
+                    if (index >= replay.files.size())
+                        break;
+
+                    const int64_t start = Now();
+                    worker.started = start;
+                    worker.current = index;
+
+                    marks.clear();
+                    const bool found = FuzzFile(device.Get(), fxFactory, replay.files[index], replay.dwOptions, marks);
+
+                    worker.current = c_Idle;
+                    replay.elapsedMs[index] = ToMilliseconds(Now() - start);
+
+                    replay.Print(marks);
+
+                    if (!found)
+                    {
+                        replay.failed = true;
+                    }
+                }
+            }
+            catch (const std::exception& e)
+            {
+                wchar_t buff[256] = {};
+                swprintf_s(buff, L"ERROR: Worker failed: %hs\n", e.what());
+                replay.Print(buff);
+                replay.failed = true;
             }
         }
 
-        fflush(stdout);
+        ++replay.finished;
+
+        CoUninitialize();
+    }
+
+    void PrintSlowest(const Replay& replay)
+    {
+        std::vector<size_t> order(replay.files.size());
+        for (size_t j = 0; j < order.size(); ++j)
+        {
+            order[j] = j;
+        }
+
+        const size_t count = std::min(order.size(), c_SlowestToReport);
+        std::partial_sort(order.begin(), order.begin() + static_cast<ptrdiff_t>(count), order.end(),
+            [&](size_t a, size_t b) { return replay.elapsedMs[a] > replay.elapsedMs[b]; });
+
+        wprintf(L"\nSlowest inputs:\n");
+        for (size_t j = 0; j < count; ++j)
+        {
+            wprintf(L"  %10.2f ms  %ls\n", static_cast<double>(replay.elapsedMs[order[j]]), replay.files[order[j]].c_str());
+        }
+    }
+}
+
+int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
+{
+    // Initialize COM (needed for WIC)
+    HRESULT hr = hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    if (FAILED(hr))
+    {
+        wprintf(L"Failed to initialize COM (%08X)\n", static_cast<unsigned int>(hr));
+        return 1;
+    }
+
+    // Process command line
+    uint32_t dwOptions = 0;
+    std::list<SConversion> conversion;
+    uint32_t jobs = 1;
+    uint32_t timeoutMs = 0;
+
+    for (int iArg = 1; iArg < argc; iArg++)
+    {
+        PWSTR pArg = argv[iArg];
+
+        if (('-' == pArg[0]) || ('/' == pArg[0]))
+        {
+            pArg++;
+            PWSTR pValue;
+
+            for (pValue = pArg; *pValue && (':' != *pValue); pValue++);
+
+            if (*pValue)
+                *pValue++ = 0;
+
+            uint32_t dwOption = LookupByName(pArg, g_pOptions);
+
+            if (!dwOption || (dwOptions & (1 << dwOption)))
+            {
+                PrintUsage();
+                return 1;
+            }
+
+            dwOptions |= 1 << dwOption;
+
+            // Handle options with additional value parameter
+            switch (dwOption)
+            {
+            case OPT_JOBS:
+            case OPT_TIMEOUT:
+                if (!*pValue)
+                {
+                    if ((iArg + 1 >= argc))
+                    {
+                        PrintUsage();
+                        return 1;
+                    }
+
+                    iArg++;
+                    pValue = argv[iArg];
+                }
+                break;
+
+            default:
+                break;
+            }
+
+            switch (dwOption)
+            {
+            case OPT_DDS:
+            case OPT_WAV:
+            case OPT_WIC:
+            case OPT_XWB:
+            case OPT_CMO:
+            case OPT_SDKMESH:
+            case OPT_VBO:
+                {
+                    uint32_t mask = (1 << OPT_DDS)
+                        | (1 << OPT_WAV)
+                        | (1 << OPT_WIC)
+                        | (1 << OPT_XWB)
+                        | (1 << OPT_CMO)
+                        | (1 << OPT_SDKMESH)
+                        | (1 << OPT_VBO)
+                        ;
+                    mask &= ~(1u << dwOption);
+                    if (dwOptions & mask)
+                    {
+                        wprintf(L"-cmo, -dds, -sdkmesh, -vbo, -wav, -wic, and -xwb are mutually exclusive options\n");
+                        return 1;
+                    }
+                }
+                break;
+
+            case OPT_JOBS:
+                if (swscanf_s(pValue, L"%u", &jobs) != 1)
+                {
+                    wprintf(L"Invalid value specified with -j (%ls)\n\n", pValue);
+                    PrintUsage();
+                    return 1;
+                }
+                if (!jobs)
+                {
+                    jobs = std::max(1u, std::thread::hardware_concurrency());
+                }
+                break;
+
+            case OPT_TIMEOUT:
+                if (swscanf_s(pValue, L"%u", &timeoutMs) != 1)
+                {
+                    wprintf(L"Invalid value specified with -timeout (%ls)\n\n", pValue);
+                    PrintUsage();
+                    return 1;
+                }
+                break;
+
+            default:
+                break;
+            }
+        }
+        else if (wcspbrk(pArg, L"?*") != nullptr)
+        {
+            size_t count = conversion.size();
+            SearchForFiles(pArg, conversion, (dwOptions & (1 << OPT_RECURSIVE)) != 0, nullptr);
+            if (conversion.size() <= count)
+            {
+                wprintf(L"No matching files found for %ls\n", pArg);
+                return 1;
+            }
+        }
+        else
+        {
+            SConversion conv = {};
+            conv.szSrc = pArg;
+
+            conversion.push_back(conv);
+        }
+    }
+
+    if (conversion.empty())
+    {
+        wprintf(L"ERROR: Need at least 1 image file to fuzz\n\n");
+        PrintUsage();
+        return 0;
+    }
+
+    Replay replay;
+    replay.dwOptions = dwOptions;
+    replay.files.reserve(conversion.size());
+    for (const auto& pConv : conversion)
+    {
+        replay.files.emplace_back(pConv.szSrc);
+    }
+    replay.elapsedMs.resize(replay.files.size(), 0.f);
+
+    jobs = std::min(jobs, static_cast<uint32_t>(std::min<size_t>(replay.files.size(), UINT32_MAX)));
+
+    auto workers = std::make_unique<Worker[]>(jobs);
+    for (uint32_t j = 0; j < jobs; ++j)
+    {
+        workers[j].thread = std::thread(WorkerThread, std::ref(replay), std::ref(workers[j]));
     }
 
+    if (timeoutMs > 0)
+    {
+        // A hung loader can't be cancelled, so the watchdog reports it and ends the process
+        const auto poll = std::chrono::milliseconds(std::min(timeoutMs, 100u));
+        while (replay.finished < jobs)
+        {
+            std::this_thread::sleep_for(poll);
+
+            const int64_t now = Now();
+            for (uint32_t j = 0; j < jobs; ++j)
+            {
+                const size_t index = workers[j].current;
+                if (index == c_Idle)
+                    continue;
+
+                const float elapsed = ToMilliseconds(now - workers[j].started);
+                if (elapsed > static_cast<float>(timeoutMs))
+                {
+                    wchar_t buff[128] = {};
+                    swprintf_s(buff, L"\nERROR: Timeout after %.0f ms processing:\n", static_cast<double>(elapsed));
+                    replay.Print(buff + replay.files[index] + L"\n");
+                    std::_Exit(1);
+                }
+            }
+        }
+    }
+
+    for (uint32_t j = 0; j < jobs; ++j)
+    {
+        workers[j].thread.join();
+    }
+
+    if (replay.failed)
+        return 1;
+
     wprintf(L"\n*** FUZZING COMPLETE ***\n");
 
+    if (replay.files.size() > 1)
+    {
+        PrintSlowest(replay);
+    }
+
     return 0;
 }
 
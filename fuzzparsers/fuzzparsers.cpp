@@ -0,0 +1,180 @@
+//--------------------------------------------------------------------------------------
+// File: fuzzparsers.cpp
+//
+// Fuzz-testing harness for the test suite's own file parsers (WaveFrontReader and the
+// SDKMESH/CMO animation loaders). Everything is parsed from memory and no Direct3D
+// device is required, so the harness also builds standalone with clang on Linux.
+//
+// Without FUZZING_BUILD_MODE this replays each file on the command line through the
+// same entry-point, which is useful for regression testing a crash corpus.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include "WaveFrontReader.h"
+
+#ifndef FUZZING_PARSERS_ONLY
+#include "Animation.h"
+#endif
+
+namespace
+{
+    void FuzzWaveFront(const uint8_t* data, size_t size)
+    {
+        {
+            DX::WaveFrontReader<uint16_t> wfReader;
+            std::ignore = wfReader.LoadFromMemory(data, size);
+        }
+
+        {
+            DX::WaveFrontReader<uint32_t> wfReader;
+            std::ignore = wfReader.LoadFromMemory(data, size, false);
+            std::ignore = wfReader.LoadMTLFromMemory(data, size);
+        }
+
+        {
+            DX::WaveFrontReader<uint16_t> vboReader;
+            std::ignore = vboReader.LoadVBOFromMemory(data, size);
+        }
+
+        {
+            DX::WaveFrontReader<uint32_t> vboReader;
+            std::ignore = vboReader.LoadVBOFromMemory(data, size);
+        }
+    }
+
+#ifndef FUZZING_PARSERS_ONLY
+    void FuzzAnimation(const uint8_t* data, size_t size)
+    {
+        // Binding only looks at bone names, so a stand-in model avoids creating a device
+        static const wchar_t* s_boneNames[] = { L"root", L"Bip01", L"Bip01_Pelvis", L"Bip01_Spine", L"Bip01_Head" };
+
+        DirectX::Model model;
+        for (size_t j = 0; j < std::size(s_boneNames); ++j)
+        {
+            DirectX::ModelBone bone;
+            bone.name = s_boneNames[j];
+            if (j > 0)
+            {
+                bone.parentIndex = 0;
+            }
+            model.bones.emplace_back(bone);
+        }
+
+        try
+        {
+            DX::AnimationSDKMESH anim;
+            if (SUCCEEDED(anim.Load(data, size)))
+            {
+                std::ignore = anim.Bind(model);
+                anim.Update(0.1f);
+            }
+        }
+        catch (const std::exception&)
+        {
+            // Ignore C++ standard exceptions
+        }
+
+        try
+        {
+            DX::AnimationCMO anim;
+            if (SUCCEEDED(anim.Load(data, size, 0)))
+            {
+                anim.Bind(model);
+                anim.Update(0.1f);
+            }
+
+            std::ignore = anim.Load(data, size, 0, L"Take 001");
+        }
+        catch (const std::exception&)
+        {
+            // Ignore C++ standard exceptions
+        }
+    }
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------
+// Libfuzzer entry-point
+//--------------------------------------------------------------------------------------
+#ifdef _WIN32
+extern "C" __declspec(dllexport) int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+#else
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+#endif
+{
+    if (!data || !size)
+        return 0;
+
+    FuzzWaveFront(data, size);
+
+#ifndef FUZZING_PARSERS_ONLY
+    FuzzAnimation(data, size);
+#endif
+
+    return 0;
+}
+
+
+#ifndef FUZZING_BUILD_MODE
+
+//--------------------------------------------------------------------------------------
+// Corpus replay entry-point
+//--------------------------------------------------------------------------------------
+#ifdef _WIN32
+int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
+#else
+int main(int argc, char* argv[])
+#endif
+{
+    if (argc < 2)
+    {
+        printf("Usage: fuzzparsers <files>\n");
+        return 0;
+    }
+
+    for (int iArg = 1; iArg < argc; ++iArg)
+    {
+        std::ifstream inFile(argv[iArg], std::ios::in | std::ios::binary | std::ios::ate);
+        if (!inFile)
+        {
+#ifdef _WIN32
+            wprintf(L"ERROR: File not found:\n%ls\n", argv[iArg]);
+#else
+            printf("ERROR: File not found:\n%s\n", argv[iArg]);
+#endif
+            return 1;
+        }
+
+        const std::streampos len = inFile.tellg();
+        if (!inFile || len <= 0)
+        {
+            printf(".");
+            continue;
+        }
+
+        std::vector<uint8_t> blob(static_cast<size_t>(len));
+
+        inFile.seekg(0, std::ios::beg);
+        inFile.read(reinterpret_cast<char*>(blob.data()), len);
+        if (!inFile)
+        {
+            printf("!");
+            continue;
+        }
+
+        std::ignore = LLVMFuzzerTestOneInput(blob.data(), blob.size());
+        printf("*");
+        fflush(stdout);
+    }
+
+    printf("\n*** FUZZING COMPLETE ***\n");
+
+    return 0;
+}
+
+#endif // !FUZZING_BUILD_MODE
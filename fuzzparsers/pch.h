@@ -0,0 +1,59 @@
+//--------------------------------------------------------------------------------------
+// File: pch.h
+//
+// Header for standard system include files.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#ifdef _WIN32
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define NODRAWTEXT
+#define NOGDI
+#define NOBITMAP
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#include <Windows.h>
+
+#include <d3d11_1.h>
+#else
+// Workarounds to avoid conflicts between sal.h and GCC runtime headers
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cinttypes>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+#include <sal.h>
+#include <wsl/winadapter.h>
+#endif
+
+#include <DirectXMath.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#ifndef FUZZING_PARSERS_ONLY
+#include "Model.h"
+#endif
@@ -0,0 +1,381 @@
+//--------------------------------------------------------------------------------------
+// File: imagediff.cpp
+//
+// Command-line tool that compares rendered frames against golden reference images using
+// ImageDiff.h without any Direct3D runtime, so goldens captured on Windows can be
+// checked in bulk on Linux. Directories are matched by relative path, and the files
+// are compared in parallel.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//--------------------------------------------------------------------------------------
+
+#ifdef _WIN32
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define NODRAWTEXT
+#define NOGDI
+#define NOBITMAP
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#include <Windows.h>
+#else
+// Workarounds to avoid conflicts between sal.h and GCC runtime headers
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cinttypes>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <utility>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cwchar>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "ImageDiff.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    struct Comparison
+    {
+        fs::path            relative;
+        fs::path            reference;
+        fs::path            candidate;
+        HRESULT             hr;
+        const char*         error;
+        DX::ImageDiffResult result;
+    };
+
+    void PrintPath(const fs::path& path)
+    {
+#ifdef _WIN32
+        wprintf(L"%ls", path.c_str());
+#else
+        printf("%s", path.c_str());
+#endif
+    }
+
+    bool IsImage(const fs::path& path)
+    {
+        auto ext = path.extension().native();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](auto c) { return (c >= 'A' && c <= 'Z') ? static_cast<decltype(c)>(c - 'A' + 'a') : c; });
+        return ext == fs::path(".qoi").native() || ext == fs::path(".dds").native();
+    }
+
+    // A golden 'foo.qoi' may be compared with a candidate 'foo.dds', and vice versa
+    fs::path FindCandidate(const fs::path& dir, const fs::path& relative)
+    {
+        std::error_code ec;
+        fs::path path = dir / relative;
+        if (fs::is_regular_file(path, ec))
+            return path;
+
+        for (const char* ext : { ".qoi", ".dds" })
+        {
+            path = dir / relative;
+            path.replace_extension(ext);
+            if (fs::is_regular_file(path, ec))
+                return path;
+        }
+
+        return {};
+    }
+
+#ifdef _WIN32
+    double ParseDouble(const wchar_t* arg) { return wcstod(arg, nullptr); }
+    unsigned long ParseULong(const wchar_t* arg) { return wcstoul(arg, nullptr, 10); }
+#else
+    double ParseDouble(const char* arg) { return strtod(arg, nullptr); }
+    unsigned long ParseULong(const char* arg) { return strtoul(arg, nullptr, 10); }
+#endif
+
+    void Compare(Comparison& item, const DX::ImageDiffOptions& options, const fs::path& storeDir, const fs::path& diffDir, size_t threads)
+    {
+        DX::RGBAImage reference = {};
+        item.hr = DX::LoadReferenceImage(item.reference, reference);
+        if (FAILED(item.hr))
+        {
+            item.error = "failed to read reference";
+            return;
+        }
+
+        // Round trip through the golden store so the stored images are what get compared
+        if (!storeDir.empty())
+        {
+            fs::path golden = storeDir / item.relative;
+            golden.replace_extension(".qoi");
+
+            std::error_code ec;
+            fs::create_directories(golden.parent_path(), ec);
+
+            item.hr = DX::SaveReferenceImage(golden, reference);
+            if (SUCCEEDED(item.hr))
+            {
+                item.hr = DX::LoadReferenceImage(golden, reference);
+            }
+
+            if (FAILED(item.hr))
+            {
+                item.error = "failed to store golden";
+                return;
+            }
+        }
+
+        DX::RGBAImage candidate = {};
+        item.hr = DX::LoadReferenceImage(item.candidate, candidate);
+        if (FAILED(item.hr))
+        {
+            item.error = "failed to read candidate";
+            return;
+        }
+
+        if (reference.width != candidate.width || reference.height != candidate.height)
+        {
+            item.hr = E_FAIL;
+            item.error = "size mismatch";
+            return;
+        }
+
+        DX::RGBAImage diff = {};
+        item.hr = DX::DiffImages(reference, candidate, options, item.result, diffDir.empty() ? nullptr : &diff, threads);
+        if (FAILED(item.hr))
+        {
+            item.error = "diff failed";
+            return;
+        }
+
+        if (!item.result.passed && !diffDir.empty())
+        {
+            fs::path diffFile = diffDir / item.relative;
+            diffFile.replace_extension(".diff.qoi");
+
+            std::error_code ec;
+            fs::create_directories(diffFile.parent_path(), ec);
+            std::ignore = DX::SaveReferenceImage(diffFile, diff);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Entry-point
+//--------------------------------------------------------------------------------------
+#ifdef _WIN32
+int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
+#else
+int main(int argc, char* argv[])
+#endif
+{
+    DX::ImageDiffOptions options = {};
+    size_t jobs = 0;
+    bool verbose = false;
+    fs::path storeDir;
+    fs::path diffDir;
+
+    std::vector<fs::path> inputs;
+    for (int iArg = 1; iArg < argc; ++iArg)
+    {
+        const fs::path arg(argv[iArg]);
+        if (arg == "-a")
+        {
+            options.ignoreAlpha = true;
+        }
+        else if (arg == "-v")
+        {
+            verbose = true;
+        }
+        else if (arg == "-t" || arg == "-p" || arg == "-m" || arg == "-j" || arg == "-o" || arg == "-s")
+        {
+            if (iArg + 1 >= argc)
+            {
+                printf("ERROR: Missing value for ");
+                PrintPath(arg);
+                printf("\n");
+                return 1;
+            }
+
+            ++iArg;
+            if (arg == "-t")
+            {
+                options.channelTolerance = static_cast<uint8_t>(std::min<unsigned long>(ParseULong(argv[iArg]), 255));
+            }
+            else if (arg == "-p")
+            {
+                options.perceptualThreshold = static_cast<float>(ParseDouble(argv[iArg]));
+            }
+            else if (arg == "-m")
+            {
+                options.maxDifferentRatio = ParseDouble(argv[iArg]);
+            }
+            else if (arg == "-j")
+            {
+                jobs = static_cast<size_t>(ParseULong(argv[iArg]));
+            }
+            else if (arg == "-o")
+            {
+                diffDir = argv[iArg];
+            }
+            else
+            {
+                storeDir = argv[iArg];
+            }
+        }
+        else
+        {
+            inputs.emplace_back(arg);
+        }
+    }
+
+    if (inputs.size() != 2)
+    {
+        printf("Usage: imagediff [-t <n>] [-p <f>] [-m <f>] [-a] [-j <n>] [-o <dir>] [-s <dir>] [-v] <reference> <candidate>\n"
+            "\n"
+            "   Compares two image files, or every image under the reference directory with the\n"
+            "   candidate of the same relative path. Images are .qoi goldens or 2D .dds files.\n"
+            "\n"
+            "   -t <n>    per-channel tolerance (0 to 255, default 0)\n"
+            "   -p <f>    perceptual threshold a pixel must also exceed (0 to 1, default 0)\n"
+            "   -m <f>    fraction of pixels allowed to differ (default 0)\n"
+            "   -a        ignore alpha\n"
+            "   -j <n>    number of threads (0 for all cores)\n"
+            "   -o <dir>  write a .diff.qoi visualization of each failure to <dir>\n"
+            "   -s <dir>  store the reference images as .qoi goldens in <dir>, then compare against those\n"
+            "   -v        print the result of every comparison\n");
+        return 0;
+    }
+
+    std::vector<Comparison> items;
+
+    std::error_code ec;
+    if (fs::is_directory(inputs[0], ec))
+    {
+        for (const auto& entry : fs::recursive_directory_iterator(inputs[0], fs::directory_options::skip_permission_denied, ec))
+        {
+            std::error_code err;
+            if (entry.is_regular_file(err) && IsImage(entry.path()))
+            {
+                Comparison item = {};
+                item.relative = entry.path().lexically_relative(inputs[0]);
+                item.reference = entry.path();
+                item.candidate = FindCandidate(inputs[1], item.relative);
+                items.emplace_back(std::move(item));
+            }
+        }
+
+        std::sort(items.begin(), items.end(), [](const Comparison& a, const Comparison& b) { return a.relative < b.relative; });
+    }
+    else
+    {
+        Comparison item = {};
+        item.relative = inputs[0].filename();
+        item.reference = inputs[0];
+        item.candidate = inputs[1];
+        items.emplace_back(std::move(item));
+    }
+
+    if (!jobs)
+    {
+        jobs = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    // Many images are compared one per thread; a single image is split across threads instead
+    const size_t workers = std::min(jobs, items.size());
+    const size_t diffThreads = (items.size() > 1) ? 1 : jobs;
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        for (;;)
+        {
+            const size_t j = next.fetch_add(1);
+            if (j >= items.size())
+                break;
+
+            if (items[j].candidate.empty())
+            {
+                items[j].hr = E_FAIL;
+                items[j].error = "missing candidate";
+                continue;
+            }
+
+            Compare(items[j], options, storeDir, diffDir, diffThreads);
+        }
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+
+    if (workers <= 1)
+    {
+        worker();
+    }
+    else
+    {
+        std::vector<std::thread> pool;
+        pool.reserve(workers - 1);
+        for (size_t j = 1; j < workers; ++j)
+        {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto& t : pool)
+        {
+            t.join();
+        }
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    size_t failures = 0;
+    uint64_t pixels = 0;
+
+    for (const auto& item : items)
+    {
+        pixels += item.result.pixels;
+
+        if (FAILED(item.hr))
+        {
+            ++failures;
+            printf("ERROR (%08X) %s: ", static_cast<unsigned int>(item.hr), item.error);
+            PrintPath(item.relative);
+            printf("\n");
+        }
+        else if (!item.result.passed || verbose)
+        {
+            if (!item.result.passed)
+                ++failures;
+
+            printf("%s ", item.result.passed ? "PASS" : "FAIL");
+            PrintPath(item.relative);
+            printf(": %" PRIu64 " of %" PRIu64 " pixels differ, max delta %u, mean error %.3f, PSNR %.2f dB\n",
+                item.result.differentPixels, item.result.pixels, item.result.maxChannelDelta,
+                item.result.meanAbsError, item.result.psnr);
+        }
+    }
+
+    const double seconds = std::max(elapsed.count(), 1e-9);
+
+    printf("\n%zu images compared, %zu failed\n", items.size(), failures);
+    printf("%.3f seconds: %.1f megapixels/sec\n", seconds, double(pixels) / seconds / 1000000.0);
+
+    return (failures > 0) ? 1 : 0;
+}